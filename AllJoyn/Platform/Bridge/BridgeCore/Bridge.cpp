@@ -66,7 +66,8 @@ DsbBridge::DsbBridge() :
     m_alljoynInitialized(false),
     m_triggerReset(false),
     m_stopWorkerThread(false),
-    m_workerThreadStopped(true)
+    m_workerThreadStopped(true),
+    m_covFlushScheduled(false)
 {
 }
 
@@ -88,7 +89,17 @@ void DsbBridge::MonitorThread()
 
     for (;;)
     {
-        m_actionRequired.wait(lock, [this] { return m_triggerReset || m_stopWorkerThread; });
+        auto actionRequired = [this] { return m_triggerReset || m_stopWorkerThread || m_covFlushScheduled; };
+        if (m_covFlushes.empty())
+        {
+            m_actionRequired.wait(lock, actionRequired);
+        }
+        else
+        {
+            auto nextFlush = m_covFlushes.begin()->first;
+            m_actionRequired.wait_until(lock, nextFlush, actionRequired);
+        }
+        m_covFlushScheduled = false;
 
         if (m_stopWorkerThread)
         {
@@ -106,6 +117,8 @@ void DsbBridge::MonitorThread()
             }
             m_triggerReset = false;
         }
+
+        FlushDueCOV(lock);
     }
 
 Leave:
@@ -114,6 +127,56 @@ Leave:
     BridgeLog::LogLeave(__FUNCTION__);
 }
 
+void DsbBridge::FlushDueCOV(std::unique_lock<std::mutex>& lock)
+{
+    std::vector<std::weak_ptr<BridgeDevice>> dueDevices;
+    auto now = std::chrono::steady_clock::now();
+
+    auto lastDue = m_covFlushes.upper_bound(now);
+    for (auto iter = m_covFlushes.begin(); iter != lastDue; iter++)
+    {
+        dueDevices.push_back(iter->second);
+    }
+    m_covFlushes.erase(m_covFlushes.begin(), lastDue);
+
+    if (dueDevices.empty())
+    {
+        return;
+    }
+
+    // signals are emitted without holding the thread lock so that adapters can keep on
+    // scheduling flushes meanwhile
+    lock.unlock();
+    for (auto &dueDevice : dueDevices)
+    {
+        auto device = dueDevice.lock();
+        if (nullptr != device)
+        {
+            device->FlushCOV();
+        }
+    }
+    lock.lock();
+}
+
+void DsbBridge::ScheduleCOVFlush(std::shared_ptr<BridgeDevice> device, std::chrono::steady_clock::time_point flushTime)
+{
+    {
+        std::lock_guard<std::mutex> threadlock(m_threadLock);
+
+        // only wake up the background thread if this flush is the next one
+        bool isNext = m_covFlushes.empty() || flushTime < m_covFlushes.begin()->first;
+        m_covFlushes.insert(std::make_pair(flushTime, device));
+        if (!isNext)
+        {
+            return;
+        }
+        m_covFlushScheduled = true;
+    }
+
+    // Shutdown() waits on the same condition, wake up everybody
+    m_actionRequired.notify_all();
+}
+
 QStatus
 DsbBridge::Initialize()
 {
@@ -201,6 +264,11 @@ DsbBridge::Shutdown()
         m_thread.detach();
     }
 
+    {
+        std::lock_guard<std::mutex> threadlock(m_threadLock);
+        m_covFlushes.clear();
+    }
+
     hr = ShutdownInternal();
 
     if (m_alljoynInitialized)
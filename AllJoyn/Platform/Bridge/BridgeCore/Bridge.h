@@ -49,6 +49,9 @@ namespace Bridge
 
         ConfigManager* GetConfigManager(std::shared_ptr<IAdapter> adapter);
 
+        // ask the background thread to flush the change of value signals a device has held back
+        void ScheduleCOVFlush(_In_ std::shared_ptr<BridgeDevice> device, _In_ std::chrono::steady_clock::time_point flushTime);
+
     private:
         static std::shared_ptr<DsbBridge> g_TheOneOnlyInstance;
 
@@ -60,6 +63,7 @@ namespace Bridge
         QStatus RemoveDevice(_In_ std::shared_ptr<IAdapter> adapter, _In_ std::shared_ptr<IAdapterDevice> device);
 
         void MonitorThread();
+        void FlushDueCOV(_In_ std::unique_lock<std::mutex>& lock);
 
         QStatus InitializeInternal();
         QStatus ShutdownInternal();
@@ -85,6 +89,10 @@ namespace Bridge
         bool m_stopWorkerThread;
         bool m_workerThreadStopped;
 
+        // pending change of value flushes, ordered by due time (protected by m_threadLock)
+        std::multimap<std::chrono::steady_clock::time_point, std::weak_ptr<BridgeDevice>> m_covFlushes;
+        bool m_covFlushScheduled;
+
     public:
         ConfigManager* GetConfigManagerForBusObject(_In_ alljoyn_busobject busObject);
 
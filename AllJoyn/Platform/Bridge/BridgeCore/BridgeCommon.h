@@ -18,11 +18,13 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <exception>
 #include <string>
 #include <thread>
 #include <algorithm>
+#include <chrono>
 
 #include <alljoyn_c/Init.h>
 #include <alljoyn_c/dbusstddefines.h>
@@ -50,6 +50,7 @@ static const char SETTINGS_DEVICE_USERNAME_PATH[] = "/BridgeConfig/Settings/Devi
 static const char SETTINGS_DEVICE_PASSWORD_PATH[] = "/BridgeConfig/Settings/Device/PASSWORD";
 static const char SETTINGS_DEVICE_ECDHE_ECDSA_PRIVATEKEY_PATH[] = "/BridgeConfig/Settings/Device/ECDHEECDSAPRIVATEKEY";
 static const char SETTINGS_DEVICE_ECDHE_ECDSA_CERTCHAIN_PATH[] = "/BridgeConfig/Settings/Device/ECDHEECDSACERTCHAIN";
+static const char SETTINGS_DEVICE_COV_MIN_INTERVAL_PATH[] = "/BridgeConfig/Settings/Device/COVMinimumInterval";
 
 // The bridge does not use a persisted configuration
 // This may be added in the future
@@ -69,6 +70,7 @@ static const char DEFAULT_BRIDGE_CFG_XML[] =
 "       <PASSWORD></PASSWORD>\n"
 "       <ECDHEECDSAPRIVATEKEY></ECDHEECDSAPRIVATEKEY>\n"
 "       <ECDHEECDSACERTCHAIN></ECDHEECDSACERTCHAIN>\n"
+"       <COVMinimumInterval>0</COVMinimumInterval>\n"
 "    </Device>\n"
 "  </Settings>\n"
 "  <AdapterDevices>\n"
@@ -366,3 +368,21 @@ bool BridgeConfig::DefaultVisibility()
 
     return bDefaultVisibility;
 }
+
+uint32_t BridgeConfig::COVMinimumInterval()
+{
+    uint32_t interval = 0;
+
+    std::string val = m_XmlUtil.GetNodeValue(SETTINGS_DEVICE_COV_MIN_INTERVAL_PATH);
+    if (!val.empty())
+    {
+        char *end = nullptr;
+        unsigned long tempValue = strtoul(val.c_str(), &end, 10);
+        if (nullptr != end && '\0' == *end && tempValue <= UINT32_MAX)
+        {
+            interval = static_cast<uint32_t>(tempValue);
+        }
+    }
+
+    return interval;
+}
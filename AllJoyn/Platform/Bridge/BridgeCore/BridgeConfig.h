@@ -230,6 +230,16 @@ public:
     //******************************************************************************************************
     bool DefaultVisibility();
 
+    //******************************************************************************************************
+    //
+    //	Returns the minimum time between 2 change of value signals of the same property, in milliseconds.
+    //	Changes that happen faster are coalesced and only the latest value is signaled.
+    //
+    //	returns: 0 (no rate limit) if not set or invalid, the configured interval otherwise
+    //
+    //******************************************************************************************************
+    uint32_t COVMinimumInterval();
+
 
 private:
     //******************************************************************************************************
@@ -43,6 +43,7 @@ BridgeDevice::BridgeDevice()
     m_uniqueIdForInterfaces(FIRST_UNIQUE_ID),
     m_deviceMain(nullptr),
     m_supportCOVSignal(false),
+    m_covMinimumInterval(0),
     m_adapter(nullptr),
     m_pControlPanel(nullptr)
 {
@@ -61,6 +62,7 @@ QStatus BridgeDevice::Initialize(std::shared_ptr<IAdapter> adapter, std::shared_
 
     QStatus status = ER_OK;
     QStatus hr = ER_OK;
+    ConfigManager *configManager = nullptr;
 
     // sanity check
     if (nullptr == device)
@@ -71,6 +73,13 @@ QStatus BridgeDevice::Initialize(std::shared_ptr<IAdapter> adapter, std::shared_
     m_device = device;
     m_adapter = adapter;
 
+    // rate limit of change of value signals
+    configManager = DsbBridge::SingleInstance()->GetConfigManager(m_adapter);
+    if (nullptr != configManager)
+    {
+        m_covMinimumInterval = std::chrono::milliseconds(configManager->GetBridgeConfig()->COVMinimumInterval());
+    }
+
     // create Device service name
     status = BuildServiceName();
     if (ER_OK != status)
@@ -110,11 +119,11 @@ QStatus BridgeDevice::Initialize(std::shared_ptr<IAdapter> adapter, std::shared_
     }
 
     // create device properties
-    //status = CreateDeviceProperties();
-    //if (ER_OK != status)
-    //{
-    //    goto leave;
-    //}
+    status = CreateDeviceProperties();
+    if (ER_OK != status)
+    {
+        goto leave;
+    }
 
     // create main device
     m_deviceMain = new(std::nothrow) DeviceMain();
@@ -187,6 +196,11 @@ void BridgeDevice::Shutdown()
     }
 
     // shutdown device properties
+    {
+        std::lock_guard<std::mutex> lock(m_covLock);
+        m_pendingCOVProperties.clear();
+        m_devicePropertiesByAdapterProperty.clear();
+    }
     for (auto &var : m_deviceProperties)
     {
         var.second->Shutdown();
@@ -216,6 +230,7 @@ void BridgeDevice::Shutdown()
     m_ServiceName.clear();
     m_device = nullptr;
     m_supportCOVSignal = false;
+    m_covMinimumInterval = std::chrono::milliseconds(0);
     m_adapter = nullptr;
 }
 
@@ -305,6 +320,7 @@ QStatus BridgeDevice::CreateDeviceProperties()
             goto leave;
         }
         m_deviceProperties.insert(std::make_pair(*deviceProperty->GetPathName(), deviceProperty));
+        m_devicePropertiesByAdapterProperty.insert(std::make_pair(tempProperty.get(), deviceProperty));
         m_about.AddObject(deviceProperty->GetBusObject(), deviceProperty->GetPropertyInterface()->GetInterfaceDescription());
 
         deviceProperty = nullptr;
@@ -679,7 +695,7 @@ void AJ_CALL BridgeDevice::SessionJoined(void * context, alljoyn_sessionport /*s
     }
 
     {
-        std::lock_guard<std::recursive_mutex> lock(DsbBridge::SingleInstance()->GetLock());
+        std::lock_guard<std::mutex> lock(bridgeDevice->m_covLock);
         bridgeDevice->m_activeSessions.push_back(id);
     }
 
@@ -702,7 +718,7 @@ void AJ_CALL BridgeDevice::MemberRemoved(void * context, alljoyn_sessionid sessi
     bridgeDevice->m_authHandler.ResetAccess(uniqueName);
 
     {
-        std::lock_guard<std::recursive_mutex> lock(DsbBridge::SingleInstance()->GetLock());
+        std::lock_guard<std::mutex> lock(bridgeDevice->m_covLock);
         auto iter = std::find(bridgeDevice->m_activeSessions.begin(), bridgeDevice->m_activeSessions.end(), sessionid);
 
         if (iter != bridgeDevice->m_activeSessions.end())
@@ -770,9 +786,10 @@ void BridgeDevice::HandleCOVSignal(std::shared_ptr<IAdapterSignal>  signal)
 {
     std::shared_ptr<IAdapterProperty> adapterProperty = nullptr;
     std::shared_ptr<IAdapterValue> newValue = nullptr;
+    std::chrono::steady_clock::time_point flushTime;
 
     // get present value and property name from the signal
-    for (auto param : signal->Params())
+    for (const auto &param : signal->Params())
     {
         if (param->Name() == Constants::COV__PROPERTY_HANDLE())
         {
@@ -784,16 +801,40 @@ void BridgeDevice::HandleCOVSignal(std::shared_ptr<IAdapterSignal>  signal)
         }
     }
 
-    if (adapterProperty != nullptr && newValue != nullptr)
+    if (adapterProperty == nullptr || newValue == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_covLock);
+
+    // get the property that has changed
+    auto index = m_devicePropertiesByAdapterProperty.find(adapterProperty.get());
+    if (m_devicePropertiesByAdapterProperty.end() == index)
     {
-        // get the property that has changed
-        for (auto val : m_deviceProperties)
+        return;
+    }
+
+    if (COVResult::Deferred == index->second->EmitSignalCOV(newValue, m_activeSessions, flushTime))
+    {
+        m_pendingCOVProperties.insert(index->second);
+        DsbBridge::SingleInstance()->ScheduleCOVFlush(shared_from_this(), flushTime);
+    }
+}
+
+void BridgeDevice::FlushCOV()
+{
+    std::lock_guard<std::mutex> lock(m_covLock);
+
+    for (auto iter = m_pendingCOVProperties.begin(); iter != m_pendingCOVProperties.end();)
+    {
+        if ((*iter)->FlushSignalCOV(m_activeSessions))
         {
-            if (val.second->GetAdapterProperty() == adapterProperty)
-            {
-                val.second->EmitSignalCOV(newValue, m_activeSessions);
-                break;
-            }
+            iter++;
+        }
+        else
+        {
+            iter = m_pendingCOVProperties.erase(iter);
         }
     }
 }
@@ -817,12 +858,10 @@ std::string BridgeDevice::GetBusObjectPath(_In_ std::shared_ptr<IAdapterProperty
     std::string busObjectPath;
 
     // find exposed bus object path from IAdapterProperty
-    for (auto val : m_deviceProperties)
+    auto val = m_devicePropertiesByAdapterProperty.find(adapterProperty.get());
+    if (val != m_devicePropertiesByAdapterProperty.end())
     {
-        if (val.second->GetAdapterProperty() == adapterProperty)
-        {
-            busObjectPath = *(val.second->GetPathName());
-        }
+        busObjectPath = *(val->second->GetPathName());
     }
     return busObjectPath;
 }
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <set>
 #include <vector>
 #include "AdapterConstants.h"
 #include "BridgeAuthHandler.h"
@@ -47,6 +48,9 @@ namespace Bridge
 
         void RaiseSignal(std::shared_ptr<IAdapterSignal> signal);
 
+        // send change of value signals that have been held back by the rate limit
+        void FlushCOV();
+
     //internal:
         QStatus Initialize(_In_ std::shared_ptr<IAdapter> adapter, _In_ std::shared_ptr<IAdapterDevice> device);
         void Shutdown();
@@ -80,6 +84,10 @@ namespace Bridge
         {
             return m_adapter;
         }
+        inline std::chrono::milliseconds GetCOVMinimumInterval()
+        {
+            return m_covMinimumInterval;
+        }
     private:
         void VerifyCOVSupport();
         QStatus RegisterSignalHandlers(_In_ bool isRegister);
@@ -103,11 +111,18 @@ namespace Bridge
         static void AJ_CALL SessionJoined(_In_ void *context, _In_ alljoyn_sessionport sessionPort, _In_ alljoyn_sessionid id, _In_z_ const char *joiner);
         static void AJ_CALL MemberRemoved(_In_ void* context, _In_ alljoyn_sessionid sessionid, _In_z_ const char* uniqueName);
 
-        // list of active sessions
+        // list of active sessions, protected by m_covLock as the signals go to them
         std::vector<alljoyn_sessionid> m_activeSessions;
 
         // list of device properties
         std::map<std::string, DeviceProperty *> m_deviceProperties;
+        std::unordered_map<IAdapterProperty *, DeviceProperty *> m_devicePropertiesByAdapterProperty;
+
+        // change of value signals (aka COV)
+        // m_covLock serializes COV emission and protects the properties waiting for a flush
+        std::mutex m_covLock;
+        std::set<DeviceProperty *> m_pendingCOVProperties;
+        std::chrono::milliseconds m_covMinimumInterval;
 
         // list of AllJoyn interfaces that a device property can expose
         std::vector<PropertyInterface *>    m_propertyInterfaces;
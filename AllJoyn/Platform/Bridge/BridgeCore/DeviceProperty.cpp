@@ -36,7 +36,8 @@ DeviceProperty::DeviceProperty()
     m_AJBusObject(nullptr),
     m_registeredOnAllJoyn(false),
     m_propertyInterface(nullptr),
-    m_adapter(nullptr)
+    m_adapter(nullptr),
+    m_covMinimumInterval(0)
 {
 }
 
@@ -80,6 +81,7 @@ QStatus DeviceProperty::Initialize(std::shared_ptr<IAdapterProperty> devicePrope
     m_propertyInterface = propertyInterface;
     m_parent = parent;
     m_adapter = parent->GetAdapter();
+    m_covMinimumInterval = parent->GetCOVMinimumInterval();
 
     // build bus object path
     AllJoynHelper::EncodeBusObjectName(m_deviceProperty->Name(), tempString);
@@ -154,6 +156,15 @@ void DeviceProperty::Shutdown()
     m_parent = nullptr;
     m_adapter = nullptr;
     m_AJBusObjectPath.clear();
+    for (auto &valuePair : m_AJpropertyAdapterValuePairs)
+    {
+        if (nullptr != valuePair.second.covMsgArg)
+        {
+            alljoyn_msgarg_destroy(valuePair.second.covMsgArg);
+        }
+    }
+    m_valuePairsByAdapterValue.clear();
+    m_valuePairsByValueName.clear();
     m_AJpropertyAdapterValuePairs.clear();
 }
 
@@ -181,7 +192,16 @@ QStatus Bridge::DeviceProperty::PairAjProperties()
             if (ajProperty->IsSameType(*adapterAttr))
             {
                 AJpropertyAdapterValuePair tempPair = { ajProperty, *adapterAttr };
-                m_AJpropertyAdapterValuePairs.insert(std::make_pair(*ajProperty->GetName(), tempPair));
+                auto inserted = m_AJpropertyAdapterValuePairs.insert(std::make_pair(*ajProperty->GetName(), tempPair));
+
+                // index the pair by adapter value for change of value signals
+                AJpropertyAdapterValuePair *valuePair = &inserted.first->second;
+                std::shared_ptr<IAdapterValue> adapterValue = valuePair->adapterAttr->Value();
+                if (nullptr != adapterValue)
+                {
+                    m_valuePairsByAdapterValue.insert(std::make_pair(adapterValue.get(), valuePair));
+                    m_valuePairsByValueName.insert(std::make_pair(adapterValue->Name(), valuePair));
+                }
                 paired = true;
                 break;
             }
@@ -308,11 +328,30 @@ leave:
     return status;
 }
 
-void DeviceProperty::EmitSignalCOV(std::shared_ptr<IAdapterValue> newValue, const std::vector<alljoyn_sessionid>& sessionIds)
+Bridge::AJpropertyAdapterValuePair *DeviceProperty::FindValuePair(const std::shared_ptr<IAdapterValue>& adapterValue)
 {
-    QStatus status = ER_OK;
-    alljoyn_msgarg msgArg = nullptr;
-    auto valuePair = m_AJpropertyAdapterValuePairs.end();
+    // adapters usually signal the value instance they expose...
+    auto byValue = m_valuePairsByAdapterValue.find(adapterValue.get());
+    if (m_valuePairsByAdapterValue.end() != byValue)
+    {
+        return byValue->second;
+    }
+
+    // ...but may also send a copy of it
+    auto byName = m_valuePairsByValueName.find(adapterValue->Name());
+    if (m_valuePairsByValueName.end() != byName)
+    {
+        return byName->second;
+    }
+
+    return nullptr;
+}
+
+COVResult DeviceProperty::EmitSignalCOV(std::shared_ptr<IAdapterValue> newValue, const std::vector<alljoyn_sessionid>& sessionIds, std::chrono::steady_clock::time_point& flushTime)
+{
+    COVResult result = COVResult::Ignored;
+    AJpropertyAdapterValuePair *valuePair = nullptr;
+    std::chrono::steady_clock::time_point now;
 
     // sanity check
     if (nullptr == newValue)
@@ -321,47 +360,104 @@ void DeviceProperty::EmitSignalCOV(std::shared_ptr<IAdapterValue> newValue, cons
     }
 
     // get AllJoyn property that match with IAdapterValue that has changed
-    for (valuePair = m_AJpropertyAdapterValuePairs.begin(); valuePair != m_AJpropertyAdapterValuePairs.end(); valuePair++)
+    valuePair = FindValuePair(newValue);
+    if (nullptr == valuePair)
     {
-        if (valuePair->second.adapterAttr->Value()->Name() == newValue->Name())
-        {
-            break;
-        }
+        // can't find any Alljoyn property that correspond to IAdapterValue
+        goto leave;
     }
-    if (valuePair == m_AJpropertyAdapterValuePairs.end())
+
+    if (nullptr != valuePair->pendingCOV)
     {
-        // can't find any Alljoyn property that correspond to IAdapterValue
+        // a signal is already waiting for the end of the interval, it will carry the latest value
+        valuePair->pendingCOV = newValue;
+        result = COVResult::Coalesced;
         goto leave;
     }
 
-    // prepare signal arguments
-    msgArg = alljoyn_msgarg_create();
-    if (nullptr == msgArg)
+    now = std::chrono::steady_clock::now();
+    if (now - valuePair->lastCOV < m_covMinimumInterval)
     {
+        valuePair->pendingCOV = newValue;
+        flushTime = valuePair->lastCOV + m_covMinimumInterval;
+        result = COVResult::Deferred;
         goto leave;
     }
 
-    // build alljoyn message from IAdapterValue
-    status = AllJoynHelper::SetMsgArg(newValue, msgArg);
+    SendSignalCOV(*valuePair, newValue, sessionIds);
+    valuePair->lastCOV = now;
+    result = COVResult::Emitted;
+
+leave:
+    return result;
+}
+
+bool DeviceProperty::FlushSignalCOV(const std::vector<alljoyn_sessionid>& sessionIds)
+{
+    bool pending = false;
+    auto now = std::chrono::steady_clock::now();
+
+    for (auto &valuePair : m_AJpropertyAdapterValuePairs)
+    {
+        if (nullptr == valuePair.second.pendingCOV)
+        {
+            continue;
+        }
+
+        if (now - valuePair.second.lastCOV < m_covMinimumInterval)
+        {
+            // not due yet, another flush has been scheduled for it
+            pending = true;
+            continue;
+        }
+
+        SendSignalCOV(valuePair.second, valuePair.second.pendingCOV, sessionIds);
+        valuePair.second.pendingCOV = nullptr;
+        valuePair.second.lastCOV = now;
+    }
+
+    return pending;
+}
+
+void DeviceProperty::SendSignalCOV(AJpropertyAdapterValuePair& valuePair, std::shared_ptr<IAdapterValue> newValue, const std::vector<alljoyn_sessionid>& sessionIds)
+{
+    QStatus status = ER_OK;
+    const char *interfaceName = nullptr;
+    const char *propertyName = nullptr;
+
+    // signal arguments are re-used from one change to the next
+    if (nullptr == valuePair.covMsgArg)
+    {
+        valuePair.covMsgArg = alljoyn_msgarg_create();
+        if (nullptr == valuePair.covMsgArg)
+        {
+            goto leave;
+        }
+    }
+    else
+    {
+        alljoyn_msgarg_clear(valuePair.covMsgArg);
+    }
+
+    // build alljoyn message from IAdapterValue, once for all sessions
+    status = AllJoynHelper::SetMsgArg(newValue, valuePair.covMsgArg);
     if (status != ER_OK)
     {
         goto leave;
     }
 
-	for (auto sessionId : sessionIds)
-	{
-		// emit property change
-		alljoyn_busobject_emitpropertychanged(m_AJBusObject,
-			m_propertyInterface->GetInterfaceName()->c_str(),
-			valuePair->second.ajProperty->GetName()->c_str(),
-			msgArg, sessionId);
-	}
+    interfaceName = m_propertyInterface->GetInterfaceName()->c_str();
+    propertyName = valuePair.ajProperty->GetName()->c_str();
 
-leave:
-    if (nullptr != msgArg)
+    for (auto sessionId : sessionIds)
     {
-        alljoyn_msgarg_destroy(msgArg);
+        // emit property change
+        alljoyn_busobject_emitpropertychanged(m_AJBusObject,
+            interfaceName,
+            propertyName,
+            valuePair.covMsgArg, sessionId);
     }
 
+leave:
     return;
 }
@@ -26,6 +26,19 @@ namespace Bridge
     {
         AllJoynProperty *ajProperty;
         std::shared_ptr<IAdapterAttribute> adapterAttr;
+
+        // change of value signal state
+        alljoyn_msgarg covMsgArg;
+        std::chrono::steady_clock::time_point lastCOV;
+        std::shared_ptr<IAdapterValue> pendingCOV;
+    };
+
+    enum class COVResult
+    {
+        Emitted,    // signal has been sent
+        Deferred,   // held back by the rate limit, property must be flushed later
+        Coalesced,  // merged into a signal that is already waiting for a flush
+        Ignored
     };
 
     class DeviceProperty
@@ -36,7 +49,8 @@ namespace Bridge
 
         QStatus Initialize(_In_ std::shared_ptr<IAdapterProperty> deviceProperty, _In_ PropertyInterface *propertyInterface, _In_ std::shared_ptr<BridgeDevice> parent);
         void Shutdown();
-        void EmitSignalCOV(_In_ std::shared_ptr<IAdapterValue> newValue, const std::vector<alljoyn_sessionid>& sessionIds);
+        COVResult EmitSignalCOV(_In_ std::shared_ptr<IAdapterValue> newValue, const std::vector<alljoyn_sessionid>& sessionIds, _Out_ std::chrono::steady_clock::time_point& flushTime);
+        bool FlushSignalCOV(const std::vector<alljoyn_sessionid>& sessionIds);
 
         inline std::string *GetPathName()
         {
@@ -57,6 +71,8 @@ namespace Bridge
 
     private:
         QStatus PairAjProperties();
+        AJpropertyAdapterValuePair *FindValuePair(_In_ const std::shared_ptr<IAdapterValue>& adapterValue);
+        void SendSignalCOV(_In_ AJpropertyAdapterValuePair& valuePair, _In_ std::shared_ptr<IAdapterValue> newValue, const std::vector<alljoyn_sessionid>& sessionIds);
 
         static QStatus AJ_CALL GetProperty(_In_ const void* context, _In_z_ const char* ifcName, _In_z_ const char* propName, _Out_ alljoyn_msgarg val);
         static QStatus AJ_CALL SetProperty(_In_ const void* context, _In_z_ const char* ifcName, _In_z_ const char* propName, _In_ alljoyn_msgarg val);
@@ -78,6 +94,14 @@ namespace Bridge
         // with its corresponding device instance (adapter value)
         std::map<std::string, AJpropertyAdapterValuePair> m_AJpropertyAdapterValuePairs;
 
+        // indexes used to find the bus property that corresponds to a change of value,
+        // either by adapter value instance or by adapter value name
+        std::unordered_map<IAdapterValue *, AJpropertyAdapterValuePair *> m_valuePairsByAdapterValue;
+        std::unordered_map<std::string, AJpropertyAdapterValuePair *> m_valuePairsByValueName;
+
+        // minimum time between 2 change of value signals of the same bus property
+        std::chrono::milliseconds m_covMinimumInterval;
+
         std::string m_AJBusObjectPath;
     };
 }
@@ -32,11 +32,23 @@ static bool s_registered_atexit_handler = false;
 // Callers must register a handler interface during initialization.
 // Callers can push items onto the queue. The registered interface is then notified
 // from the AsyncQueue's worker thread to process each queued item.
+//
+// Any number of threads can push concurrently; pushing is lock-free (an intrusive
+// multiple producers / single consumer linked list). Items are constructed in place
+// in their list node, so a push costs a single allocation. The worker thread drains
+// the queue in batches and only parks on a condition variable once the queue is empty,
+// in which case the producer that fills it again wakes it up.
 template <class QueueItem>
 class AsyncQueue
 {
 public:
     AsyncQueue() :
+        _head(&_stub),
+        _tail(&_stub),
+        _pushed(0),
+        _processed(0),
+        _consumerWaiting(false),
+        _drainWaiters(0),
         _stopWorkerThread(false),
         _workerThreadStopped(false),
         _handler(nullptr),
@@ -56,6 +68,7 @@ public:
     ~AsyncQueue()
     {
         Uninitialize();
+        DeleteItems();
     }
 
     void Initialize(_In_ const std::shared_ptr<IQueueItemHandler<QueueItem>>& handler)
@@ -89,22 +102,25 @@ public:
     void Uninitialize()
     {
         std::unique_lock<std::mutex> lock(_mutex);
-        std::queue<QueueItem> emptyQueue;
 
         if (_isInitialized)
         {
+            // Refuse new items from now on
+            _isInitialized = false;
+
             if (!_stopWorkerThread)
             {
                 // Signal the worker thread to stop
                 _stopWorkerThread = true;
-                _actionRequired.notify_one();
+                _itemsAvailable.notify_one();
+                _stateChanged.notify_all();
 
                 // If the caller did not gracefully Uninitialize the queue and we are being destroyed as the result
                 // of the CRT being torn down, we need to modify our wait behavior.
                 // Wait for the worker thread to finish, unless the CRT is terminating (all std::threads will have been stopped if the CRT is terminating).
                 if (!s_crtIsTerminating)
                 {
-                    _actionRequired.wait(lock, [this] { return _workerThreadStopped || !_workerThread.joinable(); });
+                    _stateChanged.wait(lock, [this] { return _workerThreadStopped || !_workerThread.joinable(); });
                 }
                 // Once we get here, the worker thread has finished all work and has exited the threadproc, or it has been terminated by the CRT.
                 // If it's in a joinable state, detach it.  Note that terminated/aborted threads are still joinable and must be detached (or joined)
@@ -114,106 +130,244 @@ public:
                     _workerThread.detach();
                 }
             }
-            // Clear state
-            _items.swap(emptyQueue);
+            // Clear state, items that have not been processed are dropped
+            if (_workerThreadStopped)
+            {
+                DeleteItems();
+            }
             _handler = nullptr;
             _workerThreadStopped = false;
-            _isInitialized = false;
         }
     }
 
     // Pushes another item onto the queue for processing later on the worker thread.
+    // The item is constructed in place from the argument.
     // Returns false and no-ops if the queue is not initialized.
     template <typename QueueItemType>
     bool Push(_In_ QueueItemType&& item)
     {
-        bool queueWasEmpty = false;
+        // Check whether this queue has been initialized
+        if (!_isInitialized.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        Link(new ItemNode(std::forward<QueueItemType>(item)));
+        _pushed.fetch_add(1);
 
+        // Only wake the worker thread up if it is parked (or about to be) on an empty queue.
+        // The flag is cleared here so that the producers that follow before the worker
+        // thread gets to run do not wake it up again.
+        if (_consumerWaiting.load() && _consumerWaiting.exchange(false))
         {
-            std::lock_guard<std::mutex> lock(_mutex);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+            }
+            _itemsAvailable.notify_one();
+        }
+
+        return true;
+    }
+
+    // Waits until all the items pushed before this call have been processed
+    void WaitForAll()
+    {
+        const uint64_t ticket = _pushed.load();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _drainWaiters.fetch_add(1);
+        _stateChanged.wait(lock, [this, ticket] { return (_processed.load() >= ticket || _stopWorkerThread); });
+        _drainWaiters.fetch_sub(1);
+    }
+
+private:
+    // Maximum number of items processed between two updates of the processed count
+    static const uint64_t BatchSize = 64;
+
+    struct Node
+    {
+        Node() : next(nullptr) {}
+
+        std::atomic<Node*> next;
+    };
 
-            // Check whether this queue has been initialized
-            if (!_isInitialized)
+    struct ItemNode : public Node
+    {
+        template <typename QueueItemType>
+        explicit ItemNode(QueueItemType&& value) : item(std::forward<QueueItemType>(value)) {}
+
+        QueueItem item;
+    };
+
+    // Producer side, safe to call from any thread
+    void Link(Node* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // Consumer side, only called by the worker thread (or once it has stopped).
+    // Returns nullptr if the queue is empty or if a producer has not finished linking its item yet.
+    ItemNode* Unlink()
+    {
+        Node* tail = _tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &_stub)
+        {
+            if (next == nullptr)
             {
-                return false;
+                return nullptr;
             }
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
 
-            queueWasEmpty = _items.empty();
-            _items.push(std::forward<QueueItemType>(item));
+        if (next != nullptr)
+        {
+            _tail = next;
+            return static_cast<ItemNode*>(tail);
         }
 
-        // Only notify the worker thread if the queue is no longer empty
-        // (as that's the only way the worker thread would be waiting
-        // for this signal)
-        if (queueWasEmpty)
+        if (tail != _head.load(std::memory_order_acquire))
         {
-            _actionRequired.notify_all();
+            return nullptr;
         }
 
-        return true;
+        // tail is the last item, put the stub back behind it so that it can be unlinked
+        Link(&_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr)
+        {
+            _tail = next;
+            return static_cast<ItemNode*>(tail);
+        }
+
+        return nullptr;
     }
 
-    // Waits until the queue is empty
-    void WaitForAll()
+    void DeleteItems()
     {
-        std::unique_lock<std::mutex> lock(_mutex);
+        uint64_t count = 0;
+        while (ItemNode* node = Unlink())
+        {
+            delete node;
+            ++count;
+        }
+        _processed.fetch_add(count);
+    }
 
-        _isEmpty.wait(lock, [this] {return (_items.empty() || _stopWorkerThread); });
+    bool HasPendingItems()
+    {
+        return _pushed.load() != _processed.load();
     }
 
-private:
-    class UnlockGuard
+    // On multi-core machines, wait a little for new items before parking the worker thread:
+    // back to back calls then neither pay for a wake up on the producer side nor for a
+    // context switch on the consumer side.
+    bool SpinForItems()
     {
-    public:
-        UnlockGuard(std::unique_lock<std::mutex>& lock) : _lock(lock) { _lock.unlock(); }
-        ~UnlockGuard() { _lock.lock(); }
+        static const unsigned int spinCount = std::thread::hardware_concurrency() > 1 ? 1000 : 0;
 
-    private:
-        UnlockGuard(const UnlockGuard&) = delete;
-        UnlockGuard& operator=(const UnlockGuard&) = delete;
+        for (unsigned int i = 0; i < spinCount; ++i)
+        {
+            if (HasPendingItems() || _stopWorkerThread.load(std::memory_order_relaxed))
+            {
+                return true;
+            }
+            std::this_thread::yield();
+        }
 
-        std::unique_lock<std::mutex>& _lock;
-    };
+        return false;
+    }
 
-    void WaitForAndProcessItems()
+    // Processes up to BatchSize items, returns false if there was nothing to process
+    bool ProcessBatch(IQueueItemHandler<QueueItem>& handler)
     {
-        std::unique_lock<std::mutex> lock(_mutex);
+        uint64_t count = 0;
+
+        while (count < BatchSize)
+        {
+            ItemNode* node = Unlink();
+            if (node == nullptr)
+            {
+                break;
+            }
+
+            try
+            {
+                handler.OnProcessQueueItem(node->item);
+            }
+            catch (...)
+            {
+                std::cerr << "Caught exception while processing async queue items.";
+            }
+
+            delete node;
+            ++count;
+        }
+
+        if (count == 0)
+        {
+            if (!HasPendingItems())
+            {
+                return false;
+            }
+
+            // A producer is half way through linking its item
+            std::this_thread::yield();
+            return true;
+        }
+
+        _processed.fetch_add(count);
 
-        std::shared_ptr<IQueueItemHandler<QueueItem>> handler = _handler;
+        // Let WaitForAll callers check whether their items are done
+        if (_drainWaiters.load() != 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+            }
+            _stateChanged.notify_all();
+        }
+
+        return true;
+    }
+
+    void WaitForAndProcessItems()
+    {
+        std::shared_ptr<IQueueItemHandler<QueueItem>> handler;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            handler = _handler;
+        }
         handler->OnStarted();
 
         for (;;)
         {
-            // Wait until either:
-            // - queue is not empty
-            // - worker thread has been asked to stop
-            _actionRequired.wait(lock, [this] { if (_items.empty()) _isEmpty.notify_all(); return (!_items.empty() || _stopWorkerThread); });
-            if (_stopWorkerThread)
+            if (_stopWorkerThread.load())
             {
                 break;
             }
 
-            // Move the items to a temporary queue
-            std::queue<QueueItem> items(std::move(_items));
-
-            // Process all queue items outside the lock, the UnlockGuard will re-lock on destruction
-            UnlockGuard unlock(lock);
-
-            while (!items.empty())
+            if (ProcessBatch(*handler) || SpinForItems())
             {
-                // Pop the next item off and notify the registered worker to process it
-                QueueItem item = std::move(items.front());
-                items.pop();
+                continue;
+            }
 
-                try
-                {
-                    handler->OnProcessQueueItem(item);
-                }
-                catch (...)
-                {
-                    std::cerr << "Caught exception while processing async queue items.";
-                }
+            // Wait until either:
+            // - queue is not empty
+            // - worker thread has been asked to stop
+            // The flag is raised again after every wake up, a producer may have cleared it.
+            std::unique_lock<std::mutex> lock(_mutex);
+            _consumerWaiting.store(true);
+            while (!HasPendingItems() && !_stopWorkerThread)
+            {
+                _itemsAvailable.wait(lock);
+                _consumerWaiting.store(true);
             }
+            _consumerWaiting.store(false);
         }
 
         try
@@ -226,9 +380,10 @@ private:
         }
 
         // Signal that the thread is done
+        std::lock_guard<std::mutex> lock(_mutex);
         _workerThreadStopped = true;
-        _actionRequired.notify_all();
-        //std::notify_all_at_thread_exit(_actionRequired, std::move(lock)); // This should replace the previous line but Android doesn't support it
+        _stateChanged.notify_all();
+        //std::notify_all_at_thread_exit(_stateChanged, std::move(lock)); // This should replace the previous line but Android doesn't support it
     }
 
     static void AsyncQueue_atexit_handler()
@@ -236,13 +391,22 @@ private:
         s_crtIsTerminating = true;
     }
 
-    std::queue<QueueItem> _items;
-    std::condition_variable _actionRequired;
-    std::condition_variable _isEmpty;
+    // Lock-free list, producers append at the head and the worker thread removes from the tail
+    Node _stub;
+    std::atomic<Node*> _head;
+    Node* _tail;
+
+    std::atomic<uint64_t> _pushed;
+    std::atomic<uint64_t> _processed;
+    std::atomic<bool> _consumerWaiting;
+    std::atomic<uint32_t> _drainWaiters;
+
+    std::condition_variable _itemsAvailable;
+    std::condition_variable _stateChanged;
     std::mutex _mutex;
     std::thread _workerThread;
-    bool _stopWorkerThread;
+    std::atomic<bool> _stopWorkerThread;
     bool _workerThreadStopped;
     std::shared_ptr<IQueueItemHandler<QueueItem>> _handler;
-    bool _isInitialized;
+    std::atomic<bool> _isInitialized;
 };
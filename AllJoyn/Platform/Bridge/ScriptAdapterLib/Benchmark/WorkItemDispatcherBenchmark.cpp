@@ -0,0 +1,354 @@
+//
+// Copyright (c) 2015, Microsoft Corporation
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+// IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+
+// Latency and throughput of WorkItemDispatcher compared to the mutex protected
+// std::queue of std::function it replaces.
+//
+// Standalone, build with:
+//   g++ -std=c++14 -O2 -pthread -I.. WorkItemDispatcherBenchmark.cpp -o WorkItemDispatcherBenchmark
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifndef _In_
+#define _In_
+#endif
+
+#include "WorkItemDispatcher.h"
+
+namespace
+{
+    std::atomic<uint64_t> g_allocCount(0);
+
+    typedef std::chrono::steady_clock Clock;
+
+    // The dispatcher before the lock-free queue : every push and pop takes the mutex,
+    // every work item is a std::function and waiting means waiting for the whole queue.
+    class LegacyDispatcher
+    {
+    public:
+        LegacyDispatcher() : _stop(false), _busy(false)
+        {
+            _thread = std::thread([this]
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                for (;;)
+                {
+                    _actionRequired.wait(lock, [this] { if (_items.empty()) _isEmpty.notify_all(); return !_items.empty() || _stop; });
+                    if (_stop)
+                    {
+                        break;
+                    }
+
+                    std::queue<std::function<void()>> items(std::move(_items));
+                    _busy = true;
+                    lock.unlock();
+                    while (!items.empty())
+                    {
+                        items.front()();
+                        items.pop();
+                    }
+                    lock.lock();
+                    _busy = false;
+                }
+            });
+        }
+
+        ~LegacyDispatcher()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _actionRequired.notify_all();
+            _thread.join();
+        }
+
+        bool Dispatch(std::function<void()>&& functor)
+        {
+            bool queueWasEmpty = false;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                queueWasEmpty = _items.empty();
+                _items.push(std::move(functor));
+            }
+            if (queueWasEmpty)
+            {
+                _actionRequired.notify_all();
+            }
+            return true;
+        }
+
+        bool DispatchAndWait(std::function<void()>&& functor)
+        {
+            Dispatch(std::move(functor));
+            WaitForAll();
+            return true;
+        }
+
+        void WaitForAll()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _isEmpty.wait(lock, [this] { return _items.empty() && !_busy; });
+        }
+
+    private:
+        std::queue<std::function<void()>> _items;
+        std::mutex _mutex;
+        std::condition_variable _actionRequired;
+        std::condition_variable _isEmpty;
+        std::thread _thread;
+        bool _stop;
+        bool _busy;
+    };
+
+    // A capture similar to the property getter lambdas of ScriptHost
+    struct PropertyCapture
+    {
+        std::string name;
+        std::shared_ptr<int> outParam;
+        std::function<void(uint32_t)> callback;
+    };
+
+    void Report(const char* name, std::vector<long long>& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        printf("%-44s p50 %8.2f us  p99 %8.2f us\n", name,
+            samples[samples.size() / 2] / 1000.0,
+            samples[samples.size() * 99 / 100] / 1000.0);
+    }
+
+    // Items per second over one run, and allocations per item
+    template <typename Dispatcher>
+    double ThroughputRun(Dispatcher& dispatcher, int producers, int itemsPerProducer, double& allocsPerItem)
+    {
+        std::atomic<uint64_t> processed(0);
+        PropertyCapture capture = { "temperature", std::make_shared<int>(0), [](uint32_t) {} };
+
+        g_allocCount = 0;
+        auto start = Clock::now();
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&]
+            {
+                for (int i = 0; i < itemsPerProducer; ++i)
+                {
+                    dispatcher.Dispatch([capture, &processed]
+                    {
+                        capture.callback(static_cast<uint32_t>(capture.name.size()));
+                        processed.fetch_add(1, std::memory_order_relaxed);
+                    });
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        dispatcher.DispatchAndWait([] {});
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        uint64_t total = static_cast<uint64_t>(producers) * itemsPerProducer;
+
+        allocsPerItem = static_cast<double>(g_allocCount) / total;
+        return processed == total ? total * 1000.0 / elapsed : 0;
+    }
+
+    // Median of several runs, a single run is at the mercy of the scheduler
+    template <typename Dispatcher>
+    void Throughput(const char* name, Dispatcher& dispatcher, int producers, int itemsPerProducer)
+    {
+        const int runs = 5;
+        std::vector<double> rates;
+        double allocsPerItem = 0;
+
+        for (int run = 0; run < runs; ++run)
+        {
+            rates.push_back(ThroughputRun(dispatcher, producers, itemsPerProducer, allocsPerItem));
+        }
+        std::sort(rates.begin(), rates.end());
+
+        printf("%-24s %d producer(s) : %8.2f Mitems/s %6.2f allocs/item%s\n", name, producers,
+            rates[runs / 2], allocsPerItem, rates[0] == 0 ? " (items lost!)" : "");
+    }
+
+    template <typename Dispatcher>
+    void RoundTrip(const char* name, Dispatcher& dispatcher, int iterations)
+    {
+        std::vector<long long> samples;
+        samples.reserve(iterations);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = Clock::now();
+            dispatcher.DispatchAndWait([] {});
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+
+        Report(name, samples);
+    }
+
+    // Several calls in flight before waiting for their results
+    void PipelinedRoundTrip(WorkItemDispatcher& dispatcher, int iterations, int depth)
+    {
+        std::vector<long long> samples;
+        std::vector<std::future<int>> results;
+        samples.reserve(iterations);
+        results.reserve(depth);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = Clock::now();
+            for (int d = 0; d < depth; ++d)
+            {
+                results.push_back(dispatcher.DispatchAsync([d] { return d; }));
+            }
+            for (auto& result : results)
+            {
+                result.get();
+            }
+            results.clear();
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / depth);
+        }
+
+        Report("WorkItemDispatcher futures x16 (per call)", samples);
+    }
+
+    // Several calls in flight, each reporting through a callback as the ScriptHost calls
+    // do, then waiting for the last one : the queue is FIFO so the others are done too.
+    void CallbackPipelinedRoundTrip(WorkItemDispatcher& dispatcher, int iterations, int depth)
+    {
+        std::vector<long long> samples;
+        std::vector<int> results(depth);
+        PropertyCapture capture = { "temperature", std::make_shared<int>(0), [](uint32_t) {} };
+        samples.reserve(iterations);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = Clock::now();
+            for (int d = 0; d < depth; ++d)
+            {
+                dispatcher.Dispatch([capture, &results, d]
+                {
+                    results[d] = d;
+                    capture.callback(0);
+                });
+            }
+            dispatcher.DispatchAndWait([] {});
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / depth);
+        }
+
+        Report("WorkItemDispatcher callbacks x16 (per call)", samples);
+    }
+
+    void LegacyPipelinedRoundTrip(LegacyDispatcher& dispatcher, int iterations, int depth)
+    {
+        std::vector<long long> samples;
+        std::vector<int> results(depth);
+        PropertyCapture capture = { "temperature", std::make_shared<int>(0), [](uint32_t) {} };
+        samples.reserve(iterations);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = Clock::now();
+            for (int d = 0; d < depth; ++d)
+            {
+                dispatcher.Dispatch([capture, &results, d]
+                {
+                    results[d] = d;
+                    capture.callback(0);
+                });
+            }
+            dispatcher.WaitForAll();
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / depth);
+        }
+
+        Report("std::queue callbacks x16 (per call)", samples);
+    }
+}
+
+// The counting allocator is kept out of line: once inlined next to a new expression,
+// GCC takes the std::free below for a mismatched deallocation.
+#if defined(_MSC_VER)
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+BENCHMARK_NOINLINE void* operator new(size_t size)
+{
+    ++g_allocCount;
+
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+BENCHMARK_NOINLINE void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+BENCHMARK_NOINLINE void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    const int itemsPerProducer = 200000;
+    const int iterations = 20000;
+
+    WorkItemDispatcher dispatcher;
+    dispatcher.Initialize();
+    {
+        LegacyDispatcher legacy;
+
+        for (int producers : { 1, 2, 4 })
+        {
+            Throughput("std::queue", legacy, producers, itemsPerProducer / producers);
+            Throughput("WorkItemDispatcher", dispatcher, producers, itemsPerProducer / producers);
+        }
+
+        RoundTrip("std::queue DispatchAndWait", legacy, iterations);
+        RoundTrip("WorkItemDispatcher DispatchAndWait", dispatcher, iterations);
+
+        LegacyPipelinedRoundTrip(legacy, iterations / 16, 16);
+        CallbackPipelinedRoundTrip(dispatcher, iterations / 16, 16);
+        PipelinedRoundTrip(dispatcher, iterations / 16, 16);
+    }
+    dispatcher.Shutdown();
+
+    return 0;
+}
@@ -12,34 +12,231 @@
 // WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
 // ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
 // IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
-//#pragma once
+//
+#pragma once
 #include "AsyncQueue.h"
 
-class WorkItemDispatcher
+// A move-only "void()" callable.
+// Functors that fit in InlineSize bytes (typically lambdas capturing a few strings,
+// shared pointers and a callback) are stored inline instead of on the heap.
+class WorkItem
 {
 public:
-    using WorkItemFunctorType = std::function<void()>;
+    static const size_t InlineSize = 128;
+
+    WorkItem() : _ops(nullptr) {}
+
+    template <typename Functor,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<Functor>::type, WorkItem>::value>::type>
+    WorkItem(Functor&& functor) : _ops(nullptr)
+    {
+        using FunctorType = typename std::decay<Functor>::type;
+        using Storage = typename std::conditional<IsInlinable<FunctorType>::value,
+            InlineStorage<FunctorType>, HeapStorage<FunctorType>>::type;
+
+        Storage::Create(&_storage, std::forward<Functor>(functor));
+        _ops = &Storage::Ops;
+    }
+
+    WorkItem(WorkItem&& other) noexcept : _ops(other._ops)
+    {
+        if (_ops != nullptr)
+        {
+            _ops->move(&other._storage, &_storage);
+            other._ops = nullptr;
+        }
+    }
+
+    WorkItem& operator=(WorkItem&& other)
+    {
+        if (this != &other)
+        {
+            Reset();
+            if (other._ops != nullptr)
+            {
+                other._ops->move(&other._storage, &_storage);
+                _ops = other._ops;
+                other._ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~WorkItem()
+    {
+        Reset();
+    }
+
+    void operator()()
+    {
+        _ops->invoke(&_storage);
+    }
+
+    explicit operator bool() const
+    {
+        return _ops != nullptr;
+    }
+
+private:
+    WorkItem(const WorkItem&) = delete;
+    WorkItem& operator=(const WorkItem&) = delete;
+
+    using StorageType = std::aligned_storage<InlineSize>::type;
+
+    struct Operations
+    {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to);
+        void (*destroy)(void* storage);
+    };
+
+    template <typename FunctorType>
+    struct IsInlinable : std::integral_constant<bool,
+        sizeof(FunctorType) <= sizeof(StorageType) &&
+        std::alignment_of<StorageType>::value % std::alignment_of<FunctorType>::value == 0 &&
+        std::is_nothrow_move_constructible<FunctorType>::value>
+    {
+    };
+
+    template <typename FunctorType>
+    struct InlineStorage
+    {
+        template <typename Functor>
+        static void Create(void* storage, Functor&& functor)
+        {
+            new (storage) FunctorType(std::forward<Functor>(functor));
+        }
+
+        static void Invoke(void* storage)
+        {
+            (*static_cast<FunctorType*>(storage))();
+        }
+
+        static void Move(void* from, void* to)
+        {
+            new (to) FunctorType(std::move(*static_cast<FunctorType*>(from)));
+            static_cast<FunctorType*>(from)->~FunctorType();
+        }
+
+        static void Destroy(void* storage)
+        {
+            static_cast<FunctorType*>(storage)->~FunctorType();
+        }
+
+        static const Operations Ops;
+    };
+
+    template <typename FunctorType>
+    struct HeapStorage
+    {
+        template <typename Functor>
+        static void Create(void* storage, Functor&& functor)
+        {
+            *static_cast<FunctorType**>(storage) = new FunctorType(std::forward<Functor>(functor));
+        }
 
+        static void Invoke(void* storage)
+        {
+            (**static_cast<FunctorType**>(storage))();
+        }
+
+        static void Move(void* from, void* to)
+        {
+            *static_cast<FunctorType**>(to) = *static_cast<FunctorType**>(from);
+        }
+
+        static void Destroy(void* storage)
+        {
+            delete *static_cast<FunctorType**>(storage);
+        }
+
+        static const Operations Ops;
+    };
+
+    void Reset()
+    {
+        if (_ops != nullptr)
+        {
+            _ops->destroy(&_storage);
+            _ops = nullptr;
+        }
+    }
+
+    StorageType _storage;
+    const Operations* _ops;
+};
+
+template <typename FunctorType>
+const WorkItem::Operations WorkItem::InlineStorage<FunctorType>::Ops =
+{
+    &WorkItem::InlineStorage<FunctorType>::Invoke,
+    &WorkItem::InlineStorage<FunctorType>::Move,
+    &WorkItem::InlineStorage<FunctorType>::Destroy
+};
+
+template <typename FunctorType>
+const WorkItem::Operations WorkItem::HeapStorage<FunctorType>::Ops =
+{
+    &WorkItem::HeapStorage<FunctorType>::Invoke,
+    &WorkItem::HeapStorage<FunctorType>::Move,
+    &WorkItem::HeapStorage<FunctorType>::Destroy
+};
+
+class WorkItemDispatcher
+{
+public:
     WorkItemDispatcher() { }
 
-    bool Dispatch(const WorkItemFunctorType& workItemFunctor)
+    // Queues a functor for execution on the dispatcher thread.
+    // Empty std::function objects are ignored.
+    template <typename Functor>
+    bool Dispatch(Functor&& workItemFunctor)
     {
-        return workItemFunctor == nullptr || _asyncQueue.Push(workItemFunctor);
+        return IsEmpty(workItemFunctor) || _asyncQueue.Push(std::forward<Functor>(workItemFunctor));
     }
 
-    bool Dispatch(WorkItemFunctorType&& workItemFunctor)
+    // Queues a functor for execution on the dispatcher thread and returns a future for its result.
+    // Exceptions thrown by the functor are stored in the future. If the dispatcher is not
+    // initialized or is shut down before the functor runs, the future reports a broken promise.
+    // This lets callers issue several calls before waiting for any of them. The future's
+    // shared state costs an allocation and a wake up per call, so callers that report
+    // through a callback, as ScriptHost does, are better served by Dispatch.
+    template <typename Functor>
+    std::future<typename std::result_of<typename std::decay<Functor>::type()>::type> DispatchAsync(Functor&& workItemFunctor)
     {
-        return workItemFunctor == nullptr || _asyncQueue.Push(std::move(workItemFunctor));
+        using ResultType = typename std::result_of<typename std::decay<Functor>::type()>::type;
+
+        AsyncWorkItem<typename std::decay<Functor>::type, ResultType> workItem(std::forward<Functor>(workItemFunctor));
+        auto result = workItem.promise.get_future();
+        _asyncQueue.Push(std::move(workItem));
+        return result;
     }
 
-    bool DispatchAndWait(WorkItemFunctorType&& workItemFunctor)
+    // Runs a functor on the dispatcher thread and waits for it to complete.
+    // Must not be called from the dispatcher thread.
+    template <typename Functor>
+    bool DispatchAndWait(Functor&& workItemFunctor)
     {
-        bool ret = workItemFunctor == nullptr || _asyncQueue.Push(std::move(workItemFunctor));
-        if (ret)
+        if (IsEmpty(workItemFunctor))
+        {
+            return true;
+        }
+
+        auto result = DispatchAsync(std::forward<Functor>(workItemFunctor));
+        try
+        {
+            result.get();
+        }
+        catch (const std::future_error&)
+        {
+            // the work item has not been queued or has been dropped on shutdown
+            return false;
+        }
+        catch (...)
         {
-            _asyncQueue.WaitForAll();
+            std::cerr << "Caught exception while processing async queue items.";
         }
-        return ret;
+        return true;
     }
 
     void Shutdown()
@@ -56,16 +253,62 @@ public:
 
 private:
 
-    class QueueItemHandler final : public IQueueItemHandler<WorkItemFunctorType>
+    template <typename Functor>
+    static bool IsEmpty(const Functor&)
+    {
+        return false;
+    }
+
+    template <typename Signature>
+    static bool IsEmpty(const std::function<Signature>& functor)
+    {
+        return functor == nullptr;
+    }
+
+    template <typename FunctorType, typename ResultType>
+    struct AsyncWorkItem
+    {
+        template <typename Functor>
+        explicit AsyncWorkItem(Functor&& workItemFunctor) : functor(std::forward<Functor>(workItemFunctor)) {}
+
+        void operator()()
+        {
+            try
+            {
+                SetResult(promise, functor);
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        template <typename Result>
+        static void SetResult(std::promise<Result>& promise, FunctorType& functor)
+        {
+            promise.set_value(functor());
+        }
+
+        static void SetResult(std::promise<void>& promise, FunctorType& functor)
+        {
+            functor();
+            promise.set_value();
+        }
+
+        FunctorType functor;
+        std::promise<ResultType> promise;
+    };
+
+    class QueueItemHandler final : public IQueueItemHandler<WorkItem>
     {
     public:
         QueueItemHandler() {}
         ~QueueItemHandler() {}
 
         void OnStarted() override {}
-        void OnProcessQueueItem(_In_ WorkItemFunctorType& workItemFunctor) override { workItemFunctor(); }
+        void OnProcessQueueItem(_In_ WorkItem& workItem) override { workItem(); }
         void OnStopped() override {}
     };
 
-    AsyncQueue<WorkItemFunctorType> _asyncQueue;
+    AsyncQueue<WorkItem> _asyncQueue;
 };
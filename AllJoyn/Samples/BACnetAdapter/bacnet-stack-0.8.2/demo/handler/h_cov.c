@@ -25,6 +25,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include "config.h"
@@ -40,6 +41,7 @@
 #include "cov.h"
 #include "tsm.h"
 #include "dcc.h"
+#include "keylist.h"
 #if PRINT_ENABLED
 #include "bactext.h"
 #endif
@@ -49,10 +51,18 @@
 
 /** @file h_cov.c  Handles Change of Value (COV) services. */
 
-typedef struct BACnet_COV_Address {
-    bool valid:1;
-    BACNET_ADDRESS dest;
-} BACNET_COV_ADDRESS;
+/* The subscriptions are kept in an array that grows as subscribers come,
+   and are linked three ways so that no service walks all of them:
+   - a hash of subscriber address, process identifier and monitored object,
+     to find the subscription a SubscribeCOV request refers to,
+   - a list per monitored object, the objects kept in a Keylist, so that
+     a change of value is checked once per object, and its value list is
+     encoded once for all of the subscribers to the object,
+   - a wheel of one second slots, so that handler_cov_timer_seconds() only
+     visits the subscriptions whose lifetime may have run out. */
+
+/* end of a list of subscriptions */
+#define COV_NONE (-1)
 
 /* note: This COV service only monitors the properties
    of an object that have been specified in the standard.  */
@@ -62,118 +72,454 @@ typedef struct BACnet_COV_Subscription_Flags {
     bool send_requested:1;
 } BACNET_COV_SUBSCRIPTION_FLAGS;
 
+struct BACnet_COV_Object;
+
 typedef struct BACnet_COV_Subscription {
     BACNET_COV_SUBSCRIPTION_FLAGS flag;
-    uint8_t dest_index;
     uint8_t invokeID;   /* for confirmed COV */
+    BACNET_ADDRESS dest;
     uint32_t subscriberProcessIdentifier;
-    uint32_t lifetime;  /* optional */
+    uint32_t lifetime;  /* optional - zero for an indefinite lifetime */
+    uint32_t expires;   /* COV_Seconds when the lifetime runs out */
     BACNET_OBJECT_ID monitoredObjectIdentifier;
+    struct BACnet_COV_Object *object;
+    uint32_t hash;      /* of subscriber and monitored object */
+    int next_hash;      /* in the hash bucket, or in the free list */
+    int next_object;
+    int prev_object;
+    int next_timer;
+    int prev_timer;
 } BACNET_COV_SUBSCRIPTION;
 
+/* a monitored object, and the subscriptions to it */
+typedef struct BACnet_COV_Object {
+    BACNET_OBJECT_ID objectIdentifier;
+    int subscriptions;  /* first subscription, or COV_NONE */
+    bool pending;       /* queued for handler_cov_task() to notify */
+    struct BACnet_COV_Object *next_pending;
+} BACNET_COV_OBJECT;
+
 #ifndef MAX_COV_SUBCRIPTIONS
-#define MAX_COV_SUBCRIPTIONS 128
+#define MAX_COV_SUBCRIPTIONS 65535
 #endif
-static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBCRIPTIONS];
-#ifndef MAX_COV_ADDRESSES
-#define MAX_COV_ADDRESSES 16
+/* monitored objects checked for a change of value per handler_cov_task() */
+#ifndef MAX_COV_TASK_OBJECTS
+#define MAX_COV_TASK_OBJECTS 256
 #endif
-static BACNET_COV_ADDRESS COV_Addresses[MAX_COV_ADDRESSES];
+/* one second slots of the lifetime timer wheel - a power of two */
+#ifndef COV_TIMER_SLOTS
+#define COV_TIMER_SLOTS 256
+#endif
+
+static BACNET_COV_SUBSCRIPTION *COV_Subscriptions;
+static int COV_Subscriptions_Size;
+static int COV_Subscriptions_Count;
+static int COV_Subscriptions_Free = COV_NONE;
+/* subscriber hash buckets - a power of two */
+static int *COV_Subscriber_Hash;
+static unsigned COV_Subscriber_Buckets;
+/* monitored objects, by KEY_ENCODE(type, instance) */
+static OS_Keylist COV_Objects;
+static int COV_Objects_Cursor;
+/* monitored objects with notifications to send */
+static BACNET_COV_OBJECT *COV_Pending_Head;
+static BACNET_COV_OBJECT *COV_Pending_Tail;
+static int COV_Timer_Wheel[COV_TIMER_SLOTS];
+static uint32_t COV_Seconds;
+static bool COV_Initialized;
+
+static uint32_t cov_hash_bytes(
+    uint32_t hash,
+    const uint8_t * data,
+    unsigned len)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+static uint32_t cov_hash_unsigned(
+    uint32_t hash,
+    uint32_t value)
+{
+    uint8_t buffer[4];
+
+    buffer[0] = (uint8_t) (value >> 24);
+    buffer[1] = (uint8_t) (value >> 16);
+    buffer[2] = (uint8_t) (value >> 8);
+    buffer[3] = (uint8_t) value;
+
+    return cov_hash_bytes(hash, buffer, sizeof(buffer));
+}
 
 /**
-* Gets the address from the list of COV addresses
+* Hashes a subscriber and the object it monitors. Addresses that
+* bacnet_address_same() finds the same hash the same.
 *
-* @param  index - offset into COV address list where address is stored
-* @param  dest - address to be filled when found
+* @param  src - address of the subscriber
+* @param  pid - subscriber process identifier
+* @param  object_id - the monitored object
 *
-* @return true if valid address, false if not valid or not found
+* @return the hash
 */
-static BACNET_ADDRESS *cov_address_get(
-    int index)
+static uint32_t cov_subscriber_hash(
+    BACNET_ADDRESS * src,
+    uint32_t pid,
+    BACNET_OBJECT_ID * object_id)
 {
-    BACNET_ADDRESS *cov_dest = NULL;
+    uint32_t hash = 2166136261UL;
+    uint8_t len = 0;
 
-    if (index < MAX_COV_ADDRESSES) {
-        if (COV_Addresses[index].valid) {
-            cov_dest = &COV_Addresses[index].dest;
-        }
+    hash = cov_hash_unsigned(hash, ((uint32_t) src->net << 8) | src->len);
+    len = src->len > MAX_MAC_LEN ? MAX_MAC_LEN : src->len;
+    hash = cov_hash_bytes(hash, &src->adr[0], len);
+    if (src->net == 0) {
+        len = src->mac_len > MAX_MAC_LEN ? MAX_MAC_LEN : src->mac_len;
+        hash = cov_hash_unsigned(hash, src->mac_len);
+        hash = cov_hash_bytes(hash, &src->mac[0], len);
     }
+    hash = cov_hash_unsigned(hash, pid);
+    hash =
+        cov_hash_unsigned(hash, KEY_ENCODE(object_id->type,
+            object_id->instance));
 
-    return cov_dest;
+    return hash;
 }
 
 /**
- * Removes the address from the list of COV addresses, if it is not
- * used by other COV subscriptions
- */
-static void cov_address_remove_unused(
+* Grows the list of subscriptions, and rehashes it if the number of
+* hash buckets changes
+*
+* @return true if there is room for more subscriptions
+*/
+static bool cov_subscriptions_grow(
     void)
 {
-    unsigned index = 0;
-    unsigned cov_index = 0;
-    bool found = false;
-
-    for (cov_index = 0; cov_index < MAX_COV_ADDRESSES; cov_index++) {
-        if (COV_Addresses[cov_index].valid) {
-            found = false;
-            for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-                if ((COV_Subscriptions[index].flag.valid) &&
-                    (COV_Subscriptions[index].dest_index == cov_index)) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                COV_Addresses[cov_index].valid = false;
+    BACNET_COV_SUBSCRIPTION *subscriptions = NULL;
+    int *buckets = NULL;
+    unsigned bucket_count = 16;
+    unsigned bucket = 0;
+    int size = 0;
+    int index = 0;
+
+    if (COV_Subscriptions_Size >= MAX_COV_SUBCRIPTIONS) {
+        return false;
+    }
+    size = COV_Subscriptions_Size ? COV_Subscriptions_Size * 2 : 16;
+    if (size > MAX_COV_SUBCRIPTIONS) {
+        size = MAX_COV_SUBCRIPTIONS;
+    }
+    subscriptions =
+        realloc(COV_Subscriptions, size * sizeof(BACNET_COV_SUBSCRIPTION));
+    if (!subscriptions) {
+        return false;
+    }
+    COV_Subscriptions = subscriptions;
+    while (bucket_count < (unsigned) size) {
+        bucket_count <<= 1;
+    }
+    if (bucket_count != COV_Subscriber_Buckets) {
+        buckets = malloc(bucket_count * sizeof(int));
+        if (!buckets) {
+            return false;
+        }
+        free(COV_Subscriber_Hash);
+        COV_Subscriber_Hash = buckets;
+        COV_Subscriber_Buckets = bucket_count;
+        for (bucket = 0; bucket < bucket_count; bucket++) {
+            buckets[bucket] = COV_NONE;
+        }
+        for (index = 0; index < COV_Subscriptions_Size; index++) {
+            if (COV_Subscriptions[index].flag.valid) {
+                bucket = COV_Subscriptions[index].hash & (bucket_count - 1);
+                COV_Subscriptions[index].next_hash = buckets[bucket];
+                buckets[bucket] = index;
             }
         }
     }
+    /* the lowest new index is the first to be used */
+    for (index = size - 1; index >= COV_Subscriptions_Size; index--) {
+        memset(&COV_Subscriptions[index], 0, sizeof(BACNET_COV_SUBSCRIPTION));
+        COV_Subscriptions[index].next_hash = COV_Subscriptions_Free;
+        COV_Subscriptions_Free = index;
+    }
+    COV_Subscriptions_Size = size;
+
+    return true;
+}
+
+/**
+* Takes a subscription off the free list, growing the list if needed
+*
+* @return index of the subscription, or COV_NONE if out of memory
+*/
+static int cov_subscription_alloc(
+    void)
+{
+    int index = COV_NONE;
+
+    if ((COV_Subscriptions_Free == COV_NONE) && !cov_subscriptions_grow()) {
+        return COV_NONE;
+    }
+    index = COV_Subscriptions_Free;
+    COV_Subscriptions_Free = COV_Subscriptions[index].next_hash;
+    memset(&COV_Subscriptions[index], 0, sizeof(BACNET_COV_SUBSCRIPTION));
+    COV_Subscriptions[index].next_hash = COV_NONE;
+    COV_Subscriptions[index].next_object = COV_NONE;
+    COV_Subscriptions[index].prev_object = COV_NONE;
+    COV_Subscriptions[index].next_timer = COV_NONE;
+    COV_Subscriptions[index].prev_timer = COV_NONE;
+    COV_Subscriptions_Count++;
+
+    return index;
+}
+
+/**
+* Finds the subscription of a subscriber to an object
+*
+* @param  hash - cov_subscriber_hash() of the subscriber and object
+* @param  src - address of the subscriber
+* @param  cov_data - process identifier and monitored object
+*
+* @return index of the subscription, or COV_NONE if not found
+*/
+static int cov_subscription_find(
+    uint32_t hash,
+    BACNET_ADDRESS * src,
+    BACNET_SUBSCRIBE_COV_DATA * cov_data)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+    int index = COV_NONE;
+
+    if (!COV_Subscriber_Buckets) {
+        return COV_NONE;
+    }
+    index = COV_Subscriber_Hash[hash & (COV_Subscriber_Buckets - 1)];
+    while (index != COV_NONE) {
+        cov_subscription = &COV_Subscriptions[index];
+        if ((cov_subscription->hash == hash) &&
+            (cov_subscription->subscriberProcessIdentifier ==
+                cov_data->subscriberProcessIdentifier) &&
+            (cov_subscription->monitoredObjectIdentifier.type ==
+                cov_data->monitoredObjectIdentifier.type) &&
+            (cov_subscription->monitoredObjectIdentifier.instance ==
+                cov_data->monitoredObjectIdentifier.instance) &&
+            bacnet_address_same(src, &cov_subscription->dest)) {
+            break;
+        }
+        index = cov_subscription->next_hash;
+    }
+
+    return index;
 }
 
 /**
-* Adds the address to the list of COV addresses
+* Puts a subscription with a definite lifetime on the timer wheel
 *
-* @param  dest - address to be added if there is room in the list
+* @param  index - the subscription
+*/
+static void cov_timer_add(
+    int index)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+    unsigned slot = 0;
+
+    cov_subscription->next_timer = COV_NONE;
+    cov_subscription->prev_timer = COV_NONE;
+    if (cov_subscription->lifetime) {
+        cov_subscription->expires = COV_Seconds + cov_subscription->lifetime;
+        slot = cov_subscription->expires & (COV_TIMER_SLOTS - 1);
+        cov_subscription->next_timer = COV_Timer_Wheel[slot];
+        if (cov_subscription->next_timer != COV_NONE) {
+            COV_Subscriptions[cov_subscription->next_timer].prev_timer = index;
+        }
+        COV_Timer_Wheel[slot] = index;
+    }
+}
+
+/**
+* Takes a subscription off the timer wheel
 *
-* @return index number 0..N, or -1 if unable to add
+* @param  index - the subscription
 */
-static int cov_address_add(
-    BACNET_ADDRESS * dest)
+static void cov_timer_remove(
+    int index)
 {
-    int index = -1;
-    unsigned i = 0;
-    bool found = false;
-    bool valid = false;
-    BACNET_ADDRESS *cov_dest = NULL;
-
-    if (dest) {
-        for (i = 0; i < MAX_COV_ADDRESSES; i++) {
-            valid = COV_Addresses[i].valid;
-            if (valid) {
-                cov_dest = &COV_Addresses[i].dest;
-                found = bacnet_address_same(dest, cov_dest);
-                if (found) {
-                    index = i;
-                    break;
-                }
-            }
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+
+    if (cov_subscription->lifetime) {
+        if (cov_subscription->prev_timer != COV_NONE) {
+            COV_Subscriptions[cov_subscription->prev_timer].next_timer =
+                cov_subscription->next_timer;
+        } else {
+            COV_Timer_Wheel[cov_subscription->expires & (COV_TIMER_SLOTS -
+                    1)] = cov_subscription->next_timer;
         }
-        if (!found) {
-            /* find a free place to add a new address */
-            for (i = 0; i < MAX_COV_ADDRESSES; i++) {
-                valid = COV_Addresses[i].valid;
-                if (!valid) {
-                    index = i;
-                    cov_dest = &COV_Addresses[i].dest;
-                    bacnet_address_copy(cov_dest, dest);
-                    COV_Addresses[i].valid = true;
-                    break;
-                }
+        if (cov_subscription->next_timer != COV_NONE) {
+            COV_Subscriptions[cov_subscription->next_timer].prev_timer =
+                cov_subscription->prev_timer;
+        }
+    }
+}
+
+/**
+* Gets the time remaining of a subscription
+*
+* @param  cov_subscription - the subscription
+*
+* @return seconds until the lifetime runs out, or 0 if it is indefinite
+*/
+static uint32_t cov_time_remaining(
+    BACNET_COV_SUBSCRIPTION * cov_subscription)
+{
+    if (cov_subscription->lifetime) {
+        return cov_subscription->expires - COV_Seconds;
+    }
+
+    return 0;
+}
+
+/**
+* Gets the monitored object, adding it to the list of monitored objects
+*
+* @param  object_id - the object
+*
+* @return the monitored object, or NULL if out of memory
+*/
+static BACNET_COV_OBJECT *cov_object_add(
+    BACNET_OBJECT_ID * object_id)
+{
+    BACNET_COV_OBJECT *object = NULL;
+    KEY key = KEY_ENCODE(object_id->type, object_id->instance);
+
+    object = Keylist_Data(COV_Objects, key);
+    if (!object) {
+        object = calloc(1, sizeof(BACNET_COV_OBJECT));
+        if (object) {
+            object->objectIdentifier = *object_id;
+            object->subscriptions = COV_NONE;
+            if (Keylist_Data_Add(COV_Objects, key, object) < 0) {
+                free(object);
+                object = NULL;
             }
         }
     }
 
-    return index;
+    return object;
+}
+
+/**
+* Removes the object from the list of monitored objects,
+* if there are no subscriptions to it
+*
+* @param  object - the monitored object
+*/
+static void cov_object_remove_unused(
+    BACNET_COV_OBJECT * object)
+{
+    if (object->subscriptions == COV_NONE) {
+        (void) Keylist_Data_Delete(COV_Objects,
+            KEY_ENCODE(object->objectIdentifier.type,
+                object->objectIdentifier.instance));
+        /* handler_cov_task() frees an object it has queued */
+        if (!object->pending) {
+            free(object);
+        }
+    }
+}
+
+/**
+* Queues the object for handler_cov_task() to send its notifications
+*
+* @param  object - the monitored object
+*/
+static void cov_object_queue(
+    BACNET_COV_OBJECT * object)
+{
+    if (!object->pending) {
+        object->pending = true;
+        object->next_pending = NULL;
+        if (COV_Pending_Tail) {
+            COV_Pending_Tail->next_pending = object;
+        } else {
+            COV_Pending_Head = object;
+        }
+        COV_Pending_Tail = object;
+    }
+}
+
+/**
+* Links a new subscription into the subscriber hash, the list of its
+* monitored object and the timer wheel
+*
+* @param  index - the subscription
+* @param  object - its monitored object
+*/
+static void cov_subscription_link(
+    int index,
+    BACNET_COV_OBJECT * object)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+    unsigned bucket = cov_subscription->hash & (COV_Subscriber_Buckets - 1);
+
+    cov_subscription->next_hash = COV_Subscriber_Hash[bucket];
+    COV_Subscriber_Hash[bucket] = index;
+    cov_subscription->object = object;
+    cov_subscription->prev_object = COV_NONE;
+    cov_subscription->next_object = object->subscriptions;
+    if (object->subscriptions != COV_NONE) {
+        COV_Subscriptions[object->subscriptions].prev_object = index;
+    }
+    object->subscriptions = index;
+    cov_timer_add(index);
+}
+
+/**
+* Removes a subscription, and its monitored object if it was the
+* last subscription to it
+*
+* @param  index - the subscription
+*/
+static void cov_subscription_remove(
+    int index)
+{
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+    BACNET_COV_OBJECT *object = cov_subscription->object;
+    int *link = NULL;
+
+    link =
+        &COV_Subscriber_Hash[cov_subscription->hash &
+        (COV_Subscriber_Buckets - 1)];
+    while (*link != index) {
+        link = &COV_Subscriptions[*link].next_hash;
+    }
+    *link = cov_subscription->next_hash;
+    if (cov_subscription->prev_object != COV_NONE) {
+        COV_Subscriptions[cov_subscription->prev_object].next_object =
+            cov_subscription->next_object;
+    } else {
+        object->subscriptions = cov_subscription->next_object;
+    }
+    if (cov_subscription->next_object != COV_NONE) {
+        COV_Subscriptions[cov_subscription->next_object].prev_object =
+            cov_subscription->prev_object;
+    }
+    cov_timer_remove(index);
+    if (cov_subscription->invokeID) {
+        tsm_free_invoke_id(cov_subscription->invokeID);
+        cov_subscription->invokeID = 0;
+    }
+    cov_subscription->flag.valid = false;
+    cov_subscription->object = NULL;
+    cov_subscription->next_hash = COV_Subscriptions_Free;
+    COV_Subscriptions_Free = index;
+    COV_Subscriptions_Count--;
+    cov_object_remove_unused(object);
 }
 
 /*
@@ -203,6 +549,9 @@ TimeRemaining [3] Unsigned,
 COVIncrement [4] REAL OPTIONAL
 */
 
+/* largest encoding of a BACnetCOVSubscription */
+#define COV_SUBSCRIPTION_APDU_MAX 64
+
 static int cov_encode_subscription(
     uint8_t * apdu,
     int max_apdu,
@@ -219,10 +568,7 @@ static int cov_encode_subscription(
     if (!cov_subscription) {
         return 0;
     }
-    dest = cov_address_get(cov_subscription->dest_index);
-    if (!dest) {
-        return 0;
-    }
+    dest = &cov_subscription->dest;
     /* Recipient [0] BACnetRecipientProcess - opening */
     len = encode_opening_tag(&apdu[apdu_len], 0);
     apdu_len += len;
@@ -283,7 +629,7 @@ static int cov_encode_subscription(
     /* TimeRemaining [3] Unsigned, */
     len =
         encode_context_unsigned(&apdu[apdu_len], 3,
-        cov_subscription->lifetime);
+        cov_time_remaining(cov_subscription));
     apdu_len += len;
 
     return apdu_len;
@@ -294,7 +640,6 @@ static int cov_encode_subscription(
  *  Invoked by a request to read the Device object's PROP_ACTIVE_COV_SUBSCRIPTIONS.
  *  Loops through the list of COV Subscriptions, and, for each valid one,
  *  adds its description to the APDU.
- *  @note This function needs some work to better handle buffer overruns.
  *  @param apdu [out] Buffer in which the APDU contents are built.
  *  @param max_apdu [in] Max length of the APDU buffer.
  *  @return How many bytes were encoded in the buffer, or -2 if the response
@@ -304,21 +649,23 @@ int handler_cov_encode_subscriptions(
     uint8_t * apdu,
     int max_apdu)
 {
+    uint8_t buffer[COV_SUBSCRIPTION_APDU_MAX];
     int len = 0;
     int apdu_len = 0;
-    unsigned index = 0;
+    int index = 0;
 
     if (apdu) {
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
+        for (index = 0; index < COV_Subscriptions_Size; index++) {
             if (COV_Subscriptions[index].flag.valid) {
+                /* encode aside, so that the buffer is never overrun */
                 len =
-                    cov_encode_subscription(&apdu[apdu_len],
-                    max_apdu - apdu_len, &COV_Subscriptions[index]);
-                apdu_len += len;
-                /* TODO: too late here to notice that we overran the buffer */
-                if (apdu_len > max_apdu) {
+                    cov_encode_subscription(&buffer[0], sizeof(buffer),
+                    &COV_Subscriptions[index]);
+                if ((apdu_len + len) > max_apdu) {
                     return -2;
                 }
+                memcpy(&apdu[apdu_len], &buffer[0], len);
+                apdu_len += len;
             }
         }
     }
@@ -326,29 +673,45 @@ int handler_cov_encode_subscriptions(
     return apdu_len;
 }
 
-/** Handler to initialize the COV list, clearing and disabling each entry.
+/** Handler to initialize the COV list, removing all subscriptions.
  * @ingroup DSCOV
  */
 void handler_cov_init(
     void)
 {
-    unsigned index = 0;
+    BACNET_COV_OBJECT *object = NULL;
+    BACNET_COV_OBJECT *next = NULL;
+    unsigned slot = 0;
 
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        COV_Subscriptions[index].flag.valid = false;
-        COV_Subscriptions[index].dest_index = -1;
-        COV_Subscriptions[index].subscriberProcessIdentifier = 0;
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
-            OBJECT_ANALOG_INPUT;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance = 0;
-        COV_Subscriptions[index].flag.issueConfirmedNotifications = false;
-        COV_Subscriptions[index].invokeID = 0;
-        COV_Subscriptions[index].lifetime = 0;
-        COV_Subscriptions[index].flag.send_requested = false;
+    /* queued objects that lost their last subscription */
+    for (object = COV_Pending_Head; object; object = next) {
+        next = object->next_pending;
+        if (object->subscriptions == COV_NONE) {
+            free(object);
+        }
+    }
+    COV_Pending_Head = NULL;
+    COV_Pending_Tail = NULL;
+    if (COV_Objects) {
+        while ((object = Keylist_Data_Pop(COV_Objects)) != NULL) {
+            free(object);
+        }
+    } else {
+        COV_Objects = Keylist_Create();
     }
-    for (index = 0; index < MAX_COV_ADDRESSES; index++) {
-        COV_Addresses[index].valid = false;
+    COV_Objects_Cursor = 0;
+    free(COV_Subscriptions);
+    COV_Subscriptions = NULL;
+    COV_Subscriptions_Size = 0;
+    COV_Subscriptions_Count = 0;
+    COV_Subscriptions_Free = COV_NONE;
+    free(COV_Subscriber_Hash);
+    COV_Subscriber_Hash = NULL;
+    COV_Subscriber_Buckets = 0;
+    for (slot = 0; slot < COV_TIMER_SLOTS; slot++) {
+        COV_Timer_Wheel[slot] = COV_NONE;
     }
+    COV_Initialized = true;
 }
 
 static bool cov_list_subscribe(
@@ -357,90 +720,78 @@ static bool cov_list_subscribe(
     BACNET_ERROR_CLASS * error_class,
     BACNET_ERROR_CODE * error_code)
 {
-    bool existing_entry = false;
-    int index;
-    int first_invalid_index = -1;
-    bool found = true;
-    bool address_match = false;
-    BACNET_ADDRESS *dest = NULL;
-
-    /* unable to subscribe - resources? */
-    /* unable to cancel subscription - other? */
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+    BACNET_COV_OBJECT *object = NULL;
+    uint32_t hash = 0;
+    int index = COV_NONE;
 
+    if (!COV_Initialized) {
+        handler_cov_init();
+    }
     /* existing? - match Object ID and Process ID and address */
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        if (COV_Subscriptions[index].flag.valid) {
-            dest = cov_address_get(COV_Subscriptions[index].dest_index);
-            if (dest) {
-                address_match = bacnet_address_same(src, dest);
-            } else {
-                /* skip address matching - we don't have an address */
-                address_match = true;
-            }
-            if ((COV_Subscriptions[index].monitoredObjectIdentifier.type ==
-                    cov_data->monitoredObjectIdentifier.type) &&
-                (COV_Subscriptions[index].monitoredObjectIdentifier.instance ==
-                    cov_data->monitoredObjectIdentifier.instance) &&
-                (COV_Subscriptions[index].subscriberProcessIdentifier ==
-                    cov_data->subscriberProcessIdentifier) && address_match) {
-                existing_entry = true;
-                if (cov_data->cancellationRequest) {
-                    COV_Subscriptions[index].flag.valid = false;
-                    COV_Subscriptions[index].dest_index = -1;
-                    cov_address_remove_unused();
-                } else {
-                    COV_Subscriptions[index].dest_index = cov_address_add(src);
-                    COV_Subscriptions[index].flag.issueConfirmedNotifications =
-                        cov_data->issueConfirmedNotifications;
-                    COV_Subscriptions[index].lifetime = cov_data->lifetime;
-                    COV_Subscriptions[index].flag.send_requested = true;
-                }
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-                break;
-            }
+    hash =
+        cov_subscriber_hash(src, cov_data->subscriberProcessIdentifier,
+        &cov_data->monitoredObjectIdentifier);
+    index = cov_subscription_find(hash, src, cov_data);
+    if (index != COV_NONE) {
+        cov_subscription = &COV_Subscriptions[index];
+        if (cov_subscription->invokeID) {
+            tsm_free_invoke_id(cov_subscription->invokeID);
+            cov_subscription->invokeID = 0;
+        }
+        if (cov_data->cancellationRequest) {
+            cov_subscription_remove(index);
         } else {
-            if (first_invalid_index < 0) {
-                first_invalid_index = index;
-            }
+            cov_subscription->flag.issueConfirmedNotifications =
+                cov_data->issueConfirmedNotifications;
+            cov_timer_remove(index);
+            cov_subscription->lifetime = cov_data->lifetime;
+            cov_timer_add(index);
+            cov_subscription->flag.send_requested = true;
+            cov_object_queue(cov_subscription->object);
         }
+        return true;
     }
-    if (!existing_entry && (first_invalid_index >= 0) &&
-        (!cov_data->cancellationRequest)) {
-        index = first_invalid_index;
-        found = true;
-        COV_Subscriptions[index].flag.valid = true;
-        COV_Subscriptions[index].dest_index = cov_address_add(src);
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
-            cov_data->monitoredObjectIdentifier.type;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance =
-            cov_data->monitoredObjectIdentifier.instance;
-        COV_Subscriptions[index].subscriberProcessIdentifier =
-            cov_data->subscriberProcessIdentifier;
-        COV_Subscriptions[index].flag.issueConfirmedNotifications =
-            cov_data->issueConfirmedNotifications;
-        COV_Subscriptions[index].invokeID = 0;
-        COV_Subscriptions[index].lifetime = cov_data->lifetime;
-        COV_Subscriptions[index].flag.send_requested = true;
-    } else if (!existing_entry) {
-        if (first_invalid_index < 0) {
-            /* Out of resources */
-            *error_class = ERROR_CLASS_RESOURCES;
-            *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
-            found = false;
-        } else {
-            /* cancellationRequest - valid object not subscribed */
-            /* From BACnet Standard 135-2010-13.14.2
-               ...Cancellations that are issued for which no matching COV
-               context can be found shall succeed as if a context had
-               existed, returning 'Result(+)'. */
-            found = true;
+    if (cov_data->cancellationRequest) {
+        /* cancellationRequest - valid object not subscribed */
+        /* From BACnet Standard 135-2010-13.14.2
+           ...Cancellations that are issued for which no matching COV
+           context can be found shall succeed as if a context had
+           existed, returning 'Result(+)'. */
+        return true;
+    }
+    object = cov_object_add(&cov_data->monitoredObjectIdentifier);
+    if (object) {
+        index = cov_subscription_alloc();
+        if (index == COV_NONE) {
+            cov_object_remove_unused(object);
         }
     }
+    if (index == COV_NONE) {
+        /* Out of resources */
+        *error_class = ERROR_CLASS_RESOURCES;
+        *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
+        return false;
+    }
+    cov_subscription = &COV_Subscriptions[index];
+    cov_subscription->flag.valid = true;
+    bacnet_address_copy(&cov_subscription->dest, src);
+    cov_subscription->monitoredObjectIdentifier.type =
+        cov_data->monitoredObjectIdentifier.type;
+    cov_subscription->monitoredObjectIdentifier.instance =
+        cov_data->monitoredObjectIdentifier.instance;
+    cov_subscription->subscriberProcessIdentifier =
+        cov_data->subscriberProcessIdentifier;
+    cov_subscription->flag.issueConfirmedNotifications =
+        cov_data->issueConfirmedNotifications;
+    cov_subscription->invokeID = 0;
+    cov_subscription->lifetime = cov_data->lifetime;
+    cov_subscription->hash = hash;
+    cov_subscription_link(index, object);
+    cov_subscription->flag.send_requested = true;
+    cov_object_queue(object);
 
-    return found;
+    return true;
 }
 
 static bool cov_send_request(
@@ -466,13 +817,7 @@ static bool cov_send_request(
     if (!cov_subscription) {
         return status;
     }
-    dest = cov_address_get(cov_subscription->dest_index);
-    if (!dest) {
-#if PRINT_ENABLED
-        fprintf(stderr, "COVnotification: dest not found!\n");
-#endif
-        return status;
-    }
+    dest = &cov_subscription->dest;
     datalink_get_my_address(&my_address);
     npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
     pdu_len =
@@ -486,7 +831,7 @@ static bool cov_send_request(
         cov_subscription->monitoredObjectIdentifier.type;
     cov_data.monitoredObjectIdentifier.instance =
         cov_subscription->monitoredObjectIdentifier.instance;
-    cov_data.timeRemaining = cov_subscription->lifetime;
+    cov_data.timeRemaining = cov_time_remaining(cov_subscription);
     cov_data.listOfValues = value_list;
     if (cov_subscription->flag.issueConfirmedNotifications) {
         invoke_id = tsm_next_free_invokeID();
@@ -524,219 +869,210 @@ static bool cov_send_request(
 }
 
 static void cov_lifetime_expiration_handler(
-    unsigned index,
-    uint32_t elapsed_seconds,
-    uint32_t lifetime_seconds)
-{
-    if (index < MAX_COV_SUBCRIPTIONS) {
-        /* handle lifetime expiration */
-        if (lifetime_seconds >= elapsed_seconds) {
-            COV_Subscriptions[index].lifetime -= elapsed_seconds;
-#if 0
-            fprintf(stderr, "COVtimer: subscription[%d].lifetime=%lu\n", index,
-                (unsigned long) COV_Subscriptions[index].lifetime);
-#endif
-        } else {
-            COV_Subscriptions[index].lifetime = 0;
-        }
-        if (COV_Subscriptions[index].lifetime == 0) {
-            /* expire the subscription */
+    int index)
+{
+    /* expire the subscription */
 #if PRINT_ENABLED
-            fprintf(stderr, "COVtimer: PID=%u ",
-                COV_Subscriptions[index].subscriberProcessIdentifier);
-            fprintf(stderr, "%s %u ",
-                bactext_object_type_name(COV_Subscriptions[index].
-                    monitoredObjectIdentifier.type),
-                COV_Subscriptions[index].monitoredObjectIdentifier.instance);
-            fprintf(stderr, "time remaining=%u seconds ",
-                COV_Subscriptions[index].lifetime);
-            fprintf(stderr, "\n");
+    fprintf(stderr, "COVtimer: PID=%u ",
+        COV_Subscriptions[index].subscriberProcessIdentifier);
+    fprintf(stderr, "%s %u ",
+        bactext_object_type_name(COV_Subscriptions[index].
+            monitoredObjectIdentifier.type),
+        COV_Subscriptions[index].monitoredObjectIdentifier.instance);
+    fprintf(stderr, "time remaining=%u seconds ",
+        cov_time_remaining(&COV_Subscriptions[index]));
+    fprintf(stderr, "\n");
 #endif
-            COV_Subscriptions[index].flag.valid = false;
-            COV_Subscriptions[index].dest_index = -1;
-            cov_address_remove_unused();
-            if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-            }
-        }
-    }
+    cov_subscription_remove(index);
 }
 
-/** Handler to check the list of subscribed objects for any that have changed
- *  and so need to have notifications sent.
+/** Handler to expire the COV subscriptions whose lifetime has run out.
  * @ingroup DSCOV
  * This handler will be invoked by the main program every second or so.
- * This example only handles Binary Inputs, but can be easily extended to
- * support other types.
- * For each subscribed object,
- *  - See if the subscription has timed out
- *    - Remove it if it has timed out.
- *  - See if the subscribed object instance has changed
- *    (eg, check with Binary_Input_Change_Of_Value() )
- *  - If changed,
- *    - Clear the COV (eg, Binary_Input_Change_Of_Value_Clear() )
- *    - Send the notice with cov_send_request()
- *      - Will be confirmed or unconfirmed, as per the subscription.
- *
- * @note worst case tasking: MS/TP with the ability to send only
- *        one notification per task cycle.
+ * Only the slots of the timer wheel for the seconds that have elapsed
+ * are visited, or the whole wheel if more seconds than it has slots.
  *
  * @param elapsed_seconds [in] How many seconds have elapsed since last called.
  */
 void handler_cov_timer_seconds(
     uint32_t elapsed_seconds)
 {
-    unsigned index = 0;
-    uint32_t lifetime_seconds = 0;
+    uint32_t now = COV_Seconds + elapsed_seconds;
+    uint32_t ticks = 0;
+    uint32_t tick = 0;
+    int index = COV_NONE;
+    int next = COV_NONE;
 
-    if (elapsed_seconds) {
-        /* handle the subscription timeouts */
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-            if (COV_Subscriptions[index].flag.valid) {
-                lifetime_seconds = COV_Subscriptions[index].lifetime;
-                if (lifetime_seconds) {
-                    /* only expire COV with definite lifetimes */
-                    cov_lifetime_expiration_handler(index, elapsed_seconds,
-                        lifetime_seconds);
+    if (COV_Subscriptions_Count) {
+        ticks = elapsed_seconds;
+        if (ticks > COV_TIMER_SLOTS) {
+            ticks = COV_TIMER_SLOTS;
+        }
+        for (tick = 1; tick <= ticks; tick++) {
+            index = COV_Timer_Wheel[(COV_Seconds + tick) & (COV_TIMER_SLOTS -
+                    1)];
+            while (index != COV_NONE) {
+                next = COV_Subscriptions[index].next_timer;
+                /* the slot also holds lifetimes of later turns */
+                if ((int32_t) (COV_Subscriptions[index].expires - now) <= 0) {
+                    cov_lifetime_expiration_handler(index);
                 }
+                index = next;
             }
         }
     }
+    COV_Seconds = now;
 }
 
-void handler_cov_task(
-    void)
+/**
+* Sends the requested notifications for a monitored object, encoding
+* its value list once for all of its subscribers, and queues the object
+* again if some could not be sent yet.
+*
+* @param  object - the monitored object
+*
+* @return false if a notification could not be sent
+*/
+static bool cov_object_notify(
+    BACNET_COV_OBJECT * object)
 {
-    static int index = 0;
-    BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
-    uint32_t object_instance = 0;
-    bool status = false;
-    bool send = false;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
     BACNET_PROPERTY_VALUE value_list[2];
-    /* states for transmitting */
-    static enum {
-        COV_STATE_IDLE = 0,
-        COV_STATE_MARK,
-        COV_STATE_CLEAR,
-        COV_STATE_FREE,
-        COV_STATE_SEND
-    } cov_task_state = COV_STATE_IDLE;
-
-    switch (cov_task_state) {
-        case COV_STATE_IDLE:
-            index = 0;
-            cov_task_state = COV_STATE_MARK;
-            break;
-        case COV_STATE_MARK:
-            /* mark any subscriptions where the value has changed */
-            if (COV_Subscriptions[index].flag.valid) {
-                object_type = (BACNET_OBJECT_TYPE)
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].
-                    monitoredObjectIdentifier.instance;
-                status = Device_COV(object_type, object_instance);
-                if (status) {
-                    COV_Subscriptions[index].flag.send_requested = true;
-#if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Marking...\n");
-#endif
-                }
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_CLEAR;
-            }
-            break;
-        case COV_STATE_CLEAR:
-            /* clear the COV flag after checking all subscriptions */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                object_type = (BACNET_OBJECT_TYPE)
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].
-                    monitoredObjectIdentifier.instance;
-                Device_COV_Clear(object_type, object_instance);
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_FREE;
+    bool encoded = false;
+    bool send = false;
+    bool requeue = false;
+    bool status = true;
+    int index = COV_NONE;
+
+    for (index = object->subscriptions; index != COV_NONE;
+        index = cov_subscription->next_object) {
+        cov_subscription = &COV_Subscriptions[index];
+        /* confirmed notification house keeping */
+        if (cov_subscription->invokeID) {
+            if (tsm_invoke_id_free(cov_subscription->invokeID)) {
+                cov_subscription->invokeID = 0;
+            } else if (tsm_invoke_id_failed(cov_subscription->invokeID)) {
+                tsm_free_invoke_id(cov_subscription->invokeID);
+                cov_subscription->invokeID = 0;
             }
-            break;
-        case COV_STATE_FREE:
-            /* confirmed notification house keeping */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.issueConfirmedNotifications) &&
-                (COV_Subscriptions[index].invokeID)) {
-                if (tsm_invoke_id_free(COV_Subscriptions[index].invokeID)) {
-                    COV_Subscriptions[index].invokeID = 0;
-                } else
-                    if (tsm_invoke_id_failed(COV_Subscriptions
-                        [index].invokeID)) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
+        }
+        if (status && cov_subscription->flag.send_requested) {
+            send = true;
+            if (cov_subscription->flag.issueConfirmedNotifications) {
+                if (cov_subscription->invokeID != 0) {
+                    /* already sending */
+                    send = false;
                 }
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_SEND;
-            }
-            break;
-        case COV_STATE_SEND:
-            /* send any COVs that are requested */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                send = true;
-                if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                    if (COV_Subscriptions[index].invokeID != 0) {
-                        /* already sending */
-                        send = false;
-                    }
-                    if (!tsm_transaction_available()) {
-                        /* no transactions available - can't send now */
-                        send = false;
-                    }
+                if (!tsm_transaction_available()) {
+                    /* no transactions available - can't send now */
+                    send = false;
                 }
-                if (send) {
-                    object_type = (BACNET_OBJECT_TYPE)
-                        COV_Subscriptions[index].
-                        monitoredObjectIdentifier.type;
-                    object_instance =
-                        COV_Subscriptions[index].
-                        monitoredObjectIdentifier.instance;
+            }
+            if (send) {
+                if (!encoded) {
 #if PRINT_ENABLED
                     fprintf(stderr, "COVtask: Sending...\n");
 #endif
                     /* configure the linked list for the two properties */
                     value_list[0].next = &value_list[1];
                     value_list[1].next = NULL;
-                    (void) Device_Encode_Value_List(object_type,
-                        object_instance, &value_list[0]);
-                    status =
-                        cov_send_request(&COV_Subscriptions[index],
-                        &value_list[0]);
-                    if (status) {
-                        COV_Subscriptions[index].flag.send_requested = false;
-                    }
+                    (void) Device_Encode_Value_List((BACNET_OBJECT_TYPE)
+                        object->objectIdentifier.type,
+                        object->objectIdentifier.instance, &value_list[0]);
+                    encoded = true;
+                }
+                if (cov_send_request(cov_subscription, &value_list[0])) {
+                    cov_subscription->flag.send_requested = false;
+                } else {
+                    status = false;
                 }
             }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_IDLE;
+        }
+        if (cov_subscription->flag.send_requested ||
+            cov_subscription->invokeID) {
+            requeue = true;
+        }
+    }
+    if (requeue) {
+        cov_object_queue(object);
+    }
+
+    return status;
+}
+
+/** Handler to check the subscribed objects for any that have changed
+ *  and so need to have notifications sent.
+ * @ingroup DSCOV
+ * This handler will be invoked by the main program often.
+ *  - Up to MAX_COV_TASK_OBJECTS monitored objects, in turn, are checked
+ *    for a change of value (eg, with Binary_Input_Change_Of_Value() ),
+ *    and those that changed have all their subscriptions marked, their
+ *    COV cleared (eg, Binary_Input_Change_Of_Value_Clear() ), and are
+ *    queued for notification along with new and renewed subscriptions.
+ *  - Each queued object is notified with cov_object_notify(), which
+ *    encodes its value list once and sends the notice to each subscriber
+ *    with cov_send_request(), confirmed or unconfirmed, as per the
+ *    subscription.
+ *
+ * @note worst case tasking: MS/TP with the ability to send only
+ *        one notification per task cycle - sending stops at the first
+ *        notification the datalink does not take, and resumes there
+ *        at the next call.
+ */
+void handler_cov_task(
+    void)
+{
+    BACNET_COV_OBJECT *object = NULL;
+    BACNET_COV_OBJECT *last = NULL;
+    bool done = false;
+    int count = 0;
+    int checked = 0;
+    int index = COV_NONE;
+
+    if (!COV_Objects) {
+        /* nothing subscribed yet */
+        return;
+    }
+    /* mark any subscriptions where the value has changed */
+    count = Keylist_Count(COV_Objects);
+    for (checked = 0; (checked < count) && (checked < MAX_COV_TASK_OBJECTS);
+        checked++) {
+        if (COV_Objects_Cursor >= count) {
+            COV_Objects_Cursor = 0;
+        }
+        object = Keylist_Data_Index(COV_Objects, COV_Objects_Cursor);
+        COV_Objects_Cursor++;
+        if (object &&
+            Device_COV((BACNET_OBJECT_TYPE) object->objectIdentifier.type,
+                object->objectIdentifier.instance)) {
+#if PRINT_ENABLED
+            fprintf(stderr, "COVtask: Marking...\n");
+#endif
+            for (index = object->subscriptions; index != COV_NONE;
+                index = COV_Subscriptions[index].next_object) {
+                COV_Subscriptions[index].flag.send_requested = true;
             }
-            break;
-        default:
-            index = 0;
-            cov_task_state = COV_STATE_IDLE;
-            break;
+            Device_COV_Clear((BACNET_OBJECT_TYPE) object->objectIdentifier.
+                type, object->objectIdentifier.instance);
+            cov_object_queue(object);
+        }
+    }
+    /* send any COVs that are requested, once through the queue */
+    last = COV_Pending_Tail;
+    while (COV_Pending_Head && !done) {
+        object = COV_Pending_Head;
+        COV_Pending_Head = object->next_pending;
+        if (!COV_Pending_Head) {
+            COV_Pending_Tail = NULL;
+        }
+        object->pending = false;
+        done = (object == last);
+        if (object->subscriptions == COV_NONE) {
+            /* its last subscription was removed while queued */
+            free(object);
+        } else if (!cov_object_notify(object)) {
+            done = true;
+        }
     }
 }
 
@@ -894,3 +1230,531 @@ void handler_cov_subscribe(
 
     return;
 }
+
+#ifdef TEST
+#include <assert.h>
+#include <time.h>
+#include "ctest.h"
+
+/* a device of analog inputs, whose changes of value the tests set,
+   and a datalink and TSM that count what is sent */
+#define COV_TEST_OBJECTS 4096
+static bool Test_Object_COV[COV_TEST_OBJECTS];
+static unsigned Test_Value_Lists;
+static unsigned Test_Notifications;
+static unsigned Test_Confirmed_Notifications;
+static bool Test_Transaction_Available = true;
+static bool Test_Transaction_Complete = false;
+static uint8_t Test_Invoke_ID;
+
+uint32_t Device_Object_Instance_Number(
+    void)
+{
+    return 260001;
+}
+
+bool Device_Valid_Object_Id(
+    int object_type,
+    uint32_t object_instance)
+{
+    return (object_type == OBJECT_ANALOG_INPUT) &&
+        (object_instance < COV_TEST_OBJECTS);
+}
+
+bool Device_Value_List_Supported(
+    BACNET_OBJECT_TYPE object_type)
+{
+    return (object_type == OBJECT_ANALOG_INPUT);
+}
+
+bool Device_COV(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    (void) object_type;
+
+    return Test_Object_COV[object_instance];
+}
+
+void Device_COV_Clear(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    (void) object_type;
+    Test_Object_COV[object_instance] = false;
+}
+
+bool Device_Encode_Value_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    (void) object_type;
+    Test_Value_Lists++;
+    value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_REAL;
+    value_list->value.type.Real = (float) object_instance;
+    value_list->value.next = NULL;
+    value_list->priority = BACNET_NO_PRIORITY;
+    value_list = value_list->next;
+    value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+    value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+    value_list->value.context_specific = false;
+    value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+    bitstring_init(&value_list->value.type.Bit_String);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_IN_ALARM, false);
+    bitstring_set_bit(&value_list->value.type.Bit_String, STATUS_FLAG_FAULT,
+        false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OVERRIDDEN, false);
+    bitstring_set_bit(&value_list->value.type.Bit_String,
+        STATUS_FLAG_OUT_OF_SERVICE, false);
+    value_list->value.next = NULL;
+    value_list->priority = BACNET_NO_PRIORITY;
+
+    return false;
+}
+
+bool dcc_communication_enabled(
+    void)
+{
+    return true;
+}
+
+void datalink_get_my_address(
+    BACNET_ADDRESS * my_address)
+{
+    memset(my_address, 0, sizeof(BACNET_ADDRESS));
+}
+
+int datalink_send_pdu(
+    BACNET_ADDRESS * dest,
+    BACNET_NPDU_DATA * npdu_data,
+    uint8_t * pdu,
+    unsigned pdu_len)
+{
+    (void) dest;
+    (void) npdu_data;
+    (void) pdu;
+    Test_Notifications++;
+
+    return (int) pdu_len;
+}
+
+bool tsm_transaction_available(
+    void)
+{
+    return Test_Transaction_Available;
+}
+
+uint8_t tsm_next_free_invokeID(
+    void)
+{
+    if (!Test_Transaction_Available) {
+        return 0;
+    }
+    Test_Invoke_ID++;
+    if (Test_Invoke_ID == 0) {
+        Test_Invoke_ID = 1;
+    }
+
+    return Test_Invoke_ID;
+}
+
+void tsm_set_confirmed_unsegmented_transaction(
+    uint8_t invokeID,
+    BACNET_ADDRESS * dest,
+    BACNET_NPDU_DATA * ndpu_data,
+    uint8_t * apdu,
+    uint16_t apdu_len)
+{
+    (void) invokeID;
+    (void) dest;
+    (void) ndpu_data;
+    (void) apdu;
+    (void) apdu_len;
+    Test_Confirmed_Notifications++;
+}
+
+bool tsm_invoke_id_free(
+    uint8_t invokeID)
+{
+    (void) invokeID;
+
+    return Test_Transaction_Complete;
+}
+
+bool tsm_invoke_id_failed(
+    uint8_t invokeID)
+{
+    (void) invokeID;
+
+    return false;
+}
+
+void tsm_free_invoke_id(
+    uint8_t invokeID)
+{
+    (void) invokeID;
+}
+
+static void testCOVHandlerAddress(
+    BACNET_ADDRESS * src,
+    unsigned number)
+{
+    memset(src, 0, sizeof(BACNET_ADDRESS));
+    src->mac_len = 6;
+    src->mac[0] = 192;
+    src->mac[1] = 168;
+    src->mac[2] = (uint8_t) (number >> 8);
+    src->mac[3] = (uint8_t) number;
+    src->mac[4] = 0xBA;
+    src->mac[5] = 0xC0;
+}
+
+static bool testCOVHandlerSubscribe(
+    unsigned address,
+    uint32_t pid,
+    uint32_t instance,
+    uint32_t lifetime,
+    bool confirmed,
+    bool cancel)
+{
+    BACNET_ADDRESS src;
+    BACNET_SUBSCRIBE_COV_DATA cov_data;
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_OBJECT;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
+
+    testCOVHandlerAddress(&src, address);
+    memset(&cov_data, 0, sizeof(cov_data));
+    cov_data.subscriberProcessIdentifier = pid;
+    cov_data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    cov_data.monitoredObjectIdentifier.instance = instance;
+    cov_data.cancellationRequest = cancel;
+    cov_data.issueConfirmedNotifications = confirmed;
+    cov_data.lifetime = lifetime;
+
+    return cov_subscribe(&src, &cov_data, &error_class, &error_code);
+}
+
+static void testCOVHandlerReset(
+    void)
+{
+    handler_cov_init();
+    memset(Test_Object_COV, 0, sizeof(Test_Object_COV));
+    Test_Value_Lists = 0;
+    Test_Notifications = 0;
+    Test_Confirmed_Notifications = 0;
+    Test_Transaction_Available = true;
+    Test_Transaction_Complete = false;
+}
+
+void testCOVSubscriptions(
+    Test * pTest)
+{
+    uint8_t apdu[MAX_APDU];
+    unsigned address = 0;
+    uint32_t instance = 0;
+    int len = 0;
+
+    testCOVHandlerReset();
+    /* more subscriptions than the old fixed table had room for */
+    for (address = 0; address < 20; address++) {
+        for (instance = 0; instance < 10; instance++) {
+            ct_test(pTest, testCOVHandlerSubscribe(address, 1, instance, 0, false,
+                    false));
+        }
+    }
+    ct_test(pTest, COV_Subscriptions_Count == 200);
+    ct_test(pTest, Keylist_Count(COV_Objects) == 10);
+    /* an initial notification to each, one value list per object */
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 200);
+    ct_test(pTest, Test_Value_Lists == 10);
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 200);
+    /* a change of value notifies the subscribers to the object */
+    Test_Object_COV[3] = true;
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 220);
+    ct_test(pTest, Test_Value_Lists == 11);
+    ct_test(pTest, Test_Object_COV[3] == false);
+    /* renewing does not add, and notifies the subscriber */
+    ct_test(pTest, testCOVHandlerSubscribe(7, 1, 3, 0, false, false));
+    ct_test(pTest, COV_Subscriptions_Count == 200);
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 221);
+    /* another process of the same subscriber adds */
+    ct_test(pTest, testCOVHandlerSubscribe(7, 2, 3, 0, false, false));
+    ct_test(pTest, COV_Subscriptions_Count == 201);
+    /* cancel, and cancel what is not subscribed */
+    ct_test(pTest, testCOVHandlerSubscribe(7, 2, 3, 0, false, true));
+    ct_test(pTest, COV_Subscriptions_Count == 200);
+    ct_test(pTest, testCOVHandlerSubscribe(7, 2, 3, 0, false, true));
+    ct_test(pTest, COV_Subscriptions_Count == 200);
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 221);
+    /* cancel all subscriptions to an object */
+    for (address = 0; address < 20; address++) {
+        ct_test(pTest, testCOVHandlerSubscribe(address, 1, 9, 0, false, true));
+    }
+    ct_test(pTest, COV_Subscriptions_Count == 180);
+    ct_test(pTest, Keylist_Count(COV_Objects) == 9);
+    Test_Object_COV[9] = true;
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 221);
+    /* unknown objects */
+    ct_test(pTest, !testCOVHandlerSubscribe(0, 1, COV_TEST_OBJECTS, 0, false,
+            false));
+    /* the list does not fit a single APDU any more */
+    len = handler_cov_encode_subscriptions(&apdu[0], sizeof(apdu));
+    ct_test(pTest, len == -2);
+
+    testCOVHandlerReset();
+    ct_test(pTest, testCOVHandlerSubscribe(1, 1, 1, 10, false, false));
+    /* lifetime longer than a turn of the timer wheel */
+    ct_test(pTest, testCOVHandlerSubscribe(2, 1, 1, COV_TIMER_SLOTS + 44, false,
+            false));
+    ct_test(pTest, testCOVHandlerSubscribe(3, 1, 1, 1000, false, false));
+    ct_test(pTest, testCOVHandlerSubscribe(4, 1, 1, 0, false, false));
+    len = handler_cov_encode_subscriptions(&apdu[0], sizeof(apdu));
+    ct_test(pTest, len > 0);
+    ct_test(pTest, len <= 4 * COV_SUBSCRIPTION_APDU_MAX);
+    handler_cov_timer_seconds(9);
+    ct_test(pTest, COV_Subscriptions_Count == 4);
+    handler_cov_timer_seconds(1);
+    ct_test(pTest, COV_Subscriptions_Count == 3);
+    /* renewing restarts the lifetime */
+    ct_test(pTest, testCOVHandlerSubscribe(3, 1, 1, 1000, false, false));
+    handler_cov_timer_seconds(COV_TIMER_SLOTS + 33);
+    ct_test(pTest, COV_Subscriptions_Count == 3);
+    handler_cov_timer_seconds(1);
+    ct_test(pTest, COV_Subscriptions_Count == 2);
+    handler_cov_timer_seconds(709);
+    ct_test(pTest, COV_Subscriptions_Count == 2);
+    /* more seconds than the wheel has slots */
+    handler_cov_timer_seconds(5000);
+    ct_test(pTest, COV_Subscriptions_Count == 1);
+    handler_cov_task();
+    ct_test(pTest, Keylist_Count(COV_Objects) == 1);
+
+    testCOVHandlerReset();
+    /* confirmed notifications wait for a transaction */
+    Test_Transaction_Available = false;
+    ct_test(pTest, testCOVHandlerSubscribe(1, 1, 5, 0, true, false));
+    ct_test(pTest, testCOVHandlerSubscribe(2, 1, 5, 0, false, false));
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 1);
+    Test_Transaction_Available = true;
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 2);
+    ct_test(pTest, Test_Confirmed_Notifications == 1);
+    /* and for the one in progress */
+    Test_Object_COV[5] = true;
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 3);
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 3);
+    Test_Transaction_Complete = true;
+    handler_cov_task();
+    ct_test(pTest, Test_Notifications == 4);
+    ct_test(pTest, Test_Confirmed_Notifications == 2);
+    /* an object is kept while queued, if its subscriptions go */
+    Test_Transaction_Complete = false;
+    Test_Object_COV[5] = true;
+    handler_cov_task();
+    ct_test(pTest, testCOVHandlerSubscribe(1, 1, 5, 0, true, true));
+    ct_test(pTest, testCOVHandlerSubscribe(2, 1, 5, 0, false, true));
+    ct_test(pTest, Keylist_Count(COV_Objects) == 0);
+    handler_cov_task();
+    ct_test(pTest, COV_Pending_Head == NULL);
+    handler_cov_init();
+}
+
+#ifdef TEST_COV_HANDLER
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("BACnet COV Handler", NULL);
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testCOVSubscriptions);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_COV_HANDLER */
+
+#ifdef TEST_COV_BENCHMARK
+/* Times the COV handler for a growing number of subscriptions, made by
+   64 supervisory controllers to 8 analog inputs each per 64 subscriptions:
+    - SubscribeCOV of new subscriptions, and renewals of them,
+    - handler_cov_task() when no value changes,
+    - from a change of value until all its subscribers are notified,
+    - from a change of every value until all subscribers are notified,
+    - handler_cov_timer_seconds() for one second, and cancellations.
+   Usage: cov_bench [milliseconds per case] */
+static double Benchmark_Milliseconds = 200;
+
+static double benchmarkElapsed(
+    clock_t start)
+{
+    return (double) (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static void benchmarkSubscriptions(
+    unsigned subscriptions,
+    bool cancel)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < subscriptions; i++) {
+        (void) testCOVHandlerSubscribe(i % 64, 1, i / 8, 3600 + i % 600, false,
+            cancel);
+    }
+}
+
+static bool benchmarkNotified(
+    unsigned notifications,
+    long *calls)
+{
+    unsigned target = Test_Notifications + notifications;
+
+    while (Test_Notifications < target) {
+        handler_cov_task();
+        (*calls)++;
+        if (*calls > 100000000L) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool benchmarkRun(
+    unsigned subscriptions)
+{
+    unsigned objects = subscriptions / 8;
+    unsigned object = 0;
+    double elapsed = 0;
+    long operations = 0;
+    long calls = 0;
+    clock_t start;
+
+    testCOVHandlerReset();
+    start = clock();
+    do {
+        handler_cov_init();
+        benchmarkSubscriptions(subscriptions, false);
+        operations += subscriptions;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f us\n", "subscribe", elapsed * 1e3 / operations);
+    /* the initial notifications */
+    if (!benchmarkNotified(subscriptions, &calls)) {
+        return false;
+    }
+
+    operations = 0;
+    start = clock();
+    do {
+        benchmarkSubscriptions(subscriptions, false);
+        operations += subscriptions;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f us\n", "renew", elapsed * 1e3 / operations);
+    if (!benchmarkNotified(subscriptions, &calls)) {
+        return false;
+    }
+
+    operations = 0;
+    start = clock();
+    do {
+        handler_cov_task();
+        operations++;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f us\n", "task, no change",
+        elapsed * 1e3 / operations);
+
+    operations = 0;
+    calls = 0;
+    start = clock();
+    do {
+        Test_Object_COV[object] = true;
+        object = (object + 1) % objects;
+        if (!benchmarkNotified(8, &calls)) {
+            return false;
+        }
+        operations++;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f us %8.1f calls\n", "one change to notified",
+        elapsed * 1e3 / operations, (double) calls / operations);
+
+    operations = 0;
+    calls = 0;
+    start = clock();
+    do {
+        memset(Test_Object_COV, true, objects * sizeof(bool));
+        if (!benchmarkNotified(subscriptions, &calls)) {
+            return false;
+        }
+        operations++;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f us %8.1f calls\n", "all changed to notified",
+        elapsed * 1e3 / operations, (double) calls / operations);
+
+    operations = 0;
+    start = clock();
+    do {
+        handler_cov_timer_seconds(1);
+        operations++;
+        elapsed = benchmarkElapsed(start);
+    } while ((elapsed < Benchmark_Milliseconds) && (operations < 3000));
+    printf("  %-26s : %10.3f us\n", "timer, one second",
+        elapsed * 1e3 / operations);
+
+    start = clock();
+    benchmarkSubscriptions(subscriptions, true);
+    elapsed = benchmarkElapsed(start);
+    printf("  %-26s : %10.3f us\n", "cancel", elapsed * 1e3 / subscriptions);
+    handler_cov_init();
+
+    return true;
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    unsigned subscriptions = 0;
+
+    Benchmark_Milliseconds = argc > 1 ? atof(argv[1]) : 200;
+    if (Benchmark_Milliseconds <= 0) {
+        printf("usage: %s [milliseconds per case]\n", argv[0]);
+        return 1;
+    }
+    for (subscriptions = 128; subscriptions <= 32768; subscriptions *= 4) {
+        printf("%u subscriptions\n", subscriptions);
+        if (!benchmarkRun(subscriptions)) {
+            printf("notifications were not sent\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+#endif /* TEST_COV_BENCHMARK */
+#endif /* TEST */
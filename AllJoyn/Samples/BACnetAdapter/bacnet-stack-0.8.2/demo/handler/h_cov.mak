@@ -0,0 +1,51 @@
+#Makefile to build test case
+CC      = gcc
+SRC_DIR = ../../src
+TEST_DIR = ../../test
+OBJECT_DIR = ../object
+INCLUDES = -I../../include -I$(TEST_DIR) -I. -I$(OBJECT_DIR)
+DEFINES = -DBIG_ENDIAN=0 -DBACDL_ALL -DTEST -DTEST_COV_HANDLER -DBACAPP_ALL
+
+CFLAGS  = -Wall $(INCLUDES) $(DEFINES) -g
+
+SRCS = h_cov.c \
+	txbuf.c \
+	$(SRC_DIR)/abort.c \
+	$(SRC_DIR)/bacaddr.c \
+	$(SRC_DIR)/bacapp.c \
+	$(SRC_DIR)/bacdcode.c \
+	$(SRC_DIR)/bacdevobjpropref.c \
+	$(SRC_DIR)/bacerror.c \
+	$(SRC_DIR)/bacint.c \
+	$(SRC_DIR)/bacreal.c \
+	$(SRC_DIR)/bacstr.c \
+	$(SRC_DIR)/bactext.c \
+	$(SRC_DIR)/cov.c \
+	$(SRC_DIR)/datetime.c \
+	$(SRC_DIR)/indtext.c \
+	$(SRC_DIR)/keylist.c \
+	$(SRC_DIR)/lighting.c \
+	$(SRC_DIR)/npdu.c \
+	$(SRC_DIR)/reject.c \
+	$(TEST_DIR)/ctest.c
+
+TARGET = cov_handler
+
+all: ${TARGET}
+
+OBJS = ${SRCS:.c=.o}
+
+${TARGET}: ${OBJS}
+	${CC} -o $@ ${OBJS}
+
+.c.o:
+	${CC} -c ${CFLAGS} $*.c -o $@
+
+depend:
+	rm -f .depend
+	${CC} -MM ${CFLAGS} *.c >> .depend
+
+clean:
+	rm -rf core ${TARGET} $(OBJS)
+
+include: .depend
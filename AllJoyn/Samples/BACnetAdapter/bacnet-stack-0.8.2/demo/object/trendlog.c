@@ -25,7 +25,10 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>     /* for memmove */
+#include <stddef.h>     /* for offsetof */
 #include "bacdef.h"
 #include "bacdcode.h"
 #include "bacenum.h"
@@ -43,15 +46,65 @@
 #if defined(BACFILE)
 #include "bacfile.h"    /* object list dependency */
 #endif
+#if defined(TL_STORE_DIR)
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#endif
 
 /* number of demo objects */
 #ifndef MAX_TREND_LOGS
 #define MAX_TREND_LOGS 8
 #endif
 
-TL_DATA_REC Logs[MAX_TREND_LOGS][TL_MAX_ENTRIES];
 static TL_LOG_INFO LogInfo[MAX_TREND_LOGS];
 
+/* Storage for the records of a Trend Log
+ *
+ * Each log is a ring of TL_MAX_ENTRIES slots, filled from iIndex. A slot
+ * holds the sequence number of its record and a check value over both,
+ * so that a slot torn by a crash in the middle of a write is recognised
+ * when the log is opened again. The header holds the first sequence
+ * number still in the log after a purge, and is the only thing written
+ * apart from the slots.
+ */
+
+#define TL_STORE_MAGIC 0x544C4F47       /* "TLOG" */
+
+typedef struct tl_store_header {
+    uint32_t ulMagic;
+    uint32_t ulSlots;   /* TL_MAX_ENTRIES when the file was made */
+    uint32_t ulSlotSize;        /* sizeof(TL_STORE_SLOT) likewise */
+    uint32_t ulFirstSequence;   /* Records before this were purged */
+} TL_STORE_HEADER;
+
+typedef struct tl_store_slot {
+    uint32_t ulSequence;
+    uint32_t ulCheck;   /* Over the sequence number and the record */
+    TL_DATA_REC Record;
+} TL_STORE_SLOT;
+
+typedef struct tl_store {
+    TL_STORE_HEADER *pHeader;
+    TL_STORE_SLOT *pSlots;
+    uint32_t ulOrdered; /* Newest records in time stamp order */
+#if defined(TL_STORE_DIR)
+    void *pMap; /* The file mapping, NULL if held in RAM instead */
+    size_t ulMapSize;
+#endif
+} TL_STORE;
+
+static TL_STORE Stores[MAX_TREND_LOGS];
+#if !defined(TL_STORE_DIR)
+static TL_STORE_HEADER Store_Headers[MAX_TREND_LOGS];
+static TL_STORE_SLOT Store_Slots[MAX_TREND_LOGS][TL_MAX_ENTRIES];
+#endif
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Trend_Log_Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -160,6 +213,363 @@ unsigned Trend_Log_Instance_To_Index(
     return index;
 }
 
+/*****************************************************************************
+ * Check value of a slot, FNV-1a over the sequence number and the record.    *
+ * Zero is avoided so that a slot of a new, zero filled log never passes.    *
+ *****************************************************************************/
+
+static uint32_t TL_Store_Check(
+    TL_STORE_SLOT * pSlot)
+{
+    const uint8_t *pData = (const uint8_t *) &pSlot->Record;
+    uint32_t ulHash = 2166136261UL;
+    uint32_t ulSequence = pSlot->ulSequence;
+    size_t i = 0;
+
+    for (i = 0; i < 4; i++) {
+        ulHash ^= (uint8_t) (ulSequence >> (i * 8));
+        ulHash *= 16777619UL;
+    }
+    for (i = 0; i < sizeof(TL_DATA_REC); i++) {
+        ulHash ^= pData[i];
+        ulHash *= 16777619UL;
+    }
+
+    return (ulHash == 0) ? 1 : ulHash;
+}
+
+/*****************************************************************************
+ * Slot holding a record, given as a 0 based position from the oldest.      *
+ *****************************************************************************/
+
+static TL_STORE_SLOT *TL_Store_Slot(
+    int iLog,
+    uint32_t ulPosition)
+{
+    uint32_t ulSlot = 0;
+
+    /* the oldest record is ulRecordCount slots back from iIndex */
+    ulSlot =
+        (uint32_t) LogInfo[iLog].iIndex + TL_MAX_ENTRIES -
+        LogInfo[iLog].ulRecordCount + ulPosition;
+
+    return &Stores[iLog].pSlots[ulSlot % TL_MAX_ENTRIES];
+}
+
+/*****************************************************************************
+ * Work out the records held in a log from its slots: the newest record is   *
+ * the valid slot with the highest sequence number, and the log runs back    *
+ * from it through slots of consecutive sequence numbers, stopping at one    *
+ * that is torn or was purged.                                               *
+ *****************************************************************************/
+
+static void TL_Store_Recover(
+    int iLog)
+{
+    TL_STORE *pStore = &Stores[iLog];
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    TL_STORE_SLOT *pSlot = NULL;
+    uint32_t ulFirst = pStore->pHeader->ulFirstSequence;
+    uint32_t ulNewest = 0;
+    uint32_t ulCount = 0;
+    uint32_t ulSlot = 0;
+    uint32_t ulNewestSlot = 0;
+    bool bFound = false;
+    time_t tLater = 0;
+
+    for (ulSlot = 0; ulSlot < TL_MAX_ENTRIES; ulSlot++) {
+        pSlot = &pStore->pSlots[ulSlot];
+        /* sequence numbers wrap, so compare them by their difference */
+        if ((pSlot->ulCheck == TL_Store_Check(pSlot)) &&
+            ((int32_t) (pSlot->ulSequence - ulFirst) >= 0) &&
+            (!bFound || ((int32_t) (pSlot->ulSequence - ulNewest) > 0))) {
+            ulNewest = pSlot->ulSequence;
+            ulNewestSlot = ulSlot;
+            bFound = true;
+        }
+    }
+    pStore->ulOrdered = 0;
+    if (bFound) {
+        ulSlot = ulNewestSlot;
+        for (ulCount = 0; ulCount < TL_MAX_ENTRIES; ulCount++) {
+            pSlot = &pStore->pSlots[ulSlot];
+            if ((pSlot->ulSequence != ulNewest - ulCount) ||
+                (pSlot->ulCheck != TL_Store_Check(pSlot)) ||
+                ((int32_t) (pSlot->ulSequence - ulFirst) < 0)) {
+                break;
+            }
+            if ((ulCount == 0) || (pSlot->Record.tTimeStamp <= tLater)) {
+                if (pStore->ulOrdered == ulCount) {
+                    pStore->ulOrdered++;
+                }
+            }
+            tLater = pSlot->Record.tTimeStamp;
+            ulSlot = (ulSlot + TL_MAX_ENTRIES - 1) % TL_MAX_ENTRIES;
+        }
+        CurrentLog->iIndex = (int) ((ulNewestSlot + 1) % TL_MAX_ENTRIES);
+        CurrentLog->ulRecordCount = ulCount;
+        CurrentLog->ulTotalRecordCount = ulNewest;
+    } else {
+        CurrentLog->iIndex = 0;
+        CurrentLog->ulRecordCount = 0;
+        CurrentLog->ulTotalRecordCount = ulFirst - 1;
+    }
+}
+
+/*****************************************************************************
+ * Empty a log. Sequence numbers carry on from ulTotalRecordCount.           *
+ *****************************************************************************/
+
+static void TL_Store_Purge(
+    int iLog)
+{
+    TL_STORE *pStore = &Stores[iLog];
+
+    LogInfo[iLog].ulRecordCount = 0;
+    pStore->ulOrdered = 0;
+    if (pStore->pHeader == NULL) {
+        return;
+    }
+    pStore->pHeader->ulFirstSequence = LogInfo[iLog].ulTotalRecordCount + 1;
+#if defined(TL_STORE_DIR)
+    /* the purge must reach the disk before any record after it */
+    if (pStore->pMap != NULL) {
+#if defined(_WIN32)
+        FlushViewOfFile(pStore->pMap, sizeof(TL_STORE_HEADER));
+#else
+        msync(pStore->pMap, sizeof(TL_STORE_HEADER), MS_SYNC);
+#endif
+    }
+#endif
+}
+
+/*****************************************************************************
+ * Append a record to a log, pushing out the oldest one if it is full.      *
+ *****************************************************************************/
+
+static void TL_Store_Append(
+    int iLog,
+    TL_DATA_REC * pRecord)
+{
+    TL_STORE *pStore = &Stores[iLog];
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    TL_STORE_SLOT *pSlot = NULL;
+    TL_STORE_SLOT *pNewest = NULL;
+
+    if (pStore->pSlots == NULL) {
+        return;
+    }
+    if (CurrentLog->ulRecordCount > 0) {
+        pNewest = TL_Store_Slot(iLog, CurrentLog->ulRecordCount - 1);
+    }
+    if ((pNewest == NULL) ||
+        (pRecord->tTimeStamp >= pNewest->Record.tTimeStamp)) {
+        if (pStore->ulOrdered < TL_MAX_ENTRIES) {
+            pStore->ulOrdered++;
+        }
+    } else {
+        /* the clock went back, so searches by time fall back to a scan
+           until this record is pushed out of the log */
+        pStore->ulOrdered = 1;
+    }
+
+    pSlot = &pStore->pSlots[CurrentLog->iIndex];
+    pSlot->Record = *pRecord;
+    pSlot->ulSequence = CurrentLog->ulTotalRecordCount + 1;
+    pSlot->ulCheck = TL_Store_Check(pSlot);
+
+    CurrentLog->iIndex++;
+    if (CurrentLog->iIndex >= TL_MAX_ENTRIES)
+        CurrentLog->iIndex = 0;
+
+    CurrentLog->ulTotalRecordCount++;
+
+    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
+        CurrentLog->ulRecordCount++;
+}
+
+/*****************************************************************************
+ * Find the 0 based position of the first record stamped after tRefTime, or *
+ * with bBefore the last one stamped before it. Returns -1 if there is none. *
+ * Time stamps normally only go forward so this is a binary search, but if  *
+ * the clock was set back within the log we have to look at every record.  *
+ *****************************************************************************/
+
+static int32_t TL_Store_Find_Time(
+    int iLog,
+    time_t tRefTime,
+    bool bBefore)
+{
+    uint32_t ulCount = LogInfo[iLog].ulRecordCount;
+    uint32_t ulLow = 0;
+    uint32_t ulHigh = ulCount;
+    uint32_t ulMiddle = 0;
+    time_t tStamp = 0;
+    int32_t iPosition = 0;
+
+    if (Stores[iLog].ulOrdered < ulCount) {
+        if (bBefore) {
+            for (iPosition = (int32_t) ulCount - 1; iPosition >= 0;
+                iPosition--) {
+                if (TL_Store_Slot(iLog,
+                        (uint32_t) iPosition)->Record.tTimeStamp < tRefTime)
+                    break;
+            }
+        } else {
+            for (iPosition = 0; (uint32_t) iPosition < ulCount; iPosition++) {
+                if (TL_Store_Slot(iLog,
+                        (uint32_t) iPosition)->Record.tTimeStamp > tRefTime)
+                    break;
+            }
+            if ((uint32_t) iPosition == ulCount)
+                iPosition = -1;
+        }
+
+        return iPosition;
+    }
+
+    /* ulLow ends up as the number of records stamped before tRefTime, or
+       at or before it if we are looking for the first one after it */
+    while (ulLow < ulHigh) {
+        ulMiddle = ulLow + (ulHigh - ulLow) / 2;
+        tStamp = TL_Store_Slot(iLog, ulMiddle)->Record.tTimeStamp;
+        if ((tStamp < tRefTime) || (!bBefore && (tStamp == tRefTime)))
+            ulLow = ulMiddle + 1;
+        else
+            ulHigh = ulMiddle;
+    }
+    if (bBefore)
+        return (int32_t) ulLow - 1;
+
+    return (ulLow < ulCount) ? (int32_t) ulLow : -1;
+}
+
+#if defined(TL_STORE_DIR)
+/*****************************************************************************
+ * Map the file of a log into memory, making it if need be. Returns NULL if *
+ * it cannot, and sets *pbNew if the file had to be made or remade.          *
+ *****************************************************************************/
+
+static void *TL_Store_Map(
+    int iLog,
+    size_t ulSize,
+    bool * pbNew)
+{
+    char acPath[sizeof(TL_STORE_DIR) + 32];
+    void *pMap = NULL;
+#if defined(_WIN32)
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    HANDLE hMapping = NULL;
+    DWORD dwSize = 0;
+#else
+    int iFile = -1;
+    struct stat FileStat;
+#endif
+
+    sprintf(acPath, "%s/trendlog-%lu.dat", TL_STORE_DIR,
+        (unsigned long) Trend_Log_Index_To_Instance(iLog));
+#if defined(_WIN32)
+    hFile =
+        CreateFileA(acPath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+        NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    dwSize = GetFileSize(hFile, NULL);
+    if (dwSize != (DWORD) ulSize) {
+        *pbNew = true;
+        SetFilePointer(hFile, (LONG) ulSize, NULL, FILE_BEGIN);
+        SetEndOfFile(hFile);
+    }
+    hMapping =
+        CreateFileMappingA(hFile, NULL, PAGE_READWRITE, 0, (DWORD) ulSize,
+        NULL);
+    if (hMapping != NULL) {
+        pMap = MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, ulSize);
+        /* the view keeps the file open */
+        CloseHandle(hMapping);
+    }
+    CloseHandle(hFile);
+#else
+    iFile = open(acPath, O_RDWR | O_CREAT, 0644);
+    if (iFile < 0) {
+        return NULL;
+    }
+    if ((fstat(iFile, &FileStat) != 0) ||
+        (FileStat.st_size != (off_t) ulSize)) {
+        *pbNew = true;
+        if ((ftruncate(iFile, 0) != 0) ||
+            (ftruncate(iFile, (off_t) ulSize) != 0)) {
+            close(iFile);
+            return NULL;
+        }
+    }
+    pMap =
+        mmap(NULL, ulSize, PROT_READ | PROT_WRITE, MAP_SHARED, iFile, 0);
+    if (pMap == MAP_FAILED) {
+        pMap = NULL;
+    }
+    /* the mapping keeps the file open */
+    close(iFile);
+#endif
+
+    return pMap;
+}
+#endif
+
+/*****************************************************************************
+ * Open the storage of a log and recover its records. Returns true if the    *
+ * log is new rather than one kept from before.                              *
+ *****************************************************************************/
+
+static bool TL_Store_Open(
+    int iLog)
+{
+    TL_STORE *pStore = &Stores[iLog];
+    bool bNew = false;
+
+#if defined(TL_STORE_DIR)
+    pStore->ulMapSize =
+        sizeof(TL_STORE_HEADER) + sizeof(TL_STORE_SLOT) * TL_MAX_ENTRIES;
+    pStore->pMap = TL_Store_Map(iLog, pStore->ulMapSize, &bNew);
+    if (pStore->pMap != NULL) {
+        pStore->pHeader = (TL_STORE_HEADER *) pStore->pMap;
+    } else {
+#if PRINT_ENABLED
+        fprintf(stderr, "Trend Log %d: unable to map its file in %s,"
+            " keeping it in RAM\n", iLog, TL_STORE_DIR);
+#endif
+        pStore->pHeader = (TL_STORE_HEADER *) calloc(1, pStore->ulMapSize);
+        if (pStore->pHeader == NULL) {
+            pStore->pSlots = NULL;
+            LogInfo[iLog].iIndex = 0;
+            LogInfo[iLog].ulRecordCount = 0;
+            LogInfo[iLog].ulTotalRecordCount = 0;
+            return true;
+        }
+    }
+    pStore->pSlots = (TL_STORE_SLOT *) (pStore->pHeader + 1);
+#else
+    pStore->pHeader = &Store_Headers[iLog];
+    pStore->pSlots = &Store_Slots[iLog][0];
+#endif
+    if ((pStore->pHeader->ulMagic != TL_STORE_MAGIC) ||
+        (pStore->pHeader->ulSlots != TL_MAX_ENTRIES) ||
+        (pStore->pHeader->ulSlotSize != sizeof(TL_STORE_SLOT))) {
+        bNew = true;
+    }
+    if (bNew) {
+        memset(pStore->pSlots, 0, sizeof(TL_STORE_SLOT) * TL_MAX_ENTRIES);
+        pStore->pHeader->ulSlots = TL_MAX_ENTRIES;
+        pStore->pHeader->ulSlotSize = sizeof(TL_STORE_SLOT);
+        pStore->pHeader->ulFirstSequence = 1;
+        pStore->pHeader->ulMagic = TL_STORE_MAGIC;
+    }
+    TL_Store_Recover(iLog);
+
+    return bNew;
+}
+
 /*
  * Things to do when starting up the stack for Trend Logs.
  * Should be called whenever we reset the device or power it up
@@ -172,6 +582,8 @@ void Trend_Log_Init(
     int iEntry;
     struct tm TempTime;
     time_t tClock;
+    TL_DATA_REC TempRec;
+    bool bNew;
 
     if (!initialized) {
         initialized = true;
@@ -180,42 +592,53 @@ void Trend_Log_Init(
 
         for (iLog = 0; iLog < MAX_TREND_LOGS; iLog++) {
             /*
-             * Do we need to do anything here?
              * Trend logs are usually assumed to survive over resets
-             * and are frequently implemented using Battery Backed RAM
-             * If they are implemented using Flash or SD cards or some
-             * such mechanism there may be some RAM based setup needed
-             * for log management purposes.
-             * We probably need to look at inserting LOG_INTERRUPTED
-             * entries into any active logs if the power down or reset
-             * may have caused us to miss readings.
+             * and are frequently implemented using Battery Backed RAM.
+             * With TL_STORE_DIR defined the records are kept in a file
+             * per log and are recovered here, otherwise they are in RAM
+             * and the log starts out new.
              */
+            bNew = TL_Store_Open(iLog);
+            if (bNew) {
+                /* We will just fill new logs with some entries for
+                 * testing purposes, ending at record 10000.
+                 */
+                if (TL_MAX_ENTRIES < 10000) {
+                    LogInfo[iLog].ulTotalRecordCount = 10000 - TL_MAX_ENTRIES;
+                    TL_Store_Purge(iLog);
+                }
+                TempTime.tm_year = 109;
+                TempTime.tm_mon = iLog + 1;     /* Different month for each log */
+                TempTime.tm_mday = 1;
+                TempTime.tm_hour = 0;
+                TempTime.tm_min = 0;
+                TempTime.tm_sec = 0;
+                TempTime.tm_isdst = -1;
+                tClock = mktime(&TempTime);
+
+                memset(&TempRec, 0, sizeof(TempRec));
+                for (iEntry = 0; iEntry < TL_MAX_ENTRIES; iEntry++) {
+                    TempRec.tTimeStamp = tClock;
+                    TempRec.ucRecType = TL_TYPE_REAL;
+                    TempRec.Datum.fReal =
+                        (float) (iEntry + (iLog * TL_MAX_ENTRIES));
+                    /* Put status flags with every second log */
+                    if ((iLog & 1) == 0)
+                        TempRec.ucStatus = 128;
+                    else
+                        TempRec.ucStatus = 0;
+                    TL_Store_Append(iLog, &TempRec);
+                    tClock += 900;      /* advance 15 minutes */
+                }
 
-            /* We will just fill the logs with some entries for testing
-             * purposes.
-             */
-            TempTime.tm_year = 109;
-            TempTime.tm_mon = iLog + 1; /* Different month for each log */
-            TempTime.tm_mday = 1;
-            TempTime.tm_hour = 0;
-            TempTime.tm_min = 0;
-            TempTime.tm_sec = 0;
-            tClock = mktime(&TempTime);
-
-            for (iEntry = 0; iEntry < TL_MAX_ENTRIES; iEntry++) {
-                Logs[iLog][iEntry].tTimeStamp = tClock;
-                Logs[iLog][iEntry].ucRecType = TL_TYPE_REAL;
-                Logs[iLog][iEntry].Datum.fReal =
-                    (float) (iEntry + (iLog * TL_MAX_ENTRIES));
-                /* Put status flags with every second log */
-                if ((iLog & 1) == 0)
-                    Logs[iLog][iEntry].ucStatus = 128;
-                else
-                    Logs[iLog][iEntry].ucStatus = 0;
-                tClock += 900;  /* advance 15 minutes */
+                LogInfo[iLog].tLastDataTime = tClock - 900;
+            } else if (LogInfo[iLog].ulRecordCount > 0) {
+                LogInfo[iLog].tLastDataTime =
+                    TL_Store_Slot(iLog,
+                    LogInfo[iLog].ulRecordCount - 1)->Record.tTimeStamp;
+            } else {
+                LogInfo[iLog].tLastDataTime = 0;
             }
-
-            LogInfo[iLog].tLastDataTime = tClock - 900;
             LogInfo[iLog].bAlignIntervals = true;
             LogInfo[iLog].bEnable = true;
             LogInfo[iLog].bStopWhenFull = false;
@@ -224,10 +647,7 @@ void Trend_Log_Init(
             LogInfo[iLog].Source.arrayIndex = 0;
             LogInfo[iLog].ucTimeFlags = 0;
             LogInfo[iLog].ulIntervalOffset = 0;
-            LogInfo[iLog].iIndex = 0;
             LogInfo[iLog].ulLogInterval = 900;
-            LogInfo[iLog].ulRecordCount = TL_MAX_ENTRIES;
-            LogInfo[iLog].ulTotalRecordCount = 10000;
 
             LogInfo[iLog].Source.deviceIndentifier.instance =
                 Device_Object_Instance_Number();
@@ -245,6 +665,10 @@ void Trend_Log_Init(
                 59, 99);
             LogInfo[iLog].tStopTime =
                 TL_BAC_Time_To_Local(&LogInfo[iLog].StopTime);
+            if (!bNew) {
+                /* We will have missed readings whilst we were down */
+                TL_Insert_Status_Rec(iLog, LOG_STATUS_LOG_INTERRUPTED, true);
+            }
         }
     }
 
@@ -561,8 +985,7 @@ bool Trend_Log_Write_Property(
             if (status) {
                 if (value.type.Unsigned_Int == 0) {
                     /* Time to clear down the log */
-                    CurrentLog->ulRecordCount = 0;
-                    CurrentLog->iIndex = 0;
+                    TL_Store_Purge(log_index);
                     TL_Insert_Status_Rec(log_index, LOG_STATUS_BUFFER_PURGED,
                         true);
                 }
@@ -724,8 +1147,7 @@ bool Trend_Log_Write_Property(
             if (memcmp(&TempSource, &CurrentLog->Source,
                     sizeof(BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE)) != 0) {
                 /* Clear buffer if property being logged is changed */
-                CurrentLog->ulRecordCount = 0;
-                CurrentLog->iIndex = 0;
+                TL_Store_Purge(log_index);
                 TL_Insert_Status_Rec(log_index, LOG_STATUS_BUFFER_PURGED,
                     true);
             }
@@ -844,11 +1266,9 @@ void TL_Insert_Status_Rec(
     BACNET_LOG_STATUS eStatus,
     bool bState)
 {
-    TL_LOG_INFO *CurrentLog;
     TL_DATA_REC TempRec;
 
-    CurrentLog = &LogInfo[iLog];
-
+    memset(&TempRec, 0, sizeof(TempRec));
     TempRec.tTimeStamp = time(NULL);
     TempRec.ucRecType = TL_TYPE_STATUS;
     TempRec.ucStatus = 0;
@@ -871,14 +1291,7 @@ void TL_Insert_Status_Rec(
             break;
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES)
-        CurrentLog->iIndex = 0;
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
-        CurrentLog->ulRecordCount++;
+    TL_Store_Append(iLog, &TempRec);
 }
 
 /*****************************************************************************
@@ -969,6 +1382,7 @@ time_t TL_BAC_Time_To_Local(
     LocalTime.tm_hour = SourceTime->time.hour;
     LocalTime.tm_min = SourceTime->time.min;
     LocalTime.tm_sec = SourceTime->time.sec;
+    LocalTime.tm_isdst = -1;    /* Let the library work out daylight saving */
 
     return (mktime(&LocalTime));
 }
@@ -1316,68 +1730,44 @@ int TL_encode_by_time(
     CurrentLog = &LogInfo[log_index];
 
     tRefTime = TL_BAC_Time_To_Local(&pRequest->Range.RefTime);
-    /* Find correct position for oldest entry in log */
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
-        uiIndex = 0;
-    else
-        uiIndex = CurrentLog->iIndex;
 
     if (pRequest->Count < 0) {
-        /* Start at end of log and look for record which has
-         * timestamp greater than or equal to the reference.
+        /* Look for the last record which has a timestamp before the
+         * reference time.
          */
-        iCount = CurrentLog->ulRecordCount - 1;
-        /* Start out with the sequence number for the last record */
-        uiFirstSeq = CurrentLog->ulTotalRecordCount;
-        for (;;) {
-            if (Logs[pRequest->object_instance][(uiIndex +
-                        iCount) % TL_MAX_ENTRIES].tTimeStamp < tRefTime)
-                break;
-
-            uiFirstSeq--;
-            iCount--;
-            if (iCount < 0)
-                return (0);
-        }
+        iCount = TL_Store_Find_Time(log_index, tRefTime, true);
+        if (iCount < 0)
+            return (0);
 
-        /* We have an and point for our request,
+        /* We have an end point for our request,
          * now work backwards to find where we should start from
          */
 
         pRequest->Count = -pRequest->Count;     /* Conveert to +ve count */
         /* If count would bring us back beyond the limits
          * Of the buffer then pin it to the start of the buffer
-         * otherwise adjust starting point and sequence number
-         * appropriately.
+         * otherwise adjust starting point appropriately.
          */
         iTemp = pRequest->Count - 1;
         if (iTemp > iCount) {
-            uiFirstSeq -= iCount;
             pRequest->Count = iCount + 1;
             iCount = 0;
         } else {
-            uiFirstSeq -= iTemp;
             iCount -= iTemp;
         }
     } else {
-        /* Start at beginning of log and look for 1st record which has
-         * timestamp greater than the reference time.
+        /* Look for the 1st record which has a timestamp after the
+         * reference time.
          */
-        iCount = 0;
-        /* Figure out the sequence number for the first record, last is ulTotalRecordCount */
-        uiFirstSeq =
-            CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
-        for (;;) {
-            if (Logs[pRequest->object_instance][(uiIndex +
-                        iCount) % TL_MAX_ENTRIES].tTimeStamp > tRefTime)
-                break;
-
-            uiFirstSeq++;
-            iCount++;
-            if ((uint32_t) iCount == CurrentLog->ulRecordCount)
-                return (0);
-        }
+        iCount = TL_Store_Find_Time(log_index, tRefTime, false);
+        if (iCount < 0)
+            return (0);
     }
+    /* Figure out the sequence number of the record from that of the
+     * first record, the last being ulTotalRecordCount */
+    uiFirstSeq =
+        CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1) +
+        iCount;
 
     /* We now have a starting point for the operation and a +ve count */
 
@@ -1433,14 +1823,8 @@ int TL_encode_entry(
     uint8_t ucCount = 0;
     BACNET_DATE_TIME TempTime;
 
-    /* Convert from BACnet 1 based to 0 based array index and then
-     * handle wrap around of the circular buffer */
-
-    if (LogInfo[iLog].ulRecordCount < TL_MAX_ENTRIES)
-        pSource = &Logs[iLog][(iEntry - 1) % TL_MAX_ENTRIES];
-    else
-        pSource =
-            &Logs[iLog][(LogInfo[iLog].iIndex + iEntry - 1) % TL_MAX_ENTRIES];
+    /* Convert from BACnet 1 based to 0 based position */
+    pSource = &TL_Store_Slot(iLog, (uint32_t) (iEntry - 1))->Record;
 
     iLen = 0;
     /* First stick the time stamp in with tag [0] */
@@ -1613,6 +1997,7 @@ static void TL_fetch_property(
 
     /* Record the current time in the log entry and also in the info block
      * for the log so we can figure out when the next reading is due */
+    memset(&TempRec, 0, sizeof(TempRec));
     TempRec.tTimeStamp = time(NULL);
     CurrentLog->tLastDataTime = TempRec.tTimeStamp;
     TempRec.ucStatus = 0;
@@ -1703,14 +2088,7 @@ static void TL_fetch_property(
         TempRec.ucStatus = 128 | bitstring_octet(&TempBits, 0);
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES)
-        CurrentLog->iIndex = 0;
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES)
-        CurrentLog->ulRecordCount++;
+    TL_Store_Append(iLog, &TempRec);
 }
 
 /****************************************************************************
@@ -1782,3 +2160,431 @@ void trend_log_timer(
         }
     }
 }
+
+#ifdef TEST
+#include <assert.h>
+#include "ctest.h"
+
+/* a device whose logged properties cannot be read */
+uint32_t Device_Object_Instance_Number(
+    void)
+{
+    return 260001;
+}
+
+int Device_Read_Property(
+    BACNET_READ_PROPERTY_DATA * rpdata)
+{
+    rpdata->error_class = ERROR_CLASS_OBJECT;
+    rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+
+    return BACNET_STATUS_ERROR;
+}
+
+bool WPValidateArgType(
+    BACNET_APPLICATION_DATA_VALUE * pValue,
+    uint8_t ucExpectedTag,
+    BACNET_ERROR_CLASS * pErrorClass,
+    BACNET_ERROR_CODE * pErrorCode)
+{
+    if (pValue->tag != ucExpectedTag) {
+        *pErrorClass = ERROR_CLASS_PROPERTY;
+        *pErrorCode = ERROR_CODE_INVALID_DATA_TYPE;
+        return false;
+    }
+
+    return true;
+}
+
+/* what a restart does to the storage of a log */
+static bool testTrendLogReopen(
+    int iLog)
+{
+#if defined(TL_STORE_DIR)
+    TL_STORE *pStore = &Stores[iLog];
+
+    if (pStore->pMap != NULL) {
+#if defined(_WIN32)
+        UnmapViewOfFile(pStore->pMap);
+#else
+        munmap(pStore->pMap, pStore->ulMapSize);
+#endif
+    } else {
+        free(pStore->pHeader);
+    }
+    pStore->pMap = NULL;
+    pStore->pHeader = NULL;
+    pStore->pSlots = NULL;
+#endif
+
+    return TL_Store_Open(iLog);
+}
+
+static void testTrendLogRemove(
+    int iLog)
+{
+#if defined(TL_STORE_DIR)
+    char acPath[sizeof(TL_STORE_DIR) + 32];
+
+    sprintf(acPath, "%s/trendlog-%lu.dat", TL_STORE_DIR,
+        (unsigned long) Trend_Log_Index_To_Instance(iLog));
+    (void) remove(acPath);
+#endif
+    Stores[iLog].pHeader->ulMagic = 0;
+}
+
+static void testTrendLogAppend(
+    int iLog,
+    unsigned count,
+    time_t tStart,
+    time_t tStep)
+{
+    TL_DATA_REC TempRec;
+    unsigned i = 0;
+
+    memset(&TempRec, 0, sizeof(TempRec));
+    TempRec.ucRecType = TL_TYPE_UNSIGN;
+    for (i = 0; i < count; i++) {
+        TempRec.tTimeStamp = tStart + (time_t) i *tStep;
+        /* each record holds its own sequence number */
+        TempRec.Datum.ulUValue = LogInfo[iLog].ulTotalRecordCount + 1;
+        TL_Store_Append(iLog, &TempRec);
+    }
+}
+
+/* the sequence number of the record at a 1 based position, as it holds */
+static uint32_t testTrendLogEntry(
+    int iLog,
+    uint32_t ulEntry)
+{
+    return TL_Store_Slot(iLog, ulEntry - 1)->Record.Datum.ulUValue;
+}
+
+/* the log holds records ulFirst to ulLast in order */
+static bool testTrendLogHolds(
+    int iLog,
+    uint32_t ulFirst,
+    uint32_t ulLast)
+{
+    uint32_t ulCount = ulLast - ulFirst + 1;
+    uint32_t i = 0;
+
+    if ((LogInfo[iLog].ulRecordCount != ulCount) ||
+        (LogInfo[iLog].ulTotalRecordCount != ulLast)) {
+        return false;
+    }
+    for (i = 1; i <= ulCount; i++) {
+        if (testTrendLogEntry(iLog, i) != ulFirst + i - 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* TL_Store_Find_Time() against a scan of the whole log */
+static bool testTrendLogFindTime(
+    int iLog,
+    time_t tRefTime)
+{
+    uint32_t ulCount = LogInfo[iLog].ulRecordCount;
+    int32_t iAfter = -1;
+    int32_t iBefore = -1;
+    uint32_t i = 0;
+    time_t tStamp = 0;
+
+    for (i = 0; i < ulCount; i++) {
+        tStamp = TL_Store_Slot(iLog, i)->Record.tTimeStamp;
+        if ((iAfter < 0) && (tStamp > tRefTime)) {
+            iAfter = (int32_t) i;
+        }
+    }
+    for (i = ulCount; i > 0; i--) {
+        tStamp = TL_Store_Slot(iLog, i - 1)->Record.tTimeStamp;
+        if (tStamp < tRefTime) {
+            iBefore = (int32_t) i - 1;
+            break;
+        }
+    }
+
+    return (TL_Store_Find_Time(iLog, tRefTime, false) == iAfter) &&
+        (TL_Store_Find_Time(iLog, tRefTime, true) == iBefore);
+}
+
+static int testTrendLogReadRange(
+    int iLog,
+    int RequestType,
+    time_t tRefTime,
+    uint32_t ulRef,
+    int32_t Count,
+    BACNET_READ_RANGE_DATA * pRequest)
+{
+    static uint8_t apdu[MAX_APDU];
+
+    memset(pRequest, 0, sizeof(*pRequest));
+    pRequest->object_type = OBJECT_TRENDLOG;
+    pRequest->object_instance = Trend_Log_Index_To_Instance(iLog);
+    pRequest->object_property = PROP_LOG_BUFFER;
+    pRequest->array_index = BACNET_ARRAY_ALL;
+    pRequest->RequestType = RequestType;
+    pRequest->Overhead = 24;
+    pRequest->Count = Count;
+    if (RequestType == RR_BY_TIME) {
+        TL_Local_Time_To_BAC(&pRequest->Range.RefTime, tRefTime);
+    } else {
+        pRequest->Range.RefIndex = ulRef;
+    }
+
+    return rr_trend_log_encode(apdu, pRequest);
+}
+
+void testTrendLogStore(
+    Test * pTest)
+{
+    BACNET_READ_RANGE_DATA Request;
+    TL_STORE_SLOT *pSlot = NULL;
+    const int iLog = 0;
+    const time_t tStart = 1262304000;   /* records every 10 seconds from here */
+    uint32_t ulTotal = 0;
+    uint32_t i = 0;
+    int iLen = 0;
+    bool bAgree = true;
+
+    /* a new log */
+    (void) TL_Store_Open(iLog);
+    testTrendLogRemove(iLog);
+    ct_test(pTest, testTrendLogReopen(iLog));
+    ct_test(pTest, LogInfo[iLog].ulRecordCount == 0);
+    ct_test(pTest, LogInfo[iLog].ulTotalRecordCount == 0);
+
+    /* filling, and wrapping around, the ring */
+    testTrendLogAppend(iLog, TL_MAX_ENTRIES / 2, tStart, 10);
+    ct_test(pTest, testTrendLogHolds(iLog, 1, TL_MAX_ENTRIES / 2));
+    testTrendLogAppend(iLog, 2 * TL_MAX_ENTRIES,
+        tStart + 10 * (TL_MAX_ENTRIES / 2), 10);
+    ulTotal = TL_MAX_ENTRIES / 2 + 2 * TL_MAX_ENTRIES;
+    ct_test(pTest, testTrendLogHolds(iLog, ulTotal - TL_MAX_ENTRIES + 1,
+            ulTotal));
+
+    /* by time, between, on and either side of every record */
+    for (i = 0; i <= 10 * (ulTotal + 1); i += 5) {
+        bAgree &= testTrendLogFindTime(iLog, tStart - 10 + (time_t) i);
+    }
+    ct_test(pTest, bAgree);
+    /* through ReadRange, starting after and ending before record 100 */
+    iLen =
+        testTrendLogReadRange(iLog, RR_BY_TIME,
+        TL_Store_Slot(iLog, 99)->Record.tTimeStamp, 0, 5, &Request);
+    ct_test(pTest, iLen > 0);
+    ct_test(pTest, Request.ItemCount == 5);
+    ct_test(pTest, Request.FirstSequence == testTrendLogEntry(iLog, 101));
+    iLen =
+        testTrendLogReadRange(iLog, RR_BY_TIME,
+        TL_Store_Slot(iLog, 99)->Record.tTimeStamp, 0, -5, &Request);
+    ct_test(pTest, Request.ItemCount == 5);
+    ct_test(pTest, Request.FirstSequence == testTrendLogEntry(iLog, 95));
+    iLen =
+        testTrendLogReadRange(iLog, RR_BY_TIME, tStart + 10 * (time_t) ulTotal,
+        0, 5, &Request);
+    ct_test(pTest, iLen == 0);
+    ct_test(pTest, Request.ItemCount == 0);
+    /* by position and by sequence agree */
+    iLen = testTrendLogReadRange(iLog, RR_BY_POSITION, 0, 200, 3, &Request);
+    ct_test(pTest, Request.ItemCount == 3);
+    iLen =
+        testTrendLogReadRange(iLog, RR_BY_SEQUENCE, 0,
+        testTrendLogEntry(iLog, 200), 3, &Request);
+    ct_test(pTest, Request.ItemCount == 3);
+    ct_test(pTest, Request.FirstSequence == testTrendLogEntry(iLog, 200));
+
+    /* a restart keeps the log */
+    ct_test(pTest, !testTrendLogReopen(iLog));
+    ct_test(pTest, testTrendLogHolds(iLog, ulTotal - TL_MAX_ENTRIES + 1,
+            ulTotal));
+    ct_test(pTest, Stores[iLog].ulOrdered == TL_MAX_ENTRIES);
+    /* a torn newest record is dropped */
+    pSlot = TL_Store_Slot(iLog, TL_MAX_ENTRIES - 1);
+    pSlot->Record.Datum.ulUValue ^= 0x100;
+    ct_test(pTest, !testTrendLogReopen(iLog));
+    ulTotal--;
+    ct_test(pTest, testTrendLogHolds(iLog, ulTotal - TL_MAX_ENTRIES + 2,
+            ulTotal));
+    /* and the log carries on from the record before it */
+    testTrendLogAppend(iLog, 1, tStart + 10 * (time_t) ulTotal, 10);
+    ulTotal++;
+    ct_test(pTest, testTrendLogHolds(iLog, ulTotal - TL_MAX_ENTRIES + 1,
+            ulTotal));
+    /* a torn record further back loses it and all before it */
+    pSlot = TL_Store_Slot(iLog, 10);
+    pSlot->ulSequence++;
+    ct_test(pTest, !testTrendLogReopen(iLog));
+    ct_test(pTest, testTrendLogHolds(iLog, ulTotal - TL_MAX_ENTRIES + 12,
+            ulTotal));
+
+    /* a clock set back, by time falls back to a scan */
+    testTrendLogAppend(iLog, 20, tStart + 10 * (time_t) ulTotal - 500, 10);
+    ulTotal += 20;
+    ct_test(pTest, Stores[iLog].ulOrdered == 20);
+    for (i = 0; i <= 10 * (ulTotal + 1); i += 5) {
+        bAgree &= testTrendLogFindTime(iLog, tStart - 10 + (time_t) i);
+    }
+    ct_test(pTest, bAgree);
+    ct_test(pTest, !testTrendLogReopen(iLog));
+    ct_test(pTest, Stores[iLog].ulOrdered == 20);
+    /* until the record before the clock went back is pushed out */
+    testTrendLogAppend(iLog, TL_MAX_ENTRIES - 20, tStart + 10 * (time_t) ulTotal,
+        10);
+    ulTotal += TL_MAX_ENTRIES - 20;
+    ct_test(pTest, Stores[iLog].ulOrdered == TL_MAX_ENTRIES);
+
+    /* a purge survives a restart, and sequence numbers carry on */
+    TL_Store_Purge(iLog);
+    ct_test(pTest, LogInfo[iLog].ulRecordCount == 0);
+    ct_test(pTest, !testTrendLogReopen(iLog));
+    ct_test(pTest, LogInfo[iLog].ulRecordCount == 0);
+    ct_test(pTest, LogInfo[iLog].ulTotalRecordCount == ulTotal);
+    testTrendLogAppend(iLog, 3, tStart + 10 * (time_t) ulTotal, 10);
+    ct_test(pTest, !testTrendLogReopen(iLog));
+    ct_test(pTest, testTrendLogHolds(iLog, ulTotal + 1, ulTotal + 3));
+
+    /* sequence numbers wrapping through zero */
+    testTrendLogRemove(iLog);
+    ct_test(pTest, testTrendLogReopen(iLog));
+    LogInfo[iLog].ulTotalRecordCount = 0xFFFFFFF0UL;
+    TL_Store_Purge(iLog);
+    testTrendLogAppend(iLog, 40, tStart, 10);
+    ct_test(pTest, !testTrendLogReopen(iLog));
+    ct_test(pTest, testTrendLogHolds(iLog, 0xFFFFFFF1UL, 0x18));
+    iLen =
+        testTrendLogReadRange(iLog, RR_BY_SEQUENCE, 0, 5, 4, &Request);
+    ct_test(pTest, Request.ItemCount == 4);
+    ct_test(pTest, Request.FirstSequence == 5);
+    iLen = testTrendLogReadRange(iLog, RR_BY_POSITION, 0, 21, 1, &Request);
+    ct_test(pTest, Request.ItemCount == 1);
+    ct_test(pTest, testTrendLogEntry(iLog, 21) == 5);
+
+    testTrendLogRemove(iLog);
+    (void) testTrendLogReopen(iLog);
+    testTrendLogRemove(iLog);
+}
+
+#ifdef TEST_TREND_LOG
+int main(
+    void)
+{
+    Test *pTest;
+    bool rc;
+
+    pTest = ct_create("BACnet Trend Log", NULL);
+    /* individual tests */
+    rc = ct_addTestFunction(pTest, testTrendLogStore);
+    assert(rc);
+
+    ct_setStream(pTest, stdout);
+    ct_run(pTest);
+    (void) ct_report(pTest);
+    ct_destroy(pTest);
+
+    return 0;
+}
+#endif /* TEST_TREND_LOG */
+
+#ifdef TEST_TREND_LOG_BENCHMARK
+/* Times a Trend Log of TL_MAX_ENTRIES records taken every 15 minutes:
+    - appending records to it, once full,
+    - opening it again as after a restart,
+    - ReadRange of 20 records by position, by sequence and by time,
+      from random places in the log.
+   Usage: trendlog_bench [milliseconds per case] */
+static double Benchmark_Milliseconds = 200;
+
+static double benchmarkElapsed(
+    clock_t start)
+{
+    return (double) (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static void benchmarkReadRange(
+    const char *pName,
+    int RequestType)
+{
+    BACNET_READ_RANGE_DATA Request;
+    uint32_t ulCount = LogInfo[0].ulRecordCount;
+    uint32_t ulFirstSeq = LogInfo[0].ulTotalRecordCount - (ulCount - 1);
+    uint32_t ulPosition = 0;
+    time_t tFirst = TL_Store_Slot(0, 0)->Record.tTimeStamp;
+    double elapsed = 0;
+    long operations = 0;
+    long items = 0;
+    clock_t start;
+
+    start = clock();
+    do {
+        ulPosition = (uint32_t) (((unsigned long) rand() << 15) ^ rand());
+        ulPosition %= ulCount;
+        (void) testTrendLogReadRange(0, RequestType,
+            tFirst + 900 * (time_t) ulPosition - 1,
+            (RequestType == RR_BY_SEQUENCE) ? ulFirstSeq + ulPosition :
+            ulPosition + 1, 20, &Request);
+        items += Request.ItemCount;
+        operations++;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f us, %.1f records\n", pName,
+        elapsed * 1e3 / operations, (double) items / operations);
+}
+
+int main(
+    int argc,
+    char *argv[])
+{
+    double elapsed = 0;
+    long operations = 0;
+    clock_t start;
+
+    if (argc > 1) {
+        Benchmark_Milliseconds = atof(argv[1]);
+    }
+    printf("Trend Log of %lu records, %s\n", (unsigned long) TL_MAX_ENTRIES,
+#if defined(TL_STORE_DIR)
+        "mapped from " TL_STORE_DIR
+#else
+        "in RAM"
+#endif
+        );
+    (void) TL_Store_Open(0);
+    testTrendLogRemove(0);
+    (void) testTrendLogReopen(0);
+    testTrendLogAppend(0, TL_MAX_ENTRIES, 1262304000, 900);
+
+    start = clock();
+    do {
+        testTrendLogAppend(0, 1000,
+            TL_Store_Slot(0, TL_MAX_ENTRIES - 1)->Record.tTimeStamp + 900,
+            900);
+        operations += 1000;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f us\n", "append", elapsed * 1e3 / operations);
+
+    operations = 0;
+    start = clock();
+    do {
+        (void) testTrendLogReopen(0);
+        operations++;
+        elapsed = benchmarkElapsed(start);
+    } while (elapsed < Benchmark_Milliseconds);
+    printf("  %-26s : %10.3f ms\n", "open", elapsed / operations);
+
+    benchmarkReadRange("ReadRange by position", RR_BY_POSITION);
+    benchmarkReadRange("ReadRange by sequence", RR_BY_SEQUENCE);
+    benchmarkReadRange("ReadRange by time", RR_BY_TIME);
+
+    testTrendLogRemove(0);
+    (void) testTrendLogReopen(0);
+    testTrendLogRemove(0);
+
+    return 0;
+}
+#endif /* TEST_TREND_LOG_BENCHMARK */
+#endif /* TEST */
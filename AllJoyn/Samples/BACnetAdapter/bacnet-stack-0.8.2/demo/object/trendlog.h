@@ -80,7 +80,15 @@ extern "C" {
 #define TL_T_START_WILD 1       /* Start time is wild carded */
 #define TL_T_STOP_WILD  2       /* Stop Time is wild carded */
 
+#ifndef TL_MAX_ENTRIES
 #define TL_MAX_ENTRIES 1000     /* Entries per datalog */
+#endif
+
+/* Define TL_STORE_DIR as a directory, e.g. -DTL_STORE_DIR=\"/var/lib/bacnet\",
+ * to keep the records of each log in a file there which is mapped into
+ * memory, so that the logs survive a restart. Without it they are kept
+ * in RAM only.
+ */
 
 /* Structure containing config and status info for a Trend Log */
 
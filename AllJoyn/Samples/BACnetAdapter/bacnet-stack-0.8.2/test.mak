@@ -13,7 +13,7 @@ all: abort address arf awf bacapp bacdcode bacerror bacint bacstr \
 	cov crc datetime dcc event filename fifo getevent iam ihave \
 	indtext keylist key memcopy npdu proplist ptransfer \
 	rd reject ringbuf rp rpm sbuf timesync \
-	whohas whois wp objects lighting
+	whohas whois wp objects lighting h_cov
 
 clean: logfile
 	rm ${LOGFILE}
@@ -71,6 +71,11 @@ cov: logfile test/cov.mak
 	( ./test/cov >> ${LOGFILE} )
 	$(MAKE) -s -C test -f cov.mak clean
 
+h_cov: logfile demo/handler/h_cov.mak
+	$(MAKE) -s -C demo/handler -f h_cov.mak clean all
+	( ./demo/handler/cov_handler >> ${LOGFILE} )
+	$(MAKE) -s -C demo/handler -f h_cov.mak clean
+
 crc: logfile test/crc.mak
 	$(MAKE) -s -C test -f crc.mak clean all
 	( ./test/crc >> ${LOGFILE} )
@@ -206,7 +211,8 @@ wp: logfile test/wp.mak
 	( ./test/wp >> ${LOGFILE} )
 	$(MAKE) -s -C test -f wp.mak clean
 
-objects: ai ao av bi bo bv csv lc lo lso lsp mso msv ms-input command
+objects: ai ao av bi bo bv csv lc lo lso lsp mso msv ms-input command \
+	trendlog
 
 ai: logfile demo/object/ai.mak
 	$(MAKE) -s -C demo/object -f ai.mak clean all
@@ -286,3 +292,8 @@ msv: logfile demo/object/msv.mak
 	$(MAKE) -s -C demo/object -f msv.mak clean all
 	( ./demo/object/multistate_value >> ${LOGFILE} )
 	$(MAKE) -s -C demo/object -f msv.mak clean
+
+trendlog: logfile demo/object/trendlog.mak
+	$(MAKE) -s -C demo/object -f trendlog.mak clean all
+	( ./demo/object/trendlog >> ${LOGFILE} )
+	$(MAKE) -s -C demo/object -f trendlog.mak clean
@@ -66,7 +66,7 @@ namespace AdapterLib
     static const string PRESENCE_QUERY = string("coap://") + OC_MULTICAST_PREFIX + OC_RSRVD_PRESENCE_URI;
     static const string RT_PRESENCE = OC_RSRVD_RESOURCE_TYPE_PRESENCE;
 
-    static const int64 OCProcessTimeout = 100;            //in msec
+    static const uint32_t OCProcessTimeout = 100;         //in msec, longest wait for a message between OCProcess calls
     static const int64 DeviceDiscoveryTimeout = 60000;            //in msec
     static const int64 DeviceMonitorTimeout = 60000;            //in msec
     static const DWORD ResourceDiscoveryTimeout = 15000;     //in msecs
@@ -159,7 +159,7 @@ namespace AdapterLib
                     AutoLock sync(adapterInstance->m_ocStackLock);
                 OCProcess();
                 }
-                Sleep(OCProcessTimeout);
+                OCProcessWait(OCProcessTimeout);
             }
         })
         );
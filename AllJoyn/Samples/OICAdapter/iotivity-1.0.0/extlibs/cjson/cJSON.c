@@ -69,6 +69,48 @@ void cJSON_InitHooks(cJSON_Hooks* hooks)
 	cJSON_free	 = (hooks->free_fn)?hooks->free_fn:free;
 }
 
+/* Item flags, telling cJSON_Delete what not to free. */
+#define cJSON_InArena 1			/* The item and its valuestring live in an arena. */
+#define cJSON_StringInArena 2	/* The item's string lives in an arena. */
+#define cJSON_ArenaRoot 4		/* The item heads a cJSON_Arena, and owns its blocks. */
+
+/* cJSON_ParseArena bump allocates from a chain of blocks, each twice the size of the last. */
+typedef struct cJSON_Block {struct cJSON_Block *next;size_t size,used;} cJSON_Block;
+typedef struct cJSON_Arena {cJSON root;cJSON_Block *blocks;size_t next_size;} cJSON_Arena;
+#define ARENA_ALIGN sizeof(double)
+#define ARENA_HEADER ((sizeof(cJSON_Block)+ARENA_ALIGN-1)&~(ARENA_ALIGN-1))
+
+static void *arena_alloc(cJSON_Arena *arena,size_t sz)
+{
+	cJSON_Block *b=arena->blocks;
+	sz=(sz+ARENA_ALIGN-1)&~(ARENA_ALIGN-1);
+	if (!b || b->size-b->used<sz)
+	{
+		size_t size=arena->next_size<sz?sz:arena->next_size;
+		if (!(b=(cJSON_Block*)cJSON_malloc(ARENA_HEADER+size))) return 0;
+		b->next=arena->blocks;b->size=size;b->used=0;
+		arena->blocks=b;arena->next_size=size*2;
+	}
+	b->used+=sz;
+	return (char*)b+ARENA_HEADER+b->used-sz;
+}
+
+static void arena_free(cJSON_Arena *arena)
+{
+	cJSON_Block *b=arena->blocks,*next;
+	while (b) {next=b->next;cJSON_free(b);b=next;}
+	cJSON_free(arena);
+}
+
+/* Case folded FNV-1a of an object key. Never 0, which marks an item whose hash is unknown. */
+static unsigned hash_key(const char *str)
+{
+	unsigned h=2166136261u;
+	if (!str) return 0;
+	while (*str) h=(h^(unsigned)tolower(*(const unsigned char *)str++))*16777619u;
+	return h?h:1;
+}
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(void)
 {
@@ -77,6 +119,16 @@ static cJSON *cJSON_New_Item(void)
 	return node;
 }
 
+/* Constructor for the parser, from the arena if there is one. */
+static cJSON *new_item(cJSON_Arena *arena)
+{
+	cJSON *node;
+	if (!arena) return cJSON_New_Item();
+	node=(cJSON*)arena_alloc(arena,sizeof(cJSON));
+	if (node) {memset(node,0,sizeof(cJSON));node->flags=cJSON_InArena;}
+	return node;
+}
+
 /* Delete a cJSON structure. */
 void cJSON_Delete(cJSON *c)
 {
@@ -85,9 +137,10 @@ void cJSON_Delete(cJSON *c)
 	{
 		next=c->next;
 		if (!(c->type&cJSON_IsReference) && c->child) cJSON_Delete(c->child);
-		if (!(c->type&cJSON_IsReference) && c->valuestring) cJSON_free(c->valuestring);
-		if (c->string) cJSON_free(c->string);
-		cJSON_free(c);
+		if (!(c->type&cJSON_IsReference) && c->valuestring && !(c->flags&cJSON_InArena)) cJSON_free(c->valuestring);
+		if (c->string && !(c->flags&cJSON_StringInArena)) cJSON_free(c->string);
+		if (c->flags&cJSON_ArenaRoot) arena_free((cJSON_Arena*)c);
+		else if (!(c->flags&cJSON_InArena)) cJSON_free(c);
 		c=next;
 	}
 }
@@ -114,27 +167,27 @@ static const char *parse_number(cJSON *item,const char *num)
 	return num;
 }
 
-/* Render the number nicely from the given item into a string. */
-static char *print_number(cJSON *item)
+/* The printers return the length of the text they render, and write it to out unless out is 0. */
+#define PRINT_FAIL ((size_t)-1)
+
+/* Render the number nicely from the given item. */
+static size_t print_number(cJSON *item,char *out)
 {
-	char *str;
+	char buf[64],*str=buf;size_t len;	/* This is a nice tradeoff. */
 	double d=item->valuedouble;
 	if (fabs(((double)item->valueint)-d)<=DBL_EPSILON && d<=INT_MAX && d>=INT_MIN)
 	{
-		str=(char*)cJSON_malloc(21);	/* 2^64+1 can be represented in 21 chars. */
-		if (str) sprintf(str,"%d",item->valueint);
+		unsigned u=item->valueint<0?0u-(unsigned)item->valueint:(unsigned)item->valueint;
+		str=buf+sizeof(buf);
+		do *--str=(char)('0'+u%10); while (u/=10);
+		if (item->valueint<0) *--str='-';
+		len=buf+sizeof(buf)-str;
 	}
-	else
-	{
-		str=(char*)cJSON_malloc(64);	/* This is a nice tradeoff. */
-		if (str)
-		{
-			if (fabs(floor(d)-d)<=DBL_EPSILON && fabs(d)<1.0e60)sprintf(str,"%.0f",d);
-			else if (fabs(d)<1.0e-6 || fabs(d)>1.0e9)			sprintf(str,"%e",d);
-			else												sprintf(str,"%f",d);
-		}
-	}
-	return str;
+	else if (fabs(floor(d)-d)<=DBL_EPSILON && fabs(d)<1.0e60)	len=sprintf(buf,"%.0f",d);
+	else if (fabs(d)<1.0e-6 || fabs(d)>1.0e9)					len=sprintf(buf,"%e",d);
+	else														len=sprintf(buf,"%f",d);
+	if (out) memcpy(out,str,len);
+	return len;
 }
 
 static unsigned parse_hex4(const char *str)
@@ -152,14 +205,14 @@ static unsigned parse_hex4(const char *str)
 
 /* Parse the input text into an unescaped cstring, and populate item. */
 static const unsigned char firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
-static const char *parse_string(cJSON *item,const char *str)
+static const char *parse_string(cJSON *item,const char *str,cJSON_Arena *arena)
 {
 	const char *ptr=str+1;char *ptr2;char *out;int len=0;unsigned uc,uc2;
 	if (*str!='\"') {ep=str;return 0;}	/* not a string! */
 	
 	while (*ptr!='\"' && *ptr && ++len) if (*ptr++ == '\\') ptr++;	/* Skip escaped quotes. */
 	
-	out=(char*)cJSON_malloc(len+1);	/* This is how long we need for the string, roughly. */
+	out=(char*)(arena?arena_alloc(arena,len+1):cJSON_malloc(len+1));	/* This is how long we need for the string, roughly. */
 	if (!out) return 0;
 	
 	ptr=str+1;ptr2=out;
@@ -212,15 +265,17 @@ static const char *parse_string(cJSON *item,const char *str)
 }
 
 /* Render the cstring provided to an escaped version that can be printed. */
-static char *print_string_ptr(const char *str)
+static size_t print_string_ptr(const char *str,char *out)
 {
-	const char *ptr;char *ptr2,*out;int len=0;unsigned char token;
-	
-	if (!str) return cJSON_strdup("");
-	ptr=str;while ((token=*ptr) && ++len) {if (strchr("\"\\\b\f\n\r\t",token)) len++; else if (token<32) len+=5;ptr++;}
+	static const char hex[]="0123456789abcdef";
+	const char *ptr;char *ptr2;size_t len=2;unsigned char token;
 	
-	out=(char*)cJSON_malloc(len+3);
-	if (!out) return 0;
+	if (!str) str="";
+	if (!out)
+	{
+		for (ptr=str;(token=*ptr);ptr++) {if (strchr("\"\\\b\f\n\r\t",token)) len+=2; else if (token<32) len+=6; else len++;}
+		return len;
+	}
 
 	ptr2=out;ptr=str;
 	*ptr2++='\"';
@@ -239,36 +294,30 @@ static char *print_string_ptr(const char *str)
 				case '\n':	*ptr2++='n';	break;
 				case '\r':	*ptr2++='r';	break;
 				case '\t':	*ptr2++='t';	break;
-				default: sprintf(ptr2,"u%04x",token);ptr2+=5;	break;	/* escape and print */
+				default: *ptr2++='u';*ptr2++='0';*ptr2++='0';*ptr2++=hex[token>>4];*ptr2++=hex[token&15];	break;	/* escape and print */
 			}
 		}
 	}
-	*ptr2++='\"';*ptr2++=0;
-	return out;
+	*ptr2++='\"';
+	return ptr2-out;
 }
-/* Invote print_string_ptr (which is useful) on an item. */
-static char *print_string(cJSON *item)	{return print_string_ptr(item->valuestring);}
 
 /* Predeclare these prototypes. */
-static const char *parse_value(cJSON *item,const char *value);
-static char *print_value(cJSON *item,int depth,int fmt);
-static const char *parse_array(cJSON *item,const char *value);
-static char *print_array(cJSON *item,int depth,int fmt);
-static const char *parse_object(cJSON *item,const char *value);
-static char *print_object(cJSON *item,int depth,int fmt);
+static const char *parse_value(cJSON *item,const char *value,cJSON_Arena *arena);
+static size_t print_value(cJSON *item,int depth,int fmt,char *out);
+static const char *parse_array(cJSON *item,const char *value,cJSON_Arena *arena);
+static size_t print_array(cJSON *item,int depth,int fmt,char *out);
+static const char *parse_object(cJSON *item,const char *value,cJSON_Arena *arena);
+static size_t print_object(cJSON *item,int depth,int fmt,char *out);
 
 /* Utility to jump whitespace and cr/lf */
 static const char *skip(const char *in) {while (in && *in && (unsigned char)*in<=32) in++; return in;}
 
-/* Parse an object - create a new root, and populate. */
-cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int require_null_terminated)
+/* Populate a new root c, from the arena if there is one. */
+static cJSON *parse_root(cJSON *c,const char *value,const char **return_parse_end,int require_null_terminated,cJSON_Arena *arena)
 {
 	const char *end=0;
-	cJSON *c=cJSON_New_Item();
-	ep=0;
-	if (!c) return 0;       /* memory fail */
-
-	end=parse_value(c,skip(value));
+	end=parse_value(c,skip(value),arena);
 	if (!end)	{cJSON_Delete(c);return 0;}	/* parse failure. ep is set. */
 
 	/* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
@@ -276,48 +325,79 @@ cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int r
 	if (return_parse_end) *return_parse_end=end;
 	return c;
 }
+
+/* Parse an object - create a new root, and populate. */
+cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int require_null_terminated)
+{
+	cJSON *c=cJSON_New_Item();
+	ep=0;
+	if (!c) return 0;       /* memory fail */
+	return parse_root(c,value,return_parse_end,require_null_terminated,0);
+}
 /* Default options for cJSON_Parse */
 cJSON *cJSON_Parse(const char *value) {return cJSON_ParseWithOpts(value,0,0);}
 
-/* Render a cJSON item/entity/structure to text. */
-char *cJSON_Print(cJSON *item)				{return print_value(item,0,1);}
-char *cJSON_PrintUnformatted(cJSON *item)	{return print_value(item,0,0);}
+/* Parse into an arena whose first block fits the items of typical JSON of this length. */
+cJSON *cJSON_ParseArena(const char *value)
+{
+	cJSON_Arena *arena=(cJSON_Arena*)cJSON_malloc(sizeof(cJSON_Arena));
+	ep=0;
+	if (!arena) return 0;	/* memory fail */
+	memset(arena,0,sizeof(cJSON_Arena));
+	arena->root.flags=cJSON_InArena|cJSON_ArenaRoot;
+	arena->next_size=(value?strlen(value)*3:0)+256;
+	return parse_root(&arena->root,value,0,0,arena);
+}
+
+/* Render a cJSON item/entity/structure to text, sized first so that it is written into one allocation. */
+static char *print(cJSON *item,int fmt)
+{
+	size_t len;char *out;
+	if (!item) return 0;
+	len=print_value(item,0,fmt,0);
+	if (len==PRINT_FAIL || !(out=(char*)cJSON_malloc(len+1))) return 0;
+	print_value(item,0,fmt,out);out[len]=0;
+	return out;
+}
+char *cJSON_Print(cJSON *item)				{return print(item,1);}
+char *cJSON_PrintUnformatted(cJSON *item)	{return print(item,0);}
 
 /* Parser core - when encountering text, process appropriately. */
-static const char *parse_value(cJSON *item,const char *value)
+static const char *parse_value(cJSON *item,const char *value,cJSON_Arena *arena)
 {
 	if (!value)						return 0;	/* Fail on null. */
 	if (!strncmp(value,"null",4))	{ item->type=cJSON_NULL;  return value+4; }
 	if (!strncmp(value,"false",5))	{ item->type=cJSON_False; return value+5; }
 	if (!strncmp(value,"true",4))	{ item->type=cJSON_True; item->valueint=1;	return value+4; }
-	if (*value=='\"')				{ return parse_string(item,value); }
+	if (*value=='\"')				{ return parse_string(item,value,arena); }
 	if (*value=='-' || (*value>='0' && *value<='9'))	{ return parse_number(item,value); }
-	if (*value=='[')				{ return parse_array(item,value); }
-	if (*value=='{')				{ return parse_object(item,value); }
+	if (*value=='[')				{ return parse_array(item,value,arena); }
+	if (*value=='{')				{ return parse_object(item,value,arena); }
 
 	ep=value;return 0;	/* failure. */
 }
 
+/* Render a literal. */
+static size_t print_literal(const char *str,size_t len,char *out) {if (out) memcpy(out,str,len);return len;}
+
 /* Render a value to text. */
-static char *print_value(cJSON *item,int depth,int fmt)
+static size_t print_value(cJSON *item,int depth,int fmt,char *out)
 {
-	char *out=0;
-	if (!item) return 0;
 	switch ((item->type)&255)
 	{
-		case cJSON_NULL:	out=cJSON_strdup("null");	break;
-		case cJSON_False:	out=cJSON_strdup("false");break;
-		case cJSON_True:	out=cJSON_strdup("true"); break;
-		case cJSON_Number:	out=print_number(item);break;
-		case cJSON_String:	out=print_string(item);break;
-		case cJSON_Array:	out=print_array(item,depth,fmt);break;
-		case cJSON_Object:	out=print_object(item,depth,fmt);break;
+		case cJSON_NULL:	return print_literal("null",4,out);
+		case cJSON_False:	return print_literal("false",5,out);
+		case cJSON_True:	return print_literal("true",4,out);
+		case cJSON_Number:	return print_number(item,out);
+		case cJSON_String:	return print_string_ptr(item->valuestring,out);
+		case cJSON_Array:	return print_array(item,depth,fmt,out);
+		case cJSON_Object:	return print_object(item,depth,fmt,out);
 	}
-	return out;
+	return PRINT_FAIL;
 }
 
 /* Build an array from input text. */
-static const char *parse_array(cJSON *item,const char *value)
+static const char *parse_array(cJSON *item,const char *value,cJSON_Arena *arena)
 {
 	cJSON *child;
 	if (*value!='[')	{ep=value;return 0;}	/* not an array! */
@@ -326,17 +406,17 @@ static const char *parse_array(cJSON *item,const char *value)
 	value=skip(value+1);
 	if (*value==']') return value+1;	/* empty array. */
 
-	item->child=child=cJSON_New_Item();
+	item->child=child=new_item(arena);
 	if (!item->child) return 0;		 /* memory fail */
-	value=skip(parse_value(child,skip(value)));	/* skip any spacing, get the value. */
+	value=skip(parse_value(child,skip(value),arena));	/* skip any spacing, get the value. */
 	if (!value) return 0;
 
 	while (*value==',')
 	{
-		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item())) return 0; 	/* memory fail */
-		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_value(child,skip(value+1)));
+		cJSON *new_child;
+		if (!(new_child=new_item(arena))) return 0; 	/* memory fail */
+		child->next=new_child;new_child->prev=child;child=new_child;
+		value=skip(parse_value(child,skip(value+1),arena));
 		if (!value) return 0;	/* memory fail */
 	}
 
@@ -345,65 +425,24 @@ static const char *parse_array(cJSON *item,const char *value)
 }
 
 /* Render an array to text */
-static char *print_array(cJSON *item,int depth,int fmt)
+static size_t print_array(cJSON *item,int depth,int fmt,char *out)
 {
-	char **entries;
-	char *out=0,*ptr,*ret;int len=5;
-	cJSON *child=item->child;
-	int numentries=0,i=0,fail=0;
-	
-	/* How many entries in the array? */
-	while (child) numentries++,child=child->next;
-	/* Explicitly handle numentries==0 */
-	if (!numentries)
-	{
-		out=(char*)cJSON_malloc(3);
-		if (out) strcpy(out,"[]");
-		return out;
-	}
-	/* Allocate an array to hold the values for each */
-	entries=(char**)cJSON_malloc(numentries*sizeof(char*));
-	if (!entries) return 0;
-	memset(entries,0,numentries*sizeof(char*));
-	/* Retrieve all the results: */
-	child=item->child;
-	while (child && !fail)
+	cJSON *child=item->child;size_t len=1,n;
+	if (out) *out='[';
+	while (child)
 	{
-		ret=print_value(child,depth+1,fmt);
-		entries[i++]=ret;
-		if (ret) len+=strlen(ret)+2+(fmt?1:0); else fail=1;
+		n=print_value(child,depth+1,fmt,out?out+len:0);
+		if (n==PRINT_FAIL) return PRINT_FAIL;
+		len+=n;
+		if (child->next) {if (out) out[len]=',';len++;if (fmt) {if (out) out[len]=' ';len++;}}
 		child=child->next;
 	}
-	
-	/* If we didn't fail, try to malloc the output string */
-	if (!fail) out=(char*)cJSON_malloc(len);
-	/* If that fails, we fail. */
-	if (!out) fail=1;
-
-	/* Handle failure. */
-	if (fail)
-	{
-		for (i=0;i<numentries;i++) if (entries[i]) cJSON_free(entries[i]);
-		cJSON_free(entries);
-		return 0;
-	}
-	
-	/* Compose the output array. */
-	*out='[';
-	ptr=out+1;*ptr=0;
-	for (i=0;i<numentries;i++)
-	{
-		strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-		if (i!=numentries-1) {*ptr++=',';if(fmt)*ptr++=' ';*ptr=0;}
-		cJSON_free(entries[i]);
-	}
-	cJSON_free(entries);
-	*ptr++=']';*ptr++=0;
-	return out;	
+	if (out) out[len]=']';
+	return len+1;
 }
 
 /* Build an object from the text. */
-static const char *parse_object(cJSON *item,const char *value)
+static const char *parse_object(cJSON *item,const char *value,cJSON_Arena *arena)
 {
 	cJSON *child;
 	if (*value!='{')	{ep=value;return 0;}	/* not an object! */
@@ -412,25 +451,27 @@ static const char *parse_object(cJSON *item,const char *value)
 	value=skip(value+1);
 	if (*value=='}') return value+1;	/* empty array. */
 	
-	item->child=child=cJSON_New_Item();
+	item->child=child=new_item(arena);
 	if (!item->child) return 0;
-	value=skip(parse_string(child,skip(value)));
+	value=skip(parse_string(child,skip(value),arena));
 	if (!value) return 0;
-	child->string=child->valuestring;child->valuestring=0;
+	child->string=child->valuestring;child->valuestring=0;child->hash=hash_key(child->string);
+	if (arena) child->flags|=cJSON_StringInArena;
 	if (*value!=':') {ep=value;return 0;}	/* fail! */
-	value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
+	value=skip(parse_value(child,skip(value+1),arena));	/* skip any spacing, get the value. */
 	if (!value) return 0;
 	
 	while (*value==',')
 	{
-		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item()))	return 0; /* memory fail */
-		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_string(child,skip(value+1)));
+		cJSON *new_child;
+		if (!(new_child=new_item(arena)))	return 0; /* memory fail */
+		child->next=new_child;new_child->prev=child;child=new_child;
+		value=skip(parse_string(child,skip(value+1),arena));
 		if (!value) return 0;
-		child->string=child->valuestring;child->valuestring=0;
+		child->string=child->valuestring;child->valuestring=0;child->hash=hash_key(child->string);
+		if (arena) child->flags|=cJSON_StringInArena;
 		if (*value!=':') {ep=value;return 0;}	/* fail! */
-		value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
+		value=skip(parse_value(child,skip(value+1),arena));	/* skip any spacing, get the value. */
 		if (!value) return 0;
 	}
 	
@@ -439,100 +480,67 @@ static const char *parse_object(cJSON *item,const char *value)
 }
 
 /* Render an object to text. */
-static char *print_object(cJSON *item,int depth,int fmt)
+static size_t print_object(cJSON *item,int depth,int fmt,char *out)
 {
-	char **entries=0,**names=0;
-	char *out=0,*ptr,*ret,*str;int len=7,i=0,j;
-	cJSON *child=item->child;
-	int numentries=0,fail=0;
-	/* Count the number of entries. */
-	while (child) numentries++,child=child->next;
+	cJSON *child=item->child;size_t len=1,n;int i;
+	if (out) *out='{';
+	if (fmt) {if (out) out[len]='\n';len++;}
 	/* Explicitly handle empty object case */
-	if (!numentries)
+	if (!child)
 	{
-		out=(char*)cJSON_malloc(fmt?depth+4:3);
-		if (!out)	return 0;
-		ptr=out;*ptr++='{';
-		if (fmt) {*ptr++='\n';for (i=0;i<depth-1;i++) *ptr++='\t';}
-		*ptr++='}';*ptr++=0;
-		return out;
+		if (fmt) for (i=0;i<depth-1;i++) {if (out) out[len]='\t';len++;}
+		if (out) out[len]='}';
+		return len+1;
 	}
-	/* Allocate space for the names and the objects */
-	entries=(char**)cJSON_malloc(numentries*sizeof(char*));
-	if (!entries) return 0;
-	names=(char**)cJSON_malloc(numentries*sizeof(char*));
-	if (!names) {cJSON_free(entries);return 0;}
-	memset(entries,0,sizeof(char*)*numentries);
-	memset(names,0,sizeof(char*)*numentries);
-
-	/* Collect all the results into our arrays: */
-	child=item->child;depth++;if (fmt) len+=depth;
+	depth++;
 	while (child)
 	{
-		names[i]=str=print_string_ptr(child->string);
-		entries[i++]=ret=print_value(child,depth,fmt);
-		if (str && ret) len+=strlen(ret)+strlen(str)+2+(fmt?2+depth:0); else fail=1;
+		if (fmt) {if (out) memset(out+len,'\t',depth);len+=depth;}
+		len+=print_string_ptr(child->string,out?out+len:0);
+		if (out) out[len]=':';
+		len++;
+		if (fmt) {if (out) out[len]='\t';len++;}
+		n=print_value(child,depth,fmt,out?out+len:0);
+		if (n==PRINT_FAIL) return PRINT_FAIL;
+		len+=n;
+		if (child->next) {if (out) out[len]=',';len++;}
+		if (fmt) {if (out) out[len]='\n';len++;}
 		child=child->next;
 	}
-	
-	/* Try to allocate the output string */
-	if (!fail) out=(char*)cJSON_malloc(len);
-	if (!out) fail=1;
-
-	/* Handle failure */
-	if (fail)
-	{
-		for (i=0;i<numentries;i++) {if (names[i]) cJSON_free(names[i]);if (entries[i]) cJSON_free(entries[i]);}
-		cJSON_free(names);cJSON_free(entries);
-		return 0;
-	}
-	
-	/* Compose the output: */
-	*out='{';ptr=out+1;if (fmt)*ptr++='\n';*ptr=0;
-	for (i=0;i<numentries;i++)
-	{
-		if (fmt) for (j=0;j<depth;j++) *ptr++='\t';
-		strcpy(ptr,names[i]);ptr+=strlen(names[i]);
-		*ptr++=':';if (fmt) *ptr++='\t';
-		strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-		if (i!=numentries-1) *ptr++=',';
-		if (fmt) *ptr++='\n';*ptr=0;
-		cJSON_free(names[i]);cJSON_free(entries[i]);
-	}
-	
-	cJSON_free(names);cJSON_free(entries);
-	if (fmt) for (i=0;i<depth-1;i++) *ptr++='\t';
-	*ptr++='}';*ptr++=0;
-	return out;	
+	if (fmt) {if (out) memset(out+len,'\t',depth-1);len+=depth-1;}
+	if (out) out[len]='}';
+	return len+1;
 }
 
 /* Get Array size/item / object item. */
 int    cJSON_GetArraySize(cJSON *array)							{cJSON *c=array->child;int i=0;while(c)i++,c=c->next;return i;}
 cJSON *cJSON_GetArrayItem(cJSON *array,int item)				{cJSON *c=array->child;  while (c && item>0) item--,c=c->next; return c;}
-cJSON *cJSON_GetObjectItem(cJSON *object,const char *string)	{cJSON *c=object->child; while (c && cJSON_strcasecmp(c->string,string)) c=c->next; return c;}
+cJSON *cJSON_GetObjectItem(cJSON *object,const char *string)	{unsigned h=hash_key(string);cJSON *c=object->child; while (c && ((c->hash && c->hash!=h) || cJSON_strcasecmp(c->string,string))) c=c->next; return c;}
 
 /* Utility for array list handling. */
 static void suffix_object(cJSON *prev,cJSON *item) {prev->next=item;item->prev=prev;}
 /* Utility for handling references. */
-static cJSON *create_reference(cJSON *item) {cJSON *ref=cJSON_New_Item();if (!ref) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->type|=cJSON_IsReference;ref->next=ref->prev=0;return ref;}
+static cJSON *create_reference(cJSON *item) {cJSON *ref=cJSON_New_Item();if (!ref) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->hash=0;ref->flags=0;ref->type|=cJSON_IsReference;ref->next=ref->prev=0;return ref;}
+/* Utility for naming an item of an object. */
+static void set_item_string(cJSON *item,const char *string) {if (item->string && !(item->flags&cJSON_StringInArena)) cJSON_free(item->string);item->string=cJSON_strdup(string);item->flags&=~cJSON_StringInArena;item->hash=hash_key(item->string);}
 
 /* Add item to array/object. */
 void   cJSON_AddItemToArray(cJSON *array, cJSON *item)						{cJSON *c=array->child;if (!item) return; if (!c) {array->child=item;} else {while (c && c->next) c=c->next; suffix_object(c,item);}}
-void   cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item)	{if (!item) return; if (item->string) cJSON_free(item->string);item->string=cJSON_strdup(string);cJSON_AddItemToArray(object,item);}
+void   cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item)	{if (!item) return; set_item_string(item,string);cJSON_AddItemToArray(object,item);}
 void	cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)						{cJSON_AddItemToArray(array,create_reference(item));}
 void	cJSON_AddItemReferenceToObject(cJSON *object,const char *string,cJSON *item)	{cJSON_AddItemToObject(object,string,create_reference(item));}
 
 cJSON *cJSON_DetachItemFromArray(cJSON *array,int which)			{cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return 0;
 	if (c->prev) c->prev->next=c->next;if (c->next) c->next->prev=c->prev;if (c==array->child) array->child=c->next;c->prev=c->next=0;return c;}
 void   cJSON_DeleteItemFromArray(cJSON *array,int which)			{cJSON_Delete(cJSON_DetachItemFromArray(array,which));}
-cJSON *cJSON_DetachItemFromObject(cJSON *object,const char *string) {int i=0;cJSON *c=object->child;while (c && cJSON_strcasecmp(c->string,string)) i++,c=c->next;if (c) return cJSON_DetachItemFromArray(object,i);return 0;}
+cJSON *cJSON_DetachItemFromObject(cJSON *object,const char *string) {int i=0;unsigned h=hash_key(string);cJSON *c=object->child;while (c && ((c->hash && c->hash!=h) || cJSON_strcasecmp(c->string,string))) i++,c=c->next;if (c) return cJSON_DetachItemFromArray(object,i);return 0;}
 void   cJSON_DeleteItemFromObject(cJSON *object,const char *string) {cJSON_Delete(cJSON_DetachItemFromObject(object,string));}
 
 /* Replace array/object items with new ones. */
 void   cJSON_ReplaceItemInArray(cJSON *array,int which,cJSON *newitem)		{cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return;
 	newitem->next=c->next;newitem->prev=c->prev;if (newitem->next) newitem->next->prev=newitem;
 	if (c==array->child) array->child=newitem; else newitem->prev->next=newitem;c->next=c->prev=0;cJSON_Delete(c);}
-void   cJSON_ReplaceItemInObject(cJSON *object,const char *string,cJSON *newitem){int i=0;cJSON *c=object->child;while(c && cJSON_strcasecmp(c->string,string))i++,c=c->next;if(c){newitem->string=cJSON_strdup(string);cJSON_ReplaceItemInArray(object,i,newitem);}}
+void   cJSON_ReplaceItemInObject(cJSON *object,const char *string,cJSON *newitem){int i=0;unsigned h=hash_key(string);cJSON *c=object->child;while(c && ((c->hash && c->hash!=h) || cJSON_strcasecmp(c->string,string)))i++,c=c->next;if(c){set_item_string(newitem,string);cJSON_ReplaceItemInArray(object,i,newitem);}}
 
 /* Create basic types: */
 cJSON *cJSON_CreateNull(void)					{cJSON *item=cJSON_New_Item();if(item)item->type=cJSON_NULL;return item;}
@@ -562,7 +570,7 @@ cJSON *cJSON_Duplicate(cJSON *item,int recurse)
 	/* Copy over all vars */
 	newitem->type=item->type&(~cJSON_IsReference),newitem->valueint=item->valueint,newitem->valuedouble=item->valuedouble;
 	if (item->valuestring)	{newitem->valuestring=cJSON_strdup(item->valuestring);	if (!newitem->valuestring)	{cJSON_Delete(newitem);return 0;}}
-	if (item->string)		{newitem->string=cJSON_strdup(item->string);			if (!newitem->string)		{cJSON_Delete(newitem);return 0;}}
+	if (item->string)		{newitem->string=cJSON_strdup(item->string);			if (!newitem->string)		{cJSON_Delete(newitem);return 0;}newitem->hash=item->hash;}
 	/* If non-recursive, then we're done! */
 	if (!recurse) return newitem;
 	/* Walk the ->next chain for the child. */
@@ -45,9 +45,11 @@ typedef struct cJSON {
 	struct cJSON *child;		/* An array or object item will have a child pointer pointing to a chain of the items in the array/object. */
 
 	int type;					/* The type of the item, as above. */
+	int flags;					/* Who owns the item's memory; internal to cJSON. */
 
 	char *valuestring;			/* The item's string, if type==cJSON_String */
 	int valueint;				/* The item's number, if type==cJSON_Number */
+	unsigned hash;				/* Case folded hash of string, 0 if unknown; internal to cJSON. */
 	double valuedouble;			/* The item's number, if type==cJSON_Number */
 
 	char *string;				/* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
@@ -64,6 +66,9 @@ extern void cJSON_InitHooks(cJSON_Hooks* hooks);
 
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. Call cJSON_Delete when finished. */
 extern cJSON *cJSON_Parse(const char *value);
+/* As cJSON_Parse, but the items and strings are carved from a few large blocks, which cJSON_Delete on the returned root frees at once.
+Items of the tree can be detached, replaced and deleted as usual, but none may outlive the root. */
+extern cJSON *cJSON_ParseArena(const char *value);
 /* Render a cJSON entity to text for transfer/storage. Free the char* when finished. */
 extern char  *cJSON_Print(cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. Free the char* when finished. */
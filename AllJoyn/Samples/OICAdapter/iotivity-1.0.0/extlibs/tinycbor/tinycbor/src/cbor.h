@@ -202,10 +202,13 @@ enum CborParserIteratorFlags
     CborIteratorFlag_ContainerIsMap         = 0x20
 };
 
+struct CborContainerIndex;
+
 struct CborParser
 {
     const uint8_t *end;
     int flags;
+    const struct CborContainerIndex *containers;
 };
 typedef struct CborParser CborParser;
 
@@ -221,6 +224,8 @@ struct CborValue
 typedef struct CborValue CborValue;
 
 CBOR_API CborError cbor_parser_init(const uint8_t *buffer, size_t size, int flags, CborParser *parser, CborValue *it);
+CBOR_API CborError cbor_parser_index_containers(CborParser *parser, const CborValue *it);
+CBOR_API void cbor_parser_free_containers(CborParser *parser);
 
 CBOR_INLINE_API bool cbor_value_at_end(const CborValue *it)
 { return it->remaining == 0; }
@@ -413,6 +418,30 @@ CBOR_INLINE_API CborError cbor_value_get_map_length(const CborValue *value, size
 
 CBOR_API CborError cbor_value_map_find_value(const CborValue *map, const char *string, CborValue *element);
 
+struct CborMapIndexEntry
+{
+    const uint8_t *key;     /* text of a key sent in one chunk, NULL for other keys */
+    size_t keyLength;
+    CborValue keyValue;     /* the key, tags skipped */
+    CborValue value;        /* the value, tags included */
+};
+typedef struct CborMapIndexEntry CborMapIndexEntry;
+
+struct CborMapIndex
+{
+    CborMapIndexEntry *entries;
+    uint32_t *buckets;      /* entry + 1 for each hash bucket, NULL for small maps */
+    size_t count;
+    size_t bucketCount;
+    bool hasChunkedKeys;
+    CborValue next;         /* the element after the map */
+};
+typedef struct CborMapIndex CborMapIndex;
+
+CBOR_API CborError cbor_value_index_map(const CborValue *map, CborMapIndex *index);
+CBOR_API CborError cbor_map_index_find_value(const CborMapIndex *index, const char *string, CborValue *element);
+CBOR_API void cbor_map_index_free(CborMapIndex *index);
+
 /* Floating point */
 CBOR_API CborError cbor_value_get_half_float(const CborValue *value, void *result);
 CBOR_INLINE_API CborError cbor_value_get_float(const CborValue *value, float *result)
@@ -38,6 +38,24 @@
 #  define CBOR_PARSER_MAX_RECURSIONS 1024
 #endif
 
+#ifndef CBOR_MAP_INDEX_LINEAR_MAX
+#  define CBOR_MAP_INDEX_LINEAR_MAX 8
+#endif
+
+typedef struct CborContainerBounds
+{
+    const uint8_t *start;
+    const uint8_t *end;
+} CborContainerBounds;
+
+/* start and end of every container in the buffer, in the order they start */
+struct CborContainerIndex
+{
+    CborContainerBounds *bounds;
+    size_t count;
+    size_t capacity;
+};
+
 /**
  * \typedef CborValue
  * This type contains one value parsed from the CBOR stream.
@@ -265,6 +283,22 @@ CborError cbor_value_advance_fixed(CborValue *it)
     return advance_internal(it);
 }
 
+static const uint8_t *find_container_end(const struct CborContainerIndex *index, const uint8_t *ptr)
+{
+    size_t low = 0;
+    size_t high = index->count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (index->bounds[mid].start < ptr)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low < index->count && index->bounds[low].start == ptr)
+        return index->bounds[low].end;
+    return NULL;
+}
+
 static CborError advance_recursive(CborValue *it, int nestingLevel)
 {
     if (is_fixed_type(it->type))
@@ -275,6 +309,15 @@ static CborError advance_recursive(CborValue *it, int nestingLevel)
         return _cbor_value_copy_string(it, NULL, &len, it);
     }
 
+    // a container whose end is known already is skipped at once
+    if (it->parser->containers) {
+        const uint8_t *end = find_container_end(it->parser->containers, it->ptr);
+        if (end) {
+            it->ptr = end;
+            return preparse_next_value(it);
+        }
+    }
+
     // map or array
     if (nestingLevel == CBOR_PARSER_MAX_RECURSIONS)
         return CborErrorNestingTooDeep;
@@ -292,6 +335,84 @@ static CborError advance_recursive(CborValue *it, int nestingLevel)
     return cbor_value_leave_container(it, &recursed);
 }
 
+static CborError index_recursive(struct CborContainerIndex *index, CborValue *it, int nestingLevel)
+{
+    if (!cbor_value_is_container(it))
+        return advance_recursive(it, nestingLevel);
+
+    if (nestingLevel == CBOR_PARSER_MAX_RECURSIONS)
+        return CborErrorNestingTooDeep;
+
+    if (index->count == index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : 16;
+        CborContainerBounds *bounds = (CborContainerBounds *)realloc(index->bounds, capacity * sizeof(*bounds));
+        if (!bounds)
+            return CborErrorOutOfMemory;
+        index->bounds = bounds;
+        index->capacity = capacity;
+    }
+    size_t slot = index->count++;
+    index->bounds[slot].start = it->ptr;
+    index->bounds[slot].end = NULL;
+
+    CborError err;
+    CborValue recursed;
+    err = cbor_value_enter_container(it, &recursed);
+    if (err)
+        return err;
+    while (!cbor_value_at_end(&recursed)) {
+        err = index_recursive(index, &recursed, nestingLevel + 1);
+        if (err)
+            return err;
+    }
+    index->bounds[slot].end = recursed.ptr;
+    return cbor_value_leave_container(it, &recursed);
+}
+
+/**
+ * Walks the value \a it, usually the one cbor_parser_init() returned, once
+ * and records where each container in it ends. Afterwards, skipping a
+ * container with cbor_value_advance() or cbor_value_map_find_value() no
+ * longer walks its elements again, which makes looking up keys in nested
+ * maps linear in the size of the data rather than quadratic in the nesting.
+ *
+ * The index takes 2 pointers per container and is released with
+ * cbor_parser_free_containers(). If the data is malformed, no index is kept
+ * and the error is returned; parsing can go on without the index.
+ *
+ * \sa cbor_value_advance(), cbor_parser_free_containers()
+ */
+CborError cbor_parser_index_containers(CborParser *parser, const CborValue *it)
+{
+    assert(it->parser == parser);
+    cbor_parser_free_containers(parser);
+
+    struct CborContainerIndex *index = (struct CborContainerIndex *)calloc(1, sizeof(*index));
+    if (!index)
+        return CborErrorOutOfMemory;
+
+    CborValue copy = *it;
+    CborError err = index_recursive(index, &copy, 0);
+    if (err) {
+        free(index->bounds);
+        free(index);
+        return err;
+    }
+    parser->containers = index;
+    return CborNoError;
+}
+
+/**
+ * Releases the index cbor_parser_index_containers() built for \a parser.
+ */
+void cbor_parser_free_containers(CborParser *parser)
+{
+    if (parser->containers) {
+        free(parser->containers->bounds);
+        free(CONST_CAST(struct CborContainerIndex *, parser->containers));
+        parser->containers = NULL;
+    }
+}
 
 /**
  * Advances the CBOR value \a it by one element, skipping over containers.
@@ -721,6 +842,207 @@ error:
     return err;
 }
 
+static uint32_t hash_key(const uint8_t *key, size_t len)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261U;
+    while (len--) {
+        hash ^= *key++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static CborError build_map_buckets(CborMapIndex *index)
+{
+    size_t bucketCount = 16;
+    while (bucketCount < index->count * 2)
+        bucketCount *= 2;
+    index->buckets = (uint32_t *)calloc(bucketCount, sizeof(*index->buckets));
+    if (!index->buckets)
+        return CborErrorOutOfMemory;
+    index->bucketCount = bucketCount;
+
+    size_t i;
+    for (i = 0; i < index->count; ++i) {
+        const CborMapIndexEntry *entry = &index->entries[i];
+        if (!entry->key)
+            continue;
+        size_t bucket = hash_key(entry->key, entry->keyLength) & (bucketCount - 1);
+        for ( ; index->buckets[bucket]; bucket = (bucket + 1) & (bucketCount - 1)) {
+            // the first of duplicate keys is the one found, as with cbor_value_map_find_value()
+            const CborMapIndexEntry *other = &index->entries[index->buckets[bucket] - 1];
+            if (other->keyLength == entry->keyLength && memcmp(other->key, entry->key, entry->keyLength) == 0)
+                break;
+        }
+        if (!index->buckets[bucket])
+            index->buckets[bucket] = (uint32_t)i + 1;
+    }
+    return CborNoError;
+}
+
+/**
+ * Walks the map \a map once and records in \a index where each of its keys
+ * and values is, so that cbor_map_index_find_value() can find values without
+ * parsing the map again. The element after the map is stored in the \c next
+ * member of \a index, sparing another walk over the map to advance past it.
+ *
+ * On success, the index must be released with cbor_map_index_free(). It
+ * refers to the CBOR data, which must outlive it.
+ *
+ * \sa cbor_value_map_find_value(), cbor_parser_index_containers()
+ */
+CborError cbor_value_index_map(const CborValue *map, CborMapIndex *index)
+{
+    assert(cbor_value_is_map(map));
+    memset(index, 0, sizeof(*index));
+
+    CborValue it;
+    CborError err = cbor_value_enter_container(map, &it);
+    if (err)
+        goto error;
+
+    size_t capacity = 0;
+    while (!cbor_value_at_end(&it)) {
+        if (index->count == capacity) {
+            // at most one pair per 2 bytes left, whatever the map claims
+            if (capacity == 0 && it.remaining != UINT32_MAX)
+                capacity = it.remaining / 2;
+            else
+                capacity = capacity ? capacity * 2 : 8;
+            size_t limit = (size_t)(it.parser->end - it.ptr) / 2 + 1;
+            if (capacity > limit)
+                capacity = limit;
+            CborMapIndexEntry *entries = (CborMapIndexEntry *)realloc(index->entries, capacity * sizeof(*entries));
+            if (!entries) {
+                err = CborErrorOutOfMemory;
+                goto error;
+            }
+            index->entries = entries;
+        }
+
+        CborMapIndexEntry *entry = &index->entries[index->count];
+        err = cbor_value_skip_tag(&it);
+        if (err)
+            goto error;
+        entry->keyValue = it;
+        entry->key = NULL;
+        entry->keyLength = 0;
+        if (cbor_value_is_text_string(&it)) {
+            if (cbor_value_is_length_known(&it)) {
+                const uint8_t *ptr = it.ptr;
+                err = extract_length(it.parser, &ptr, &entry->keyLength);
+                if (err)
+                    goto error;
+                if (entry->keyLength > (size_t)(it.parser->end - ptr)) {
+                    err = CborErrorUnexpectedEOF;
+                    goto error;
+                }
+                entry->key = ptr;
+            } else {
+                index->hasChunkedKeys = true;
+            }
+        }
+        err = advance_recursive(&it, 0);
+        if (err)
+            goto error;
+        if (cbor_value_at_end(&it)) {
+            // a key without a value
+            err = CborErrorUnexpectedBreak;
+            goto error;
+        }
+
+        entry->value = it;
+        err = cbor_value_skip_tag(&it);
+        if (err)
+            goto error;
+        err = advance_recursive(&it, 0);
+        if (err)
+            goto error;
+        ++index->count;
+    }
+
+    index->next = *map;
+    err = cbor_value_leave_container(&index->next, &it);
+    if (err)
+        goto error;
+
+    if (index->count > CBOR_MAP_INDEX_LINEAR_MAX && !index->hasChunkedKeys) {
+        err = build_map_buckets(index);
+        if (err)
+            goto error;
+    }
+    return CborNoError;
+
+error:
+    cbor_map_index_free(index);
+    return err;
+}
+
+/**
+ * Finds the value in the map indexed by \a index that corresponds to the text
+ * string key \a string, like cbor_value_map_find_value() does. If no item is
+ * found matching the key, then \a element will contain an element of type
+ * \ref CborInvalidType.
+ *
+ * This function runs in constant time for maps of more than a few keys sent
+ * in one chunk each.
+ *
+ * \sa cbor_value_index_map()
+ */
+CborError cbor_map_index_find_value(const CborMapIndex *index, const char *string, CborValue *element)
+{
+    size_t len = strlen(string);
+    if (index->buckets) {
+        size_t mask = index->bucketCount - 1;
+        size_t bucket = hash_key((const uint8_t *)string, len) & mask;
+        for ( ; index->buckets[bucket]; bucket = (bucket + 1) & mask) {
+            const CborMapIndexEntry *entry = &index->entries[index->buckets[bucket] - 1];
+            if (entry->keyLength == len && memcmp(entry->key, string, len) == 0) {
+                *element = entry->value;
+                return CborNoError;
+            }
+        }
+    } else {
+        size_t i;
+        for (i = 0; i < index->count; ++i) {
+            const CborMapIndexEntry *entry = &index->entries[i];
+            bool equals = false;
+            if (entry->key) {
+                equals = entry->keyLength == len && memcmp(entry->key, string, len) == 0;
+            } else if (cbor_value_is_text_string(&entry->keyValue)) {
+                CborError err = cbor_value_text_string_equals(&entry->keyValue, string, &equals);
+                if (err) {
+                    element->type = CborInvalidType;
+                    return err;
+                }
+            }
+            if (equals) {
+                *element = entry->value;
+                return CborNoError;
+            }
+        }
+    }
+
+    // not found
+    *element = index->next;
+    element->type = CborInvalidType;
+    return CborNoError;
+}
+
+/**
+ * Releases the memory of the map index \a index.
+ */
+void cbor_map_index_free(CborMapIndex *index)
+{
+    free(index->entries);
+    free(index->buckets);
+    index->entries = NULL;
+    index->buckets = NULL;
+    index->count = 0;
+    index->bucketCount = 0;
+}
+
 /**
  * Extracts a half-precision floating point from \a value and stores it in \a
  * result.
@@ -73,6 +73,8 @@ private slots:
     void stringCompare();
     void mapFind_data();
     void mapFind();
+    void mapIndexFind_data() { mapFind_data(); }
+    void mapIndexFind();
 
     // validation & errors
     void validation_data();
@@ -81,6 +83,8 @@ private slots:
     void resumeParsing();
     void endPointer_data();
     void endPointer();
+    void indexedEndPointer_data() { endPointer_data(); }
+    void indexedEndPointer();
     void recursionLimit_data();
     void recursionLimit();
 };
@@ -915,6 +919,12 @@ void tst_Parser::mapFind_data()
     QTest::newRow("mapbefore") << raw("\xa2\x61z\xa0\x66needle\xd8\x2a\x68haystack") << true;
     QTest::newRow("nestedmapbefore") << raw("\xa2\x61z\xa1\0\x81\0\x66needle\xd8\x2a\x68haystack") << true;
     QTest::newRow("mapmapbefore") << raw("\xa2\xa1\1\2\xa0\x66needle\xd8\x2a\x68haystack") << true;
+
+    // enough keys for a hashed index
+    QTest::newRow("absent-manykeys") << raw("\xaa\x61""a\0\x61""b\0\x61""c\0\x61""d\0\x61""e\0\x61""f\0\x61g\0\x61h\0\x61i\0\x61j\0") << false;
+    QTest::newRow("manykeysbefore") << raw("\xab\x61""a\0\x61""b\0\x61""c\0\x61""d\0\x61""e\0\x61""f\0\x61g\0\x61h\0\x61i\0\x61j\0\x66needle\xd8\x2a\x68haystack") << true;
+    QTest::newRow("manykeys-duplicate") << raw("\xab\x66needle\xd8\x2a\x68haystack\x61""a\0\x61""b\0\x61""c\0\x61""d\0\x61""e\0\x61""f\0\x61g\0\x61h\0\x61i\0\x66needle\0") << true;
+    QTest::newRow("manykeys-chunked") << raw("\xab\x61""a\0\x61""b\0\x61""c\0\x61""d\0\x61""e\0\x61""f\0\x61g\0\x61h\0\x61i\0\x61j\0\x7f\x63nee\x63""dle\xff\xd8\x2a\x68haystack") << true;
 }
 
 void tst_Parser::mapFind()
@@ -948,6 +958,43 @@ void tst_Parser::mapFind()
     }
 }
 
+void tst_Parser::mapIndexFind()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(bool, expected);
+
+    CborParser parser;
+    CborValue value;
+    CborError err = cbor_parser_init(reinterpret_cast<const quint8 *>(data.constData()), data.length(), 0, &parser, &value);
+    QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+
+    CborMapIndex index;
+    err = cbor_value_index_map(&value, &index);
+    QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+
+    CborValue element;
+    err = cbor_map_index_find_value(&index, "needle", &element);
+    cbor_map_index_free(&index);
+    QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+
+    if (expected) {
+        QCOMPARE(int(element.type), int(CborTagType));
+
+        CborTag tag;
+        err = cbor_value_get_tag(&element, &tag);
+        QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+        QCOMPARE(int(tag), 42);
+
+        bool equals;
+        err = cbor_value_text_string_equals(&element, "haystack", &equals);
+        QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+        QVERIFY(equals);
+    } else {
+        QCOMPARE(int(element.type), int(CborInvalidType));
+        QCOMPARE(int(element.ptr - reinterpret_cast<const quint8 *>(data.constBegin())), data.length());
+    }
+}
+
 void tst_Parser::validation_data()
 {
     QTest::addColumn<QByteArray>("data");
@@ -1162,6 +1209,25 @@ void tst_Parser::endPointer()
     QCOMPARE(int(first.ptr - reinterpret_cast<const quint8 *>(data.constBegin())), offset);
 }
 
+void tst_Parser::indexedEndPointer()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, offset);
+
+    CborParser parser;
+    CborValue first;
+    CborError err = cbor_parser_init(reinterpret_cast<const quint8 *>(data.constData()), data.length(), 0, &parser, &first);
+    QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+
+    err = cbor_parser_index_containers(&parser, &first);
+    QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+
+    err = cbor_value_advance(&first);
+    cbor_parser_free_containers(&parser);
+    QVERIFY2(!err, QByteArray("Got error \"") + cbor_error_string(err) + "\"");
+    QCOMPARE(int(first.ptr - reinterpret_cast<const quint8 *>(data.constBegin())), offset);
+}
+
 void tst_Parser::recursionLimit_data()
 {
     static const int recursions = CBOR_PARSER_MAX_RECURSIONS + 2;
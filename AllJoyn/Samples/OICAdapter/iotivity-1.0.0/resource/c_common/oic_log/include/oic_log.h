@@ -0,0 +1,197 @@
+/******************************************************************
+ *
+ * Copyright 2015 Microsoft Corporation All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * Level filtering and asynchronous output shared by the stack logger
+ * (OC_LOG) and the connectivity logger (OIC_LOG).
+ *
+ * Levels are the LogLevel values of the loggers, DEBUG being the lowest.
+ */
+
+#ifndef OIC_LOG_H_
+#define OIC_LOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/** Longest tag kept by a tag level or a queued record, '\0' included. */
+#define OIC_LOG_TAG_SIZE (32)
+
+/** Longest message kept by a queued record, '\0' included. */
+#define OIC_LOG_MESSAGE_SIZE (256)
+
+/** Most tags having their own level. */
+#define OIC_LOG_MAX_TAG_LEVELS (32)
+
+/**
+ * Sets the lowest level output for the tags without a level of their own.
+ * The default is to output every level.
+ *
+ * @param level Lowest level output.
+ */
+void OICLogSetDefaultLevel(int level);
+
+/**
+ * Sets the lowest level output for one tag.
+ *
+ * @param tag Module name, as passed to the log macros.
+ * @param level Lowest level output; a negative level makes the tag use the
+ *              default level again.
+ *
+ * @return false if OIC_LOG_MAX_TAG_LEVELS tags already have a level.
+ */
+bool OICLogSetTagLevel(const char *tag, int level);
+
+/**
+ * Checks whether a message is output, before it is formatted.
+ *
+ * @param level Level of the message.
+ * @param tag Module name of the message.
+ *
+ * @return true if the message is output.
+ */
+bool OICLogIsEnabled(int level, const char *tag);
+
+/**
+ * Outputs only one hex dump out of interval. The default, 1, outputs all.
+ *
+ * @param interval Hex dumps skipped per output, plus one; 0 outputs none.
+ */
+void OICLogSetBufferSampling(uint32_t interval);
+
+/**
+ * Counts a hex dump and tells whether it is the one of its interval output.
+ *
+ * @return true if the hex dump is output.
+ */
+bool OICLogSampleBuffer(void);
+
+typedef struct OICLogRecord OICLogRecord;
+
+/**
+ * Outputs one record on the writer thread of a log ring.
+ *
+ * @param record Record to output, only valid during the call.
+ */
+typedef void (*OICLogRecordWriter)(const OICLogRecord *record);
+
+/** Message queued for the writer thread of a log ring. */
+struct OICLogRecord
+{
+    /** Outputs the record. */
+    OICLogRecordWriter writer;
+
+    /** Level of the message. */
+    int level;
+
+    /** Time the message was logged, in the unit of the writer. */
+    uint32_t timestamp;
+
+    /** Module name of the message. */
+    char tag[OIC_LOG_TAG_SIZE];
+
+    /** Formatted message. */
+    char message[OIC_LOG_MESSAGE_SIZE];
+};
+
+/** Bounded queue of records written out by a thread of its own. */
+typedef struct OICLogRing OICLogRing;
+
+/**
+ * Creates a log ring and starts its writer thread.
+ *
+ * @param capacity Records the ring holds, rounded up to a power of 2.
+ *
+ * @return the ring, or NULL if it could not be created or the platform has
+ *         no threads.
+ */
+OICLogRing *OICLogRingCreate(uint32_t capacity);
+
+/**
+ * Writes out the queued records, stops the writer thread and frees the ring.
+ * No other thread may push records anymore.
+ *
+ * @param ring Ring to destroy.
+ */
+void OICLogRingDestroy(OICLogRing *ring);
+
+/**
+ * Queues a record without blocking. Safe to call from any thread.
+ *
+ * When the ring is full the record is dropped; the writer thread reports the
+ * number of dropped records through the writer of the last record it wrote.
+ *
+ * @param ring Ring to queue the record on.
+ * @param writer Outputs the record on the writer thread.
+ * @param level Level of the message.
+ * @param timestamp Time the message was logged, in the unit of writer.
+ * @param tag Module name, truncated to OIC_LOG_TAG_SIZE.
+ * @param message Message, truncated to OIC_LOG_MESSAGE_SIZE.
+ *
+ * @return false if the record was dropped.
+ */
+bool OICLogRingPush(OICLogRing *ring, OICLogRecordWriter writer, int level,
+                    uint32_t timestamp, const char *tag, const char *message);
+
+/**
+ * Makes the loggers queue their messages for a writer thread instead of
+ * writing them out on the calling thread. Messages are dropped while the queue
+ * is full.
+ *
+ * @param capacity Messages queued at most.
+ *
+ * @return false if the writer thread could not be started; the loggers keep
+ *         writing synchronously.
+ */
+bool OICLogStartAsync(uint32_t capacity);
+
+/**
+ * Writes out the queued messages and makes the loggers write synchronously
+ * again. No other thread may log during the call.
+ */
+void OICLogStopAsync(void);
+
+/**
+ * Queues a message for the writer thread started by OICLogStartAsync.
+ *
+ * @param writer Outputs the message on the writer thread.
+ * @param level Level of the message.
+ * @param timestamp Time the message was logged, in the unit of writer.
+ * @param tag Module name of the message.
+ * @param message Formatted message.
+ *
+ * @return false if there is no writer thread and the caller has to write the
+ *         message itself.
+ */
+bool OICLogWriteAsync(OICLogRecordWriter writer, int level, uint32_t timestamp,
+                      const char *tag, const char *message);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OIC_LOG_H_
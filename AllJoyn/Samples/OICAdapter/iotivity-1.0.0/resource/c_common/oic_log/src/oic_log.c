@@ -0,0 +1,632 @@
+/******************************************************************
+ *
+ * Copyright 2015 Microsoft Corporation All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+// Defining _POSIX_C_SOURCE macro with 200809L (or greater) as value
+// causes header files to expose definitions
+// corresponding to the POSIX.1-2008 base
+// specification (excluding the XSI extension).
+// For POSIX.1-2008 base specification,
+// Refer http://pubs.opengroup.org/stage7tc1/
+//
+// For this specific file, see use of clock_gettime and pthread_cond_timedwait
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "oic_log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "oic_malloc.h"
+#include "oic_string.h"
+
+#if defined(WIN32) || defined(_WIN32)
+#include <Windows.h>
+#define HAVE_WINDOWS_THREADS
+#elif defined(__linux__) || defined(__APPLE__) || defined(__ANDROID__) || defined(__TIZEN__)
+#include <pthread.h>
+#include <time.h>
+#define HAVE_PTHREADS
+#endif
+
+// How long the writer thread sleeps at most when there is nothing to write
+#define WRITER_IDLE_WAIT_MS (100)
+
+// Tag used for the messages of the ring itself
+#define TAG "OIC_LOG"
+
+/*
+ * 32 bit atomics, full barriers. Platforms without threads don't need more than
+ * volatile accesses.
+ */
+#if defined(HAVE_WINDOWS_THREADS)
+typedef volatile LONG oic_atomic_t;
+
+static uint32_t AtomicLoad(oic_atomic_t *value)
+{
+    return (uint32_t)InterlockedCompareExchange(value, 0, 0);
+}
+
+static void AtomicStore(oic_atomic_t *value, uint32_t newValue)
+{
+    InterlockedExchange(value, (LONG)newValue);
+}
+
+static uint32_t AtomicExchange(oic_atomic_t *value, uint32_t newValue)
+{
+    return (uint32_t)InterlockedExchange(value, (LONG)newValue);
+}
+
+static bool AtomicCompareExchange(oic_atomic_t *value, uint32_t expected, uint32_t desired)
+{
+    return InterlockedCompareExchange(value, (LONG)desired, (LONG)expected) == (LONG)expected;
+}
+
+static uint32_t AtomicIncrement(oic_atomic_t *value)
+{
+    return (uint32_t)InterlockedIncrement(value);
+}
+#elif defined(HAVE_PTHREADS)
+typedef uint32_t oic_atomic_t;
+
+static uint32_t AtomicLoad(oic_atomic_t *value)
+{
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+static void AtomicStore(oic_atomic_t *value, uint32_t newValue)
+{
+    __atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+}
+
+static uint32_t AtomicExchange(oic_atomic_t *value, uint32_t newValue)
+{
+    return __atomic_exchange_n(value, newValue, __ATOMIC_SEQ_CST);
+}
+
+static bool AtomicCompareExchange(oic_atomic_t *value, uint32_t expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n(value, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static uint32_t AtomicIncrement(oic_atomic_t *value)
+{
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+#else
+typedef volatile uint32_t oic_atomic_t;
+
+static uint32_t AtomicLoad(oic_atomic_t *value)
+{
+    return *value;
+}
+
+static void AtomicStore(oic_atomic_t *value, uint32_t newValue)
+{
+    *value = newValue;
+}
+
+static bool AtomicCompareExchange(oic_atomic_t *value, uint32_t expected, uint32_t desired)
+{
+    if (*value != expected)
+    {
+        return false;
+    }
+    *value = desired;
+    return true;
+}
+
+static uint32_t AtomicIncrement(oic_atomic_t *value)
+{
+    return ++*value;
+}
+#endif
+
+/*
+ * Levels
+ *
+ * Tags get an entry the first time they are given a level and keep it; a tag
+ * going back to the default level only gets its level reset. Entries are filled
+ * before the count publishes them, so lookups take no lock.
+ */
+typedef struct
+{
+    char tag[OIC_LOG_TAG_SIZE];
+    oic_atomic_t level;
+} TagLevel;
+
+// Tag levels use UNSET_LEVEL to follow the default level
+#define UNSET_LEVEL (0xFFFFFFFFu)
+
+static TagLevel g_tagLevels[OIC_LOG_MAX_TAG_LEVELS];
+static oic_atomic_t g_tagLevelCount = 0;
+static oic_atomic_t g_defaultLevel = 0;
+// Lowest of the default level and the tag levels, rejects most messages at once
+static oic_atomic_t g_lowestLevel = 0;
+// Serializes the level setters
+static oic_atomic_t g_levelLock = 0;
+
+static oic_atomic_t g_bufferSampling = 1;
+static oic_atomic_t g_bufferCount = 0;
+
+static void LockLevels(void)
+{
+    while (!AtomicCompareExchange(&g_levelLock, 0, 1))
+    {
+    }
+}
+
+static void UnlockLevels(void)
+{
+    AtomicStore(&g_levelLock, 0);
+}
+
+static void UpdateLowestLevel(void)
+{
+    uint32_t lowest = AtomicLoad(&g_defaultLevel);
+    uint32_t count = AtomicLoad(&g_tagLevelCount);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t level = AtomicLoad(&g_tagLevels[i].level);
+        if (level != UNSET_LEVEL && level < lowest)
+        {
+            lowest = level;
+        }
+    }
+    AtomicStore(&g_lowestLevel, lowest);
+}
+
+void OICLogSetDefaultLevel(int level)
+{
+    LockLevels();
+    AtomicStore(&g_defaultLevel, level < 0 ? 0 : (uint32_t)level);
+    UpdateLowestLevel();
+    UnlockLevels();
+}
+
+bool OICLogSetTagLevel(const char *tag, int level)
+{
+    if (!tag)
+    {
+        return false;
+    }
+
+    uint32_t newLevel = level < 0 ? UNSET_LEVEL : (uint32_t)level;
+    bool result = true;
+
+    LockLevels();
+    uint32_t count = AtomicLoad(&g_tagLevelCount);
+    uint32_t i = 0;
+    while (i < count && strncmp(g_tagLevels[i].tag, tag, OIC_LOG_TAG_SIZE - 1) != 0)
+    {
+        i++;
+    }
+
+    if (i < count)
+    {
+        AtomicStore(&g_tagLevels[i].level, newLevel);
+    }
+    else if (newLevel != UNSET_LEVEL && count < OIC_LOG_MAX_TAG_LEVELS)
+    {
+        OICStrcpy(g_tagLevels[count].tag, sizeof(g_tagLevels[count].tag), tag);
+        AtomicStore(&g_tagLevels[count].level, newLevel);
+        AtomicStore(&g_tagLevelCount, count + 1);
+    }
+    else
+    {
+        result = (newLevel == UNSET_LEVEL);
+    }
+
+    UpdateLowestLevel();
+    UnlockLevels();
+    return result;
+}
+
+bool OICLogIsEnabled(int level, const char *tag)
+{
+    if (level < 0 || (uint32_t)level < AtomicLoad(&g_lowestLevel))
+    {
+        return false;
+    }
+
+    uint32_t threshold = AtomicLoad(&g_defaultLevel);
+    uint32_t count = AtomicLoad(&g_tagLevelCount);
+    if (tag)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (strncmp(g_tagLevels[i].tag, tag, OIC_LOG_TAG_SIZE - 1) == 0)
+            {
+                uint32_t tagLevel = AtomicLoad(&g_tagLevels[i].level);
+                if (tagLevel != UNSET_LEVEL)
+                {
+                    threshold = tagLevel;
+                }
+                break;
+            }
+        }
+    }
+
+    return (uint32_t)level >= threshold;
+}
+
+void OICLogSetBufferSampling(uint32_t interval)
+{
+    AtomicStore(&g_bufferSampling, interval);
+}
+
+bool OICLogSampleBuffer(void)
+{
+    uint32_t interval = AtomicLoad(&g_bufferSampling);
+    if (interval <= 1)
+    {
+        return interval == 1;
+    }
+    // the first hex dump of every interval is output
+    return (AtomicIncrement(&g_bufferCount) % interval) == 1;
+}
+
+/*
+ * Log ring
+ *
+ * A bounded multi-producer queue where every slot carries a sequence number:
+ * producers claim a position with a compare and swap on the enqueue position
+ * and publish the slot by moving its sequence to position + 1; the writer
+ * thread releases it for the next lap by moving its sequence to
+ * position + capacity.
+ */
+#if defined(HAVE_WINDOWS_THREADS) || defined(HAVE_PTHREADS)
+
+typedef struct
+{
+    oic_atomic_t sequence;
+    OICLogRecord record;
+} LogSlot;
+
+struct OICLogRing
+{
+    LogSlot *slots;
+    uint32_t mask;
+    oic_atomic_t enqueuePosition;
+    uint32_t dequeuePosition;
+
+    oic_atomic_t dropped;
+    oic_atomic_t droppedLevel;
+    OICLogRecordWriter lastWriter;
+    uint32_t lastTimestamp;
+
+    // set while the writer thread waits for records, producers then wake it up
+    oic_atomic_t sleeping;
+    oic_atomic_t stop;
+
+#if defined(HAVE_WINDOWS_THREADS)
+    HANDLE thread;
+    HANDLE wakeup;
+#else
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t wakeup;
+#endif
+};
+
+static void WakeWriter(OICLogRing *ring)
+{
+#if defined(HAVE_WINDOWS_THREADS)
+    SetEvent(ring->wakeup);
+#else
+    pthread_mutex_lock(&ring->mutex);
+    pthread_cond_signal(&ring->wakeup);
+    pthread_mutex_unlock(&ring->mutex);
+#endif
+}
+
+static LogSlot *PeekRecord(OICLogRing *ring)
+{
+    LogSlot *slot = &ring->slots[ring->dequeuePosition & ring->mask];
+    int32_t ready = (int32_t)(AtomicLoad(&slot->sequence) - (ring->dequeuePosition + 1));
+    return ready < 0 ? NULL : slot;
+}
+
+static void WaitForRecords(OICLogRing *ring)
+{
+#if defined(HAVE_WINDOWS_THREADS)
+    AtomicStore(&ring->sleeping, 1);
+    if (!PeekRecord(ring) && !AtomicLoad(&ring->stop))
+    {
+        WaitForSingleObject(ring->wakeup, WRITER_IDLE_WAIT_MS);
+    }
+    AtomicStore(&ring->sleeping, 0);
+#else
+    pthread_mutex_lock(&ring->mutex);
+    AtomicStore(&ring->sleeping, 1);
+    if (!PeekRecord(ring) && !AtomicLoad(&ring->stop))
+    {
+        struct timespec deadline = { 0, 0 };
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += WRITER_IDLE_WAIT_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&ring->wakeup, &ring->mutex, &deadline);
+    }
+    AtomicStore(&ring->sleeping, 0);
+    pthread_mutex_unlock(&ring->mutex);
+#endif
+}
+
+static void ReportDropped(OICLogRing *ring)
+{
+    if (!ring->lastWriter || AtomicLoad(&ring->dropped) == 0)
+    {
+        return;
+    }
+
+    uint32_t dropped = AtomicExchange(&ring->dropped, 0);
+    OICLogRecord record;
+    record.writer = ring->lastWriter;
+    record.level = (int)AtomicExchange(&ring->droppedLevel, 0);
+    record.timestamp = ring->lastTimestamp;
+    OICStrcpy(record.tag, sizeof(record.tag), TAG);
+    snprintf(record.message, sizeof(record.message),
+             "%u log messages dropped, the log ring was full", (unsigned int)dropped);
+    record.writer(&record);
+}
+
+static void WriteRecords(OICLogRing *ring)
+{
+    LogSlot *slot;
+    while ((slot = PeekRecord(ring)) != NULL)
+    {
+        ring->lastWriter = slot->record.writer;
+        ring->lastTimestamp = slot->record.timestamp;
+        slot->record.writer(&slot->record);
+        AtomicStore(&slot->sequence, ring->dequeuePosition + ring->mask + 1);
+        ring->dequeuePosition++;
+    }
+    ReportDropped(ring);
+}
+
+#if defined(HAVE_WINDOWS_THREADS)
+static DWORD WINAPI WriterThread(LPVOID param)
+#else
+static void *WriterThread(void *param)
+#endif
+{
+    OICLogRing *ring = (OICLogRing *)param;
+    for (;;)
+    {
+        // Records pushed before the stop request are written out before leaving
+        bool stopping = AtomicLoad(&ring->stop) != 0;
+        WriteRecords(ring);
+        if (stopping)
+        {
+            break;
+        }
+        WaitForRecords(ring);
+    }
+#if defined(HAVE_WINDOWS_THREADS)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+OICLogRing *OICLogRingCreate(uint32_t capacity)
+{
+    if (capacity == 0 || capacity > 0x10000000u)
+    {
+        return NULL;
+    }
+
+    uint32_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    OICLogRing *ring = (OICLogRing *)OICCalloc(1, sizeof(OICLogRing));
+    if (!ring)
+    {
+        return NULL;
+    }
+
+    ring->slots = (LogSlot *)OICMalloc(size * sizeof(LogSlot));
+    if (!ring->slots)
+    {
+        OICFree(ring);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < size; i++)
+    {
+        ring->slots[i].sequence = i;
+    }
+    ring->mask = size - 1;
+
+#if defined(HAVE_WINDOWS_THREADS)
+    ring->wakeup = CreateEvent(NULL, FALSE, FALSE, NULL);
+    ring->thread = ring->wakeup ? CreateThread(NULL, 0, WriterThread, ring, 0, NULL) : NULL;
+    if (!ring->thread)
+    {
+        if (ring->wakeup)
+        {
+            CloseHandle(ring->wakeup);
+        }
+        OICFree(ring->slots);
+        OICFree(ring);
+        return NULL;
+    }
+#else
+    pthread_mutex_init(&ring->mutex, NULL);
+    pthread_cond_init(&ring->wakeup, NULL);
+    if (pthread_create(&ring->thread, NULL, WriterThread, ring) != 0)
+    {
+        pthread_cond_destroy(&ring->wakeup);
+        pthread_mutex_destroy(&ring->mutex);
+        OICFree(ring->slots);
+        OICFree(ring);
+        return NULL;
+    }
+#endif
+
+    return ring;
+}
+
+void OICLogRingDestroy(OICLogRing *ring)
+{
+    if (!ring)
+    {
+        return;
+    }
+
+    AtomicStore(&ring->stop, 1);
+    WakeWriter(ring);
+
+#if defined(HAVE_WINDOWS_THREADS)
+    WaitForSingleObject(ring->thread, INFINITE);
+    CloseHandle(ring->thread);
+    CloseHandle(ring->wakeup);
+#else
+    pthread_join(ring->thread, NULL);
+    pthread_cond_destroy(&ring->wakeup);
+    pthread_mutex_destroy(&ring->mutex);
+#endif
+
+    OICFree(ring->slots);
+    OICFree(ring);
+}
+
+bool OICLogRingPush(OICLogRing *ring, OICLogRecordWriter writer, int level,
+                    uint32_t timestamp, const char *tag, const char *message)
+{
+    if (!ring || !writer || !tag || !message)
+    {
+        return false;
+    }
+
+    uint32_t position = AtomicLoad(&ring->enqueuePosition);
+    LogSlot *slot;
+    for (;;)
+    {
+        slot = &ring->slots[position & ring->mask];
+        int32_t available = (int32_t)(AtomicLoad(&slot->sequence) - position);
+        if (available == 0)
+        {
+            if (AtomicCompareExchange(&ring->enqueuePosition, position, position + 1))
+            {
+                break;
+            }
+            position = AtomicLoad(&ring->enqueuePosition);
+        }
+        else if (available < 0)
+        {
+            // Full, the writer thread still has this slot from the previous lap
+            uint32_t droppedLevel = AtomicLoad(&ring->droppedLevel);
+            while ((uint32_t)level > droppedLevel &&
+                   !AtomicCompareExchange(&ring->droppedLevel, droppedLevel, (uint32_t)level))
+            {
+                droppedLevel = AtomicLoad(&ring->droppedLevel);
+            }
+            AtomicIncrement(&ring->dropped);
+            return false;
+        }
+        else
+        {
+            position = AtomicLoad(&ring->enqueuePosition);
+        }
+    }
+
+    slot->record.writer = writer;
+    slot->record.level = level;
+    slot->record.timestamp = timestamp;
+    OICStrcpy(slot->record.tag, sizeof(slot->record.tag), tag);
+    OICStrcpy(slot->record.message, sizeof(slot->record.message), message);
+    AtomicStore(&slot->sequence, position + 1);
+
+    if (AtomicLoad(&ring->sleeping))
+    {
+        WakeWriter(ring);
+    }
+    return true;
+}
+
+#else // no threads
+
+OICLogRing *OICLogRingCreate(uint32_t capacity)
+{
+    (void)capacity;
+    return NULL;
+}
+
+void OICLogRingDestroy(OICLogRing *ring)
+{
+    (void)ring;
+}
+
+bool OICLogRingPush(OICLogRing *ring, OICLogRecordWriter writer, int level,
+                    uint32_t timestamp, const char *tag, const char *message)
+{
+    (void)ring;
+    (void)writer;
+    (void)level;
+    (void)timestamp;
+    (void)tag;
+    (void)message;
+    return false;
+}
+
+#endif
+
+/*
+ * Process wide ring of the loggers
+ */
+static OICLogRing *g_asyncRing = NULL;
+
+bool OICLogStartAsync(uint32_t capacity)
+{
+    if (!g_asyncRing)
+    {
+        g_asyncRing = OICLogRingCreate(capacity);
+    }
+    return g_asyncRing != NULL;
+}
+
+void OICLogStopAsync(void)
+{
+    OICLogRing *ring = g_asyncRing;
+    g_asyncRing = NULL;
+    OICLogRingDestroy(ring);
+}
+
+bool OICLogWriteAsync(OICLogRecordWriter writer, int level, uint32_t timestamp,
+                      const char *tag, const char *message)
+{
+    OICLogRing *ring = g_asyncRing;
+    if (!ring)
+    {
+        return false;
+    }
+
+    // a message dropped on a full ring is handled too
+    OICLogRingPush(ring, writer, level, timestamp, tag, message);
+    return true;
+}
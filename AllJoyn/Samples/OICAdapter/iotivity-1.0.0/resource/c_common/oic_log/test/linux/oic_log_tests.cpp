@@ -0,0 +1,242 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <oic_log.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // The levels of the loggers
+    const int DEBUG_LEVEL = 0;
+    const int INFO_LEVEL = 1;
+    const int WARNING_LEVEL = 2;
+    const int ERROR_LEVEL = 3;
+
+    std::mutex g_recordsMutex;
+    std::vector<std::string> g_records;
+
+    void recordWriter(const OICLogRecord *record)
+    {
+        std::lock_guard<std::mutex> lock(g_recordsMutex);
+        g_records.push_back(std::string(record->tag) + ":" + record->message);
+    }
+
+    // Holds the writer thread until released, to fill the ring
+    std::atomic<bool> g_writerBlocked(false);
+
+    void blockingWriter(const OICLogRecord *record)
+    {
+        while (g_writerBlocked)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        recordWriter(record);
+    }
+
+    class LogLevelTests : public testing::Test
+    {
+    protected:
+        virtual void TearDown()
+        {
+            OICLogSetDefaultLevel(DEBUG_LEVEL);
+            OICLogSetTagLevel("LOUD", -1);
+            OICLogSetTagLevel("QUIET", -1);
+            OICLogSetBufferSampling(1);
+        }
+    };
+
+    class LogRingTests : public testing::Test
+    {
+    protected:
+        virtual void SetUp()
+        {
+            std::lock_guard<std::mutex> lock(g_recordsMutex);
+            g_records.clear();
+        }
+    };
+}
+
+TEST_F(LogLevelTests, EverythingEnabledByDefault)
+{
+    EXPECT_TRUE(OICLogIsEnabled(DEBUG_LEVEL, "ANY"));
+    EXPECT_TRUE(OICLogIsEnabled(ERROR_LEVEL, "ANY"));
+}
+
+TEST_F(LogLevelTests, DefaultLevel)
+{
+    OICLogSetDefaultLevel(WARNING_LEVEL);
+
+    EXPECT_FALSE(OICLogIsEnabled(DEBUG_LEVEL, "ANY"));
+    EXPECT_FALSE(OICLogIsEnabled(INFO_LEVEL, "ANY"));
+    EXPECT_TRUE(OICLogIsEnabled(WARNING_LEVEL, "ANY"));
+    EXPECT_TRUE(OICLogIsEnabled(ERROR_LEVEL, "ANY"));
+}
+
+TEST_F(LogLevelTests, TagLevelOverridesDefault)
+{
+    OICLogSetDefaultLevel(WARNING_LEVEL);
+    EXPECT_TRUE(OICLogSetTagLevel("LOUD", DEBUG_LEVEL));
+    EXPECT_TRUE(OICLogSetTagLevel("QUIET", ERROR_LEVEL));
+
+    EXPECT_TRUE(OICLogIsEnabled(DEBUG_LEVEL, "LOUD"));
+    EXPECT_FALSE(OICLogIsEnabled(WARNING_LEVEL, "QUIET"));
+    EXPECT_TRUE(OICLogIsEnabled(ERROR_LEVEL, "QUIET"));
+    EXPECT_FALSE(OICLogIsEnabled(INFO_LEVEL, "OTHER"));
+
+    // back to the default level
+    EXPECT_TRUE(OICLogSetTagLevel("LOUD", -1));
+    EXPECT_FALSE(OICLogIsEnabled(DEBUG_LEVEL, "LOUD"));
+    EXPECT_TRUE(OICLogIsEnabled(WARNING_LEVEL, "LOUD"));
+}
+
+TEST_F(LogLevelTests, BufferSampling)
+{
+    OICLogSetBufferSampling(4);
+    int sampled = 0;
+    for (int i = 0; i < 40; i++)
+    {
+        sampled += OICLogSampleBuffer() ? 1 : 0;
+    }
+    EXPECT_EQ(10, sampled);
+
+    OICLogSetBufferSampling(0);
+    EXPECT_FALSE(OICLogSampleBuffer());
+
+    OICLogSetBufferSampling(1);
+    EXPECT_TRUE(OICLogSampleBuffer());
+}
+
+TEST_F(LogRingTests, WritesRecordsInOrder)
+{
+    OICLogRing *ring = OICLogRingCreate(16);
+    ASSERT_TRUE(ring != NULL);
+
+    for (int i = 0; i < 100; i++)
+    {
+        std::string message = std::to_string(i);
+        // wait for room rather than dropping, order is what is tested here
+        while (!OICLogRingPush(ring, recordWriter, INFO_LEVEL, 0, "RING", message.c_str()))
+        {
+            std::this_thread::yield();
+        }
+    }
+    OICLogRingDestroy(ring);
+
+    std::lock_guard<std::mutex> lock(g_recordsMutex);
+    std::vector<std::string> written;
+    for (const auto& record : g_records)
+    {
+        if (record.compare(0, 5, "RING:") == 0)
+        {
+            written.push_back(record);
+        }
+    }
+    ASSERT_EQ(100u, written.size());
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ("RING:" + std::to_string(i), written[i]);
+    }
+}
+
+TEST_F(LogRingTests, ConcurrentProducers)
+{
+    const int producers = 4;
+    const int perProducer = 2000;
+    OICLogRing *ring = OICLogRingCreate(1024);
+    ASSERT_TRUE(ring != NULL);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([ring]
+        {
+            for (int i = 0; i < perProducer; i++)
+            {
+                while (!OICLogRingPush(ring, recordWriter, INFO_LEVEL, 0, "RING", "message"))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    OICLogRingDestroy(ring);
+
+    // drop reports aside, every message is written once
+    std::lock_guard<std::mutex> lock(g_recordsMutex);
+    int written = 0;
+    for (const auto& record : g_records)
+    {
+        written += (record == "RING:message") ? 1 : 0;
+    }
+    EXPECT_EQ(producers * perProducer, written);
+}
+
+TEST_F(LogRingTests, ReportsDroppedRecords)
+{
+    OICLogRing *ring = OICLogRingCreate(4);
+    ASSERT_TRUE(ring != NULL);
+
+    g_writerBlocked = true;
+    ASSERT_TRUE(OICLogRingPush(ring, blockingWriter, INFO_LEVEL, 0, "RING", "first"));
+
+    // the writer thread holds the first record, the ring fills behind it
+    int dropped = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        dropped += OICLogRingPush(ring, recordWriter, WARNING_LEVEL, 0, "RING", "next") ? 0 : 1;
+    }
+    EXPECT_EQ(7, dropped);
+
+    g_writerBlocked = false;
+    OICLogRingDestroy(ring);
+
+    std::lock_guard<std::mutex> lock(g_recordsMutex);
+    ASSERT_FALSE(g_records.empty());
+    EXPECT_EQ("RING:first", g_records.front());
+    EXPECT_EQ("OIC_LOG:" + std::to_string(dropped) + " log messages dropped, the log ring was full",
+              g_records.back());
+}
+
+TEST_F(LogRingTests, WriteAsyncNeedsStart)
+{
+    EXPECT_FALSE(OICLogWriteAsync(recordWriter, INFO_LEVEL, 0, "ASYNC", "sync"));
+
+    ASSERT_TRUE(OICLogStartAsync(64));
+    EXPECT_TRUE(OICLogWriteAsync(recordWriter, INFO_LEVEL, 0, "ASYNC", "queued"));
+    OICLogStopAsync();
+
+    EXPECT_FALSE(OICLogWriteAsync(recordWriter, INFO_LEVEL, 0, "ASYNC", "sync"));
+
+    std::lock_guard<std::mutex> lock(g_recordsMutex);
+    ASSERT_EQ(1u, g_records.size());
+    EXPECT_EQ("ASYNC:queued", g_records[0]);
+}
@@ -423,6 +423,60 @@ typedef struct
                              helpful to identify the error */
 } CAErrorInfo_t;
 
+#ifdef WITH_BWT
+/**
+ * Callback function type to read a block of a streamed payload.
+ * It is called from the send thread once for every block that is sent.
+ * @param[in]   context     context given with the stream source.
+ * @param[in]   offset      offset of the block in the payload.
+ * @param[out]  buffer      buffer to copy the block to.
+ * @param[in]   length      length of the block.
+ * @return  ::CA_STATUS_OK, or an error code to stop the transfer.
+ */
+typedef CAResult_t (*CABlockReadCallback)(void *context, size_t offset, uint8_t *buffer,
+                                          size_t length);
+
+/**
+ * Callback function type to receive a block of a streamed payload.
+ * Blocks of a transfer arrive in order on a connectivity thread. Offset 0 after
+ * other blocks means the peer started the transfer over. Once the last block
+ * has arrived, the request or response callback is called without payload.
+ * @param[in]   context     context given to CASetBlockStreamHandler().
+ * @param[in]   object      endpoint the block is received from.
+ * @param[in]   token       token of the request or response.
+ * @param[in]   tokenLength length of the token.
+ * @param[in]   offset      offset of the block in the payload.
+ * @param[in]   data        block payload.
+ * @param[in]   length      length of the block payload.
+ * @return  ::CA_STATUS_OK, ::CA_NOT_SUPPORTED for the first block to receive the whole
+ *          payload with the request or response instead, or another error code to
+ *          stop the transfer.
+ */
+typedef CAResult_t (*CABlockWriteCallback)(void *context, const CAEndpoint_t *object,
+                                           const CAToken_t token, uint8_t tokenLength,
+                                           size_t offset, const uint8_t *data, size_t length);
+
+/**
+ * Callback function type to release the context of a stream source.
+ * It is called once for every source given to send a stream, also when sending
+ * fails, as soon as the source is no longer read: after the payload has been
+ * read at once or its transfer has ended, failed, timed out or was replaced.
+ * @param[in]   context     context given with the stream source.
+ */
+typedef void (*CABlockReleaseCallback)(void *context);
+
+/**
+ * Source of a payload that is sent block by block.
+ */
+typedef struct
+{
+    size_t length;                          /**< total payload length */
+    CABlockReadCallback readCallback;       /**< reads a block of the payload */
+    void *context;                          /**< passed to the callbacks */
+    CABlockReleaseCallback releaseCallback; /**< releases the context, may be NULL */
+} CABlockStreamSource_t;
+#endif
+
 /**
  * CA Remote Access information for XMPP Client
  *
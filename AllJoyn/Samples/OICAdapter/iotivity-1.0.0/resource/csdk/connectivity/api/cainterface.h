@@ -170,6 +170,43 @@ CAResult_t CASendRequest(const CAEndpoint_t *object, const CARequestInfo_t *requ
  */
 CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo);
 
+#ifdef WITH_BWT
+/**
+ * Send a request whose payload is read block by block from a stream source,
+ * so that the payload is never held in memory as a whole.
+ * @param[in]   object       Endpoint where the payload need to be sent.
+ * @param[in]   requestInfo  Information for the request, without payload.
+ * @param[in]   source       Source of the payload. The read callback is called
+ *                           until the last block is sent or the transfer fails,
+ *                           then the release callback is called, also when this
+ *                           call fails.
+ * @return  ::CA_STATUS_OK ::CA_STATUS_FAILED ::CA_MEMORY_ALLOC_FAILED ::CA_NOT_SUPPORTED
+ */
+CAResult_t CASendRequestStream(const CAEndpoint_t *object, const CARequestInfo_t *requestInfo,
+                               const CABlockStreamSource_t *source);
+
+/**
+ * Send a response whose payload is read block by block from a stream source,
+ * as blocks are requested by the remote endpoint.
+ * @param[in]   object           Endpoint where the payload need to be sent.
+ * @param[in]   responseInfo     Information for the response, without payload.
+ * @param[in]   source           Source of the payload. Its release callback is
+ *                               called once the transfer has ended or failed.
+ * @return  ::CA_STATUS_OK ::CA_STATUS_FAILED ::CA_MEMORY_ALLOC_FAILED ::CA_NOT_SUPPORTED
+ */
+CAResult_t CASendResponseStream(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo,
+                                const CABlockStreamSource_t *source);
+
+/**
+ * Register a handler that receives block-wise payloads block by block instead
+ * of reassembled with the request or response.
+ * @param[in]   writeCallback   handler for received blocks, NULL to reassemble
+ *                              all payloads again.
+ * @param[in]   context         passed to writeCallback.
+ */
+void CASetBlockStreamHandler(CABlockWriteCallback writeCallback, void *context);
+#endif
+
 /**
  * Select network to use.
  * @param[in]   interestedNetwork    Connectivity Type enum.
@@ -201,6 +238,16 @@ CAResult_t CAGetNetworkInformation(CAEndpoint_t **info, uint32_t *size);
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Wait until a received Request or Response is ready for ::CAHandleRequestResponse.
+ * Does not handle anything itself, so it may be called without serializing with the
+ * other API calls.
+ * @param[in]   timeoutMs   maximum time to wait in milliseconds, 0 to only check.
+ * @return   ::CA_STATUS_OK if a message is pending, ::CA_REQUEST_TIMEOUT if the
+ *           timeout expired first or ::CA_STATUS_NOT_INITIALIZED.
+ */
+CAResult_t CAWaitForRequestResponse(uint32_t timeoutMs);
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
@@ -26,6 +26,14 @@
  * via the SCONS build script.  Currently, cathreadpool_pthreads.c is implemented,
  * with cathreadpool_winthreads.c being considered.  RTOS implementations should use
  * a name that best describes the used technology, not the OS.
+ *
+ * A pool runs tasks on at most num_of_threads worker threads, started on demand.
+ * Tasks that cannot start right away wait in a bounded queue; what happens when
+ * the queue is full is chosen by the overflow policy.  Tasks that do not return
+ * until they are told to stop (receive loops and the like) must be added with
+ * ca_thread_pool_add_long_running_task(), which gives each its own thread: on a
+ * worker they would hold it for good, and once every worker is held the queued
+ * tasks would never run.
  */
 
 #ifndef CA_THREAD_POOL_H_
@@ -53,7 +61,57 @@ typedef struct ca_thread_pool
 }*ca_thread_pool_t;
 
 /**
- * This function creates a newly allocated thread pool.
+ * Queue size used by ca_thread_pool_init().
+ */
+#define CA_THREAD_POOL_DEFAULT_QUEUE_SIZE 64
+
+/**
+ * What ca_thread_pool_add_task() does when the task queue is full.
+ */
+typedef enum
+{
+    CA_THREAD_POOL_REJECT = 0,      /**< Fail with CA_STATUS_FAILED. */
+    CA_THREAD_POOL_BLOCK,           /**< Wait for a free slot.  Do not use from tasks of the
+                                         same pool, they could wait for themselves. */
+    CA_THREAD_POOL_CALLER_RUNS      /**< Run the task on the calling thread. */
+} ca_thread_pool_overflow_policy_t;
+
+/**
+ * Thread pool configuration for ca_thread_pool_init_with_config().
+ */
+typedef struct ca_thread_pool_config
+{
+    int32_t num_of_threads;         /**< Maximum number of worker threads. */
+    uint32_t queue_size;            /**< Tasks that can wait for a worker. */
+    ca_thread_pool_overflow_policy_t overflow_policy;
+    uint32_t cpu_mask;              /**< CPUs the workers may run on, bit n for CPU n,
+                                         0 for no affinity. */
+} ca_thread_pool_config_t;
+
+/**
+ * Thread pool statistics, see ca_thread_pool_get_stats().  Wait time is from
+ * ca_thread_pool_add_task() to the start of the task.
+ */
+typedef struct ca_thread_pool_stats
+{
+    uint32_t num_threads;           /**< Worker threads started. */
+    uint32_t dedicated_threads;     /**< Threads started for long-running tasks. */
+    uint32_t busy_threads;          /**< Workers running a task. */
+    uint32_t queue_depth;           /**< Tasks waiting for a worker. */
+    uint32_t max_queue_depth;
+    uint64_t tasks_submitted;       /**< Tasks queued. */
+    uint64_t tasks_completed;
+    uint64_t tasks_rejected;        /**< Tasks refused with a full queue. */
+    uint64_t tasks_caller_runs;     /**< Tasks run by the caller with a full queue. */
+    uint64_t total_wait_us;
+    uint64_t max_wait_us;
+    uint64_t total_run_us;
+    uint64_t max_run_us;
+} ca_thread_pool_stats_t;
+
+/**
+ * This function creates a newly allocated thread pool with a queue of
+ * CA_THREAD_POOL_DEFAULT_QUEUE_SIZE tasks which rejects tasks when full.
  *
  * @param num_of_threads The number of worker thread used in this pool.
  * @param thread_pool_handle Handle to newly create thread pool.
@@ -61,22 +119,62 @@ typedef struct ca_thread_pool
  */
 CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_pool_handle);
 
+/**
+ * This function creates a newly allocated thread pool.
+ *
+ * @param config Pool size, queue size, overflow policy and worker affinity.
+ * @param thread_pool_handle Handle to newly create thread pool.
+ * @return Error code, CA_STATUS_OK if success, else error number.
+ */
+CAResult_t ca_thread_pool_init_with_config(const ca_thread_pool_config_t *config,
+                                           ca_thread_pool_t *thread_pool_handle);
+
 /**
  * This function adds a routine to be executed by the thread pool at some future time.
+ * The routine must return in a bounded time, as it keeps a worker while it runs; loops
+ * go to ca_thread_pool_add_long_running_task().
  *
  * @param thread_pool The thread pool structure.
  * @param method The routine to be executed.
  * @param data The data to be passed to the routine.
  *
  * @return CA_STATUS_OK on success.
+ * @return CA_STATUS_FAILED if the queue is full and the overflow policy rejects tasks.
  * @return Error on failure.
  */
 CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func method,
                     void *data);
 
+/**
+ * This function starts a routine that runs until it is told to stop, such as a receive
+ * loop, on a thread of its own.  The thread does not count against num_of_threads and
+ * is joined by ca_thread_pool_free(), so the routine must have been stopped by then.
+ *
+ * @param thread_pool The thread pool structure.
+ * @param method The routine to be executed.
+ * @param data The data to be passed to the routine.
+ *
+ * @return CA_STATUS_OK on success.
+ * @return CA_STATUS_FAILED if the thread could not be started or the pool is being freed.
+ * @return Error on failure.
+ */
+CAResult_t ca_thread_pool_add_long_running_task(ca_thread_pool_t thread_pool,
+                                                ca_thread_func method, void *data);
+
+/**
+ * This function copies the statistics of a thread pool.
+ *
+ * @param thread_pool The thread pool structure.
+ * @param stats Filled with the current statistics.
+ *
+ * @return CA_STATUS_OK on success, CA_STATUS_INVALID_PARAM for NULL arguments.
+ */
+CAResult_t ca_thread_pool_get_stats(ca_thread_pool_t thread_pool, ca_thread_pool_stats_t *stats);
+
 /**
  * This function stops all the worker threads (stop & exit). And frees all the allocated memory.
- * Function will return only after joining all threads executing the currently scheduled tasks.
+ * Function will return only after joining all threads executing the currently scheduled tasks,
+ * queued tasks are run first.
  *
  * @param thread_pool The thread pool structure.
  */
@@ -26,6 +26,7 @@
 #include <stdarg.h>
 #include "oic_logger.h"
 #include "oic_console_logger.h"
+#include "oic_log.h"
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -58,6 +59,13 @@ extern "C"
 // Max buffer size used in variable argument log function
 #define MAX_LOG_V_BUFFER_SIZE (256)
 
+// Lowest level compiled in, e.g. -DOC_LOG_MIN_LEVEL=2 leaves out DEBUG and INFO
+// messages. Shared with the stack logger; see OICLogSetTagLevel for the
+// runtime levels.
+#ifndef OC_LOG_MIN_LEVEL
+#define OC_LOG_MIN_LEVEL (0)
+#endif
+
 #ifdef ERROR
 #undef ERROR
 #endif
@@ -183,10 +191,10 @@ void OICLogv(LogLevel level, PROGMEM const char *tag, const int16_t lineNum,
 #define OIC_LOG_BUFFER(level, tag, buffer, bufferSize)
 #else // These macros are defined for Linux, Android, and Arduino
 #define OIC_LOG_INIT()    OICLogInit()
-#define OIC_LOG_BUFFER(level, tag, buffer, bufferSize)\
-    OICLogBuffer((level), (tag), (buffer), (bufferSize))
 
 #ifdef ARDUINO
+#define OIC_LOG_BUFFER(level, tag, buffer, bufferSize)\
+    OICLogBuffer((level), (tag), (buffer), (bufferSize))
 #define OIC_LOG_CONFIG(ctx)
 #define OIC_LOG_SHUTDOWN()
 #define OIC_LOG(level, tag, logStr) OICLog((level), PCF(tag), __LINE__, PCF(logStr))
@@ -196,8 +204,15 @@ void OICLogv(LogLevel level, PROGMEM const char *tag, const int16_t lineNum,
 #else
 #define OIC_LOG_CONFIG(ctx)    OICLogConfig((ctx))
 #define OIC_LOG_SHUTDOWN()     OICLogShutdown()
-#define OIC_LOG(level, tag, logStr)  OICLog((level), (tag), (logStr))
-#define OIC_LOG_V(level, tag, ...) OICLogv((level), (tag), __VA_ARGS__)
+#define OIC_LOG_ENABLED(level, tag) \
+    ((int)(level) >= OC_LOG_MIN_LEVEL && OICLogIsEnabled((level), (tag)))
+#define OIC_LOG(level, tag, logStr) \
+    do { if (OIC_LOG_ENABLED((level), (tag))) OICLog((level), (tag), (logStr)); } while (0)
+#define OIC_LOG_V(level, tag, ...) \
+    do { if (OIC_LOG_ENABLED((level), (tag))) OICLogv((level), (tag), __VA_ARGS__); } while (0)
+#define OIC_LOG_BUFFER(level, tag, buffer, bufferSize) \
+    do { if (OIC_LOG_ENABLED((level), (tag))) \
+        OICLogBuffer((level), (tag), (buffer), (bufferSize)); } while (0)
 #endif //ARDUINO
 #endif //__TIZEN__
 #else //TB_LOG
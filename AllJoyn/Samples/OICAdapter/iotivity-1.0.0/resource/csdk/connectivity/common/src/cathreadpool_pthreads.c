@@ -24,73 +24,299 @@
  * This file provides APIs related to thread pool.
  */
 
+// Defining _GNU_SOURCE before any header exposes sched_setaffinity and
+// CPU_SET for worker affinity on Linux.
+#define _GNU_SOURCE
+
 #ifdef WIN32
 #include <Windows.h>
 typedef HANDLE pthread_t;
 #else
 #include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
 #endif
 
-#define _GNU_SOURCE
 #include <errno.h>
+#include <string.h>
 #include "cathreadpool.h"
 #include "logger.h"
 #include "oic_malloc.h"
-#include "uarraylist.h"
 #include "camutex.h"
 
 #define TAG PCF("UTHREADPOOL")
 
 /**
- * empty struct to represent the details.  This implementation has no data
- * that it needs to keep track of, so it only uses NULL for the internal value.
+ * A queued task and the time it was queued at, for the wait latency.
  */
-typedef struct ca_thread_pool_details_t
+typedef struct ca_thread_pool_task_t
 {
-    u_arraylist_t* threads_list;
-    ca_mutex list_lock;
-} ca_thread_pool_details_t;
+    ca_thread_func func;
+    void* data;
+    uint64_t queued_us;
+} ca_thread_pool_task_t;
 
 /**
- * struct to wrap the pthreads callback properly.  The function pointer for
- * pthreads requires a void* return value, however u_thread_func is a void.
+ * A long-running task handed to its dedicated thread, which frees it.
  */
-typedef struct ca_thread_pool_callback_info_t
+typedef struct ca_thread_pool_dedicated_task_t
 {
     ca_thread_func func;
     void* data;
-} ca_thread_pool_callback_info_t;
+} ca_thread_pool_dedicated_task_t;
+
+/**
+ * Worker threads take tasks from a fixed size ring buffer.  Workers are
+ * started on demand when a task is queued and no worker is idle, up to
+ * num_of_threads, and they live until the pool is freed.  Long-running
+ * tasks get a dedicated thread each, outside of the workers, which is
+ * joined when the pool is freed.
+ */
+typedef struct ca_thread_pool_details_t
+{
+    ca_mutex lock;
+    ca_cond task_cond;          // a task was queued, or shutdown
+    ca_cond space_cond;         // a queue slot was freed, or shutdown
+    ca_thread_pool_task_t* queue;
+    uint32_t queue_size;
+    uint32_t head;
+    uint32_t count;
+    pthread_t* threads;
+    int32_t max_threads;
+    int32_t started_threads;
+    int32_t idle_threads;
+    pthread_t* dedicated_threads;
+    uint32_t dedicated_count;
+    uint32_t dedicated_capacity;
+    ca_thread_pool_overflow_policy_t overflow_policy;
+    uint32_t cpu_mask;
+    bool shutdown;
+    ca_thread_pool_stats_t stats;
+} ca_thread_pool_details_t;
+
+static uint64_t ca_thread_pool_now_us()
+{
+#ifdef WIN32
+    return (uint64_t)GetTickCount64() * 1000;
+#elif defined(__ANDROID__) || _POSIX_TIMERS > 0
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+static void ca_thread_pool_set_affinity(uint32_t cpu_mask)
+{
+    if (0 == cpu_mask)
+    {
+        return;
+    }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 32; ++cpu)
+    {
+        if (cpu_mask & (1u << cpu))
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+    // pid 0 is the calling thread
+    if (0 != sched_setaffinity(0, sizeof(set), &set))
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to set worker affinity to 0x%x: %d", cpu_mask, errno);
+    }
+#elif defined(WIN32)
+    if (0 == SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)cpu_mask))
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to set worker affinity to 0x%x: %d", cpu_mask,
+                  GetLastError());
+    }
+#else
+    OIC_LOG(ERROR, TAG, "Worker affinity is not supported on this platform");
+#endif
+}
+
+// worker thread body: runs queued tasks until the pool is freed and the
+// queue is empty
+static void* ca_thread_pool_worker(void* data)
+{
+    ca_thread_pool_details_t* details = (ca_thread_pool_details_t*)data;
+
+    ca_thread_pool_set_affinity(details->cpu_mask);
+
+    ca_mutex_lock(details->lock);
+    for (;;)
+    {
+        while (0 == details->count && !details->shutdown)
+        {
+            details->idle_threads++;
+            ca_cond_wait(details->task_cond, details->lock);
+            details->idle_threads--;
+        }
+        if (0 == details->count)
+        {
+            break;
+        }
+
+        ca_thread_pool_task_t task = details->queue[details->head];
+        details->head = (details->head + 1) % details->queue_size;
+        details->count--;
+        ca_cond_signal(details->space_cond);
+
+        uint64_t start = ca_thread_pool_now_us();
+        uint64_t wait = start - task.queued_us;
+        details->stats.queue_depth = details->count;
+        details->stats.busy_threads++;
+        details->stats.total_wait_us += wait;
+        if (wait > details->stats.max_wait_us)
+        {
+            details->stats.max_wait_us = wait;
+        }
+        ca_mutex_unlock(details->lock);
+
+        task.func(task.data);
+
+        uint64_t run = ca_thread_pool_now_us() - start;
+        ca_mutex_lock(details->lock);
+        details->stats.busy_threads--;
+        details->stats.tasks_completed++;
+        details->stats.total_run_us += run;
+        if (run > details->stats.max_run_us)
+        {
+            details->stats.max_run_us = run;
+        }
+    }
+    ca_mutex_unlock(details->lock);
+    return NULL;
+}
 
-// passthrough function to convert the pthreads call to a u_thread_func call
-void* ca_thread_pool_pthreads_delegate(void* data)
+// dedicated thread body: runs its long-running task once
+static void* ca_thread_pool_dedicated(void* data)
 {
-    ca_thread_pool_callback_info_t* info = (ca_thread_pool_callback_info_t*)data;
-    info->func(info->data);
-    OICFree(info);
+    ca_thread_pool_dedicated_task_t task = *(ca_thread_pool_dedicated_task_t*)data;
+    OICFree(data);
+
+    task.func(task.data);
     return NULL;
 }
 
-// this implementation doesn't do a thread pool, so this function is essentially
-// a no-op besides creating a valid ca_thread_pool_t object.  It was determined after
-// reading through the existing implementation that the thread-pooling was unnecessary
-// for the posix platforms.  Behavior shouldn't be changed since previously num_of_threads
-// was greater than the number of requested threads.
+static bool ca_thread_pool_create_thread(void* (*routine)(void*), void* data,
+                                         pthread_t* threadHandle)
+{
+#ifdef WIN32
+    *threadHandle = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)routine, data, 0, NULL);
+    if (NULL == *threadHandle)
+    {
+        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", GetLastError());
+        return false;
+    }
+#else
+    int result = pthread_create(threadHandle, NULL, routine, data);
+    if (result != 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", result);
+        return false;
+    }
+#endif
+    return true;
+}
+
+static void ca_thread_pool_join_thread(pthread_t tid, uint32_t index)
+{
+#ifdef WIN32
+    DWORD joinres = WaitForSingleObject(tid, INFINITE);
+    if (WAIT_OBJECT_0 != joinres)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", index, joinres);
+    }
+    CloseHandle(tid);
+#else
+    int joinres = pthread_join(tid, NULL);
+    if(0 != joinres)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", index, joinres);
+    }
+#endif
+}
+
+// starts one more worker, called with the lock held
+static bool ca_thread_pool_start_worker(ca_thread_pool_details_t* details)
+{
+    pthread_t threadHandle;
+
+    if (!ca_thread_pool_create_thread(ca_thread_pool_worker, details, &threadHandle))
+    {
+        return false;
+    }
+
+    details->threads[details->started_threads++] = threadHandle;
+    details->stats.num_threads = details->started_threads;
+    return true;
+}
+
+static void ca_thread_pool_details_free(ca_thread_pool_details_t* details)
+{
+    if (details->lock)
+    {
+        ca_mutex_free(details->lock);
+    }
+    if (details->task_cond)
+    {
+        ca_cond_free(details->task_cond);
+    }
+    if (details->space_cond)
+    {
+        ca_cond_free(details->space_cond);
+    }
+    OICFree(details->queue);
+    OICFree(details->threads);
+    OICFree(details->dedicated_threads);
+    OICFree(details);
+}
+
 CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_pool)
+{
+    ca_thread_pool_config_t config = {
+        num_of_threads,
+        CA_THREAD_POOL_DEFAULT_QUEUE_SIZE,
+        CA_THREAD_POOL_REJECT,
+        0
+    };
+
+    return ca_thread_pool_init_with_config(&config, thread_pool);
+}
+
+CAResult_t ca_thread_pool_init_with_config(const ca_thread_pool_config_t *config,
+                                           ca_thread_pool_t *thread_pool)
 {
     OIC_LOG(DEBUG, TAG, "IN");
 
-    if(!thread_pool)
+    if(!thread_pool || !config)
     {
-        OIC_LOG(ERROR, TAG, "Parameter thread_pool was null!");
+        OIC_LOG(ERROR, TAG, "Parameter thread_pool or config was null!");
         return CA_STATUS_INVALID_PARAM;
     }
 
-    if(num_of_threads <= 0)
+    if(config->num_of_threads <= 0)
     {
         OIC_LOG(ERROR, TAG, "num_of_threads must be positive and non-zero");
         return CA_STATUS_INVALID_PARAM;
     }
 
+    if(0 == config->queue_size)
+    {
+        OIC_LOG(ERROR, TAG, "queue_size must be non-zero");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
     *thread_pool = OICMalloc(sizeof(struct ca_thread_pool));
 
     if(!*thread_pool)
@@ -99,8 +325,8 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details = OICMalloc(sizeof(struct ca_thread_pool_details_t));
-    if(!(*thread_pool)->details)
+    ca_thread_pool_details_t* details = OICCalloc(1, sizeof(ca_thread_pool_details_t));
+    if(!details)
     {
         OIC_LOG(ERROR, TAG, "Failed to allocate for thread-pool details");
         OICFree(*thread_pool);
@@ -108,33 +334,35 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details->list_lock = ca_mutex_new();
-
-    if(!(*thread_pool)->details->list_lock)
+    details->queue = OICMalloc(config->queue_size * sizeof(ca_thread_pool_task_t));
+    details->threads = OICMalloc(config->num_of_threads * sizeof(pthread_t));
+    if(!details->queue || !details->threads)
     {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool mutex");
-        OICFree((*thread_pool)->details);
+        OIC_LOG(ERROR, TAG, "Failed to allocate for thread-pool queue");
+        ca_thread_pool_details_free(details);
         OICFree(*thread_pool);
         *thread_pool = NULL;
-        return CA_STATUS_FAILED;
+        return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details->threads_list = u_arraylist_create();
-
-    if(!(*thread_pool)->details->threads_list)
+    details->lock = ca_mutex_new();
+    details->task_cond = ca_cond_new();
+    details->space_cond = ca_cond_new();
+    if(!details->lock || !details->task_cond || !details->space_cond)
     {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool list");
-        if(!ca_mutex_free((*thread_pool)->details->list_lock))
-        {
-            OIC_LOG(ERROR, TAG, "Failed to free thread-pool mutex");
-        }
-
-        OICFree((*thread_pool)->details);
+        OIC_LOG(ERROR, TAG, "Failed to create thread-pool mutex or conditions");
+        ca_thread_pool_details_free(details);
         OICFree(*thread_pool);
         *thread_pool = NULL;
         return CA_STATUS_FAILED;
     }
 
+    details->queue_size = config->queue_size;
+    details->max_threads = config->num_of_threads;
+    details->overflow_policy = config->overflow_policy;
+    details->cpu_mask = config->cpu_mask;
+    (*thread_pool)->details = details;
+
     OIC_LOG(DEBUG, TAG, "OUT");
     return CA_STATUS_OK;
 }
@@ -150,48 +378,142 @@ CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func
         return CA_STATUS_INVALID_PARAM;
     }
 
-    ca_thread_pool_callback_info_t* info = OICMalloc(sizeof(ca_thread_pool_callback_info_t));
-    if(!info)
+    ca_thread_pool_details_t* details = thread_pool->details;
+
+    ca_mutex_lock(details->lock);
+    while (details->count == details->queue_size && !details->shutdown)
     {
-        OIC_LOG(ERROR, TAG, "Failed to allocate for memory wrapper");
-        return CA_MEMORY_ALLOC_FAILED;
+        if (CA_THREAD_POOL_REJECT == details->overflow_policy)
+        {
+            details->stats.tasks_rejected++;
+            ca_mutex_unlock(details->lock);
+            OIC_LOG(ERROR, TAG, "Task queue is full, task rejected");
+            return CA_STATUS_FAILED;
+        }
+        if (CA_THREAD_POOL_CALLER_RUNS == details->overflow_policy)
+        {
+            details->stats.tasks_caller_runs++;
+            ca_mutex_unlock(details->lock);
+            method(data);
+            OIC_LOG(DEBUG, TAG, "OUT");
+            return CA_STATUS_OK;
+        }
+        ca_cond_wait(details->space_cond, details->lock);
+    }
+    if (details->shutdown)
+    {
+        ca_mutex_unlock(details->lock);
+        OIC_LOG(ERROR, TAG, "Thread pool is shutting down");
+        return CA_STATUS_FAILED;
     }
 
-    info->func = method;
-    info->data = data;
+    uint32_t tail = (details->head + details->count) % details->queue_size;
+    details->queue[tail].func = method;
+    details->queue[tail].data = data;
+    details->queue[tail].queued_us = ca_thread_pool_now_us();
+    details->count++;
+
+    // Queued tasks beyond the idle workers get a new worker while the pool
+    // is below its size.  Without any worker the task could never run.
+    if ((uint32_t)details->idle_threads < details->count
+        && details->started_threads < details->max_threads
+        && !ca_thread_pool_start_worker(details)
+        && 0 == details->started_threads)
+    {
+        details->count--;
+        ca_mutex_unlock(details->lock);
+        return CA_STATUS_FAILED;
+    }
 
-    pthread_t threadHandle;
+    details->stats.tasks_submitted++;
+    details->stats.queue_depth = details->count;
+    if (details->count > details->stats.max_queue_depth)
+    {
+        details->stats.max_queue_depth = details->count;
+    }
+    ca_cond_signal(details->task_cond);
+    ca_mutex_unlock(details->lock);
 
-#ifdef WIN32
-    if ((threadHandle = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)ca_thread_pool_pthreads_delegate, (void*)info, 0, NULL)) == INVALID_HANDLE_VALUE)
+    OIC_LOG(DEBUG, TAG, "OUT");
+    return CA_STATUS_OK;
+}
+
+CAResult_t ca_thread_pool_add_long_running_task(ca_thread_pool_t thread_pool,
+                                                ca_thread_func method, void *data)
+{
+    OIC_LOG(DEBUG, TAG, "IN");
+
+    if(NULL == thread_pool || NULL == method)
     {
-        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", GetLastError());
-        return CA_STATUS_FAILED;
+        OIC_LOG(ERROR, TAG, "thread_pool or method was NULL");
+        return CA_STATUS_INVALID_PARAM;
     }
-#else
-    int result = pthread_create(&threadHandle, NULL, ca_thread_pool_pthreads_delegate, info);
 
-    if(result != 0)
+    ca_thread_pool_details_t* details = thread_pool->details;
+
+    ca_thread_pool_dedicated_task_t* task = OICMalloc(sizeof(ca_thread_pool_dedicated_task_t));
+    if (!task)
     {
-        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", result);
+        OIC_LOG(ERROR, TAG, "Failed to allocate for long-running task");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    task->func = method;
+    task->data = data;
+
+    ca_mutex_lock(details->lock);
+    if (details->shutdown)
+    {
+        ca_mutex_unlock(details->lock);
+        OICFree(task);
+        OIC_LOG(ERROR, TAG, "Thread pool is shutting down");
         return CA_STATUS_FAILED;
     }
-#endif
 
-    ca_mutex_lock(thread_pool->details->list_lock);
-    bool addResult = u_arraylist_add(thread_pool->details->threads_list, (void*)threadHandle);
-    ca_mutex_unlock(thread_pool->details->list_lock);
+    if (details->dedicated_count == details->dedicated_capacity)
+    {
+        uint32_t capacity = details->dedicated_capacity ? details->dedicated_capacity * 2 : 4;
+        pthread_t* threads = OICRealloc(details->dedicated_threads, capacity * sizeof(pthread_t));
+        if (!threads)
+        {
+            ca_mutex_unlock(details->lock);
+            OICFree(task);
+            OIC_LOG(ERROR, TAG, "Failed to allocate for long-running task thread");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        details->dedicated_threads = threads;
+        details->dedicated_capacity = capacity;
+    }
 
-    if(!addResult)
+    pthread_t threadHandle;
+    if (!ca_thread_pool_create_thread(ca_thread_pool_dedicated, task, &threadHandle))
     {
-        OIC_LOG_V(ERROR, TAG, "Arraylist Add failed, may not be properly joined: %d", addResult);
+        ca_mutex_unlock(details->lock);
+        OICFree(task);
         return CA_STATUS_FAILED;
     }
 
+    details->dedicated_threads[details->dedicated_count++] = threadHandle;
+    details->stats.dedicated_threads = details->dedicated_count;
+    ca_mutex_unlock(details->lock);
+
     OIC_LOG(DEBUG, TAG, "OUT");
     return CA_STATUS_OK;
 }
 
+CAResult_t ca_thread_pool_get_stats(ca_thread_pool_t thread_pool, ca_thread_pool_stats_t *stats)
+{
+    if(NULL == thread_pool || NULL == stats)
+    {
+        OIC_LOG(ERROR, TAG, "thread_pool or stats was NULL");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_mutex_lock(thread_pool->details->lock);
+    *stats = thread_pool->details->stats;
+    ca_mutex_unlock(thread_pool->details->lock);
+    return CA_STATUS_OK;
+}
+
 void ca_thread_pool_free(ca_thread_pool_t thread_pool)
 {
     OIC_LOG(DEBUG, TAG, "IN");
@@ -202,33 +524,27 @@ void ca_thread_pool_free(ca_thread_pool_t thread_pool)
         return;
     }
 
-    ca_mutex_lock(thread_pool->details->list_lock);
+    ca_thread_pool_details_t* details = thread_pool->details;
+
+    // Workers finish the queued tasks before they see the shutdown.
+    ca_mutex_lock(details->lock);
+    details->shutdown = true;
+    ca_cond_broadcast(details->task_cond);
+    ca_cond_broadcast(details->space_cond);
+    ca_mutex_unlock(details->lock);
 
-    for(uint32_t i = 0; i<u_arraylist_length(thread_pool->details->threads_list); ++i)
+    for(int32_t i = 0; i < details->started_threads; ++i)
     {
-        pthread_t tid = (pthread_t)u_arraylist_get(thread_pool->details->threads_list, i);
-#ifdef WIN32
-        DWORD joinres = WaitForSingleObject(tid, INFINITE);
-        if (WAIT_OBJECT_0 != joinres)
-        {
-            OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", i, joinres);
-        }
-        CloseHandle(tid);
-#else
-        int joinres = pthread_join(tid, NULL);
-        if(0 != joinres)
-        {
-            OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", i, joinres);
-        }
-#endif
+        ca_thread_pool_join_thread(details->threads[i], i);
     }
 
-    u_arraylist_free(&(thread_pool->details->threads_list));
-
-    ca_mutex_unlock(thread_pool->details->list_lock);
-    ca_mutex_free(thread_pool->details->list_lock);
+    // Long-running tasks are expected to have been told to stop by now.
+    for(uint32_t i = 0; i < details->dedicated_count; ++i)
+    {
+        ca_thread_pool_join_thread(details->dedicated_threads[i], i);
+    }
 
-    OICFree(thread_pool->details);
+    ca_thread_pool_details_free(details);
     OICFree(thread_pool);
 
     OIC_LOG(DEBUG, TAG, "OUT");
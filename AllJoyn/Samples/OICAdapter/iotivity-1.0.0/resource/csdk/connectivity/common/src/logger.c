@@ -50,6 +50,7 @@
 #include "string.h"
 #include "oic_logger.h"
 #include "oic_console_logger.h"
+#include "oic_log.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -122,6 +123,8 @@ void OICLogInit()
 
 void OICLogShutdown()
 {
+    // the writer thread may still write through logCtx
+    OICLogStopAsync();
 #if defined(__linux__) || defined(__APPLE__)
     if (logCtx && logCtx->destroy)
     {
@@ -130,22 +133,50 @@ void OICLogShutdown()
 #endif
 }
 
-/**
- * Output a log string with the specified priority level.
- * Only defined for Linux and Android
- *
- * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
- * @param tag    - Module name
- * @param logStr - log string
- */
-void OICLog(LogLevel level, const char *tag, const char *logStr)
+// Milliseconds within the hour, what the log lines show
+static uint32_t OICLogGetTimestamp()
 {
-    if (!logStr || !tag)
+    int min = 0;
+    int sec = 0;
+    int ms = 0;
+#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
+    struct timespec when = { 0, 0 };
+    clockid_t clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    clk = CLOCK_REALTIME_COARSE;
+#endif
+    if (!clock_gettime(clk, &when))
     {
-        return;
+        min = (when.tv_sec / 60) % 60;
+        sec = when.tv_sec % 60;
+        ms = when.tv_nsec / 1000000;
+    }
+#elif defined(WIN32)
+    SYSTEMTIME localTime = {0};
+    GetLocalTime(&localTime);
+    min = localTime.wMinute;
+    sec = localTime.wSecond;
+    ms = localTime.wMilliseconds;
+#elif defined(HAVE_UNISTD_H)
+    struct timeval now;
+    if (!gettimeofday(&now, NULL))
+    {
+        min = (now.tv_sec / 60) % 60;
+        sec = now.tv_sec % 60;
+        ms = now.tv_usec / 1000;
     }
+#endif
+    return (uint32_t)((min * 60 + sec) * 1000 + ms);
+}
 
+/**
+ * Write a log string out on the calling thread, or on the writer thread of
+ * the log ring.
+ */
+static void OICLogWrite(LogLevel level, const char *tag, const char *logStr, uint32_t timestamp)
+{
 #ifdef __ANDROID__
+    (void)timestamp;
 
 #ifdef ADB_SHELL
     printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
@@ -161,41 +192,50 @@ void OICLog(LogLevel level, const char *tag, const char *logStr)
     }
     else
     {
-        int min = 0;
-        int sec = 0;
-        int ms = 0;
-#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-        struct timespec when = { 0, 0 };
-        clockid_t clk = CLOCK_REALTIME;
-#ifdef CLOCK_REALTIME_COARSE
-        clk = CLOCK_REALTIME_COARSE;
-#endif
-        if (!clock_gettime(clk, &when))
-        {
-            min = (when.tv_sec / 60) % 60;
-            sec = when.tv_sec % 60;
-            ms = when.tv_nsec / 1000000;
-        }
-#elif defined(WIN32)
-        SYSTEMTIME localTime = {0};
-        GetLocalTime(&localTime);
-        min = localTime.wMinute;
-        sec = localTime.wSecond;
-        ms = localTime.wMilliseconds;
-#else
-        struct timeval now;
-        if (!gettimeofday(&now, NULL))
-        {
-            min = (now.tv_sec / 60) % 60;
-            sec = now.tv_sec % 60;
-            ms = now.tv_usec * 1000;
-        }
-#endif
+        int min = timestamp / 60000;
+        int sec = (timestamp / 1000) % 60;
+        int ms = timestamp % 1000;
         printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
     }
 #endif
 }
 
+static void OICLogWriteRecord(const OICLogRecord *record)
+{
+    OICLogWrite((LogLevel)record->level, record->tag, record->message, record->timestamp);
+}
+
+// Queue the string for the writer thread when there is one
+static void OICLogOutput(LogLevel level, const char *tag, const char *logStr)
+{
+    uint32_t timestamp = OICLogGetTimestamp();
+    if (!OICLogWriteAsync(OICLogWriteRecord, level, timestamp, tag, logStr))
+    {
+        OICLogWrite(level, tag, logStr, timestamp);
+    }
+}
+
+/**
+ * Output a log string with the specified priority level.
+ * Only defined for Linux and Android
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @param tag    - Module name
+ * @param logStr - log string
+ */
+void OICLog(LogLevel level, const char *tag, const char *logStr)
+{
+    if (!logStr || !tag)
+    {
+        return;
+    }
+    if (!OICLogIsEnabled(level, tag))
+    {
+        return;
+    }
+    OICLogOutput(level, tag, logStr);
+}
+
 /**
  * Output a variable argument list log string with the specified priority level.
  * Only defined for Linux and Android
@@ -210,16 +250,22 @@ void OICLogv(LogLevel level, const char *tag, const char *format, ...)
     {
         return;
     }
+    // Nothing is formatted for a disabled level
+    if (!OICLogIsEnabled(level, tag))
+    {
+        return;
+    }
     char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof buffer - 1, format, args);
     va_end(args);
-    OICLog(level, tag, buffer);
+    OICLogOutput(level, tag, buffer);
 }
 
 /**
  * Output the contents of the specified buffer (in hex) with the specified priority level.
+ * Only one buffer out of the interval set with OICLogSetBufferSampling is output.
  *
  * @param level      - DEBUG, INFO, WARNING, ERROR, FATAL
  * @param tag        - Module name
@@ -232,6 +278,10 @@ void OICLogBuffer(LogLevel level, const char *tag, const uint8_t *buffer, uint16
     {
         return;
     }
+    if (!OICLogIsEnabled(level, tag) || !OICLogSampleBuffer())
+    {
+        return;
+    }
 
     // I've got no idea why static initialization doesn't work here.  It seems that the compiler
     // seems to think that this is a variable-sized object
@@ -247,7 +297,7 @@ void OICLogBuffer(LogLevel level, const char *tag, const uint8_t *buffer, uint16
         // Output 16 values per line
         if (((i + 1) % 16) == 0)
         {
-            OICLog(level, tag, lineBuffer);
+            OICLogOutput(level, tag, lineBuffer);
             memset(lineBuffer, 0, sizeof lineBuffer);
             lineIndex = 0;
         }
@@ -255,7 +305,7 @@ void OICLogBuffer(LogLevel level, const char *tag, const uint8_t *buffer, uint16
     // Output last values in the line, if any
     if (bufferSize % 16)
     {
-        OICLog(level, tag, lineBuffer);
+        OICLogOutput(level, tag, lineBuffer);
     }
 }
 #endif //__TIZEN__
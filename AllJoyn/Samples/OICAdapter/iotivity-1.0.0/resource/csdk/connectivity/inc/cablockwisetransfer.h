@@ -47,6 +47,20 @@ typedef void (*CASendThreadFunc)(CAData_t *data);
  */
 typedef void (*CAReceiveThreadFunc)(CAData_t *data);
 
+/**
+ * Time in microseconds after which a block data set that has seen no block
+ * is removed from the block-wise transfer list. This is the EXCHANGE_LIFETIME
+ * of RFC 7252, the longest a peer may take to send the next block.
+ */
+#define CA_BLOCK_DATA_IDLE_TIMEOUT      (247 * (uint64_t)1000000)
+
+/**
+ * Minimum time in microseconds between two scans for idle block data sets.
+ */
+#define CA_BLOCK_DATA_SWEEP_INTERVAL    (10 * (uint64_t)1000000)
+
+typedef struct CABlockData CABlockData_t;
+
 /**
  * context of blockwise transfer.
  */
@@ -58,8 +72,26 @@ typedef struct
     /** callback function for received message. **/
     CAReceiveThreadFunc receivedThreadFunc;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** hash table of block data sets, chained through CABlockData_t::next. **/
+    CABlockData_t **dataTable;
+
+    /** number of buckets in dataTable, a power of two. **/
+    size_t dataTableSize;
+
+    /** number of block data sets in dataTable. **/
+    size_t dataCount;
+
+    /** time of the last scan for idle block data sets. **/
+    uint64_t lastSweepTime;
+
+    /** number of block data sets with a streamed payload to send. **/
+    size_t streamCount;
+
+    /** handler for received payloads that are streamed. **/
+    CABlockWriteCallback writeCallback;
+
+    /** context passed to writeCallback. **/
+    void *writeContext;
 
     /** data list mutex for synchronization. **/
     ca_mutex blockDataListMutex;
@@ -80,7 +112,7 @@ typedef struct
 /**
  * Block Data Set.
  */
-typedef struct
+struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
@@ -90,7 +122,13 @@ typedef struct
     CAPayload_t payload;                /**< payload buffer. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
-} CABlockData_t;
+    size_t payloadCapacity;             /**< allocated size of the payload buffer. */
+    uint64_t lastActivity;              /**< time of the last lookup, in microseconds. */
+    CABlockStreamSource_t source;       /**< source of a streamed payload to be sent. */
+    bool streamed;                      /**< received payload is passed to writeCallback. */
+    uint32_t hash;                      /**< hash of blockDataId. */
+    CABlockData_t *next;                /**< next block data in the same hash bucket. */
+};
 
 /**
  * state of received block message from remote endpoint.
@@ -151,6 +189,39 @@ void CATerminateBlockWiseMutexVariables();
  */
 CAResult_t CASendBlockWiseData(const CAData_t *data);
 
+/**
+ * Send a message whose payload is read block by block from a stream source.
+ * A payload that fits in one block is read at once into sendData.
+ * @param[in]   sendData    data to be sent, without payload.
+ * @param[in]   source      source of the payload, released when it is no longer
+ *                          read, also when this call fails.
+ * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ *         ::CA_NOT_SUPPORTED means sendData is to be sent as a normal message.
+ */
+CAResult_t CASendBlockWiseStream(CAData_t *sendData, const CABlockStreamSource_t *source);
+
+/**
+ * Release a stream source that won't be read.
+ * @param[in]   source      source of the payload, may be NULL.
+ */
+void CAReleaseBlockStreamSource(const CABlockStreamSource_t *source);
+
+/**
+ * Set the handler that received payloads are streamed to.
+ * @param[in]   writeCallback   handler for received blocks, NULL to reassemble payloads.
+ * @param[in]   context         passed to writeCallback.
+ */
+void CASetBlockWriteCallback(CABlockWriteCallback writeCallback, void *context);
+
+/**
+ * Get the length of a payload that is streamed, which the message doesn't carry.
+ * @param[in]   token           token of the message.
+ * @param[in]   tokenLength     length of the token.
+ * @param[in]   port            port of the remote endpoint.
+ * @return  length of the streamed payload, 0 if the payload isn't streamed.
+ */
+size_t CAGetBlockStreamLength(const CAToken_t token, uint8_t tokenLength, uint16_t port);
+
 /**
  * Add the data to send thread queue.
  * @param[in]   sendData    data for sending.
@@ -551,6 +622,12 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID);
  */
 bool CAIsBlockDataInList(const CABlockDataID_t *blockID);
 
+/**
+ * Remove the block data sets that have not been looked up for a given time.
+ * @param[in]   idleTime    idle time in microseconds.
+ * @return number of removed block data sets.
+ */
+size_t CARemoveIdleBlockDataFromList(uint64_t idleTime);
 
 #ifdef __cplusplus
 } /* extern "C" */
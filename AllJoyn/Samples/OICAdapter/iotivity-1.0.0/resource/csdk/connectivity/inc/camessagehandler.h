@@ -126,6 +126,13 @@ void CATerminateMessageHandler();
  */
 void CAHandleRequestResponseCallbacks();
 
+/**
+ * Wait until a received message is queued for CAHandleRequestResponseCallbacks.
+ * @param[in]   timeoutMs   maximum time to wait in milliseconds, 0 to only check the queue.
+ * @return  true if a message is pending, false if the timeout expired first.
+ */
+bool CAWaitForRequestResponseCallbacks(uint32_t timeoutMs);
+
 /**
  * To log the PDU data.
  * @param[in] pdu    pdu data.
@@ -145,6 +152,18 @@ void CAAddDataToSendThread(CAData_t *data);
  * @param[in] data    received data.
  */
 void CAAddDataToReceiveThread(CAData_t *data);
+
+/**
+ * Detaches control from the caller for sending a message whose payload is
+ * read block by block from a stream source.
+ * @param[in] endpoint    endpoint information where the data has to be sent.
+ * @param[in] sendData    request or response that needs to be sent, without payload.
+ * @param[in] dataType    ::CA_REQUEST_DATA or ::CA_RESPONSE_DATA.
+ * @param[in] source      source of the payload, released also when this call fails.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CADetachStreamMessage(const CAEndpoint_t *endpoint, const void *sendData,
+                                 CADataType_t dataType, const CABlockStreamSource_t *source);
 #endif
 
 #ifdef __cplusplus
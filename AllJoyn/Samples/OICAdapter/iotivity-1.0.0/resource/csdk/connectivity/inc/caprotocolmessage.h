@@ -50,11 +50,27 @@ typedef uint32_t code_t;
 
 static const uint8_t PAYLOAD_MARKER = 1;
 
+/**
+ * Starts caching the options CAGeneratePDU generates for a URI, header options
+ * and formats, so that messages sent again to the same URI are not parsed again.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAInitializePDUTemplates();
+
+/**
+ * Frees the cached options and the PDUs kept for reuse. No PDU may be generated
+ * during the call.
+ */
+void CATerminatePDUTemplates();
+
 /**
  * generates pdu structure from the given information.
+ * The pdu storage is sized to the message.
  * @param[in]   code                 code of the pdu packet.
  * @param[in]   info                 pdu information.
  * @param[in]   endpoint             endpoint information.
+ * @param[out]  optlist              options of the pdu, sorted.
+ * @param[out]  transport            transport type of the pdu.
  * @return  generated pdu.
  */
 coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
@@ -57,7 +57,9 @@ int coap_delete(coap_list_t *node)
 
     if (node->delete_func)
         node->delete_func(node->data);
-    coap_free( node->data);
+    /* data allocated with the node by coap_new_listnode_data() goes with it */
+    if (node->data != (void *) (node + 1))
+        coap_free( node->data);
     coap_free( node);
 
     return 1;
@@ -90,3 +92,19 @@ coap_new_listnode(void *data, void (*delete_func)(void *))
     return node;
 }
 
+coap_list_t *
+coap_new_listnode_data(size_t size)
+{
+    coap_list_t *node = (coap_list_t *) coap_malloc( sizeof(coap_list_t) + size );
+    if (!node)
+    {
+#ifndef NDEBUG
+        coap_log(LOG_CRIT, "coap_new_listnode_data: malloc\n");
+#endif
+        return NULL;
+    }
+
+    memset(node, 0, sizeof(coap_list_t) + size);
+    node->data = node + 1;
+    return node;
+}
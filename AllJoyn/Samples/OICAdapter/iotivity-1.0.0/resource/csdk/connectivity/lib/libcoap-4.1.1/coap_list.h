@@ -9,6 +9,8 @@
 #ifndef _COAP_LIST_H_
 #define _COAP_LIST_H_
 
+#include <stddef.h>
+
 struct coap_linkedlistnode
 {
     struct coap_linkedlistnode *next;
@@ -42,4 +44,11 @@ void coap_delete_list(coap_list_t *queue);
  */
 coap_list_t *coap_new_listnode(void *data, void (*delete_func)(void *));
 
+/**
+ * Creates a new list node with @p size bytes of zeroed storage for its data,
+ * allocated together with the node in a single block. coap_delete() releases
+ * both. Returns the new list node.
+ */
+coap_list_t *coap_new_listnode_data(size_t size);
+
 #endif /* _COAP_LIST_H_ */
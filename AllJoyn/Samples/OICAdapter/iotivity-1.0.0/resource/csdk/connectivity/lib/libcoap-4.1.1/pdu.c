@@ -30,6 +30,8 @@
 
 #ifdef WIN32
 #include <WinSock2.h>
+#elif defined(WITH_POSIX)
+#include <pthread.h>
 #endif
 
 #ifdef WITH_CONTIKI
@@ -50,6 +52,109 @@ coap_pdu_resources_init()
 #include "mem.h"
 #endif /* WITH_CONTIKI */
 
+#if defined(WITH_POSIX) || defined(WIN32)
+/*
+ * Freed PDUs are kept for reuse in classes by storage size, so that messages
+ * sized to their content do not each go through malloc. PDUs larger than the
+ * biggest class are allocated and freed directly.
+ */
+#define COAP_PDU_POOL_DEPTH 8
+
+static const size_t coap_pdu_pool_sizes[] = { 64, 128, 256, 512, COAP_MAX_PDU_SIZE };
+
+#define COAP_PDU_POOL_CLASSES (sizeof(coap_pdu_pool_sizes) / sizeof(coap_pdu_pool_sizes[0]))
+
+static struct
+{
+    coap_pdu_t *free[COAP_PDU_POOL_DEPTH];
+    unsigned int count;
+} coap_pdu_pool[COAP_PDU_POOL_CLASSES];
+
+#ifdef WIN32
+static SRWLOCK coap_pdu_pool_lock = SRWLOCK_INIT;
+#define COAP_PDU_POOL_LOCK() AcquireSRWLockExclusive(&coap_pdu_pool_lock)
+#define COAP_PDU_POOL_UNLOCK() ReleaseSRWLockExclusive(&coap_pdu_pool_lock)
+#else
+static pthread_mutex_t coap_pdu_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+#define COAP_PDU_POOL_LOCK() pthread_mutex_lock(&coap_pdu_pool_lock)
+#define COAP_PDU_POOL_UNLOCK() pthread_mutex_unlock(&coap_pdu_pool_lock)
+#endif
+
+static int coap_pdu_pool_class(size_t size)
+{
+    for (size_t i = 0; i < COAP_PDU_POOL_CLASSES; i++)
+    {
+        if (size <= coap_pdu_pool_sizes[i])
+        {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+static coap_pdu_t *coap_pdu_pool_alloc(size_t size)
+{
+    int sizeClass = coap_pdu_pool_class(size);
+    if (sizeClass < 0)
+    {
+        return (coap_pdu_t *) coap_malloc(sizeof(coap_pdu_t) + size);
+    }
+
+    coap_pdu_t *pdu = NULL;
+    COAP_PDU_POOL_LOCK();
+    if (coap_pdu_pool[sizeClass].count)
+    {
+        pdu = coap_pdu_pool[sizeClass].free[--coap_pdu_pool[sizeClass].count];
+    }
+    COAP_PDU_POOL_UNLOCK();
+
+    if (!pdu)
+    {
+        pdu = (coap_pdu_t *) coap_malloc(sizeof(coap_pdu_t) + coap_pdu_pool_sizes[sizeClass]);
+    }
+    return pdu;
+}
+
+/* the class is found again from max_size, which coap_pdu_init() set */
+static void coap_pdu_pool_free(coap_pdu_t *pdu)
+{
+    if (!pdu)
+    {
+        return;
+    }
+
+    int sizeClass = coap_pdu_pool_class(pdu->max_size);
+    if (sizeClass >= 0)
+    {
+        COAP_PDU_POOL_LOCK();
+        if (coap_pdu_pool[sizeClass].count < COAP_PDU_POOL_DEPTH)
+        {
+            coap_pdu_pool[sizeClass].free[coap_pdu_pool[sizeClass].count++] = pdu;
+            pdu = NULL;
+        }
+        COAP_PDU_POOL_UNLOCK();
+    }
+    coap_free(pdu);
+}
+
+void coap_pdu_pool_release()
+{
+    COAP_PDU_POOL_LOCK();
+    for (size_t i = 0; i < COAP_PDU_POOL_CLASSES; i++)
+    {
+        while (coap_pdu_pool[i].count)
+        {
+            coap_free(coap_pdu_pool[i].free[--coap_pdu_pool[i].count]);
+        }
+    }
+    COAP_PDU_POOL_UNLOCK();
+}
+#else
+void coap_pdu_pool_release()
+{
+}
+#endif /* WITH_POSIX || WIN32 */
+
 void coap_pdu_clear(coap_pdu_t *pdu, size_t size, coap_transport_type transport, unsigned int length)
 {
     assert(pdu);
@@ -140,7 +245,10 @@ coap_pdu_init(unsigned char type, unsigned char code, unsigned short id,
 #endif
 
     /* size must be large enough for hdr */
-#if defined(WITH_POSIX) || defined(WITH_ARDUINO) || defined(WIN32)
+#if defined(WITH_POSIX) || defined(WIN32)
+    pdu = coap_pdu_pool_alloc(size);
+#endif
+#ifdef WITH_ARDUINO
     pdu = (coap_pdu_t *) coap_malloc(sizeof(coap_pdu_t) + size);
 #endif
 #ifdef WITH_CONTIKI
@@ -234,7 +342,10 @@ coap_new_pdu(coap_transport_type transport, unsigned int size)
 
 void coap_delete_pdu(coap_pdu_t *pdu)
 {
-#if defined(WITH_POSIX) || defined(WITH_ARDUINO) || defined(WIN32)
+#if defined(WITH_POSIX) || defined(WIN32)
+    coap_pdu_pool_free(pdu);
+#endif
+#ifdef WITH_ARDUINO
     coap_free( pdu );
 #endif
 #ifdef WITH_LWIP
@@ -379,6 +379,11 @@ coap_pdu_t *coap_new_pdu(coap_transport_type transport, unsigned int size);
 
 void coap_delete_pdu(coap_pdu_t *);
 
+/**
+ * Frees the PDUs that coap_delete_pdu() keeps for reuse.
+ */
+void coap_pdu_pool_release();
+
 /**
  * Parses @p data into the CoAP PDU structure given in @p result. This
  * function returns @c 0 on error or a number greater than zero on
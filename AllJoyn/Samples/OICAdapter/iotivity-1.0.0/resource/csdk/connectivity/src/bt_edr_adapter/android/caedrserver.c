@@ -544,7 +544,8 @@ void CAEDRServerStartAcceptThread()
     }
 
     ctx->stopFlag = &g_stopAccept;
-    if (CA_STATUS_OK != ca_thread_pool_add_task(g_threadPoolHandle, CAAcceptHandler, (void *) ctx))
+    if (CA_STATUS_OK != ca_thread_pool_add_long_running_task(g_threadPoolHandle, CAAcceptHandler,
+                                                             (void *) ctx))
     {
         OIC_LOG(ERROR, TAG, "Failed to create read thread!");
         OICFree((void *) ctx);
@@ -616,7 +617,8 @@ CAResult_t CAEDRStartUnicastServer(bool isSecured)
 
     ctx->stopFlag = &g_stopUnicast;
     ctx->type = isSecured ? CA_SECURED_UNICAST_SERVER : CA_UNICAST_SERVER;
-    if (CA_STATUS_OK != ca_thread_pool_add_task(g_threadPoolHandle, CAReceiveHandler, (void *) ctx))
+    if (CA_STATUS_OK != ca_thread_pool_add_long_running_task(g_threadPoolHandle, CAReceiveHandler,
+                                                             (void *) ctx))
     {
         OIC_LOG(ERROR, TAG, "Failed to create read thread!");
         ca_mutex_unlock(g_mutexUnicastServer);
@@ -656,7 +658,8 @@ CAResult_t CAEDRStartMulticastServer()
     ctx->type = CA_MULTICAST_SERVER;
 
     g_stopMulticast = false;
-    if (CA_STATUS_OK != ca_thread_pool_add_task(g_threadPoolHandle, CAReceiveHandler, (void *) ctx))
+    if (CA_STATUS_OK != ca_thread_pool_add_long_running_task(g_threadPoolHandle, CAReceiveHandler,
+                                                             (void *) ctx))
     {
         OIC_LOG(ERROR, TAG, "thread_pool_add_task failed!");
 
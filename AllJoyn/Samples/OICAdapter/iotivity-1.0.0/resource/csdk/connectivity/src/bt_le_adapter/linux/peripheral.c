@@ -600,9 +600,9 @@ CAResult_t CAPeripheralStart(CALEContext * context)
       Spawn a thread to run the Glib event loop that will drive D-Bus
       signal handling.
      */
-    result = ca_thread_pool_add_task(context->server_thread_pool,
-                                     CAPeripheralStartEventLoop,
-                                     context);
+    result = ca_thread_pool_add_long_running_task(context->server_thread_pool,
+                                                  CAPeripheralStartEventLoop,
+                                                  context);
 
     if (result != CA_STATUS_OK)
     {
@@ -672,8 +672,8 @@ CAResult_t CAStartLEGattClient()
         return CA_STATUS_FAILED;
     }
 
-    retVal = ca_thread_pool_add_task(g_bleClientThreadPool, CAStartBleGattClientThread,
-                                     NULL);
+    retVal = ca_thread_pool_add_long_running_task(g_bleClientThreadPool,
+                                                  CAStartBleGattClientThread, NULL);
     if (CA_STATUS_OK != retVal)
     {
         OIC_LOG(ERROR, TZ_BLE_CLIENT_TAG, "ca_thread_pool_add_task failed");
@@ -33,6 +33,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#ifndef WIN32
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
 
 #include "caadapterutils.h"
 #include "cainterface.h"
@@ -52,9 +58,200 @@
 
 #define BLOCK_SIZE(arg) (1 << ((arg) + 4))
 
+#define BLOCK_DATA_TABLE_INITIAL_SIZE   16
+
+// number of blocks the payload buffer is first allocated for
+// when the total payload length is not known
+#define BLOCK_PAYLOAD_INITIAL_BLOCKS    4
+
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { 0 };
 
+static uint64_t CAGetBlockDataTime()
+{
+#if defined(WIN32)
+    return GetTickCount64() * (uint64_t)1000;
+#elif defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * (uint64_t)1000000 + ts.tv_nsec / 1000;
+#else
+    return time(NULL) * (uint64_t)1000000;
+#endif
+}
+
+static uint32_t CAHashBlockId(const CABlockDataID_t *blockID)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < blockID->idLength; i++)
+    {
+        hash = (hash ^ blockID->id[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Destroys a block data set that is no longer in the table and releases its
+ * stream source. The caller doesn't hold blockDataListMutex, so that the
+ * release callback may send again.
+ */
+static void CADestroyBlockData(CABlockData_t *data)
+{
+    if (data->sentData)
+    {
+        CADestroyDataSet(data->sentData);
+    }
+    CADestroyBlockID(data->blockDataId);
+    OICFree(data->payload);
+    CAReleaseBlockStreamSource(&data->source);
+    OICFree(data);
+}
+
+/**
+ * Destroys block data sets chained by their next pointers.
+ */
+static void CADestroyBlockDataList(CABlockData_t *data)
+{
+    while (data)
+    {
+        CABlockData_t *next = data->next;
+        CADestroyBlockData(data);
+        data = next;
+    }
+}
+
+/**
+ * Takes a block data set that was unlinked from the table off the counts.
+ * The caller holds blockDataListMutex.
+ */
+static void CAUncountBlockData(const CABlockData_t *data)
+{
+    g_context.dataCount--;
+    if (data->source.readCallback)
+    {
+        g_context.streamCount--;
+    }
+}
+
+/**
+ * Finds the block data of a block ID and marks it as active.
+ * The caller holds blockDataListMutex.
+ */
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!g_context.dataTable || !blockID->id)
+    {
+        return NULL;
+    }
+
+    uint32_t hash = CAHashBlockId(blockID);
+    CABlockData_t *currData = g_context.dataTable[hash & (g_context.dataTableSize - 1)];
+    for (; currData; currData = currData->next)
+    {
+        if (currData->hash == hash && CABlockidMatches(currData, blockID))
+        {
+            currData->lastActivity = CAGetBlockDataTime();
+            return currData;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Finds the block data of the request sent with a message ID.
+ * The caller holds blockDataListMutex.
+ */
+static CABlockData_t *CAFindBlockDataByMessageId(uint16_t messageId, CATransportAdapter_t adapter)
+{
+    for (size_t i = 0; g_context.dataTable && i < g_context.dataTableSize; i++)
+    {
+        for (CABlockData_t *currData = g_context.dataTable[i]; currData; currData = currData->next)
+        {
+            if (NULL != currData->sentData && NULL != currData->sentData->requestInfo
+                && messageId == currData->sentData->requestInfo->info.messageId
+                && adapter == currData->sentData->remoteEndpoint->adapter)
+            {
+                return currData;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Doubles the number of buckets. The table keeps its size if that fails,
+ * which only makes the chains longer.
+ * The caller holds blockDataListMutex.
+ */
+static void CAGrowBlockDataTable()
+{
+    size_t newSize = g_context.dataTableSize * 2;
+    CABlockData_t **newTable = (CABlockData_t **) OICCalloc(newSize, sizeof(CABlockData_t *));
+    if (!newTable)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return;
+    }
+
+    for (size_t i = 0; i < g_context.dataTableSize; i++)
+    {
+        CABlockData_t *currData = g_context.dataTable[i];
+        while (currData)
+        {
+            CABlockData_t *next = currData->next;
+            CABlockData_t **bucket = &newTable[currData->hash & (newSize - 1)];
+            currData->next = *bucket;
+            *bucket = currData;
+            currData = next;
+        }
+    }
+
+    OICFree(g_context.dataTable);
+    g_context.dataTable = newTable;
+    g_context.dataTableSize = newSize;
+}
+
+/**
+ * Removes the block data sets idle for longer than idleTime and chains them to
+ * removedList, to be destroyed once blockDataListMutex is unlocked.
+ * The caller holds blockDataListMutex.
+ */
+static size_t CARemoveIdleBlockData(uint64_t now, uint64_t idleTime,
+                                    CABlockData_t **removedList)
+{
+    size_t removed = 0;
+    for (size_t i = 0; g_context.dataTable && i < g_context.dataTableSize; i++)
+    {
+        CABlockData_t **link = &g_context.dataTable[i];
+        while (*link)
+        {
+            CABlockData_t *currData = *link;
+            if (now - currData->lastActivity >= idleTime)
+            {
+                *link = currData->next;
+                CAUncountBlockData(currData);
+                currData->next = *removedList;
+                *removedList = currData;
+                removed++;
+            }
+            else
+            {
+                link = &currData->next;
+            }
+        }
+    }
+
+    if (removed)
+    {
+        OIC_LOG_V(INFO, TAG, "removed %u idle block data", (unsigned int) removed);
+    }
+    return removed;
+}
+
+static CAResult_t CASendBlockWiseDataImpl(const CAData_t *sendData,
+                                          const CABlockStreamSource_t *source);
+
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
     size_t payloadLen = 0;
@@ -88,9 +285,18 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.receivedThreadFunc = receivedThreadFunc;
     }
 
-    if (!g_context.dataList)
+    if (!g_context.dataTable)
     {
-        g_context.dataList = u_arraylist_create();
+        g_context.dataTable = (CABlockData_t **) OICCalloc(BLOCK_DATA_TABLE_INITIAL_SIZE,
+                                                           sizeof(CABlockData_t *));
+        if (!g_context.dataTable)
+        {
+            OIC_LOG(ERROR, TAG, "out of memory");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        g_context.dataTableSize = BLOCK_DATA_TABLE_INITIAL_SIZE;
+        g_context.dataCount = 0;
+        g_context.lastSweepTime = CAGetBlockDataTime();
     }
 
     CAResult_t res = CAInitBlockWiseMutexVariables();
@@ -106,11 +312,25 @@ CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "terminate");
 
-    if (g_context.dataList)
+    if (g_context.dataTable)
     {
-        u_arraylist_free(&g_context.dataList);
+        for (size_t i = 0; i < g_context.dataTableSize; i++)
+        {
+            CADestroyBlockDataList(g_context.dataTable[i]);
+        }
+        OICFree(g_context.dataTable);
+        g_context.dataTable = NULL;
+        g_context.dataTableSize = 0;
+        g_context.dataCount = 0;
+        g_context.streamCount = 0;
     }
 
+    // the queues these hand data to go with the message handler
+    ca_mutex_lock(g_context.blockDataSenderMutex);
+    g_context.sendThreadFunc = NULL;
+    g_context.receivedThreadFunc = NULL;
+    ca_mutex_unlock(g_context.blockDataSenderMutex);
+
     CATerminateBlockWiseMutexVariables();
 
     return CA_STATUS_OK;
@@ -158,6 +378,110 @@ void CATerminateBlockWiseMutexVariables()
 }
 
 CAResult_t CASendBlockWiseData(const CAData_t *sendData)
+{
+    return CASendBlockWiseDataImpl(sendData, NULL);
+}
+
+void CAReleaseBlockStreamSource(const CABlockStreamSource_t *source)
+{
+    if (source && source->releaseCallback)
+    {
+        source->releaseCallback(source->context);
+    }
+}
+
+CAResult_t CASendBlockWiseStream(CAData_t *sendData, const CABlockStreamSource_t *source)
+{
+    VERIFY_NON_NULL(source, TAG, "source");
+    if (!sendData || !source->readCallback)
+    {
+        OIC_LOG(ERROR, TAG, "sendData or read callback is null");
+        CAReleaseBlockStreamSource(source);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    CAInfo_t *info = NULL;
+    if (sendData->requestInfo)
+    {
+        info = &sendData->requestInfo->info;
+    }
+    else if (sendData->responseInfo)
+    {
+        info = &sendData->responseInfo->info;
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "no CAInfo data");
+        CAReleaseBlockStreamSource(source);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (source->length > BLOCK_SIZE(CA_DEFAULT_BLOCK_SIZE))
+    {
+        return CASendBlockWiseDataImpl(sendData, source);
+    }
+
+    // a payload that fits in one block is sent as it is
+    OIC_LOG(DEBUG, TAG, "read the payload at once");
+    CAPayload_t payload = NULL;
+    if (source->length)
+    {
+        payload = (CAPayload_t) OICMalloc(source->length);
+        if (!payload)
+        {
+            OIC_LOG(ERROR, TAG, "out of memory");
+            CAReleaseBlockStreamSource(source);
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+
+        CAResult_t res = source->readCallback(source->context, 0, payload, source->length);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "read has failed");
+            OICFree(payload);
+            CAReleaseBlockStreamSource(source);
+            return res;
+        }
+    }
+    CAReleaseBlockStreamSource(source);
+    OICFree(info->payload);
+    info->payload = payload;
+    info->payloadSize = source->length;
+
+    return CASendBlockWiseDataImpl(sendData, NULL);
+}
+
+void CASetBlockWriteCallback(CABlockWriteCallback writeCallback, void *context)
+{
+    ca_mutex_lock(g_context.blockDataListMutex);
+    g_context.writeCallback = writeCallback;
+    g_context.writeContext = context;
+    ca_mutex_unlock(g_context.blockDataListMutex);
+}
+
+size_t CAGetBlockStreamLength(const CAToken_t token, uint8_t tokenLength, uint16_t port)
+{
+    size_t length = 0;
+    ca_mutex_lock(g_context.blockDataListMutex);
+    if (g_context.streamCount)
+    {
+        CABlockDataID_t *blockID = CACreateBlockDatablockId(token, tokenLength, port);
+        if (blockID)
+        {
+            CABlockData_t *currData = CAFindBlockData(blockID);
+            if (currData && currData->source.readCallback)
+            {
+                length = currData->source.length;
+            }
+            CADestroyBlockID(blockID);
+        }
+    }
+    ca_mutex_unlock(g_context.blockDataListMutex);
+    return length;
+}
+
+static CAResult_t CASendBlockWiseDataImpl(const CAData_t *sendData,
+                                          const CABlockStreamSource_t *source)
 {
     VERIFY_NON_NULL(sendData, TAG, "sendData");
 
@@ -167,6 +491,7 @@ CAResult_t CASendBlockWiseData(const CAData_t *sendData)
         if (CA_MSG_RESET == sendData->responseInfo->info.type)
         {
             OIC_LOG(DEBUG, TAG, "reset message can't be sent to the block");
+            CAReleaseBlockStreamSource(source);
             return CA_NOT_SUPPORTED;
         }
     }
@@ -181,7 +506,7 @@ CAResult_t CASendBlockWiseData(const CAData_t *sendData)
         {
             OIC_LOG(DEBUG, TAG, "There is no block data");
 
-            bool isBlock = CACheckPayloadLength(sendData);
+            bool isBlock = source || CACheckPayloadLength(sendData);
             if (!isBlock)
             {
                 if (sendData->requestInfo)
@@ -199,11 +524,32 @@ CAResult_t CASendBlockWiseData(const CAData_t *sendData)
             if (!currData)
             {
                 OIC_LOG(ERROR, TAG, "failed to create block data");
+                CAReleaseBlockStreamSource(source);
                 return CA_MEMORY_ALLOC_FAILED;
             }
         }
     }
 
+    // a streamed payload is read when its blocks are sent
+    CABlockStreamSource_t replaced;
+    ca_mutex_lock(g_context.blockDataListMutex);
+    replaced = currData->source;
+    if (currData->source.readCallback)
+    {
+        g_context.streamCount--;
+    }
+    if (source)
+    {
+        currData->source = *source;
+        g_context.streamCount++;
+    }
+    else
+    {
+        memset(&currData->source, 0, sizeof(currData->source));
+    }
+    ca_mutex_unlock(g_context.blockDataListMutex);
+    CAReleaseBlockStreamSource(&replaced);
+
     // #3. check request/response block option type and payload length
     res = CACheckBlockOptionType(currData);
     if (CA_STATUS_OK == res)
@@ -253,7 +599,7 @@ CAResult_t CACheckBlockOptionType(CABlockData_t *currData)
     VERIFY_NON_NULL(currData, TAG, "currData");
     VERIFY_NON_NULL(currData->sentData, TAG, "currData->sentData");
 
-    bool isBlock = CACheckPayloadLength(currData->sentData);
+    bool isBlock = currData->source.readCallback || CACheckPayloadLength(currData->sentData);
     if (!isBlock)
     {
         return CA_NOT_SUPPORTED;
@@ -716,6 +1062,7 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
         data->payload = NULL;
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
+        data->payloadCapacity = 0;
         data->block1.num = 0;
         data->block2.num = 0;
     }
@@ -737,20 +1084,29 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID,
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // update payload
-    size_t fullPayloadLen = 0;
-    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID,
-                                                            &fullPayloadLen);
-    if (fullPayload)
+    // update payload; the reassembled payload is handed over without a copy,
+    // a streamed one has been passed to the application already
+    CAInfo_t *info = NULL;
+    if (CA_REQUEST_DATA == cloneData->dataType && cloneData->requestInfo)
     {
-        CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
-        if (CA_STATUS_OK != res)
-        {
-            OIC_LOG(ERROR, TAG, "update has failed");
-            CADestroyDataSet(cloneData);
-            return res;
-        }
+        info = &cloneData->requestInfo->info;
     }
+    else if (CA_RESPONSE_DATA == cloneData->dataType && cloneData->responseInfo)
+    {
+        info = &cloneData->responseInfo->info;
+    }
+
+    ca_mutex_lock(g_context.blockDataListMutex);
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData && info && (currData->payload || currData->streamed))
+    {
+        OICFree(info->payload);
+        info->payload = currData->payload;
+        info->payloadSize = currData->payload ? currData->receivedPayloadLen : 0;
+        currData->payload = NULL;
+        currData->payloadCapacity = 0;
+    }
+    ca_mutex_unlock(g_context.blockDataListMutex);
 
     if (g_context.receivedThreadFunc)
     {
@@ -1425,6 +1781,13 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
         goto exit;
     }
 
+    // a streamed payload is not in info
+    CABlockData_t *blockData = CAGetBlockDataFromBlockDataList(blockDataID);
+    if (blockData && blockData->source.readCallback)
+    {
+        dataLength = blockData->source.length;
+    }
+
     uint8_t blockType = CAGetBlockOptionType(blockDataID);
     if (COAP_OPTION_BLOCK2 == blockType)
     {
@@ -1496,6 +1859,43 @@ exit:
     return res;
 }
 
+/**
+ * Adds the part of the payload that a block carries, read from the stream
+ * source if the payload is streamed.
+ */
+static bool CAAddBlockPayload(coap_pdu_t *pdu, const CAInfo_t *info, size_t dataLength,
+                              const CABlockDataID_t *blockID, const coap_block_t *block)
+{
+    CABlockData_t *data = CAGetBlockDataFromBlockDataList(blockID);
+    if (!data || !data->source.readCallback)
+    {
+        return coap_add_block(pdu, dataLength, (const unsigned char *) info->payload,
+                              block->num, block->szx);
+    }
+
+    size_t start = (size_t) block->num << (block->szx + 4);
+    if (dataLength <= start || block->szx > CA_BLOCK_SIZE_1024_BYTE)
+    {
+        return false;
+    }
+
+    size_t length = dataLength - start;
+    if (length > (size_t) BLOCK_SIZE(block->szx))
+    {
+        length = BLOCK_SIZE(block->szx);
+    }
+
+    uint8_t buffer[BLOCK_SIZE(CA_BLOCK_SIZE_1024_BYTE)];
+    CAResult_t res = data->source.readCallback(data->source.context, start, buffer, length);
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG_V(ERROR, TAG, "read has failed: %d", res);
+        CARemoveBlockDataFromList(blockID);
+        return false;
+    }
+    return coap_add_data(pdu, length, buffer);
+}
+
 CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
                              const CABlockDataID_t *blockID, coap_list_t **options)
 {
@@ -1570,8 +1970,7 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
             block1->num = 0;
         }
 
-        if (!coap_add_block(*pdu, dataLength, (const unsigned char *) info->payload,
-                            block2->num, block2->szx))
+        if (!CAAddBlockPayload(*pdu, info, dataLength, blockID, block2))
         {
             OIC_LOG(ERROR, TAG, "Data length is smaller than the start index");
             return CA_STATUS_FAILED;
@@ -1703,8 +2102,7 @@ CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
         }
         CALogBlockInfo(block1);
 
-        if (!coap_add_block(*pdu, dataLength, (const unsigned char *) info->payload,
-                            block1->num, block1->szx))
+        if (!CAAddBlockPayload(*pdu, info, dataLength, blockID, block1))
         {
             OIC_LOG(ERROR, TAG, "Data length is smaller than the start index");
             return CA_STATUS_FAILED;
@@ -1952,6 +2350,55 @@ uint8_t CACheckBlockErrorType(CABlockData_t *currData, coap_block_t *receivedBlo
     return CA_BLOCK_UNKNOWN;
 }
 
+/**
+ * Passes a received block to the write callback if the payload is streamed.
+ * The first block of a payload decides whether it is streamed.
+ * @return ::CA_NOT_SUPPORTED if the payload is reassembled instead.
+ */
+static CAResult_t CAWriteBlockPayload(CABlockData_t *currData, const CAData_t *receivedData,
+                                      const uint8_t *block, size_t blockLength)
+{
+    if (!currData->streamed && (currData->receivedPayloadLen || currData->payload))
+    {
+        return CA_NOT_SUPPORTED;
+    }
+
+    const CAInfo_t *info = NULL;
+    if (receivedData->requestInfo)
+    {
+        info = &receivedData->requestInfo->info;
+    }
+    else if (receivedData->responseInfo)
+    {
+        info = &receivedData->responseInfo->info;
+    }
+
+    ca_mutex_lock(g_context.blockDataListMutex);
+    CABlockWriteCallback writeCallback = g_context.writeCallback;
+    void *writeContext = g_context.writeContext;
+    ca_mutex_unlock(g_context.blockDataListMutex);
+
+    if (!writeCallback || !info)
+    {
+        // the rest of a streamed payload has nowhere to go
+        return currData->streamed ? CA_STATUS_FAILED : CA_NOT_SUPPORTED;
+    }
+
+    CAResult_t res = writeCallback(writeContext, receivedData->remoteEndpoint,
+                                   info->token, info->tokenLength,
+                                   currData->receivedPayloadLen, block, blockLength);
+    if (CA_STATUS_OK == res)
+    {
+        currData->streamed = true;
+    }
+    else if (CA_NOT_SUPPORTED == res && currData->streamed)
+    {
+        // only the first block can decline the stream
+        res = CA_STATUS_FAILED;
+    }
+    return res;
+}
+
 CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *receivedData,
                                uint8_t status, bool isSizeOption, uint16_t blockType)
 {
@@ -1980,46 +2427,63 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
     size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        CAResult_t res = CAWriteBlockPayload(currData, receivedData, blockPayload,
+                                             blockPayloadLen);
+        if (CA_STATUS_OK == res)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
-            {
-                CAPayload_t prePayload = currData->payload;
+            currData->receivedPayloadLen += blockPayloadLen;
+            OIC_LOG_V(DEBUG, TAG, "streamed payload, len: %d", currData->receivedPayloadLen);
+            return CA_STATUS_OK;
+        }
+        else if (CA_NOT_SUPPORTED != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "write has failed: %d", res);
+            return res;
+        }
 
+        size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
+        if (totalPayloadLen > currData->payloadCapacity)
+        {
+            size_t capacity = 0;
+            if (isSizeOption && currData->payloadLength >= totalPayloadLen)
+            {
+                // in case the block message has the size option
+                // allocate the memory for the total payload
                 OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
+                capacity = currData->payloadLength;
+            }
+            else
+            {
+                // otherwise grow the buffer geometrically so that the
+                // received payload is not copied for every block
+                OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
+                capacity = currData->payloadCapacity ?
+                        currData->payloadCapacity : blockPayloadLen * BLOCK_PAYLOAD_INITIAL_BLOCKS;
+                if (0 == capacity)
                 {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
+                    // an empty block with nothing allocated yet, doubling
+                    // zero would never reach the received length
+                    capacity = totalPayloadLen;
+                }
+                while (capacity < totalPayloadLen)
+                {
+                    capacity *= 2;
                 }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
             }
 
-            // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
-        }
-        else
-        {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
-
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
+            CAPayload_t newPayload = OICRealloc(currData->payload, capacity);
             if (NULL == newPayload)
             {
                 OIC_LOG(ERROR, TAG, "out of memory");
                 return CA_MEMORY_ALLOC_FAILED;
             }
-
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
             currData->payload = newPayload;
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+            currData->payloadCapacity = capacity;
         }
 
+        // update the total payload
+        memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+
         // update received payload length
         currData->receivedPayloadLen += blockPayloadLen;
 
@@ -2209,17 +2673,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2234,16 +2694,12 @@ uint8_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return currData->type;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2257,15 +2713,11 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        return currData->sentData;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2282,40 +2734,26 @@ CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    // RST and empty ACK messages carry no token, so all block data are searched
+    CABlockData_t *currData = CAFindBlockDataByMessageId(pdu->hdr->coap_hdr_udp_t.id,
+                                                         endpoint->adapter);
+    if (currData && NULL != currData->sentData->requestInfo->info.token)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (NULL == currData)
+        uint8_t length = currData->sentData->requestInfo->info.tokenLength;
+        responseInfo->info.tokenLength = length;
+        responseInfo->info.token = (char *) OICMalloc(length);
+        if (NULL == responseInfo->info.token)
         {
-            continue;
+            OIC_LOG(ERROR, TAG, "out of memory");
+            ca_mutex_unlock(g_context.blockDataListMutex);
+            return CA_MEMORY_ALLOC_FAILED;
         }
+        memcpy(responseInfo->info.token, currData->sentData->requestInfo->info.token,
+               responseInfo->info.tokenLength);
 
-        if (NULL != currData->sentData && NULL != currData->sentData->requestInfo)
-        {
-            if (pdu->hdr->coap_hdr_udp_t.id == currData->sentData->requestInfo->info.messageId &&
-                    endpoint->adapter == currData->sentData->remoteEndpoint->adapter)
-            {
-                if (NULL != currData->sentData->requestInfo->info.token)
-                {
-                    uint8_t length = currData->sentData->requestInfo->info.tokenLength;
-                    responseInfo->info.tokenLength = length;
-                    responseInfo->info.token = (char *) OICMalloc(length);
-                    if (NULL == responseInfo->info.token)
-                    {
-                        OIC_LOG(ERROR, TAG, "out of memory");
-                        ca_mutex_unlock(g_context.blockDataListMutex);
-                        return CA_MEMORY_ALLOC_FAILED;
-                    }
-                    memcpy(responseInfo->info.token, currData->sentData->requestInfo->info.token,
-                           responseInfo->info.tokenLength);
-
-                    ca_mutex_unlock(g_context.blockDataListMutex);
-                    OIC_LOG(DEBUG, TAG, "OUT-CAGetTokenFromBlockDataList");
-                    return CA_STATUS_OK;
-                }
-            }
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-CAGetTokenFromBlockDataList");
+        return CA_STATUS_OK;
     }
 
     ca_mutex_unlock(g_context.blockDataListMutex);
@@ -2329,93 +2767,65 @@ CAResult_t CACheckBlockDataValidation(const CAData_t *sendData, CABlockData_t **
     VERIFY_NON_NULL(sendData, TAG, "sendData");
     VERIFY_NON_NULL(blockData, TAG, "blockData");
 
-    ca_mutex_lock(g_context.blockDataListMutex);
-
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    const CAInfo_t *info = NULL;
+    if (sendData->requestInfo) // sendData is requestMessage
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
+        OIC_LOG(DEBUG, TAG, "Send request");
+        info = &sendData->requestInfo->info;
+    }
+    else if (sendData->responseInfo) // sendData is responseMessage
+    {
+        OIC_LOG(DEBUG, TAG, "Send response");
+        info = &sendData->responseInfo->info;
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "no CAInfo data");
+        return CA_STATUS_FAILED;
+    }
 
-        if (!currData)
-        {
-            continue;
-        }
+    if (NULL == info->token)
+    {
+        return CA_STATUS_FAILED;
+    }
 
-        if (sendData->requestInfo) // sendData is requestMessage
-        {
-            OIC_LOG(DEBUG, TAG, "Send request");
-            if (NULL != currData->blockDataId
-                    && NULL != currData->blockDataId->id
-                    && currData->blockDataId->idLength > 0
-                    && NULL != sendData->requestInfo->info.token)
-            {
-                CABlockDataID_t* blockDataID = CACreateBlockDatablockId(
-                        (CAToken_t)sendData->requestInfo->info.token,
-                        sendData->requestInfo->info.tokenLength,
-                        sendData->remoteEndpoint->port);
+    CABlockDataID_t* blockDataID = CACreateBlockDatablockId((CAToken_t)info->token,
+                                                            info->tokenLength,
+                                                            sendData->remoteEndpoint->port);
+    if (NULL == blockDataID || NULL == blockDataID->id || blockDataID->idLength < 1)
+    {
+        OIC_LOG(ERROR, TAG, "blockId is null");
+        CADestroyBlockID(blockDataID);
+        return CA_STATUS_FAILED;
+    }
 
-                if(NULL == blockDataID || NULL == blockDataID->id || blockDataID->idLength < 1)
-                {
-                    OIC_LOG(ERROR, TAG, "blockId is null");
-                    CADestroyBlockID(blockDataID);
-                    return CA_STATUS_FAILED;
-                }
+    ca_mutex_lock(g_context.blockDataListMutex);
 
-                if (CABlockidMatches(currData, blockDataID))
-                {
-                    OIC_LOG(ERROR, TAG, "already sent");
-                    CADestroyBlockID(blockDataID);
-                    continue;
-                }
-                CADestroyBlockID(blockDataID);
-            }
-        }
-        else if (sendData->responseInfo) // sendData is responseMessage
-        {
-            OIC_LOG(DEBUG, TAG, "Send response");
-            if (NULL != currData->blockDataId
-                    && NULL != currData->blockDataId->id
-                    && currData->blockDataId->idLength > 0
-                    && NULL != sendData->responseInfo->info.token)
-            {
-                CABlockDataID_t* blockDataID = CACreateBlockDatablockId(
-                        (CAToken_t)sendData->responseInfo->info.token,
-                        sendData->responseInfo->info.tokenLength,
-                        sendData->remoteEndpoint->port);
+    CABlockData_t *currData = CAFindBlockData(blockDataID);
+    CADestroyBlockID(blockDataID);
+    if (!currData)
+    {
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        return CA_STATUS_FAILED;
+    }
 
-                if(NULL == blockDataID || NULL == blockDataID->id || blockDataID->idLength < 1)
-                {
-                    OIC_LOG(ERROR, TAG, "blockId is null");
-                    CADestroyBlockID(blockDataID);
-                    return CA_STATUS_FAILED;
-                }
+    if (sendData->requestInfo)
+    {
+        OIC_LOG(ERROR, TAG, "already sent");
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        return CA_STATUS_FAILED;
+    }
 
-                if (CABlockidMatches(currData, blockDataID))
-                {
-                    // set sendData
-                    if (NULL != currData->sentData)
-                    {
-                        OIC_LOG(DEBUG, TAG, "init block number");
-                        CADestroyDataSet(currData->sentData);
-                    }
-                    currData->sentData = CACloneCAData(sendData);
-                    *blockData = currData;
-                    CADestroyBlockID(blockDataID);
-                    ca_mutex_unlock(g_context.blockDataListMutex);
-                    return CA_STATUS_OK;
-                }
-                CADestroyBlockID(blockDataID);
-            }
-        }
-        else
-        {
-            OIC_LOG(ERROR, TAG, "no CAInfo data");
-            continue;
-        }
+    // set sendData
+    if (NULL != currData->sentData)
+    {
+        OIC_LOG(DEBUG, TAG, "init block number");
+        CADestroyDataSet(currData->sentData);
     }
+    currData->sentData = CACloneCAData(sendData);
+    *blockData = currData;
     ca_mutex_unlock(g_context.blockDataListMutex);
-
-    return CA_STATUS_FAILED;
+    return CA_STATUS_OK;
 }
 
 CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
@@ -2423,20 +2833,10 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
     VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
 
     ca_mutex_lock(g_context.blockDataListMutex);
-
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     ca_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
@@ -2447,22 +2847,18 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else
-            {
-                return &currData->block1;
-            }
+            return &currData->block2;
+        }
+        else
+        {
+            return &currData->block1;
         }
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
@@ -2480,17 +2876,13 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        *fullPayloadLen = currData->receivedPayloadLen;
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return currData->payload;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2547,21 +2939,40 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
         return NULL;
     }
     data->blockDataId = blockDataID;
+    data->hash = CAHashBlockId(blockDataID);
+    data->lastActivity = CAGetBlockDataTime();
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    bool res = u_arraylist_add(g_context.dataList, (void *) data);
-    if (!res)
+    if (!g_context.dataTable)
     {
         OIC_LOG(ERROR, TAG, "add has failed");
-        CADestroyBlockID(data->blockDataId);
-        CADestroyDataSet(data->sentData);
-        OICFree(data);
         ca_mutex_unlock(g_context.blockDataListMutex);
+        CADestroyBlockData(data);
         return NULL;
     }
+
+    // peers that stop in the middle of a transfer leave their block data behind
+    CABlockData_t *removedList = NULL;
+    if (data->lastActivity - g_context.lastSweepTime >= CA_BLOCK_DATA_SWEEP_INTERVAL)
+    {
+        g_context.lastSweepTime = data->lastActivity;
+        CARemoveIdleBlockData(data->lastActivity, CA_BLOCK_DATA_IDLE_TIMEOUT, &removedList);
+    }
+
+    if (g_context.dataCount >= g_context.dataTableSize)
+    {
+        CAGrowBlockDataTable();
+    }
+
+    CABlockData_t **bucket = &g_context.dataTable[data->hash & (g_context.dataTableSize - 1)];
+    data->next = *bucket;
+    *bucket = data;
+    g_context.dataCount++;
     ca_mutex_unlock(g_context.blockDataListMutex);
 
+    CADestroyBlockDataList(removedList);
+
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
     return data;
 }
@@ -2571,32 +2982,27 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
     OIC_LOG(DEBUG, TAG, "CARemoveBlockData");
     VERIFY_NON_NULL(blockID, TAG, "blockID");
 
+    VERIFY_NON_NULL(blockID->id, TAG, "blockID->id");
+
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    if (g_context.dataTable)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        uint32_t hash = CAHashBlockId(blockID);
+        CABlockData_t **link = &g_context.dataTable[hash & (g_context.dataTableSize - 1)];
+        for (; *link; link = &(*link)->next)
         {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
+            CABlockData_t *currData = *link;
+            if (currData->hash == hash && CABlockidMatches(currData, blockID))
             {
-                OIC_LOG(ERROR, TAG, "data is NULL");
+                *link = currData->next;
+                CAUncountBlockData(currData);
                 ca_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
 
-            // destroy memory
-            if (currData->sentData)
-            {
-                CADestroyDataSet(currData->sentData);
+                // destroy memory
+                CADestroyBlockData(currData);
+                return CA_STATUS_OK;
             }
-            CADestroyBlockID(currData->blockDataId);
-            OICFree(currData->payload);
-            OICFree(currData);
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
         }
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
@@ -2611,16 +3017,12 @@ bool CAIsBlockDataInList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            OIC_LOG(DEBUG, TAG, "found block data");
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return true;
-        }
+        OIC_LOG(DEBUG, TAG, "found block data");
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        return true;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2628,6 +3030,18 @@ bool CAIsBlockDataInList(const CABlockDataID_t *blockID)
     return false;
 }
 
+size_t CARemoveIdleBlockDataFromList(uint64_t idleTime)
+{
+    CABlockData_t *removedList = NULL;
+    ca_mutex_lock(g_context.blockDataListMutex);
+    size_t removed = CARemoveIdleBlockData(CAGetBlockDataTime(), idleTime, &removedList);
+    ca_mutex_unlock(g_context.blockDataListMutex);
+
+    CADestroyBlockDataList(removedList);
+
+    return removed;
+}
+
 void CADestroyDataSet(CAData_t* data)
 {
     VERIFY_NON_NULL_VOID(data, TAG, "data");
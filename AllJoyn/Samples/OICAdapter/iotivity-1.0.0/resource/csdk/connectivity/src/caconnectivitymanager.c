@@ -29,6 +29,9 @@
 #include "caprotocolmessage.h"
 #include "canetworkconfigurator.h"
 #include "cainterfacecontroller.h"
+#ifdef WITH_BWT
+#include "cablockwisetransfer.h"
+#endif
 #include "logger.h"
 #ifdef __WITH_DTLS__
 #include "caadapternetdtls.h"
@@ -260,6 +263,43 @@ CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *re
     return CADetachResponseMessage(object, responseInfo);
 }
 
+#ifdef WITH_BWT
+CAResult_t CASendRequestStream(const CAEndpoint_t *object, const CARequestInfo_t *requestInfo,
+                               const CABlockStreamSource_t *source)
+{
+    OIC_LOG(DEBUG, TAG, "CASendRequestStream");
+
+    if(!g_isInitialized)
+    {
+        CAReleaseBlockStreamSource(source);
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CADetachStreamMessage(object, requestInfo, CA_REQUEST_DATA, source);
+}
+
+CAResult_t CASendResponseStream(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo,
+                                const CABlockStreamSource_t *source)
+{
+    OIC_LOG(DEBUG, TAG, "CASendResponseStream");
+
+    if(!g_isInitialized)
+    {
+        CAReleaseBlockStreamSource(source);
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CADetachStreamMessage(object, responseInfo, CA_RESPONSE_DATA, source);
+}
+
+void CASetBlockStreamHandler(CABlockWriteCallback writeCallback, void *context)
+{
+    OIC_LOG(DEBUG, TAG, "CASetBlockStreamHandler");
+
+    CASetBlockWriteCallback(writeCallback, context);
+}
+#endif
+
 CAResult_t CASelectNetwork(CATransportAdapter_t interestedNetwork)
 {
     OIC_LOG_V(DEBUG, TAG, "Selected network : %d", interestedNetwork);
@@ -377,6 +417,17 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CAWaitForRequestResponse(uint32_t timeoutMs)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CAWaitForRequestResponseCallbacks(timeoutMs) ? CA_STATUS_OK : CA_REQUEST_TIMEOUT;
+}
+
 #ifdef __WITH_DTLS__
 
 CAResult_t CASelectCipherSuite(const uint16_t cipher)
@@ -91,6 +91,14 @@ void CAAddDataToSendThread(CAData_t *data)
 {
     VERIFY_NON_NULL_VOID(data, TAG, "data");
 
+    // the queue is gone once the message handler has been terminated
+    if (NULL == g_sendThread.threadMutex)
+    {
+        OIC_LOG(ERROR, TAG, "send thread is not running");
+        CADestroyData(data, sizeof(CAData_t));
+        return;
+    }
+
     // add thread
     CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
 }
@@ -99,6 +107,13 @@ void CAAddDataToReceiveThread(CAData_t *data)
 {
     VERIFY_NON_NULL_VOID(data, TAG, "data");
 
+    if (NULL == g_receiveThread.threadMutex)
+    {
+        OIC_LOG(ERROR, TAG, "receive thread is not running");
+        CADestroyData(data, sizeof(CAData_t));
+        return;
+    }
+
     // add thread
     CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
 }
@@ -879,6 +894,36 @@ void CAHandleRequestResponseCallbacks()
 #endif
 }
 
+bool CAWaitForRequestResponseCallbacks(uint32_t timeoutMs)
+{
+#ifdef SINGLE_THREAD
+    // data is read from the adapters by CAHandleRequestResponseCallbacks itself.
+    (void)timeoutMs;
+    return true;
+#else
+    if (NULL == g_receiveThread.threadMutex)
+    {
+        return false;
+    }
+
+    // the receive queue is signalled by CAQueueingThreadAddData, and nobody else
+    // waits on it while the receive thread is not started (SINGLE_HANDLE).
+    ca_mutex_lock(g_receiveThread.threadMutex);
+
+    if (0 == u_queue_get_size(g_receiveThread.dataQueue) && 0 < timeoutMs)
+    {
+        ca_cond_wait_for(g_receiveThread.threadCond, g_receiveThread.threadMutex,
+                         (uint64_t)timeoutMs * 1000);
+    }
+
+    bool pending = (0 < u_queue_get_size(g_receiveThread.dataQueue));
+
+    ca_mutex_unlock(g_receiveThread.threadMutex);
+
+    return pending;
+#endif
+}
+
 static CAData_t* CAPrepareSendData(const CAEndpoint_t *endpoint, const void *sendData,
                                    CADataType_t dataType)
 {
@@ -1067,6 +1112,72 @@ CAResult_t CADetachResponseMessage(const CAEndpoint_t *object,
     return CA_STATUS_OK;
 }
 
+#ifdef WITH_BWT
+CAResult_t CADetachStreamMessage(const CAEndpoint_t *object, const void *sendData,
+                                 CADataType_t dataType, const CABlockStreamSource_t *source)
+{
+    VERIFY_NON_NULL(source, TAG, "source");
+    if (!object || !sendData)
+    {
+        OIC_LOG(ERROR, TAG, "object or sendData is null");
+        CAReleaseBlockStreamSource(source);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+#ifdef SINGLE_THREAD
+    OIC_LOG(ERROR, TAG, "streaming needs the send thread");
+    CAReleaseBlockStreamSource(source);
+    return CA_NOT_SUPPORTED;
+#else
+    if (false == CAIsSelectedNetworkAvailable())
+    {
+        CAReleaseBlockStreamSource(source);
+        return CA_STATUS_FAILED;
+    }
+
+    // only the adapters that use block-wise transfer can stream a payload
+    if (CA_ADAPTER_GATT_BTLE == object->adapter
+#ifdef TCP_ADAPTER
+            || CA_ADAPTER_TCP == object->adapter
+#endif
+            )
+    {
+        OIC_LOG(ERROR, TAG, "no block-wise transfer for the adapter");
+        CAReleaseBlockStreamSource(source);
+        return CA_NOT_SUPPORTED;
+    }
+
+    CAData_t *data = CAPrepareSendData(object, sendData, dataType);
+    if(!data)
+    {
+        OIC_LOG(ERROR, TAG, "CAPrepareSendData failed");
+        CAReleaseBlockStreamSource(source);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    if (SEND_TYPE_MULTICAST == data->type)
+    {
+        OIC_LOG(ERROR, TAG, "multicast payload can't be streamed");
+        CADestroyData(data, sizeof(CAData_t));
+        CAReleaseBlockStreamSource(source);
+        return CA_NOT_SUPPORTED;
+    }
+
+    // the source is released by the block-wise transfer from here
+    CAResult_t res = CASendBlockWiseStream(data, source);
+    if (CA_NOT_SUPPORTED == res)
+    {
+        OIC_LOG(DEBUG, TAG, "normal msg will be sent");
+        CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
+        return CA_STATUS_OK;
+    }
+
+    CADestroyData(data, sizeof(CAData_t));
+    return res;
+#endif
+}
+#endif
+
 CAResult_t CADetachMessageResourceUri(const CAURI_t resourceUri, const CAToken_t token,
                                       uint8_t tokenLength, const CAHeaderOption_t *options,
                                       uint8_t numOptions)
@@ -1091,6 +1202,12 @@ CAResult_t CAInitializeMessageHandler()
 {
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
 
+    if (CA_STATUS_OK != CAInitializePDUTemplates())
+    {
+        OIC_LOG(ERROR, TAG, "PDU templates initialize error.");
+        return CA_STATUS_FAILED;
+    }
+
     CASetNetworkChangeCallback(CANetworkChangedCallback);
     CASetErrorHandleCallback(CAErrorHandler);
 
@@ -1239,6 +1356,8 @@ void CATerminateMessageHandler()
     CARetransmissionStop(&g_retransmissionContext);
     CARetransmissionDestroy(&g_retransmissionContext);
 #endif
+
+    CATerminatePDUTemplates();
 }
 
 void CALogPDUInfo(coap_pdu_t *pdu, const CAEndpoint_t *endpoint)
@@ -38,9 +38,15 @@
 #endif
 
 #include "caprotocolmessage.h"
+#include "camutex.h"
 #include "logger.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#ifdef WITH_BWT
+#include "cainterface.h"
+#include "camessagehandler.h"
+#include "cablockwisetransfer.h"
+#endif
 
 // ARM GCC compiler doesnt define srandom function.
 #if defined(ARDUINO) && !defined(ARDUINO_ARCH_SAM)
@@ -63,10 +69,60 @@
 #define CA_PDU_MIN_SIZE (4)
 #define CA_PORT_BUFFER_SIZE (4)
 
+/**
+ * Number of PDU templates kept, each holding the options generated for a
+ * combination of URI, header options and formats sent before.
+ */
+#define CA_PDU_TEMPLATE_COUNT (16)
+
+/** Longest template key, messages with a longer one are not cached. */
+#define CA_PDU_TEMPLATE_KEY_SIZE (1024)
+
+/** Option header with extended delta and length, the worst case. */
+#define CA_OPTION_HEADER_MAX_SIZE (5)
+
+/** Room for the Block1/Block2 and Size1/Size2 options block-wise transfer adds. */
+#define CA_BLOCK_OPTIONS_SIZE (2 * (CA_OPTION_HEADER_MAX_SIZE + 3) + \
+                               2 * (CA_OPTION_HEADER_MAX_SIZE + 4))
+
+/** Smallest PDU allocated, room for the response phrase added on errors. */
+#define CA_PDU_MIN_ALLOC_SIZE (64)
+
 static const char COAP_URI_HEADER[] = "coap://[::]/";
 
 static unsigned int SEED = 0;
 
+/**
+ * Options generated for a key, both as the sorted option records the option
+ * list is cloned from and encoded the way coap_add_option writes them.
+ * Templates are immutable; an evicted template is freed by its last user.
+ */
+typedef struct
+{
+    uint32_t hash;
+    uint32_t lastUse;
+    uint32_t refCount;
+    bool evicted;
+    size_t keyLength;
+    uint8_t *key;
+    uint16_t optionCount;
+    size_t recordsLength;
+    uint8_t *records;           /**< per option: key, length (2 bytes each) and data */
+    size_t encodedLength;
+    uint8_t *encoded;
+    uint16_t lastOption;
+} CAPDUTemplate_t;
+
+static CAPDUTemplate_t *g_pduTemplates[CA_PDU_TEMPLATE_COUNT];
+static ca_mutex g_pduTemplateMutex = NULL;
+static uint32_t g_pduTemplateClock = 0;
+
+static coap_pdu_t *CAGeneratePDUWithTemplate(code_t code, const CAInfo_t *info,
+                                             const CAEndpoint_t *endpoint,
+                                             coap_list_t *options,
+                                             const CAPDUTemplate_t *pduTemplate,
+                                             coap_transport_type *transport);
+
 CAResult_t CAGetRequestInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                                    CARequestInfo_t *outReqInfo)
 {
@@ -114,6 +170,325 @@ CAResult_t CAGetErrorInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endp
     return ret;
 }
 
+CAResult_t CAInitializePDUTemplates()
+{
+    if (!g_pduTemplateMutex)
+    {
+        g_pduTemplateMutex = ca_mutex_new();
+        if (!g_pduTemplateMutex)
+        {
+            OIC_LOG(ERROR, TAG, "ca_mutex_new has failed");
+            return CA_STATUS_FAILED;
+        }
+    }
+    return CA_STATUS_OK;
+}
+
+void CATerminatePDUTemplates()
+{
+    if (g_pduTemplateMutex)
+    {
+        ca_mutex_lock(g_pduTemplateMutex);
+        for (size_t i = 0; i < CA_PDU_TEMPLATE_COUNT; i++)
+        {
+            // the PDUs are generated by the send and receive threads, stopped by now
+            OICFree(g_pduTemplates[i]);
+            g_pduTemplates[i] = NULL;
+        }
+        ca_mutex_unlock(g_pduTemplateMutex);
+        ca_mutex_free(g_pduTemplateMutex);
+        g_pduTemplateMutex = NULL;
+    }
+    coap_pdu_pool_release();
+}
+
+static size_t CAAppendTemplateKey(uint8_t *key, size_t keyLength, size_t keySize,
+                                  const void *data, size_t length)
+{
+    if (keyLength > keySize || length > keySize - keyLength)
+    {
+        // does not fit, the whole key is dropped
+        return keySize + 1;
+    }
+    memcpy(key + keyLength, data, length);
+    return keyLength + length;
+}
+
+/**
+ * Serializes what CAGeneratePDU derives the options from : the URI, the header
+ * options and the formats.
+ *
+ * @return the key length, or 0 if the key does not fit and the message is not
+ *         to be cached.
+ */
+static size_t CAGetPDUTemplateKey(const CAInfo_t *info, uint8_t *key, size_t keySize)
+{
+    size_t keyLength = 0;
+    uint8_t hasUri = (CA_MSG_ACKNOWLEDGE != info->type && info->resourceUri) ? 1 : 0;
+
+    keyLength = CAAppendTemplateKey(key, keyLength, keySize, &hasUri, sizeof(hasUri));
+    if (hasUri)
+    {
+        // with its '\0' so that the URI cannot run into the options
+        keyLength = CAAppendTemplateKey(key, keyLength, keySize, info->resourceUri,
+                                        strlen(info->resourceUri) + 1);
+    }
+    keyLength = CAAppendTemplateKey(key, keyLength, keySize, &info->numOptions,
+                                    sizeof(info->numOptions));
+    for (uint32_t i = 0; info->options && i < info->numOptions; i++)
+    {
+        const CAHeaderOption_t *option = info->options + i;
+        uint16_t length = option->optionLength;
+        if (length > sizeof(option->optionData))
+        {
+            return 0;
+        }
+        keyLength = CAAppendTemplateKey(key, keyLength, keySize, &option->optionID,
+                                        sizeof(option->optionID));
+        keyLength = CAAppendTemplateKey(key, keyLength, keySize, &length, sizeof(length));
+        keyLength = CAAppendTemplateKey(key, keyLength, keySize, option->optionData, length);
+    }
+    keyLength = CAAppendTemplateKey(key, keyLength, keySize, &info->payloadFormat,
+                                    sizeof(info->payloadFormat));
+    keyLength = CAAppendTemplateKey(key, keyLength, keySize, &info->acceptFormat,
+                                    sizeof(info->acceptFormat));
+
+    return keyLength <= keySize ? keyLength : 0;
+}
+
+static uint32_t CAHashTemplateKey(const uint8_t *key, size_t keyLength)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < keyLength; i++)
+    {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void CAReleasePDUTemplate(CAPDUTemplate_t *pduTemplate)
+{
+    if (!pduTemplate)
+    {
+        return;
+    }
+
+    ca_mutex_lock(g_pduTemplateMutex);
+    bool unused = (0 == --pduTemplate->refCount) && pduTemplate->evicted;
+    ca_mutex_unlock(g_pduTemplateMutex);
+
+    if (unused)
+    {
+        OICFree(pduTemplate);
+    }
+}
+
+/**
+ * Looks for the template of a key and holds it until CAReleasePDUTemplate.
+ */
+static CAPDUTemplate_t *CAFindPDUTemplate(const uint8_t *key, size_t keyLength, uint32_t hash)
+{
+    CAPDUTemplate_t *found = NULL;
+
+    ca_mutex_lock(g_pduTemplateMutex);
+    for (size_t i = 0; i < CA_PDU_TEMPLATE_COUNT; i++)
+    {
+        CAPDUTemplate_t *pduTemplate = g_pduTemplates[i];
+        if (pduTemplate && pduTemplate->hash == hash && pduTemplate->keyLength == keyLength
+            && 0 == memcmp(pduTemplate->key, key, keyLength))
+        {
+            pduTemplate->lastUse = ++g_pduTemplateClock;
+            pduTemplate->refCount++;
+            found = pduTemplate;
+            break;
+        }
+    }
+    ca_mutex_unlock(g_pduTemplateMutex);
+
+    return found;
+}
+
+/**
+ * Makes a template of the options generated for a key, and replaces the least
+ * recently used template with it.
+ */
+static void CAAddPDUTemplate(const uint8_t *key, size_t keyLength, uint32_t hash,
+                             const coap_list_t *options)
+{
+    size_t recordsLength = 0;
+    size_t encodedSize = 0;
+    uint16_t optionCount = 0;
+    for (const coap_list_t *opt = options; opt; opt = opt->next)
+    {
+        const coap_option *option = (const coap_option *) opt->data;
+        if (COAP_OPTION_LENGTH(*option) > UINT16_MAX)
+        {
+            return;
+        }
+        recordsLength += 2 * sizeof(uint16_t) + COAP_OPTION_LENGTH(*option);
+        encodedSize += CA_OPTION_HEADER_MAX_SIZE + COAP_OPTION_LENGTH(*option);
+        optionCount++;
+    }
+
+    // one block for the template, the key, the records and the encoded options
+    CAPDUTemplate_t *pduTemplate = (CAPDUTemplate_t *) OICCalloc(1,
+            sizeof(CAPDUTemplate_t) + keyLength + recordsLength + encodedSize);
+    if (!pduTemplate)
+    {
+        return;
+    }
+    pduTemplate->hash = hash;
+    pduTemplate->keyLength = keyLength;
+    pduTemplate->key = (uint8_t *) (pduTemplate + 1);
+    memcpy(pduTemplate->key, key, keyLength);
+    pduTemplate->optionCount = optionCount;
+    pduTemplate->recordsLength = recordsLength;
+    pduTemplate->records = pduTemplate->key + keyLength;
+    pduTemplate->encoded = pduTemplate->records + recordsLength;
+
+    uint8_t *record = pduTemplate->records;
+    unsigned short delta = 0;
+    for (const coap_list_t *opt = options; opt; opt = opt->next)
+    {
+        const coap_option *option = (const coap_option *) opt->data;
+        uint16_t optionKey = COAP_OPTION_KEY(*option);
+        uint16_t length = (uint16_t) COAP_OPTION_LENGTH(*option);
+        memcpy(record, &optionKey, sizeof(optionKey));
+        memcpy(record + sizeof(optionKey), &length, sizeof(length));
+        memcpy(record + 2 * sizeof(uint16_t), COAP_OPTION_DATA(*option), length);
+        record += 2 * sizeof(uint16_t) + length;
+
+        size_t optionSize = (optionKey < delta) ? 0 :
+                coap_opt_encode(pduTemplate->encoded + pduTemplate->encodedLength,
+                                encodedSize - pduTemplate->encodedLength,
+                                optionKey - delta, COAP_OPTION_DATA(*option), length);
+        if (!optionSize)
+        {
+            OICFree(pduTemplate);
+            return;
+        }
+        pduTemplate->encodedLength += optionSize;
+        delta = optionKey;
+    }
+    pduTemplate->lastOption = delta;
+
+    ca_mutex_lock(g_pduTemplateMutex);
+    size_t victim = 0;
+    for (size_t i = 0; i < CA_PDU_TEMPLATE_COUNT; i++)
+    {
+        if (!g_pduTemplates[i])
+        {
+            victim = i;
+            break;
+        }
+        if (g_pduTemplates[i]->hash == hash && g_pduTemplates[i]->keyLength == keyLength
+            && 0 == memcmp(g_pduTemplates[i]->key, key, keyLength))
+        {
+            // added by another thread meanwhile
+            ca_mutex_unlock(g_pduTemplateMutex);
+            OICFree(pduTemplate);
+            return;
+        }
+        if (g_pduTemplates[i]->lastUse < g_pduTemplates[victim]->lastUse)
+        {
+            victim = i;
+        }
+    }
+
+    CAPDUTemplate_t *evicted = g_pduTemplates[victim];
+    if (evicted)
+    {
+        evicted->evicted = true;
+        if (evicted->refCount)
+        {
+            // freed by CAReleasePDUTemplate
+            evicted = NULL;
+        }
+    }
+    pduTemplate->lastUse = ++g_pduTemplateClock;
+    g_pduTemplates[victim] = pduTemplate;
+    ca_mutex_unlock(g_pduTemplateMutex);
+
+    OICFree(evicted);
+}
+
+/**
+ * Creates the option list of a template, already sorted.
+ */
+static CAResult_t CACloneTemplateOptions(const CAPDUTemplate_t *pduTemplate,
+                                         coap_list_t **optlist)
+{
+    coap_list_t **tail = optlist;
+    while (*tail)
+    {
+        tail = &(*tail)->next;
+    }
+
+    const uint8_t *record = pduTemplate->records;
+    for (uint16_t i = 0; i < pduTemplate->optionCount; i++)
+    {
+        uint16_t optionKey = 0;
+        uint16_t length = 0;
+        memcpy(&optionKey, record, sizeof(optionKey));
+        memcpy(&length, record + sizeof(optionKey), sizeof(length));
+
+        coap_list_t *node = coap_new_listnode_data(sizeof(coap_option) + length + 1);
+        if (!node)
+        {
+            OIC_LOG(ERROR, TAG, "Out of memory");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        coap_option *option = (coap_option *) node->data;
+        COAP_OPTION_KEY(*option) = optionKey;
+        COAP_OPTION_LENGTH(*option) = length;
+        memcpy(COAP_OPTION_DATA(*option), record + 2 * sizeof(uint16_t), length);
+
+        *tail = node;
+        tail = &node->next;
+        record += 2 * sizeof(uint16_t) + length;
+    }
+
+    return CA_STATUS_OK;
+}
+
+/**
+ * Parses the options of the URI and of the header options, the work PDU
+ * templates save.
+ */
+static CAResult_t CAParseOptions(uint32_t code, const CAInfo_t *info, coap_list_t **optlist)
+{
+    if (CA_MSG_ACKNOWLEDGE != info->type && info->resourceUri)
+    {
+        uint32_t length = strlen(info->resourceUri);
+        if (CA_MAX_URI_LENGTH < length)
+        {
+            OIC_LOG(ERROR, TAG, "URI len err");
+            return CA_STATUS_INVALID_PARAM;
+        }
+
+        uint32_t uriLength = length + sizeof(COAP_URI_HEADER);
+        char *coapUri = (char *) OICCalloc(1, uriLength);
+        if (NULL == coapUri)
+        {
+            OIC_LOG(ERROR, TAG, "out of memory");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        OICStrcat(coapUri, uriLength, COAP_URI_HEADER);
+        OICStrcat(coapUri, uriLength, info->resourceUri);
+
+        // parsing options in URI
+        CAResult_t res = CAParseURI(coapUri, optlist);
+        OICFree(coapUri);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
+        }
+    }
+    // parsing options in HeadOption
+    return CAParseHeadOption(code, info, optlist);
+}
+
 coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
                           coap_list_t **optlist, coap_transport_type *transport)
 {
@@ -136,43 +511,45 @@ coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_
     }
     else
     {
-        if (CA_MSG_ACKNOWLEDGE != info->type && info->resourceUri)
+        // the options of a URI sent before come from its template, unless
+        // templates are not initialized
+        CAPDUTemplate_t *pduTemplate = NULL;
+        uint8_t key[CA_PDU_TEMPLATE_KEY_SIZE];
+        size_t keyLength = 0;
+        uint32_t hash = 0;
+        if (g_pduTemplateMutex && !*optlist)
         {
-            uint32_t length = strlen(info->resourceUri);
-            if (CA_MAX_URI_LENGTH < length)
+            keyLength = CAGetPDUTemplateKey(info, key, sizeof(key));
+            if (keyLength)
             {
-                OIC_LOG(ERROR, TAG, "URI len err");
-                return NULL;
+                hash = CAHashTemplateKey(key, keyLength);
+                pduTemplate = CAFindPDUTemplate(key, keyLength, hash);
             }
+        }
 
-            uint32_t uriLength = length + sizeof(COAP_URI_HEADER);
-            char *coapUri = (char *) OICCalloc(1, uriLength);
-            if (NULL == coapUri)
+        if (pduTemplate)
+        {
+            if (CA_STATUS_OK != CACloneTemplateOptions(pduTemplate, optlist))
             {
-                OIC_LOG(ERROR, TAG, "out of memory");
+                CAReleasePDUTemplate(pduTemplate);
                 return NULL;
             }
-            OICStrcat(coapUri, uriLength, COAP_URI_HEADER);
-            OICStrcat(coapUri, uriLength, info->resourceUri);
-
-            // parsing options in URI
-            CAResult_t res = CAParseURI(coapUri, optlist);
-            if (CA_STATUS_OK != res)
+        }
+        else
+        {
+            if (CA_STATUS_OK != CAParseOptions(code, info, optlist))
             {
-                OICFree(coapUri);
                 return NULL;
             }
-
-            OICFree(coapUri);
-        }
-        // parsing options in HeadOption
-        CAResult_t ret = CAParseHeadOption(code, info, optlist);
-        if (CA_STATUS_OK != ret)
-        {
-            return NULL;
+            if (keyLength)
+            {
+                CAAddPDUTemplate(key, keyLength, hash, *optlist);
+            }
         }
 
-        pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, *optlist, transport);
+        pdu = CAGeneratePDUWithTemplate((code_t) code, info, endpoint, *optlist,
+                                        pduTemplate, transport);
+        CAReleasePDUTemplate(pduTemplate);
         if (NULL == pdu)
         {
             OIC_LOG(ERROR, TAG, "pdu NULL");
@@ -258,6 +635,65 @@ coap_pdu_t *CAParsePDU(const char *data, uint32_t length, uint32_t *outCode,
 coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
                               const CAEndpoint_t *endpoint, coap_list_t *options,
                               coap_transport_type *transport)
+{
+    return CAGeneratePDUWithTemplate(code, info, endpoint, options, NULL, transport);
+}
+
+/**
+ * Storage a UDP PDU needs for the message, the block-wise transfer options
+ * included, rather than the largest PDU.
+ */
+static unsigned int CAGetPDUSize(const CAInfo_t *info, const CAEndpoint_t *endpoint,
+                                 const coap_list_t *options,
+                                 const CAPDUTemplate_t *pduTemplate)
+{
+    size_t size = sizeof(coap_hdr_t) + info->tokenLength;
+    if (pduTemplate)
+    {
+        size += pduTemplate->encodedLength;
+    }
+    else
+    {
+        for (const coap_list_t *opt = options; opt; opt = opt->next)
+        {
+            size += CA_OPTION_HEADER_MAX_SIZE + COAP_OPTION_LENGTH(*(coap_option *) opt->data);
+        }
+    }
+#ifdef WITH_BWT
+    size += CA_BLOCK_OPTIONS_SIZE;
+    if (NULL == info->payload)
+    {
+        // a streamed payload is added block by block
+        size_t streamLength = CAGetBlockStreamLength(info->token, info->tokenLength,
+                                                     endpoint->port);
+        if (streamLength)
+        {
+            size += PAYLOAD_MARKER + streamLength;
+        }
+    }
+#endif
+    if (NULL != info->payload && 0 < info->payloadSize)
+    {
+        size += PAYLOAD_MARKER + info->payloadSize;
+    }
+
+    if (size < CA_PDU_MIN_ALLOC_SIZE)
+    {
+        size = CA_PDU_MIN_ALLOC_SIZE;
+    }
+    // larger payloads go block-wise as before
+    return size < COAP_MAX_PDU_SIZE ? (unsigned int) size : COAP_MAX_PDU_SIZE;
+}
+
+/**
+ * Generates a PDU, with the options encoded by pduTemplate if there is one,
+ * options being its option list.
+ */
+static coap_pdu_t *CAGeneratePDUWithTemplate(code_t code, const CAInfo_t *info,
+                                             const CAEndpoint_t *endpoint,
+                                             coap_list_t *options,
+                                             const CAPDUTemplate_t *pduTemplate,
+                                             coap_transport_type *transport)
 {
     VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
     VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
@@ -307,9 +743,10 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
 #endif
     {
         *transport = coap_udp;
+        length = CAGetPDUSize(info, endpoint, options, pduTemplate);
     }
 
-    coap_pdu_t *pdu = coap_new_pdu(*transport, length);
+    coap_pdu_t *pdu = coap_pdu_init(0, 0, ntohs(COAP_INVALID_TID), length, *transport);
 
     if (NULL == pdu)
     {
@@ -375,7 +812,15 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
     }
 #endif
 
-    if (options)
+    if (pduTemplate && pduTemplate->encodedLength <= pdu->max_size - pdu->length)
+    {
+        // the options as coap_add_option would encode them
+        memcpy((unsigned char *) pdu->hdr + pdu->length, pduTemplate->encoded,
+               pduTemplate->encodedLength);
+        pdu->length += pduTemplate->encodedLength;
+        pdu->max_delta = pduTemplate->lastOption;
+    }
+    else if (options)
     {
         for (coap_list_t *opt = options; opt; opt = opt->next)
         {
@@ -628,13 +1073,14 @@ coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *da
         return NULL;
     }
 
-    coap_option *option = coap_malloc(sizeof(coap_option) + length + 1);
-    if (!option)
+    // the option is allocated with the node
+    coap_list_t *node = coap_new_listnode_data(sizeof(coap_option) + length + 1);
+    if (!node)
     {
         OIC_LOG(ERROR, TAG, "Out of memory");
         return NULL;
     }
-    memset(option, 0, sizeof(coap_option) + length + 1);
+    coap_option *option = (coap_option *) node->data;
 
     COAP_OPTION_KEY(*option) = key;
 
@@ -662,16 +1108,6 @@ coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *da
         memcpy(COAP_OPTION_DATA(*option), data, length);
     }
 
-    /* we can pass NULL here as delete function since option is released automatically  */
-    coap_list_t *node = coap_new_listnode(option, NULL);
-
-    if (!node)
-    {
-        OIC_LOG(ERROR, TAG, "node is NULL");
-        coap_free(option);
-        return NULL;
-    }
-
     return node;
 }
 
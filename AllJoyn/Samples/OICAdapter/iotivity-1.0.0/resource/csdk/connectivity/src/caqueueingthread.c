@@ -200,8 +200,8 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
     // mutex unlock
     ca_mutex_unlock(thread->threadMutex);
 
-    CAResult_t res = ca_thread_pool_add_task(thread->threadPool, CAQueueingThreadBaseRoutine,
-                                            thread);
+    CAResult_t res = ca_thread_pool_add_long_running_task(thread->threadPool,
+                                                          CAQueueingThreadBaseRoutine, thread);
     if (res != CA_STATUS_OK)
     {
         OIC_LOG(ERROR, TAG, "thread pool add task error(send thread).");
@@ -121,8 +121,8 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
         return CA_STATUS_INVALID_PARAM;
     }
 
-    CAResult_t res = ca_thread_pool_add_task(context->threadPool, CARetransmissionBaseRoutine,
-                                             context);
+    CAResult_t res = ca_thread_pool_add_long_running_task(context->threadPool,
+                                                          CARetransmissionBaseRoutine, context);
 
     if (CA_STATUS_OK != res)
     {
@@ -637,7 +637,7 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     }
 
     caglobals.ip.terminate = false;
-    res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
+    res = ca_thread_pool_add_long_running_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread_pool_add_task failed");
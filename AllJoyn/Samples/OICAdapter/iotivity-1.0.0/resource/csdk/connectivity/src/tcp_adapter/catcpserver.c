@@ -557,7 +557,7 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
 
     caglobals.tcp.terminate = false;
 
-    res = ca_thread_pool_add_task(threadPool, CAAcceptHandler, NULL);
+    res = ca_thread_pool_add_long_running_task(threadPool, CAAcceptHandler, NULL);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread_pool_add_task failed");
@@ -565,7 +565,7 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     }
     OIC_LOG(DEBUG, TAG, "CAAcceptHandler thread started successfully.");
 
-    res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
+    res = ca_thread_pool_add_long_running_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread_pool_add_task failed");
@@ -645,8 +645,8 @@ static size_t CACheckPayloadLength(const void *data, size_t dlen)
     if (pdu->length > headerSize)
     {
         payloadLen = (unsigned char *) pdu->hdr + pdu->length - pdu->data;
-        OICFree(pdu);
     }
+    coap_delete_pdu(pdu);
 
     return payloadLen;
 }
@@ -0,0 +1,191 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+// Nanoseconds per received block spent in the block-wise transfer list when
+// many multi-block transfers are in flight at once, as when a firmware image
+// is pulled by many devices. Every transfer gets one block in turn, the way
+// they interleave on the network. A block is looked up by its block ID, its
+// block option is read and its payload is appended, with and without a Size2
+// option announcing the total length. Finished transfers are removed.
+//
+// Usage: blockwise_benchmark [blocks per transfer]
+
+extern "C"
+{
+    #include "cainterface.h"
+    #include "camessagehandler.h"
+    #include "cablockwisetransfer.h"
+}
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const size_t BLOCK_LENGTH = 1024;
+    const uint8_t TOKEN_LENGTH = 8;
+
+    unsigned char g_block[BLOCK_LENGTH];
+
+    struct Transfer
+    {
+        char token[TOKEN_LENGTH];
+        CABlockDataID_t* blockID;
+    };
+
+    CAData_t* createRequest(char* token, uint16_t port)
+    {
+        CAEndpoint_t endpoint;
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.port = port;
+        strcpy(endpoint.addr, "192.168.1.1");
+
+        CARequestInfo_t requestInfo;
+        memset(&requestInfo, 0, sizeof(requestInfo));
+        requestInfo.method = CA_GET;
+        requestInfo.info.type = CA_MSG_CONFIRM;
+        requestInfo.info.token = token;
+        requestInfo.info.tokenLength = TOKEN_LENGTH;
+
+        CAData_t data;
+        memset(&data, 0, sizeof(data));
+        data.type = SEND_TYPE_UNICAST;
+        data.remoteEndpoint = &endpoint;
+        data.requestInfo = &requestInfo;
+        data.dataType = CA_REQUEST_DATA;
+        return CACloneCAData(&data);
+    }
+
+    bool run(size_t transferCount, size_t blocks, bool sizeOption)
+    {
+        std::vector<Transfer> transfers(transferCount);
+        for (size_t i = 0; i < transferCount; ++i)
+        {
+            Transfer& transfer = transfers[i];
+            uint32_t id = (uint32_t) i;
+            memset(transfer.token, 0, sizeof(transfer.token));
+            memcpy(transfer.token, &id, sizeof(id));
+
+            CAData_t* request = createRequest(transfer.token, 5683);
+            CABlockData_t* blockData = request ? CACreateNewBlockData(request) : nullptr;
+            CADestroyDataSet(request);
+            transfer.blockID = CACreateBlockDatablockId(transfer.token, TOKEN_LENGTH, 5683);
+            if (!blockData || !transfer.blockID)
+            {
+                printf("creating the block data failed\n");
+                return false;
+            }
+        }
+
+        // a response carrying one block
+        CAResponseInfo_t responseInfo;
+        memset(&responseInfo, 0, sizeof(responseInfo));
+        responseInfo.result = CA_CONTENT;
+        responseInfo.info.type = CA_MSG_ACKNOWLEDGE;
+        responseInfo.info.payload = g_block;
+        responseInfo.info.payloadSize = BLOCK_LENGTH;
+        CAData_t received;
+        memset(&received, 0, sizeof(received));
+        received.responseInfo = &responseInfo;
+        received.dataType = CA_RESPONSE_DATA;
+
+        auto start = Clock::now();
+        for (size_t num = 0; num < blocks; ++num)
+        {
+            for (Transfer& transfer : transfers)
+            {
+                CABlockData_t* blockData = CAGetBlockDataFromBlockDataList(transfer.blockID);
+                coap_block_t* block = CAGetBlockOption(transfer.blockID, COAP_OPTION_BLOCK2);
+                if (!blockData || !block)
+                {
+                    printf("block data lookup failed\n");
+                    return false;
+                }
+                block->num = num;
+                if (sizeOption)
+                {
+                    blockData->payloadLength = blocks * BLOCK_LENGTH;
+                }
+                if (CAUpdatePayloadData(blockData, &received, CA_BLOCK_UNKNOWN, sizeOption,
+                                        COAP_OPTION_BLOCK2) != CA_STATUS_OK)
+                {
+                    printf("CAUpdatePayloadData failed\n");
+                    return false;
+                }
+            }
+        }
+        for (Transfer& transfer : transfers)
+        {
+            size_t payloadLength = 0;
+            CAGetPayloadFromBlockDataList(transfer.blockID, &payloadLength);
+            if (payloadLength != blocks * BLOCK_LENGTH)
+            {
+                printf("payload length %u, expected %u\n", (unsigned int) payloadLength,
+                        (unsigned int) (blocks * BLOCK_LENGTH));
+                return false;
+            }
+            CARemoveBlockDataFromList(transfer.blockID);
+            CADestroyBlockID(transfer.blockID);
+        }
+        std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+
+        printf("%5u transfers, %-10s : %8.0f ns/block\n", (unsigned int) transferCount,
+                sizeOption ? "Size2" : "no Size2", elapsed.count() / (transferCount * blocks));
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int blocks = argc > 1 ? atoi(argv[1]) : 64;
+    if (blocks <= 0)
+    {
+        printf("usage: %s [blocks per transfer]\n", argv[0]);
+        return 1;
+    }
+
+    if (CAInitializeBlockWiseTransfer(nullptr, nullptr) != CA_STATUS_OK)
+    {
+        printf("CAInitializeBlockWiseTransfer failed\n");
+        return 1;
+    }
+
+    printf("%d blocks of %u bytes per transfer\n", blocks, (unsigned int) BLOCK_LENGTH);
+    for (size_t transfers : { 1, 100, 200, 400, 800 })
+    {
+        for (bool sizeOption : { false, true })
+        {
+            if (!run(transfers, blocks, sizeOption))
+            {
+                return 1;
+            }
+        }
+    }
+
+    CATerminateBlockWiseTransfer();
+    return 0;
+}
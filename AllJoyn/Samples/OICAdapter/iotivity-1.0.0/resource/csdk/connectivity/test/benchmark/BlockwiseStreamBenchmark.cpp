@@ -0,0 +1,289 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+// Throughput and peak resident memory of a large block-wise transfer with
+// the payload in memory against a streamed payload. Sending builds the PDU
+// of every Block1 block of a POST, from the payload or from a read callback;
+// receiving appends every Block2 block of a response, reassembled or passed
+// to a write callback. Each case runs in a child process so that its peak
+// RSS is its own.
+//
+// Usage: blockwise_stream_benchmark [payload MB]
+
+extern "C"
+{
+    #include "cainterface.h"
+    #include "camessagehandler.h"
+    #include "cablockwisetransfer.h"
+    #include "caprotocolmessage.h"
+    #include "oic_malloc.h"
+}
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const size_t BLOCK_LENGTH = 1024;
+    const uint8_t TOKEN_LENGTH = 8;
+    const uint16_t PORT = 5683;
+
+    char g_token[TOKEN_LENGTH] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint32_t g_checksum = 0;
+
+    CAResult_t readPayload(void* context, size_t offset, uint8_t* buffer, size_t length)
+    {
+        memset(buffer, (int) (offset / BLOCK_LENGTH), length);
+        return CA_STATUS_OK;
+    }
+
+    CAResult_t writePayload(void* context, const CAEndpoint_t* object, const CAToken_t token,
+                            uint8_t tokenLength, size_t offset, const uint8_t* data,
+                            size_t length)
+    {
+        g_checksum += data[0] + data[length - 1];
+        return CA_STATUS_OK;
+    }
+
+    void initEndpoint(CAEndpoint_t& endpoint)
+    {
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.port = PORT;
+        strcpy(endpoint.addr, "192.168.1.1");
+    }
+
+    bool send(size_t length, bool streamed)
+    {
+        CAEndpoint_t endpoint;
+        initEndpoint(endpoint);
+
+        CARequestInfo_t requestInfo;
+        memset(&requestInfo, 0, sizeof(requestInfo));
+        requestInfo.method = CA_POST;
+        requestInfo.info.type = CA_MSG_CONFIRM;
+        requestInfo.info.token = g_token;
+        requestInfo.info.tokenLength = TOKEN_LENGTH;
+
+        CAData_t data;
+        memset(&data, 0, sizeof(data));
+        data.type = SEND_TYPE_UNICAST;
+        data.remoteEndpoint = &endpoint;
+        data.requestInfo = &requestInfo;
+        data.dataType = CA_REQUEST_DATA;
+
+        auto start = Clock::now();
+        CAResult_t res;
+        if (streamed)
+        {
+            CABlockStreamSource_t source = { length, readPayload, nullptr, nullptr };
+            res = CASendBlockWiseStream(&data, &source);
+        }
+        else
+        {
+            requestInfo.info.payload = (CAPayload_t) OICMalloc(length);
+            if (!requestInfo.info.payload)
+            {
+                printf("out of memory\n");
+                return false;
+            }
+            for (size_t offset = 0; offset < length; offset += BLOCK_LENGTH)
+            {
+                readPayload(nullptr, offset, requestInfo.info.payload + offset,
+                            length - offset < BLOCK_LENGTH ? length - offset : BLOCK_LENGTH);
+            }
+            requestInfo.info.payloadSize = length;
+            res = CASendBlockWiseData(&data);
+        }
+        if (CA_STATUS_OK != res)
+        {
+            printf("sending has failed: %d\n", res);
+            return false;
+        }
+
+        CABlockDataID_t* blockID = CACreateBlockDatablockId(g_token, TOKEN_LENGTH, PORT);
+        size_t blocks = (length + BLOCK_LENGTH - 1) / BLOCK_LENGTH;
+        for (size_t num = 0; num < blocks; ++num)
+        {
+            coap_block_t* block = CAGetBlockOption(blockID, COAP_OPTION_BLOCK1);
+            if (!block)
+            {
+                printf("block data lookup failed\n");
+                return false;
+            }
+            block->num = num;
+
+            coap_list_t* options = nullptr;
+            coap_transport_type transport;
+            coap_pdu_t* pdu = CAGeneratePDU(CA_POST, &requestInfo.info, &endpoint, &options,
+                                            &transport);
+            if (!pdu || CA_STATUS_OK != CAAddBlockOption(&pdu, &requestInfo.info, &endpoint,
+                                                         &options))
+            {
+                printf("generating block %u failed\n", (unsigned int) num);
+                return false;
+            }
+            coap_delete_list(options);
+            coap_delete_pdu(pdu);
+        }
+        CARemoveBlockDataFromList(blockID);
+        CADestroyBlockID(blockID);
+        OICFree(requestInfo.info.payload);
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        printf("send,    %-10s : %8.1f MB/s", streamed ? "streamed" : "in memory",
+                length / elapsed.count() / (1024 * 1024));
+        return true;
+    }
+
+    bool receive(size_t length, bool streamed)
+    {
+        CASetBlockWriteCallback(streamed ? writePayload : nullptr, nullptr);
+
+        CAEndpoint_t endpoint;
+        initEndpoint(endpoint);
+
+        CARequestInfo_t requestInfo;
+        memset(&requestInfo, 0, sizeof(requestInfo));
+        requestInfo.method = CA_GET;
+        requestInfo.info.type = CA_MSG_CONFIRM;
+        requestInfo.info.token = g_token;
+        requestInfo.info.tokenLength = TOKEN_LENGTH;
+
+        CAData_t request;
+        memset(&request, 0, sizeof(request));
+        request.type = SEND_TYPE_UNICAST;
+        request.remoteEndpoint = &endpoint;
+        request.requestInfo = &requestInfo;
+        request.dataType = CA_REQUEST_DATA;
+
+        CABlockData_t* blockData = CACreateNewBlockData(&request);
+        CABlockDataID_t* blockID = CACreateBlockDatablockId(g_token, TOKEN_LENGTH, PORT);
+        if (!blockData || !blockID)
+        {
+            printf("creating the block data failed\n");
+            return false;
+        }
+
+        // a response carrying one block
+        unsigned char block[BLOCK_LENGTH];
+        CAResponseInfo_t responseInfo;
+        memset(&responseInfo, 0, sizeof(responseInfo));
+        responseInfo.result = CA_CONTENT;
+        responseInfo.info.type = CA_MSG_ACKNOWLEDGE;
+        responseInfo.info.token = g_token;
+        responseInfo.info.tokenLength = TOKEN_LENGTH;
+        responseInfo.info.payload = block;
+        CAData_t received;
+        memset(&received, 0, sizeof(received));
+        received.remoteEndpoint = &endpoint;
+        received.responseInfo = &responseInfo;
+        received.dataType = CA_RESPONSE_DATA;
+
+        auto start = Clock::now();
+        for (size_t offset = 0; offset < length; offset += BLOCK_LENGTH)
+        {
+            responseInfo.info.payloadSize =
+                length - offset < BLOCK_LENGTH ? length - offset : BLOCK_LENGTH;
+            readPayload(nullptr, offset, block, responseInfo.info.payloadSize);
+            blockData->payloadLength = length;
+            if (CAUpdatePayloadData(blockData, &received, CA_BLOCK_UNKNOWN, true,
+                                    COAP_OPTION_BLOCK2) != CA_STATUS_OK)
+            {
+                printf("CAUpdatePayloadData failed\n");
+                return false;
+            }
+        }
+        if (blockData->receivedPayloadLen != length)
+        {
+            printf("payload length %u, expected %u\n",
+                    (unsigned int) blockData->receivedPayloadLen, (unsigned int) length);
+            return false;
+        }
+        CARemoveBlockDataFromList(blockID);
+        CADestroyBlockID(blockID);
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        printf("receive, %-10s : %8.1f MB/s", streamed ? "streamed" : "in memory",
+                length / elapsed.count() / (1024 * 1024));
+        return true;
+    }
+
+    // runs a case in a child process and reports its peak RSS
+    bool run(bool (*transfer)(size_t, bool), size_t length, bool streamed)
+    {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            printf("fork failed\n");
+            return false;
+        }
+        if (0 == pid)
+        {
+            bool ok = CA_STATUS_OK == CAInitializeBlockWiseTransfer(nullptr, nullptr) &&
+                      transfer(length, streamed);
+            CATerminateBlockWiseTransfer();
+            if (ok)
+            {
+                struct rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                printf("  peak RSS %8ld kB\n", usage.ru_maxrss);
+            }
+            fflush(stdout);
+            _exit(ok ? 0 : 1);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && 0 == WEXITSTATUS(status);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int megabytes = argc > 1 ? atoi(argv[1]) : 64;
+    if (megabytes <= 0)
+    {
+        printf("usage: %s [payload MB]\n", argv[0]);
+        return 1;
+    }
+
+    size_t length = (size_t) megabytes * 1024 * 1024;
+    printf("%d MB payload in blocks of %u bytes\n", megabytes, (unsigned int) BLOCK_LENGTH);
+    for (bool streamed : { false, true })
+    {
+        if (!run(send, length, streamed) || !run(receive, length, streamed))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
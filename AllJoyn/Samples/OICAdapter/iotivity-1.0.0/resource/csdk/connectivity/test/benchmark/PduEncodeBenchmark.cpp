@@ -0,0 +1,155 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+// Nanoseconds per PDU spent by CAGeneratePDU, with and without the PDU
+// templates, for:
+//  - a GET with a query and an accept format, as a client sends it,
+//  - a non-confirmable response carrying a payload, as an observe notification.
+// Each message is encoded for an IP endpoint, where block-wise transfer adds the
+// options, and for a BLE endpoint, where CAGeneratePDU writes them itself. An
+// iteration generates the PDU and frees it along with its option list.
+//
+// Usage: pdu_encode_benchmark [iterations]
+
+extern "C"
+{
+    #include "caprotocolmessage.h"
+}
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    char g_token[] = "abcdefgh";
+    char g_requestUri[] = "/a/light?if=oic.if.baseline;rt=core.light";
+    char g_responseUri[] = "/a/light";
+    char g_payload[] = "\xbf\x62rt\x6b" "core.light\x65state\xf5\x65power\x18\x64\xff";
+
+    struct Message
+    {
+        const char* name;
+        CAMessageType_t type;
+        uint32_t code;
+        char* uri;
+        char* payload;
+        size_t payloadSize;
+        CAPayloadFormat_t acceptFormat;
+    };
+
+    const Message MESSAGES[] =
+    {
+        { "GET with query", CA_MSG_CONFIRM, CA_GET, g_requestUri, nullptr, 0,
+          CA_FORMAT_APPLICATION_CBOR },
+        { "observe response", CA_MSG_NONCONFIRM, CA_CONTENT, g_responseUri, g_payload,
+          sizeof(g_payload) - 1, CA_FORMAT_UNDEFINED }
+    };
+
+    double encode(const Message& message, CATransportAdapter_t adapter, int iterations)
+    {
+        CAHeaderOption_t observe;
+        memset(&observe, 0, sizeof(observe));
+        observe.protocolID = CA_COAP_ID;
+        observe.optionID = COAP_OPTION_OBSERVE;
+        observe.optionLength = 1;
+        observe.optionData[0] = 7;
+
+        CAInfo_t info;
+        memset(&info, 0, sizeof(info));
+        info.type = message.type;
+        info.messageId = 1;
+        info.token = g_token;
+        info.tokenLength = sizeof(g_token) - 1;
+        info.options = &observe;
+        info.numOptions = 1;
+        info.payload = reinterpret_cast<CAPayload_t>(message.payload);
+        info.payloadSize = message.payloadSize;
+        info.payloadFormat = message.payload ? CA_FORMAT_APPLICATION_CBOR
+                                             : CA_FORMAT_UNDEFINED;
+        info.acceptFormat = message.acceptFormat;
+        info.resourceUri = message.uri;
+
+        CAEndpoint_t endpoint;
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = adapter;
+
+        auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            coap_list_t* optlist = nullptr;
+            coap_transport_type transport;
+            coap_pdu_t* pdu = CAGeneratePDU(message.code, &info, &endpoint, &optlist,
+                                            &transport);
+            if (!pdu)
+            {
+                return -1;
+            }
+            coap_delete_list(optlist);
+            coap_delete_pdu(pdu);
+        }
+        std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+    void run(const char* mode, int iterations)
+    {
+        const CATransportAdapter_t adapters[] = { CA_ADAPTER_IP, CA_ADAPTER_GATT_BTLE };
+        const char* const adapterNames[] = { "IP", "BLE" };
+
+        for (const Message& message : MESSAGES)
+        {
+            for (size_t a = 0; a < sizeof(adapters) / sizeof(adapters[0]); ++a)
+            {
+                // one pass to fill the templates and the PDU pool
+                encode(message, adapters[a], 1);
+                printf("%-18s %-17s %-4s : %8.1f ns/PDU\n", mode, message.name,
+                        adapterNames[a], encode(message, adapters[a], iterations));
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    if (iterations <= 0)
+    {
+        printf("usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d PDUs per message\n", iterations);
+
+    run("without templates", iterations);
+
+    if (CAInitializePDUTemplates() != CA_STATUS_OK)
+    {
+        printf("CAInitializePDUTemplates failed\n");
+        return 1;
+    }
+    run("with templates", iterations);
+    CATerminatePDUTemplates();
+    return 0;
+}
@@ -0,0 +1,175 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+// Task dispatch throughput and latency of ca_thread_pool for short tasks,
+// against starting a thread per task as the pool used to do. One thread
+// submits all tasks; latency is from ca_thread_pool_add_task() (or
+// pthread_create()) to the start of the task. The pools block the
+// submitter when their queue is full, so no task is rejected.
+//
+// Usage: thread_pool_benchmark [tasks]
+
+extern "C"
+{
+    #include "cathreadpool.h"
+}
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct Task
+    {
+        Clock::time_point submitted;
+        double latencyUs;
+    };
+
+    std::atomic<int> g_done(0);
+
+    void taskFunc(void* data)
+    {
+        Task* task = static_cast<Task*>(data);
+        std::chrono::duration<double, std::micro> latency = Clock::now() - task->submitted;
+        task->latencyUs = latency.count();
+        g_done.fetch_add(1, std::memory_order_release);
+    }
+
+    void* threadFunc(void* data)
+    {
+        taskFunc(data);
+        return nullptr;
+    }
+
+    void report(const char* mode, std::vector<Task>& tasks, double seconds)
+    {
+        std::vector<double> latencies;
+        latencies.reserve(tasks.size());
+        for (const Task& task : tasks)
+        {
+            latencies.push_back(task.latencyUs);
+        }
+        std::sort(latencies.begin(), latencies.end());
+        printf("%-22s : %10.0f tasks/s  latency p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+                mode, tasks.size() / seconds, latencies[latencies.size() / 2],
+                latencies[latencies.size() * 99 / 100], latencies.back());
+    }
+
+    bool runThreadPerTask(std::vector<Task>& tasks)
+    {
+        std::vector<pthread_t> threads(tasks.size());
+        auto start = Clock::now();
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            tasks[i].submitted = Clock::now();
+            if (pthread_create(&threads[i], nullptr, threadFunc, &tasks[i]) != 0)
+            {
+                printf("pthread_create failed after %zu threads\n", i);
+                for (size_t j = 0; j < i; ++j)
+                {
+                    pthread_join(threads[j], nullptr);
+                }
+                return false;
+            }
+        }
+        for (pthread_t& thread : threads)
+        {
+            pthread_join(thread, nullptr);
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        report("thread per task", tasks, elapsed.count());
+        return true;
+    }
+
+    bool runPool(std::vector<Task>& tasks, int32_t threads)
+    {
+        ca_thread_pool_config_t config = { threads, 256, CA_THREAD_POOL_BLOCK, 0 };
+        ca_thread_pool_t pool;
+        if (ca_thread_pool_init_with_config(&config, &pool) != CA_STATUS_OK)
+        {
+            printf("ca_thread_pool_init_with_config failed\n");
+            return false;
+        }
+
+        g_done.store(0);
+        auto start = Clock::now();
+        for (Task& task : tasks)
+        {
+            task.submitted = Clock::now();
+            if (ca_thread_pool_add_task(pool, taskFunc, &task) != CA_STATUS_OK)
+            {
+                printf("ca_thread_pool_add_task failed\n");
+                ca_thread_pool_free(pool);
+                return false;
+            }
+        }
+        while (g_done.load(std::memory_order_acquire) < (int)tasks.size())
+        {
+            sched_yield();
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        ca_thread_pool_stats_t stats;
+        ca_thread_pool_get_stats(pool, &stats);
+        ca_thread_pool_free(pool);
+
+        char mode[32];
+        snprintf(mode, sizeof(mode), "pool, %d threads", threads);
+        report(mode, tasks, elapsed.count());
+        printf("%-22s   max queue depth %u, mean wait %.1f us\n", "",
+                stats.max_queue_depth, (double)stats.total_wait_us / stats.tasks_completed);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 20000;
+    if (count <= 0)
+    {
+        printf("usage: %s [tasks]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d tasks\n", count);
+
+    std::vector<Task> tasks(count);
+    if (!runThreadPerTask(tasks))
+    {
+        return 1;
+    }
+    for (int32_t threads : { 1, 4, 20 })
+    {
+        if (!runPool(tasks, threads))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
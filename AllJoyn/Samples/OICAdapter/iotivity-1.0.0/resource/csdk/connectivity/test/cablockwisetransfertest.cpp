@@ -0,0 +1,480 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "cainterface.h"
+#include "camessagehandler.h"
+#include "cablockwisetransfer.h"
+#include "caprotocolmessage.h"
+#include "oic_malloc.h"
+
+#include <string.h>
+#include <vector>
+
+static const uint16_t PORT = 5683;
+static const uint8_t TOKEN_LENGTH = 8;
+
+class CABlockWiseTransferF : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        sentCount = 0;
+        ASSERT_EQ(CA_STATUS_OK, CAInitializeBlockWiseTransfer(sendStub, NULL));
+    }
+
+    virtual void TearDown()
+    {
+        CASetBlockWriteCallback(NULL, NULL);
+        CATerminateBlockWiseTransfer();
+    }
+
+    // stands in for the message handler's send queue, which is not running here
+    static void sendStub(CAData_t *data)
+    {
+        sentCount++;
+        CADestroyDataSet(data);
+    }
+
+    static size_t sentCount;
+
+    static void makeToken(uint32_t n, char *token)
+    {
+        memset(token, 0, TOKEN_LENGTH);
+        memcpy(token, &n, sizeof(n));
+    }
+
+    static CABlockData_t *createBlockData(uint32_t n)
+    {
+        char token[TOKEN_LENGTH];
+        makeToken(n, token);
+
+        CAEndpoint_t endpoint;
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.port = PORT;
+
+        CARequestInfo_t requestInfo;
+        memset(&requestInfo, 0, sizeof(requestInfo));
+        requestInfo.method = CA_GET;
+        requestInfo.info.type = CA_MSG_CONFIRM;
+        requestInfo.info.token = token;
+        requestInfo.info.tokenLength = TOKEN_LENGTH;
+
+        CAData_t data;
+        memset(&data, 0, sizeof(data));
+        data.remoteEndpoint = &endpoint;
+        data.requestInfo = &requestInfo;
+        data.dataType = CA_REQUEST_DATA;
+        return CACreateNewBlockData(&data);
+    }
+
+    static CABlockDataID_t *createBlockID(uint32_t n)
+    {
+        char token[TOKEN_LENGTH];
+        makeToken(n, token);
+        return CACreateBlockDatablockId(token, TOKEN_LENGTH, PORT);
+    }
+
+    static bool isInList(uint32_t n)
+    {
+        CABlockDataID_t *blockID = createBlockID(n);
+        bool found = CAIsBlockDataInList(blockID);
+        CADestroyBlockID(blockID);
+        return found;
+    }
+
+    static CAResult_t addBlock(CABlockData_t *blockData, unsigned char *block, size_t length,
+                               bool isSizeOption)
+    {
+        CAResponseInfo_t responseInfo;
+        memset(&responseInfo, 0, sizeof(responseInfo));
+        responseInfo.info.payload = block;
+        responseInfo.info.payloadSize = length;
+
+        CAData_t received;
+        memset(&received, 0, sizeof(received));
+        received.responseInfo = &responseInfo;
+        return CAUpdatePayloadData(blockData, &received, CA_BLOCK_UNKNOWN, isSizeOption,
+                                   COAP_OPTION_BLOCK2);
+    }
+};
+
+size_t CABlockWiseTransferF::sentCount = 0;
+
+TEST_F(CABlockWiseTransferF, ManyBlockData)
+{
+    const uint32_t count = 500;
+    for (uint32_t n = 0; n < count; ++n)
+    {
+        ASSERT_TRUE(createBlockData(n) != NULL);
+    }
+
+    for (uint32_t n = 0; n < count; ++n)
+    {
+        CABlockDataID_t *blockID = createBlockID(n);
+        CABlockData_t *blockData = CAGetBlockDataFromBlockDataList(blockID);
+        ASSERT_TRUE(blockData != NULL);
+        EXPECT_TRUE(CABlockidMatches(blockData, blockID));
+        CADestroyBlockID(blockID);
+    }
+
+    for (uint32_t n = 0; n < count; n += 2)
+    {
+        CABlockDataID_t *blockID = createBlockID(n);
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(blockID));
+        CADestroyBlockID(blockID);
+    }
+
+    for (uint32_t n = 0; n < count; ++n)
+    {
+        EXPECT_EQ(n % 2 != 0, isInList(n)) << n;
+    }
+}
+
+TEST_F(CABlockWiseTransferF, RemoveIdleBlockData)
+{
+    ASSERT_TRUE(createBlockData(1) != NULL);
+    ASSERT_TRUE(createBlockData(2) != NULL);
+    ASSERT_TRUE(createBlockData(3) != NULL);
+
+    EXPECT_EQ(static_cast<size_t>(0), CARemoveIdleBlockDataFromList(CA_BLOCK_DATA_IDLE_TIMEOUT));
+    EXPECT_TRUE(isInList(2));
+
+    EXPECT_EQ(static_cast<size_t>(3), CARemoveIdleBlockDataFromList(0));
+    EXPECT_FALSE(isInList(1));
+    EXPECT_FALSE(isInList(2));
+    EXPECT_FALSE(isInList(3));
+}
+
+TEST_F(CABlockWiseTransferF, PayloadWithoutSizeOption)
+{
+    CABlockData_t *blockData = createBlockData(1);
+    ASSERT_TRUE(blockData != NULL);
+
+    unsigned char block[100];
+    for (int i = 0; i < 10; ++i)
+    {
+        memset(block, 'a' + i, sizeof(block));
+        ASSERT_EQ(CA_STATUS_OK, addBlock(blockData, block, sizeof(block), false));
+        EXPECT_GE(blockData->payloadCapacity, blockData->receivedPayloadLen);
+    }
+
+    // grown by doubling from four blocks
+    EXPECT_EQ(static_cast<size_t>(1600), blockData->payloadCapacity);
+
+    CABlockDataID_t *blockID = createBlockID(1);
+    size_t length = 0;
+    CAPayload_t payload = CAGetPayloadFromBlockDataList(blockID, &length);
+    ASSERT_EQ(static_cast<size_t>(1000), length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        ASSERT_EQ('a' + i / 100, payload[i]) << i;
+    }
+    CADestroyBlockID(blockID);
+}
+
+TEST_F(CABlockWiseTransferF, PayloadWithSizeOption)
+{
+    CABlockData_t *blockData = createBlockData(1);
+    ASSERT_TRUE(blockData != NULL);
+    blockData->payloadLength = 1000;
+
+    unsigned char block[100];
+    memset(block, 'x', sizeof(block));
+    ASSERT_EQ(CA_STATUS_OK, addBlock(blockData, block, sizeof(block), true));
+    CAPayload_t payload = blockData->payload;
+    EXPECT_EQ(static_cast<size_t>(1000), blockData->payloadCapacity);
+
+    for (int i = 1; i < 10; ++i)
+    {
+        ASSERT_EQ(CA_STATUS_OK, addBlock(blockData, block, sizeof(block), true));
+    }
+
+    // allocated once for the announced length
+    EXPECT_EQ(payload, blockData->payload);
+    EXPECT_EQ(static_cast<size_t>(1000), blockData->receivedPayloadLen);
+
+    // a peer sending more than it announced
+    ASSERT_EQ(CA_STATUS_OK, addBlock(blockData, block, sizeof(block), true));
+    EXPECT_EQ(static_cast<size_t>(1100), blockData->receivedPayloadLen);
+    EXPECT_GE(blockData->payloadCapacity, blockData->receivedPayloadLen);
+}
+
+struct StreamSource
+{
+    StreamSource() : releases(0), failing(false) {}
+    std::vector<size_t> offsets;
+    size_t releases;
+    bool failing;
+};
+
+static CAResult_t readStream(void *context, size_t offset, uint8_t *buffer, size_t length)
+{
+    StreamSource *stream = static_cast<StreamSource *>(context);
+    stream->offsets.push_back(offset);
+    if (stream->failing)
+    {
+        return CA_STATUS_FAILED;
+    }
+    for (size_t i = 0; i < length; ++i)
+    {
+        buffer[i] = (uint8_t) ((offset + i) % 251);
+    }
+    return CA_STATUS_OK;
+}
+
+static void releaseStream(void *context)
+{
+    static_cast<StreamSource *>(context)->releases++;
+}
+
+TEST_F(CABlockWiseTransferF, StreamedRequestPayload)
+{
+    char token[TOKEN_LENGTH];
+    makeToken(1, token);
+
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_IP;
+    endpoint.port = PORT;
+
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(requestInfo));
+    requestInfo.method = CA_POST;
+    requestInfo.info.type = CA_MSG_CONFIRM;
+    requestInfo.info.token = token;
+    requestInfo.info.tokenLength = TOKEN_LENGTH;
+
+    CAData_t data;
+    memset(&data, 0, sizeof(data));
+    data.type = SEND_TYPE_UNICAST;
+    data.remoteEndpoint = &endpoint;
+    data.requestInfo = &requestInfo;
+    data.dataType = CA_REQUEST_DATA;
+
+    StreamSource stream;
+    CABlockStreamSource_t source = { 3000, readStream, &stream, releaseStream };
+    ASSERT_EQ(CA_STATUS_OK, CASendBlockWiseStream(&data, &source));
+    EXPECT_TRUE(stream.offsets.empty());
+    EXPECT_EQ(static_cast<size_t>(1), sentCount);
+
+    coap_list_t *options = NULL;
+    coap_transport_type transport;
+    coap_pdu_t *pdu = CAGeneratePDU(CA_POST, &requestInfo.info, &endpoint, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+    ASSERT_EQ(CA_STATUS_OK, CAAddBlockOption(&pdu, &requestInfo.info, &endpoint, &options));
+
+    // only the first block has been read
+    ASSERT_EQ(static_cast<size_t>(1), stream.offsets.size());
+    EXPECT_EQ(static_cast<size_t>(0), stream.offsets[0]);
+
+    size_t length = 0;
+    uint8_t *payload = NULL;
+    ASSERT_TRUE(coap_get_data(pdu, &length, &payload));
+    ASSERT_EQ(static_cast<size_t>(1024), length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        ASSERT_EQ(i % 251, payload[i]) << i;
+    }
+
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    // the source is read until the transfer ends
+    EXPECT_EQ(static_cast<size_t>(0), stream.releases);
+    CABlockDataID_t *blockID = createBlockID(1);
+    CARemoveBlockDataFromList(blockID);
+    CADestroyBlockID(blockID);
+    EXPECT_EQ(static_cast<size_t>(1), stream.releases);
+}
+
+TEST_F(CABlockWiseTransferF, StreamSourceIsReleasedOnce)
+{
+    char token[TOKEN_LENGTH];
+    makeToken(1, token);
+
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_IP;
+    endpoint.port = PORT;
+
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(responseInfo));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.type = CA_MSG_ACKNOWLEDGE;
+    responseInfo.info.token = token;
+    responseInfo.info.tokenLength = TOKEN_LENGTH;
+
+    CAData_t data;
+    memset(&data, 0, sizeof(data));
+    data.type = SEND_TYPE_UNICAST;
+    data.remoteEndpoint = &endpoint;
+    data.responseInfo = &responseInfo;
+    data.dataType = CA_RESPONSE_DATA;
+
+    // a response sent again for the same token replaces the first source
+    StreamSource first;
+    CABlockStreamSource_t source = { 3000, readStream, &first, releaseStream };
+    ASSERT_EQ(CA_STATUS_OK, CASendBlockWiseStream(&data, &source));
+    StreamSource second;
+    source.context = &second;
+    ASSERT_EQ(CA_STATUS_OK, CASendBlockWiseStream(&data, &source));
+    EXPECT_EQ(static_cast<size_t>(1), first.releases);
+    EXPECT_EQ(static_cast<size_t>(0), second.releases);
+
+    // a transfer that times out
+    EXPECT_EQ(static_cast<size_t>(1), CARemoveIdleBlockDataFromList(0));
+    EXPECT_EQ(static_cast<size_t>(1), second.releases);
+
+    // a transfer that is left when block-wise transfer terminates
+    StreamSource third;
+    source.context = &third;
+    ASSERT_EQ(CA_STATUS_OK, CASendBlockWiseStream(&data, &source));
+    CATerminateBlockWiseTransfer();
+    EXPECT_EQ(static_cast<size_t>(1), third.releases);
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeBlockWiseTransfer(sendStub, NULL));
+
+    // a send that fails before the transfer starts
+    StreamSource fourth;
+    source.context = &fourth;
+    data.responseInfo = NULL;
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CASendBlockWiseStream(&data, &source));
+    EXPECT_EQ(static_cast<size_t>(1), fourth.releases);
+
+    // a read that fails
+    StreamSource fifth;
+    fifth.failing = true;
+    source.length = 100;
+    source.context = &fifth;
+    data.responseInfo = &responseInfo;
+    EXPECT_EQ(CA_STATUS_FAILED, CASendBlockWiseStream(&data, &source));
+    EXPECT_EQ(static_cast<size_t>(1), fifth.releases);
+
+    EXPECT_EQ(static_cast<size_t>(1), first.releases);
+    EXPECT_EQ(static_cast<size_t>(1), second.releases);
+    EXPECT_EQ(static_cast<size_t>(1), third.releases);
+}
+
+TEST_F(CABlockWiseTransferF, SmallStreamIsReadAtOnce)
+{
+    char token[TOKEN_LENGTH];
+    makeToken(1, token);
+
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_IP;
+    endpoint.port = PORT;
+
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(responseInfo));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.type = CA_MSG_ACKNOWLEDGE;
+    responseInfo.info.token = token;
+    responseInfo.info.tokenLength = TOKEN_LENGTH;
+
+    CAData_t data;
+    memset(&data, 0, sizeof(data));
+    data.type = SEND_TYPE_UNICAST;
+    data.remoteEndpoint = &endpoint;
+    data.responseInfo = &responseInfo;
+    data.dataType = CA_RESPONSE_DATA;
+
+    StreamSource stream;
+    CABlockStreamSource_t source = { 100, readStream, &stream, releaseStream };
+
+    // sent without block options
+    EXPECT_EQ(CA_NOT_SUPPORTED, CASendBlockWiseStream(&data, &source));
+    ASSERT_EQ(static_cast<size_t>(1), stream.offsets.size());
+    EXPECT_EQ(static_cast<size_t>(0), stream.offsets[0]);
+    EXPECT_EQ(static_cast<size_t>(1), stream.releases);
+    ASSERT_TRUE(responseInfo.info.payload != NULL);
+    EXPECT_EQ(static_cast<size_t>(100), responseInfo.info.payloadSize);
+    EXPECT_EQ(99, responseInfo.info.payload[99]);
+    OICFree(responseInfo.info.payload);
+}
+
+struct StreamSink
+{
+    CAResult_t result;
+    std::vector<size_t> offsets;
+    std::vector<uint8_t> payload;
+};
+
+static CAResult_t writeStream(void *context, const CAEndpoint_t *object, const CAToken_t token,
+                              uint8_t tokenLength, size_t offset, const uint8_t *data,
+                              size_t length)
+{
+    StreamSink *sink = static_cast<StreamSink *>(context);
+    if (CA_STATUS_OK == sink->result)
+    {
+        sink->offsets.push_back(offset);
+        sink->payload.insert(sink->payload.end(), data, data + length);
+    }
+    return sink->result;
+}
+
+TEST_F(CABlockWiseTransferF, StreamedReceivedPayload)
+{
+    StreamSink sink;
+    sink.result = CA_STATUS_OK;
+    CASetBlockWriteCallback(writeStream, &sink);
+
+    CABlockData_t *blockData = createBlockData(1);
+    ASSERT_TRUE(blockData != NULL);
+
+    unsigned char block[100];
+    for (int i = 0; i < 10; ++i)
+    {
+        memset(block, 'a' + i, sizeof(block));
+        ASSERT_EQ(CA_STATUS_OK, addBlock(blockData, block, sizeof(block), false));
+    }
+
+    // passed on in order and not kept
+    EXPECT_TRUE(blockData->streamed);
+    EXPECT_TRUE(blockData->payload == NULL);
+    EXPECT_EQ(static_cast<size_t>(1000), blockData->receivedPayloadLen);
+    ASSERT_EQ(static_cast<size_t>(10), sink.offsets.size());
+    for (size_t i = 0; i < sink.offsets.size(); ++i)
+    {
+        EXPECT_EQ(i * 100, sink.offsets[i]);
+    }
+    ASSERT_EQ(static_cast<size_t>(1000), sink.payload.size());
+    EXPECT_EQ('j', sink.payload[999]);
+}
+
+TEST_F(CABlockWiseTransferF, DeclinedStreamIsBuffered)
+{
+    StreamSink sink;
+    sink.result = CA_NOT_SUPPORTED;
+    CASetBlockWriteCallback(writeStream, &sink);
+
+    CABlockData_t *blockData = createBlockData(1);
+    ASSERT_TRUE(blockData != NULL);
+
+    unsigned char block[100];
+    memset(block, 'x', sizeof(block));
+    ASSERT_EQ(CA_STATUS_OK, addBlock(blockData, block, sizeof(block), false));
+    ASSERT_EQ(CA_STATUS_OK, addBlock(blockData, block, sizeof(block), false));
+
+    EXPECT_FALSE(blockData->streamed);
+    ASSERT_TRUE(blockData->payload != NULL);
+    EXPECT_EQ(static_cast<size_t>(200), blockData->receivedPayloadLen);
+}
@@ -552,3 +552,220 @@ TEST(ConditionTests, TC_07_WAITDURATION)
 
     ca_cond_free(sharedCond);
 }
+
+typedef struct _tagPoolGate
+{
+    ca_mutex mutex;
+    ca_cond cond;
+    bool open;
+    int ran;
+} _pool_gate_struct;
+
+// Blocks until the gate is opened, then counts itself.
+void gatedFunc(void *context)
+{
+    _pool_gate_struct* pData = (_pool_gate_struct*) context;
+
+    ca_mutex_lock(pData->mutex);
+    while (!pData->open)
+    {
+        ca_cond_wait(pData->cond, pData->mutex);
+    }
+    pData->ran++;
+    ca_mutex_unlock(pData->mutex);
+}
+
+void openGate(_pool_gate_struct* pData)
+{
+    ca_mutex_lock(pData->mutex);
+    pData->open = true;
+    ca_cond_broadcast(pData->cond);
+    ca_mutex_unlock(pData->mutex);
+}
+
+// Waits until the pool has a task running and none queued.
+void waitForPoolBusy(ca_thread_pool_t pool)
+{
+    ca_thread_pool_stats_t stats;
+    do
+    {
+        usleep(MINIMAL_LOOP_SLEEP * USECS_PER_MSEC);
+        ca_thread_pool_get_stats(pool, &stats);
+    } while (stats.busy_threads == 0 || stats.queue_depth != 0);
+}
+
+TEST(ThreadPoolTests, TC_01_QUEUE_FULL_REJECTS)
+{
+    ca_thread_pool_config_t config = { 1, 2, CA_THREAD_POOL_REJECT, 0 };
+    ca_thread_pool_t mythreadpool;
+    _pool_gate_struct pData = { ca_mutex_new(), ca_cond_new(), false, 0 };
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init_with_config(&config, &mythreadpool));
+
+    // one task keeps the only worker busy, two fill the queue
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+    waitForPoolBusy(mythreadpool);
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+    EXPECT_EQ(CA_STATUS_FAILED, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+
+    ca_thread_pool_stats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_get_stats(mythreadpool, &stats));
+    EXPECT_EQ(1u, stats.num_threads);
+    EXPECT_EQ(2u, stats.queue_depth);
+    EXPECT_EQ(3u, stats.tasks_submitted);
+    EXPECT_EQ(1u, stats.tasks_rejected);
+
+    openGate(&pData);
+    ca_thread_pool_free(mythreadpool);
+
+    EXPECT_EQ(3, pData.ran);
+
+    ca_mutex_free(pData.mutex);
+    ca_cond_free(pData.cond);
+}
+
+TEST(ThreadPoolTests, TC_02_QUEUE_FULL_CALLER_RUNS)
+{
+    ca_thread_pool_config_t config = { 1, 1, CA_THREAD_POOL_CALLER_RUNS, 0 };
+    ca_thread_pool_t mythreadpool;
+    _pool_gate_struct pData = { ca_mutex_new(), ca_cond_new(), false, 0 };
+    _pool_gate_struct pOpen = { ca_mutex_new(), ca_cond_new(), true, 0 };
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init_with_config(&config, &mythreadpool));
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+    waitForPoolBusy(mythreadpool);
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+
+    // the queue is full, so this one has run by the time the call returns
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pOpen));
+    EXPECT_EQ(1, pOpen.ran);
+
+    ca_thread_pool_stats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_get_stats(mythreadpool, &stats));
+    EXPECT_EQ(1u, stats.tasks_caller_runs);
+
+    openGate(&pData);
+    ca_thread_pool_free(mythreadpool);
+
+    EXPECT_EQ(2, pData.ran);
+
+    ca_mutex_free(pData.mutex);
+    ca_cond_free(pData.cond);
+    ca_mutex_free(pOpen.mutex);
+    ca_cond_free(pOpen.cond);
+}
+
+TEST(ThreadPoolTests, TC_03_FREE_RUNS_QUEUED_TASKS)
+{
+    const int TASKS = 200;
+    ca_thread_pool_config_t config = { 3, TASKS, CA_THREAD_POOL_REJECT, 0 };
+    ca_thread_pool_t mythreadpool;
+    _pool_gate_struct pData = { ca_mutex_new(), ca_cond_new(), true, 0 };
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init_with_config(&config, &mythreadpool));
+
+    for (int i = 0; i < TASKS; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+    }
+
+    ca_thread_pool_stats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_get_stats(mythreadpool, &stats));
+    EXPECT_GE(3u, stats.num_threads);
+    EXPECT_EQ((uint64_t) TASKS, stats.tasks_submitted);
+
+    ca_thread_pool_free(mythreadpool);
+
+    EXPECT_EQ(TASKS, pData.ran);
+
+    ca_mutex_free(pData.mutex);
+    ca_cond_free(pData.cond);
+}
+
+typedef struct _tagPoolSubmit
+{
+    ca_thread_pool_t pool;
+    _pool_gate_struct* gate;
+    volatile bool submitted;
+} _pool_submit_struct;
+
+void submitFunc(void *context)
+{
+    _pool_submit_struct* pData = (_pool_submit_struct*) context;
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pData->pool, gatedFunc, pData->gate));
+    pData->submitted = true;
+}
+
+TEST(ThreadPoolTests, TC_04_QUEUE_FULL_BLOCKS)
+{
+    ca_thread_pool_config_t config = { 1, 1, CA_THREAD_POOL_BLOCK, 0 };
+    ca_thread_pool_t mythreadpool;
+    ca_thread_pool_t submitter;
+    _pool_gate_struct pData = { ca_mutex_new(), ca_cond_new(), false, 0 };
+    _pool_submit_struct pSubmit = { NULL, &pData, false };
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init_with_config(&config, &mythreadpool));
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &submitter));
+    pSubmit.pool = mythreadpool;
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+    waitForPoolBusy(mythreadpool);
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pData));
+
+    // the third task waits for room in the queue
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(submitter, submitFunc, &pSubmit));
+    usleep(MINIMAL_EXTRA_SLEEP * USECS_PER_MSEC);
+    EXPECT_FALSE(pSubmit.submitted);
+
+    openGate(&pData);
+    ca_thread_pool_free(submitter);
+    EXPECT_TRUE(pSubmit.submitted);
+    ca_thread_pool_free(mythreadpool);
+
+    EXPECT_EQ(3, pData.ran);
+
+    ca_mutex_free(pData.mutex);
+    ca_cond_free(pData.cond);
+}
+
+TEST(ThreadPoolTests, TC_05_LONG_RUNNING_TASK_KEEPS_WORKERS_FREE)
+{
+    ca_thread_pool_config_t config = { 1, 1, CA_THREAD_POOL_REJECT, 0 };
+    ca_thread_pool_t mythreadpool;
+    _pool_gate_struct pLoop = { ca_mutex_new(), ca_cond_new(), false, 0 };
+    _pool_gate_struct pOpen = { ca_mutex_new(), ca_cond_new(), true, 0 };
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init_with_config(&config, &mythreadpool));
+
+    // the loop has a thread of its own, so the only worker still runs the task
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_long_running_task(mythreadpool, gatedFunc, &pLoop));
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(mythreadpool, gatedFunc, &pOpen));
+
+    ca_thread_pool_stats_t stats;
+    for (int i = 0; i < 250; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_get_stats(mythreadpool, &stats));
+        if (1u == stats.tasks_completed)
+        {
+            break;
+        }
+        usleep(MINIMAL_LOOP_SLEEP * USECS_PER_MSEC);
+    }
+    EXPECT_EQ(1u, stats.tasks_completed);
+    EXPECT_EQ(1u, stats.num_threads);
+    EXPECT_EQ(1u, stats.dedicated_threads);
+
+    openGate(&pLoop);
+    ca_thread_pool_free(mythreadpool);
+
+    EXPECT_EQ(1, pLoop.ran);
+    EXPECT_EQ(1, pOpen.ran);
+
+    ca_mutex_free(pLoop.mutex);
+    ca_cond_free(pLoop.cond);
+    ca_mutex_free(pOpen.mutex);
+    ca_cond_free(pOpen.cond);
+}
@@ -186,3 +186,141 @@ TEST(CAProtocolMessage, CAParseURILongPath)
     verifyParsedOptions(cases, numCases, optlist);
     coap_delete_list(optlist);
 }
+
+namespace {
+
+/**
+ * Generates a PDU and returns its bytes and options. The endpoint is BLE,
+ * for which CAGeneratePDU adds the options itself rather than leaving them to
+ * block-wise transfer.
+ */
+std::string generatePDU(const CAInfo_t &info, std::string &options, size_t &maxSize)
+{
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_GATT_BTLE;
+
+    coap_list_t *optlist = NULL;
+    coap_transport_type transport;
+    coap_pdu_t *pdu = CAGeneratePDU(CA_GET, &info, &endpoint, &optlist, &transport);
+    EXPECT_TRUE(pdu != NULL);
+
+    options.clear();
+    for (coap_list_t *opt = optlist; opt; opt = opt->next)
+    {
+        coap_option *option = (coap_option *) opt->data;
+        options += std::to_string(COAP_OPTION_KEY(*option)) + "="
+                + std::string((const char *) COAP_OPTION_DATA(*option),
+                              COAP_OPTION_LENGTH(*option)) + ";";
+    }
+    coap_delete_list(optlist);
+
+    std::string bytes;
+    maxSize = 0;
+    if (pdu)
+    {
+        bytes.assign((const char *) pdu->hdr, pdu->length);
+        maxSize = pdu->max_size;
+        coap_delete_pdu(pdu);
+    }
+    return bytes;
+}
+
+class CAPDUTemplateTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        memset(&m_option, 0, sizeof(m_option));
+        m_option.protocolID = CA_COAP_ID;
+        m_option.optionID = 2048;
+        m_option.optionLength = 1;
+        m_option.optionData[0] = '1';
+
+        memset(&m_info, 0, sizeof(m_info));
+        m_info.type = CA_MSG_NONCONFIRM;
+        m_info.messageId = 42;
+        m_info.token = m_token;
+        m_info.tokenLength = sizeof(m_token) - 1;
+        m_info.options = &m_option;
+        m_info.numOptions = 1;
+        m_info.payload = (CAPayload_t) m_payload;
+        m_info.payloadSize = sizeof(m_payload) - 1;
+        m_info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+        m_info.acceptFormat = CA_FORMAT_APPLICATION_CBOR;
+        m_info.resourceUri = m_uri;
+    }
+
+    virtual void TearDown()
+    {
+        CATerminatePDUTemplates();
+    }
+
+    char m_token[9] = "abcdefgh";
+    char m_payload[8] = "payload";
+    char m_uri[42] = "/a/light?if=oic.if.baseline;rt=core.light";
+    CAHeaderOption_t m_option;
+    CAInfo_t m_info;
+};
+
+} // namespace
+
+TEST_F(CAPDUTemplateTest, MatchesParsedOptions)
+{
+    std::string parsedOptions;
+    size_t maxSize = 0;
+    std::string parsed = generatePDU(m_info, parsedOptions, maxSize);
+    ASSERT_FALSE(parsed.empty());
+
+    ASSERT_EQ(CA_STATUS_OK, CAInitializePDUTemplates());
+    for (int i = 0; i < 3; i++)
+    {
+        // parsed into the template the first time, from the template after
+        std::string options;
+        EXPECT_EQ(parsed, generatePDU(m_info, options, maxSize));
+        EXPECT_EQ(parsedOptions, options);
+    }
+}
+
+TEST_F(CAPDUTemplateTest, KeyedByQueryAndHeaderOptions)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializePDUTemplates());
+
+    std::string first;
+    size_t maxSize = 0;
+    generatePDU(m_info, first, maxSize);
+
+    char otherUri[] = "/a/light?if=oic.if.baseline;rt=core.lamp";
+    m_info.resourceUri = otherUri;
+    std::string query;
+    generatePDU(m_info, query, maxSize);
+    EXPECT_NE(first, query);
+    EXPECT_NE(std::string::npos, query.find("rt=core.lamp"));
+
+    m_info.resourceUri = m_uri;
+    m_option.optionData[0] = '2';
+    std::string header;
+    generatePDU(m_info, header, maxSize);
+    EXPECT_NE(first, header);
+    EXPECT_NE(std::string::npos, header.find("2048=2;"));
+}
+
+TEST_F(CAPDUTemplateTest, SizedToMessage)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializePDUTemplates());
+
+    std::string options;
+    size_t maxSize = 0;
+    std::string bytes = generatePDU(m_info, options, maxSize);
+    EXPECT_LT(maxSize, (size_t) COAP_MAX_PDU_SIZE);
+    EXPECT_LE(bytes.size(), maxSize);
+    EXPECT_NE(std::string::npos, bytes.find(m_payload));
+
+    // a payload filling a PDU still fits in one
+    std::string large(COAP_MAX_PDU_SIZE - bytes.size() + m_info.payloadSize - 16, 'x');
+    m_info.payload = (CAPayload_t) large.c_str();
+    m_info.payloadSize = large.size();
+    bytes = generatePDU(m_info, options, maxSize);
+    EXPECT_EQ((size_t) COAP_MAX_PDU_SIZE, maxSize);
+    EXPECT_NE(std::string::npos, bytes.find(large));
+}
@@ -26,6 +26,7 @@
 #include <stdarg.h>
 #include "oc_logger.h"
 #include "oc_console_logger.h"
+#include "oic_log.h"
 
 #ifdef __ANDROID__
     #include <android/log.h>
@@ -55,6 +56,14 @@ extern "C" {
 // Max buffer size used in variable argument log function
 #define MAX_LOG_V_BUFFER_SIZE (256)
 
+// Lowest level compiled in, e.g. -DOC_LOG_MIN_LEVEL=2 leaves out DEBUG and INFO
+// messages. Above it the levels output are set at runtime per tag with
+// OICLogSetTagLevel, and disabled messages are neither formatted nor have
+// their arguments evaluated.
+#ifndef OC_LOG_MIN_LEVEL
+#define OC_LOG_MIN_LEVEL (0)
+#endif
+
 #ifdef WIN32
 #undef ERROR
 #endif
@@ -174,9 +183,9 @@ typedef enum {
     #define OC_LOG_BUFFER(level, tag, buffer, bufferSize)
 #else // These macros are defined for Linux, Android, and Arduino
     #define OC_LOG_INIT()    OCLogInit()
-    #define OC_LOG_BUFFER(level, tag, buffer, bufferSize)  OCLogBuffer((level), PCF(tag), (buffer), (bufferSize))
 
     #ifdef ARDUINO
+        #define OC_LOG_BUFFER(level, tag, buffer, bufferSize)  OCLogBuffer((level), PCF(tag), (buffer), (bufferSize))
         #define OC_LOG_CONFIG(ctx)
         #define OC_LOG_SHUTDOWN()
         #define OC_LOG(level, tag, logStr)  OCLog((level), PCF(tag), PCF(logStr))
@@ -185,11 +194,18 @@ typedef enum {
         // Don't define variable argument log function for Arduino
         #define OC_LOG_V(level, tag, format, ...) OCLogv((level), PCF(tag), PCF(format), __VA_ARGS__)
     #else
+        #define OC_LOG_ENABLED(level, tag) \
+            ((int)(level) >= OC_LOG_MIN_LEVEL && OICLogIsEnabled((level), (tag)))
         #define OC_LOG_CONFIG(ctx)    OCLogConfig((ctx))
-        #define OC_LOG(level, tag, logStr)  OCLog((level), (tag), (logStr))
+        #define OC_LOG(level, tag, logStr) \
+            do { if (OC_LOG_ENABLED((level), (tag))) OCLog((level), (tag), (logStr)); } while (0)
         #define OC_LOG_SHUTDOWN()     OCLogShutdown()
         // Define variable argument log function for Linux and Android
-        #define OC_LOG_V(level, tag, ...)  OCLogv((level), (tag), __VA_ARGS__)
+        #define OC_LOG_V(level, tag, ...) \
+            do { if (OC_LOG_ENABLED((level), (tag))) OCLogv((level), (tag), __VA_ARGS__); } while (0)
+        #define OC_LOG_BUFFER(level, tag, buffer, bufferSize) \
+            do { if (OC_LOG_ENABLED((level), (tag))) \
+                OCLogBuffer((level), (tag), (buffer), (bufferSize)); } while (0)
     #endif
 #endif
 #else
@@ -54,6 +54,7 @@
 #include "string.h"
 #include "oc_logger.h"
 #include "oc_console_logger.h"
+#include "oic_log.h"
 
 #ifndef __TIZEN__
 static oc_log_ctx_t *logCtx = 0;
@@ -103,6 +104,8 @@ void OCLogInit() {
 }
 
 void OCLogShutdown() {
+    // the writer thread may still write through logCtx
+    OICLogStopAsync();
 #if defined(__linux__) || defined(__APPLE__)
     if (logCtx && logCtx->destroy)
     {
@@ -111,26 +114,6 @@ void OCLogShutdown() {
 #endif
 }
 
-/**
- * Output a variable argument list log string with the specified priority level.
- * Only defined for Linux and Android
- *
- * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
- * @param tag    - Module name
- * @param format - variadic log string
- */
-void OCLogv(LogLevel level, const char * tag, const char * format, ...) {
-    if (!format || !tag) {
-        return;
-    }
-    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
-    va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, sizeof buffer - 1, format, args);
-    va_end(args);
-    OCLog(level, tag, buffer);
-}
-
 static void osalGetTime(int *min,int *sec, int *ms)
 {
     if (min && sec && ms)
@@ -165,20 +148,23 @@ static void osalGetTime(int *min,int *sec, int *ms)
     }
 }
 
+// Milliseconds within the hour, what the log lines show
+static uint32_t osalGetTimestamp(void)
+{
+    int min = 0;
+    int sec = 0;
+    int ms = 0;
+    osalGetTime(&min, &sec, &ms);
+    return (uint32_t)((min * 60 + sec) * 1000 + ms);
+}
+
 /**
- * Output a log string with the specified priority level.
- * Only defined for Linux and Android
- *
- * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
- * @param tag    - Module name
- * @param logStr - log string
+ * Write a log string out on the calling thread, or on the writer thread of
+ * the log ring.
  */
-void OCLog(LogLevel level, const char * tag, const char * logStr) {
-    if (!logStr || !tag) {
-        return;
-    }
-
+static void OCLogWrite(LogLevel level, const char * tag, const char * logStr, uint32_t timestamp) {
 #ifdef __ANDROID__
+    (void)timestamp;
     __android_log_write(LEVEL[level], tag, logStr);
 #elif defined(__linux__) || defined(__APPLE__) || defined(WIN32)
     if (logCtx && logCtx->write_level)
@@ -187,18 +173,73 @@ void OCLog(LogLevel level, const char * tag, const char * logStr) {
     }
     else
     {
-        int min = 0;
-        int sec = 0;
-        int ms = 0;
-        osalGetTime(&min,&sec,&ms);
+        int min = timestamp / 60000;
+        int sec = (timestamp / 1000) % 60;
+        int ms = timestamp % 1000;
 
         printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
     }
 #endif
 }
 
+static void OCLogWriteRecord(const OICLogRecord *record) {
+    OCLogWrite((LogLevel)record->level, record->tag, record->message, record->timestamp);
+}
+
+// Queue the string for the writer thread when there is one
+static void OCLogOutput(LogLevel level, const char * tag, const char * logStr) {
+    uint32_t timestamp = osalGetTimestamp();
+    if (!OICLogWriteAsync(OCLogWriteRecord, level, timestamp, tag, logStr))
+    {
+        OCLogWrite(level, tag, logStr, timestamp);
+    }
+}
+
+/**
+ * Output a variable argument list log string with the specified priority level.
+ * Only defined for Linux and Android
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @param tag    - Module name
+ * @param format - variadic log string
+ */
+void OCLogv(LogLevel level, const char * tag, const char * format, ...) {
+    if (!format || !tag) {
+        return;
+    }
+    // Nothing is formatted for a disabled level
+    if (!OICLogIsEnabled(level, tag)) {
+        return;
+    }
+    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof buffer - 1, format, args);
+    va_end(args);
+    OCLogOutput(level, tag, buffer);
+}
+
+/**
+ * Output a log string with the specified priority level.
+ * Only defined for Linux and Android
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @param tag    - Module name
+ * @param logStr - log string
+ */
+void OCLog(LogLevel level, const char * tag, const char * logStr) {
+    if (!logStr || !tag) {
+        return;
+    }
+    if (!OICLogIsEnabled(level, tag)) {
+        return;
+    }
+    OCLogOutput(level, tag, logStr);
+}
+
 /**
  * Output the contents of the specified buffer (in hex) with the specified priority level.
+ * Only one buffer out of the interval set with OICLogSetBufferSampling is output.
  *
  * @param level      - DEBUG, INFO, WARNING, ERROR, FATAL
  * @param tag        - Module name
@@ -209,7 +250,9 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
     if (!buffer || !tag || (bufferSize == 0)) {
         return;
     }
-
+    if (!OICLogIsEnabled(level, tag) || !OICLogSampleBuffer()) {
+        return;
+    }
     // No idea why the static initialization won't work here, it seems the compiler is convinced
     // that this is a variable-sized object.
     char lineBuffer[LINE_BUFFER_SIZE];
@@ -222,14 +265,14 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
         lineIndex++;
         // Output 16 values per line
         if (((i+1)%16) == 0) {
-            OCLog(level, tag, lineBuffer);
+            OCLogOutput(level, tag, lineBuffer);
             memset(lineBuffer, 0, sizeof lineBuffer);
             lineIndex = 0;
         }
     }
     // Output last values in the line, if any
     if (bufferSize % 16) {
-        OCLog(level, tag, lineBuffer);
+        OCLogOutput(level, tag, lineBuffer);
     }
 }
 #endif //__TIZEN__
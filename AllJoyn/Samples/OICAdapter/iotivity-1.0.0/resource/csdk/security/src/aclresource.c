@@ -234,7 +234,7 @@ OicSecAcl_t * JSONToAclBin(const char * jsonStr)
 
     VERIFY_NON_NULL(TAG, jsonStr, ERROR);
 
-    jsonRoot = cJSON_Parse(jsonStr);
+    jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonAclArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_ACL_NAME);
@@ -411,7 +411,7 @@ static bool UpdatePersistentStorage(const OicSecAcl_t *acl)
     char *jsonStr = BinToAclJSON(acl);
     if (jsonStr)
     {
-        cJSON *jsonAcl = cJSON_Parse(jsonStr);
+        cJSON *jsonAcl = cJSON_ParseArena(jsonStr);
         OICFree(jsonStr);
 
         if ((jsonAcl) && (OC_STACK_OK == UpdateSVRDatabase(OIC_JSON_ACL_NAME, jsonAcl)))
@@ -1002,7 +1002,7 @@ OCStackResult InstallNewACL(const char* newJsonStr)
         char *jsonStr = BinToAclJSON(gAcl);
         if (jsonStr)
         {
-            cJSON *jsonAcl = cJSON_Parse(jsonStr);
+            cJSON *jsonAcl = cJSON_ParseArena(jsonStr);
             OICFree(jsonStr);
 
             if (jsonAcl)
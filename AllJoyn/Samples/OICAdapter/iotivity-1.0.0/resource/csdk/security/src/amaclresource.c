@@ -172,7 +172,7 @@ OicSecAmacl_t * JSONToAmaclBin(const char * jsonStr)
 
     VERIFY_NON_NULL(TAG, jsonStr, ERROR);
 
-    jsonRoot = cJSON_Parse(jsonStr);
+    jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonAmaclArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_AMACL_NAME);
@@ -279,7 +279,7 @@ static OCEntityHandlerResult HandleAmaclPostRequest (const OCEntityHandlerReques
         char *jsonStr = BinToAmaclJSON(gAmacl);
         if (jsonStr)
         {
-            cJSON *jsonAmacl = cJSON_Parse(jsonStr);
+            cJSON *jsonAmacl = cJSON_ParseArena(jsonStr);
             OICFree(jsonStr);
 
             if ((jsonAmacl) &&
@@ -241,7 +241,7 @@ OicSecCred_t * JSONToCredBin(const char * jsonStr)
     OicSecCred_t * prevCred = NULL;
     cJSON *jsonCredArray = NULL;
 
-    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonCredArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_CRED_NAME);
@@ -486,7 +486,7 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
     char *jsonStr = BinToCredJSON(cred);
     if (jsonStr)
     {
-        cJSON *jsonCred = cJSON_Parse(jsonStr);
+        cJSON *jsonCred = cJSON_ParseArena(jsonStr);
         OICFree(jsonStr);
 
         if ((jsonCred) &&
@@ -138,7 +138,7 @@ OicSecCrl_t *JSONToCrlBin(const char * jsonStr)
     uint32_t outLen = 0;
     B64Result b64Ret = B64_OK;
 
-    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonCrl = cJSON_GetObjectItem(jsonRoot, OIC_JSON_CRL_NAME);
@@ -250,7 +250,7 @@ OCStackResult UpdateCRLResource(const OicSecCrl_t *crl)
         return OC_STACK_ERROR;
     }
 
-    cJSON *jsonObj = cJSON_Parse(jsonStr);
+    cJSON *jsonObj = cJSON_ParseArena(jsonStr);
     OICFree(jsonStr);
 
     if (jsonObj == NULL)
@@ -275,7 +275,7 @@ static OCEntityHandlerResult HandleCRLPostRequest(const OCEntityHandlerRequest *
         OC_LOG(INFO, TAG, "UpdateSVRDB...");
         OC_LOG_V(INFO, TAG, "crl: \"%s\"", jsonCRL);
 
-        cJSON *jsonObj = cJSON_Parse(jsonCRL);
+        cJSON *jsonObj = cJSON_ParseArena(jsonCRL);
         OicSecCrl_t *crl = NULL;
         crl = JSONToCrlBin(jsonCRL);
         if (!crl)
@@ -186,7 +186,7 @@ OicSecDoxm_t * JSONToDoxmBin(const char * jsonStr)
     uint32_t outLen = 0;
     B64Result b64Ret = B64_OK;
 
-    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonDoxm = cJSON_GetObjectItem(jsonRoot, OIC_JSON_DOXM_NAME);
@@ -342,7 +342,7 @@ static bool UpdatePersistentStorage(OicSecDoxm_t * doxm)
         char *jsonStr = BinToDoxmJSON(doxm);
         if (jsonStr)
         {
-            cJSON *jsonDoxm = cJSON_Parse(jsonStr);
+            cJSON *jsonDoxm = cJSON_ParseArena(jsonStr);
             OICFree(jsonStr);
 
             if (jsonDoxm &&
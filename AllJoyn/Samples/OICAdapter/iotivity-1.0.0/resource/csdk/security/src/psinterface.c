@@ -134,8 +134,8 @@ OCStackResult UpdateSVRDatabase(const char* rsrcName, cJSON* jsonObj)
     char* jsonSVRDbStr = GetSVRDatabase();
     VERIFY_NON_NULL(TAG,jsonSVRDbStr, ERROR);
 
-    // Use cJSON_Parse to parse the existing SVR database
-    jsonSVRDb = cJSON_Parse(jsonSVRDbStr);
+    // Parse the existing SVR database into an arena, which cJSON_Delete frees at once
+    jsonSVRDb = cJSON_ParseArena(jsonSVRDbStr);
     VERIFY_NON_NULL(TAG,jsonSVRDb, ERROR);
 
     OICFree(jsonSVRDbStr);
@@ -149,8 +149,8 @@ OCStackResult UpdateSVRDatabase(const char* rsrcName, cJSON* jsonObj)
     }
     else if (jsonObj->child )
     {
-        // Create a duplicate of the JSON object which was passed.
-        cJSON* jsonDuplicateObj = cJSON_Duplicate(jsonObj, 1);
+        // Create a duplicate of the SVR in the JSON object which was passed.
+        cJSON* jsonDuplicateObj = cJSON_Duplicate(jsonObj->child, 1);
         VERIFY_NON_NULL(TAG,jsonDuplicateObj, ERROR);
 
         cJSON* jsonObj = cJSON_GetObjectItem(jsonSVRDb, rsrcName);
@@ -163,14 +163,14 @@ OCStackResult UpdateSVRDatabase(const char* rsrcName, cJSON* jsonObj)
                                                                                     && (!jsonObj))
         {
             // Add the fist cred object in existing SVR database json
-            cJSON_AddItemToObject(jsonSVRDb, rsrcName, jsonDuplicateObj->child);
+            cJSON_AddItemToObject(jsonSVRDb, rsrcName, jsonDuplicateObj);
         }
         else
         {
             VERIFY_NON_NULL(TAG,jsonObj, ERROR);
 
             // Replace the modified json object in existing SVR database json
-            cJSON_ReplaceItemInObject(jsonSVRDb, rsrcName, jsonDuplicateObj->child);
+            cJSON_ReplaceItemInObject(jsonSVRDb, rsrcName, jsonDuplicateObj);
         }
     }
 
@@ -125,7 +125,7 @@ OicSecPstat_t * JSONToPstatBin(const char * jsonStr)
     uint32_t outLen = 0;
     B64Result b64Ret = B64_OK;
 
-    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, INFO);
 
     jsonPstat = cJSON_GetObjectItem(jsonRoot, OIC_JSON_PSTAT_NAME);
@@ -267,12 +267,13 @@ static OCEntityHandlerResult HandlePstatPutRequest(const OCEntityHandlerRequest
         char *jsonStr = BinToPstatJSON(gPstat);
         if (jsonStr)
         {
-            cJSON *jsonPstat = cJSON_Parse(jsonStr);
+            cJSON *jsonPstat = cJSON_ParseArena(jsonStr);
             OICFree(jsonStr);
             if (OC_STACK_OK == UpdateSVRDatabase(OIC_JSON_PSTAT_NAME, jsonPstat))
             {
                 ehRet = OC_EH_OK;
             }
+            cJSON_Delete(jsonPstat);
         }
     }
  exit:
@@ -137,7 +137,7 @@ OicSecSvc_t * JSONToSvcBin(const char * jsonStr)
 
     VERIFY_NON_NULL(TAG, jsonStr, ERROR);
 
-    jsonRoot = cJSON_Parse(jsonStr);
+    jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonSvcArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_SVC_NAME);
@@ -259,7 +259,7 @@ static OCEntityHandlerResult HandleSVCPostRequest (const OCEntityHandlerRequest
         char *jsonStr = BinToSvcJSON(gSvc);
         if (jsonStr)
         {
-            cJSON *jsonSvc = cJSON_Parse(jsonStr);
+            cJSON *jsonSvc = cJSON_ParseArena(jsonStr);
             OICFree(jsonStr);
 
             if ((jsonSvc) &&
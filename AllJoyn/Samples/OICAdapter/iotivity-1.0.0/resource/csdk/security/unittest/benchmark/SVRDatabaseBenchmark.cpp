@@ -0,0 +1,235 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Time the cJSON work the SRM does on an SVR database, for databases of a
+// growing number of ACEs and credentials laid out as oic_svr_db_server.json:
+//  - cJSON_Parse and cJSON_ParseArena of the whole database, then delete,
+//  - reading every ACE and credential the way JSONToAclBin and
+//    JSONToCredBin do,
+//  - cJSON_PrintUnformatted of the whole database,
+//  - one UpdateSVRDatabase cycle: parse, replace the ACL, print, delete.
+// A database file given on the command line is timed as well.
+//
+// Usage: svr_database_benchmark [milliseconds per case] [SVR database file]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+
+extern "C"
+{
+    #include "cJSON.h"
+    #include "srmresourcestrings.h"
+}
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double g_milliseconds = 500;
+
+    std::string createDatabase(int entries)
+    {
+        char buffer[512];
+        std::string db = "{\"acl\": [";
+        for (int i = 0; i < entries; ++i)
+        {
+            snprintf(buffer, sizeof(buffer),
+                    "%s{\"sub\": \"MjIyMjIyMjIyMjIy%04d==\", "
+                    "\"rsrc\": [\"/a/led/%d\", \"/oic/sec/acl\", \"/oic/sec/cred\"], "
+                    "\"perms\": %d, "
+                    "\"prds\": [\"20150630T060000/20150630T220000\"], "
+                    "\"recurs\": [\"FREQ=DAILY; BYDAY=MO, WE, FR\"], "
+                    "\"ownrs\": [\"MjIyMjIyMjIyMjIyMjIyMg==\"]}",
+                    i ? ", " : "", i, i, 2 + i % 5);
+            db += buffer;
+        }
+        db += "], \"pstat\": {\"isop\": true, \"deviceid\": \"ZGV2aWNlaWQAAAAAABhanw==\", "
+              "\"ch\": 0, \"cm\": 0, \"tm\": 0, \"om\": 3, \"sm\": [3]}, "
+              "\"doxm\": {\"oxm\": [0], \"oxmsel\": 0, \"sct\": 1, \"owned\": true, "
+              "\"deviceid\": \"MTExMTExMTExMTExMTExMQ==\", \"ownr\": \"YWRtaW5EZXZpY2VVVUlEAA==\"}, "
+              "\"cred\": [";
+        for (int i = 0; i < entries; ++i)
+        {
+            snprintf(buffer, sizeof(buffer),
+                    "%s{\"credid\": %d, \"sub\": \"MTExMTIyMjIz%04d==\", \"credtyp\": 1, "
+                    "\"pvdata\": \"QUFBQUFBQUFBQUFBQUFBQQ==\", "
+                    "\"ownrs\": [\"MjIyMjIyMjIyMjIyMjIyMg==\"]}",
+                    i ? ", " : "", i + 1, i);
+            db += buffer;
+        }
+        db += "]}";
+        return db;
+    }
+
+    // reads every member of an array of objects, returns the number of items read
+    int readEntries(cJSON* array, std::initializer_list<const char*> names)
+    {
+        int items = 0;
+        for (cJSON* entry = array ? array->child : NULL; entry; entry = entry->next)
+        {
+            for (const char* name : names)
+            {
+                cJSON* item = cJSON_GetObjectItem(entry, name);
+                items += item ? 1 + cJSON_GetArraySize(item) : 0;
+            }
+        }
+        return items;
+    }
+
+    int readDatabase(cJSON* db)
+    {
+        return readEntries(cJSON_GetObjectItem(db, OIC_JSON_ACL_NAME),
+                    { OIC_JSON_SUBJECT_NAME, OIC_JSON_RESOURCES_NAME, OIC_JSON_PERMISSION_NAME,
+                      OIC_JSON_PERIODS_NAME, OIC_JSON_RECURRENCES_NAME, OIC_JSON_OWNERS_NAME }) +
+               readEntries(cJSON_GetObjectItem(db, OIC_JSON_CRED_NAME),
+                    { OIC_JSON_CREDID_NAME, OIC_JSON_SUBJECT_NAME, OIC_JSON_CREDTYPE_NAME,
+                      OIC_JSON_PRIVATEDATA_NAME, OIC_JSON_PUBLICDATA_NAME, OIC_JSON_OWNERS_NAME });
+    }
+
+    template <typename Operation>
+    bool time(const char* name, Operation operation)
+    {
+        long operations = 0;
+        auto start = Clock::now();
+        std::chrono::duration<double, std::milli> elapsed(0);
+        while (elapsed.count() < g_milliseconds)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                if (!operation())
+                {
+                    printf("%-24s : failed\n", name);
+                    return false;
+                }
+            }
+            operations += 8;
+            elapsed = Clock::now() - start;
+        }
+        printf("%-24s : %10.1f us\n", name, elapsed.count() * 1e3 / operations);
+        return true;
+    }
+
+    bool run(const std::string& db)
+    {
+        const char* text = db.c_str();
+        cJSON* parsed = cJSON_Parse(text);
+        cJSON* acl = parsed ? cJSON_GetObjectItem(parsed, OIC_JSON_ACL_NAME) : NULL;
+        if (!acl)
+        {
+            printf("the database does not parse or has no ACL\n");
+            cJSON_Delete(parsed);
+            return false;
+        }
+        // the ACL resource posts itself as {"acl": [...]}
+        cJSON* aclObject = cJSON_CreateObject();
+        cJSON_AddItemToObject(aclObject, OIC_JSON_ACL_NAME, cJSON_Duplicate(acl, 1));
+
+        bool ok =
+            time("parse", [&] {
+                cJSON* json = cJSON_Parse(text);
+                cJSON_Delete(json);
+                return json != NULL;
+            }) &&
+            time("parse, arena", [&] {
+                cJSON* json = cJSON_ParseArena(text);
+                cJSON_Delete(json);
+                return json != NULL;
+            }) &&
+            time("read entries", [&] { return readDatabase(parsed) > 0; }) &&
+            time("print", [&] {
+                char* out = cJSON_PrintUnformatted(parsed);
+                free(out);
+                return out != NULL;
+            }) &&
+            time("update cycle", [&] {
+                cJSON* json = cJSON_ParseArena(text);
+                if (!json)
+                {
+                    return false;
+                }
+                cJSON_ReplaceItemInObject(json, OIC_JSON_ACL_NAME,
+                                          cJSON_Duplicate(aclObject->child, 1));
+                char* out = cJSON_PrintUnformatted(json);
+                cJSON_Delete(json);
+                free(out);
+                return out != NULL;
+            });
+
+        cJSON_Delete(aclObject);
+        cJSON_Delete(parsed);
+        return ok;
+    }
+
+    bool readFile(const char* path, std::string& contents)
+    {
+        FILE* file = fopen(path, "rb");
+        if (!file)
+        {
+            return false;
+        }
+        char buffer[4096];
+        size_t bytes;
+        while ((bytes = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            contents.append(buffer, bytes);
+        }
+        fclose(file);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    g_milliseconds = argc > 1 ? atof(argv[1]) : 500;
+    if (g_milliseconds <= 0)
+    {
+        printf("usage: %s [milliseconds per case] [SVR database file]\n", argv[0]);
+        return 1;
+    }
+
+    for (int entries : { 8, 64, 512 })
+    {
+        std::string db = createDatabase(entries);
+        printf("%d ACEs and credentials, %u bytes\n", entries, (unsigned int)db.size());
+        if (!run(db))
+        {
+            return 1;
+        }
+    }
+    if (argc > 2)
+    {
+        std::string db;
+        if (!readFile(argv[2], db))
+        {
+            printf("cannot read %s\n", argv[2]);
+            return 1;
+        }
+        printf("%s, %u bytes\n", argv[2], (unsigned int)db.size());
+        if (!run(db))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
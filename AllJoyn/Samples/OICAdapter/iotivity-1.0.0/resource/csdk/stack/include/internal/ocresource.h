@@ -192,6 +192,9 @@ typedef struct OCResource {
     /** Points to next resource in list.*/
     struct OCResource *next;
 
+    /** Points to next resource in the same bucket of the URI index.*/
+    struct OCResource *uriIndexNext;
+
     /** Relative path on the device; will be combined with base url to create fully qualified path.*/
     char *uri;
 
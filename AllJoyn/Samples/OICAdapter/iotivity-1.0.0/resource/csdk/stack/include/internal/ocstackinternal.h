@@ -199,6 +199,15 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
  */
 OCStackResult HandleStackRequests(OCServerProtocolRequest * protocolRequest);
 
+/**
+ * Find a resource by its URI. The resources are indexed by URI, the time taken does not
+ * depend on the number of resources.
+ *
+ * @param uri           URI of the resource.
+ * @return Pointer to the resource, NULL if there is no resource with this URI.
+ */
+OCResource *lookupResourceUri(const char *uri);
+
 OCStackResult SendDirectStackResponse(const CAEndpoint_t* endPoint, const uint16_t coapID,
         const CAResponseResult_t responseResult, const CAMessageType_t type,
         const uint8_t numOptions, const CAHeaderOption_t *options,
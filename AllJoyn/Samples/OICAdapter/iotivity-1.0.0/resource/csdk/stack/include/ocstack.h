@@ -114,6 +114,22 @@ OCStackResult OCStopMulticastServer();
  */
 OCStackResult OCProcess();
 
+/**
+ * This function blocks until the stack has received a message for ::OCProcess to
+ * handle, or until the timeout expires.  It does not process anything itself and
+ * may be called without serializing with the other stack calls, so a processing
+ * loop can wait here instead of sleeping and call ::OCProcess when it returns.
+ *
+ * ::OCProcess also drives periodic work such as presence timeouts, so the timeout
+ * bounds how late that work is done.
+ *
+ * @param timeoutMs     Maximum time to wait in milliseconds, 0 to only check.
+ *
+ * @return ::OC_STACK_OK if a message is pending, ::OC_STACK_TIMEOUT if the timeout
+ *         expired first, some other value upon failure.
+ */
+OCStackResult OCProcessWait(uint32_t timeoutMs);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -222,7 +222,7 @@ bool ClientTokenExist(const CAToken_t token, uint8_t tokenLength)
     bool bRet = false;
     ClientCB* out = NULL;
 
-    if (token && *token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
+    if (token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
     {
         OC_LOG(INFO, TAG, "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
@@ -248,7 +248,7 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
 
     ClientCB* out = NULL;
 
-    if(token && *token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
+    if(token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
     {
         OC_LOG (INFO, TAG,  "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
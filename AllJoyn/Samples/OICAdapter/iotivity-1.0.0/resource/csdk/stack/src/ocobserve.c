@@ -377,7 +377,7 @@ OCStackResult AddObserver (const char         *resUri,
     }
     ResourceObserver *obsNode = NULL;
 
-    if(!resUri || !token || !*token)
+    if(!resUri || !token || !tokenLength)
     {
         return OC_STACK_INVALID_PARAM;
     }
@@ -447,7 +447,7 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
 {
     ResourceObserver *out = NULL;
 
-    if(token && *token)
+    if(token && tokenLength)
     {
         OC_LOG(INFO, TAG, "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
@@ -473,7 +473,7 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
 
 OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
 {
-    if(!token || !*token)
+    if(!token || !tokenLength)
     {
         return OC_STACK_INVALID_PARAM;
     }
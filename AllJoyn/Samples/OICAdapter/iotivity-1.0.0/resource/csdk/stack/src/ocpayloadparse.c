@@ -41,6 +41,9 @@
 
 #define TAG "OCPayloadParse"
 
+// Below this size a representation is walked faster than it is indexed
+#define CONTAINER_INDEX_MIN_SIZE 256
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue* arrayVal);
 static OCStackResult OCParseDevicePayload(OCPayload** outPayload, CborValue* arrayVal);
 static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* arrayVal);
@@ -69,6 +72,16 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
         return OC_STACK_MALFORMED_RESPONSE;
     }
 
+    // Representations nest objects in objects, and every lookup in a parent
+    // walks over its children; with their ends indexed, skipping one is a
+    // search instead. Discovery payloads are flat, many small containers
+    // that are cheaper to walk, as are small payloads. If indexing fails, the
+    // payload is malformed and parsing it reports where.
+    if (payloadType == PAYLOAD_TYPE_REPRESENTATION && payloadSize >= CONTAINER_INDEX_MIN_SIZE)
+    {
+        cbor_parser_index_containers(&parser, &rootValue);
+    }
+
     CborValue arrayValue;
     // enter the array
     err = err || cbor_value_enter_container(&rootValue, &arrayValue);
@@ -76,6 +89,7 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
     if(err)
     {
         OC_LOG_V(ERROR, TAG, "CBOR payload parse failed :%d", err);
+        cbor_parser_free_containers(&parser);
         return OC_STACK_MALFORMED_RESPONSE;
     }
 
@@ -114,7 +128,7 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
         err = err || cbor_value_leave_container(&rootValue, &arrayValue);
         if(err != CborNoError)
         {
-            return OC_STACK_MALFORMED_RESPONSE;
+            result = OC_STACK_MALFORMED_RESPONSE;
         }
     }
     else
@@ -122,6 +136,7 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
         OC_LOG_V(INFO, TAG, "Finished parse payload, result is %d", result);
     }
 
+    cbor_parser_free_containers(&parser);
     return result;
 }
 
@@ -590,37 +605,41 @@ static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* a
         {
              err = err || cbor_value_map_find_value(arrayVal, OC_RSRVD_REPRESENTATION, &curVal);
 
+            // one walk over the map for all the lookups
+            CborMapIndex repIndex = {0};
+            err = err || cbor_value_index_map(&curVal, &repIndex);
+
             CborValue repVal;
             // Platform ID
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_PLATFORM_ID, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_PLATFORM_ID, &repVal);
              if(cbor_value_is_valid(&repVal))
              {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.platformID), &len, NULL);
              }
 
             // MFG Name
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_MFG_NAME, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_MFG_NAME, &repVal);
              if(cbor_value_is_valid(&repVal))
              {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.manufacturerName), &len, NULL);
              }
 
             // MFG URL
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_MFG_URL, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_MFG_URL, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.manufacturerUrl), &len, NULL);
             }
 
             // Model Num
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_MODEL_NUM, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_MODEL_NUM, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.modelNumber), &len, NULL);
             }
 
             // Date of Mfg
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_MFG_DATE, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_MFG_DATE, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.dateOfManufacture), &len,
@@ -628,7 +647,7 @@ static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* a
             }
 
             // Platform Version
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_PLATFORM_VERSION, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_PLATFORM_VERSION, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.platformVersion), &len,
@@ -636,7 +655,7 @@ static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* a
             }
 
             // OS Version
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_OS_VERSION, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_OS_VERSION, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.operatingSystemVersion),
@@ -644,7 +663,7 @@ static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* a
             }
 
             // Hardware Version
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_HARDWARE_VERSION, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_HARDWARE_VERSION, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.hardwareVersion), &len,
@@ -652,7 +671,7 @@ static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* a
             }
 
             // Firmware Version
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_FIRMWARE_VERSION, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_FIRMWARE_VERSION, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.firmwareVersion), &len,
@@ -660,18 +679,19 @@ static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* a
             }
 
             // Support URL
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_SUPPORT_URL, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_SUPPORT_URL, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.supportUrl), &len, NULL);
             }
 
             // System Time
-             err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_SYSTEM_TIME, &repVal);
+             err = err || cbor_map_index_find_value(&repIndex, OC_RSRVD_SYSTEM_TIME, &repVal);
             if(cbor_value_is_valid(&repVal))
             {
                  err = err || cbor_value_dup_text_string(&repVal, &(info.systemTime), &len, NULL);
             }
+            cbor_map_index_free(&repIndex);
         }
 
          err = err || cbor_value_advance(arrayVal);
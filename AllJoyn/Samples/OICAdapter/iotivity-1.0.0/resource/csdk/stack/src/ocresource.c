@@ -338,17 +338,12 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCResource * pointer = lookupResourceUri(resourceUri);
+    if (!pointer)
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
-        {
-            return pointer;
-        }
-        pointer = pointer->next;
+        OC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
     }
-    OC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
+    return pointer;
 }
 
 
@@ -99,6 +99,15 @@ static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
 OCResource *headResource = NULL;
 static OCResource *tailResource = NULL;
+
+/**
+ * URI index of the resource list, a hash table chained through OCResource::uriIndexNext.
+ * Its size is a power of 2, and it is rebuilt from the list when it grows.
+ */
+static OCResource **resourceUriIndex = NULL;
+static size_t resourceUriIndexSize = 0;
+static size_t resourceUriIndexCount = 0;
+#define RESOURCE_URI_INDEX_MIN_SIZE 64
 #ifdef WITH_PRESENCE
 static OCPresenceState presenceState = OC_PRESENCE_UNINITIALIZED;
 static PresenceResource presenceResource;
@@ -161,6 +170,20 @@ static OCStackResult initResources();
  */
 static void insertResource(OCResource *resource);
 
+/**
+ * Add a resource whose URI is set to the URI index.
+ *
+ * @param resource Resource to be added
+ */
+static void indexResourceUri(OCResource *resource);
+
+/**
+ * Remove a resource from the URI index.
+ *
+ * @param resource Resource to be removed
+ */
+static void unindexResourceUri(OCResource *resource);
+
 /**
  * Find a resource in the linked list of resources.
  *
@@ -1666,11 +1689,15 @@ void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
 
     requestResult = HandleStackRequests (&serverRequest);
 
-    // Send ACK to client as precursor to slow response
+    // Send ACK to client as precursor to slow response; a NON request gets
+    // nothing until the response itself
     if(requestResult == OC_STACK_SLOW_RESOURCE)
     {
-        SendDirectStackResponse(endPoint, requestInfo->info.messageId, CA_EMPTY,
-                    CA_MSG_ACKNOWLEDGE,0, NULL, NULL, 0, NULL);
+        if(requestInfo->info.type == CA_MSG_CONFIRM)
+        {
+            SendDirectStackResponse(endPoint, requestInfo->info.messageId, CA_EMPTY,
+                        CA_MSG_ACKNOWLEDGE,0, NULL, NULL, 0, NULL);
+        }
     }
     else if(requestResult != OC_STACK_OK)
     {
@@ -2806,6 +2833,17 @@ OCStackResult OCProcess()
     return OC_STACK_OK;
 }
 
+OCStackResult OCProcessWait(uint32_t timeoutMs)
+{
+    if (stackState != OC_STACK_INITIALIZED)
+    {
+        OC_LOG(ERROR, TAG, "OCProcessWait: stack not initialized");
+        return OC_STACK_ERROR;
+    }
+
+    return CAResultToOCResult(CAWaitForRequestResponse(timeoutMs));
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OCStartPresence(const uint32_t ttl)
 {
@@ -2978,21 +3016,11 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    if (lookupResourceUri(uri))
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
@@ -3012,6 +3040,7 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         result = OC_STACK_NO_MEMORY;
         goto exit;
     }
+    indexResourceUri(pointer);
 
     // Set properties.  Set OC_ACTIVE
     pointer->resourceProperties = (OCResourceProperty) (resourceProperties
@@ -3783,6 +3812,109 @@ void insertResource(OCResource *resource)
     resource->next = NULL;
 }
 
+static uint32_t hashResourceUri(const char *uri)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*uri)
+    {
+        hash ^= (uint8_t) *uri++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void indexResourceUri(OCResource *resource)
+{
+    if (resourceUriIndexCount >= resourceUriIndexSize)
+    {
+        size_t size = resourceUriIndexSize ? resourceUriIndexSize * 2 : RESOURCE_URI_INDEX_MIN_SIZE;
+        OCResource **index = (OCResource **) OICCalloc(size, sizeof(OCResource *));
+        if (index)
+        {
+            // Rebuilt from the list, which holds the new resource already
+            OICFree(resourceUriIndex);
+            resourceUriIndex = index;
+            resourceUriIndexSize = size;
+            resourceUriIndexCount = 0;
+            OCResource *pointer = NULL;
+            for (pointer = headResource; pointer; pointer = pointer->next)
+            {
+                if (pointer->uri)
+                {
+                    uint32_t bucket = hashResourceUri(pointer->uri) & (size - 1);
+                    pointer->uriIndexNext = index[bucket];
+                    index[bucket] = pointer;
+                    resourceUriIndexCount++;
+                }
+            }
+            return;
+        }
+        else if (!resourceUriIndex)
+        {
+            // lookupResourceUri() walks the list until an index can be built
+            return;
+        }
+        // Otherwise the buckets only get longer
+    }
+
+    uint32_t bucket = hashResourceUri(resource->uri) & (resourceUriIndexSize - 1);
+    resource->uriIndexNext = resourceUriIndex[bucket];
+    resourceUriIndex[bucket] = resource;
+    resourceUriIndexCount++;
+}
+
+void unindexResourceUri(OCResource *resource)
+{
+    if (!resourceUriIndex || !resource->uri)
+    {
+        return;
+    }
+
+    OCResource **link = &resourceUriIndex[hashResourceUri(resource->uri) & (resourceUriIndexSize - 1)];
+    while (*link)
+    {
+        if (*link == resource)
+        {
+            *link = resource->uriIndexNext;
+            resource->uriIndexNext = NULL;
+            resourceUriIndexCount--;
+            break;
+        }
+        link = &(*link)->uriIndexNext;
+    }
+
+    if (!resourceUriIndexCount)
+    {
+        OICFree(resourceUriIndex);
+        resourceUriIndex = NULL;
+        resourceUriIndexSize = 0;
+    }
+}
+
+OCResource *lookupResourceUri(const char *uri)
+{
+    OCResource *pointer = NULL;
+    if (!resourceUriIndex)
+    {
+        for (pointer = headResource; pointer; pointer = pointer->next)
+        {
+            if (pointer->uri && strcmp(uri, pointer->uri) == 0)
+            {
+                break;
+            }
+        }
+        return pointer;
+    }
+
+    pointer = resourceUriIndex[hashResourceUri(uri) & (resourceUriIndexSize - 1)];
+    while (pointer && strcmp(uri, pointer->uri) != 0)
+    {
+        pointer = pointer->uriIndexNext;
+    }
+    return pointer;
+}
+
 OCResource *findResource(OCResource *resource)
 {
     OCResource *pointer = headResource;
@@ -3881,6 +4013,7 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            unindexResourceUri(temp);
             deleteResourceElements(temp);
             OICFree(temp);
             return OC_STACK_OK;
@@ -0,0 +1,369 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// GETs per second served by a server process depending on how it logs :
+//  - FATAL only, what a release deployment keeps,
+//  - INFO written synchronously,
+//  - INFO queued for the writer thread (OICLogStartAsync),
+//  - DEBUG written synchronously, hex dumps of every PDU included,
+//  - DEBUG queued, with one hex dump out of 16 (OICLogSetBufferSampling).
+// The server writes its log to /dev/null, so the numbers show the cost of
+// producing the messages rather than of the terminal. Each mode runs in its own
+// server process, which is this program started again with --server.
+//
+// The stack only logs when built with LOGGING=1 (TB_LOG).
+//
+// Usage: logging_throughput_benchmark [requests]
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocpayload.h"
+    #include "logger.h"
+}
+
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const char BENCH_URI[] = "/bench/log";
+    const char BENCH_RT[] = "bench.log";
+    const char SERVER_OPTION[] = "--server";
+    const int WINDOW = 8;
+    const uint32_t ASYNC_CAPACITY = 1024;
+    const uint32_t BUFFER_SAMPLING = 16;
+
+    enum LogMode
+    {
+        FATAL_ONLY,
+        INFO_SYNC,
+        INFO_ASYNC,
+        DEBUG_SYNC,
+        DEBUG_ASYNC_SAMPLED,
+        LOG_MODES
+    };
+
+    const char* const MODE_NAMES[LOG_MODES] =
+        { "FATAL only", "INFO sync", "INFO async", "DEBUG sync", "DEBUG async 1/16" };
+
+    void configureLog(LogMode mode)
+    {
+        switch (mode)
+        {
+            case FATAL_ONLY:
+                OICLogSetDefaultLevel(FATAL);
+                break;
+            case INFO_SYNC:
+                OICLogSetDefaultLevel(INFO);
+                break;
+            case INFO_ASYNC:
+                OICLogSetDefaultLevel(INFO);
+                OICLogStartAsync(ASYNC_CAPACITY);
+                break;
+            case DEBUG_SYNC:
+                OICLogSetDefaultLevel(DEBUG);
+                break;
+            default:
+                OICLogSetDefaultLevel(DEBUG);
+                OICLogSetBufferSampling(BUFFER_SAMPLING);
+                OICLogStartAsync(ASYNC_CAPACITY);
+                break;
+        }
+    }
+
+    // Server side
+
+    volatile sig_atomic_t g_serverQuit = 0;
+
+    void serverQuit(int /*signum*/)
+    {
+        g_serverQuit = 1;
+    }
+
+    OCEntityHandlerResult echoHandler(OCEntityHandlerFlag flag,
+            OCEntityHandlerRequest* request, void* /*callbackParam*/)
+    {
+        if (!(flag & OC_REQUEST_FLAG) || !request || OC_REST_GET != request->method)
+        {
+            return OC_EH_ERROR;
+        }
+
+        OCRepPayload* payload = OCRepPayloadCreate();
+        OCRepPayloadSetUri(payload, BENCH_URI);
+        OCRepPayloadSetPropInt(payload, "value", 42);
+
+        OCEntityHandlerResponse response;
+        memset(&response, 0, sizeof(response));
+        response.requestHandle = request->requestHandle;
+        response.resourceHandle = request->resource;
+        response.ehResult = OC_EH_OK;
+        response.payload = reinterpret_cast<OCPayload*>(payload);
+
+        OCEntityHandlerResult result = OC_EH_OK;
+        if (OCDoResponse(&response) != OC_STACK_OK)
+        {
+            result = OC_EH_ERROR;
+        }
+        OCPayloadDestroy(response.payload);
+        return result;
+    }
+
+    int serve(LogMode mode)
+    {
+        signal(SIGTERM, serverQuit);
+        if (!freopen("/dev/null", "w", stdout))
+        {
+            return 1;
+        }
+        configureLog(mode);
+
+        if (OCInit(nullptr, 0, OC_SERVER) != OC_STACK_OK)
+        {
+            return 1;
+        }
+
+        OCResourceHandle handle;
+        if (OCCreateResource(&handle, BENCH_RT, OC_RSRVD_INTERFACE_DEFAULT, BENCH_URI,
+                    echoHandler, nullptr, OC_DISCOVERABLE) != OC_STACK_OK)
+        {
+            OCStop();
+            return 1;
+        }
+
+        while (!g_serverQuit)
+        {
+            OCProcess();
+            OCProcessWait(100);
+        }
+
+        OCStop();
+        OICLogStopAsync();
+        return 0;
+    }
+
+    // Client side, not logging to keep it out of the measurement
+
+    std::recursive_mutex g_stackLock;
+    std::mutex g_mutex;
+    std::condition_variable g_cond;
+    bool g_discovered = false;
+    OCDevAddr g_serverAddr;
+    int g_inFlight = 0;
+    int g_completed = 0;
+    int g_failed = 0;
+    std::atomic<bool> g_clientRun(true);
+
+    OCStackApplicationResult discoveryHandler(void* /*ctx*/, OCDoHandle /*handle*/,
+            OCClientResponse* clientResponse)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (clientResponse && clientResponse->result == OC_STACK_OK && !g_discovered)
+        {
+            g_serverAddr = clientResponse->devAddr;
+            g_discovered = true;
+            g_cond.notify_all();
+        }
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    OCStackApplicationResult getHandler(void* /*ctx*/, OCDoHandle /*handle*/,
+            OCClientResponse* clientResponse)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        --g_inFlight;
+        ++g_completed;
+        if (!clientResponse || clientResponse->result != OC_STACK_OK)
+        {
+            ++g_failed;
+        }
+        g_cond.notify_all();
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    void processFunc()
+    {
+        while (g_clientRun)
+        {
+            {
+                std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+                OCProcess();
+            }
+            OCProcessWait(100);
+        }
+    }
+
+    bool discover()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_discovered = false;
+        }
+
+        std::string query = std::string(OC_RSRVD_WELL_KNOWN_URI) + "?rt=" + BENCH_RT;
+        OCCallbackData cbData = { nullptr, discoveryHandler, nullptr };
+
+        // the server may still be starting, ask again until it answers
+        for (int attempt = 0; attempt < 10; ++attempt)
+        {
+            {
+                std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+                OCDoResource(nullptr, OC_REST_DISCOVER, query.c_str(), nullptr, nullptr,
+                        CT_DEFAULT, OC_LOW_QOS, &cbData, nullptr, 0);
+            }
+            std::unique_lock<std::mutex> lock(g_mutex);
+            if (g_cond.wait_for(lock, std::chrono::seconds(1), [] { return g_discovered; }))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    pid_t startServer(const char* self, LogMode mode)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            std::string modeArg = std::to_string(static_cast<int>(mode));
+            execl(self, self, SERVER_OPTION, modeArg.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        return pid;
+    }
+
+    void stopServer(pid_t pid)
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    void run(const char* self, LogMode mode, int requests)
+    {
+        pid_t server = startServer(self, mode);
+        if (!discover())
+        {
+            printf("%-16s : the benchmark server was not discovered\n", MODE_NAMES[mode]);
+            stopServer(server);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_inFlight = 0;
+            g_completed = 0;
+            g_failed = 0;
+        }
+
+        OCCallbackData cbData = { nullptr, getHandler, nullptr };
+        bool stalled = false;
+        auto start = Clock::now();
+
+        for (int sent = 0; sent < requests && !stalled; ++sent)
+        {
+            {
+                std::unique_lock<std::mutex> lock(g_mutex);
+                stalled = !g_cond.wait_for(lock, std::chrono::seconds(2),
+                        [] { return g_inFlight < WINDOW; });
+                ++g_inFlight;
+            }
+
+            std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+            if (OCDoResource(nullptr, OC_REST_GET, BENCH_URI, &g_serverAddr, nullptr,
+                        CT_DEFAULT, OC_LOW_QOS, &cbData, nullptr, 0) != OC_STACK_OK)
+            {
+                std::lock_guard<std::mutex> countLock(g_mutex);
+                --g_inFlight;
+                ++g_failed;
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            stalled = !g_cond.wait_for(lock, std::chrono::seconds(2),
+                    [] { return g_inFlight <= 0; }) || stalled;
+        }
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        stopServer(server);
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        printf("%-16s : %9.1f req/s  %d responses  %d failed%s\n",
+                MODE_NAMES[mode], g_completed / seconds, g_completed, g_failed,
+                stalled ? "  (responses lost)" : "");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 3 && strcmp(argv[1], SERVER_OPTION) == 0)
+    {
+        int mode = atoi(argv[2]);
+        return (mode >= 0 && mode < LOG_MODES) ? serve(static_cast<LogMode>(mode)) : 1;
+    }
+
+    int requests = argc > 1 ? atoi(argv[1]) : 5000;
+    if (requests <= 0)
+    {
+        printf("usage: %s [requests]\n", argv[0]);
+        return 1;
+    }
+
+#ifndef TB_LOG
+    printf("built without TB_LOG, the server does not log in any mode\n");
+#endif
+
+    OICLogSetDefaultLevel(FATAL);
+    if (OCInit(nullptr, 0, OC_CLIENT) != OC_STACK_OK)
+    {
+        printf("OCInit failed\n");
+        return 1;
+    }
+    std::thread processThread(processFunc);
+
+    printf("GET %s, %d requests, %d in flight\n", BENCH_URI, requests, WINDOW);
+
+    for (int mode = 0; mode < LOG_MODES; ++mode)
+    {
+        run(argv[0], static_cast<LogMode>(mode), requests);
+    }
+
+    g_clientRun = false;
+    processThread.join();
+    OCStop();
+    return 0;
+}
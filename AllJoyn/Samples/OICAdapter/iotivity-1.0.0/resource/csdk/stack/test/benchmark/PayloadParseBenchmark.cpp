@@ -0,0 +1,240 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Time OCParsePayload() takes for the payloads a client parses most:
+//  - /oic/res discovery responses of servers with a growing number of
+//    resources, each with resource types, interfaces and a policy,
+//  - an /oic/p platform response,
+//  - representations with many properties and with nested objects.
+// The payloads are encoded by OCConvertPayload(), as a server sends them.
+//
+// Usage: payload_parse_benchmark [milliseconds per payload]
+
+extern "C"
+{
+    #include "ocpayload.h"
+    #include "ocpayloadcbor.h"
+    #include "oic_malloc.h"
+    #include "oic_string.h"
+}
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const uint8_t DEVICE_ID[] = { 0x3a, 0x61, 0x6b, 0x13, 0x2b, 0x5c, 0x4b, 0x3e,
+                                  0x93, 0x0c, 0x55, 0x14, 0x0d, 0x94, 0x86, 0x17 };
+
+    OCPayload* createDiscovery(int resources)
+    {
+        OCDiscoveryPayload* payload = OCDiscoveryPayloadCreate();
+        for (int i = 0; payload && i < resources; ++i)
+        {
+            OCResourcePayload* resource =
+                (OCResourcePayload*)OICCalloc(1, sizeof(OCResourcePayload));
+            if (!resource)
+            {
+                break;
+            }
+            char uri[32];
+            snprintf(uri, sizeof(uri), "/a/light/%d", i);
+            resource->uri = OICStrdup(uri);
+            resource->sid = (uint8_t*)OICMalloc(sizeof(DEVICE_ID));
+            if (resource->sid)
+            {
+                memcpy(resource->sid, DEVICE_ID, sizeof(DEVICE_ID));
+            }
+            OCResourcePayloadAddResourceType(resource, "core.light");
+            OCResourcePayloadAddResourceType(resource, "oic.r.switch.binary");
+            OCResourcePayloadAddInterface(resource, "oic.if.baseline");
+            OCResourcePayloadAddInterface(resource, "oic.if.a");
+            resource->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+            resource->secure = (i % 2) != 0;
+            resource->port = resource->secure ? 5684 : 0;
+            OCDiscoveryPayloadAddNewResource(payload, resource);
+        }
+        return (OCPayload*)payload;
+    }
+
+    OCPayload* createPlatform()
+    {
+        OCPlatformInfo info;
+        info.platformID = (char*)"0A3E0D6F-DBF5-404E-8719-D6880042463A";
+        info.manufacturerName = (char*)"Contoso";
+        info.manufacturerUrl = (char*)"http://www.contoso.com";
+        info.modelNumber = (char*)"Model 1.0";
+        info.dateOfManufacture = (char*)"2015-10-01";
+        info.platformVersion = (char*)"1.0";
+        info.operatingSystemVersion = (char*)"Linux 3.19";
+        info.hardwareVersion = (char*)"Rev B";
+        info.firmwareVersion = (char*)"1.0.3";
+        info.supportUrl = (char*)"http://support.contoso.com";
+        info.systemTime = (char*)"2015-10-01T12:00:00Z";
+        return (OCPayload*)OCPlatformPayloadCreate("/oic/p", &info);
+    }
+
+    void setProperties(OCRepPayload* payload, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "prop%d", i);
+            switch (i % 4)
+            {
+                case 0:
+                    OCRepPayloadSetPropInt(payload, name, i * 1000);
+                    break;
+                case 1:
+                    OCRepPayloadSetPropBool(payload, name, true);
+                    break;
+                case 2:
+                    OCRepPayloadSetPropDouble(payload, name, i / 3.0);
+                    break;
+                default:
+                    OCRepPayloadSetPropString(payload, name, "a string value");
+                    break;
+            }
+        }
+    }
+
+    // properties objects deep, each level with 8 properties
+    OCRepPayload* createNested(int depth)
+    {
+        OCRepPayload* payload = OCRepPayloadCreate();
+        if (!payload)
+        {
+            return NULL;
+        }
+        setProperties(payload, 8);
+        if (depth > 1)
+        {
+            OCRepPayload* child = createNested(depth - 1);
+            if (child)
+            {
+                OCRepPayloadSetPropObjectAsOwner(payload, "child", child);
+            }
+        }
+        return payload;
+    }
+
+    OCPayload* createRepresentation(int properties, int depth)
+    {
+        OCRepPayload* payload = depth ? createNested(depth) : OCRepPayloadCreate();
+        if (payload)
+        {
+            OCRepPayloadSetUri(payload, "/a/thing");
+            OCRepPayloadAddResourceType(payload, "oic.r.thing");
+            OCRepPayloadAddInterface(payload, "oic.if.baseline");
+            setProperties(payload, properties);
+        }
+        return (OCPayload*)payload;
+    }
+
+    bool run(const char* name, OCPayload* payload, double milliseconds)
+    {
+        if (!payload)
+        {
+            printf("creating %s failed\n", name);
+            return false;
+        }
+        OCPayloadType type = payload->type;
+        uint8_t* cbor = NULL;
+        size_t size = 0;
+        OCStackResult result = OCConvertPayload(payload, &cbor, &size);
+        OCPayloadDestroy(payload);
+        if (result != OC_STACK_OK)
+        {
+            printf("encoding %s failed: %d\n", name, result);
+            return false;
+        }
+
+        long parses = 0;
+        auto start = Clock::now();
+        std::chrono::duration<double, std::milli> elapsed(0);
+        while (elapsed.count() < milliseconds)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                OCPayload* parsed = NULL;
+                if (OCParsePayload(&parsed, type, cbor, size) != OC_STACK_OK)
+                {
+                    printf("parsing %s failed\n", name);
+                    OICFree(cbor);
+                    return false;
+                }
+                OCPayloadDestroy(parsed);
+            }
+            parses += 16;
+            elapsed = Clock::now() - start;
+        }
+        OICFree(cbor);
+
+        printf("%-28s %7u bytes : %10.0f ns/parse\n", name, (unsigned int)size,
+                elapsed.count() * 1e6 / parses);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double milliseconds = argc > 1 ? atof(argv[1]) : 500;
+    if (milliseconds <= 0)
+    {
+        printf("usage: %s [milliseconds per payload]\n", argv[0]);
+        return 1;
+    }
+
+    char name[64];
+    for (int resources : { 1, 10, 50, 200 })
+    {
+        snprintf(name, sizeof(name), "/oic/res, %d resources", resources);
+        if (!run(name, createDiscovery(resources), milliseconds))
+        {
+            return 1;
+        }
+    }
+    if (!run("/oic/p", createPlatform(), milliseconds))
+    {
+        return 1;
+    }
+    for (int properties : { 8, 64 })
+    {
+        snprintf(name, sizeof(name), "rep, %d properties", properties);
+        if (!run(name, createRepresentation(properties, 0), milliseconds))
+        {
+            return 1;
+        }
+    }
+    for (int depth : { 4, 16 })
+    {
+        snprintf(name, sizeof(name), "rep, %d nested objects", depth);
+        if (!run(name, createRepresentation(0, depth), milliseconds))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Round trip latency of a GET between a client and a server process on the
+// same host, depending on how the OCProcess loops wait between calls :
+//  - sleeping 10 ms, as the C++ wrappers used to,
+//  - sleeping 100 ms, as the OIC adapter used to,
+//  - OCProcessWait, which returns as soon as a message is queued.
+// Each mode runs against its own server process, which is this program
+// started again with --server.
+//
+// Usage: ocprocess_latency_benchmark [iterations]
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocpayload.h"
+}
+
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const char BENCH_URI[] = "/bench/echo";
+    const char BENCH_RT[] = "bench.echo";
+    const char SERVER_OPTION[] = "--server";
+
+    enum WaitMode
+    {
+        SLEEP_10MS,
+        SLEEP_100MS,
+        PROCESS_WAIT,
+        WAIT_MODES
+    };
+
+    const char* const MODE_NAMES[WAIT_MODES] = { "sleep 10 ms", "sleep 100 ms", "OCProcessWait" };
+
+    // Serializes stack calls, like the csdk lock of the C++ wrappers.
+    std::recursive_mutex g_stackLock;
+
+    std::mutex g_responseMutex;
+    std::condition_variable g_responseCond;
+    bool g_responded = false;
+    bool g_discovered = false;
+    OCDevAddr g_serverAddr;
+
+    volatile sig_atomic_t g_serverQuit = 0;
+
+    // One turn of a processing loop : what the wrappers do between OCProcess calls.
+    void processOnce(WaitMode mode)
+    {
+        {
+            std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+            OCProcess();
+        }
+
+        switch (mode)
+        {
+            case SLEEP_10MS:
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                break;
+            case SLEEP_100MS:
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                break;
+            default:
+                OCProcessWait(100);
+                break;
+        }
+    }
+
+    OCEntityHandlerResult echoHandler(OCEntityHandlerFlag flag,
+            OCEntityHandlerRequest* request, void* /*callbackParam*/)
+    {
+        if (!(flag & OC_REQUEST_FLAG) || !request || OC_REST_GET != request->method)
+        {
+            return OC_EH_ERROR;
+        }
+
+        OCRepPayload* payload = OCRepPayloadCreate();
+        OCRepPayloadSetUri(payload, BENCH_URI);
+        OCRepPayloadSetPropInt(payload, "value", 42);
+
+        OCEntityHandlerResponse response;
+        memset(&response, 0, sizeof(response));
+        response.requestHandle = request->requestHandle;
+        response.resourceHandle = request->resource;
+        response.ehResult = OC_EH_OK;
+        response.payload = reinterpret_cast<OCPayload*>(payload);
+
+        OCEntityHandlerResult result = OC_EH_OK;
+        if (OCDoResponse(&response) != OC_STACK_OK)
+        {
+            result = OC_EH_ERROR;
+        }
+        OCPayloadDestroy(response.payload);
+        return result;
+    }
+
+    void serverQuit(int /*signum*/)
+    {
+        g_serverQuit = 1;
+    }
+
+    int serve(WaitMode mode)
+    {
+        signal(SIGTERM, serverQuit);
+
+        if (OCInit(nullptr, 0, OC_SERVER) != OC_STACK_OK)
+        {
+            printf("%s : server OCInit failed\n", MODE_NAMES[mode]);
+            return 1;
+        }
+
+        OCResourceHandle handle;
+        if (OCCreateResource(&handle, BENCH_RT, OC_RSRVD_INTERFACE_DEFAULT, BENCH_URI, echoHandler, nullptr, OC_DISCOVERABLE) != OC_STACK_OK)
+        {
+            printf("%s : OCCreateResource failed\n", MODE_NAMES[mode]);
+            OCStop();
+            return 1;
+        }
+
+        while (!g_serverQuit)
+        {
+            processOnce(mode);
+        }
+
+        OCStop();
+        return 0;
+    }
+
+    OCStackApplicationResult discoveryHandler(void* /*ctx*/, OCDoHandle /*handle*/,
+            OCClientResponse* clientResponse)
+    {
+        std::lock_guard<std::mutex> lock(g_responseMutex);
+        if (clientResponse && clientResponse->result == OC_STACK_OK && !g_discovered)
+        {
+            g_serverAddr = clientResponse->devAddr;
+            g_discovered = true;
+            g_responseCond.notify_all();
+        }
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    OCStackApplicationResult getHandler(void* /*ctx*/, OCDoHandle /*handle*/,
+            OCClientResponse* /*clientResponse*/)
+    {
+        std::lock_guard<std::mutex> lock(g_responseMutex);
+        g_responded = true;
+        g_responseCond.notify_all();
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    class ProcessThread
+    {
+    public:
+        explicit ProcessThread(WaitMode mode) : m_run(true), m_wakeups(0)
+        {
+            m_thread = std::thread([this, mode]
+            {
+                while (m_run)
+                {
+                    processOnce(mode);
+                    ++m_wakeups;
+                }
+            });
+        }
+
+        ~ProcessThread()
+        {
+            m_run = false;
+            m_thread.join();
+        }
+
+        unsigned long wakeups() const
+        {
+            return m_wakeups;
+        }
+
+    private:
+        std::atomic<bool> m_run;
+        std::atomic<unsigned long> m_wakeups;
+        std::thread m_thread;
+    };
+
+    bool waitFor(bool& flag, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(g_responseMutex);
+        return g_responseCond.wait_for(lock, timeout, [&flag] { return flag; });
+    }
+
+    bool discover()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_responseMutex);
+            g_discovered = false;
+        }
+
+        std::string query = std::string(OC_RSRVD_WELL_KNOWN_URI) + "?rt=" + BENCH_RT;
+        OCCallbackData cbData = { nullptr, discoveryHandler, nullptr };
+
+        // the server may still be starting, ask again until it answers
+        for (int attempt = 0; attempt < 10; ++attempt)
+        {
+            {
+                std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+                OCDoResource(nullptr, OC_REST_DISCOVER, query.c_str(), nullptr, nullptr,
+                        CT_DEFAULT, OC_LOW_QOS, &cbData, nullptr, 0);
+            }
+            if (waitFor(g_discovered, std::chrono::milliseconds(1000)))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    pid_t startServer(const char* self, WaitMode mode)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            std::string modeArg = std::to_string(static_cast<int>(mode));
+            execl(self, self, SERVER_OPTION, modeArg.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        return pid;
+    }
+
+    void stopServer(pid_t pid)
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    void run(const char* self, WaitMode mode, int iterations)
+    {
+        const char* name = MODE_NAMES[mode];
+        std::vector< long long > samples;
+        samples.reserve(iterations);
+
+        pid_t server = startServer(self, mode);
+        ProcessThread processThread(mode);
+        if (!discover())
+        {
+            printf("%s : the benchmark server was not discovered\n", name);
+            stopServer(server);
+            return;
+        }
+
+        unsigned long wakeupsBefore = processThread.wakeups();
+        auto start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> lock(g_responseMutex);
+                g_responded = false;
+            }
+
+            OCCallbackData cbData = { nullptr, getHandler, nullptr };
+            auto sent = Clock::now();
+            {
+                std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+                if (OCDoResource(nullptr, OC_REST_GET, BENCH_URI, &g_serverAddr, nullptr,
+                            CT_DEFAULT, OC_LOW_QOS, &cbData, nullptr, 0) != OC_STACK_OK)
+                {
+                    printf("%s : OCDoResource failed\n", name);
+                    stopServer(server);
+                    return;
+                }
+            }
+            if (!waitFor(g_responded, std::chrono::milliseconds(2000)))
+            {
+                printf("%s : no response\n", name);
+                stopServer(server);
+                return;
+            }
+            samples.push_back(std::chrono::duration_cast< std::chrono::nanoseconds >(
+                        Clock::now() - sent).count());
+        }
+
+        double seconds = std::chrono::duration< double >(Clock::now() - start).count();
+        stopServer(server);
+        std::sort(samples.begin(), samples.end());
+
+        printf("%-16s p50 %9.3f ms  p99 %9.3f ms  %8.1f req/s  %5.1f client OCProcess/req\n",
+                name,
+                samples[samples.size() / 2] / 1e6,
+                samples[samples.size() * 99 / 100] / 1e6,
+                iterations / seconds,
+                static_cast< double >(processThread.wakeups() - wakeupsBefore) / iterations);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 3 && strcmp(argv[1], SERVER_OPTION) == 0)
+    {
+        int mode = atoi(argv[2]);
+        return (mode >= 0 && mode < WAIT_MODES) ? serve(static_cast<WaitMode>(mode)) : 1;
+    }
+
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (iterations <= 0)
+    {
+        printf("usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    if (OCInit(nullptr, 0, OC_CLIENT) != OC_STACK_OK)
+    {
+        printf("OCInit failed\n");
+        return 1;
+    }
+
+    printf("GET %s between two processes, %d iterations\n", BENCH_URI, iterations);
+
+    run(argv[0], SLEEP_10MS, iterations);
+    run(argv[0], SLEEP_100MS, std::max(iterations / 10, 1));
+    run(argv[0], PROCESS_WAIT, iterations);
+
+    OCStop();
+    return 0;
+}
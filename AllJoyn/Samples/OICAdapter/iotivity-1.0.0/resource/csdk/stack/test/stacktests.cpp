@@ -325,6 +325,21 @@ TEST(StackStop, StackStopRepeated)
     EXPECT_EQ(OC_STACK_ERROR, OCStop());
 }
 
+TEST(StackProcess, ProcessWaitWithoutInit)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_ERROR, OCProcessWait(0));
+}
+
+TEST(StackProcess, ProcessWaitTimesOutWhenIdle)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+    EXPECT_EQ(OC_STACK_TIMEOUT, OCProcessWait(0));
+    EXPECT_EQ(OC_STACK_TIMEOUT, OCProcessWait(10));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackResource, DISABLED_UpdateResourceNullURI)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -558,6 +573,51 @@ TEST(StackResource, CreateResourceMultipleResources)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResource, CreateResourceManyResourcesUriIndex)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OC_LOG(INFO, TAG, "Starting CreateResourceManyResourcesUriIndex test");
+    InitStack(OC_SERVER);
+
+    // Enough resources for the URI index to grow a few times
+    const int numResources = 200;
+    OCResourceHandle handles[numResources];
+    char uri[32];
+    for (int i = 0; i < numResources; i++)
+    {
+        snprintf(uri, sizeof(uri), "/a/led%d", i);
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handles[i],
+                                                "core.led",
+                                                "core.rw",
+                                                uri,
+                                                0,
+                                                NULL,
+                                                OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led150",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    // A deleted URI can be used again
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handles[150]));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led150",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_STREQ("/a/led150", OCGetResourceUri(handle));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackResource, CreateResourceBadResoureType)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -0,0 +1,76 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _ENTITY_HANDLER_POOL_H_
+#define _ENTITY_HANDLER_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <ocstack.h>
+
+namespace OC
+{
+    /**
+     * Threads running entity handlers for the server wrapper.
+     *
+     * Tasks posted for the same resource run one after the other, in the order
+     * they were posted; tasks for different resources run in parallel.
+     */
+    class EntityHandlerPool
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        explicit EntityHandlerPool(unsigned int threadCount);
+
+        /**
+         * Stops the threads once the tasks being run complete. The tasks still
+         * queued are dropped.
+         */
+        ~EntityHandlerPool();
+
+        EntityHandlerPool(const EntityHandlerPool&) = delete;
+        EntityHandlerPool& operator=(const EntityHandlerPool&) = delete;
+
+        /** Queues task behind the tasks already posted for resource. */
+        void post(OCResourceHandle resource, Task task);
+
+    private:
+        void run();
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        // Pending tasks per resource. A resource with tasks is either in m_ready or
+        // has its front task being run by a thread, never both, which is what keeps
+        // its tasks serialized.
+        std::unordered_map<OCResourceHandle, std::deque<Task>> m_strands;
+        std::deque<OCResourceHandle> m_ready;
+        std::vector<std::thread> m_threads;
+        bool m_stop;
+    };
+}
+
+#endif
@@ -87,6 +87,14 @@ namespace OC
                         const HeaderOptions& headerOptions, ObserveCallback& callback,
                         QualityOfService QoS)=0;
 
+        virtual OCStackResult ObserveResourcePayload(
+                        ObserveType observeType, OCDoHandle* handle,
+                        const OCDevAddr& devAddr,
+                        const std::string& uri,
+                        const QueryParamsMap& queryParams,
+                        const HeaderOptions& headerOptions, ObservePayloadCallback& callback,
+                        QualityOfService QoS)=0;
+
         virtual OCStackResult CancelObserveResource(
                         OCDoHandle handle,
                         const std::string& host,
@@ -81,6 +81,12 @@ namespace OC
             ObserveCallback callback;
             ObserveContext(ObserveCallback cb) : callback(cb){}
         };
+
+        struct ObservePayloadContext
+        {
+            ObservePayloadCallback callback;
+            ObservePayloadContext(ObservePayloadCallback cb) : callback(cb){}
+        };
     }
 
     class InProcClientWrapper : public IClientWrapper
@@ -131,6 +137,13 @@ namespace OC
             const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
             ObserveCallback& callback, QualityOfService QoS);
 
+        virtual OCStackResult ObserveResourcePayload(
+            ObserveType observeType, OCDoHandle* handle,
+            const OCDevAddr& devAddr,
+            const std::string& uri,
+            const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
+            ObservePayloadCallback& callback, QualityOfService QoS);
+
         virtual OCStackResult CancelObserveResource(
             OCDoHandle handle,
             const std::string& host,
@@ -147,11 +160,19 @@ namespace OC
         virtual OCStackResult UnsubscribePresence(OCDoHandle handle);
         OCStackResult GetDefaultQos(QualityOfService& QoS);
     private:
+        // longest wait for a message between OCProcess calls, in milliseconds
+        static const uint32_t PROCESS_WAIT_TIMEOUT_MS = 100;
+
         void listeningFunc();
         std::string assembleSetResourceUri(std::string uri, const QueryParamsMap& queryParams);
         OCPayload* assembleSetResourcePayload(const OCRepresentation& attributes);
         OCHeaderOption* assembleHeaderOptions(OCHeaderOption options[],
            const HeaderOptions& headerOptions);
+        OCStackResult doObserveResource(ObserveType observeType, OCDoHandle* handle,
+            const OCDevAddr& devAddr,
+            const std::string& uri,
+            const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
+            OCCallbackData& cbdata, QualityOfService QoS);
         std::thread m_listeningThread;
         bool m_threadRun;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
@@ -23,8 +23,10 @@
 
 #include <thread>
 #include <mutex>
+#include <memory>
 
 #include <IServerWrapper.h>
+#include <EntityHandlerPool.h>
 
 namespace OC
 {
@@ -68,11 +70,23 @@ namespace OC
         virtual OCStackResult setDefaultDeviceEntityHandler(EntityHandler entityHandler);
 
         virtual OCStackResult sendResponse(const std::shared_ptr<OCResourceResponse> pResponse);
+
+        /**
+         * Runs entityHandler for pRequest on the entity handler threads and tells
+         * the stack that the response comes later. Only used when the platform
+         * configuration asks for entity handler threads.
+         */
+        OCEntityHandlerResult dispatchEntityHandler(const EntityHandler& entityHandler,
+                    const std::shared_ptr<OCResourceRequest>& pRequest);
     private:
+        // longest wait for a message between OCProcess calls, in milliseconds
+        static const uint32_t PROCESS_WAIT_TIMEOUT_MS = 100;
+
         void processFunc();
         std::thread m_processThread;
         bool m_threadRun;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
+        std::unique_ptr<EntityHandlerPool> m_entityHandlerPool;
     };
 }
 
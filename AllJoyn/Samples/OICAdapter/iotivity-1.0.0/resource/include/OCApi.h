@@ -152,6 +152,14 @@ namespace OC
         /** persistant storage Handler structure (open/read/write/close/unlink). */
         OCPersistentStorage        *ps;
 
+        /**
+         * number of threads running the entity handlers of the server. With 0 they
+         * run on the processing thread, one request at a time. Otherwise requests
+         * for different resources are handled in parallel, requests for the same
+         * resource still one at a time, and responses are sent as slow responses.
+         */
+        unsigned int               entityHandlerThreads;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
@@ -161,7 +169,8 @@ namespace OC
                 ipAddress("0.0.0.0"),
                 port(0),
                 QoS(QualityOfService::NaQos),
-                ps(nullptr)
+                ps(nullptr),
+                entityHandlerThreads(0)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -176,7 +185,8 @@ namespace OC
                 ipAddress(""),
                 port(0),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                entityHandlerThreads(0)
         {}
             // for backward compatibility
             PlatformConfig(const ServiceType serviceType_,
@@ -192,7 +202,8 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                entityHandlerThreads(0)
         {}
     };
 
@@ -276,6 +287,14 @@ namespace OC
 
     typedef std::function<void(const HeaderOptions&,
                                 const OCRepresentation&, const int, const int)> ObserveCallback;
+
+    /**
+    * Observe callback that receives the decoded payload itself, for clients that
+    * convert it to their own representation.  It is called on the stack's thread,
+    * and the payload, which may be null, is only valid until it returns.
+    */
+    typedef std::function<void(const HeaderOptions&,
+                                const OCRepPayload*, const int, const int)> ObservePayloadCallback;
 } // namespace OC
 
 #endif
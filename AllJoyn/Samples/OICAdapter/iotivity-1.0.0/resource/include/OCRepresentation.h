@@ -72,8 +72,13 @@ namespace OC
 
             const std::vector<OCRepresentation>& representations() const;
 
+            // Moves the representations out, leaving this container empty.
+            std::vector<OCRepresentation> extractRepresentations();
+
             void addRepresentation(const OCRepresentation& rep);
 
+            void addRepresentation(OCRepresentation&& rep);
+
             const OCRepresentation& operator[](int index) const
             {
                 return m_reps[index];
@@ -113,6 +118,8 @@ namespace OC
 
             void addChild(const OCRepresentation&);
 
+            void addChild(OCRepresentation&&);
+
             void clearChildren();
 
             const std::vector<OCRepresentation>& getChildren() const;
@@ -243,7 +250,7 @@ namespace OC
                     template<typename T>
                     T getValue() const
                     {
-                        return boost::get<T>(m_values[m_attrName]);
+                        return boost::get<T>(value());
                     }
 
                     std::string getValueToString() const;
@@ -251,14 +258,14 @@ namespace OC
                     template<typename T>
                     AttributeItem& operator=(T&& rhs)
                     {
-                        m_values[m_attrName] = std::forward<T>(rhs);
+                        value() = std::forward<T>(rhs);
                         return *this;
                     }
 
                     AttributeItem& operator=(std::nullptr_t /*rhs*/)
                     {
                         NullType t;
-                        m_values[m_attrName] = t;
+                        value() = t;
                         return *this;
                     }
 
@@ -307,8 +314,15 @@ namespace OC
                     AttributeItem(const std::string& name,
                             std::map<std::string, AttributeValue>& vals);
                     AttributeItem(const AttributeItem&) = default;
+                    // Items created by iterators already know their value,
+                    // others look it up (and create it) by name.
+                    AttributeValue& value() const
+                    {
+                        return m_value ? *m_value : m_values[m_attrName];
+                    }
                     std::string m_attrName;
                     std::map<std::string, AttributeValue>& m_values;
+                    AttributeValue* m_value;
             };
 
             // Iterator to allow iteration via STL containers/methods
@@ -338,7 +352,10 @@ namespace OC
                     iterator(std::map<std::string, AttributeValue>::iterator&& itr,
                             std::map<std::string, AttributeValue>& vals)
                         : m_iterator(std::move(itr)),
-                        m_item(m_iterator != vals.end() ? m_iterator->first:"", vals){}
+                        m_item(m_iterator != vals.end() ? m_iterator->first:"", vals)
+                    {
+                        m_item.m_value = m_iterator != vals.end() ? &m_iterator->second : nullptr;
+                    }
                     std::map<std::string, AttributeValue>::iterator m_iterator;
                     AttributeItem m_item;
             };
@@ -371,7 +388,11 @@ namespace OC
                     const_iterator(std::map<std::string, AttributeValue>::const_iterator&& itr,
                             std::map<std::string, AttributeValue>& vals)
                         : m_iterator(std::move(itr)),
-                        m_item(m_iterator != vals.end() ? m_iterator->first: "", vals){}
+                        m_item(m_iterator != vals.end() ? m_iterator->first: "", vals)
+                    {
+                        m_item.m_value = m_iterator != vals.end() ?
+                            const_cast<AttributeValue*>(&m_iterator->second) : nullptr;
+                    }
                     std::map<std::string, AttributeValue>::const_iterator m_iterator;
                     AttributeItem m_item;
             };
@@ -394,7 +415,8 @@ namespace OC
             template<typename T>
             void payload_array_helper(const OCRepPayloadValue* pl, size_t depth);
             template<typename T>
-            T payload_array_helper_copy(size_t index, const OCRepPayloadValue* pl);
+            std::vector<T> payload_array_helper_row(const OCRepPayloadValue* pl,
+                    size_t offset, size_t count);
             void setPayload(const OCRepPayload* payload);
             void setPayloadArray(const OCRepPayloadValue* pl);
             void getPayloadArray(OCRepPayload* payload,
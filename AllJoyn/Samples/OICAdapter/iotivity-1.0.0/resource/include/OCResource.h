@@ -415,6 +415,42 @@ namespace OC
         OCStackResult observe(ObserveType observeType, const QueryParamsMap& queryParametersMap,
                         ObserveCallback observeHandler, QualityOfService qos);
 
+        /**
+        * Function to set observation on the resource, with notifications handed over
+        * as the decoded payload rather than as an OCRepresentation
+        *
+        * @param observeType allows the client to specify how it wants to observe.
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param observeHandler handles callback
+        *        The callback function is invoked on the stack's thread with the payload
+        *        of each notification, which is only valid until it returns, the result
+        *        from this observe operation and the sequence number.
+        * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
+        * @note OCStackResult is defined in ocstack.h.
+        *
+        */
+        OCStackResult observePayload(ObserveType observeType,
+                        const QueryParamsMap& queryParametersMap,
+                        ObservePayloadCallback observeHandler);
+        /**
+        * Function to set observation on the resource, with notifications handed over
+        * as the decoded payload rather than as an OCRepresentation
+        *
+        * @param observeType allows the client to specify how it wants to observe.
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param observeHandler handles callback
+        *        The callback function is invoked on the stack's thread with the payload
+        *        of each notification, which is only valid until it returns, the result
+        *        from this observe operation and the sequence number.
+        * @param qos the quality of communication
+        * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
+        * @note OCStackResult is defined in ocstack.h.
+        *
+        */
+        OCStackResult observePayload(ObserveType observeType,
+                        const QueryParamsMap& queryParametersMap,
+                        ObservePayloadCallback observeHandler, QualityOfService qos);
+
         /**
         * Function to cancel the observation on the resource
         *
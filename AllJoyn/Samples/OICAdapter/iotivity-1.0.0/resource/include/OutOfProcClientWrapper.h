@@ -95,6 +95,15 @@ namespace OC
             ObserveCallback& /*callback*/, QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
+        virtual OCStackResult ObserveResourcePayload(
+            ObserveType /*observeType*/, OCDoHandle* /*handle*/,
+            const OCDevAddr& /*devAddr*/,
+            const std::string& /*uri*/,
+            const QueryParamsMap& /*queryParams*/,
+            const HeaderOptions& /*headerOptions*/,
+            ObservePayloadCallback& /*callback*/, QualityOfService /*QoS*/)
+            {return OC_STACK_NOTIMPL;}
+
         virtual OCStackResult CancelObserveResource(
             OCDoHandle /*handle*/,
             const std::string& /*host*/,
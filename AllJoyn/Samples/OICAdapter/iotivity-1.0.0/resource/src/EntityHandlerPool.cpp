@@ -0,0 +1,101 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <EntityHandlerPool.h>
+
+namespace OC
+{
+    EntityHandlerPool::EntityHandlerPool(unsigned int threadCount)
+        : m_stop(false)
+    {
+        for(unsigned int i = 0; i < threadCount; ++i)
+        {
+            m_threads.push_back(std::thread(&EntityHandlerPool::run, this));
+        }
+    }
+
+    EntityHandlerPool::~EntityHandlerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+
+        for(auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    void EntityHandlerPool::post(OCResourceHandle resource, Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto entry = m_strands.find(resource);
+            if(entry != m_strands.end())
+            {
+                // a thread picks it up after the tasks in front of it
+                entry->second.push_back(std::move(task));
+                return;
+            }
+
+            m_strands[resource].push_back(std::move(task));
+            m_ready.push_back(resource);
+        }
+        m_cond.notify_one();
+    }
+
+    void EntityHandlerPool::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for(;;)
+        {
+            m_cond.wait(lock, [this] { return m_stop || !m_ready.empty(); });
+            if(m_stop)
+            {
+                break;
+            }
+
+            OCResourceHandle resource = m_ready.front();
+            m_ready.pop_front();
+
+            // The emptied queue stays in m_strands while the task runs, so tasks
+            // posted meanwhile for this resource wait for it.
+            auto& tasks = m_strands[resource];
+            Task task = std::move(tasks.front());
+            tasks.pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+
+            auto entry = m_strands.find(resource);
+            if(entry->second.empty())
+            {
+                m_strands.erase(entry);
+            }
+            else
+            {
+                m_ready.push_back(resource);
+            }
+        }
+    }
+}
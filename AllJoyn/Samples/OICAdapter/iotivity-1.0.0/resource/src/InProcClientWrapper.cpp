@@ -92,8 +92,9 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until a message is queued; the timeout bounds how late the
+            // stack's periodic work (e.g. presence timeouts) gets done.
+            OCProcessWait(PROCESS_WAIT_TIMEOUT_MS);
         }
     }
 
@@ -115,19 +116,20 @@ namespace OC
         oc.setPayload(clientResponse->payload);
         //OCPayloadDestroy(clientResponse->payload);
 
-        std::vector<OCRepresentation>::const_iterator it = oc.representations().begin();
-        if(it == oc.representations().end())
+        std::vector<OCRepresentation> reps = oc.extractRepresentations();
+        std::vector<OCRepresentation>::iterator it = reps.begin();
+        if(it == reps.end())
         {
             return OCRepresentation();
         }
 
         // first one is considered the root, everything else is considered a child of this one.
-        OCRepresentation root = *it;
+        OCRepresentation root = std::move(*it);
         ++it;
 
-        std::for_each(it, oc.representations().end(),
-                [&root](const OCRepresentation& repItr)
-                {root.addChild(repItr);});
+        std::for_each(it, reps.end(),
+                [&root](OCRepresentation& repItr)
+                {root.addChild(std::move(repItr));});
         return root;
 
     }
@@ -228,7 +230,7 @@ namespace OC
         try
         {
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
+            std::thread exec(context->callback, std::move(rep));
             exec.detach();
         }
         catch(OC::OCException& e)
@@ -331,7 +333,7 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
+        std::thread exec(context->callback, serverHeaderOptions, std::move(rep), result);
         exec.detach();
         return OC_STACK_DELETE_TRANSACTION;
     }
@@ -408,7 +410,7 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
+        std::thread exec(context->callback, serverHeaderOptions, std::move(attrs), result);
         exec.detach();
         return OC_STACK_DELETE_TRANSACTION;
     }
@@ -627,7 +629,7 @@ namespace OC
                 result = e.code();
             }
         }
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
+        std::thread exec(context->callback, serverHeaderOptions, std::move(attrs),
                     result, sequenceNumber);
         exec.detach();
         if(sequenceNumber == OC_OBSERVE_DEREGISTER)
@@ -637,6 +639,45 @@ namespace OC
         return OC_STACK_KEEP_TRANSACTION;
     }
 
+    OCStackApplicationResult observeResourcePayloadCallback(void* ctx,
+                                                            OCDoHandle /*handle*/,
+        OCClientResponse* clientResponse)
+    {
+        ClientCallbackContext::ObservePayloadContext* context =
+            static_cast<ClientCallbackContext::ObservePayloadContext*>(ctx);
+        HeaderOptions serverHeaderOptions;
+        const OCRepPayload* payload = nullptr;
+        uint32_t sequenceNumber = clientResponse->sequenceNumber;
+        OCStackResult result = clientResponse->result;
+        if(clientResponse->result == OC_STACK_OK)
+        {
+            parseServerHeaderOptions(clientResponse, serverHeaderOptions);
+            if(clientResponse->payload != nullptr &&
+                    clientResponse->payload->type == PAYLOAD_TYPE_REPRESENTATION)
+            {
+                payload = reinterpret_cast<const OCRepPayload*>(clientResponse->payload);
+            }
+        }
+
+        // The payload belongs to the stack, so the callback runs here rather than
+        // on a thread of its own.
+        try
+        {
+            context->callback(serverHeaderOptions, payload, result, sequenceNumber);
+        }
+        catch(std::exception& e)
+        {
+            oclog() << "Exception in observeResourcePayloadCallback, ignoring response: "
+                << e.what() << std::flush;
+        }
+
+        if(sequenceNumber == OC_OBSERVE_DEREGISTER)
+        {
+            return OC_STACK_DELETE_TRANSACTION;
+        }
+        return OC_STACK_KEEP_TRANSACTION;
+    }
+
     OCStackResult InProcClientWrapper::ObserveResource(ObserveType observeType, OCDoHandle* handle,
         const OCDevAddr& devAddr,
         const std::string& uri,
@@ -647,7 +688,6 @@ namespace OC
         {
             return OC_STACK_INVALID_PARAM;
         }
-        OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
             new ClientCallbackContext::ObserveContext(callback);
@@ -657,6 +697,43 @@ namespace OC
                 [](void* c) {delete static_cast<ClientCallbackContext::ObserveContext*>(c);}
         };
 
+        return doObserveResource(observeType, handle, devAddr, uri, queryParams,
+                headerOptions, cbdata, QoS);
+    }
+
+    OCStackResult InProcClientWrapper::ObserveResourcePayload(ObserveType observeType,
+        OCDoHandle* handle,
+        const OCDevAddr& devAddr,
+        const std::string& uri,
+        const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
+        ObservePayloadCallback& callback, QualityOfService QoS)
+    {
+        if(!callback)
+        {
+            return OC_STACK_INVALID_PARAM;
+        }
+
+        ClientCallbackContext::ObservePayloadContext* ctx =
+            new ClientCallbackContext::ObservePayloadContext(callback);
+        OCCallbackData cbdata{
+                static_cast<void*>(ctx),
+                observeResourcePayloadCallback,
+                [](void* c) {delete static_cast<ClientCallbackContext::ObservePayloadContext*>(c);}
+        };
+
+        return doObserveResource(observeType, handle, devAddr, uri, queryParams,
+                headerOptions, cbdata, QoS);
+    }
+
+    OCStackResult InProcClientWrapper::doObserveResource(ObserveType observeType,
+        OCDoHandle* handle,
+        const OCDevAddr& devAddr,
+        const std::string& uri,
+        const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
+        OCCallbackData& cbdata, QualityOfService QoS)
+    {
+        OCStackResult result;
+
         OCMethod method;
         if (observeType == ObserveType::Observe)
         {
@@ -691,7 +768,7 @@ namespace OC
         }
         else
         {
-            delete ctx;
+            cbdata.cd(cbdata.context);
             return OC_STACK_ERROR;
         }
 
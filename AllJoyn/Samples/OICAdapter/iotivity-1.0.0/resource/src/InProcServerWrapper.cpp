@@ -182,7 +182,7 @@ OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
 
 OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
                                            OCEntityHandlerRequest * entityHandlerRequest,
-                                           void* /*callbackParam*/)
+                                           void* callbackParam)
 {
     OCEntityHandlerResult result = OC_EH_ERROR;
 
@@ -228,7 +228,13 @@ OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
     if(entityHandlerEntry != entityHandlerEnd)
     {
         // Call CPP Application Entity Handler
-        if(entityHandlerEntry->second)
+        if(entityHandlerEntry->second && callbackParam)
+        {
+            // The server wrapper runs its entity handlers on its own threads
+            InProcServerWrapper* server = static_cast<InProcServerWrapper*>(callbackParam);
+            result = server->dispatchEntityHandler(entityHandlerEntry->second, pRequest);
+        }
+        else if(entityHandlerEntry->second)
         {
             result = entityHandlerEntry->second(pRequest);
         }
@@ -284,6 +290,11 @@ namespace OC
             throw InitializeException(OC::InitException::STACK_INIT_ERROR, result);
         }
 
+        if(cfg.entityHandlerThreads > 0)
+        {
+            m_entityHandlerPool.reset(new EntityHandlerPool(cfg.entityHandlerThreads));
+        }
+
         m_threadRun = true;
         m_processThread = std::thread(&InProcServerWrapper::processFunc, this);
     }
@@ -306,7 +317,9 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until a message is queued; the timeout bounds how late the
+            // stack's periodic work gets done.
+            OCProcessWait(PROCESS_WAIT_TIMEOUT_MS);
         }
     }
 
@@ -358,7 +371,7 @@ namespace OC
                             resourceInterface.c_str(), //const char * resourceInterfaceName //TODO fix this
                             resourceURI.c_str(), // const char * uri
                             EntityHandlerWrapper, // OCEntityHandler entityHandler
-                            NULL,
+                            m_entityHandlerPool ? this : NULL,
                             resourceProperties // uint8_t resourceProperties
                             );
             }
@@ -595,6 +608,48 @@ namespace OC
         }
     }
 
+    OCEntityHandlerResult InProcServerWrapper::dispatchEntityHandler(
+            const EntityHandler& entityHandler, const std::shared_ptr<OCResourceRequest>& pRequest)
+    {
+        std::weak_ptr<std::recursive_mutex> csdkLock = m_csdkLock;
+
+        m_entityHandlerPool->post(pRequest->getResourceHandle(),
+            [csdkLock, entityHandler, pRequest]
+            {
+                OCEntityHandlerResult result = OC_EH_ERROR;
+                try
+                {
+                    result = entityHandler(pRequest);
+                }
+                catch(std::exception& e)
+                {
+                    oclog() << "Entity handler failed: " << e.what() << std::flush;
+                }
+
+                if(OC_EH_ERROR != result)
+                {
+                    return;
+                }
+
+                // The stack only drops the request of a failing entity handler when it
+                // returns synchronously; a slow request has to be answered.
+                OCEntityHandlerResponse response;
+                memset(&response, 0, sizeof(response));
+                response.requestHandle = pRequest->getRequestHandle();
+                response.resourceHandle = pRequest->getResourceHandle();
+                response.ehResult = OC_EH_ERROR;
+
+                auto cLock = csdkLock.lock();
+                if(cLock)
+                {
+                    std::lock_guard<std::recursive_mutex> lock(*cLock);
+                    OCDoResponse(&response);
+                }
+            });
+
+        return OC_EH_SLOW;
+    }
+
     InProcServerWrapper::~InProcServerWrapper()
     {
         if(m_processThread.joinable())
@@ -603,6 +658,9 @@ namespace OC
             m_processThread.join();
         }
 
+        // no new requests come in once the processing thread is gone
+        m_entityHandlerPool.reset();
+
         OCStop();
     }
 }
@@ -133,7 +133,7 @@ namespace OC
             cur.setPayload(pl);
 
             pl = pl->next;
-            this->addRepresentation(cur);
+            this->addRepresentation(std::move(cur));
         }
     }
 
@@ -160,10 +160,22 @@ namespace OC
         return m_reps;
     }
 
+    std::vector<OCRepresentation> MessageContainer::extractRepresentations()
+    {
+        std::vector<OCRepresentation> reps;
+        reps.swap(m_reps);
+        return reps;
+    }
+
     void MessageContainer::addRepresentation(const OCRepresentation& rep)
     {
         m_reps.push_back(rep);
     }
+
+    void MessageContainer::addRepresentation(OCRepresentation&& rep)
+    {
+        m_reps.push_back(std::move(rep));
+    }
 }
 
 namespace OC
@@ -262,6 +274,9 @@ namespace OC
             ((T*)array)[pos] = item;
         }
 
+        // Preferred over the template so nested representations are not copied.
+        void copy_to_array(const OC::OCRepresentation& item, void* array, size_t pos);
+
         size_t dimensions[MAX_REP_ARRAY_DEPTH];
         size_t root_size;
         size_t dimTotal;
@@ -318,8 +333,8 @@ namespace OC
         ((char**)array)[pos] = OICStrdup(item.c_str());
     }
 
-    template<>
-    void get_payload_array::copy_to_array(OC::OCRepresentation item, void* array, size_t pos)
+    void get_payload_array::copy_to_array(const OC::OCRepresentation& item, void* array,
+            size_t pos)
     {
         ((OCRepPayload**)array)[pos] = item.getPayload();
     }
@@ -328,7 +343,7 @@ namespace OC
                     const OCRepresentation::AttributeItem& item) const
     {
         get_payload_array vis{};
-        boost::apply_visitor(vis, m_values[item.attrname()]);
+        boost::apply_visitor(vis, item.value());
 
 
         switch(item.base_type())
@@ -402,11 +417,11 @@ namespace OC
                     break;
                 case AttributeType::String:
                     OCRepPayloadSetPropString(root, val.attrname().c_str(),
-                            static_cast<std::string>(val).c_str());
+                            boost::get<std::string>(val.value()).c_str());
                     break;
                 case AttributeType::OCRepresentation:
                     OCRepPayloadSetPropObjectAsOwner(root, val.attrname().c_str(),
-                            static_cast<OCRepresentation>(val).getPayload());
+                            boost::get<OCRepresentation>(val.value()).getPayload());
                     break;
                 case AttributeType::Vector:
                     getPayloadArray(root, val);
@@ -441,98 +456,98 @@ namespace OC
         }
     }
 
+    // Rows of the flattened payload array are read as typed ranges,
+    // so primitive arrays are copied in bulk instead of element by element.
     template<typename T>
-    T OCRepresentation::payload_array_helper_copy(size_t index, const OCRepPayloadValue* pl)
+    std::vector<T> OCRepresentation::payload_array_helper_row(const OCRepPayloadValue* /*pl*/,
+            size_t /*offset*/, size_t /*count*/)
     {
-        throw std::logic_error("payload_array_helper_copy: unsupported type");
+        throw std::logic_error("payload_array_helper_row: unsupported type");
     }
     template<>
-    int OCRepresentation::payload_array_helper_copy<int>(size_t index, const OCRepPayloadValue* pl)
+    std::vector<int> OCRepresentation::payload_array_helper_row<int>(
+            const OCRepPayloadValue* pl, size_t offset, size_t count)
     {
-        return pl->arr.iArray[index];
+        return std::vector<int>(pl->arr.iArray + offset, pl->arr.iArray + offset + count);
     }
     template<>
-    double OCRepresentation::payload_array_helper_copy<double>(size_t index, const OCRepPayloadValue* pl)
+    std::vector<double> OCRepresentation::payload_array_helper_row<double>(
+            const OCRepPayloadValue* pl, size_t offset, size_t count)
     {
-        return pl->arr.dArray[index];
+        return std::vector<double>(pl->arr.dArray + offset, pl->arr.dArray + offset + count);
     }
     template<>
-    bool OCRepresentation::payload_array_helper_copy<bool>(size_t index, const OCRepPayloadValue* pl)
+    std::vector<bool> OCRepresentation::payload_array_helper_row<bool>(
+            const OCRepPayloadValue* pl, size_t offset, size_t count)
     {
-        return pl->arr.bArray[index];
+        return std::vector<bool>(pl->arr.bArray + offset, pl->arr.bArray + offset + count);
     }
     template<>
-    std::string OCRepresentation::payload_array_helper_copy<std::string>(
-            size_t index, const OCRepPayloadValue* pl)
+    std::vector<std::string> OCRepresentation::payload_array_helper_row<std::string>(
+            const OCRepPayloadValue* pl, size_t offset, size_t count)
     {
-        if (pl->arr.strArray[index])
-        {
-            return std::string(pl->arr.strArray[index]);
-        }
-        else
+        std::vector<std::string> row;
+        row.reserve(count);
+        for(size_t i = offset; i < offset + count; ++i)
         {
-            return std::string{};
+            if (pl->arr.strArray[i])
+            {
+                row.emplace_back(pl->arr.strArray[i]);
+            }
+            else
+            {
+                row.emplace_back();
+            }
         }
+        return row;
     }
     template<>
-    OCRepresentation OCRepresentation::payload_array_helper_copy<OCRepresentation>(
-            size_t index, const OCRepPayloadValue* pl)
+    std::vector<OCRepresentation> OCRepresentation::payload_array_helper_row<OCRepresentation>(
+            const OCRepPayloadValue* pl, size_t offset, size_t count)
     {
-        OCRepresentation r;
-        if (pl->arr.objArray[index])
+        std::vector<OCRepresentation> row(count);
+        for(size_t i = 0; i < count; ++i)
         {
-            r.setPayload(pl->arr.objArray[index]);
+            if (pl->arr.objArray[offset + i])
+            {
+                row[i].setPayload(pl->arr.objArray[offset + i]);
+            }
         }
-        return r;
+        return row;
     }
 
     template<typename T>
     void OCRepresentation::payload_array_helper(const OCRepPayloadValue* pl, size_t depth)
     {
+        const size_t* dimensions = pl->arr.dimensions;
+
         if(depth == 1)
         {
-            std::vector<T> val(pl->arr.dimensions[0]);
-
-            for(size_t i = 0; i < pl->arr.dimensions[0]; ++i)
-            {
-                val[i] = payload_array_helper_copy<T>(i, pl);
-            }
-            this->setValue(std::string(pl->name), val);
+            m_values[pl->name] = payload_array_helper_row<T>(pl, 0, dimensions[0]);
         }
         else if (depth == 2)
         {
-            std::vector<std::vector<T>> val(pl->arr.dimensions[0]);
-            for(size_t i = 0; i < pl->arr.dimensions[0]; ++i)
+            std::vector<std::vector<T>> val;
+            val.reserve(dimensions[0]);
+            for(size_t i = 0; i < dimensions[0]; ++i)
             {
-                val[i].resize(pl->arr.dimensions[1]);
-                for(size_t j = 0; j < pl->arr.dimensions[1]; ++j)
-                {
-                    val[i][j] = payload_array_helper_copy<T>(
-                            i * pl->arr.dimensions[1] + j, pl);
-                }
+                val.push_back(payload_array_helper_row<T>(pl, i * dimensions[1], dimensions[1]));
             }
-            this->setValue(std::string(pl->name), val);
+            m_values[pl->name] = std::move(val);
         }
         else if (depth == 3)
         {
-            std::vector<std::vector<std::vector<T>>> val(pl->arr.dimensions[0]);
-            for(size_t i = 0; i < pl->arr.dimensions[0]; ++i)
+            std::vector<std::vector<std::vector<T>>> val(dimensions[0]);
+            for(size_t i = 0; i < dimensions[0]; ++i)
             {
-                val[i].resize(pl->arr.dimensions[1]);
-                for(size_t j = 0; j < pl->arr.dimensions[1]; ++j)
+                val[i].reserve(dimensions[1]);
+                for(size_t j = 0; j < dimensions[1]; ++j)
                 {
-                    val[i][j].resize(pl->arr.dimensions[2]);
-                    for(size_t k = 0; k < pl->arr.dimensions[2]; ++k)
-                    {
-                        val[i][j][k] = payload_array_helper_copy<T>(
-                                pl->arr.dimensions[2] * j +
-                                pl->arr.dimensions[2] * pl->arr.dimensions[1] * i +
-                                k,
-                                pl);
-                    }
+                    val[i].push_back(payload_array_helper_row<T>(pl,
+                            (i * dimensions[1] + j) * dimensions[2], dimensions[2]));
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            m_values[pl->name] = std::move(val);
         }
         else
         {
@@ -603,13 +618,13 @@ namespace OC
                     setValue<bool>(val->name, val->b);
                     break;
                 case OCREP_PROP_STRING:
-                    setValue<std::string>(val->name, val->str);
+                    m_values[val->name] = std::string(val->str);
                     break;
                 case OCREP_PROP_OBJECT:
                     {
                         OCRepresentation cur;
                         cur.setPayload(val->obj);
-                        setValue<OCRepresentation>(val->name, cur);
+                        m_values[val->name] = std::move(cur);
                     }
                     break;
                 case OCREP_PROP_ARRAY:
@@ -629,6 +644,11 @@ namespace OC
         m_children.push_back(rep);
     }
 
+    void OCRepresentation::addChild(OCRepresentation&& rep)
+    {
+        m_children.push_back(std::move(rep));
+    }
+
     void OCRepresentation::clearChildren()
     {
         m_children.clear();
@@ -795,7 +815,7 @@ namespace OC
 {
     OCRepresentation::AttributeItem::AttributeItem(const std::string& name,
             std::map<std::string, AttributeValue>& vals):
-            m_attrName(name), m_values(vals){}
+            m_attrName(name), m_values(vals), m_value(nullptr){}
 
     OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key)
     {
@@ -864,21 +884,21 @@ namespace OC
     AttributeType OCRepresentation::AttributeItem::type() const
     {
         type_introspection_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return vis.type;
     }
 
     AttributeType OCRepresentation::AttributeItem::base_type() const
     {
         type_introspection_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return vis.base_type;
     }
 
     size_t OCRepresentation::AttributeItem::depth() const
     {
         type_introspection_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return vis.depth;
     }
 
@@ -972,10 +992,12 @@ namespace OC
         if(m_iterator != m_item.m_values.end())
         {
             m_item.m_attrName = m_iterator->first;
+            m_item.m_value = &m_iterator->second;
         }
         else
         {
             m_item.m_attrName = "";
+            m_item.m_value = nullptr;
         }
         return *this;
     }
@@ -986,10 +1008,12 @@ namespace OC
         if(m_iterator != m_item.m_values.end())
         {
             m_item.m_attrName = m_iterator->first;
+            m_item.m_value = const_cast<AttributeValue*>(&m_iterator->second);
         }
         else
         {
             m_item.m_attrName = "";
+            m_item.m_value = nullptr;
         }
         return *this;
     }
@@ -1074,7 +1098,7 @@ namespace OC
     std::string OCRepresentation::AttributeItem::getValueToString() const
     {
         to_string_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return std::move(vis.str);
     }
 
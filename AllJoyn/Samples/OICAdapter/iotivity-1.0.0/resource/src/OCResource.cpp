@@ -374,6 +374,31 @@ OCStackResult OCResource::observe(ObserveType observeType,
     return result_guard(observe(observeType, queryParametersMap, observeHandler, defaultQoS));
 }
 
+OCStackResult OCResource::observePayload(ObserveType observeType,
+        const QueryParamsMap& queryParametersMap, ObservePayloadCallback observeHandler,
+        QualityOfService QoS)
+{
+    if(m_observeHandle != nullptr)
+    {
+        return result_guard(OC_STACK_INVALID_PARAM);
+    }
+
+    return checked_guard(m_clientWrapper.lock(), &IClientWrapper::ObserveResourcePayload,
+                         observeType, &m_observeHandle, m_devAddr,
+                         m_uri, queryParametersMap, m_headerOptions,
+                         observeHandler, QoS);
+}
+
+OCStackResult OCResource::observePayload(ObserveType observeType,
+        const QueryParamsMap& queryParametersMap, ObservePayloadCallback observeHandler)
+{
+    QualityOfService defaultQoS = OC::QualityOfService::NaQos;
+    checked_guard(m_clientWrapper.lock(), &IClientWrapper::GetDefaultQos, defaultQoS);
+
+    return result_guard(observePayload(observeType, queryParametersMap, observeHandler,
+                defaultQoS));
+}
+
 OCStackResult OCResource::cancelObserve()
 {
     QualityOfService defaultQoS = OC::QualityOfService::NaQos;
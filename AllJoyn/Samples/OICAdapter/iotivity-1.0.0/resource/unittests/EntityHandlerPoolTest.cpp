@@ -0,0 +1,173 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <EntityHandlerPool.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace EntityHandlerPoolTest
+{
+    using namespace OC;
+
+    OCResourceHandle resource(int index)
+    {
+        return reinterpret_cast<OCResourceHandle>(static_cast<intptr_t>(index + 1));
+    }
+
+    // Counts down from count, lets waiters block until it reaches 0
+    class Latch
+    {
+    public:
+        explicit Latch(int count) : m_count(count) {}
+
+        void countDown()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(--m_count <= 0)
+            {
+                m_cond.notify_all();
+            }
+        }
+
+        bool wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            return m_cond.wait_for(lock, std::chrono::seconds(10), [this] { return m_count <= 0; });
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        int m_count;
+    };
+
+    TEST(EntityHandlerPoolTest, RunsEveryTask)
+    {
+        const int tasks = 1000;
+        std::atomic<int> ran(0);
+        Latch done(tasks);
+        {
+            EntityHandlerPool pool(4);
+            for(int i = 0; i < tasks; ++i)
+            {
+                pool.post(resource(i % 7), [&ran, &done] { ++ran; done.countDown(); });
+            }
+            EXPECT_TRUE(done.wait());
+        }
+        EXPECT_EQ(tasks, ran);
+    }
+
+    TEST(EntityHandlerPoolTest, SerializesTasksOfAResource)
+    {
+        const int resources = 4;
+        const int tasksPerResource = 200;
+        std::vector<int> lastSeen(resources, -1);
+        std::vector<std::atomic<int>> running(resources);
+        std::atomic<bool> ordered(true);
+        std::atomic<bool> overlapped(false);
+        Latch done(resources * tasksPerResource);
+
+        for(auto& count : running)
+        {
+            count = 0;
+        }
+
+        EntityHandlerPool pool(4);
+        for(int i = 0; i < tasksPerResource; ++i)
+        {
+            for(int r = 0; r < resources; ++r)
+            {
+                pool.post(resource(r), [&, r, i]
+                {
+                    if(++running[r] != 1)
+                    {
+                        overlapped = true;
+                    }
+                    if(lastSeen[r] != i - 1)
+                    {
+                        ordered = false;
+                    }
+                    lastSeen[r] = i;
+                    --running[r];
+                    done.countDown();
+                });
+            }
+        }
+
+        EXPECT_TRUE(done.wait());
+        EXPECT_TRUE(ordered);
+        EXPECT_FALSE(overlapped);
+    }
+
+    TEST(EntityHandlerPoolTest, RunsResourcesInParallel)
+    {
+        // The first task blocks until the second one, posted for another resource, ran
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool secondRan = false;
+        Latch done(2);
+
+        EntityHandlerPool pool(2);
+        pool.post(resource(0), [&]
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait_for(lock, std::chrono::seconds(10), [&] { return secondRan; });
+            done.countDown();
+        });
+        pool.post(resource(1), [&]
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                secondRan = true;
+            }
+            cond.notify_all();
+            done.countDown();
+        });
+
+        EXPECT_TRUE(done.wait());
+        EXPECT_TRUE(secondRan);
+    }
+
+    TEST(EntityHandlerPoolTest, DestructionDropsQueuedTasks)
+    {
+        std::atomic<int> ran(0);
+        Latch started(1);
+        {
+            EntityHandlerPool pool(1);
+            pool.post(resource(0), [&]
+            {
+                started.countDown();
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                ++ran;
+            });
+            for(int i = 0; i < 10; ++i)
+            {
+                pool.post(resource(0), [&ran] { ++ran; });
+            }
+            EXPECT_TRUE(started.wait());
+        }
+        EXPECT_EQ(1, ran);
+    }
+}
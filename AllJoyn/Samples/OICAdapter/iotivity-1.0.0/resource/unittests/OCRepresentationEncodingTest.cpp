@@ -259,6 +259,50 @@ namespace OCRepresentationEncodingTest
         OCPayloadDestroy(cparsed);
     }
 
+    TEST(RepresentationEncoding, ExtractRepresentations)
+    {
+        OC::OCRepresentation startRep;
+        startRep.setUri("/a/parent");
+        startRep.setValue("IntAttr", 77);
+        startRep.setValue("IntVectorVector",
+                std::vector<std::vector<int>>{{1, 2, 3}, {4, 5, 6}});
+        OC::OCRepresentation child;
+        child.setUri("/a/child");
+        child.setValue("StringAttr", std::string("String attr"));
+
+        OC::MessageContainer mc1;
+        mc1.addRepresentation(startRep);
+        mc1.addRepresentation(child);
+
+        OCRepPayload* cstart = mc1.getPayload();
+
+        uint8_t* cborData;
+        size_t cborSize;
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)cstart, &cborData, &cborSize));
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OCPayloadDestroy((OCPayload*)cstart);
+        OICFree(cborData);
+
+        OC::MessageContainer mc2;
+        mc2.setPayload(cparsed);
+        OCPayloadDestroy(cparsed);
+
+        std::vector<OC::OCRepresentation> reps = mc2.extractRepresentations();
+        EXPECT_EQ(0u, mc2.representations().size());
+        ASSERT_EQ(2u, reps.size());
+
+        EXPECT_EQ("/a/parent", reps[0].getUri());
+        EXPECT_EQ(77, reps[0].getValue<int>("IntAttr"));
+        std::vector<std::vector<int>> expected{{1, 2, 3}, {4, 5, 6}};
+        EXPECT_EQ(expected,
+                reps[0].getValue<std::vector<std::vector<int>>>("IntVectorVector"));
+
+        EXPECT_EQ("/a/child", reps[1].getUri());
+        EXPECT_STREQ("String attr", reps[1].getValue<std::string>("StringAttr").c_str());
+    }
+
     TEST(RepresentationEncoding, OneDVectors)
     {
         // Setup
@@ -0,0 +1,359 @@
+//******************************************************************
+//
+// Copyright 2015 Microsoft Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Requests per second served by an OCPlatform server depending on the number
+// of entity handler threads (PlatformConfig::entityHandlerThreads, 0 runs the
+// handlers on the processing thread).
+//
+// The server registers RESOURCES resources whose entity handler either sleeps
+// (a handler waiting on a device, like the bridge adapters do) or spins (a
+// handler doing computation) before answering. The client keeps WINDOW GETs in
+// flight, spread over the resources. Each server configuration runs in its own
+// process, which is this program started again with --server.
+//
+// Sleeping handlers scale with the threads on any host; spinning handlers only
+// scale up to the number of cores.
+//
+// Usage: server_throughput_benchmark [requests] [work us]
+
+#include <OCPlatform.h>
+#include <OCApi.h>
+
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int RESOURCES = 8;
+    const int WINDOW = 32;
+    const char BENCH_RT[] = "bench.work";
+    const char SERVER_OPTION[] = "--server";
+
+    enum WorkKind
+    {
+        SLEEP_WORK,
+        SPIN_WORK,
+        WORK_KINDS
+    };
+
+    const char* const WORK_NAMES[WORK_KINDS] = { "sleep", "spin" };
+
+    std::string resourceUri(int index)
+    {
+        return "/bench/r" + std::to_string(index);
+    }
+
+    // Server side
+
+    volatile sig_atomic_t g_serverQuit = 0;
+    WorkKind g_workKind = SLEEP_WORK;
+    std::chrono::microseconds g_work(0);
+
+    void serverQuit(int /*signum*/)
+    {
+        g_serverQuit = 1;
+    }
+
+    void doWork()
+    {
+        if (g_workKind == SLEEP_WORK)
+        {
+            std::this_thread::sleep_for(g_work);
+            return;
+        }
+
+        auto end = Clock::now() + g_work;
+        while (Clock::now() < end)
+        {
+        }
+    }
+
+    OCEntityHandlerResult workHandler(std::shared_ptr<OC::OCResourceRequest> request)
+    {
+        if (!request || request->getRequestType() != "GET")
+        {
+            return OC_EH_ERROR;
+        }
+
+        doWork();
+
+        OC::OCRepresentation rep;
+        rep.setValue("value", 42);
+
+        auto response = std::make_shared<OC::OCResourceResponse>();
+        response->setRequestHandle(request->getRequestHandle());
+        response->setResourceHandle(request->getResourceHandle());
+        response->setErrorCode(200);
+        response->setResponseResult(OC_EH_OK);
+        response->setResourceRepresentation(rep);
+
+        return OC::OCPlatform::sendResponse(response) == OC_STACK_OK ? OC_EH_OK : OC_EH_ERROR;
+    }
+
+    int serve(unsigned int threads, WorkKind kind, int workUs)
+    {
+        signal(SIGTERM, serverQuit);
+        g_workKind = kind;
+        g_work = std::chrono::microseconds(workUs);
+
+        OC::PlatformConfig cfg(OC::ServiceType::InProc, OC::ModeType::Server,
+                "0.0.0.0", 0, OC::QualityOfService::LowQos);
+        cfg.entityHandlerThreads = threads;
+        OC::OCPlatform::Configure(cfg);
+
+        for (int i = 0; i < RESOURCES; ++i)
+        {
+            OCResourceHandle handle;
+            std::string uri = resourceUri(i);
+            if (OC::OCPlatform::registerResource(handle, uri, BENCH_RT, OC::DEFAULT_INTERFACE,
+                        workHandler, OC_DISCOVERABLE) != OC_STACK_OK)
+            {
+                printf("registerResource %s failed\n", uri.c_str());
+                return 1;
+            }
+        }
+
+        while (!g_serverQuit)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        return 0;
+    }
+
+    // Client side, on the C stack to keep the client out of the measurement
+
+    std::recursive_mutex g_stackLock;
+    std::mutex g_mutex;
+    std::condition_variable g_cond;
+    bool g_discovered = false;
+    OCDevAddr g_serverAddr;
+    int g_inFlight = 0;
+    int g_completed = 0;
+    int g_failed = 0;
+    std::atomic<bool> g_clientRun(true);
+
+    OCStackApplicationResult discoveryHandler(void* /*ctx*/, OCDoHandle /*handle*/,
+            OCClientResponse* clientResponse)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (clientResponse && clientResponse->result == OC_STACK_OK && !g_discovered)
+        {
+            g_serverAddr = clientResponse->devAddr;
+            g_discovered = true;
+            g_cond.notify_all();
+        }
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    OCStackApplicationResult getHandler(void* /*ctx*/, OCDoHandle /*handle*/,
+            OCClientResponse* clientResponse)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        --g_inFlight;
+        ++g_completed;
+        if (!clientResponse || clientResponse->result != OC_STACK_OK)
+        {
+            ++g_failed;
+        }
+        g_cond.notify_all();
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    void processFunc()
+    {
+        while (g_clientRun)
+        {
+            {
+                std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+                OCProcess();
+            }
+            OCProcessWait(100);
+        }
+    }
+
+    bool discover()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_discovered = false;
+        }
+
+        std::string query = std::string(OC_RSRVD_WELL_KNOWN_URI) + "?rt=" + BENCH_RT;
+        OCCallbackData cbData = { nullptr, discoveryHandler, nullptr };
+
+        // the server may still be starting, ask again until it answers
+        for (int attempt = 0; attempt < 10; ++attempt)
+        {
+            {
+                std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+                OCDoResource(nullptr, OC_REST_DISCOVER, query.c_str(), nullptr, nullptr,
+                        CT_DEFAULT, OC_LOW_QOS, &cbData, nullptr, 0);
+            }
+            std::unique_lock<std::mutex> lock(g_mutex);
+            if (g_cond.wait_for(lock, std::chrono::seconds(1), [] { return g_discovered; }))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    pid_t startServer(const char* self, unsigned int threads, WorkKind kind, int workUs)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            std::string threadsArg = std::to_string(threads);
+            std::string kindArg = std::to_string(static_cast<int>(kind));
+            std::string workArg = std::to_string(workUs);
+            execl(self, self, SERVER_OPTION, threadsArg.c_str(), kindArg.c_str(),
+                    workArg.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        return pid;
+    }
+
+    void stopServer(pid_t pid)
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    void run(const char* self, unsigned int threads, WorkKind kind, int workUs, int requests)
+    {
+        pid_t server = startServer(self, threads, kind, workUs);
+        if (!discover())
+        {
+            printf("%-6s %2u threads : the benchmark server was not discovered\n",
+                    WORK_NAMES[kind], threads);
+            stopServer(server);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_inFlight = 0;
+            g_completed = 0;
+            g_failed = 0;
+        }
+
+        std::vector<std::string> uris;
+        for (int i = 0; i < RESOURCES; ++i)
+        {
+            uris.push_back(resourceUri(i));
+        }
+
+        OCCallbackData cbData = { nullptr, getHandler, nullptr };
+        bool stalled = false;
+        auto start = Clock::now();
+
+        for (int sent = 0; sent < requests && !stalled; ++sent)
+        {
+            {
+                std::unique_lock<std::mutex> lock(g_mutex);
+                stalled = !g_cond.wait_for(lock, std::chrono::seconds(2),
+                        [] { return g_inFlight < WINDOW; });
+                ++g_inFlight;
+            }
+
+            std::lock_guard<std::recursive_mutex> lock(g_stackLock);
+            if (OCDoResource(nullptr, OC_REST_GET, uris[sent % RESOURCES].c_str(), &g_serverAddr,
+                        nullptr, CT_DEFAULT, OC_LOW_QOS, &cbData, nullptr, 0) != OC_STACK_OK)
+            {
+                std::lock_guard<std::mutex> countLock(g_mutex);
+                --g_inFlight;
+                ++g_failed;
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            stalled = !g_cond.wait_for(lock, std::chrono::seconds(2),
+                    [] { return g_inFlight <= 0; }) || stalled;
+        }
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        stopServer(server);
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        printf("%-6s %2u threads : %9.1f req/s  %d responses  %d failed%s\n",
+                WORK_NAMES[kind], threads, g_completed / seconds, g_completed, g_failed,
+                stalled ? "  (responses lost)" : "");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 5 && strcmp(argv[1], SERVER_OPTION) == 0)
+    {
+        int kind = atoi(argv[3]);
+        return (kind >= 0 && kind < WORK_KINDS) ?
+            serve(atoi(argv[2]), static_cast<WorkKind>(kind), atoi(argv[4])) : 1;
+    }
+
+    int requests = argc > 1 ? atoi(argv[1]) : 2000;
+    int workUs = argc > 2 ? atoi(argv[2]) : 1000;
+    if (requests <= 0 || workUs < 0)
+    {
+        printf("usage: %s [requests] [work us]\n", argv[0]);
+        return 1;
+    }
+
+    if (OCInit(nullptr, 0, OC_CLIENT) != OC_STACK_OK)
+    {
+        printf("OCInit failed\n");
+        return 1;
+    }
+    std::thread processThread(processFunc);
+
+    printf("%d GETs over %d resources, %d in flight, %d us of work per request, %u cores\n",
+            requests, RESOURCES, WINDOW, workUs, std::thread::hardware_concurrency());
+
+    for (int kind = 0; kind < WORK_KINDS; ++kind)
+    {
+        for (unsigned int threads : { 0, 1, 2, 4, 8 })
+        {
+            run(argv[0], threads, static_cast<WorkKind>(kind), workUs, requests);
+        }
+    }
+
+    g_clientRun = false;
+    processThread.join();
+    OCStop();
+    return 0;
+}
@@ -33,7 +33,8 @@
 #define BOOST_MPL_LIMIT_VECTOR_SIZE 30
 
 #include <functional>
-#include <unordered_map>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 #include <boost/variant.hpp>
@@ -41,7 +42,6 @@
 #include <boost/mpl/find.hpp>
 #include <boost/mpl/distance.hpp>
 #include <boost/mpl/begin_end.hpp>
-#include <boost/scoped_ptr.hpp>
 
 #include <RCSException.h>
 
@@ -57,6 +57,9 @@ namespace OIC
         * operators and accessors)<br/>
         * An attribute value can be one of various types. <br/>
         *
+        * Elements are kept in a flat array sorted by key, with keys interned and
+        * values stored inline. Copies share the same array until one of them is
+        * modified (copy-on-write), so taking a snapshot of attributes is cheap.
         *
         * @see Value
         * @see Type
@@ -130,6 +133,26 @@ namespace OIC
 
             template <typename T> struct IndexOfType;
 
+            /**
+             * A variant whose size and alignment matches ValueVariant.
+             * ValueVariant can not be a direct member of Value as RCSResourceAttributes is
+             * incomplete at that point, so Value keeps an inline storage of this layout instead.
+             * The sizes are checked against each other where both are complete.
+             */
+            typedef boost::variant<
+                std::nullptr_t,
+                int,
+                double,
+                bool,
+                std::string,
+                std::vector< int >,
+                std::vector< bool >,
+                std::shared_ptr< void >
+            > ValueVariantLayout;
+
+            struct Entry;
+            class Storage;
+
         public:
 
             /**
@@ -298,20 +321,22 @@ namespace OIC
                  *       Otherwise it won't compile.
                  */
                 template< typename T, typename = typename enable_if_supported< T >::type >
-                Value(T&& value) :
-                        m_data{ new ValueVariant{ std::forward< T >(value) } }
+                Value(T&& value)
                 {
+                    new (&m_storage) ValueVariant{ std::forward< T >(value) };
                 }
 
                 Value(const char*);
 
+                ~Value();
+
                 Value& operator=(const Value&);
                 Value& operator=(Value&&);
 
                 template< typename T, typename = typename enable_if_supported< T >::type >
                 Value& operator=(T&& rhs)
                 {
-                    *m_data = std::forward< T >(rhs);
+                    data() = std::forward< T >(rhs);
                     return *this;
                 }
 
@@ -372,7 +397,7 @@ namespace OIC
                 {
                     try
                     {
-                        return boost::get< T >(*m_data);
+                        return boost::get< T >(data());
                     }
                     catch (const boost::bad_get&)
                     {
@@ -393,8 +418,17 @@ namespace OIC
                     }
                 }
 
+                ValueVariant& data() const noexcept
+                {
+                    return *reinterpret_cast< ValueVariant* >(
+                            const_cast< InlineStorage* >(&m_storage));
+                }
+
             private:
-                boost::scoped_ptr< ValueVariant > m_data;
+                typedef std::aligned_storage< sizeof(ValueVariantLayout),
+                        std::alignment_of< ValueVariantLayout >::value >::type InlineStorage;
+
+                InlineStorage m_storage;
             };
 
             class KeyValuePair;
@@ -403,21 +437,21 @@ namespace OIC
 
         public:
             RCSResourceAttributes() = default;
-            RCSResourceAttributes(const RCSResourceAttributes&) = default;
+            RCSResourceAttributes(const RCSResourceAttributes&);
             RCSResourceAttributes(RCSResourceAttributes&&) = default;
 
-            RCSResourceAttributes& operator=(const RCSResourceAttributes&) = default;
+            RCSResourceAttributes& operator=(const RCSResourceAttributes&);
             RCSResourceAttributes& operator=(RCSResourceAttributes&&) = default;
 
             /**
              * Returns an {@link iterator} referring to the first element.
              */
-            iterator begin() noexcept;
+            iterator begin();
 
             /**
              * Returns an {@link iterator} referring to the <i>past-the-end element</i>.
              */
-            iterator end() noexcept;
+            iterator end();
 
             /**
              * @copydoc cbegin()
@@ -452,6 +486,9 @@ namespace OIC
              *
              * @return A reference to the mapped value with @a key.
              *
+             * @note Inserting or erasing an element invalidates references and iterators
+             *       to the other elements.
+             *
              * @see at
              */
             Value& operator[](const std::string& key);
@@ -547,22 +584,31 @@ namespace OIC
 
         private:
             template< typename VISITOR >
-            void visit(VISITOR& visitor) const
-            {
-                KeyValueVisitorHelper< VISITOR > helper{ visitor };
+            void visit(VISITOR& visitor) const;
 
-                for (const auto& i : m_values)
-                {
-                    boost::variant< const std::string& > key{ i.first };
-                    boost::apply_visitor(helper, key, *i.second.m_data);
-                }
-            }
+            /**
+             * Sets a value without handing out a reference to it,
+             * so the attributes can still be shared by later copies.
+             */
+            void setValue(const std::string& key, Value&& value);
+
+            /**
+             * Makes the storage exclusive to this object before modification.
+             */
+            Storage& detach();
+
+            /**
+             * Same as detach, but also prevents the storage from being shared afterwards
+             * as references to elements will be exposed.
+             */
+            Storage& detachForWrite();
 
         private:
-            std::unordered_map< std::string, Value > m_values;
+            std::shared_ptr< Storage > m_storage;
 
             //! @cond
             friend class ResourceAttributesConverter;
+            friend class RCSResourceObject;
 
             friend bool operator==(const RCSResourceAttributes&, const RCSResourceAttributes&);
             //! @endcond
@@ -784,7 +830,7 @@ namespace OIC
                 public std::iterator< std::forward_iterator_tag, RCSResourceAttributes::KeyValuePair >
         {
         private:
-            typedef std::unordered_map< std::string, Value >::iterator base_iterator;
+            typedef RCSResourceAttributes::Entry* base_iterator;
 
         public:
             iterator();
@@ -802,7 +848,7 @@ namespace OIC
             bool operator!=(const iterator&) const;
 
         private:
-            explicit iterator(base_iterator&&);
+            explicit iterator(base_iterator);
 
         private:
             base_iterator m_cur;
@@ -826,7 +872,7 @@ namespace OIC
                                        const RCSResourceAttributes::KeyValuePair >
         {
         private:
-            typedef std::unordered_map< std::string, Value >::const_iterator base_iterator;
+            typedef const RCSResourceAttributes::Entry* base_iterator;
 
         public:
             const_iterator();
@@ -846,7 +892,7 @@ namespace OIC
             bool operator!=(const const_iterator&) const;
 
         private:
-            explicit const_iterator(base_iterator&&);
+            explicit const_iterator(base_iterator);
 
         private:
             base_iterator m_cur;
@@ -857,6 +903,20 @@ namespace OIC
             //! @endcond
         };
 
+        //! @cond
+        template< typename VISITOR >
+        void RCSResourceAttributes::visit(VISITOR& visitor) const
+        {
+            KeyValueVisitorHelper< VISITOR > helper{ visitor };
+
+            for (const auto& kv : *this)
+            {
+                boost::variant< const std::string& > key{ kv.key() };
+                boost::apply_visitor(helper, key, kv.value().data());
+            }
+        }
+        //! @endcond
+
     }
 }
 
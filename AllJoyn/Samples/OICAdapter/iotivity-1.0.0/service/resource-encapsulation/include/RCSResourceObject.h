@@ -29,6 +29,7 @@
 #include <string>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 
 #include <RCSResourceAttributes.h>
 #include <RCSResponse.h>
@@ -0,0 +1,174 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Measures what an observe notification costs before a resource-encapsulation
+// callback sees it : CBOR parsing, OCRepPayload to OCRepresentation and
+// OCRepresentation to RCSResourceAttributes.
+// The representations are either moved out of the container, as the client
+// wrapper does, or copied as they used to be.
+
+#include <ResourceAttributesConverter.h>
+
+#include <OCRepresentation.h>
+#include <ocpayload.h>
+#include <ocpayloadcbor.h>
+#include <oic_malloc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace OIC::Service;
+
+namespace
+{
+    constexpr int ITERATIONS = 20000;
+
+    typedef std::chrono::steady_clock Clock;
+
+    OCRepPayload* createNotification()
+    {
+        OCRepPayload* payload = OCRepPayloadCreate();
+        OCRepPayloadSetUri(payload, "/a/sensor");
+
+        OCRepPayloadSetPropInt(payload, "temperature", 23);
+        OCRepPayloadSetPropInt(payload, "humidity", 41);
+        OCRepPayloadSetPropDouble(payload, "voltage", 3.3);
+        OCRepPayloadSetPropBool(payload, "power", true);
+        OCRepPayloadSetPropString(payload, "units", "C");
+        OCRepPayloadSetPropString(payload, "status", "operational");
+
+        int64_t samples[4 * 16];
+        for (int i = 0; i < 4 * 16; ++i) samples[i] = i;
+        size_t samplesDim[MAX_REP_ARRAY_DEPTH] = { 4, 16, 0 };
+        OCRepPayloadSetIntArray(payload, "samples", samples, samplesDim);
+
+        double history[64];
+        for (int i = 0; i < 64; ++i) history[i] = i * 0.5;
+        size_t historyDim[MAX_REP_ARRAY_DEPTH] = { 64, 0, 0 };
+        OCRepPayloadSetDoubleArray(payload, "history", history, historyDim);
+
+        const char* tags[] = { "kitchen", "floor1", "wall", "north" };
+        size_t tagsDim[MAX_REP_ARRAY_DEPTH] = { 4, 0, 0 };
+        OCRepPayloadSetStringArray(payload, "tags", tags, tagsDim);
+
+        OCRepPayload* range = OCRepPayloadCreate();
+        OCRepPayloadSetPropInt(range, "min", -40);
+        OCRepPayloadSetPropInt(range, "max", 125);
+        OCRepPayloadSetPropObjectAsOwner(payload, "range", range);
+
+        return payload;
+    }
+
+    void report(const char* name, std::vector< long long >& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+
+        long long total = 0;
+        for (auto sample : samples) total += sample;
+
+        printf("%-30s mean %8.1f us  p50 %8.1f us  p99 %8.1f us\n", name,
+                total / 1000.0 / samples.size(),
+                samples[samples.size() / 2] / 1000.0,
+                samples[samples.size() * 99 / 100] / 1000.0);
+    }
+
+    long long elapsed(Clock::time_point from, Clock::time_point to)
+    {
+        return std::chrono::duration_cast< std::chrono::nanoseconds >(to - from).count();
+    }
+
+    template< bool MOVE >
+    void run(const char* name, const uint8_t* cbor, size_t cborSize)
+    {
+        std::vector< long long > parseSamples, repSamples, attrsSamples, totalSamples;
+
+        for (int i = 0; i < ITERATIONS; ++i)
+        {
+            auto start = Clock::now();
+
+            OCPayload* payload = nullptr;
+            if (OCParsePayload(&payload, PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize)
+                    != OC_STACK_OK)
+            {
+                printf("failed to parse the payload\n");
+                return;
+            }
+
+            auto parsed = Clock::now();
+
+            OC::OCRepresentation rep;
+            {
+                OC::MessageContainer container;
+                container.setPayload(payload);
+
+                if (MOVE) rep = std::move(container.extractRepresentations()[0]);
+                else rep = container.representations()[0];
+            }
+
+            auto converted = Clock::now();
+
+            RCSResourceAttributes attrs{
+                ResourceAttributesConverter::fromOCRepresentation(rep) };
+
+            auto done = Clock::now();
+
+            OCPayloadDestroy(payload);
+
+            volatile size_t size = attrs.size();
+            (void) size;
+
+            parseSamples.push_back(elapsed(start, parsed));
+            repSamples.push_back(elapsed(parsed, converted));
+            attrsSamples.push_back(elapsed(converted, done));
+            totalSamples.push_back(elapsed(start, done));
+        }
+
+        printf("%s\n", name);
+        report("  cbor -> OCRepPayload", parseSamples);
+        report("  payload -> OCRepresentation", repSamples);
+        report("  rep -> attributes", attrsSamples);
+        report("  total", totalSamples);
+    }
+}
+
+int main()
+{
+    OCRepPayload* payload = createNotification();
+
+    uint8_t* cbor = nullptr;
+    size_t cborSize = 0;
+    if (OCConvertPayload(reinterpret_cast< OCPayload* >(payload), &cbor, &cborSize)
+            != OC_STACK_OK)
+    {
+        printf("failed to encode the payload\n");
+        return 1;
+    }
+    OCPayloadDestroy(reinterpret_cast< OCPayload* >(payload));
+
+    printf("notification : %zu bytes of CBOR, %d iterations\n", cborSize, ITERATIONS);
+
+    run< false >("copied representations", cbor, cborSize);
+    run< true >("moved representations", cbor, cborSize);
+
+    OICFree(cbor);
+    return 0;
+}
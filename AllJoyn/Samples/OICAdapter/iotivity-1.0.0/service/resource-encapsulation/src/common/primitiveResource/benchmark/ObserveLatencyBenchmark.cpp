@@ -0,0 +1,271 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Measures observe notifications end to end : from the server notifying its
+// observers to the client holding the notified RCSResourceAttributes.
+// A sensor resource and its observer live in this process and talk over the
+// loopback, and each notification is waited for before the next one is sent.
+// The observer takes the notification either through OCRepresentation, as
+// OCResource::observe delivers it, or straight from the payload, as
+// PrimitiveResource::requestObserve now does.
+
+#include <PrimitiveResource.h>
+#include <ResponseStatement.h>
+#include <ResourceAttributesConverter.h>
+
+#include <OCPlatform.h>
+#include <OCApi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+using namespace OIC::Service;
+using namespace OC;
+
+namespace
+{
+    constexpr int ITERATIONS = 2000;
+
+    constexpr char RESOURCE_URI[]{ "/a/benchmark/sensor" };
+    constexpr char RESOURCE_TYPE[]{ "oic.r.benchmark.sensor" };
+    constexpr char SEQUENCE[]{ "sequence" };
+
+    const std::chrono::seconds TIMEOUT{ 5 };
+
+    typedef std::chrono::steady_clock Clock;
+
+    std::mutex g_mutex;
+    std::condition_variable g_cond;
+
+    int g_sequence{ 0 };
+    int g_received{ -1 };
+    Clock::time_point g_sentAt;
+    std::vector< long long > g_samples;
+
+    std::shared_ptr< OCResource > g_found;
+
+    OCRepresentation createSensor(int sequence)
+    {
+        OCRepresentation rep;
+
+        rep[SEQUENCE] = sequence;
+        rep["temperature"] = 23;
+        rep["humidity"] = 41;
+        rep["voltage"] = 3.3;
+        rep["power"] = true;
+        rep["units"] = std::string{ "C" };
+        rep["status"] = std::string{ "operational" };
+
+        std::vector< std::vector< int > > samples(4, std::vector< int >(16));
+        for (int i = 0; i < 4 * 16; ++i) samples[i / 16][i % 16] = i;
+        rep["samples"] = samples;
+
+        std::vector< double > history(64);
+        for (int i = 0; i < 64; ++i) history[i] = i * 0.5;
+        rep["history"] = history;
+
+        rep["tags"] = std::vector< std::string >{ "kitchen", "floor1", "wall", "north" };
+
+        OCRepresentation range;
+        range["min"] = -40;
+        range["max"] = 125;
+        rep["range"] = range;
+
+        return rep;
+    }
+
+    OCEntityHandlerResult handleRequest(std::shared_ptr< OCResourceRequest > request)
+    {
+        if (!(request->getRequestHandlerFlag() & RequestHandlerFlag::RequestFlag)
+                || request->getRequestType() != "GET")
+        {
+            return OC_EH_OK;
+        }
+
+        int sequence;
+        {
+            std::lock_guard< std::mutex > lock{ g_mutex };
+            sequence = g_sequence;
+        }
+
+        auto response = std::make_shared< OCResourceResponse >();
+        response->setRequestHandle(request->getRequestHandle());
+        response->setResourceHandle(request->getResourceHandle());
+        response->setErrorCode(200);
+        response->setResponseResult(OC_EH_OK);
+        response->setResourceRepresentation(createSensor(sequence));
+
+        return OCPlatform::sendResponse(response) == OC_STACK_OK ? OC_EH_OK : OC_EH_ERROR;
+    }
+
+    void received(const RCSResourceAttributes& attrs)
+    {
+        auto now = Clock::now();
+
+        std::lock_guard< std::mutex > lock{ g_mutex };
+
+        if (!attrs.contains(SEQUENCE)) return;
+
+        int sequence = attrs.at(SEQUENCE).get< int >();
+        if (sequence <= g_received) return;
+
+        if (sequence > 0)
+        {
+            g_samples.push_back(
+                    std::chrono::duration_cast< std::chrono::nanoseconds >(now - g_sentAt).count());
+        }
+        g_received = sequence;
+        g_cond.notify_all();
+    }
+
+    bool waitFor(int sequence)
+    {
+        std::unique_lock< std::mutex > lock{ g_mutex };
+        return g_cond.wait_for(lock, TIMEOUT, [sequence]{ return g_received >= sequence; });
+    }
+
+    void report(const char* name, std::vector< long long >& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+
+        long long total = 0;
+        for (auto sample : samples) total += sample;
+
+        printf("%-30s mean %8.1f us  p50 %8.1f us  p99 %8.1f us\n", name,
+                total / 1000.0 / samples.size(),
+                samples[samples.size() / 2] / 1000.0,
+                samples[samples.size() * 99 / 100] / 1000.0);
+    }
+
+    // Sends ITERATIONS notifications, once the registration has been answered.
+    bool run(OCResourceHandle handle)
+    {
+        if (!waitFor(0)) return false;
+
+        for (int i = 1; i <= ITERATIONS; ++i)
+        {
+            {
+                std::lock_guard< std::mutex > lock{ g_mutex };
+                g_sequence = i;
+                g_sentAt = Clock::now();
+            }
+
+            if (OCPlatform::notifyAllObservers(handle) != OC_STACK_OK || !waitFor(i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void reset()
+    {
+        std::lock_guard< std::mutex > lock{ g_mutex };
+        g_sequence = 0;
+        g_received = -1;
+        g_samples.clear();
+    }
+
+    bool runThroughRepresentation(OCResourceHandle handle)
+    {
+        reset();
+
+        g_found->observe(ObserveType::Observe, QueryParamsMap{ },
+                [](const HeaderOptions&, const OCRepresentation& rep, int, int)
+                {
+                    received(ResourceAttributesConverter::fromOCRepresentation(rep));
+                });
+
+        bool ok = run(handle);
+        g_found->cancelObserve();
+
+        if (ok) report("through OCRepresentation", g_samples);
+        return ok;
+    }
+
+    bool runFromPayload(OCResourceHandle handle)
+    {
+        reset();
+
+        auto resource = PrimitiveResource::create(g_found);
+        resource->requestObserve(
+                [](const HeaderOptions&, const ResponseStatement& response, int, int)
+                {
+                    received(response.getAttributes());
+                });
+
+        bool ok = run(handle);
+        resource->cancelObserve();
+
+        if (ok) report("straight from the payload", g_samples);
+        return ok;
+    }
+}
+
+int main()
+{
+    PlatformConfig cfg
+    {
+        ServiceType::InProc, ModeType::Both, "0.0.0.0", 0, QualityOfService::LowQos
+    };
+    OCPlatform::Configure(cfg);
+
+    std::string uri{ RESOURCE_URI };
+    OCResourceHandle handle;
+    if (OCPlatform::registerResource(handle, uri, RESOURCE_TYPE, DEFAULT_INTERFACE,
+            handleRequest, OC_DISCOVERABLE | OC_OBSERVABLE) != OC_STACK_OK)
+    {
+        printf("failed to register the resource\n");
+        return 1;
+    }
+
+    OCPlatform::findResource("", std::string{ OC_RSRVD_WELL_KNOWN_URI } + "?rt=" + RESOURCE_TYPE,
+            CT_DEFAULT, [](std::shared_ptr< OCResource > resource)
+            {
+                std::lock_guard< std::mutex > lock{ g_mutex };
+                if (!g_found) g_found = resource;
+                g_cond.notify_all();
+            });
+
+    {
+        std::unique_lock< std::mutex > lock{ g_mutex };
+        if (!g_cond.wait_for(lock, TIMEOUT, []{ return g_found != nullptr; }))
+        {
+            printf("the resource was not found\n");
+            return 1;
+        }
+    }
+
+    printf("%d notifications each\n", ITERATIONS);
+
+    if (!runThroughRepresentation(handle) || !runFromPayload(handle))
+    {
+        printf("a notification was not received\n");
+        return 1;
+    }
+
+    OCPlatform::unregisterResource(handle);
+    return 0;
+}
@@ -0,0 +1,183 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Compares RCSResourceAttributes against the unordered_map of boxed values
+// it used to be, for building, copying and looking up typical sensor attributes.
+
+#include <RCSResourceAttributes.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+using namespace OIC::Service;
+
+namespace
+{
+    std::atomic< size_t > g_allocCount{ 0 };
+
+    constexpr int ITERATIONS = 100000;
+
+    const char* const KEYS[] =
+    {
+        "temperature", "humidity", "units", "power", "range", "value", "name", "status"
+    };
+
+    // The representation before the flat storage : a node per element and a boxed value.
+    class LegacyValue
+    {
+    public:
+        LegacyValue() : m_value{ new RCSResourceAttributes::Value{ } } { }
+        LegacyValue(const LegacyValue& from) :
+            m_value{ new RCSResourceAttributes::Value{ *from.m_value } } { }
+
+        LegacyValue& operator=(int v)
+        {
+            *m_value = v;
+            return *this;
+        }
+
+        LegacyValue& operator=(const char* v)
+        {
+            *m_value = v;
+            return *this;
+        }
+
+        const RCSResourceAttributes::Value& get() const { return *m_value; }
+
+    private:
+        std::unique_ptr< RCSResourceAttributes::Value > m_value;
+    };
+
+    typedef std::unordered_map< std::string, LegacyValue > LegacyAttributes;
+
+    template< typename ATTRS >
+    ATTRS build(int count)
+    {
+        ATTRS attrs;
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (i % 2) attrs[KEYS[i]] = i;
+            else attrs[KEYS[i]] = "text";
+        }
+
+        return attrs;
+    }
+
+    const RCSResourceAttributes::Value& lookup(const RCSResourceAttributes& attrs,
+            const std::string& key)
+    {
+        return attrs.at(key);
+    }
+
+    const RCSResourceAttributes::Value& lookup(const LegacyAttributes& attrs,
+            const std::string& key)
+    {
+        return attrs.at(key).get();
+    }
+
+    template< typename FUNC >
+    void measure(const char* name, int count, FUNC&& func)
+    {
+        g_allocCount = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < ITERATIONS; ++i)
+        {
+            func();
+        }
+
+        auto elapsed = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                std::chrono::steady_clock::now() - start).count();
+
+        printf("%-32s %2d attrs : %8.1f ns/op %6.2f allocs/op\n", name, count,
+                static_cast< double >(elapsed) / ITERATIONS,
+                static_cast< double >(g_allocCount) / ITERATIONS);
+    }
+
+    template< typename ATTRS >
+    void runSuite(const char* name, int count)
+    {
+        std::string label{ name };
+
+        measure((label + " build").c_str(), count, [count]
+        {
+            volatile size_t size = build< ATTRS >(count).size();
+            (void) size;
+        });
+
+        const ATTRS source = build< ATTRS >(count);
+
+        measure((label + " copy").c_str(), count, [&source]
+        {
+            ATTRS copied{ source };
+            volatile size_t size = copied.size();
+            (void) size;
+        });
+
+        // A copy which nobody has written through, like a snapshot handed to observers.
+        const ATTRS snapshot{ source };
+
+        measure((label + " copy snapshot").c_str(), count, [&snapshot]
+        {
+            ATTRS copied{ snapshot };
+            volatile size_t size = copied.size();
+            (void) size;
+        });
+
+        const std::string key{ KEYS[count - 1] };
+        measure((label + " lookup").c_str(), count, [&source, &key]
+        {
+            volatile bool isInt = lookup(source, key).getType()
+                    == RCSResourceAttributes::Type::typeOf< int >();
+            (void) isInt;
+        });
+    }
+}
+
+void* operator new(size_t size)
+{
+    ++g_allocCount;
+
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{ };
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    for (int count : { 2, 4, 8 })
+    {
+        runSuite< LegacyAttributes >("unordered_map", count);
+        runSuite< RCSResourceAttributes >("RCSResourceAttributes", count);
+    }
+
+    return 0;
+}
@@ -27,6 +27,8 @@
 
 #include <ResourceAttributesConverter.h>
 
+#include <thread>
+
 namespace OIC
 {
     namespace Service
@@ -65,13 +67,21 @@ namespace OIC
                 checkedCall(resource, cb, headerOptions, createResponseStatement(rep), errorCode);
             }
 
+            // Runs on the stack's thread, which owns the payload, so the attributes are
+            // read here and handed to the callback on a thread of its own.
             static void safeObserveCallback(const std::weak_ptr< const PrimitiveResource >& res,
                     const PrimitiveResource::ObserveCallback& cb,
-                    const HeaderOptions& headerOptions, const OC::OCRepresentation& rep,
+                    const HeaderOptions& headerOptions, const OCRepPayload* payload,
                     int errorCode, int sequenceNumber)
             {
-                checkedCall(res, cb, headerOptions, createResponseStatement(rep), errorCode,
-                        sequenceNumber);
+                std::shared_ptr< ResponseStatement > response{ new ResponseStatement{
+                    ResponseStatement::create(
+                            ResourceAttributesConverter::fromOCRepPayload(payload)) } };
+
+                std::thread{ [res, cb, headerOptions, response, errorCode, sequenceNumber]()
+                {
+                    checkedCall(res, cb, headerOptions, *response, errorCode, sequenceNumber);
+                } }.detach();
             }
 
             std::weak_ptr< PrimitiveResource > WeakFromThis()
@@ -123,9 +133,10 @@ namespace OIC
                 using namespace std::placeholders;
 
                 typedef OCStackResult (BaseResource::*ObserveFunc)(OC::ObserveType,
-                        const OC::QueryParamsMap&, OC::ObserveCallback);
+                        const OC::QueryParamsMap&, OC::ObservePayloadCallback);
 
-                invokeOC(m_baseResource, static_cast< ObserveFunc >(&BaseResource::observe),
+                invokeOC(m_baseResource,
+                        static_cast< ObserveFunc >(&BaseResource::observePayload),
                         OC::ObserveType::ObserveAll, OC::QueryParamsMap{ },
                         std::bind(safeObserveCallback, WeakFromThis(),
                                                        std::move(callback), _1, _2, _3, _4));
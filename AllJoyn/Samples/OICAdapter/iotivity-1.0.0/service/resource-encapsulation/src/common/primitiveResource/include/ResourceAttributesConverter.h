@@ -22,8 +22,10 @@
 #define COMMON_RESOURCEATTRIBUTESCONVERTER_H
 
 #include <RCSResourceAttributes.h>
+#include <RCSException.h>
 
 #include <OCRepresentation.h>
+#include <octypes.h>
 
 namespace OIC
 {
@@ -200,13 +202,137 @@ namespace OIC
                 template< typename T >
                 void putValue(const std::string& key, T&& value)
                 {
-                    m_target[key] = std::forward< T >(value);
+                    m_target.setValue(key, RCSResourceAttributes::Value{ std::forward< T >(value) });
                 }
 
             private:
                 RCSResourceAttributes m_target;
             };
 
+            // Builds attributes straight from a decoded payload, reading its arrays
+            // in place rather than through an OCRepresentation.
+            class PayloadAttributesBuilder
+            {
+            private:
+                static int convert(int64_t value) { return static_cast< int >(value); }
+                static double convert(double value) { return value; }
+                static bool convert(bool value) { return value; }
+                static std::string convert(const char* value) { return value ? value : ""; }
+
+                static RCSResourceAttributes convert(const OCRepPayload* value)
+                {
+                    return ResourceAttributesConverter::fromOCRepPayload(value);
+                }
+
+                template< typename T, typename E >
+                static std::vector< T > row(const E* elements, size_t offset, size_t size)
+                {
+                    std::vector< T > result;
+                    result.reserve(size);
+
+                    for (size_t i = 0; i < size; ++i)
+                    {
+                        result.push_back(convert(elements[offset + i]));
+                    }
+
+                    return result;
+                }
+
+                template< typename T, typename E >
+                static RCSResourceAttributes::Value array(const size_t* dimensions,
+                        const E* elements)
+                {
+                    if (dimensions[1] == 0)
+                    {
+                        return RCSResourceAttributes::Value{
+                            row< T >(elements, 0, dimensions[0]) };
+                    }
+
+                    if (dimensions[2] == 0)
+                    {
+                        std::vector< std::vector< T > > result;
+                        result.reserve(dimensions[0]);
+
+                        for (size_t i = 0; i < dimensions[0]; ++i)
+                        {
+                            result.push_back(row< T >(elements, i * dimensions[1], dimensions[1]));
+                        }
+
+                        return RCSResourceAttributes::Value{ std::move(result) };
+                    }
+
+                    std::vector< std::vector< std::vector< T > > > result(dimensions[0]);
+
+                    for (size_t i = 0; i < dimensions[0]; ++i)
+                    {
+                        result[i].reserve(dimensions[1]);
+
+                        for (size_t j = 0; j < dimensions[1]; ++j)
+                        {
+                            result[i].push_back(row< T >(elements,
+                                    (i * dimensions[1] + j) * dimensions[2], dimensions[2]));
+                        }
+                    }
+
+                    return RCSResourceAttributes::Value{ std::move(result) };
+                }
+
+                static RCSResourceAttributes::Value array(const OCRepPayloadValueArray& arr)
+                {
+                    switch (arr.type)
+                    {
+                        case OCREP_PROP_INT:
+                            return array< int >(arr.dimensions, arr.iArray);
+
+                        case OCREP_PROP_DOUBLE:
+                            return array< double >(arr.dimensions, arr.dArray);
+
+                        case OCREP_PROP_BOOL:
+                            return array< bool >(arr.dimensions, arr.bArray);
+
+                        case OCREP_PROP_STRING:
+                            return array< std::string >(arr.dimensions, arr.strArray);
+
+                        case OCREP_PROP_OBJECT:
+                            return array< RCSResourceAttributes >(arr.dimensions, arr.objArray);
+
+                        default:
+                            throw RCSException{ "Unsupported array type in payload" };
+                    }
+                }
+
+            public:
+                static RCSResourceAttributes::Value value(const OCRepPayloadValue& item)
+                {
+                    switch (item.type)
+                    {
+                        case OCREP_PROP_NULL:
+                            return RCSResourceAttributes::Value{ nullptr };
+
+                        case OCREP_PROP_INT:
+                            return RCSResourceAttributes::Value{ convert(item.i) };
+
+                        case OCREP_PROP_DOUBLE:
+                            return RCSResourceAttributes::Value{ item.d };
+
+                        case OCREP_PROP_BOOL:
+                            return RCSResourceAttributes::Value{ item.b };
+
+                        case OCREP_PROP_STRING:
+                            return RCSResourceAttributes::Value{ convert(item.str) };
+
+                        case OCREP_PROP_OBJECT:
+                            return RCSResourceAttributes::Value{ convert(item.obj) };
+
+                        case OCREP_PROP_ARRAY:
+                            return array(item.arr);
+
+                        default:
+                            throw RCSException{ "Unsupported value type in payload" };
+                    }
+                }
+            };
+
             class OCRepresentationBuilder
             {
             public:
@@ -276,6 +402,22 @@ namespace OIC
                 return builder.extract();
             }
 
+            /**
+             * Converts a decoded representation payload without building an
+             * OC::OCRepresentation first.  The payload is only read.
+             */
+            static RCSResourceAttributes fromOCRepPayload(const OCRepPayload* payload)
+            {
+                RCSResourceAttributes attrs;
+
+                for (auto item = payload ? payload->values : nullptr; item; item = item->next)
+                {
+                    attrs.setValue(item->name, PayloadAttributesBuilder::value(*item));
+                }
+
+                return attrs;
+            }
+
             static OC::OCRepresentation toOCRepresentation(
                     const RCSResourceAttributes& resourceAttributes)
             {
@@ -23,16 +23,73 @@
 #include <ResourceAttributesUtils.h>
 #include <ResourceAttributesConverter.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+
 #include <boost/lexical_cast.hpp>
 #include <boost/mpl/advance.hpp>
 #include <boost/mpl/size.hpp>
 #include <boost/mpl/deref.hpp>
+#include <boost/container/small_vector.hpp>
 
 namespace
 {
 
     using namespace OIC::Service;
 
+    typedef std::shared_ptr< const std::string > InternedKey;
+
+    // Typical resources have a handful of attributes;
+    // they fit in the storage itself without another allocation.
+    constexpr size_t INLINE_ENTRY_COUNT = 8;
+
+    // Keys from the network are not trusted to be a bounded set,
+    // so only this many are interned and the rest are owned by each storage.
+    constexpr size_t MAX_INTERNED_KEY_COUNT = 4096;
+    constexpr size_t MAX_INTERNED_KEY_LENGTH = 64;
+
+    class KeyPool
+    {
+    public:
+        static KeyPool& getInstance()
+        {
+            static KeyPool instance;
+            return instance;
+        }
+
+        InternedKey intern(const std::string& key)
+        {
+            if (key.size() <= MAX_INTERNED_KEY_LENGTH)
+            {
+                std::lock_guard< std::mutex > lock{ m_mutex };
+
+                auto it = m_keys.find(key);
+                if (it == m_keys.end() && m_keys.size() < MAX_INTERNED_KEY_COUNT)
+                {
+                    it = m_keys.insert(key).first;
+                }
+
+                if (it != m_keys.end())
+                {
+                    // Pooled keys live as long as the process,
+                    // so they are shared without reference counting.
+                    return InternedKey{ std::shared_ptr< void >{ }, &*it };
+                }
+            }
+
+            return std::make_shared< const std::string >(key);
+        }
+
+    private:
+        KeyPool() = default;
+
+    private:
+        std::mutex m_mutex;
+        std::unordered_set< std::string > m_keys;
+    };
+
     class ToStringVisitor: public boost::static_visitor< std::string >
     {
     public:
@@ -219,6 +276,81 @@ namespace OIC
     namespace Service
     {
 
+        struct RCSResourceAttributes::Entry
+        {
+            InternedKey key;
+            Value value;
+        };
+
+        class RCSResourceAttributes::Storage
+        {
+        public:
+            typedef boost::container::small_vector< Entry, INLINE_ENTRY_COUNT > Entries;
+
+            Storage() = default;
+
+            Storage(const Storage& from) :
+                m_entries(from.m_entries),
+                m_shareable{ true }
+            {
+            }
+
+            Storage& operator=(const Storage&) = delete;
+
+            // Entries are ordered by length first, so most mismatches are decided
+            // without comparing characters.
+            Entries::iterator lowerBound(const std::string& key)
+            {
+                return std::lower_bound(m_entries.begin(), m_entries.end(), key,
+                        [](const Entry& entry, const std::string& key)
+                        {
+                            if (entry.key->size() != key.size())
+                            {
+                                return entry.key->size() < key.size();
+                            }
+                            return entry.key->compare(key) < 0;
+                        });
+            }
+
+            Entries::const_iterator find(const std::string& key) const
+            {
+                // A linear scan beats the binary search for the few entries kept inline.
+                if (m_entries.size() <= INLINE_ENTRY_COUNT)
+                {
+                    return std::find_if(m_entries.begin(), m_entries.end(),
+                            [&key](const Entry& entry)
+                            {
+                                return *entry.key == key;
+                            });
+                }
+
+                auto it = const_cast< Storage* >(this)->lowerBound(key);
+                return it != m_entries.end() && *it->key == key ? it : m_entries.end();
+            }
+
+            Value& getOrInsert(const std::string& key)
+            {
+                auto it = lowerBound(key);
+
+                if (it == m_entries.end() || *it->key != key)
+                {
+                    it = m_entries.insert(it, Entry{ KeyPool::getInstance().intern(key), Value{ } });
+                }
+
+                return it->value;
+            }
+
+        public:
+            Entries m_entries;
+
+            // False once a reference to an element has been handed out;
+            // such a storage is copied instead of shared, as the reference can modify it.
+            bool m_shareable{ true };
+        };
+
+        static_assert(sizeof(RCSResourceAttributes) == sizeof(std::shared_ptr< void >),
+                "RCSResourceAttributes must have the size assumed by ValueVariantLayout.");
+
         RCSResourceAttributes::Value::ComparisonHelper::ComparisonHelper(const Value& v) :
                 m_valueRef(v)
         {
@@ -227,7 +359,7 @@ namespace OIC
         bool RCSResourceAttributes::Value::ComparisonHelper::operator==
                 (const Value::ComparisonHelper& rhs) const
         {
-            return *m_valueRef.m_data == *rhs.m_valueRef.m_data;
+            return m_valueRef.data() == rhs.m_valueRef.data();
         }
 
         bool operator==(const RCSResourceAttributes::Type& lhs,
@@ -256,7 +388,28 @@ namespace OIC
 
         bool operator==(const RCSResourceAttributes& lhs, const RCSResourceAttributes& rhs)
         {
-            return lhs.m_values == rhs.m_values;
+            if (lhs.m_storage == rhs.m_storage)
+            {
+                return true;
+            }
+
+            if (lhs.size() != rhs.size())
+            {
+                return false;
+            }
+
+            if (lhs.empty())
+            {
+                return true;
+            }
+
+            // Entries are sorted by key, so equal attributes have equal entries in order.
+            return std::equal(lhs.m_storage->m_entries.begin(), lhs.m_storage->m_entries.end(),
+                    rhs.m_storage->m_entries.begin(),
+                    [](const RCSResourceAttributes::Entry& l, const RCSResourceAttributes::Entry& r)
+                    {
+                        return *l.key == *r.key && l.value == r.value;
+                    });
         }
 
         bool operator!=(const RCSResourceAttributes& lhs, const RCSResourceAttributes& rhs)
@@ -280,83 +433,94 @@ namespace OIC
         }
 
 
-        RCSResourceAttributes::Value::Value() :
-                m_data{ new ValueVariant{} }
+        RCSResourceAttributes::Value::Value()
+        {
+            static_assert(sizeof(InlineStorage) >= sizeof(ValueVariant),
+                    "The inline storage of Value is too small for ValueVariant.");
+            static_assert(std::alignment_of< InlineStorage >::value
+                    % std::alignment_of< ValueVariant >::value == 0,
+                    "The inline storage of Value is misaligned for ValueVariant.");
+
+            new (&m_storage) ValueVariant{ };
+        }
+
+        RCSResourceAttributes::Value::Value(const Value& from)
         {
+            new (&m_storage) ValueVariant{ from.data() };
         }
 
-        RCSResourceAttributes::Value::Value(const Value& from) :
-                m_data{ new ValueVariant{ *from.m_data } }
+        RCSResourceAttributes::Value::Value(Value&& from) noexcept
         {
+            new (&m_storage) ValueVariant{ std::move(from.data()) };
+            from.data() = nullptr;
         }
 
-        RCSResourceAttributes::Value::Value(Value&& from) noexcept :
-                m_data{ new ValueVariant{} }
+        RCSResourceAttributes::Value::Value(const char* value)
         {
-            m_data.swap(from.m_data);
+            new (&m_storage) ValueVariant{ std::string{ value } };
         }
 
-        RCSResourceAttributes::Value::Value(const char* value) :
-                m_data{ new ValueVariant{ std::string{ value } } }
+        RCSResourceAttributes::Value::~Value()
         {
+            data().~ValueVariant();
         }
 
         auto RCSResourceAttributes::Value::operator=(const Value& rhs) -> Value&
         {
-            *m_data = *rhs.m_data;
+            data() = rhs.data();
             return *this;
         }
 
         auto RCSResourceAttributes::Value::operator=(Value&& rhs) -> Value&
         {
-            *m_data = ValueVariant{};
-            m_data->swap(*rhs.m_data);
+            data() = std::move(rhs.data());
+            rhs.data() = nullptr;
             return *this;
         }
 
         auto RCSResourceAttributes::Value::operator=(const char* rhs) -> Value&
         {
-            *m_data = std::string{ rhs };
+            data() = std::string{ rhs };
             return *this;
         }
 
         auto RCSResourceAttributes::Value::operator=(std::nullptr_t) -> Value&
         {
-            *m_data = nullptr;
+            data() = nullptr;
             return *this;
         }
 
         auto RCSResourceAttributes::Value::getType() const -> Type
         {
-            return boost::apply_visitor(TypeVisitor(), *m_data);
+            return boost::apply_visitor(TypeVisitor(), data());
         }
 
         std::string RCSResourceAttributes::Value::toString() const
         {
-            return boost::apply_visitor(ToStringVisitor(), *m_data);
+            return boost::apply_visitor(ToStringVisitor(), data());
         }
 
         void RCSResourceAttributes::Value::swap(Value& rhs) noexcept
         {
-            m_data.swap(rhs.m_data);
+            data().swap(rhs.data());
         }
 
         auto RCSResourceAttributes::KeyValuePair::KeyVisitor::operator()(
                 iterator* iter) const noexcept -> result_type
         {
-            return iter->m_cur->first;
+            return *iter->m_cur->key;
         }
 
         auto RCSResourceAttributes::KeyValuePair::KeyVisitor::operator()(
                 const_iterator* iter) const noexcept -> result_type
         {
-            return iter->m_cur->first;
+            return *iter->m_cur->key;
         }
 
         auto RCSResourceAttributes::KeyValuePair::ValueVisitor::operator() (iterator* iter) noexcept
                 -> result_type
         {
-            return iter->m_cur->second;
+            return iter->m_cur->value;
         }
 
         auto RCSResourceAttributes::KeyValuePair::ValueVisitor::operator() (const_iterator*)
@@ -369,13 +533,13 @@ namespace OIC
         auto RCSResourceAttributes::KeyValuePair::ConstValueVisitor::operator()(
                 iterator*iter) const noexcept -> result_type
         {
-            return iter->m_cur->second;
+            return iter->m_cur->value;
         }
 
         auto RCSResourceAttributes::KeyValuePair::ConstValueVisitor::operator()(
                 const_iterator* iter) const noexcept -> result_type
         {
-            return iter->m_cur->second;
+            return iter->m_cur->value;
         }
 
         auto RCSResourceAttributes::KeyValuePair::key() const noexcept -> const std::string&
@@ -401,13 +565,13 @@ namespace OIC
 
 
         RCSResourceAttributes::iterator::iterator() :
-                m_cur{ base_iterator{ } },
+                m_cur{ nullptr },
                 m_keyValuePair{ this }
         {
         }
 
-        RCSResourceAttributes::iterator::iterator(base_iterator&& iter) :
-                m_cur{ std::move(iter) },
+        RCSResourceAttributes::iterator::iterator(base_iterator iter) :
+                m_cur{ iter },
                 m_keyValuePair{ this }
         {
         }
@@ -447,11 +611,11 @@ namespace OIC
 
 
         RCSResourceAttributes::const_iterator::const_iterator() :
-                m_cur{ base_iterator{} }, m_keyValuePair{ this }
+                m_cur{ nullptr }, m_keyValuePair{ this }
         {
         }
 
-        RCSResourceAttributes::const_iterator::const_iterator(base_iterator&& iter) :
+        RCSResourceAttributes::const_iterator::const_iterator(base_iterator iter) :
                 m_cur{ iter }, m_keyValuePair{ this }
         {
         }
@@ -503,93 +667,150 @@ namespace OIC
         }
 
 
-        auto RCSResourceAttributes::begin() noexcept -> iterator
+        RCSResourceAttributes::RCSResourceAttributes(const RCSResourceAttributes& from) :
+                m_storage{ from.m_storage }
+        {
+            if (m_storage && !m_storage->m_shareable)
+            {
+                m_storage = std::make_shared< Storage >(*m_storage);
+            }
+        }
+
+        auto RCSResourceAttributes::operator=(const RCSResourceAttributes& rhs)
+                -> RCSResourceAttributes&
+        {
+            RCSResourceAttributes{ rhs }.m_storage.swap(m_storage);
+            return *this;
+        }
+
+        auto RCSResourceAttributes::detach() -> Storage&
+        {
+            if (!m_storage)
+            {
+                m_storage = std::make_shared< Storage >();
+            }
+            else if (!m_storage.unique())
+            {
+                m_storage = std::make_shared< Storage >(*m_storage);
+            }
+            else
+            {
+                // Pairs with the release of the other owners,
+                // whose reads must be done before this modifies the storage.
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+
+            return *m_storage;
+        }
+
+        auto RCSResourceAttributes::detachForWrite() -> Storage&
+        {
+            auto& storage = detach();
+            storage.m_shareable = false;
+            return storage;
+        }
+
+        void RCSResourceAttributes::setValue(const std::string& key, Value&& value)
+        {
+            detach().getOrInsert(key) = std::move(value);
+        }
+
+        auto RCSResourceAttributes::begin() -> iterator
         {
-            return iterator{ m_values.begin() };
+            return iterator{ detachForWrite().m_entries.data() };
         }
 
-        auto RCSResourceAttributes::end() noexcept -> iterator
+        auto RCSResourceAttributes::end() -> iterator
         {
-            return iterator{ m_values.end() };
+            auto& entries = detachForWrite().m_entries;
+            return iterator{ entries.data() + entries.size() };
         }
 
         auto RCSResourceAttributes::begin() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.begin() };
+            return cbegin();
         }
 
         auto RCSResourceAttributes::end() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.end() };
+            return cend();
         }
 
         auto RCSResourceAttributes::cbegin() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.begin() };
+            return const_iterator{ m_storage ? m_storage->m_entries.data() : nullptr };
         }
 
         auto RCSResourceAttributes::cend() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.end() };
+            return const_iterator{ m_storage ?
+                    m_storage->m_entries.data() + m_storage->m_entries.size() : nullptr };
         }
 
         auto RCSResourceAttributes::operator[](const std::string& key) -> Value&
         {
-            return m_values[key];
+            return detachForWrite().getOrInsert(key);
         }
 
         auto RCSResourceAttributes::operator[](std::string&& key) -> Value&
         {
-            return m_values[std::move(key)];
+            return detachForWrite().getOrInsert(key);
         }
 
         auto RCSResourceAttributes::at(const std::string& key) -> Value&
         {
-            try
-            {
-                return m_values.at(key);
-            }
-            catch (const std::out_of_range&)
+            if (!contains(key))
             {
                 throw RCSInvalidKeyException{ "No attribute named '" + key + "'" };
             }
+
+            return detachForWrite().lowerBound(key)->value;
         }
 
         auto RCSResourceAttributes::at(const std::string& key) const -> const Value&
         {
-            try
-            {
-                return m_values.at(key);
-            }
-            catch (const std::out_of_range&)
+            if (m_storage)
             {
-                throw RCSInvalidKeyException{ "No attribute named '" + key + "'" };
+                auto it = m_storage->find(key);
+                if (it != m_storage->m_entries.end())
+                {
+                    return it->value;
+                }
             }
+
+            throw RCSInvalidKeyException{ "No attribute named '" + key + "'" };
         }
 
         void RCSResourceAttributes::clear() noexcept
         {
-            return m_values.clear();
+            m_storage.reset();
         }
 
         bool RCSResourceAttributes::erase(const std::string& key)
         {
-            return m_values.erase(key) == 1U;
+            if (!contains(key))
+            {
+                return false;
+            }
+
+            auto& storage = detach();
+            storage.m_entries.erase(storage.lowerBound(key));
+            return true;
         }
 
         bool RCSResourceAttributes::contains(const std::string& key) const
         {
-            return m_values.find(key) != m_values.end();
+            return m_storage && m_storage->find(key) != m_storage->m_entries.end();
         }
 
         bool RCSResourceAttributes::empty() const noexcept
         {
-            return m_values.empty();
+            return size() == 0;
         }
 
         size_t RCSResourceAttributes::size() const noexcept
         {
-            return m_values.size();
+            return m_storage ? m_storage->m_entries.size() : 0;
         }
 
 
@@ -40,8 +40,8 @@ public:
     virtual OCStackResult put(
             const OC::OCRepresentation&, const OC::QueryParamsMap&, OC::PutCallback) = 0;
 
-    virtual OCStackResult observe(
-            OC::ObserveType, const OC::QueryParamsMap&, OC::ObserveCallback) = 0;
+    virtual OCStackResult observePayload(
+            OC::ObserveType, const OC::QueryParamsMap&, OC::ObservePayloadCallback) = 0;
 
     virtual OCStackResult cancelObserve() = 0;
 
@@ -118,16 +118,16 @@ TEST_F(PrimitiveResourceTest, RequestSetPassResourceAttributesToOCResourcePut)
     resource->requestSet(attrs, PrimitiveResource::SetCallback());
 }
 
-TEST_F(PrimitiveResourceTest, RequestObserveInvokesOCResourceObserve)
+TEST_F(PrimitiveResourceTest, RequestObserveInvokesOCResourceObservePayload)
 {
-    mocks.ExpectCall(fakeResource, FakeOCResource::observe).Return(OC_STACK_OK);
+    mocks.ExpectCall(fakeResource, FakeOCResource::observePayload).Return(OC_STACK_OK);
 
     resource->requestObserve(PrimitiveResource::ObserveCallback());
 }
 
-TEST_F(PrimitiveResourceTest, RequestObserveThrowsOCResourceObserveReturnsNotOK)
+TEST_F(PrimitiveResourceTest, RequestObserveThrowsOCResourceObservePayloadReturnsNotOK)
 {
-    mocks.OnCall(fakeResource, FakeOCResource::observe).Return(OC_STACK_ERROR);
+    mocks.OnCall(fakeResource, FakeOCResource::observePayload).Return(OC_STACK_ERROR);
 
     ASSERT_THROW(resource->requestObserve(PrimitiveResource::ObserveCallback()), RCSPlatformException);
 }
@@ -22,6 +22,8 @@
 #include <ResourceAttributesConverter.h>
 #include <ResourceAttributesUtils.h>
 
+#include <ocpayload.h>
+
 #include <gtest/gtest.h>
 
 using namespace testing;
@@ -146,6 +148,38 @@ TEST_F(ResourceAttributesTest, ToStringReturnsEmptyStringForNullValue)
     ASSERT_EQ("", resourceAttributes[KEY].toString());
 }
 
+TEST_F(ResourceAttributesTest, CopyIsNotAffectedByChangesOfOriginal)
+{
+    resourceAttributes[KEY] = 1;
+
+    const RCSResourceAttributes copied{ resourceAttributes };
+    resourceAttributes[KEY] = 2;
+
+    ASSERT_EQ(1, copied.at(KEY));
+}
+
+TEST_F(ResourceAttributesTest, CopyIsNotAffectedByReferenceTakenBeforeCopied)
+{
+    auto& valueRef = resourceAttributes[KEY];
+
+    const RCSResourceAttributes copied{ resourceAttributes };
+    valueRef = 2;
+
+    ASSERT_EQ(nullptr, copied.at(KEY));
+}
+
+TEST_F(ResourceAttributesTest, AttributesWithSameValuesInDifferentOrderAreEqual)
+{
+    RCSResourceAttributes other;
+
+    resourceAttributes["a"] = 1;
+    resourceAttributes["b"] = 2;
+    other["b"] = 2;
+    other["a"] = 1;
+
+    ASSERT_EQ(resourceAttributes, other);
+}
+
 
 class ResourceAttributesIteratorTest: public Test
 {
@@ -439,6 +473,73 @@ TEST(ResourceAttributesConverterTest, OCRepresentationWithSequenceTypeCanBeConve
     ASSERT_EQ(seq, resourceAttributes[KEY]);
 }
 
+TEST(ResourceAttributesConverterTest, OCRepPayloadCanBeConvertedIntoResourceAttributes)
+{
+    constexpr double value = 9876;
+    OCRepPayload* payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropDouble(payload, KEY, value);
+
+    RCSResourceAttributes resourceAttributes{
+        ResourceAttributesConverter::fromOCRepPayload(payload) };
+    OCRepPayloadDestroy(payload);
+
+    ASSERT_TRUE(value == resourceAttributes[KEY]);
+}
+
+TEST(ResourceAttributesConverterTest, NullOCRepPayloadIsEmptyResourceAttributes)
+{
+    ASSERT_TRUE(ResourceAttributesConverter::fromOCRepPayload(nullptr).empty());
+}
+
+TEST(ResourceAttributesConverterTest, OCRepPayloadConvertsAsItsOCRepresentationDoes)
+{
+    typedef std::vector< std::vector< std::vector< std::string > > > NestedVector;
+
+    OC::OCRepresentation nested;
+    nested[KEY] = std::string{ "nested" };
+
+    OC::OCRepresentation ocRep;
+    NestedVector seq(3, NestedVector::value_type(2, std::vector< std::string >(4)));
+    seq[1][1][3] = "some_string";
+    ocRep[KEY] = seq;
+    ocRep["int"] = 10;
+    ocRep["bool"] = true;
+    ocRep["ints"] = std::vector< std::vector< int > >{ { 1, 2, 3 }, { 4, 5, 6 } };
+    ocRep["nested"] = nested;
+    ocRep["objects"] = std::vector< OC::OCRepresentation >{ nested, nested };
+    ocRep.setNULL("null");
+
+    OCRepPayload* payload = ocRep.getPayload();
+
+    RCSResourceAttributes resourceAttributes{
+        ResourceAttributesConverter::fromOCRepPayload(payload) };
+    OCRepPayloadDestroy(payload);
+
+    ASSERT_EQ(ResourceAttributesConverter::fromOCRepresentation(ocRep), resourceAttributes);
+}
+
+TEST(ResourceAttributesConverterTest, JaggedSequenceIsRectangularInOCRepPayload)
+{
+    typedef std::vector< std::vector< std::vector< std::string > > > NestedVector;
+
+    OC::OCRepresentation ocRep;
+    NestedVector seq(3);
+    seq[1].resize(2, std::vector< std::string >(4));
+    seq[1][1][3] = "some_string";
+    ocRep[KEY] = seq;
+
+    OCRepPayload* payload = ocRep.getPayload();
+
+    RCSResourceAttributes resourceAttributes{
+        ResourceAttributesConverter::fromOCRepPayload(payload) };
+    OCRepPayloadDestroy(payload);
+
+    NestedVector expected(3, NestedVector::value_type(2, std::vector< std::string >(4)));
+    expected[1][1][3] = "some_string";
+
+    ASSERT_EQ(expected, resourceAttributes[KEY]);
+}
+
 
 class ResourceAttributesUtilTest: public Test
 {
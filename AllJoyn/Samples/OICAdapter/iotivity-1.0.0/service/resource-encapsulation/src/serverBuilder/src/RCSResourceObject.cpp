@@ -234,7 +234,8 @@ namespace OIC
                     valueUpdated = testValueUpdated(key, value);
                 }
 
-                m_resourceAttributes[std::forward< K >(key)] = std::forward< V >(value);
+                m_resourceAttributes.setValue(key,
+                        RCSResourceAttributes::Value{ std::forward< V >(value) });
             }
 
             if (needToNotify) autoNotify(valueUpdated);
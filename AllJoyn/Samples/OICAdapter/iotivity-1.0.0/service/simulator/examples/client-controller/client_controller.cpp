@@ -19,6 +19,7 @@
  ******************************************************************/
 
 #include "simulator_manager.h"
+#include <fstream>
 #include <map>
 #include <mutex>
 
@@ -56,7 +57,7 @@ class ClientController
                 int choice = -1;
                 std::cout << "Enter your choice: ";
                 std::cin >> choice;
-                if (choice < 0 || choice > 12)
+                if (choice < 0 || choice > 14)
                 {
                     std::cout << "Invaild choice !" << std::endl; continue;
                 }
@@ -74,7 +75,9 @@ class ClientController
                     case 9: sendAllPUTRequests(); break;
                     case 10: sendAllPOSTRequests(); break;
                     case 11: configure(); break;
-                    case 12: printMenu(); break;
+                    case 12: startLoadGeneration(); break;
+                    case 13: stopLoadGeneration(); break;
+                    case 14: printMenu(); break;
                     case 0: cont = false;
                 }
             }
@@ -95,7 +98,9 @@ class ClientController
             std::cout << "9. Send All PUT requests" << std::endl;
             std::cout << "10. Send All POST requests" << std::endl;
             std::cout << "11. Configure (using RAML file)" << std::endl;
-            std::cout << "12: Help" << std::endl;
+            std::cout << "12. Start load generation" << std::endl;
+            std::cout << "13. Stop load generation" << std::endl;
+            std::cout << "14: Help" << std::endl;
             std::cout << "0. Exit" << std::endl;
             std::cout << "###################################################" << std::endl;
         }
@@ -503,6 +508,90 @@ class ClientController
             }
         }
 
+        void startLoadGeneration()
+        {
+            SimulatorRemoteResourceSP resource = selectResource();
+            if (!resource) return;
+
+            LoadProfile profile;
+            std::cout << "Enter the request rate (requests per second): ";
+            std::cin >> profile.requestRate;
+            std::cout << "Enter the maximum number of requests in flight: ";
+            std::cin >> profile.maxInFlight;
+            std::cout << "Enter the duration (seconds): ";
+            std::cin >> profile.duration;
+            std::cout << "Enter the weights of GET, PUT, POST and OBSERVE requests: ";
+            std::cin >> profile.getWeight >> profile.putWeight >> profile.postWeight
+                    >> profile.observeWeight;
+            std::cout << "Enter the report interval (seconds, 0 for the final report only): ";
+            std::cin >> profile.reportInterval;
+
+            std::string reportPath;
+            std::cout << "Enter the JSON report file (- for none): ";
+            std::cin >> reportPath;
+
+            SimulatorRemoteResource::LoadReportCallback callback = [reportPath] (std::string uid,
+                    int sessionId, const LoadReport & report)
+            {
+                std::cout << "\nLoad report received ![id:  " << sessionId << " UID: " << uid
+                        << "]" << std::endl << report.toString() << std::endl;
+
+                // One JSON object per line, intermediate reports first
+                if ("-" != reportPath)
+                {
+                    std::ofstream reportFile(reportPath, std::ios::app);
+                    reportFile << report.toJSON() << std::endl;
+                }
+            };
+
+            try
+            {
+                int id = resource->startLoadGeneration(profile, callback);
+                std::cout << "startLoadGeneration is successfull!id: " << id << std::endl;
+            }
+            catch (InvalidArgsException &e)
+            {
+                std::cout << "InvalidArgsException occured [code : " << e.code() << " Detail: "
+                        << e.what() << "]" << std::endl;
+            }
+            catch (NoSupportException &e)
+            {
+                std::cout << "NoSupportException occured [code : " << e.code() << " Detail: " <<
+                        e.what() << "]" << std::endl;
+            }
+            catch (SimulatorException &e)
+            {
+                std::cout << "SimulatorException occured [code : " << e.code() << " Detail: " <<
+                        e.what() << "]" << std::endl;
+            }
+        }
+
+        void stopLoadGeneration()
+        {
+            SimulatorRemoteResourceSP resource = selectResource();
+            if (!resource) return;
+
+            int id = -1;
+            std::cout << "Enter the load generation id: ";
+            std::cin >> id;
+
+            try
+            {
+                resource->stopLoadGeneration(id);
+                std::cout << "stopLoadGeneration is successfull!" << std::endl;
+            }
+            catch (InvalidArgsException &e)
+            {
+                std::cout << "InvalidArgsException occured [code : " << e.code() << " Detail: "
+                        << e.what() << "]" << std::endl;
+            }
+            catch (SimulatorException &e)
+            {
+                std::cout << "SimulatorException occured [code : " << e.code() << " Detail: " <<
+                        e.what() << "]" << std::endl;
+            }
+        }
+
         void configure()
         {
             SimulatorRemoteResourceSP resource = selectResource();
@@ -0,0 +1,165 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+// Creates many resources from one RAML file and reports :
+//  - the memory taken by each simulated resource, OIC stack registration included,
+//  - the resource updates per second the update automation delivers for a range of
+//    update intervals, and whether it keeps up with the rate the interval asks for.
+// A resource update is one model change notification to the application, which covers
+// all the attributes updated in the same round. The resources are not observed, the cost
+// of the notifications sent to remote observers is not part of the numbers.
+//
+// Usage: simulator-scale-benchmark PATH-TO-RAML-FILE [resources] [seconds]
+
+#include "simulator_manager.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Update intervals in milliseconds, 0 updates as fast as the scheduler goes
+    const int INTERVALS[] = { 1000, 100, 10, 0 };
+    const double SUSTAINED_RATIO = 0.95;
+
+    std::atomic<unsigned long> g_notifications(0);
+
+    long residentBytes()
+    {
+        long pages = 0;
+        long resident = 0;
+        std::ifstream statm("/proc/self/statm");
+        statm >> pages >> resident;
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
+    void onModelChanged(const std::string &/*uri*/, const SimulatorResourceModel &/*model*/)
+    {
+        g_notifications++;
+    }
+
+    void onAutomationCompleted(const std::string &/*uri*/, const int /*id*/)
+    {
+    }
+
+    void runInterval(std::vector<SimulatorResourceServerSP> &resources, int interval,
+                     int seconds)
+    {
+        std::vector<int> automations;
+        automations.reserve(resources.size());
+        for (auto & resource : resources)
+        {
+            for (auto & attribute : resource->getModel().getAttributes())
+                resource->setUpdateInterval(attribute.first, interval);
+
+            automations.push_back(resource->startUpdateAutomation(AutomationType::RECURRENT,
+                                  onAutomationCompleted));
+        }
+
+        // Let all the resources get their first round done before measuring
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::max(interval, 100) * 2));
+        unsigned long first = g_notifications;
+        Clock::time_point start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        unsigned long count = g_notifications - first;
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        for (size_t i = 0; i < resources.size(); i++)
+            resources[i]->stopUpdateAutomation(automations[i]);
+
+        double rate = count / elapsed;
+        if (0 == interval)
+        {
+            printf("%8s ms  %12s  %12.0f updates/s  (as fast as it goes)\n", "0", "-", rate);
+            return;
+        }
+
+        double target = resources.size() * 1000.0 / interval;
+        printf("%8d ms  %12.0f  %12.0f updates/s  %s\n", interval, target, rate,
+               rate >= target * SUSTAINED_RATIO ? "sustained" : "falling behind");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: %s PATH-TO-RAML-FILE [resources] [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    std::string configPath = argv[1];
+    unsigned int count = argc > 2 ? atoi(argv[2]) : 100000;
+    int seconds = argc > 3 ? atoi(argv[3]) : 5;
+    if (0 == count || seconds <= 0)
+    {
+        printf("usage: %s PATH-TO-RAML-FILE [resources] [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    SimulatorManager *manager = SimulatorManager::getInstance();
+
+    std::vector<SimulatorResourceServerSP> resources;
+    long before = residentBytes();
+    Clock::time_point start = Clock::now();
+    try
+    {
+        resources = manager->createResource(configPath, count, onModelChanged);
+    }
+    catch (SimulatorException &e)
+    {
+        printf("Failed to create the resources [code : %d Detail: %s]\n", e.code(), e.what());
+        return 1;
+    }
+    catch (std::exception &e)
+    {
+        printf("Failed to create the resources [%s]\n", e.what());
+        return 1;
+    }
+    double creation = std::chrono::duration<double>(Clock::now() - start).count();
+    long after = residentBytes();
+
+    if (resources.empty())
+    {
+        printf("No resource created from %s\n", configPath.c_str());
+        return 1;
+    }
+
+    printf("%zu resources with %d attributes created in %.2f s\n", resources.size(),
+           resources[0]->getModel().size(), creation);
+    printf("memory: %.1f MB, %ld bytes per resource\n\n", (after - before) / 1048576.0,
+           (after - before) / static_cast<long>(resources.size()));
+
+    printf("%11s  %12s  %12s\n", "interval", "target", "delivered");
+    for (int interval : INTERVALS)
+        runInterval(resources, interval, seconds);
+
+    manager->deleteResource();
+    return 0;
+}
@@ -0,0 +1,170 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file simulator_load_generation.h
+ *
+ * @brief This file provides the types for configuring an open-loop load generation session on
+ * a remote resource and for reporting its results.
+ *
+ */
+
+#ifndef SIMULATOR_LOAD_GENERATION_H_
+#define SIMULATOR_LOAD_GENERATION_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * @struct  LoadProfile
+ *
+ * @brief   Parameters of a load generation session. Requests are started at the target rate
+ *          whatever the response times are, so a slow server shows up as growing latencies
+ *          rather than as a lower request rate. The mix is given as relative weights, a weight
+ *          of zero leaving the request type out.
+ */
+struct LoadProfile
+{
+    LoadProfile()
+        :   requestRate(100),
+            maxInFlight(64),
+            duration(10),
+            requestTimeout(5000),
+            reportInterval(0),
+            getWeight(1),
+            putWeight(0),
+            postWeight(0),
+            observeWeight(0) {}
+
+    /** Requests started per second. */
+    double requestRate;
+
+    /**
+     * Requests waiting for their response at once. A request due while this many are
+     * outstanding is started as soon as one completes, the wait counting in its latency.
+     * The requests still waiting at the end of the duration are not sent.
+     */
+    int maxInFlight;
+
+    /** Seconds during which requests are started. */
+    int duration;
+
+    /** Milliseconds after which a request without response is counted as timed out. */
+    int requestTimeout;
+
+    /** Seconds between intermediate reports, 0 for the final report only. */
+    int reportInterval;
+
+    int getWeight;
+    int putWeight;
+    int postWeight;
+
+    /** Weight of observe registrations, each cancelled once its first notification arrives. */
+    int observeWeight;
+};
+
+/**
+ * @struct  LoadStatistics
+ *
+ * @brief   Counters and latency distribution of the requests of one type, or of all of them.
+ *          Latencies are in microseconds and measured from the time a request was scheduled
+ *          to start, not from the time it was sent.
+ */
+struct LoadStatistics
+{
+    LoadStatistics()
+        :   sent(0), completed(0), errors(0), timeouts(0), throughput(0),
+            minLatency(0), meanLatency(0), maxLatency(0),
+            p50Latency(0), p90Latency(0), p99Latency(0), p999Latency(0) {}
+
+    /** Fraction of the sent requests which failed or timed out. */
+    double errorRate() const
+    {
+        return sent ? static_cast<double>(errors + timeouts) / sent : 0;
+    }
+
+    /** Requests started, including the ones the stack refused to send. */
+    int64_t sent;
+
+    /** Responses received, successful or not. */
+    int64_t completed;
+
+    /** Error responses and requests the stack refused to send. */
+    int64_t errors;
+
+    /** Requests which got no response within LoadProfile::requestTimeout. */
+    int64_t timeouts;
+
+    /** Responses received per second. */
+    double throughput;
+
+    int64_t minLatency;
+    int64_t meanLatency;
+    int64_t maxLatency;
+    int64_t p50Latency;
+    int64_t p90Latency;
+    int64_t p99Latency;
+    int64_t p999Latency;
+};
+
+/**
+ * @struct  LoadReport
+ *
+ * @brief   State of a load generation session since it started.
+ */
+struct LoadReport
+{
+    LoadReport() : finalReport(false), elapsed(0), targetRate(0), maxInFlight(0),
+        delayedStarts(0) {}
+
+    /**
+     * This method is for getting the report as text lines, one per request type.
+     *
+     * @return Report as text.
+     */
+    std::string toString() const;
+
+    /**
+     * This method is for getting the report as a JSON object.
+     *
+     * @return Report as JSON.
+     */
+    std::string toJSON() const;
+
+    /** true for the last report of the session. */
+    bool finalReport;
+
+    /** Seconds since the session started. */
+    double elapsed;
+
+    double targetRate;
+    int maxInFlight;
+
+    /** Requests started later than scheduled because LoadProfile::maxInFlight were pending. */
+    int64_t delayedStarts;
+
+    LoadStatistics total;
+
+    /** Statistics per request type, keyed "GET", "PUT", "POST" and "OBSERVE". */
+    std::map<std::string, LoadStatistics> requests;
+};
+
+#endif
@@ -82,7 +82,7 @@ class SimulatorManager
          * @SimulatorException if any other error occured.
          */
         std::vector<std::shared_ptr<SimulatorResourceServer>> createResource(
-                    const std::string &configPath, unsigned short count,
+                    const std::string &configPath, unsigned int count,
                     SimulatorResourceServer::ResourceModelChangedCB callback);
 
         /**
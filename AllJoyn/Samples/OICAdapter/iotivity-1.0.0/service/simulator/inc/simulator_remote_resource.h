@@ -30,6 +30,7 @@
 
 #include "simulator_client_types.h"
 #include "simulator_resource_model.h"
+#include "simulator_load_generation.h"
 
 /**
  * @class   SimulatorRemoteResource
@@ -60,6 +61,14 @@ class SimulatorRemoteResource
         typedef std::function<void(std::string, int, OperationState)>
         StateCallback;
 
+        /**
+         * Callback method for receiving the intermediate and final reports of a load
+         * generation session.
+         *
+         */
+        typedef std::function<void(std::string, int, const LoadReport &)>
+        LoadReportCallback;
+
         /**
          * API for getting URI of resource.
          *
@@ -150,6 +159,32 @@ class SimulatorRemoteResource
 
         virtual void stopVerification(int id) = 0;
 
+        /**
+         * API for starting an open-loop load generation session. Requests are started at
+         * the rate of the profile, in its mix of GET, PUT, POST and observe, whatever the
+         * response times, and their latencies are reported through @p callback. GET, PUT and
+         * POST requests take their query parameters and representations from the RAML
+         * configuration of the resource.
+         *
+         * @param profile - Rate, concurrency, duration and mix of the requests.
+         * @param callback - Callback receiving the reports, the last one with
+         *                   LoadReport::finalReport set.
+         *
+         * @return ID of the load generation session.
+         *
+         * NOTE: API throws @InvalidArgsException, @NoSupportException and @SimulatorException
+         */
+        virtual int startLoadGeneration(const LoadProfile &profile,
+                                        LoadReportCallback callback) = 0;
+
+        /**
+         * API for stopping a load generation session before the end of its duration. The
+         * final report is sent once the pending requests complete or time out.
+         *
+         * @param id - ID of the load generation session.
+         */
+        virtual void stopLoadGeneration(int id) = 0;
+
         virtual void configure(const std::string &path) = 0;
 };
 
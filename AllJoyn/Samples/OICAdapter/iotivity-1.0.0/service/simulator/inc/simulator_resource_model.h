@@ -30,6 +30,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include "OCPlatform.h"
 #include <climits>
 
@@ -69,20 +70,10 @@ class SimulatorResourceModel
                     STRING
                 };
 
-                Attribute()
-                {
-                    m_min = INT_MIN;
-                    m_max = INT_MAX;
-                    m_updateInterval = -1;
-                }
+                Attribute() : m_schema(defaultSchema()) {}
 
                 Attribute(const std::string &attrName)
-                {
-                    m_name = attrName;
-                    m_min = INT_MIN;
-                    m_max = INT_MAX;
-                    m_updateInterval = -1;
-                }
+                    : m_name(attrName), m_schema(defaultSchema()) {}
 
                 /**
                  * API to get attribute's name.
@@ -172,7 +163,7 @@ class SimulatorResourceModel
                         return false;
                     }
 
-                    m_allowedValues.addValues(values);
+                    mutableSchema().allowedValues.addValues(values);
                     return true;
                 }
 
@@ -204,8 +195,8 @@ class SimulatorResourceModel
 
                 std::vector<ValueVariant> getAllowedValues();
 
-                int getUpdateFrequencyTime() {return m_updateInterval;}
-                void setUpdateFrequencyTime(int interval) {m_updateInterval = interval;}
+                int getUpdateFrequencyTime() {return m_schema->updateInterval;}
+                void setUpdateFrequencyTime(int interval) {mutableSchema().updateInterval = interval;}
 
             private:
                 class AllowedValues
@@ -228,20 +219,34 @@ class SimulatorResourceModel
                             }
                         }
 
-                        ValueVariant &at(unsigned int index);
+                        const ValueVariant &at(unsigned int index) const;
                         int size() const;
                         std::vector<std::string> toString() const;
-                        std::vector<ValueVariant> getValues();
+                        std::vector<ValueVariant> getValues() const;
                     private:
                         std::vector<ValueVariant> m_values;
                 };
 
+                /**
+                 * Part of the attribute which comes from the RAML schema. All the copies of an
+                 * attribute share it, and the first of them to change it gets its own copy.
+                 */
+                struct Schema
+                {
+                    Schema() : min(INT_MIN), max(INT_MAX), updateInterval(-1) {}
+
+                    int min;
+                    int max;
+                    AllowedValues allowedValues;
+                    int updateInterval;
+                };
+
+                static const std::shared_ptr<const Schema> &defaultSchema();
+                Schema &mutableSchema();
+
                 std::string m_name;
                 ValueVariant m_value;
-                int m_max;
-                int m_min;
-                AllowedValues m_allowedValues;
-                int m_updateInterval;
+                std::shared_ptr<const Schema> m_schema;
         };
 
         /**
@@ -31,6 +31,7 @@
 #include "simulator_server_types.h"
 #include "simulator_resource_model.h"
 #include "simulator_exceptions.h"
+#include <mutex>
 
 enum class ObservationStatus : unsigned char
 {
@@ -130,6 +131,7 @@ class SimulatorResourceServer
         template <typename T>
         void setAllowedValues(const std::string &attrName, const std::vector<T> &values)
         {
+            std::lock_guard<std::mutex> lock(m_modelLock);
             m_resModel.setAllowedValues(attrName, values);
         }
 
@@ -150,7 +152,10 @@ class SimulatorResourceServer
         template <typename T>
         void updateAttributeValue(const std::string &attrName, const T &value)
         {
-            m_resModel.updateAttribute(attrName, value);
+            {
+                std::lock_guard<std::mutex> lock(m_modelLock);
+                m_resModel.updateAttribute(attrName, value);
+            }
 
             // Notify all the subscribers
             notifyAll();
@@ -282,6 +287,9 @@ class SimulatorResourceServer
         std::string m_resourceType;
         std::string m_interfaceType;
         SimulatorResourceModel m_resModel;
+
+        // The update automation changes the model from the scheduler workers
+        mutable std::mutex m_modelLock;
 };
 
 typedef std::shared_ptr<SimulatorResourceServer> SimulatorResourceServerSP;
@@ -0,0 +1,188 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "latency_histogram.h"
+
+#include <limits>
+
+namespace
+{
+    // 2048 sub-buckets, enough for three significant digits
+    const int SUB_BUCKET_COUNT_MAGNITUDE = 11;
+
+    int bitLength(int64_t value)
+    {
+        int length = 0;
+        while (value)
+        {
+            value >>= 1;
+            length++;
+        }
+        return length;
+    }
+}
+
+LatencyHistogram::LatencyHistogram(int64_t highestTrackableValue)
+    :   m_highestTrackableValue(highestTrackableValue < 2 ? 2 : highestTrackableValue),
+        m_subBucketHalfCountMagnitude(SUB_BUCKET_COUNT_MAGNITUDE - 1),
+        m_subBucketHalfCount(1 << (SUB_BUCKET_COUNT_MAGNITUDE - 1)),
+        m_subBucketMask((int64_t(1) << SUB_BUCKET_COUNT_MAGNITUDE) - 1),
+        m_bucketCount(1),
+        m_totalCount(0),
+        m_minValue(std::numeric_limits<int64_t>::max()),
+        m_maxValue(0),
+        m_sum(0)
+{
+    // Each bucket covers twice the range of the previous one
+    int64_t smallestUntrackableValue = int64_t(1) << SUB_BUCKET_COUNT_MAGNITUDE;
+    while (smallestUntrackableValue <= m_highestTrackableValue)
+    {
+        smallestUntrackableValue <<= 1;
+        m_bucketCount++;
+    }
+
+    m_counts.assign((m_bucketCount + 1) * m_subBucketHalfCount, 0);
+}
+
+int LatencyHistogram::bucketIndex(int64_t value) const
+{
+    return bitLength(value | m_subBucketMask) - SUB_BUCKET_COUNT_MAGNITUDE;
+}
+
+int LatencyHistogram::countsIndex(int64_t value) const
+{
+    int bucket = bucketIndex(value);
+    int subBucket = static_cast<int>(value >> bucket);
+    return ((bucket + 1) << m_subBucketHalfCountMagnitude) + (subBucket - m_subBucketHalfCount);
+}
+
+int64_t LatencyHistogram::valueFromIndex(int index) const
+{
+    int bucket = (index >> m_subBucketHalfCountMagnitude) - 1;
+    int subBucket = (index & (m_subBucketHalfCount - 1)) + m_subBucketHalfCount;
+    if (bucket < 0)
+    {
+        subBucket -= m_subBucketHalfCount;
+        bucket = 0;
+    }
+    return int64_t(subBucket) << bucket;
+}
+
+int64_t LatencyHistogram::highestEquivalentValue(int64_t value) const
+{
+    int bucket = bucketIndex(value);
+    int64_t subBucket = value >> bucket;
+    if (subBucket >= (m_subBucketMask + 1))
+    {
+        bucket++;
+    }
+    int64_t lowest = (value >> bucket) << bucket;
+    return lowest + (int64_t(1) << bucket) - 1;
+}
+
+void LatencyHistogram::record(int64_t value)
+{
+    if (value < 0)
+        value = 0;
+    if (value > m_highestTrackableValue)
+        value = m_highestTrackableValue;
+
+    m_counts[countsIndex(value)]++;
+    m_totalCount++;
+    m_sum += value;
+    if (value < m_minValue)
+        m_minValue = value;
+    if (value > m_maxValue)
+        m_maxValue = value;
+}
+
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    if (!other.m_totalCount)
+        return;
+
+    if (other.m_counts.size() == m_counts.size())
+    {
+        for (std::size_t index = 0; index < m_counts.size(); index++)
+            m_counts[index] += other.m_counts[index];
+    }
+    else
+    {
+        for (std::size_t index = 0; index < other.m_counts.size(); index++)
+        {
+            int64_t value = other.valueFromIndex(index);
+            if (value > m_highestTrackableValue)
+                value = m_highestTrackableValue;
+            m_counts[countsIndex(value)] += other.m_counts[index];
+        }
+    }
+
+    m_totalCount += other.m_totalCount;
+    m_sum += other.m_sum;
+    if (other.m_minValue < m_minValue)
+        m_minValue = other.m_minValue;
+    if (other.m_maxValue > m_maxValue)
+        m_maxValue = other.m_maxValue;
+}
+
+void LatencyHistogram::reset()
+{
+    m_counts.assign(m_counts.size(), 0);
+    m_totalCount = 0;
+    m_minValue = std::numeric_limits<int64_t>::max();
+    m_maxValue = 0;
+    m_sum = 0;
+}
+
+int64_t LatencyHistogram::min() const
+{
+    return m_totalCount ? m_minValue : 0;
+}
+
+double LatencyHistogram::mean() const
+{
+    return m_totalCount ? static_cast<double>(m_sum) / m_totalCount : 0;
+}
+
+int64_t LatencyHistogram::valueAtPercentile(double percentile) const
+{
+    if (!m_totalCount)
+        return 0;
+
+    if (percentile > 100)
+        percentile = 100;
+
+    int64_t countAtPercentile = static_cast<int64_t>((percentile / 100) * m_totalCount + 0.5);
+    if (countAtPercentile < 1)
+        countAtPercentile = 1;
+
+    int64_t total = 0;
+    for (std::size_t index = 0; index < m_counts.size(); index++)
+    {
+        total += m_counts[index];
+        if (total >= countAtPercentile)
+        {
+            int64_t value = highestEquivalentValue(valueFromIndex(index));
+            return value < m_maxValue ? value : m_maxValue;
+        }
+    }
+
+    return m_maxValue;
+}
@@ -0,0 +1,81 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file latency_histogram.h
+ *
+ * @brief This file provides a class for recording request latencies with a fixed relative
+ * precision, in the way of HdrHistogram.
+ *
+ */
+
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Counts values between 1 and a highest trackable value, keeping three significant digits
+ * over the whole range. Values are grouped in buckets whose width doubles from one bucket to
+ * the next, each bucket being split in 2048 sub-buckets, so recording a value is an index
+ * computation and a counter increment. Values above the highest trackable value are counted
+ * as the highest trackable value.
+ */
+class LatencyHistogram
+{
+    public:
+        LatencyHistogram(int64_t highestTrackableValue);
+
+        void record(int64_t value);
+        void add(const LatencyHistogram &other);
+        void reset();
+
+        int64_t count() const { return m_totalCount; }
+        int64_t min() const;
+        int64_t max() const { return m_maxValue; }
+        double mean() const;
+
+        /**
+         * Value at or below which the given percentage of the recorded values fall, e.g.
+         * valueAtPercentile(99.9). The value returned is the highest value equivalent to the
+         * one recorded, within the precision of the histogram.
+         */
+        int64_t valueAtPercentile(double percentile) const;
+
+    private:
+        int bucketIndex(int64_t value) const;
+        int countsIndex(int64_t value) const;
+        int64_t valueFromIndex(int index) const;
+        int64_t highestEquivalentValue(int64_t value) const;
+
+        int64_t m_highestTrackableValue;
+        int m_subBucketHalfCountMagnitude;
+        int m_subBucketHalfCount;
+        int64_t m_subBucketMask;
+        int m_bucketCount;
+        std::vector<int64_t> m_counts;
+        int64_t m_totalCount;
+        int64_t m_minValue;
+        int64_t m_maxValue;
+        int64_t m_sum;
+};
+
+#endif
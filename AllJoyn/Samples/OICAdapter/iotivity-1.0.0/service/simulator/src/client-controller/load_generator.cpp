@@ -0,0 +1,490 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "load_generator.h"
+#include "query_param_generator.h"
+#include "attribute_generator.h"
+#include "OCPlatform.h"
+#include "logger.h"
+
+#define TAG "LOAD_GENERATOR"
+
+namespace
+{
+    // Latencies are recorded in microseconds, up to an hour
+    const int64_t HIGHEST_LATENCY = 3600LL * 1000 * 1000;
+
+    // Query parameter combinations and representations prepared per request type
+    const std::size_t MAX_VARIANTS = 256;
+
+    std::vector<SimulatorResourceModelSP> generateRepresentations(SimulatorResourceModelSP schema)
+    {
+        std::vector<SimulatorResourceModelSP> representations;
+        if (!schema)
+            return representations;
+
+        // Same walk through the attribute values as the PUT and POST verification
+        std::vector<AttributeGenerator> attributeGenList;
+        for (auto &attributeElement : schema->getAttributes())
+            attributeGenList.push_back(AttributeGenerator(attributeElement.second));
+
+        while (attributeGenList.size() && representations.size() < MAX_VARIANTS)
+        {
+            bool hasNext = false;
+            SimulatorResourceModelSP repModel(new SimulatorResourceModel);
+            for (auto &attributeGen : attributeGenList)
+            {
+                SimulatorResourceModel::Attribute attribute;
+                if (attributeGen.hasNext())
+                {
+                    if (true == attributeGen.next(attribute))
+                        repModel->addAttribute(attribute);
+
+                    hasNext = true;
+                }
+                else if (true == attributeGen.previous(attribute))
+                {
+                    repModel->addAttribute(attribute);
+                }
+            }
+
+            if (!hasNext)
+                break;
+
+            representations.push_back(repModel);
+        }
+
+        // Attributes without range or allowed values keep the values of the schema
+        if (representations.empty())
+            representations.push_back(schema);
+
+        return representations;
+    }
+
+    void setLatencies(LoadStatistics &statistics, const LatencyHistogram &latencies,
+                      double elapsed)
+    {
+        statistics.throughput = elapsed > 0 ? statistics.completed / elapsed : 0;
+        statistics.minLatency = latencies.min();
+        statistics.meanLatency = static_cast<int64_t>(latencies.mean());
+        statistics.maxLatency = latencies.max();
+        statistics.p50Latency = latencies.valueAtPercentile(50);
+        statistics.p90Latency = latencies.valueAtPercentile(90);
+        statistics.p99Latency = latencies.valueAtPercentile(99);
+        statistics.p999Latency = latencies.valueAtPercentile(99.9);
+    }
+
+    bool isSuccess(SimulatorResult result)
+    {
+        return SIMULATOR_OK == result || SIMULATOR_RESOURCE_CREATED == result
+               || SIMULATOR_RESOURCE_DELETED == result;
+    }
+}
+
+LoadGenerator::Operation::Operation(const std::string &operationName, int operationWeight)
+    :   name(operationName),
+        weight(operationWeight),
+        currentWeight(0),
+        next(0),
+        latencies(HIGHEST_LATENCY) {}
+
+LoadGenerator::LoadGenerator(int id, const LoadProfile &profile,
+                             std::shared_ptr<OC::OCResource> &ocResource, ReportCallback callback)
+    :   m_id(id),
+        m_profile(profile),
+        m_ocResource(ocResource),
+        m_callback(callback),
+        m_totalWeight(0),
+        m_running(false),
+        m_stopRequested(false),
+        m_requestId(0),
+        m_delayedStarts(0) {}
+
+void LoadGenerator::addRequests(RequestType type, int weight, RequestSenderSP requestSender,
+                                RequestModelSP requestModel)
+{
+    if (weight <= 0 || !requestSender)
+        return;
+
+    std::string name = "GET";
+    if (RequestType::RQ_TYPE_PUT == type)
+        name = "PUT";
+    else if (RequestType::RQ_TYPE_POST == type)
+        name = "POST";
+
+    Operation operation(name, weight);
+    operation.requestSender = requestSender;
+
+    if (requestModel)
+    {
+        QPGenerator queryParamGen(requestModel->getQueryParams());
+        while (queryParamGen.hasNext() && operation.queryParams.size() < MAX_VARIANTS)
+            operation.queryParams.push_back(queryParamGen.next());
+    }
+
+    if (operation.queryParams.empty())
+        operation.queryParams.push_back(std::map<std::string, std::string>());
+
+    if (RequestType::RQ_TYPE_PUT == type || RequestType::RQ_TYPE_POST == type)
+    {
+        operation.representations = generateRepresentations(
+                                        requestModel ? requestModel->getRepSchema() : nullptr);
+        if (operation.representations.empty())
+        {
+            OC_LOG_V(ERROR, TAG, "No representation for %s requests!", name.c_str());
+            throw SimulatorException(SIMULATOR_ERROR, "Invalid representation detected!");
+        }
+    }
+
+    m_operations.push_back(operation);
+    m_totalWeight += weight;
+}
+
+void LoadGenerator::addObserve(int weight)
+{
+    if (weight <= 0)
+        return;
+
+    m_operations.push_back(Operation("OBSERVE", weight));
+    m_totalWeight += weight;
+}
+
+void LoadGenerator::start()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_running)
+    {
+        OC_LOG(ERROR, TAG, "Operation already in progress !");
+        throw OperationInProgressException("Load generation session is already in progress!");
+    }
+
+    if (m_operations.empty())
+    {
+        OC_LOG(ERROR, TAG, "No request to generate !");
+        throw InvalidArgsException(SIMULATOR_INVALID_PARAM, "No request type in the load profile!");
+    }
+
+    // The thread keeps the generator alive until the final report
+    std::thread thread(&LoadGenerator::run, shared_from_this());
+    thread.detach();
+    m_running = true;
+}
+
+void LoadGenerator::stop()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stopRequested = true;
+    m_condition.notify_all();
+}
+
+void LoadGenerator::run()
+{
+    OC_LOG_V(INFO, TAG, "Load generation session started [%d]", m_id);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_startTime = Clock::now();
+    Clock::time_point endTime = m_startTime + std::chrono::seconds(m_profile.duration);
+    Clock::duration reportInterval = std::chrono::seconds(m_profile.reportInterval);
+    Clock::time_point nextReport = m_startTime + reportInterval;
+
+    for (uint64_t count = 0; !m_stopRequested; count++)
+    {
+        // Computed from the start rather than from the previous send, a late send does not
+        // delay the ones after it
+        Clock::time_point scheduled = m_startTime + std::chrono::duration_cast<Clock::duration>(
+                                          std::chrono::duration<double>(count / m_profile.requestRate));
+        if (scheduled >= endTime)
+            break;
+
+        m_condition.wait_until(lock, scheduled, [this] { return m_stopRequested; });
+        if (m_stopRequested)
+            break;
+
+        expire(Clock::now());
+        if (static_cast<int>(m_pendingRequests.size()) >= m_profile.maxInFlight)
+        {
+            m_delayedStarts++;
+            while (!m_stopRequested
+                   && static_cast<int>(m_pendingRequests.size()) >= m_profile.maxInFlight)
+            {
+                waitForResponse(lock);
+                expire(Clock::now());
+            }
+
+            // Requests which could not start within the duration are not sent at all
+            if (m_stopRequested || Clock::now() >= endTime)
+                break;
+        }
+
+        send(lock, nextOperation(), scheduled);
+
+        if (!m_observersToCancel.empty())
+            cancelObservers(lock);
+
+        if (m_profile.reportInterval > 0 && Clock::now() >= nextReport)
+        {
+            LoadReport intermediateReport = report(false, Clock::now());
+            lock.unlock();
+            m_callback(m_id, intermediateReport);
+            lock.lock();
+            nextReport += reportInterval;
+        }
+    }
+
+    // Wait for the pending requests, at most until they time out
+    while (!m_pendingRequests.empty())
+    {
+        waitForResponse(lock);
+        expire(Clock::now());
+    }
+    cancelObservers(lock);
+
+    LoadReport finalReport = report(true, Clock::now());
+    m_running = false;
+    lock.unlock();
+
+    OC_LOG_V(INFO, TAG, "Load generation session completed [%d]", m_id);
+    m_callback(m_id, finalReport);
+}
+
+std::size_t LoadGenerator::nextOperation()
+{
+    // Smooth weighted round robin, the mix is exact over every m_totalWeight requests
+    std::size_t selected = 0;
+    for (std::size_t index = 0; index < m_operations.size(); index++)
+    {
+        m_operations[index].currentWeight += m_operations[index].weight;
+        if (m_operations[index].currentWeight > m_operations[selected].currentWeight)
+            selected = index;
+    }
+
+    m_operations[selected].currentWeight -= m_totalWeight;
+    return selected;
+}
+
+void LoadGenerator::send(std::unique_lock<std::mutex> &lock, std::size_t operationIndex,
+                         Clock::time_point scheduled)
+{
+    Operation &operation = m_operations[operationIndex];
+    operation.statistics.sent++;
+
+    uint64_t requestId = m_requestId++;
+    PendingRequest &pending = m_pendingRequests[requestId];
+    pending.operation = operationIndex;
+    pending.scheduled = scheduled;
+    pending.sent = Clock::now();
+
+    RequestSenderSP requestSender = operation.requestSender;
+    std::map<std::string, std::string> queryParam;
+    SimulatorResourceModelSP repModel;
+    std::shared_ptr<OC::OCResource> observer;
+    if (requestSender)
+    {
+        queryParam = operation.queryParams[operation.next % operation.queryParams.size()];
+        if (!operation.representations.empty())
+            repModel = operation.representations[operation.next % operation.representations.size()];
+        operation.next++;
+    }
+    else
+    {
+        observer = OC::OCPlatform::constructResourceObject(m_ocResource->host(),
+                   m_ocResource->uri(), m_ocResource->connectivityType(), true,
+                   m_ocResource->getResourceTypes(), m_ocResource->getResourceInterfaces());
+        pending.observer = observer;
+    }
+
+    // Responses are handled on other threads, which take the lock
+    lock.unlock();
+
+    if (requestSender)
+    {
+        std::weak_ptr<LoadGenerator> weakSelf = shared_from_this();
+        try
+        {
+            requestSender->sendRequest(queryParam, repModel,
+                                       [weakSelf, requestId](SimulatorResult result, SimulatorResourceModelSP)
+            {
+                LoadGeneratorSP self = weakSelf.lock();
+                if (self)
+                    self->onResponse(requestId, result);
+            });
+        }
+        catch (SimulatorException &e)
+        {
+            OC_LOG_V(ERROR, TAG, "Sending request failed [%s]", e.what());
+            fail(requestId);
+        }
+    }
+    else
+    {
+        sendObserve(requestId, observer);
+    }
+
+    lock.lock();
+}
+
+void LoadGenerator::sendObserve(uint64_t requestId, std::shared_ptr<OC::OCResource> observer)
+{
+    if (!observer)
+    {
+        fail(requestId);
+        return;
+    }
+
+    std::weak_ptr<LoadGenerator> weakSelf = shared_from_this();
+    OC::ObserveCallback observeCallback = [weakSelf, requestId](const OC::HeaderOptions &,
+                                          const OC::OCRepresentation &, const int errorCode, const int)
+    {
+        LoadGeneratorSP self = weakSelf.lock();
+        if (self)
+            self->onResponse(requestId, static_cast<SimulatorResult>(errorCode));
+    };
+
+    try
+    {
+        OCStackResult ocResult = observer->observe(OC::ObserveType::Observe,
+                                 OC::QueryParamsMap(), observeCallback);
+        if (OC_STACK_OK != ocResult)
+        {
+            OC_LOG_V(ERROR, TAG, "Sending observe request failed [errorcode: %d]", ocResult);
+            fail(requestId);
+        }
+    }
+    catch (OC::OCException &e)
+    {
+        OC_LOG_V(ERROR, TAG, "Sending observe request failed [%s]", e.what());
+        fail(requestId);
+    }
+}
+
+void LoadGenerator::onResponse(uint64_t requestId, SimulatorResult result)
+{
+    Clock::time_point now = Clock::now();
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // Responses after the timeout and later observe notifications are not accounted
+    auto pending = m_pendingRequests.find(requestId);
+    if (m_pendingRequests.end() == pending)
+        return;
+
+    Operation &operation = m_operations[pending->second.operation];
+    operation.latencies.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   now - pending->second.scheduled).count());
+    operation.statistics.completed++;
+    if (!isSuccess(result))
+        operation.statistics.errors++;
+
+    if (pending->second.observer)
+        m_observersToCancel.push_back(pending->second.observer);
+
+    m_pendingRequests.erase(pending);
+    m_condition.notify_all();
+}
+
+void LoadGenerator::fail(uint64_t requestId)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto pending = m_pendingRequests.find(requestId);
+    if (m_pendingRequests.end() == pending)
+        return;
+
+    m_operations[pending->second.operation].statistics.errors++;
+    m_pendingRequests.erase(pending);
+    m_condition.notify_all();
+}
+
+void LoadGenerator::expire(Clock::time_point now)
+{
+    // Requests are numbered in send order, the first pending one is the oldest. The timeout
+    // runs from the send, a request delayed by maxInFlight still gets its full timeout
+    Clock::duration timeout = std::chrono::milliseconds(m_profile.requestTimeout);
+    while (!m_pendingRequests.empty())
+    {
+        auto oldest = m_pendingRequests.begin();
+        if (oldest->second.sent + timeout > now)
+            break;
+
+        m_operations[oldest->second.operation].statistics.timeouts++;
+        if (oldest->second.observer)
+            m_observersToCancel.push_back(oldest->second.observer);
+
+        m_pendingRequests.erase(oldest);
+    }
+}
+
+void LoadGenerator::waitForResponse(std::unique_lock<std::mutex> &lock)
+{
+    if (m_pendingRequests.empty())
+        return;
+
+    // Until a response arrives or the oldest request times out
+    m_condition.wait_until(lock, m_pendingRequests.begin()->second.sent
+                           + std::chrono::milliseconds(m_profile.requestTimeout));
+}
+
+void LoadGenerator::cancelObservers(std::unique_lock<std::mutex> &lock)
+{
+    std::vector<std::shared_ptr<OC::OCResource>> observers;
+    observers.swap(m_observersToCancel);
+    if (observers.empty())
+        return;
+
+    lock.unlock();
+    for (auto &observer : observers)
+    {
+        try
+        {
+            observer->cancelObserve();
+        }
+        catch (OC::OCException &e)
+        {
+            OC_LOG_V(WARNING, TAG, "Cancelling observe failed [%s]", e.what());
+        }
+    }
+    lock.lock();
+}
+
+LoadReport LoadGenerator::report(bool finalReport, Clock::time_point now)
+{
+    LoadReport loadReport;
+    loadReport.finalReport = finalReport;
+    loadReport.elapsed = std::chrono::duration<double>(now - m_startTime).count();
+    loadReport.targetRate = m_profile.requestRate;
+    loadReport.maxInFlight = m_profile.maxInFlight;
+    loadReport.delayedStarts = m_delayedStarts;
+
+    LatencyHistogram totalLatencies(HIGHEST_LATENCY);
+    for (auto &operation : m_operations)
+    {
+        LoadStatistics statistics = operation.statistics;
+        setLatencies(statistics, operation.latencies, loadReport.elapsed);
+        loadReport.requests[operation.name] = statistics;
+
+        loadReport.total.sent += statistics.sent;
+        loadReport.total.completed += statistics.completed;
+        loadReport.total.errors += statistics.errors;
+        loadReport.total.timeouts += statistics.timeouts;
+        totalLatencies.add(operation.latencies);
+    }
+    setLatencies(loadReport.total, totalLatencies, loadReport.elapsed);
+
+    return loadReport;
+}
@@ -0,0 +1,120 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file load_generator.h
+ *
+ * @brief This file provides a class for generating open-loop load on a remote resource.
+ *
+ */
+
+#ifndef LOAD_GENERATOR_H_
+#define LOAD_GENERATOR_H_
+
+#include "request_sender.h"
+#include "latency_histogram.h"
+#include "simulator_load_generation.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+/**
+ * Starts requests on a schedule derived from the target rate, without waiting for the
+ * responses of the previous ones, and accounts each of them from its scheduled start. The
+ * requests of each type cycle through the query parameters and representations the RAML
+ * description of the resource allows. Observe registrations go through their own copy of the
+ * resource, as a resource holds a single observation.
+ */
+class LoadGenerator : public std::enable_shared_from_this<LoadGenerator>
+{
+    public:
+        typedef std::function<void (int, const LoadReport &)> ReportCallback;
+
+        LoadGenerator(int id, const LoadProfile &profile,
+                      std::shared_ptr<OC::OCResource> &ocResource, ReportCallback callback);
+
+        void addRequests(RequestType type, int weight, RequestSenderSP requestSender,
+                         RequestModelSP requestModel);
+        void addObserve(int weight);
+
+        int id() const { return m_id; }
+        void start();
+        void stop();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Operation
+        {
+            Operation(const std::string &operationName, int operationWeight);
+
+            std::string name;
+            int weight;
+            int currentWeight;
+            RequestSenderSP requestSender;
+            std::vector<std::map<std::string, std::string>> queryParams;
+            std::vector<SimulatorResourceModelSP> representations;
+            std::size_t next;
+            LoadStatistics statistics;
+            LatencyHistogram latencies;
+        };
+
+        struct PendingRequest
+        {
+            std::size_t operation;
+            Clock::time_point scheduled;
+            Clock::time_point sent;
+            std::shared_ptr<OC::OCResource> observer;
+        };
+
+        void run();
+        std::size_t nextOperation();
+        void send(std::unique_lock<std::mutex> &lock, std::size_t operation,
+                  Clock::time_point scheduled);
+        void sendObserve(uint64_t requestId, std::shared_ptr<OC::OCResource> observer);
+        void onResponse(uint64_t requestId, SimulatorResult result);
+        void fail(uint64_t requestId);
+        void expire(Clock::time_point now);
+        void cancelObservers(std::unique_lock<std::mutex> &lock);
+        void waitForResponse(std::unique_lock<std::mutex> &lock);
+        LoadReport report(bool finalReport, Clock::time_point now);
+
+        int m_id;
+        LoadProfile m_profile;
+        std::shared_ptr<OC::OCResource> m_ocResource;
+        ReportCallback m_callback;
+        std::vector<Operation> m_operations;
+        int m_totalWeight;
+
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+        bool m_running;
+        bool m_stopRequested;
+        std::map<uint64_t, PendingRequest> m_pendingRequests;
+        uint64_t m_requestId;
+        std::vector<std::shared_ptr<OC::OCResource>> m_observersToCancel;
+        int64_t m_delayedStarts;
+        Clock::time_point m_startTime;
+};
+
+typedef std::shared_ptr<LoadGenerator> LoadGeneratorSP;
+
+#endif
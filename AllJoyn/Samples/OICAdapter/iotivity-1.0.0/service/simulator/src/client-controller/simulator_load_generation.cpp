@@ -0,0 +1,111 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "simulator_load_generation.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    void statisticsToString(std::ostringstream &out, const std::string &name,
+                            const LoadStatistics &statistics)
+    {
+        out << std::left << std::setw(8) << name << std::right
+            << std::setw(9) << statistics.sent
+            << std::setw(10) << statistics.completed
+            << std::setw(8) << statistics.errors
+            << std::setw(9) << statistics.timeouts
+            << std::setw(10) << std::setprecision(1) << statistics.throughput
+            << std::setw(9) << std::setprecision(2) << statistics.errorRate() * 100
+            << std::setw(10) << statistics.p50Latency
+            << std::setw(10) << statistics.p99Latency
+            << std::setw(10) << statistics.p999Latency
+            << std::setw(10) << statistics.maxLatency << std::endl;
+    }
+
+    void statisticsToJSON(std::ostringstream &out, const LoadStatistics &statistics)
+    {
+        out << "{\"sent\":" << statistics.sent
+            << ",\"completed\":" << statistics.completed
+            << ",\"errors\":" << statistics.errors
+            << ",\"timeouts\":" << statistics.timeouts
+            << ",\"throughput\":" << statistics.throughput
+            << ",\"errorRate\":" << statistics.errorRate()
+            << ",\"latency\":{\"min\":" << statistics.minLatency
+            << ",\"mean\":" << statistics.meanLatency
+            << ",\"p50\":" << statistics.p50Latency
+            << ",\"p90\":" << statistics.p90Latency
+            << ",\"p99\":" << statistics.p99Latency
+            << ",\"p999\":" << statistics.p999Latency
+            << ",\"max\":" << statistics.maxLatency << "}}";
+    }
+}
+
+std::string LoadReport::toString() const
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1)
+        << (finalReport ? "Final" : "Intermediate") << " load report after " << elapsed
+        << "s, target " << targetRate << " req/s, " << maxInFlight << " in flight, "
+        << delayedStarts << " delayed starts" << std::endl;
+
+    out << std::left << std::setw(8) << "request" << std::right
+        << std::setw(9) << "sent"
+        << std::setw(10) << "completed"
+        << std::setw(8) << "errors"
+        << std::setw(9) << "timeouts"
+        << std::setw(10) << "req/s"
+        << std::setw(9) << "error%"
+        << std::setw(10) << "p50(us)"
+        << std::setw(10) << "p99(us)"
+        << std::setw(10) << "p999(us)"
+        << std::setw(10) << "max(us)" << std::endl;
+
+    for (auto &entry : requests)
+        statisticsToString(out, entry.first, entry.second);
+    statisticsToString(out, "total", total);
+
+    return out.str();
+}
+
+std::string LoadReport::toJSON() const
+{
+    std::ostringstream out;
+    out << "{\"final\":" << (finalReport ? "true" : "false")
+        << ",\"elapsed\":" << elapsed
+        << ",\"targetRate\":" << targetRate
+        << ",\"maxInFlight\":" << maxInFlight
+        << ",\"delayedStarts\":" << delayedStarts
+        << ",\"total\":";
+    statisticsToJSON(out, total);
+
+    out << ",\"requests\":{";
+    bool first = true;
+    for (auto &entry : requests)
+    {
+        out << (first ? "" : ",") << "\"" << entry.first << "\":";
+        statisticsToJSON(out, entry.second);
+        first = false;
+    }
+    out << "}}";
+
+    return out.str();
+}
@@ -32,6 +32,7 @@ SimulatorRemoteResourceImpl::SimulatorRemoteResourceImpl(std::shared_ptr<OC::OCR
         m_putRequestSender(new PUTRequestSender(ocResource)),
         m_postRequestSender(new POSTRequestSender(ocResource)),
         m_autoRequestGenMngr(nullptr),
+        m_loadGenId(0),
         m_ocResource(ocResource)
 {
     m_id = m_ocResource->sid().append(m_ocResource->uri());
@@ -352,6 +353,102 @@ void SimulatorRemoteResourceImpl::stopVerification(int id)
     m_autoRequestGenMngr->stop(id);
 }
 
+int SimulatorRemoteResourceImpl::startLoadGeneration(const LoadProfile &profile,
+        LoadReportCallback callback)
+{
+    if (!callback)
+    {
+        OC_LOG(ERROR, TAG, "Invalid callback!");
+        throw InvalidArgsException(SIMULATOR_INVALID_CALLBACK, "Invalid callback!");
+    }
+
+    if (profile.requestRate <= 0 || profile.maxInFlight <= 0 || profile.duration <= 0
+        || profile.requestTimeout <= 0 || profile.reportInterval < 0
+        || profile.getWeight < 0 || profile.putWeight < 0 || profile.postWeight < 0
+        || profile.observeWeight < 0)
+    {
+        OC_LOG(ERROR, TAG, "Invalid load profile!");
+        throw InvalidArgsException(SIMULATOR_INVALID_PARAM, "Invalid load profile!");
+    }
+
+    std::map<RequestType, int> weights;
+    weights[RequestType::RQ_TYPE_GET] = profile.getWeight;
+    weights[RequestType::RQ_TYPE_PUT] = profile.putWeight;
+    weights[RequestType::RQ_TYPE_POST] = profile.postWeight;
+
+    std::map<RequestType, RequestSenderSP> requestSenders;
+    requestSenders[RequestType::RQ_TYPE_GET] = m_getRequestSender;
+    requestSenders[RequestType::RQ_TYPE_PUT] = m_putRequestSender;
+    requestSenders[RequestType::RQ_TYPE_POST] = m_postRequestSender;
+
+    for (auto &weight : weights)
+    {
+        if (!weight.second)
+            continue;
+
+        if (!m_autoRequestGenMngr)
+        {
+            OC_LOG(ERROR, TAG, "Resource is not configured with RAML !");
+            throw NoSupportException("Resource is not configured with RAML!");
+        }
+
+        if (m_requestModelList.end() == m_requestModelList.find(weight.first)
+            || !requestSenders[weight.first])
+        {
+            throw NoSupportException("Resource does not support this request type!");
+        }
+    }
+
+    if (profile.observeWeight && !m_ocResource->isObservable())
+        throw NoSupportException("Resource is not observable!");
+
+    // Local callback for removing the session once its final report is sent
+    LoadGenerator::ReportCallback localCallback = [this, callback](int sessionId,
+            const LoadReport & report)
+    {
+        if (report.finalReport)
+        {
+            std::lock_guard<std::mutex> lock(m_loadGenLock);
+            m_loadGenList.erase(sessionId);
+        }
+
+        callback(m_id, sessionId, report);
+    };
+
+    std::lock_guard<std::mutex> lock(m_loadGenLock);
+    LoadGeneratorSP loadGen = std::make_shared<LoadGenerator>(m_loadGenId, profile,
+                              m_ocResource, localCallback);
+    for (auto &weight : weights)
+    {
+        loadGen->addRequests(weight.first, weight.second, requestSenders[weight.first],
+                             weight.second ? m_requestModelList[weight.first] : nullptr);
+    }
+    loadGen->addObserve(profile.observeWeight);
+
+    loadGen->start();
+    m_loadGenList[m_loadGenId] = loadGen;
+    return m_loadGenId++;
+}
+
+void SimulatorRemoteResourceImpl::stopLoadGeneration(int id)
+{
+    if (id < 0)
+    {
+        OC_LOG(ERROR, TAG, "Invalid session id!");
+        throw InvalidArgsException(SIMULATOR_INVALID_PARAM, "Invalid ID!");
+    }
+
+    std::lock_guard<std::mutex> lock(m_loadGenLock);
+    if (m_loadGenList.end() != m_loadGenList.find(id))
+    {
+        m_loadGenList[id]->stop();
+        OC_LOG_V(INFO, TAG, "Load generation session stopped [%d]", id);
+        return;
+    }
+
+    OC_LOG_V(ERROR, TAG, "Invalid load generation id : %d", id);
+}
+
 void SimulatorRemoteResourceImpl::configure(const std::string &path)
 {
     if (path.empty())
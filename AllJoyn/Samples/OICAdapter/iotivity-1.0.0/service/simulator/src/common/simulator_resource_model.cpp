@@ -159,8 +159,8 @@ class range_validation : public boost::static_visitor<bool>
         SimulatorResourceModel::Attribute &m_attrItem;
 };
 
-SimulatorResourceModel::Attribute::ValueVariant
-&SimulatorResourceModel::Attribute::AllowedValues::at(unsigned int index)
+const SimulatorResourceModel::Attribute::ValueVariant
+&SimulatorResourceModel::Attribute::AllowedValues::at(unsigned int index) const
 {
     return m_values.at(index);
 }
@@ -183,11 +183,25 @@ std::vector<std::string> SimulatorResourceModel::Attribute::AllowedValues::toStr
 }
 
 std::vector<SimulatorResourceModel::Attribute::ValueVariant>
-SimulatorResourceModel::Attribute::AllowedValues::getValues()
+SimulatorResourceModel::Attribute::AllowedValues::getValues() const
 {
     return m_values;
 }
 
+const std::shared_ptr<const SimulatorResourceModel::Attribute::Schema>
+&SimulatorResourceModel::Attribute::defaultSchema()
+{
+    static const std::shared_ptr<const Schema> s_schema = std::make_shared<Schema>();
+    return s_schema;
+}
+
+SimulatorResourceModel::Attribute::Schema &SimulatorResourceModel::Attribute::mutableSchema()
+{
+    if (!m_schema.unique())
+        m_schema = std::make_shared<Schema>(*m_schema);
+    return const_cast<Schema &>(*m_schema);
+}
+
 std::string SimulatorResourceModel::Attribute::getName(void) const
 {
     return m_name;
@@ -200,24 +214,25 @@ void SimulatorResourceModel::Attribute::setName(const std::string &name)
 
 void SimulatorResourceModel::Attribute::getRange(int &min, int &max) const
 {
-    min = m_min;
-    max = m_max;
+    min = m_schema->min;
+    max = m_schema->max;
 }
 
 void SimulatorResourceModel::Attribute::setRange(const int &min, const int &max)
 {
-    m_min = min;
-    m_max = max;
+    Schema &schema = mutableSchema();
+    schema.min = min;
+    schema.max = max;
 }
 
 int SimulatorResourceModel::Attribute::getAllowedValuesSize() const
 {
-    return m_allowedValues.size();
+    return m_schema->allowedValues.size();
 }
 
 void SimulatorResourceModel::Attribute::setFromAllowedValue(unsigned int index)
 {
-    m_value = m_allowedValues.at(index);
+    m_value = m_schema->allowedValues.at(index);
 }
 
 SimulatorResourceModel::Attribute::ValueType SimulatorResourceModel::Attribute::getValueType() const
@@ -234,7 +249,7 @@ std::string SimulatorResourceModel::Attribute::valueToString() const
 
 std::vector<std::string> SimulatorResourceModel::Attribute::allowedValuesToString() const
 {
-    return m_allowedValues.toString();
+    return m_schema->allowedValues.toString();
 }
 
 void SimulatorResourceModel::Attribute::addValuetoRepresentation(OC::OCRepresentation &rep,
@@ -261,7 +276,7 @@ bool SimulatorResourceModel::Attribute::compare(SimulatorResourceModel::Attribut
 std::vector<SimulatorResourceModel::Attribute::ValueVariant>
 SimulatorResourceModel::Attribute::getAllowedValues()
 {
-    return m_allowedValues.getValues();
+    return m_schema->allowedValues.getValues();
 }
 
 bool SimulatorResourceModel::getAttribute(const std::string &attrName, Attribute &value)
@@ -52,7 +52,7 @@ SimulatorResourceServerSP ResourceManager::createResource(const std::string &con
 }
 
 std::vector<SimulatorResourceServerSP> ResourceManager::createResource(
-    const std::string &configPath, unsigned short count,
+    const std::string &configPath, unsigned int count,
     SimulatorResourceServer::ResourceModelChangedCB callback)
 {
     OC_LOG_V(INFO, "Create multiple resource request : config=%s, count=%d", configPath.c_str(),
@@ -77,15 +77,24 @@ std::vector<SimulatorResourceServerSP> ResourceManager::createResource(
         throw InvalidArgsException(SIMULATOR_INVALID_CALLBACK, "Invalid callback!");
     }
 
+    // Parse the RAML file once, all the resources are built from the same schema
+    ResourceSchemaSP schema = m_resourceCreator.loadSchema(configPath);
+    if (!schema)
+    {
+        OC_LOG(ERROR, TAG, "Failed to create resource!");
+        throw SimulatorException(SIMULATOR_ERROR, "Failed to create resource!");
+    }
+
     std::vector<SimulatorResourceServerSP> resourceList;
+    resourceList.reserve(count);
 
     // Create resources
-    for (unsigned short i = 0; i < count; i++)
+    for (unsigned int i = 0; i < count; i++)
     {
-        OC_LOG_V(INFO, TAG, "Creating resource [%d]", i + 1);
+        OC_LOG_V(INFO, TAG, "Creating resource [%u]", i + 1);
         SIM_LOG(ILogger::INFO, "Creating resource [" << i + 1 << "]");
 
-        SimulatorResourceServerSP resource = buildResource(configPath, callback);
+        SimulatorResourceServerSP resource = buildResource(schema, callback);
         if (!resource)
         {
             break;
@@ -148,10 +157,14 @@ void ResourceManager::deleteResource(const SimulatorResourceServerSP &resource)
 void ResourceManager::deleteResources(const std::string &resourceType)
 {
     std::lock_guard<std::recursive_mutex> lock(m_lock);
-    for (auto & resourceTableEntry : m_resources)
+    for (auto resourceTable = m_resources.begin(); resourceTable != m_resources.end();)
     {
+        auto &resourceTableEntry = *resourceTable;
         if (!resourceType.empty() && resourceType.compare(resourceTableEntry.first))
+        {
+            ++resourceTable;
             continue;
+        }
 
         for (auto & resourceEntry : resourceTableEntry.second)
         {
@@ -164,7 +177,7 @@ void ResourceManager::deleteResources(const std::string &resourceType)
         }
 
         // Erase the entry for resource type from resources list
-        m_resources.erase(resourceTableEntry.first);
+        resourceTable = m_resources.erase(resourceTable);
     }
 }
 
@@ -176,7 +189,19 @@ SimulatorResourceServerSP ResourceManager::buildResource(const std::string &conf
         SimulatorResourceServer::ResourceModelChangedCB callback)
 {
     // Create resource based on the RAML file.
-    SimulatorResourceServerImplSP resourceImpl = m_resourceCreator.createResource(configPath);
+    return registerResource(m_resourceCreator.createResource(configPath), callback);
+}
+
+SimulatorResourceServerSP ResourceManager::buildResource(const ResourceSchemaSP &schema,
+        SimulatorResourceServer::ResourceModelChangedCB callback)
+{
+    return registerResource(m_resourceCreator.createResource(schema), callback);
+}
+
+SimulatorResourceServerSP ResourceManager::registerResource(
+    SimulatorResourceServerImplSP resourceImpl,
+    SimulatorResourceServer::ResourceModelChangedCB callback)
+{
     if (!resourceImpl)
     {
         OC_LOG(ERROR, TAG, "Failed to create resource!");
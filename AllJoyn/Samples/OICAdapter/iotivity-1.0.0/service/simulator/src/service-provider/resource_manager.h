@@ -57,7 +57,7 @@ class ResourceManager
 
         /**
              * This method is for creating multiple resources of same type based on the input data
-             * provided from RAML file.
+             * provided from RAML file. The file is parsed once and the resources share its schema.
              *
              * @param configPath - RAML configuration file path.
              * @param count - Number of resource to be created.
@@ -67,7 +67,7 @@ class ResourceManager
              * resources.
              */
         std::vector<SimulatorResourceServerSP> createResource(const std::string &configPath,
-                unsigned short count, SimulatorResourceServer::ResourceModelChangedCB callback);
+                unsigned int count, SimulatorResourceServer::ResourceModelChangedCB callback);
 
         /**
              * This method is for obtaining a list of created resources.
@@ -106,6 +106,10 @@ class ResourceManager
 
         SimulatorResourceServerSP buildResource(const std::string &configPath,
                                                 SimulatorResourceServer::ResourceModelChangedCB callback);
+        SimulatorResourceServerSP buildResource(const ResourceSchemaSP &schema,
+                                                SimulatorResourceServer::ResourceModelChangedCB callback);
+        SimulatorResourceServerSP registerResource(SimulatorResourceServerImplSP resourceImpl,
+                SimulatorResourceServer::ResourceModelChangedCB callback);
         std::string constructURI(const std::string &uri);
 
         /*Member variables*/
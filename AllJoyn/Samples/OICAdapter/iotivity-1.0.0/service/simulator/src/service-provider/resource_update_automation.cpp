@@ -20,6 +20,7 @@
 
 #include "resource_update_automation.h"
 #include "simulator_resource_server_impl.h"
+#include "update_scheduler.h"
 #include "simulator_exceptions.h"
 #include "simulator_logger.h"
 #include "logger.h"
@@ -27,23 +28,29 @@
 #define ATAG "ATTRIBUTE_AUTOMATION"
 #define RTAG "RESOURCE_AUTOMATION"
 
-#define SLEEP_FOR(X) if (X > 0) std::this_thread::sleep_for(std::chrono::milliseconds(X));
-
 AttributeUpdateAutomation::AttributeUpdateAutomation(int id, SimulatorResourceServer *resource,
         const std::string &attrName, AutomationType type, int interval,
         updateCompleteCallback callback, std::function<void (const int)> finishedCallback)
-    :   m_resource(resource),
+    :   m_resource(dynamic_cast<SimulatorResourceServerImpl *>(resource)),
         m_attrName(attrName),
         m_type(type),
         m_id(id),
         m_stopRequested(false),
+        m_completed(false),
         m_updateInterval(interval),
         m_callback(callback),
         m_finishedCallback(finishedCallback),
-        m_thread(nullptr) {}
+        m_taskId(-1),
+        m_valueIndex(0) {}
 
 void AttributeUpdateAutomation::start()
 {
+    if (!m_resource)
+    {
+        OC_LOG(ERROR, ATAG, "Invalid resource!");
+        throw SimulatorException(SIMULATOR_ERROR, "Invalid resource!");
+    }
+
     // Check the validity of attribute
     SimulatorResourceModel resModel = m_resource->getModel();
     if (false == resModel.getAttribute(m_attrName, m_attribute))
@@ -59,32 +66,73 @@ void AttributeUpdateAutomation::start()
             m_updateInterval = 0;
     }
 
-    m_thread = new std::thread(&AttributeUpdateAutomation::updateAttribute, this);
+    // The task keeps the automation alive until it is finished or cancelled
+    AttributeUpdateAutomationSP self = shared_from_this();
+    m_taskId = UpdateScheduler::getInstance()->schedule(m_updateInterval, [self]()
+    {
+        return self->updateAttribute();
+    });
 }
 
 void AttributeUpdateAutomation::stop()
 {
+    if (m_taskId < 0)
+        return;
+
     m_stopRequested = true;
-    if (m_thread)
-        m_thread->join();
+    UpdateScheduler::getInstance()->cancel(m_taskId);
+    completed();
 }
 
-void AttributeUpdateAutomation::updateAttribute()
+/**
+ * One step of the automation, sets the next value of the attribute. The observers are
+ * notified by the resource once for all the updates made to it in the same round.
+ */
+bool AttributeUpdateAutomation::updateAttribute()
 {
-    do
+    if (m_stopRequested)
+        return false;
+
+    bool isInteger = (SimulatorResourceModel::Attribute::ValueType::INTEGER ==
+                      m_attribute.getValueType());
+    int min = 0;
+    int max = 0;
+    long long count;
+    if (isInteger)
     {
-        try
-        {
-            setAttributeValue();
-        }
-        catch (SimulatorException &e)
+        m_attribute.getRange(min, max);
+        count = (min <= max) ? static_cast<long long>(max) - min + 1 : 0;
+    }
+    else
+    {
+        count = m_attribute.getAllowedValuesSize();
+    }
+
+    if (m_valueIndex >= count)
+    {
+        if (AutomationType::RECURRENT != m_type || 0 == count)
         {
-            break;
+            completed();
+            return false;
         }
-        if (m_stopRequested)
-            break;
+        m_valueIndex = 0;
     }
-    while (AutomationType::RECURRENT == m_type);
+
+    if (isInteger)
+        m_resource->setAttributeValue(m_attrName, static_cast<int>(min + m_valueIndex));
+    else
+        m_resource->setFromAllowedValues(m_attrName, static_cast<unsigned int>(m_valueIndex));
+    m_valueIndex++;
+
+    m_resource->notifyBatched();
+    return true;
+}
+
+void AttributeUpdateAutomation::completed()
+{
+    // Either the last step or stop(), whichever comes first
+    if (m_completed.exchange(true))
+        return;
 
     if (!m_stopRequested)
     {
@@ -100,42 +148,6 @@ void AttributeUpdateAutomation::updateAttribute()
         m_finishedCallback(m_id);
 }
 
-void AttributeUpdateAutomation::setAttributeValue()
-{
-    SimulatorResourceServerImpl *resourceImpl =
-        dynamic_cast<SimulatorResourceServerImpl *>(m_resource);
-    if (!resourceImpl)
-        return;
-
-    if (SimulatorResourceModel::Attribute::ValueType::INTEGER ==
-            m_attribute.getValueType()) // For integer type values
-    {
-        int min;
-        int max;
-
-        m_attribute.getRange(min, max);
-        for (int value = min; value <= max; value++)
-        {
-            if (m_stopRequested)
-                break;
-            resourceImpl->updateAttributeValue(m_attribute.getName(), value);
-            resourceImpl->notifyApp();
-            SLEEP_FOR(m_updateInterval);
-        }
-    }
-    else
-    {
-        for (int index = 0; index < m_attribute.getAllowedValuesSize(); index++)
-        {
-            if (m_stopRequested)
-                break;
-            resourceImpl->updateFromAllowedValues(m_attribute.getName(), index);
-            resourceImpl->notifyApp();
-            SLEEP_FOR(m_updateInterval);
-        }
-    }
-}
-
 ResourceUpdateAutomation::ResourceUpdateAutomation(int id, SimulatorResourceServer *resource,
         AutomationType type, int interval, updateCompleteCallback callback,
         std::function<void (const int)> finishedCallback)
@@ -143,6 +155,7 @@ ResourceUpdateAutomation::ResourceUpdateAutomation(int id, SimulatorResourceServ
         m_type(type),
         m_id(id),
         m_updateInterval(interval),
+        m_stopped(false),
         m_callback(callback),
         m_finishedCallback(finishedCallback) {}
 
@@ -156,14 +169,28 @@ void ResourceUpdateAutomation::start()
         throw SimulatorException(SIMULATOR_ERROR, "Resource has zero attributes!");
     }
 
+    // The attribute automations may finish as soon as they are started,
+    // all of them are listed before the first one starts.
+    std::weak_ptr<ResourceUpdateAutomation> weakSelf = shared_from_this();
+    std::vector<AttributeUpdateAutomationSP> automations;
     int id = 0;
     for (auto & attribute : attributes)
     {
         AttributeUpdateAutomationSP attributeAutomation(new AttributeUpdateAutomation(
                     id, m_resource, attribute.first, m_type, m_updateInterval, nullptr,
-                    std::bind(&ResourceUpdateAutomation::finished, this, std::placeholders::_1)));
+                    [weakSelf](const int attrAutomationId)
+        {
+            if (ResourceUpdateAutomationSP self = weakSelf.lock())
+                self->finished(attrAutomationId);
+        }));
 
+        std::lock_guard<std::mutex> lock(m_lock);
         m_attrUpdationList[id++] = attributeAutomation;
+        automations.push_back(attributeAutomation);
+    }
+
+    for (auto & attributeAutomation : automations)
+    {
         try
         {
             attributeAutomation->start();
@@ -178,29 +205,37 @@ void ResourceUpdateAutomation::start()
 
 void ResourceUpdateAutomation::finished(int id)
 {
-    if (m_attrUpdationList.end() != m_attrUpdationList.find(id))
     {
-        m_attrUpdationList.erase(m_attrUpdationList.find(id));
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto automation = m_attrUpdationList.find(id);
+        if (m_stopped || m_attrUpdationList.end() == automation)
+            return;
+
+        m_attrUpdationList.erase(automation);
+        if (m_attrUpdationList.size())
+            return;
     }
 
-    if (!m_attrUpdationList.size())
-    {
-        // Notify application through callback
-        if (m_callback)
-            m_callback(m_resource->getURI(), m_id);
+    // Notify application through callback
+    if (m_callback)
+        m_callback(m_resource->getURI(), m_id);
 
-        if (m_finishedCallback)
-            m_finishedCallback(m_id);
-    }
+    if (m_finishedCallback)
+        m_finishedCallback(m_id);
 }
 
 void ResourceUpdateAutomation::stop()
 {
+    std::map<int, AttributeUpdateAutomationSP> attrUpdationList;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stopped = true;
+        attrUpdationList.swap(m_attrUpdationList);
+    }
+
     // Stop all the attributes updation
-    for (auto & attrAutomation : m_attrUpdationList)
+    for (auto & attrAutomation : attrUpdationList)
     {
         (attrAutomation.second)->stop();
     }
-
-    m_attrUpdationList.clear();
 }
@@ -22,9 +22,15 @@
 #define RESOURCE_UPDATE_AUTOMATION_H_
 
 #include "simulator_resource_server.h"
-#include <thread>
+#include <atomic>
 
-class AttributeUpdateAutomation
+class SimulatorResourceServerImpl;
+
+/**
+ * Steps through the values of an attribute, one value per update interval. The steps run on
+ * the shared UpdateScheduler rather than on a thread of their own.
+ */
+class AttributeUpdateAutomation : public std::enable_shared_from_this<AttributeUpdateAutomation>
 {
     public:
         AttributeUpdateAutomation(int id, SimulatorResourceServer *resource,
@@ -37,24 +43,26 @@ class AttributeUpdateAutomation
         void stop();
 
     private:
-        void updateAttribute();
-        void setAttributeValue();
+        bool updateAttribute();
+        void completed();
 
-        SimulatorResourceServer *m_resource;
+        SimulatorResourceServerImpl *m_resource;
         std::string m_attrName;
         AutomationType m_type;
         int m_id;
-        bool m_stopRequested;
+        std::atomic<bool> m_stopRequested;
+        std::atomic<bool> m_completed;
         int m_updateInterval;
         SimulatorResourceModel::Attribute m_attribute;
         updateCompleteCallback m_callback;
         std::function<void (const int)> m_finishedCallback;
-        std::thread *m_thread;
+        int m_taskId;
+        long long m_valueIndex;
 };
 
 typedef std::shared_ptr<AttributeUpdateAutomation> AttributeUpdateAutomationSP;
 
-class ResourceUpdateAutomation
+class ResourceUpdateAutomation : public std::enable_shared_from_this<ResourceUpdateAutomation>
 {
     public:
         ResourceUpdateAutomation(int id, SimulatorResourceServer *resource,
@@ -74,6 +82,8 @@ class ResourceUpdateAutomation
         int m_id;
         int m_updateInterval;
         SimulatorResourceModel m_resModel;
+        std::mutex m_lock;
+        bool m_stopped;
         std::map<int, AttributeUpdateAutomationSP> m_attrUpdationList;
         updateCompleteCallback m_callback;
         std::function<void (const int)> m_finishedCallback;
@@ -28,6 +28,12 @@
 UpdateAutomationMngr::UpdateAutomationMngr()
     :   m_id(0) {}
 
+UpdateAutomationMngr::~UpdateAutomationMngr()
+{
+    // The scheduled steps refer to the resource which owns this manager
+    stopAll();
+}
+
 int UpdateAutomationMngr::startResourceAutomation(SimulatorResourceServer *resource,
         AutomationType type, int interval, updateCompleteCallback callback)
 {
@@ -98,19 +104,36 @@ std::vector<int> UpdateAutomationMngr::getAttributeAutomationIds()
     return ids;
 }
 
+/**
+ * The automations are stopped without holding the lock, as an automation which finishes
+ * meanwhile reports it through automationCompleted() from the update scheduler.
+ */
 void UpdateAutomationMngr::stop(int id)
 {
-    std::lock_guard<std::mutex> lock(m_lock);
-    if (m_resourceUpdationList.end() != m_resourceUpdationList.find(id))
+    ResourceUpdateAutomationSP resourceAutomation;
+    AttributeUpdateAutomationSP attributeAutomation;
     {
-        m_resourceUpdationList[id]->stop();
-        m_resourceUpdationList.erase(m_resourceUpdationList.find(id));
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_resourceUpdationList.end() != m_resourceUpdationList.find(id))
+        {
+            resourceAutomation = m_resourceUpdationList[id];
+            m_resourceUpdationList.erase(m_resourceUpdationList.find(id));
+        }
+        else if (m_attrUpdationList.end() != m_attrUpdationList.find(id))
+        {
+            attributeAutomation = m_attrUpdationList[id];
+            m_attrUpdationList.erase(m_attrUpdationList.find(id));
+        }
+    }
+
+    if (resourceAutomation)
+    {
+        resourceAutomation->stop();
         return;
     }
-    else if (m_attrUpdationList.end() != m_attrUpdationList.find(id))
+    else if (attributeAutomation)
     {
-        m_attrUpdationList[id]->stop();
-        m_attrUpdationList.erase(m_attrUpdationList.find(id));
+        attributeAutomation->stop();
         return;
     }
 
@@ -120,21 +143,25 @@ void UpdateAutomationMngr::stop(int id)
 
 void UpdateAutomationMngr::stopAll()
 {
-    std::lock_guard<std::mutex> lock(m_lock);
-    std::for_each(m_resourceUpdationList.begin(),
-                  m_resourceUpdationList.end(), [] (std::pair<int, ResourceUpdateAutomationSP> element)
+    std::map<int, ResourceUpdateAutomationSP> resourceUpdationList;
+    std::map<int, AttributeUpdateAutomationSP> attrUpdationList;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        resourceUpdationList.swap(m_resourceUpdationList);
+        attrUpdationList.swap(m_attrUpdationList);
+    }
+
+    std::for_each(resourceUpdationList.begin(),
+                  resourceUpdationList.end(), [] (std::pair<int, ResourceUpdateAutomationSP> element)
     {
         element.second->stop();
     });
-    m_resourceUpdationList.clear();
 
-    std::for_each(m_attrUpdationList.begin(),
-                  m_attrUpdationList.end(), [] (std::pair<int, AttributeUpdateAutomationSP> element)
+    std::for_each(attrUpdationList.begin(),
+                  attrUpdationList.end(), [] (std::pair<int, AttributeUpdateAutomationSP> element)
     {
         element.second->stop();
     });
-
-    m_attrUpdationList.clear();
 }
 
 void UpdateAutomationMngr::automationCompleted(int id)
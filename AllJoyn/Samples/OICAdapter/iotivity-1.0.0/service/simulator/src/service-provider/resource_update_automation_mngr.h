@@ -29,6 +29,8 @@ class UpdateAutomationMngr
     public:
         UpdateAutomationMngr();
 
+        ~UpdateAutomationMngr();
+
         int startResourceAutomation(SimulatorResourceServer *resource,
                                     AutomationType type, int interval, updateCompleteCallback callback);
 
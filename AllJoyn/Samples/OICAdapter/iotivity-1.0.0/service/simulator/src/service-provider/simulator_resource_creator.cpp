@@ -28,6 +28,31 @@
 unsigned int SimulatorResourceCreator::s_id;
 SimulatorResourceServerImplSP SimulatorResourceCreator::createResource(
     const std::string &configPath)
+{
+    ResourceSchemaSP schema = loadSchema(configPath);
+    if (!schema)
+        return nullptr;
+
+    return createResource(schema);
+}
+
+SimulatorResourceServerImplSP SimulatorResourceCreator::createResource(
+    const ResourceSchemaSP &schema)
+{
+    SimulatorResourceServerImplSP simResource(new SimulatorResourceServerImpl());
+    simResource->setName(schema->name);
+    simResource->setURI(constructURI(schema->uri));
+    if (!schema->resourceType.empty())
+        simResource->setResourceType(schema->resourceType);
+    if (!schema->interfaceType.empty())
+        simResource->setInterfaceType(schema->interfaceType);
+
+    // Copies of the attributes share their range and allowed values with the schema
+    simResource->setModel(schema->model);
+    return simResource;
+}
+
+ResourceSchemaSP SimulatorResourceCreator::loadSchema(const std::string &configPath)
 {
     RAML::RamlPtr raml;
 
@@ -52,9 +77,9 @@ SimulatorResourceServerImplSP SimulatorResourceCreator::createResource(
 
     if (ramlResource)
     {
-        SimulatorResourceServerImplSP simResource(new SimulatorResourceServerImpl());
-        simResource->setName(ramlResource->getDisplayName());
-        simResource->setURI(ramlResource->getResourceUri());
+        std::shared_ptr<ResourceSchema> schema = std::make_shared<ResourceSchema>();
+        schema->name = ramlResource->getDisplayName();
+        schema->uri = ramlResource->getResourceUri();
 
         // Get the resource representation schema from GET response body
         RAML::ActionPtr action = ramlResource->getAction(RAML::ActionType::GET);
@@ -84,12 +109,12 @@ SimulatorResourceServerImplSP SimulatorResourceCreator::createResource(
                 std::string propName = propertyElement.second->getName();
                 if ("rt" == propName || "resourceType" == propName)
                 {
-                    simResource->setResourceType(propertyElement.second->getValueString());
+                    schema->resourceType = propertyElement.second->getValueString();
                     continue;
                 }
                 else if ("if" == propName)
                 {
-                    simResource->setInterfaceType(propertyElement.second->getValueString());
+                    schema->interfaceType = propertyElement.second->getValueString();
                     continue;
                 }
                 else if ("p" == propName || "n" == propName || "id" == propName)
@@ -126,12 +151,11 @@ SimulatorResourceServerImplSP SimulatorResourceCreator::createResource(
                 if (propertyElement.second->getAllowedValuesSize() > 0)
                     attribute.setAllowedValues(propertyElement.second->getAllowedValues());
 
-                simResource->addAttribute(attribute);
+                schema->model.addAttribute(attribute);
             }
         }
 
-        simResource->setURI(constructURI(simResource->getURI()));
-        return simResource;
+        return schema;
     }
 
     return nullptr;
@@ -23,11 +23,30 @@
 
 #include "simulator_resource_server_impl.h"
 
+/**
+ * What the RAML file tells about a resource. It is parsed once for all the resources
+ * created from the same file, whose models share the attribute schema.
+ */
+struct ResourceSchema
+{
+    std::string name;
+    std::string uri;
+    std::string resourceType;
+    std::string interfaceType;
+    SimulatorResourceModel model;
+};
+
+typedef std::shared_ptr<const ResourceSchema> ResourceSchemaSP;
+
 class SimulatorResourceCreator
 {
     public:
         SimulatorResourceServerImplSP createResource(const std::string &configPath);
 
+        ResourceSchemaSP loadSchema(const std::string &configPath);
+
+        SimulatorResourceServerImplSP createResource(const ResourceSchemaSP &schema);
+
     private:
         std::string constructURI(const std::string &uri);
         static unsigned int s_id;
@@ -46,23 +46,35 @@ std::string SimulatorResourceServer::getName() const
 
 void SimulatorResourceServer::addAttribute(SimulatorResourceModel::Attribute &attribute)
 {
+    std::lock_guard<std::mutex> lock(m_modelLock);
     m_resModel.addAttribute(attribute);
 }
 
 void SimulatorResourceServer::setRange(const std::string &attrName, const int min, const int max)
 {
+    std::lock_guard<std::mutex> lock(m_modelLock);
     m_resModel.setRange(attrName, min, max);
 }
 
+void SimulatorResourceServer::setUpdateInterval(const std::string &attrName, int interval)
+{
+    std::lock_guard<std::mutex> lock(m_modelLock);
+    m_resModel.setUpdateInterval(attrName, interval);
+}
+
 SimulatorResourceModel SimulatorResourceServer::getModel() const
 {
+    std::lock_guard<std::mutex> lock(m_modelLock);
     return m_resModel;
 }
 
 void SimulatorResourceServer::updateFromAllowedValues(const std::string &attrName,
         unsigned int index)
 {
-    m_resModel.updateAttributeFromAllowedValues(attrName, index);
+    {
+        std::lock_guard<std::mutex> lock(m_modelLock);
+        m_resModel.updateAttributeFromAllowedValues(attrName, index);
+    }
 
     // Notify all the subscribers
     notifyAll();
@@ -70,6 +82,7 @@ void SimulatorResourceServer::updateFromAllowedValues(const std::string &attrNam
 
 void SimulatorResourceServer::removeAttribute(const std::string &attrName)
 {
+    std::lock_guard<std::mutex> lock(m_modelLock);
     m_resModel.removeAttribute(attrName);
 }
 
@@ -19,6 +19,7 @@
  ******************************************************************/
 
 #include "simulator_resource_server_impl.h"
+#include "update_scheduler.h"
 #include "simulator_utils.h"
 #include "simulator_logger.h"
 #include "logger.h"
@@ -26,12 +27,19 @@
 #define TAG "SIM_RESOURCE_SERVER"
 
 SimulatorResourceServerImpl::SimulatorResourceServerImpl()
-    :   m_resourceHandle(NULL)
+    :   m_notifyPending(false),
+        m_resourceHandle(NULL)
 {
     m_property = static_cast<OCResourceProperty>(OC_DISCOVERABLE | OC_OBSERVABLE);
     m_interfaceType.assign(OC::DEFAULT_INTERFACE);
 }
 
+void SimulatorResourceServerImpl::setModel(const SimulatorResourceModel &model)
+{
+    std::lock_guard<std::mutex> lock(m_modelLock);
+    m_resModel = model;
+}
+
 bool SimulatorResourceServerImpl::isObservable() const
 {
     return (m_property & OC_OBSERVABLE);
@@ -129,6 +137,7 @@ void SimulatorResourceServerImpl::setObserverCallback(ObserverCB callback)
 
 std::vector<ObserverInfo> SimulatorResourceServerImpl::getObserversList()
 {
+    std::lock_guard<std::mutex> lock(m_observersLock);
     return m_observersList;
 }
 
@@ -169,7 +178,14 @@ void SimulatorResourceServerImpl::notifyAll()
         throw SimulatorException(SIMULATOR_NO_RESOURCE, "Invalid resource!");
     }
 
-    if (!m_observersList.size())
+    OC::ObservationIds observers;
+    {
+        std::lock_guard<std::mutex> lock(m_observersLock);
+        for (auto & observer : m_observersList)
+            observers.push_back(observer.id);
+    }
+
+    if (!observers.size())
     {
         OC_LOG(ERROR, TAG, "Observers list is empty!");
         return;
@@ -182,10 +198,6 @@ void SimulatorResourceServerImpl::notifyAll()
     resourceResponse->setResponseResult(OC_EH_OK);
     resourceResponse->setResourceRepresentation(getOCRepresentation(), OC::DEFAULT_INTERFACE);
 
-    OC::ObservationIds observers;
-    for (auto & observer : m_observersList)
-        observers.push_back(observer.id);
-
     SIM_LOG(ILogger::INFO, "[" << m_uri << "] Sending notification to all observers");
 
     typedef OCStackResult (*NotifyListOfObservers)(OCResourceHandle, OC::ObservationIds &,
@@ -229,6 +241,9 @@ void SimulatorResourceServerImpl::stop()
         throw SimulatorException(SIMULATOR_NO_RESOURCE, "Invalid resource!");
     }
 
+    // The automation would otherwise keep updating a resource which is gone
+    m_updateAutomationMgr.stopAll();
+
     typedef OCStackResult (*UnregisterResource)(const OCResourceHandle &);
 
     invokeocplatform(static_cast<UnregisterResource>(OC::OCPlatform::unregisterResource),
@@ -242,18 +257,79 @@ void SimulatorResourceServerImpl::notifyApp()
     // Notify the application callback
     if (m_callback)
     {
-        m_callback(m_uri, m_resModel);
+        m_callback(m_uri, getModel());
+    }
+}
+
+void SimulatorResourceServerImpl::setFromAllowedValues(const std::string &attrName,
+        unsigned int index)
+{
+    std::lock_guard<std::mutex> lock(m_modelLock);
+    m_resModel.updateAttributeFromAllowedValues(attrName, index);
+}
+
+void SimulatorResourceServerImpl::notifyBatched()
+{
+    if (m_notifyPending.exchange(true))
+        return;
+
+    std::weak_ptr<SimulatorResourceServerImpl> weakSelf;
+    try
+    {
+        weakSelf = shared_from_this();
+    }
+    catch (std::bad_weak_ptr &e)
+    {
+        // Resource is being released
+        return;
+    }
+
+    UpdateScheduler::getInstance()->post([weakSelf]()
+    {
+        if (SimulatorResourceServerImplSP self = weakSelf.lock())
+            self->sendBatchedNotification();
+    });
+}
+
+void SimulatorResourceServerImpl::sendBatchedNotification()
+{
+    // Cleared first, an update made from now on needs a notification of its own
+    m_notifyPending = false;
+
+    bool observed;
+    {
+        std::lock_guard<std::mutex> lock(m_observersLock);
+        observed = !m_observersList.empty();
     }
+
+    if (observed && m_resourceHandle)
+    {
+        try
+        {
+            notifyAll();
+        }
+        catch (SimulatorException &e)
+        {
+            OC_LOG_V(ERROR, TAG, "Failed to notify the observers of %s!", m_uri.c_str());
+        }
+    }
+
+    notifyApp();
 }
 
 OC::OCRepresentation SimulatorResourceServerImpl::getOCRepresentation()
 {
+    std::lock_guard<std::mutex> lock(m_modelLock);
     return m_resModel.getOCRepresentation();
 }
 
 bool SimulatorResourceServerImpl::modifyResourceModel(OC::OCRepresentation &ocRep)
 {
-    bool status = m_resModel.update(ocRep);
+    bool status;
+    {
+        std::lock_guard<std::mutex> lock(m_modelLock);
+        status = m_resModel.update(ocRep);
+    }
     if (true == status)
     {
         resourceModified();
@@ -272,10 +348,7 @@ void SimulatorResourceServerImpl::resourceModified()
     notifyAll();
 
     // Notify the application callback
-    if (m_callback)
-    {
-        m_callback(m_uri, m_resModel);
-    }
+    notifyApp();
 }
 
 OCEntityHandlerResult SimulatorResourceServerImpl::entityHandler(
@@ -403,7 +476,10 @@ OCEntityHandlerResult SimulatorResourceServerImpl::entityHandler(
             SIM_LOG(ILogger::INFO, "[" << m_uri << "] OBSERVE REGISTER request received");
 
             ObserverInfo info {observationInfo.obsId, observationInfo.address, observationInfo.port};
-            m_observersList.push_back(info);
+            {
+                std::lock_guard<std::mutex> lock(m_observersLock);
+                m_observersList.push_back(info);
+            }
 
             //Inform about addition of observer
             if (m_observeCallback)
@@ -416,12 +492,15 @@ OCEntityHandlerResult SimulatorResourceServerImpl::entityHandler(
             SIM_LOG(ILogger::INFO, "[" << m_uri << "] OBSERVE UNREGISTER request received");
 
             ObserverInfo info;
-            for (auto iter = m_observersList.begin(); iter != m_observersList.end(); iter++)
             {
-                if ((info = *iter), info.id == observationInfo.obsId)
+                std::lock_guard<std::mutex> lock(m_observersLock);
+                for (auto iter = m_observersList.begin(); iter != m_observersList.end(); iter++)
                 {
-                    m_observersList.erase(iter);
-                    break;
+                    if ((info = *iter), info.id == observationInfo.obsId)
+                    {
+                        m_observersList.erase(iter);
+                        break;
+                    }
                 }
             }
 
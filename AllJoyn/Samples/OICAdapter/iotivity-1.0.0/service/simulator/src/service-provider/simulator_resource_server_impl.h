@@ -23,12 +23,16 @@
 
 #include "simulator_resource_server.h"
 #include "resource_update_automation_mngr.h"
+#include <atomic>
 
-class SimulatorResourceServerImpl : public SimulatorResourceServer
+class SimulatorResourceServerImpl : public SimulatorResourceServer,
+    public std::enable_shared_from_this<SimulatorResourceServerImpl>
 {
     public:
         SimulatorResourceServerImpl();
 
+        void setModel(const SimulatorResourceModel &model);
+
         void setURI(const std::string &uri);
 
         void setResourceType(const std::string &resourceType);
@@ -69,16 +73,38 @@ class SimulatorResourceServerImpl : public SimulatorResourceServer
 
         void notifyApp();
 
+        /**
+         * Updates used by the update automation, which leave the notifications to
+         * notifyBatched().
+         */
+        template <typename T>
+        void setAttributeValue(const std::string &attrName, const T &value)
+        {
+            std::lock_guard<std::mutex> lock(m_modelLock);
+            m_resModel.updateAttribute(attrName, value);
+        }
+
+        void setFromAllowedValues(const std::string &attrName, unsigned int index);
+
+        /**
+         * Notifies the observers and the application of the model from the update scheduler.
+         * The updates made before the notification is sent are all covered by it.
+         */
+        void notifyBatched();
+
     private:
         OC::OCRepresentation getOCRepresentation();
         bool modifyResourceModel(OC::OCRepresentation &ocRep);
         OCEntityHandlerResult entityHandler(std::shared_ptr<OC::OCResourceRequest> request);
         void resourceModified();
+        void sendBatchedNotification();
 
         ResourceModelChangedCB m_callback;
         ObserverCB m_observeCallback;
         UpdateAutomationMngr m_updateAutomationMgr;
         std::vector<ObserverInfo> m_observersList;
+        std::mutex m_observersLock;
+        std::atomic<bool> m_notifyPending;
 
         OCResourceProperty m_property;
         OCResourceHandle m_resourceHandle;
@@ -0,0 +1,269 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "update_scheduler.h"
+#include "logger.h"
+
+#include <algorithm>
+
+#define TAG "UPDATE_SCHEDULER"
+
+// Two workers at least, so that a slow notification does not hold all the updates
+#define MIN_WORKERS 2
+
+UpdateScheduler *UpdateScheduler::getInstance()
+{
+    // Never destroyed, resources which are released at exit still cancel their tasks here
+    static UpdateScheduler *s_instance = new UpdateScheduler();
+    return s_instance;
+}
+
+UpdateScheduler::UpdateScheduler()
+    :   m_started(false),
+        m_workers(0),
+        m_id(0),
+        m_steps(0),
+        m_jobs(0),
+        m_lateSteps(0),
+        m_maxLag(Clock::duration::zero()) {}
+
+int UpdateScheduler::schedule(unsigned int interval, Step step)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    startThreads();
+
+    int id = m_id++;
+    Task &task = m_tasks[id];
+    task.interval = std::chrono::milliseconds(interval);
+    task.due = Clock::now();
+    task.step = std::make_shared<Step>(std::move(step));
+    task.running = false;
+    task.cancelled = false;
+
+    m_ready.push_back(WorkItem {id, nullptr});
+    m_workCond.notify_one();
+    return id;
+}
+
+void UpdateScheduler::cancel(int id)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto task = m_tasks.find(id);
+    if (m_tasks.end() == task)
+        return;
+
+    // The timer or ready entry of a task which is not running is skipped once the task is gone
+    if (!task->second.running)
+    {
+        // What the step holds is released without the lock, it may cancel other tasks
+        std::shared_ptr<Step> step = std::move(task->second.step);
+        m_tasks.erase(task);
+        lock.unlock();
+        return;
+    }
+
+    task->second.cancelled = true;
+    if (task->second.runner == std::this_thread::get_id())
+        return;
+
+    m_doneCond.wait(lock, [this, id] { return m_tasks.end() == m_tasks.find(id); });
+}
+
+void UpdateScheduler::post(Job job)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    startThreads();
+
+    m_ready.push_back(WorkItem {-1, std::move(job)});
+    m_workCond.notify_one();
+}
+
+UpdateScheduler::Statistics UpdateScheduler::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    Statistics stats;
+    stats.workers = m_workers;
+    stats.tasks = m_tasks.size();
+    stats.steps = m_steps;
+    stats.jobs = m_jobs;
+    stats.lateSteps = m_lateSteps;
+    stats.maxLag = std::chrono::duration_cast<std::chrono::microseconds>(m_maxLag);
+    return stats;
+}
+
+void UpdateScheduler::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_steps = 0;
+    m_jobs = 0;
+    m_lateSteps = 0;
+    m_maxLag = Clock::duration::zero();
+}
+
+/**
+ * The threads are started by the first task or job, and run as long as the process,
+ * a simulator which never automates updates does not pay for them.
+ */
+void UpdateScheduler::startThreads()
+{
+    if (m_started)
+        return;
+
+    m_started = true;
+    m_workers = std::max<unsigned int>(MIN_WORKERS, std::thread::hardware_concurrency());
+    OC_LOG_V(DEBUG, TAG, "Starting the update scheduler with %u workers", m_workers);
+
+    std::thread(&UpdateScheduler::timerLoop, this).detach();
+    for (unsigned int i = 0; i < m_workers; i++)
+        std::thread(&UpdateScheduler::workerLoop, this).detach();
+}
+
+void UpdateScheduler::timerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        if (m_timers.empty())
+        {
+            m_timerCond.wait(lock);
+            continue;
+        }
+
+        TimerEntry next = m_timers.top();
+        if (next.due > Clock::now())
+        {
+            m_timerCond.wait_until(lock, next.due);
+            continue;
+        }
+
+        m_timers.pop();
+        auto task = m_tasks.find(next.id);
+        if (m_tasks.end() == task || task->second.running || task->second.due != next.due)
+            continue;
+
+        m_ready.push_back(WorkItem {next.id, nullptr});
+        m_workCond.notify_one();
+    }
+}
+
+void UpdateScheduler::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        m_workCond.wait(lock, [this] { return !m_ready.empty(); });
+
+        WorkItem item = std::move(m_ready.front());
+        m_ready.pop_front();
+
+        if (item.id >= 0)
+        {
+            runStep(lock, item.id);
+            continue;
+        }
+
+        m_jobs++;
+        lock.unlock();
+        try
+        {
+            item.job();
+        }
+        catch (...)
+        {
+            OC_LOG(ERROR, TAG, "Exception from a scheduled job!");
+        }
+        lock.lock();
+    }
+}
+
+/**
+ * Called with the lock held, releases it while the step runs. Tasks run at a fixed rate,
+ * a step which starts late does not make the next ones run faster to catch up though.
+ */
+void UpdateScheduler::runStep(std::unique_lock<std::mutex> &lock, int id)
+{
+    auto entry = m_tasks.find(id);
+    if (m_tasks.end() == entry)
+        return;
+
+    Task &task = entry->second;
+    Clock::time_point start = Clock::now();
+    Clock::duration lag = start - task.due;
+    if (lag > m_maxLag)
+        m_maxLag = lag;
+    if (task.interval.count() > 0 && lag > task.interval)
+        m_lateSteps++;
+    m_steps++;
+
+    task.running = true;
+    task.runner = std::this_thread::get_id();
+    std::shared_ptr<Step> step = task.step;
+
+    lock.unlock();
+    bool again = false;
+    try
+    {
+        again = (*step)();
+    }
+    catch (...)
+    {
+        OC_LOG_V(ERROR, TAG, "Exception from the step of task %d, task stopped!", id);
+    }
+    step.reset();
+    lock.lock();
+
+    // Only the runner removes a running task, the reference is still valid
+    task.running = false;
+    task.runner = std::thread::id();
+    if (!again || task.cancelled)
+    {
+        step = std::move(task.step);
+        m_tasks.erase(entry);
+        m_doneCond.notify_all();
+
+        lock.unlock();
+        step.reset();
+        lock.lock();
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    task.due += task.interval;
+    if (task.due < now)
+        task.due = now;
+
+    if (task.due <= now)
+    {
+        m_ready.push_back(WorkItem {id, nullptr});
+        m_workCond.notify_one();
+    }
+    else
+    {
+        pushTimer(id, task.due);
+    }
+}
+
+void UpdateScheduler::pushTimer(int id, Clock::time_point due)
+{
+    bool earliest = m_timers.empty() || due < m_timers.top().due;
+    m_timers.push(TimerEntry {due, id});
+    if (earliest)
+        m_timerCond.notify_one();
+}
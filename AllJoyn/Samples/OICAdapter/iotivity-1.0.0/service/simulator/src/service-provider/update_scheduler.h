@@ -0,0 +1,163 @@
+/******************************************************************
+ *
+ * Copyright 2015 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file   update_scheduler.h
+ *
+ * @brief   This file contains the scheduler which drives the update automation of all the
+ *             simulated resources from one timer thread and a fixed pool of worker threads.
+ */
+
+#ifndef UPDATE_SCHEDULER_H_
+#define UPDATE_SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @class   UpdateScheduler
+ * @brief   Runs periodic tasks at a fixed rate and one-shot jobs on a fixed pool of workers.
+ *
+ * A periodic task is a step function which is run once per interval until it returns false
+ * or is cancelled. A task never runs on two workers at the same time, the tasks are spread
+ * over the workers otherwise. One-shot jobs are queued behind the steps which are already
+ * due, which is what the resources use to send one notification for all the updates made
+ * to them in the same round.
+ */
+class UpdateScheduler
+{
+    public:
+        /**
+         * Step of a periodic task.
+         *
+         * @return true to be run again after the interval, false when the task is finished.
+         */
+        typedef std::function<bool ()> Step;
+        typedef std::function<void ()> Job;
+
+        struct Statistics
+        {
+            unsigned int workers;
+            unsigned int tasks;
+            uint64_t steps;
+            uint64_t jobs;
+            uint64_t lateSteps; // steps which started more than an interval after they were due
+            std::chrono::microseconds maxLag;
+        };
+
+        static UpdateScheduler *getInstance();
+
+        /**
+         * Schedules a periodic task. The first step is run as soon as a worker is free.
+         *
+         * @param interval - Interval between two steps in milliseconds, 0 to run the task
+         *                   again as soon as the other due tasks had their turn.
+         * @param step - Step function of the task.
+         *
+         * @return Identifier of the task.
+         */
+        int schedule(unsigned int interval, Step step);
+
+        /**
+         * Cancels a periodic task. When this returns the step is not running and will not
+         * be run again, unless it is called from the step itself.
+         *
+         * @param id - Identifier of the task.
+         */
+        void cancel(int id);
+
+        /**
+         * Queues a one-shot job behind the steps which are already due.
+         *
+         * @param job - Job to be run on a worker.
+         */
+        void post(Job job);
+
+        Statistics getStatistics();
+
+        void resetStatistics();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Task
+        {
+            std::chrono::milliseconds interval;
+            Clock::time_point due;
+            std::shared_ptr<Step> step;
+            bool running;
+            bool cancelled;
+            std::thread::id runner;
+        };
+
+        struct TimerEntry
+        {
+            Clock::time_point due;
+            int id;
+
+            bool operator>(const TimerEntry &other) const
+            {
+                return due > other.due || (due == other.due && id > other.id);
+            }
+        };
+
+        struct WorkItem
+        {
+            int id; // task to step, -1 for a job
+            Job job;
+        };
+
+        UpdateScheduler();
+        ~UpdateScheduler() = default;
+        UpdateScheduler(const UpdateScheduler &) = delete;
+        UpdateScheduler &operator=(const UpdateScheduler &) = delete;
+
+        void startThreads();
+        void timerLoop();
+        void workerLoop();
+        void runStep(std::unique_lock<std::mutex> &lock, int id);
+        void pushTimer(int id, Clock::time_point due);
+
+        std::mutex m_lock;
+        std::condition_variable m_timerCond;
+        std::condition_variable m_workCond;
+        std::condition_variable m_doneCond;
+        std::map<int, Task> m_tasks;
+        std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> m_timers;
+        std::deque<WorkItem> m_ready;
+        bool m_started;
+        unsigned int m_workers;
+        int m_id;
+        uint64_t m_steps;
+        uint64_t m_jobs;
+        uint64_t m_lateSteps;
+        Clock::duration m_maxLag;
+};
+
+#endif
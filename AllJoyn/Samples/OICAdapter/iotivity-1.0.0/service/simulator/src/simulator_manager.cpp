@@ -51,7 +51,7 @@ std::shared_ptr<SimulatorResourceServer> SimulatorManager::createResource(
 }
 
 std::vector<std::shared_ptr<SimulatorResourceServer>> SimulatorManager::createResource(
-            const std::string &configPath, unsigned short count,
+            const std::string &configPath, unsigned int count,
             SimulatorResourceServer::ResourceModelChangedCB callback)
 {
     return ResourceManager::getInstance()->createResource(configPath, count, callback);
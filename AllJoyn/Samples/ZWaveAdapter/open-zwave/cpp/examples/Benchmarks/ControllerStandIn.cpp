@@ -0,0 +1,629 @@
+//-----------------------------------------------------------------------------
+//
+//	ControllerStandIn.cpp
+//
+//	A pseudo terminal that answers the Serial API like a Z-Wave controller
+//	with a network of simple listening nodes behind it, for benchmarks.
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "ControllerStandIn.h"
+
+// Bytes a frame adds on the air around its payload, and the length of the
+// acknowledgement that answers it
+static uint32 const c_frameOverhead = 10;
+static uint32 const c_ackBytes = 10;
+
+//-----------------------------------------------------------------------------
+// <GetMilliseconds>
+// Milliseconds on a monotonic clock
+//-----------------------------------------------------------------------------
+double GetMilliseconds
+(
+)
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::ControllerStandIn>
+// Constructor
+//-----------------------------------------------------------------------------
+ControllerStandIn::ControllerStandIn
+(
+	uint32 const _homeId,
+	uint8 const _nodeCount,
+	uint8 const* _commandClasses,
+	uint8 const _commandClassCount
+):
+	m_nodeCount( _nodeCount ),
+	m_frameCount( 0 ),
+	m_getCount( 0 ),
+	m_homeId( _homeId ),
+	m_commandClasses( _commandClasses, _commandClasses + _commandClassCount ),
+	m_fd( -1 ),
+	m_slaveFd( -1 ),
+	m_exit( false ),
+	m_running( false ),
+	m_radioFree( 0 ),
+	m_bitRate( 9600 ),
+	m_nodeDelay( 5 )
+{
+	memset( m_level, 0, sizeof(m_level) );
+	m_wakeFds[0] = m_wakeFds[1] = -1;
+	pthread_mutex_init( &m_mutex, NULL );
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::~ControllerStandIn>
+// Destructor
+//-----------------------------------------------------------------------------
+ControllerStandIn::~ControllerStandIn
+(
+)
+{
+	Close();
+	pthread_mutex_destroy( &m_mutex );
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::Open>
+// Create the pseudo terminal and start answering on it
+//-----------------------------------------------------------------------------
+bool ControllerStandIn::Open
+(
+)
+{
+	m_fd = posix_openpt( O_RDWR | O_NOCTTY );
+	if( m_fd < 0 || grantpt( m_fd ) || unlockpt( m_fd ) )
+	{
+		return false;
+	}
+	m_path = ptsname( m_fd );
+
+	// Pass bytes through untouched, whatever the host does to the slave later
+	struct termios tios;
+	tcgetattr( m_fd, &tios );
+	cfmakeraw( &tios );
+	tcsetattr( m_fd, TCSANOW, &tios );
+
+	m_slaveFd = open( m_path.c_str(), O_RDWR | O_NOCTTY );
+	if( m_slaveFd < 0 )
+	{
+		return false;
+	}
+
+	if( pipe( m_wakeFds ) )
+	{
+		return false;
+	}
+	fcntl( m_wakeFds[0], F_SETFL, O_NONBLOCK );
+	fcntl( m_wakeFds[1], F_SETFL, O_NONBLOCK );
+
+	m_exit = false;
+	m_running = ( 0 == pthread_create( &m_thread, NULL, ThreadEntryPoint, this ) );
+	return m_running;
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::Close>
+// Stop answering and remove the pseudo terminal
+//-----------------------------------------------------------------------------
+void ControllerStandIn::Close
+(
+)
+{
+	if( m_running )
+	{
+		m_exit = true;
+		pthread_join( m_thread, NULL );
+		m_running = false;
+	}
+	if( m_slaveFd >= 0 )
+	{
+		close( m_slaveFd );
+		m_slaveFd = -1;
+	}
+	if( m_fd >= 0 )
+	{
+		close( m_fd );
+		m_fd = -1;
+	}
+	if( m_wakeFds[0] >= 0 )
+	{
+		close( m_wakeFds[0] );
+		close( m_wakeFds[1] );
+		m_wakeFds[0] = m_wakeFds[1] = -1;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::SendCommand>
+// Report an application command from a node
+//-----------------------------------------------------------------------------
+void ControllerStandIn::SendCommand
+(
+	uint8 const _nodeId,
+	uint8 const* _data,
+	uint8 const _length
+)
+{
+	pthread_mutex_lock( &m_mutex );
+	QueueCommand( _nodeId, _data, _length );
+	pthread_mutex_unlock( &m_mutex );
+
+	// Wake the thread, in case the report is due before it would look again.
+	// A full pipe means it is waking anyway.
+	uint8 wake = 0;
+	if( write( m_wakeFds[1], &wake, 1 ) < 0 && EAGAIN != errno )
+	{
+		fprintf( stderr, "stand-in: cannot wake the thread\n" );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::ThreadEntryPoint>
+// Entry point of the thread answering the host
+//-----------------------------------------------------------------------------
+void* ControllerStandIn::ThreadEntryPoint
+(
+	void* _context
+)
+{
+	static_cast<ControllerStandIn*>( _context )->ThreadProc();
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::ThreadProc>
+// Read frames from the host and write out the answers as they fall due
+//-----------------------------------------------------------------------------
+void ControllerStandIn::ThreadProc
+(
+)
+{
+	while( !m_exit )
+	{
+		int timeout = 20;
+		pthread_mutex_lock( &m_mutex );
+		if( !m_output.empty() )
+		{
+			double wait = m_output.front().m_due - GetMilliseconds();
+			if( wait < timeout )
+			{
+				timeout = ( wait > 0 ) ? (int)wait + 1 : 0;
+			}
+		}
+		pthread_mutex_unlock( &m_mutex );
+
+		struct pollfd pfd[2];
+		pfd[0].fd = m_fd;
+		pfd[0].events = POLLIN;
+		pfd[0].revents = 0;
+		pfd[1].fd = m_wakeFds[0];
+		pfd[1].events = POLLIN;
+		pfd[1].revents = 0;
+		if( poll( pfd, 2, timeout ) > 0 && ( pfd[1].revents & POLLIN ) )
+		{
+			uint8 wake[64];
+			while( read( m_wakeFds[0], wake, sizeof(wake) ) > 0 )
+			{
+			}
+		}
+		if( pfd[0].revents & POLLIN )
+		{
+			uint8 buffer[256];
+			ssize_t count = read( m_fd, buffer, sizeof(buffer) );
+			if( count > 0 )
+			{
+				m_input.insert( m_input.end(), buffer, buffer + count );
+			}
+		}
+
+		// Pick the frames out of the input.  The host's ACK, NAK and CAN bytes
+		// need no answer.
+		while( !m_input.empty() )
+		{
+			if( SOF != m_input[0] )
+			{
+				m_input.erase( m_input.begin() );
+				continue;
+			}
+			if( m_input.size() < 2 || m_input.size() < (size_t)m_input[1] + 2 )
+			{
+				break;
+			}
+
+			uint32 length = m_input[1] + 2;
+			uint8 checksum = 0xff;
+			for( uint32 i=1; i<length-1; ++i )
+			{
+				checksum ^= m_input[i];
+			}
+			uint8 reply = ( checksum == m_input[length-1] ) ? ACK : NAK;
+			if( write( m_fd, &reply, 1 ) != 1 )
+			{
+				fprintf( stderr, "stand-in: cannot write to %s\n", m_path.c_str() );
+			}
+			if( ACK == reply )
+			{
+				pthread_mutex_lock( &m_mutex );
+				HandleFrame( &m_input[2], length - 3 );
+				pthread_mutex_unlock( &m_mutex );
+			}
+			m_input.erase( m_input.begin(), m_input.begin() + length );
+		}
+
+		WriteDue();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::HandleFrame>
+// Answer a frame from the host.  _data starts at the frame type.
+//-----------------------------------------------------------------------------
+void ControllerStandIn::HandleFrame
+(
+	uint8 const* _data,
+	uint32 const _length
+)
+{
+	if( _length < 2 || REQUEST != _data[0] )
+	{
+		return;
+	}
+
+	uint8 reply[64];
+	uint8 function = _data[1];
+	reply[0] = function;
+	switch( function )
+	{
+		case FUNC_ID_ZW_GET_VERSION:
+		{
+			static char const version[] = "Z-Wave 3.95";
+			memcpy( &reply[1], version, sizeof(version) );
+			reply[1+sizeof(version)] = 0x01;			// Static controller library
+			Respond( reply, 2 + sizeof(version) );
+			break;
+		}
+		case FUNC_ID_ZW_MEMORY_GET_ID:
+		{
+			reply[1] = (uint8)( m_homeId >> 24 );
+			reply[2] = (uint8)( m_homeId >> 16 );
+			reply[3] = (uint8)( m_homeId >> 8 );
+			reply[4] = (uint8)m_homeId;
+			reply[5] = 1;
+			Respond( reply, 6 );
+			break;
+		}
+		case FUNC_ID_ZW_GET_CONTROLLER_CAPABILITIES:
+		{
+			reply[1] = 0;								// Primary controller, no SIS
+			Respond( reply, 2 );
+			break;
+		}
+		case FUNC_ID_SERIAL_API_GET_CAPABILITIES:
+		{
+			static uint8 const ids[] = { 0x01, 0x00, 0x00, 0x86, 0x00, 0x01, 0x00, 0x5a };
+			memcpy( &reply[1], ids, sizeof(ids) );
+			memset( &reply[1+sizeof(ids)], 0, 32 );		// No optional functions
+			Respond( reply, 1 + sizeof(ids) + 32 );
+			break;
+		}
+		case FUNC_ID_ZW_GET_SUC_NODE_ID:
+		{
+			reply[1] = 1;								// We are the SUC, so the host leaves it alone
+			Respond( reply, 2 );
+			break;
+		}
+		case FUNC_ID_SERIAL_API_GET_INIT_DATA:
+		{
+			reply[1] = 0x05;
+			reply[2] = 0x08;
+			reply[3] = NUM_NODE_BITFIELD_BYTES;
+			memset( &reply[4], 0, NUM_NODE_BITFIELD_BYTES );
+			for( uint32 nodeId=1; nodeId<=(uint32)m_nodeCount+1; ++nodeId )
+			{
+				reply[4+((nodeId-1)>>3)] |= 1 << ((nodeId-1) & 7);
+			}
+			reply[4+NUM_NODE_BITFIELD_BYTES] = 0x03;
+			reply[5+NUM_NODE_BITFIELD_BYTES] = 0x01;
+			Respond( reply, 6 + NUM_NODE_BITFIELD_BYTES );
+			break;
+		}
+		case FUNC_ID_SERIAL_API_SET_TIMEOUTS:
+		{
+			reply[1] = ACK_TIMEOUT / 10;
+			reply[2] = BYTE_TIMEOUT / 10;
+			Respond( reply, 3 );
+			break;
+		}
+		case FUNC_ID_SERIAL_API_APPL_NODE_INFORMATION:
+		{
+			// No reply
+			break;
+		}
+		case FUNC_ID_ZW_GET_NODE_PROTOCOL_INFO:
+		{
+			uint8 nodeId = ( _length > 2 ) ? _data[2] : 0;
+			memset( &reply[1], 0, 6 );
+			if( 1 == nodeId )
+			{
+				reply[1] = 0x80 | 0x40 | 0x10 | 0x02;	// Listening, routing, 40k
+				reply[4] = 0x02;						// Static controller
+				reply[5] = 0x02;
+				reply[6] = 0x01;
+			}
+			else if( nodeId > 1 && nodeId <= m_nodeCount + 1 )
+			{
+				reply[1] = 0x80 | 0x40 | 0x10 | 0x02;
+				reply[4] = 0x04;						// Routing slave
+				reply[5] = 0x10;						// Binary switch
+				reply[6] = 0x01;
+			}
+			Respond( reply, 7 );
+			break;
+		}
+		case FUNC_ID_ZW_REQUEST_NODE_INFO:
+		{
+			uint8 nodeId = ( _length > 2 ) ? _data[2] : 0;
+			reply[1] = 1;
+			Respond( reply, 2 );
+
+			uint8 update[64];
+			uint8 count = (uint8)m_commandClasses.size();
+			update[0] = FUNC_ID_ZW_APPLICATION_UPDATE;
+			update[1] = UPDATE_STATE_NODE_INFO_RECEIVED;
+			update[2] = nodeId;
+			update[3] = 3 + count;
+			update[4] = 0x04;
+			update[5] = 0x10;
+			update[6] = 0x01;
+			memcpy( &update[7], &m_commandClasses[0], count );
+			QueueRadio( m_nodeDelay, c_frameOverhead * 2 + 3 + count, update, 7 + count );
+			break;
+		}
+		case FUNC_ID_ZW_GET_ROUTING_INFO:
+		{
+			// Every node hears every other
+			memset( &reply[1], 0, NUM_NODE_BITFIELD_BYTES );
+			for( uint32 nodeId=1; nodeId<=(uint32)m_nodeCount+1; ++nodeId )
+			{
+				if( nodeId != _data[2] )
+				{
+					reply[1+((nodeId-1)>>3)] |= 1 << ((nodeId-1) & 7);
+				}
+			}
+			Respond( reply, 1 + NUM_NODE_BITFIELD_BYTES );
+			break;
+		}
+		case FUNC_ID_ZW_SEND_DATA:
+		{
+			HandleSendData( _data, _length );
+			break;
+		}
+		default:
+		{
+			fprintf( stderr, "stand-in: no answer for function 0x%.2x\n", function );
+			reply[1] = 0;
+			Respond( reply, 2 );
+			break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::HandleSendData>
+// Carry a command to a node, and report the transmission back to the host
+//-----------------------------------------------------------------------------
+void ControllerStandIn::HandleSendData
+(
+	uint8 const* _data,
+	uint32 const _length
+)
+{
+	// REQUEST, FUNC_ID_ZW_SEND_DATA, node, length, command..., options, callback id
+	if( _length < 6 || _length < (uint32)_data[3] + 6 )
+	{
+		return;
+	}
+	uint8 nodeId = _data[2];
+	uint8 length = _data[3];
+	uint8 callbackId = _data[_length-1];
+
+	uint8 reply[3];
+	reply[0] = FUNC_ID_ZW_SEND_DATA;
+	reply[1] = 1;
+	Respond( reply, 2 );
+
+	bool known = ( nodeId > 1 && nodeId <= m_nodeCount + 1 );
+	reply[1] = callbackId;
+	reply[2] = known ? TRANSMIT_COMPLETE_OK : TRANSMIT_COMPLETE_NO_ACK;
+	QueueRadio( 0, c_frameOverhead + length + c_ackBytes, reply, 3 );
+	++m_frameCount;
+
+	if( known && length > 0 )
+	{
+		HandleCommand( nodeId, &_data[4], length );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::HandleCommand>
+// Act on an application command sent to a node
+//-----------------------------------------------------------------------------
+void ControllerStandIn::HandleCommand
+(
+	uint8 const _nodeId,
+	uint8 const* _data,
+	uint8 const _length
+)
+{
+	uint8 commandClass = _data[0];
+	if( 0x27 == commandClass && _length >= 2 && 0x02 == _data[1] )
+	{
+		// Switch All Get, which the device class brings in
+		uint8 report[3] = { 0x27, 0x03, 0xff };
+		QueueCommand( _nodeId, report, 3 );
+		return;
+	}
+	if( ( 0x20 != commandClass && 0x25 != commandClass && 0x26 != commandClass ) || _length < 2 )
+	{
+		return;
+	}
+
+	if( 0x01 == _data[1] && _length >= 3 )
+	{
+		// Set
+		m_level[_nodeId] = _data[2];
+	}
+	else if( 0x02 == _data[1] )
+	{
+		// Get
+		++m_getCount;
+		uint8 report[3];
+		report[0] = commandClass;
+		report[1] = 0x03;
+		report[2] = ( 0x25 == commandClass && m_level[_nodeId] ) ? 0xff : m_level[_nodeId];
+		QueueCommand( _nodeId, report, 3 );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::QueueCommand>
+// Queue an application command from a node
+//-----------------------------------------------------------------------------
+void ControllerStandIn::QueueCommand
+(
+	uint8 const _nodeId,
+	uint8 const* _data,
+	uint8 const _length
+)
+{
+	uint8 frame[256];
+	frame[0] = FUNC_ID_APPLICATION_COMMAND_HANDLER;
+	frame[1] = 0;						// Receive status
+	frame[2] = _nodeId;
+	frame[3] = _length;
+	memcpy( &frame[4], _data, _length );
+	QueueRadio( m_nodeDelay, c_frameOverhead + _length + c_ackBytes, frame, 4 + _length );
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::Respond>
+// Queue a response from the controller itself, which goes out at once
+//-----------------------------------------------------------------------------
+void ControllerStandIn::Respond
+(
+	uint8 const* _data,
+	uint8 const _length
+)
+{
+	QueueFrame( 0, RESPONSE, _data, _length );
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::QueueRadio>
+// Queue a frame that follows a radio transmission of _airBytes, which starts
+// _delay ms from now or when the radio is free, whichever is later
+//-----------------------------------------------------------------------------
+void ControllerStandIn::QueueRadio
+(
+	double const _delay,
+	uint32 const _airBytes,
+	uint8 const* _data,
+	uint8 const _length
+)
+{
+	double start = GetMilliseconds() + _delay;
+	if( start < m_radioFree )
+	{
+		start = m_radioFree;
+	}
+	m_radioFree = start + _airBytes * 8 * 1000.0 / m_bitRate;
+	QueueFrame( m_radioFree, REQUEST, _data, _length );
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::QueueFrame>
+// Queue a frame to the host, in order of when it is due
+//-----------------------------------------------------------------------------
+void ControllerStandIn::QueueFrame
+(
+	double const _due,
+	uint8 const _type,
+	uint8 const* _data,
+	uint8 const _length
+)
+{
+	Output output;
+	output.m_due = _due;
+	output.m_frame.resize( _length + 4 );
+	output.m_frame[0] = SOF;
+	output.m_frame[1] = _length + 2;
+	output.m_frame[2] = _type;
+	memcpy( &output.m_frame[3], _data, _length );
+	uint8 checksum = 0xff;
+	for( uint32 i=1; i<(uint32)_length+3; ++i )
+	{
+		checksum ^= output.m_frame[i];
+	}
+	output.m_frame[_length+3] = checksum;
+
+	deque<Output>::iterator it = m_output.begin();
+	while( it != m_output.end() && it->m_due <= _due )
+	{
+		++it;
+	}
+	m_output.insert( it, output );
+}
+
+//-----------------------------------------------------------------------------
+// <ControllerStandIn::WriteDue>
+// Write the frames that have fallen due to the host
+//-----------------------------------------------------------------------------
+void ControllerStandIn::WriteDue
+(
+)
+{
+	double now = GetMilliseconds();
+	pthread_mutex_lock( &m_mutex );
+	while( !m_output.empty() && m_output.front().m_due <= now )
+	{
+		vector<uint8> const& frame = m_output.front().m_frame;
+		if( write( m_fd, &frame[0], frame.size() ) != (ssize_t)frame.size() )
+		{
+			fprintf( stderr, "stand-in: cannot write to %s\n", m_path.c_str() );
+		}
+		m_output.pop_front();
+	}
+	pthread_mutex_unlock( &m_mutex );
+}
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+//
+//	ControllerStandIn.h
+//
+//	A pseudo terminal that answers the Serial API like a Z-Wave controller
+//	with a network of simple listening nodes behind it, for benchmarks.
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _ControllerStandIn_H
+#define _ControllerStandIn_H
+
+#include <pthread.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "Defs.h"
+
+using namespace std;
+using namespace OpenZWave;
+
+// Milliseconds on a monotonic clock
+extern double GetMilliseconds();
+
+// The stand-in plays a static controller (node 1) and _nodeCount routing
+// slaves (nodes 2 onwards) that all support the same command classes.  Frames
+// to and from the nodes take the time they would on a radio of the given bit
+// rate, one at a time, so the host sees realistic transaction times.
+class ControllerStandIn
+{
+public:
+	ControllerStandIn( uint32 const _homeId, uint8 const _nodeCount, uint8 const* _commandClasses, uint8 const _commandClassCount );
+	virtual ~ControllerStandIn();
+
+	bool Open();													// Create the pseudo terminal and start answering on it
+	void Close();
+	string const& GetPath()const{ return m_path; }					// The device to hand to Manager::AddDriver
+
+	void SetBitRate( uint32 const _bitRate ){ m_bitRate = _bitRate; }	// Radio speed, 9600 by default
+	void SetNodeDelay( uint32 const _ms ){ m_nodeDelay = _ms; }		// Time a node takes to answer, 5ms by default
+
+	uint32 GetFrameCount()const{ return m_frameCount; }				// Frames sent to nodes
+	uint32 GetGetCount()const{ return m_getCount; }					// Gets among them
+
+	// Report an application command from a node, as if the node sent it unsolicited
+	void SendCommand( uint8 const _nodeId, uint8 const* _data, uint8 const _length );
+
+protected:
+	// Called on the stand-in thread, with m_mutex held, for every application
+	// command sent to a node.  The default handles Sets and Gets of the Basic,
+	// Binary Switch and Multilevel Switch command classes, and Switch All Gets.
+	virtual void HandleCommand( uint8 const _nodeId, uint8 const* _data, uint8 const _length );
+
+	// Queue an application command from a node once the radio is free.  Caller must hold m_mutex.
+	void QueueCommand( uint8 const _nodeId, uint8 const* _data, uint8 const _length );
+
+	uint8					m_nodeCount;
+	uint8					m_level[256];						// Switch level of each node
+	uint32 volatile			m_frameCount;
+	uint32 volatile			m_getCount;
+	pthread_mutex_t			m_mutex;							// Guards the output queue
+
+private:
+	struct Output
+	{
+		double				m_due;
+		vector<uint8>		m_frame;
+	};
+
+	static void* ThreadEntryPoint( void* _context );
+	void ThreadProc();
+	void HandleFrame( uint8 const* _data, uint32 const _length );
+	void HandleSendData( uint8 const* _data, uint32 const _length );
+	void Respond( uint8 const* _data, uint8 const _length );
+	void QueueRadio( double const _delay, uint32 const _airBytes, uint8 const* _data, uint8 const _length );
+	void QueueFrame( double const _due, uint8 const _type, uint8 const* _data, uint8 const _length );
+	void WriteDue();
+
+	uint32					m_homeId;
+	vector<uint8>			m_commandClasses;
+	string					m_path;
+	int						m_fd;
+	int						m_slaveFd;							// Held open so the master never sees a hang-up
+	int						m_wakeFds[2];						// A pipe that SendCommand wakes the thread with
+	bool volatile			m_exit;
+	bool					m_running;
+	pthread_t				m_thread;
+	deque<Output>			m_output;
+	vector<uint8>			m_input;
+	double					m_radioFree;						// When the radio is next free, in ms
+	uint32					m_bitRate;
+	uint32					m_nodeDelay;
+};
+
+#endif
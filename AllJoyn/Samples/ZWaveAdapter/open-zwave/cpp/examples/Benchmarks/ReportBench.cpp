@@ -0,0 +1,339 @@
+//-----------------------------------------------------------------------------
+//
+//	ReportBench.cpp
+//
+//	Measures how fast the driver turns unsolicited reports into value
+//	updates, while an application thread keeps reading the values.
+//
+//	A ControllerStandIn plays the controller and a network of multilevel
+//	sensors on a fast radio.  Once the nodes are queried, every node reports
+//	a number of sensor types, so each has that many values, and then rounds
+//	of reports of every sensor on every node are sent as fast as the driver
+//	takes them.  The rounds are sent twice, the second time with another
+//	thread reading the sensor values through the Manager throughout.
+//	Reports per second, the processor time each took, and reads per second
+//	are printed.
+//
+//	Usage: ReportBench [rounds] [nodes] [sensors per node]
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <vector>
+#include "Options.h"
+#include "Manager.h"
+#include "Notification.h"
+#include "platform/Log.h"
+#include "ControllerStandIn.h"
+
+using namespace OpenZWave;
+
+static uint32 const c_homeId = 0xc0ffee01;
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool volatile g_queried = false;
+static bool volatile g_reading = false;
+static vector<ValueID> g_sensors;						// Every multilevel sensor value
+static uint32 volatile g_refreshed = 0;					// Sensor values changed or refreshed by a report
+static uint32 volatile g_reads = 0;
+
+//-----------------------------------------------------------------------------
+// <SensorNetwork>
+// The stand-in network, which also answers the sensor Gets of the query
+//-----------------------------------------------------------------------------
+class SensorNetwork : public ControllerStandIn
+{
+public:
+	SensorNetwork( uint8 const _nodeCount, uint8 const* _commandClasses, uint8 const _commandClassCount ):
+		ControllerStandIn( c_homeId, _nodeCount, _commandClasses, _commandClassCount )
+	{
+	}
+
+	// Report a reading of one sensor type, as a node does when it changes
+	void Report( uint8 const _nodeId, uint8 const _sensorType, uint8 const _reading )
+	{
+		uint8 report[5] = { 0x31, 0x05, _sensorType, 0x01, _reading };
+		SendCommand( _nodeId, report, 5 );
+	}
+
+protected:
+	virtual void HandleCommand( uint8 const _nodeId, uint8 const* _data, uint8 const _length )
+	{
+		if( _length >= 2 && 0x31 == _data[0] && 0x04 == _data[1] )
+		{
+			uint8 report[5] = { 0x31, 0x05, 0x01, 0x01, 20 };
+			QueueCommand( _nodeId, report, 5 );
+			return;
+		}
+		ControllerStandIn::HandleCommand( _nodeId, _data, _length );
+	}
+};
+
+//-----------------------------------------------------------------------------
+// <OnNotification>
+// Collect the sensor values and count their refreshes
+//-----------------------------------------------------------------------------
+void OnNotification
+(
+	Notification const* _notification,
+	void* _context
+)
+{
+	switch( _notification->GetType() )
+	{
+		case Notification::Type_ValueAdded:
+		{
+			ValueID const& valueId = _notification->GetValueID();
+			if( 0x31 == valueId.GetCommandClassId() )
+			{
+				pthread_mutex_lock( &g_mutex );
+				g_sensors.push_back( valueId );
+				pthread_mutex_unlock( &g_mutex );
+			}
+			break;
+		}
+		case Notification::Type_ValueChanged:
+		case Notification::Type_ValueRefreshed:
+		{
+			if( 0x31 == _notification->GetValueID().GetCommandClassId() )
+			{
+				++g_refreshed;
+			}
+			break;
+		}
+		case Notification::Type_AwakeNodesQueried:
+		case Notification::Type_AllNodesQueried:
+		case Notification::Type_AllNodesQueriedSomeDead:
+		{
+			g_queried = true;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <ReaderThread>
+// Read the sensor values through the Manager, as a dashboard would
+//-----------------------------------------------------------------------------
+void* ReaderThread
+(
+	void* _context
+)
+{
+	pthread_mutex_lock( &g_mutex );
+	vector<ValueID> sensors = g_sensors;
+	pthread_mutex_unlock( &g_mutex );
+
+	string reading;
+	while( g_reading )
+	{
+		for( size_t i=0; i<sensors.size() && g_reading; ++i )
+		{
+			Manager::Get()->GetValueAsString( sensors[i], &reading );
+			++g_reads;
+		}
+	}
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// <WaitForRefreshes>
+// Wait until the driver has handled the given number of reports
+//-----------------------------------------------------------------------------
+bool WaitForRefreshes
+(
+	uint32 const _count
+)
+{
+	double start = GetMilliseconds();
+	while( g_refreshed < _count )
+	{
+		if( GetMilliseconds() - start > 30000 )
+		{
+			return false;
+		}
+		usleep( 100 );
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// <RunRounds>
+// Send rounds of reports of every sensor on every node, and return how many
+// milliseconds the driver took to handle them, or a negative number if some
+// were lost
+//-----------------------------------------------------------------------------
+double RunRounds
+(
+	SensorNetwork& _network,
+	int const _rounds,
+	int const _nodes,
+	int const _sensors,
+	uint32& _expected
+)
+{
+	double start = GetMilliseconds();
+	for( int round=0; round<_rounds; ++round )
+	{
+		for( int nodeId=2; nodeId<_nodes+2; ++nodeId )
+		{
+			for( int type=1; type<=_sensors; ++type )
+			{
+				_network.Report( (uint8)nodeId, (uint8)type, (uint8)( round + type ) );
+				++_expected;
+			}
+			if( !WaitForRefreshes( _expected ) )
+			{
+				return -1;
+			}
+		}
+	}
+	return GetMilliseconds() - start;
+}
+
+//-----------------------------------------------------------------------------
+// <CpuMilliseconds>
+// Processor time used by all the threads of the process
+//-----------------------------------------------------------------------------
+double CpuMilliseconds
+(
+)
+{
+	struct rusage usage;
+	getrusage( RUSAGE_SELF, &usage );
+	return ( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * 1000.0 + ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ) / 1000.0;
+}
+
+int main
+(
+	int argc,
+	char* argv[]
+)
+{
+	int rounds = ( argc > 1 ) ? atoi( argv[1] ) : 50;
+	int nodes = ( argc > 2 ) ? atoi( argv[2] ) : 32;
+	int sensors = ( argc > 3 ) ? atoi( argv[3] ) : 16;
+	if( rounds <= 0 || nodes <= 0 || nodes > 200 || sensors <= 0 || sensors > 30 )
+	{
+		printf( "usage: %s [rounds] [nodes] [sensors per node]\n", argv[0] );
+		return 1;
+	}
+
+	static uint8 const commandClasses[] = { 0x25, 0x26, 0x31 };
+	SensorNetwork network( (uint8)nodes, commandClasses, sizeof(commandClasses) );
+	if( !network.Open() )
+	{
+		printf( "cannot create a pseudo terminal\n" );
+		return 1;
+	}
+
+	char userPath[] = "/tmp/ReportBench.XXXXXX";
+	if( !mkdtemp( userPath ) )
+	{
+		printf( "cannot create a user directory\n" );
+		return 1;
+	}
+	Options::Create( OZW_CONFIG_DIR, string( userPath ) + "/", "" );
+	Options::Get()->AddOptionBool( "Logging", false );
+	Options::Get()->AddOptionBool( "ConsoleOutput", false );
+	Options::Get()->AddOptionBool( "SaveConfiguration", false );
+	Options::Get()->Lock();
+
+	Manager::Create();
+	Manager::Get()->AddWatcher( OnNotification, NULL );
+	Manager::Get()->AddDriver( network.GetPath() );
+
+	double start = GetMilliseconds();
+	while( !g_queried && GetMilliseconds() - start < 120000 )
+	{
+		usleep( 10000 );
+	}
+	if( !g_queried )
+	{
+		printf( "the nodes were not queried within two minutes\n" );
+		return 1;
+	}
+	printf( "%d nodes queried in %.0f ms\n", nodes, GetMilliseconds() - start );
+
+	// Reports now come in as fast as the host takes them
+	network.SetBitRate( 10000000 );
+	network.SetNodeDelay( 0 );
+
+	// Every node reports each of its sensor types once, which creates the
+	// values.  A node's reports go together, and the next node's wait for
+	// them, as the driver's serial buffer holds only so many.
+	uint32 expected = g_refreshed;
+	for( int nodeId=2; nodeId<nodes+2; ++nodeId )
+	{
+		for( int type=1; type<=sensors; ++type )
+		{
+			network.Report( (uint8)nodeId, (uint8)type, 0 );
+			++expected;
+		}
+		if( !WaitForRefreshes( expected ) )
+		{
+			printf( "the sensor values were not created\n" );
+			return 1;
+		}
+	}
+	printf( "%u sensor values\n", (uint32)g_sensors.size() );
+
+	uint32 reports = (uint32)rounds * nodes * sensors;
+	double cpu = CpuMilliseconds();
+	double elapsed = RunRounds( network, rounds, nodes, sensors, expected );
+	cpu = CpuMilliseconds() - cpu;
+	if( elapsed < 0 )
+	{
+		printf( "reports were lost\n" );
+		return 1;
+	}
+	printf( "%u reports in %.0f ms, %.0f reports/s, %.1f us of processor time each\n", reports, elapsed, reports * 1000.0 / elapsed, cpu * 1000.0 / reports );
+
+	// Again, with the values being read all the while
+	g_reading = true;
+	pthread_t reader;
+	pthread_create( &reader, NULL, ReaderThread, NULL );
+	uint32 reads = g_reads;
+	elapsed = RunRounds( network, rounds, nodes, sensors, expected );
+	reads = g_reads - reads;
+	g_reading = false;
+	pthread_join( reader, NULL );
+	if( elapsed < 0 )
+	{
+		printf( "reports were lost\n" );
+		return 1;
+	}
+	printf( "with a reader: %.0f reports/s, %.0f reads/s\n", reports * 1000.0 / elapsed, reads * 1000.0 / elapsed );
+
+	Manager::Get()->RemoveDriver( network.GetPath() );
+	Manager::Get()->RemoveWatcher( OnNotification, NULL );
+	Manager::Destroy();
+	Options::Destroy();
+	network.Close();
+	rmdir( userPath );
+	return 0;
+}
@@ -0,0 +1,447 @@
+//-----------------------------------------------------------------------------
+//
+//	SecurityBench.cpp
+//
+//	Measures how fast runs of S0 encrypted commands get through to nodes.
+//
+//	A ControllerStandIn plays the controller and a network of switches on a
+//	9.6 kbaud radio.  The nodes speak Security Command Class version 1: the
+//	binary switch is only reachable encrypted, each node hands out one nonce
+//	at a time and checks the MAC of everything it receives.  Once the nodes
+//	are queried, a scene sets every switch a few times over, and the time
+//	the scene takes to arrive, the frames it costs and any rejected
+//	messages are reported.
+//
+//	Usage: SecurityBench [scenes] [nodes] [sets per node]
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <list>
+#include "Options.h"
+#include "Manager.h"
+#include "Notification.h"
+#include "platform/Log.h"
+#include "aes/aes.h"
+#include "ControllerStandIn.h"
+
+using namespace OpenZWave;
+
+static uint32 const c_homeId = 0xc0ffee02;
+static uint8 const c_networkKey[16] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10 };
+static char const* c_networkKeyOption = "0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10";
+static double const c_nonceTimer = 10000;				// How long a node keeps the nonce it handed out
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool volatile g_queried = false;
+static list<ValueID> g_switches;						// The binary switch of each node
+static uint32 volatile g_delivered = 0;					// Secure Sets that reached their node
+static double volatile g_lastDelivery = 0;
+
+//-----------------------------------------------------------------------------
+// <SecureNetwork>
+// The stand-in network, with nodes that only take the binary switch encrypted
+//-----------------------------------------------------------------------------
+class SecureNetwork : public ControllerStandIn
+{
+public:
+	SecureNetwork( uint8 const _nodeCount, uint8 const* _commandClasses, uint8 const _commandClassCount ):
+		ControllerStandIn( c_homeId, _nodeCount, _commandClasses, _commandClassCount ),
+		m_rejected( 0 )
+	{
+		aes_init();
+		DeriveKey( 0xaa, &m_encryptKey );
+		DeriveKey( 0x55, &m_authKey );
+		memset( m_nonceDue, 0, sizeof(m_nonceDue) );
+		memset( m_waitingForNonce, 0, sizeof(m_waitingForNonce) );
+	}
+
+	uint32 GetRejectedCount()const{ return m_rejected; }	// Encrypted messages that failed their nonce or MAC check
+
+protected:
+	virtual void HandleCommand( uint8 const _nodeId, uint8 const* _data, uint8 const _length )
+	{
+		if( 0x98 != _data[0] || _length < 2 )
+		{
+			ControllerStandIn::HandleCommand( _nodeId, _data, _length );
+			return;
+		}
+
+		switch( _data[1] )
+		{
+			case 0x40:
+			{
+				// Nonce Get
+				SendNonce( _nodeId );
+				break;
+			}
+			case 0x80:
+			{
+				// Nonce Report, for the reply this node has waiting
+				if( _length >= 10 && m_waitingForNonce[_nodeId] && !m_replies[_nodeId].empty() )
+				{
+					m_waitingForNonce[_nodeId] = false;
+					vector<uint8> reply = m_replies[_nodeId].front();
+					m_replies[_nodeId].pop_front();
+					SendEncrypted( _nodeId, &_data[2], &reply[0], (uint8)reply.size() );
+					if( !m_replies[_nodeId].empty() )
+					{
+						RequestNonce( _nodeId );
+					}
+				}
+				break;
+			}
+			case 0x81:
+			case 0xc1:
+			{
+				// Message Encapsulation, and the same asking for the next nonce
+				uint8 plain[64];
+				uint8 plainLength;
+				bool valid = Decrypt( _nodeId, _data, _length, plain, &plainLength );
+				if( 0xc1 == _data[1] )
+				{
+					SendNonce( _nodeId );
+				}
+				if( !valid )
+				{
+					++m_rejected;
+					break;
+				}
+				HandleSecureCommand( _nodeId, &plain[1], plainLength - 1 );
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+	}
+
+private:
+	void HandleSecureCommand( uint8 const _nodeId, uint8 const* _data, uint8 const _length )
+	{
+		if( 0x98 == _data[0] && 0x02 == _data[1] )
+		{
+			// Security Commands Supported Get: the binary switch is secure only,
+			// and the mark keeps the byte the driver reads past the end harmless
+			uint8 report[5] = { 0x98, 0x03, 0x00, 0x25, 0xef };
+			QueueSecure( _nodeId, report, 5 );
+			return;
+		}
+		if( 0x25 != _data[0] || _length < 2 )
+		{
+			ControllerStandIn::HandleCommand( _nodeId, _data, _length );
+			return;
+		}
+		if( 0x01 == _data[1] && _length >= 3 )
+		{
+			m_level[_nodeId] = _data[2];
+			pthread_mutex_lock( &g_mutex );
+			++g_delivered;
+			g_lastDelivery = GetMilliseconds();
+			pthread_mutex_unlock( &g_mutex );
+		}
+		else if( 0x02 == _data[1] )
+		{
+			++m_getCount;
+			uint8 report[3] = { 0x25, 0x03, (uint8)( m_level[_nodeId] ? 0xff : 0x00 ) };
+			QueueSecure( _nodeId, report, 3 );
+		}
+	}
+
+	// The encryption and authentication keys are the network key's
+	// encryption of two fixed blocks
+	void DeriveKey( uint8 const _fill, aes_encrypt_ctx* _key )
+	{
+		aes_encrypt_ctx networkKey;
+		aes_encrypt_key128( c_networkKey, &networkKey );
+		uint8 block[16];
+		uint8 key[16];
+		memset( block, _fill, 16 );
+		aes_encrypt( block, key, &networkKey );
+		aes_encrypt_key128( key, _key );
+	}
+
+	// CBC-MAC of the command, the node ids, the length and the encrypted payload
+	void ComputeMac( uint8 const* _iv, uint8 const _command, uint8 const _from, uint8 const _to, uint8 const* _payload, uint8 const _length, uint8* _mac )
+	{
+		uint8 buffer[80];
+		memset( buffer, 0, sizeof(buffer) );
+		buffer[0] = _command;
+		buffer[1] = _from;
+		buffer[2] = _to;
+		buffer[3] = _length;
+		memcpy( &buffer[4], _payload, _length );
+
+		uint8 mac[16];
+		aes_encrypt( _iv, mac, &m_authKey );
+		for( uint32 i=0; i<4u+_length; i+=16 )
+		{
+			for( uint32 j=0; j<16; ++j )
+			{
+				mac[j] ^= buffer[i+j];
+			}
+			aes_encrypt( mac, mac, &m_authKey );
+		}
+		memcpy( _mac, mac, 8 );
+	}
+
+	void SendNonce( uint8 const _nodeId )
+	{
+		uint8 report[10] = { 0x98, 0x80 };
+		for( int i=0; i<8; ++i )
+		{
+			report[2+i] = (uint8)( rand() % 0xff + 1 );
+		}
+		memcpy( m_nonce[_nodeId], &report[2], 8 );
+		m_nonceDue[_nodeId] = GetMilliseconds() + c_nonceTimer;
+		QueueCommand( _nodeId, report, 10 );
+	}
+
+	void RequestNonce( uint8 const _nodeId )
+	{
+		uint8 get[2] = { 0x98, 0x40 };
+		m_waitingForNonce[_nodeId] = true;
+		QueueCommand( _nodeId, get, 2 );
+	}
+
+	// Encrypted replies wait for a nonce from the controller
+	void QueueSecure( uint8 const _nodeId, uint8 const* _data, uint8 const _length )
+	{
+		m_replies[_nodeId].push_back( vector<uint8>( _data, _data + _length ) );
+		if( !m_waitingForNonce[_nodeId] )
+		{
+			RequestNonce( _nodeId );
+		}
+	}
+
+	bool Decrypt( uint8 const _nodeId, uint8 const* _data, uint8 const _length, uint8* _plain, uint8* _plainLength )
+	{
+		// Security, command, 8 bytes of IV, payload, nonce id, 8 bytes of MAC
+		if( _length < 20 || _length - 19 > 48 )
+		{
+			return false;
+		}
+		uint8 payloadLength = _length - 19;
+		uint8 const* payload = &_data[10];
+
+		// Each nonce is good for one message, and only until it times out
+		bool fresh = ( m_nonceDue[_nodeId] > GetMilliseconds() ) && ( payload[payloadLength] == m_nonce[_nodeId][0] );
+		m_nonceDue[_nodeId] = 0;
+		if( !fresh )
+		{
+			return false;
+		}
+
+		uint8 iv[16];
+		memcpy( iv, &_data[2], 8 );
+		memcpy( &iv[8], m_nonce[_nodeId], 8 );
+		uint8 mac[8];
+		ComputeMac( iv, _data[1], 1, _nodeId, payload, payloadLength, mac );
+		if( memcmp( mac, &payload[payloadLength+1], 8 ) )
+		{
+			return false;
+		}
+
+		aes_mode_reset( &m_encryptKey );
+		aes_ofb_crypt( payload, _plain, payloadLength, iv, &m_encryptKey );
+		*_plainLength = payloadLength;
+		return payloadLength >= 3;
+	}
+
+	void SendEncrypted( uint8 const _nodeId, uint8 const* _nonce, uint8 const* _data, uint8 const _length )
+	{
+		uint8 frame[80];
+		uint8 plain[48];
+		plain[0] = 0;									// Not sequenced
+		memcpy( &plain[1], _data, _length );
+		uint8 payloadLength = _length + 1;
+
+		frame[0] = 0x98;
+		frame[1] = 0x81;
+		uint8 iv[16];
+		for( int i=0; i<8; ++i )
+		{
+			iv[i] = frame[2+i] = (uint8)rand();
+		}
+		memcpy( &iv[8], _nonce, 8 );
+		aes_mode_reset( &m_encryptKey );
+		aes_ofb_crypt( plain, &frame[10], payloadLength, iv, &m_encryptKey );
+
+		memcpy( &iv[8], _nonce, 8 );
+		memcpy( iv, &frame[2], 8 );
+		frame[10+payloadLength] = _nonce[0];
+		ComputeMac( iv, 0x81, _nodeId, 1, &frame[10], payloadLength, &frame[11+payloadLength] );
+		QueueCommand( _nodeId, frame, 19 + payloadLength );
+	}
+
+	aes_encrypt_ctx			m_encryptKey;
+	aes_encrypt_ctx			m_authKey;
+	uint8					m_nonce[256][8];				// The nonce each node last handed out
+	double					m_nonceDue[256];				// When it stops being good, or 0 once used
+	bool					m_waitingForNonce[256];
+	list< vector<uint8> >	m_replies[256];					// Encrypted replies waiting for a nonce
+	uint32 volatile			m_rejected;
+};
+
+//-----------------------------------------------------------------------------
+// <OnNotification>
+// Collect the switches, and note when the nodes have been queried
+//-----------------------------------------------------------------------------
+void OnNotification
+(
+	Notification const* _notification,
+	void* _context
+)
+{
+	switch( _notification->GetType() )
+	{
+		case Notification::Type_ValueAdded:
+		{
+			ValueID const& valueId = _notification->GetValueID();
+			if( ValueID::ValueGenre_User == valueId.GetGenre() && 0 == valueId.GetIndex() && 0x25 == valueId.GetCommandClassId() )
+			{
+				pthread_mutex_lock( &g_mutex );
+				g_switches.push_back( valueId );
+				pthread_mutex_unlock( &g_mutex );
+			}
+			break;
+		}
+		case Notification::Type_AwakeNodesQueried:
+		case Notification::Type_AllNodesQueried:
+		case Notification::Type_AllNodesQueriedSomeDead:
+		{
+			g_queried = true;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+int main
+(
+	int argc,
+	char* argv[]
+)
+{
+	int scenes = ( argc > 1 ) ? atoi( argv[1] ) : 5;
+	int nodes = ( argc > 2 ) ? atoi( argv[2] ) : 8;
+	int sets = ( argc > 3 ) ? atoi( argv[3] ) : 4;
+	if( scenes <= 0 || nodes <= 0 || nodes > 200 || sets <= 0 )
+	{
+		printf( "usage: %s [scenes] [nodes] [sets per node]\n", argv[0] );
+		return 1;
+	}
+
+	static uint8 const commandClasses[] = { 0x26, 0x98 };
+	SecureNetwork network( (uint8)nodes, commandClasses, sizeof(commandClasses) );
+	if( !network.Open() )
+	{
+		printf( "cannot create a pseudo terminal\n" );
+		return 1;
+	}
+
+	char userPath[] = "/tmp/SecurityBench.XXXXXX";
+	if( !mkdtemp( userPath ) )
+	{
+		printf( "cannot create a user directory\n" );
+		return 1;
+	}
+	Options::Create( OZW_CONFIG_DIR, string( userPath ) + "/", "" );
+	Options::Get()->AddOptionBool( "Logging", false );
+	Options::Get()->AddOptionBool( "ConsoleOutput", false );
+	Options::Get()->AddOptionBool( "SaveConfiguration", false );
+	Options::Get()->AddOptionString( "NetworkKey", c_networkKeyOption, false );
+	Options::Get()->Lock();
+
+	Manager::Create();
+	Manager::Get()->AddWatcher( OnNotification, NULL );
+	Manager::Get()->AddDriver( network.GetPath() );
+
+	double start = GetMilliseconds();
+	while( !g_queried && GetMilliseconds() - start < 120000 )
+	{
+		usleep( 10000 );
+	}
+	if( !g_queried )
+	{
+		printf( "the nodes were not queried within two minutes\n" );
+		return 1;
+	}
+	printf( "%d nodes queried in %.0f ms, %u secure switches\n", nodes, GetMilliseconds() - start, (uint32)g_switches.size() );
+	sleep( 1 );
+
+	vector<double> durations;
+	uint32 frames = network.GetFrameCount();
+	uint32 rejected = network.GetRejectedCount();
+	uint32 issued = 0;
+	uint32 delivered = g_delivered;
+	uint32 first = delivered;
+	for( int scene=0; scene<scenes; ++scene )
+	{
+		// Set every switch a few times over, as a scene with transitions would
+		start = GetMilliseconds();
+		uint32 target = delivered;
+		for( int i=0; i<sets; ++i )
+		{
+			for( list<ValueID>::iterator it = g_switches.begin(); it != g_switches.end(); ++it )
+			{
+				Manager::Get()->SetValue( *it, 0 == ( i + scene ) % 2 );
+				++target;
+				++issued;
+			}
+		}
+		while( g_delivered < target && GetMilliseconds() - start < 60000 )
+		{
+			usleep( 5000 );
+		}
+		pthread_mutex_lock( &g_mutex );
+		durations.push_back( g_lastDelivery - start );
+		delivered = g_delivered;
+		pthread_mutex_unlock( &g_mutex );
+		sleep( 1 );
+	}
+
+	double total = 0;
+	for( size_t i=0; i<durations.size(); ++i )
+	{
+		total += durations[i];
+	}
+	sort( durations.begin(), durations.end() );
+	uint32 sent = network.GetFrameCount() - frames;
+	printf( "%u secure sets, %u delivered, %u rejected\n", issued, delivered - first, network.GetRejectedCount() - rejected );
+	printf( "scene of %d sets: mean %.0f ms, worst %.0f ms, %.1f sets/s\n", nodes * sets, total / durations.size(), durations.back(), issued * 1000.0 / total );
+	printf( "%.2f frames to nodes per set\n", issued ? (double)sent / issued : 0.0 );
+
+	Manager::Get()->RemoveDriver( network.GetPath() );
+	Manager::Get()->RemoveWatcher( OnNotification, NULL );
+	Manager::Destroy();
+	Options::Destroy();
+	network.Close();
+	rmdir( userPath );
+	return 0;
+}
@@ -0,0 +1,258 @@
+//-----------------------------------------------------------------------------
+//
+//	SendQueueBench.cpp
+//
+//	Measures how long user commands wait in the driver's send queues while
+//	the network is busy with polls and value refreshes.
+//
+//	A ControllerStandIn plays the controller and a network of switches on a
+//	9.6 kbaud radio.  Once the nodes are queried, every value is polled
+//	back to back, every value is refreshed twice a second as a dashboard
+//	would, and one switch is toggled every 100ms.  The time from each
+//	Manager::SetValue call to the Set reaching its node is reported.
+//
+//	Usage: SendQueueBench [seconds] [nodes] [bit rate]
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <list>
+#include "Options.h"
+#include "Manager.h"
+#include "Notification.h"
+#include "platform/Log.h"
+#include "ControllerStandIn.h"
+
+using namespace OpenZWave;
+
+static uint32 const c_homeId = 0xc0ffee01;
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool volatile g_queried = false;
+static list<ValueID> g_values;							// Every polled value
+static list<ValueID> g_switches;						// The binary switch of each node
+static list<double> g_issued[256];						// When each Set still on its way to a node was issued
+static vector<double> g_latencies;
+
+//-----------------------------------------------------------------------------
+// <SwitchNetwork>
+// The stand-in network, which times the Sets as they arrive
+//-----------------------------------------------------------------------------
+class SwitchNetwork : public ControllerStandIn
+{
+public:
+	SwitchNetwork( uint8 const _nodeCount, uint8 const* _commandClasses, uint8 const _commandClassCount ):
+		ControllerStandIn( c_homeId, _nodeCount, _commandClasses, _commandClassCount )
+	{
+	}
+
+protected:
+	virtual void HandleCommand( uint8 const _nodeId, uint8 const* _data, uint8 const _length )
+	{
+		if( _length >= 3 && 0x25 == _data[0] && 0x01 == _data[1] )
+		{
+			pthread_mutex_lock( &g_mutex );
+			if( !g_issued[_nodeId].empty() )
+			{
+				g_latencies.push_back( GetMilliseconds() - g_issued[_nodeId].front() );
+				g_issued[_nodeId].pop_front();
+			}
+			pthread_mutex_unlock( &g_mutex );
+		}
+		ControllerStandIn::HandleCommand( _nodeId, _data, _length );
+	}
+};
+
+//-----------------------------------------------------------------------------
+// <OnNotification>
+// Collect the switch values, and note when the nodes have been queried
+//-----------------------------------------------------------------------------
+void OnNotification
+(
+	Notification const* _notification,
+	void* _context
+)
+{
+	switch( _notification->GetType() )
+	{
+		case Notification::Type_ValueAdded:
+		{
+			ValueID const& valueId = _notification->GetValueID();
+			if( ValueID::ValueGenre_User == valueId.GetGenre() && 0 == valueId.GetIndex()
+				&& ( 0x25 == valueId.GetCommandClassId() || 0x26 == valueId.GetCommandClassId() ) )
+			{
+				pthread_mutex_lock( &g_mutex );
+				g_values.push_back( valueId );
+				if( 0x25 == valueId.GetCommandClassId() )
+				{
+					g_switches.push_back( valueId );
+				}
+				pthread_mutex_unlock( &g_mutex );
+			}
+			break;
+		}
+		case Notification::Type_AwakeNodesQueried:
+		case Notification::Type_AllNodesQueried:
+		case Notification::Type_AllNodesQueriedSomeDead:
+		{
+			g_queried = true;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Percentile>
+// The latency below which the given fraction of the sorted samples fall
+//-----------------------------------------------------------------------------
+double Percentile
+(
+	vector<double> const& _sorted,
+	double const _fraction
+)
+{
+	if( _sorted.empty() )
+	{
+		return 0;
+	}
+	size_t index = (size_t)( _fraction * ( _sorted.size() - 1 ) + 0.5 );
+	return _sorted[index];
+}
+
+int main
+(
+	int argc,
+	char* argv[]
+)
+{
+	int seconds = ( argc > 1 ) ? atoi( argv[1] ) : 20;
+	int nodes = ( argc > 2 ) ? atoi( argv[2] ) : 16;
+	int bitRate = ( argc > 3 ) ? atoi( argv[3] ) : 9600;
+	if( seconds <= 0 || nodes <= 0 || nodes > 200 || bitRate <= 0 )
+	{
+		printf( "usage: %s [seconds] [nodes] [bit rate]\n", argv[0] );
+		return 1;
+	}
+
+	static uint8 const commandClasses[] = { 0x25, 0x26 };
+	SwitchNetwork network( (uint8)nodes, commandClasses, sizeof(commandClasses) );
+	network.SetBitRate( bitRate );
+	if( !network.Open() )
+	{
+		printf( "cannot create a pseudo terminal\n" );
+		return 1;
+	}
+
+	char userPath[] = "/tmp/SendQueueBench.XXXXXX";
+	if( !mkdtemp( userPath ) )
+	{
+		printf( "cannot create a user directory\n" );
+		return 1;
+	}
+	Options::Create( OZW_CONFIG_DIR, string( userPath ) + "/", "" );
+	Options::Get()->AddOptionBool( "Logging", false );
+	Options::Get()->AddOptionBool( "ConsoleOutput", false );
+	Options::Get()->AddOptionBool( "SaveConfiguration", false );
+	Options::Get()->AddOptionBool( "IntervalBetweenPolls", true );
+	Options::Get()->AddOptionInt( "PollInterval", 1 );
+	Options::Get()->Lock();
+
+	Manager::Create();
+	Manager::Get()->AddWatcher( OnNotification, NULL );
+	Manager::Get()->AddDriver( network.GetPath() );
+
+	double start = GetMilliseconds();
+	while( !g_queried && GetMilliseconds() - start < 120000 )
+	{
+		usleep( 10000 );
+	}
+	if( !g_queried )
+	{
+		printf( "the nodes were not queried within two minutes\n" );
+		return 1;
+	}
+	printf( "%d nodes queried in %.0f ms, %u values\n", nodes, GetMilliseconds() - start, (uint32)g_values.size() );
+
+	for( list<ValueID>::iterator it = g_values.begin(); it != g_values.end(); ++it )
+	{
+		Manager::Get()->EnablePoll( *it );
+	}
+
+	uint32 frames = network.GetFrameCount();
+	uint32 gets = network.GetGetCount();
+	uint32 commands = 0;
+	bool on = true;
+	list<ValueID>::iterator next = g_switches.begin();
+	start = GetMilliseconds();
+	for( int tick=0; GetMilliseconds() - start < seconds * 1000.0; ++tick )
+	{
+		if( 0 == tick % 5 )
+		{
+			// Dashboard refresh
+			for( list<ValueID>::iterator it = g_values.begin(); it != g_values.end(); ++it )
+			{
+				Manager::Get()->RefreshValue( *it );
+			}
+		}
+
+		pthread_mutex_lock( &g_mutex );
+		g_issued[next->GetNodeId()].push_back( GetMilliseconds() );
+		pthread_mutex_unlock( &g_mutex );
+		Manager::Get()->SetValue( *next, on );
+		++commands;
+		if( ++next == g_switches.end() )
+		{
+			next = g_switches.begin();
+			on = !on;
+		}
+		usleep( 100000 );
+	}
+	double elapsed = GetMilliseconds() - start;
+
+	pthread_mutex_lock( &g_mutex );
+	vector<double> latencies = g_latencies;
+	pthread_mutex_unlock( &g_mutex );
+	sort( latencies.begin(), latencies.end() );
+	double total = 0;
+	for( size_t i=0; i<latencies.size(); ++i )
+	{
+		total += latencies[i];
+	}
+
+	printf( "%u commands, %u delivered during the run\n", commands, (uint32)latencies.size() );
+	printf( "command latency ms: mean %.0f, median %.0f, 95th %.0f, max %.0f\n",
+		latencies.empty() ? 0 : total / latencies.size(), Percentile( latencies, 0.5 ), Percentile( latencies, 0.95 ), Percentile( latencies, 1.0 ) );
+	printf( "%.1f frames/s to nodes, %.1f Gets/s\n", ( network.GetFrameCount() - frames ) * 1000.0 / elapsed, ( network.GetGetCount() - gets ) * 1000.0 / elapsed );
+
+	Manager::Get()->RemoveDriver( network.GetPath() );
+	Manager::Get()->RemoveWatcher( OnNotification, NULL );
+	Manager::Destroy();
+	Options::Destroy();
+	network.Close();
+	rmdir( userPath );
+	return 0;
+}
@@ -214,6 +214,12 @@ namespace OpenZWave
 #define BYTE_TIMEOUT	150
 //#define RETRY_TIMEOUT	40000		// Retry send after 40 seconds
 #define RETRY_TIMEOUT	10000		// Retry send after 10 seconds (we might need to keep this below 10 for Security CC to function correctly)
+#define SEND_DEADLINE	2000		// Queued requests are due after 2 seconds
+#define QUERY_DEADLINE	30000		// Queued node queries are due after 30 seconds
+#define POLL_DEADLINE	60000		// Queued polls are due after 60 seconds
+#define NONCE_PREFETCH_WINDOW	3000		// How long a nonce a node sent ahead of need is used for (S0 nodes keep them at least 3 seconds)
+#define NONCE_PREFETCH_WAIT	1000		// How long to wait for a nonce a node was asked for ahead of need, before asking again
+#define SECURE_BATCH_SIZE	8		// Encrypted messages sent to a node in a row while it keeps a nonce ready
 
 #define SOF												0x01
 #define ACK												0x06
@@ -130,6 +130,10 @@ static char const* c_sendQueueNames[] =
 		"Poll"
 };
 
+// Queue deadlines are kept below this, and the epoch they are measured from
+// is moved on before the time since it exceeds it, so they cannot overflow.
+static int32 const c_maxQueueDeadline = 0x10000000;		// about three days
+
 
 //-----------------------------------------------------------------------------
 // <Driver::Driver>
@@ -178,6 +182,7 @@ m_SUCNodeId( 0 ),
 m_controllerResetEvent( NULL ),
 m_sendMutex( new Mutex() ),
 m_currentMsg( NULL ),
+m_sendTurn( 0 ),
 m_virtualNeighborsReceived( false ),
 m_notificationsEvent( new Event() ),
 m_SOFCnt( 0 ),
@@ -201,8 +206,15 @@ m_nondelivery( 0 ),
 m_routedbusy( 0 ),
 m_broadcastReadCnt( 0 ),
 m_broadcastWriteCnt( 0 ),
+AuthKey( NULL ),
+EncryptKey( NULL ),
 m_nonceReportSent( 0 ),
-m_nonceReportSentAttempt( 0 )
+m_nonceReportSentAttempt( 0 ),
+m_nonceWait( false ),
+m_noncePrefetchWait( false ),
+m_noncePrefetchNodeId( 0 ),
+m_noncePrefetchReceived( false ),
+m_noncePrefetchBatch( 0 )
 {
 	// set a timestamp to indicate when this driver started
 	TimeStamp m_startTime;
@@ -215,12 +227,13 @@ m_nonceReportSentAttempt( 0 )
 
 	// Clear the nodes array
 	memset( m_nodes, 0, sizeof(Node*) * 256 );
+	memset( m_nodeTurn, 0, sizeof(m_nodeTurn) );
 
 	// Clear the virtual neighbors array
 	memset( m_virtualNeighbors, 0, NUM_NODE_BITFIELD_BYTES );
 
 	// Initilize the Network Keys
-
+	m_keysDerived[0] = m_keysDerived[1] = false;
 	initNetworkKeys(false);
 
 	if( ControllerInterface_Hid == _interface )
@@ -236,6 +249,23 @@ m_nonceReportSentAttempt( 0 )
 	Options::Get()->GetOptionAsBool( "NotifyTransactions", &m_notifytransactions );
 	Options::Get()->GetOptionAsInt( "PollInterval", &m_pollInterval );
 	Options::Get()->GetOptionAsBool( "IntervalBetweenPolls", &m_bIntervalBetweenPolls );
+
+	// Items on the strictly prioritised queues are never due
+	memset( m_queueDeadline, 0, sizeof(m_queueDeadline) );
+	Options::Get()->GetOptionAsInt( "SendDeadline", &m_queueDeadline[MsgQueue_Send] );
+	Options::Get()->GetOptionAsInt( "QueryDeadline", &m_queueDeadline[MsgQueue_Query] );
+	Options::Get()->GetOptionAsInt( "PollDeadline", &m_queueDeadline[MsgQueue_Poll] );
+	for( int32 i=MsgQueue_Send; i<MsgQueue_Count; ++i )
+	{
+		if( m_queueDeadline[i] < 0 )
+		{
+			m_queueDeadline[i] = 0;
+		}
+		else if( m_queueDeadline[i] > c_maxQueueDeadline )
+		{
+			m_queueDeadline[i] = c_maxQueueDeadline;
+		}
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -428,6 +458,11 @@ void Driver::DriverThreadProc
 				{
 					count = 3;
 					timeout = m_waitingForAck ? ACK_TIMEOUT : retryTimeStamp.TimeRemaining();
+					if( m_noncePrefetchWait )
+					{
+						// Ask for the nonce again if the one already asked for is overdue
+						timeout = m_noncePrefetchExpiry.TimeRemaining();
+					}
 					if( timeout < 0 )
 					{
 						timeout = 0;
@@ -450,7 +485,7 @@ void Driver::DriverThreadProc
 					case -1:
 					{
 						// Wait has timed out - time to resend
-						if( m_currentMsg != NULL )
+						if( m_currentMsg != NULL && !m_noncePrefetchWait )
 						{
 							Notification* notification = new Notification( Notification::Type_Notification );
 							notification->SetHomeAndNodeIds( m_homeId, m_currentMsg->GetTargetNodeId() );
@@ -919,8 +954,7 @@ void Driver::SendQueryStageComplete
 		// Non-sleeping node
 		Log::Write( LogLevel_Detail, node->GetNodeId(), "Queuing (%s) Query Stage Complete (%s)", c_sendQueueNames[MsgQueue_Query], node->GetQueryStageName( _stage ).c_str() );
 		m_sendMutex->Lock();
-		m_msgQueue[MsgQueue_Query].push_back( item );
-		m_queueEvent[MsgQueue_Query]->Set();
+		PushQueueItem( item, MsgQueue_Query );
 		m_sendMutex->Unlock();
 
 	}
@@ -1015,13 +1049,245 @@ void Driver::SendMsg
 			}
 		}
 	}
-	Log::Write( LogLevel_Detail, GetNodeNumber( _msg ), "Queuing (%s) %s", c_sendQueueNames[_queue], _msg->GetAsString().c_str() );
 	m_sendMutex->Lock();
-	m_msgQueue[_queue].push_back( item );
-	m_queueEvent[_queue]->Set();
+	if( CoalesceMsg( _msg, _queue ) )
+	{
+		m_sendMutex->Unlock();
+		delete _msg;
+		return;
+	}
+	Log::Write( LogLevel_Detail, GetNodeNumber( _msg ), "Queuing (%s) %s", c_sendQueueNames[_queue], _msg->GetAsString().c_str() );
+	PushQueueItem( item, _queue );
 	m_sendMutex->Unlock();
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::MsgQueueItem::GetNodeId>
+// The node a queued item is for
+//-----------------------------------------------------------------------------
+uint8 Driver::MsgQueueItem::GetNodeId
+(
+)const
+{
+	if( MsgQueueCmd_SendMsg == m_command )
+	{
+		return m_msg->GetTargetNodeId();
+	}
+	return m_nodeId;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetQueueTime>
+// Milliseconds since the queue epoch
+//-----------------------------------------------------------------------------
+int32 Driver::GetQueueTime
+(
+)
+{
+	TimeStamp now;
+	int32 elapsed = now - m_queueEpoch;
+	if( elapsed > c_maxQueueDeadline )
+	{
+		// Move the epoch on, and the deadlines of the waiting items with it
+		for( int32 i=MsgQueue_Send; i<MsgQueue_Count; ++i )
+		{
+			for( list<MsgQueueItem>::iterator it = m_msgQueue[i].begin(); it != m_msgQueue[i].end(); ++it )
+			{
+				(*it).m_deadline -= elapsed;
+			}
+		}
+		m_queueEpoch.SetTime();
+		elapsed = 0;
+	}
+	return elapsed;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::PushQueueItem>
+// Append an item to a message queue
+//-----------------------------------------------------------------------------
+void Driver::PushQueueItem
+(
+		MsgQueueItem& _item,
+		MsgQueue const _queue
+)
+{
+	if( _queue >= MsgQueue_Send )
+	{
+		_item.m_deadline = GetQueueTime() + m_queueDeadline[_queue];
+	}
+	m_msgQueue[_queue].push_back( _item );
+	m_queueEvent[_queue]->Set();
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::CoalesceMsg>
+// Merge a Get with an equal one already waiting on the send or poll queue
+//-----------------------------------------------------------------------------
+bool Driver::CoalesceMsg
+(
+		Msg* _msg,
+		MsgQueue const _queue
+)
+{
+	// Only Gets can be merged, as one report answers any number of them.  Node
+	// queries are left alone, since each query stage completes in order behind
+	// its own requests.
+	if( ( MsgQueue_Send != _queue && MsgQueue_Poll != _queue )
+		|| FUNC_ID_APPLICATION_COMMAND_HANDLER != _msg->GetExpectedReply()
+		|| 0 == _msg->GetExpectedCommandClassId() )
+	{
+		return false;
+	}
+
+	MsgQueue const queues[] = { MsgQueue_Send, MsgQueue_Poll };
+	for( int32 i=0; i<2; ++i )
+	{
+		list<MsgQueueItem>& msgQueue = m_msgQueue[queues[i]];
+		for( list<MsgQueueItem>::iterator it = msgQueue.begin(); it != msgQueue.end(); ++it )
+		{
+			if( MsgQueueCmd_SendMsg != (*it).m_command || !( *(*it).m_msg == *_msg ) )
+			{
+				continue;
+			}
+
+			if( queues[i] <= _queue )
+			{
+				Log::Write( LogLevel_Detail, GetNodeNumber( _msg ), "Not queuing (%s) %s, already queued (%s)", c_sendQueueNames[_queue], _msg->GetAsString().c_str(), c_sendQueueNames[queues[i]] );
+				return true;
+			}
+
+			// The request is wanted sooner now, so take the poll off its queue
+			Log::Write( LogLevel_Detail, GetNodeNumber( _msg ), "Removing (%s) %s, now queued (%s)", c_sendQueueNames[queues[i]], (*it).m_msg->GetAsString().c_str(), c_sendQueueNames[_queue] );
+			delete (*it).m_msg;
+			msgQueue.erase( it );
+			if( msgQueue.empty() )
+			{
+				m_queueEvent[queues[i]]->Reset();
+			}
+			return false;
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetScheduledQueue>
+// Choose the queue to serve when a queue event has been signalled
+//-----------------------------------------------------------------------------
+Driver::MsgQueue Driver::GetScheduledQueue
+(
+		MsgQueue const _queue
+)
+{
+	if( _queue < MsgQueue_Send )
+	{
+		return _queue;
+	}
+
+	// Serve the queue whose oldest item is due first, preferring the
+	// higher priority queue when they are due together
+	int32 queue = -1;
+	for( int32 i=MsgQueue_Send; i<MsgQueue_Count; ++i )
+	{
+		if( !m_msgQueue[i].empty() && ( queue < 0 || m_msgQueue[i].front().m_deadline < m_msgQueue[queue].front().m_deadline ) )
+		{
+			queue = i;
+		}
+	}
+	return( queue < 0 ? _queue : (MsgQueue)queue );
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetScheduledItem>
+// Choose the next item to take from a queue, which may move _queue on to a
+// higher priority queue holding items the chosen one has to wait for
+//-----------------------------------------------------------------------------
+list<Driver::MsgQueueItem>::iterator Driver::GetScheduledItem
+(
+		MsgQueue& _queue
+)
+{
+	list<MsgQueueItem>::iterator next = m_msgQueue[_queue].begin();
+	if( _queue < MsgQueue_Send )
+	{
+		return next;
+	}
+
+	next = GetFairItem( _queue );
+
+	// A query stage completes only once the node's requests queued ahead of
+	// it have gone, as they did when the queues were served strictly in turn
+	if( MsgQueueCmd_QueryStageComplete == (*next).m_command )
+	{
+		for( int32 i=MsgQueue_Send; i<_queue; ++i )
+		{
+			for( list<MsgQueueItem>::iterator it = m_msgQueue[i].begin(); it != m_msgQueue[i].end(); ++it )
+			{
+				if( (*it).GetNodeId() == (*next).m_nodeId )
+				{
+					_queue = (MsgQueue)i;
+					return it;
+				}
+			}
+		}
+	}
+	return next;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetFairItem>
+// Choose the next item to take from a bulk queue, taking turns between nodes
+//-----------------------------------------------------------------------------
+list<Driver::MsgQueueItem>::iterator Driver::GetFairItem
+(
+		MsgQueue const _queue
+)
+{
+	// The queue was chosen for its oldest item, so once that is due it goes
+	// first, however many turns the other nodes are owed
+	list<MsgQueueItem>::iterator next = m_msgQueue[_queue].begin();
+	int32 now = GetQueueTime();
+	if( (*next).m_deadline <= now )
+	{
+		return next;
+	}
+
+	// While a node has sent the nonce for its next encrypted message, or is
+	// about to, stay with it for a few messages so the nonce is not wasted.
+	// Only the node's oldest item may go, and only if it is encrypted, so
+	// that its items still go in the order they were queued.
+	if( m_noncePrefetchNodeId != 0 && m_noncePrefetchBatch < SECURE_BATCH_SIZE && m_noncePrefetchExpiry.TimeRemaining() > 0 )
+	{
+		for( list<MsgQueueItem>::iterator it = next; it != m_msgQueue[_queue].end(); ++it )
+		{
+			if( m_noncePrefetchNodeId == (*it).GetNodeId() )
+			{
+				if( MsgQueueCmd_SendMsg == (*it).m_command && (*it).m_msg->isEncrypted() )
+				{
+					return it;
+				}
+				break;
+			}
+		}
+	}
+
+	// Take the oldest item for the node that was served longest ago, so that
+	// a node with many requests waiting cannot hold up the others.  Each
+	// node's own items still go in the order they were queued.
+	uint32 nextAge = 0;
+	for( list<MsgQueueItem>::iterator it = next; it != m_msgQueue[_queue].end(); ++it )
+	{
+		uint32 age = m_sendTurn - m_nodeTurn[(*it).GetNodeId()];
+		if( age > nextAge )
+		{
+			next = it;
+			nextAge = age;
+		}
+	}
+	return next;
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::WriteNextMsg>
 // Transmit a queued message to the Z-Wave controller
@@ -1032,19 +1298,36 @@ bool Driver::WriteNextMsg
 )
 {
 
-	// There are messages to send, so get the one at the front of the queue
+	// There are messages to send, so get the next one due
 	m_sendMutex->Lock();
-	MsgQueueItem item = m_msgQueue[_queue].front();
+	MsgQueue queue = GetScheduledQueue( _queue );
+	if( m_msgQueue[queue].empty() )
+	{
+		m_queueEvent[queue]->Reset();
+		m_sendMutex->Unlock();
+		return false;
+	}
+	list<MsgQueueItem>::iterator it = GetScheduledItem( queue );
+	MsgQueueItem item = *it;
+	if( queue >= MsgQueue_Send )
+	{
+		if( m_nodeTurn[item.GetNodeId()] != m_sendTurn )
+		{
+			// Another node's turn, so any run of encrypted messages is over
+			m_noncePrefetchBatch = 0;
+		}
+		m_nodeTurn[item.GetNodeId()] = ++m_sendTurn;
+	}
 
 	if( MsgQueueCmd_SendMsg == item.m_command )
 	{
 		// Send a message
 		m_currentMsg = item.m_msg;
-		m_currentMsgQueueSource = _queue;
-		m_msgQueue[_queue].pop_front();
-		if( m_msgQueue[_queue].empty() )
+		m_currentMsgQueueSource = queue;
+		m_msgQueue[queue].erase( it );
+		if( m_msgQueue[queue].empty() )
 		{
-			m_queueEvent[_queue]->Reset();
+			m_queueEvent[queue]->Reset();
 		}
 		m_sendMutex->Unlock();
 		return WriteMsg( "WriteNextMsg" );
@@ -1055,10 +1338,10 @@ bool Driver::WriteNextMsg
 		// Move to the next query stage
 		m_currentMsg = NULL;
 		Node::QueryStage stage = item.m_queryStage;
-		m_msgQueue[_queue].pop_front();
-		if( m_msgQueue[_queue].empty() )
+		m_msgQueue[queue].erase( it );
+		if( m_msgQueue[queue].empty() )
 		{
-			m_queueEvent[_queue]->Reset();
+			m_queueEvent[queue]->Reset();
 		}
 		m_sendMutex->Unlock();
 
@@ -1084,10 +1367,10 @@ bool Driver::WriteNextMsg
 		if ( m_currentControllerCommand->m_controllerCommandDone )
 		{
 			m_sendMutex->Lock();
-			m_msgQueue[_queue].pop_front();
-			if( m_msgQueue[_queue].empty() )
+			m_msgQueue[queue].pop_front();
+			if( m_msgQueue[queue].empty() )
 			{
-				m_queueEvent[_queue]->Reset();
+				m_queueEvent[queue]->Reset();
 			}
 			m_sendMutex->Unlock();
 			if( m_currentControllerCommand->m_controllerCallback )
@@ -1115,7 +1398,7 @@ bool Driver::WriteNextMsg
 		{
 			Log::Write( LogLevel_Info, "WriteNextMsg Controller nothing to do" );
 			m_sendMutex->Lock();
-			m_queueEvent[_queue]->Reset();
+			m_queueEvent[queue]->Reset();
 			m_sendMutex->Unlock();
 		}
 		return true;
@@ -1188,6 +1471,12 @@ bool Driver::WriteMsg
 		return false;
 	}
 
+	/* an encrypted message may not need to ask for a nonce, if its node sent one ahead of need */
+	bool noncePending = false;
+	if (m_nonceReportSent == 0 && m_currentMsg->isEncrypted() && !m_currentMsg->isNonceRecieved()) {
+		noncePending = UsePrefetchedNonce();
+	}
+
 	if (( attempts != 0) && (m_nonceReportSent == 0))
 	{
 		// this is not the first attempt, so increment the callback id before sending
@@ -1200,7 +1489,7 @@ bool Driver::WriteMsg
 	 */
 
 	if (m_nonceReportSent == 0) {
-		if (m_currentMsg->isEncrypted() && !m_currentMsg->isNonceRecieved()) {
+		if (m_currentMsg->isEncrypted() && !m_currentMsg->isNonceRecieved() && !noncePending) {
 			m_currentMsg->SetSendAttempts( ++attempts );
 		} else if (!m_currentMsg->isEncrypted() ) {
 			m_currentMsg->SetSendAttempts( ++attempts );
@@ -1233,6 +1522,13 @@ bool Driver::WriteMsg
 		if (m_currentMsg->isNonceRecieved()) {
 			Log::Write( LogLevel_Info, nodeId, "Processing (%s) Encrypted message (%sCallback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], attemptsstr.c_str(), m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str() );
 			SendEncryptedMessage();
+		} else if (noncePending) {
+			Log::Write( LogLevel_Info, nodeId, "Processing (%s) Encrypted message (%sCallback ID=0x%.2x, Expected Reply=0x%.2x) - Waiting for the Nonce_Report already asked for", c_sendQueueNames[m_currentMsgQueueSource], attemptsstr.c_str(), m_expectedCallbackId, m_expectedReply);
+			/* nothing has been written, so there is no ACK to wait for */
+			m_waitingForAck = false;
+			m_nonceWait = true;
+			m_noncePrefetchWait = true;
+			return true;
 		} else {
 			Log::Write( LogLevel_Info, nodeId, "Processing (%s) Nonce Request message (%sCallback ID=0x%.2x, Expected Reply=0x%.2x)", c_sendQueueNames[m_currentMsgQueueSource], attemptsstr.c_str(), m_expectedCallbackId, m_expectedReply);
 			SendNonceRequest(m_currentMsg->GetLogText());
@@ -1302,6 +1598,8 @@ void Driver::RemoveCurrentMsg
 	m_waitingForAck = false;
 	m_nonceReportSent = 0;
 	m_nonceReportSentAttempt = 0;
+	m_nonceWait = false;
+	m_noncePrefetchWait = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -1810,9 +2108,21 @@ void Driver::ProcessMsg
 		if (SecurityCmd_NonceReport == _data[6]) {
 			Log::Write(LogLevel_Info,  _data[3], "Received SecurityCmd_NonceReport from node %d", _data[3] );
 
-			// No Need to triger a WriteMsg here - It should be handled automatically
-			m_currentMsg->setNonce(&_data[7]);
-			this->SendEncryptedMessage();
+			if (m_nonceWait && m_currentMsg != NULL && m_currentMsg->GetTargetNodeId() == _data[3]) {
+				// No Need to triger a WriteMsg here - It should be handled automatically
+				if (m_noncePrefetchNodeId == _data[3]) {
+					m_noncePrefetchNodeId = 0;
+				}
+				m_currentMsg->setNonce(&_data[7]);
+				this->SendEncryptedMessage();
+			} else if (m_noncePrefetchNodeId == _data[3] && !m_noncePrefetchReceived) {
+				/* the node answered a MessageEncapNonceGet - keep the nonce for its next encrypted message */
+				memcpy(m_noncePrefetch, &_data[7], 8);
+				m_noncePrefetchReceived = true;
+				m_noncePrefetchExpiry.SetTime(NONCE_PREFETCH_WINDOW);
+			} else {
+				Log::Write(LogLevel_Warning, _data[3], "Nonce_Report from node %d was not asked for. Ignoring it", _data[3]);
+			}
 			return;
 
 			/* if this is a NONCE Get - Then call to the CC directly, process it, and then bail out. */
@@ -1839,6 +2149,7 @@ void Driver::ProcessMsg
 		} else if ((SecurityCmd_MessageEncap == _data[6]) || (SecurityCmd_MessageEncapNonceGet == _data[6])) {
 			uint8 _newdata[256];
 			uint8 *_nonce;
+			bool nonceGet = (SecurityCmd_MessageEncapNonceGet == _data[6]);
 
 			/* clear out NONCE Report tracking */
 			m_nonceReportSent = 0;
@@ -1871,7 +2182,7 @@ void Driver::ProcessMsg
 				//PrintHex("Decrypted Packet", _data, _data[4]+5);
 
 				/* if the Node has something else to send, it will encrypt a message and send it as a MessageEncapNonceGet */
-				if (SecurityCmd_MessageEncapNonceGet == _data[6])
+				if (nonceGet)
 				{
 					Log::Write(LogLevel_Info,  _data[3], "Received SecurityCmd_MessageEncapNonceGet from node %d - Sending New Nonce", _data[3] );
 					LockGuard LG(m_nodeMutex);
@@ -6561,17 +6872,92 @@ uint8 *Driver::GetNetworkKey() {
 //-----------------------------------------------------------------------------
 bool Driver::SendEncryptedMessage() {
 
+	uint8 nodeId = m_currentMsg->GetTargetNodeId();
+
+	/* if more encrypted messages are waiting for this node, ask it for the
+	 * nonce for the next one along with this one (MessageEncapNonceGet)
+	 */
+	bool prefetch = HasQueuedEncryptedMsg(nodeId);
+	m_currentMsg->setNonceGet(prefetch);
+
 	uint8 *buffer = m_currentMsg->GetBuffer();
 	uint8 length = m_currentMsg->GetLength();
 	m_expectedCallbackId = m_currentMsg->GetCallbackId();
-	Log::Write(LogLevel_Info, m_currentMsg->GetTargetNodeId(), "Sending (%s) message (Callback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str());
+	Log::Write(LogLevel_Info, nodeId, "Sending (%s) message (Callback ID=0x%.2x, Expected Reply=0x%.2x) - %s%s", c_sendQueueNames[m_currentMsgQueueSource], m_expectedCallbackId, m_expectedReply, prefetch ? "Nonce_Get - " : "", m_currentMsg->GetAsString().c_str());
 
 	m_controller->Write( buffer, length );
 	m_currentMsg->clearNonce();
+	m_nonceWait = false;
+	m_noncePrefetchWait = false;
+
+	if (prefetch) {
+		m_noncePrefetchNodeId = nodeId;
+		m_noncePrefetchReceived = false;
+		m_noncePrefetchExpiry.SetTime(NONCE_PREFETCH_WAIT);
+		m_noncePrefetchBatch++;
+	} else if (m_noncePrefetchNodeId == nodeId) {
+		m_noncePrefetchNodeId = 0;
+	}
 
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::HasQueuedEncryptedMsg>
+// Whether an encrypted message for the node is waiting in any send queue
+//-----------------------------------------------------------------------------
+bool Driver::HasQueuedEncryptedMsg
+(
+		uint8 const _nodeId
+)
+{
+	bool found = false;
+	m_sendMutex->Lock();
+	for( int32 i=0; i<MsgQueue_Count && !found; ++i )
+	{
+		for( list<MsgQueueItem>::iterator it = m_msgQueue[i].begin(); it != m_msgQueue[i].end(); ++it )
+		{
+			if( MsgQueueCmd_SendMsg == (*it).m_command && _nodeId == (*it).m_msg->GetTargetNodeId() && (*it).m_msg->isEncrypted() )
+			{
+				found = true;
+				break;
+			}
+		}
+	}
+	m_sendMutex->Unlock();
+	return found;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::UsePrefetchedNonce>
+// Give the current message the nonce its node sent ahead of need, if it is
+// still good.  Returns true if the nonce has been asked for but not arrived.
+//-----------------------------------------------------------------------------
+bool Driver::UsePrefetchedNonce
+(
+)
+{
+	if( m_noncePrefetchNodeId == 0 || m_noncePrefetchNodeId != m_currentMsg->GetTargetNodeId() )
+	{
+		return false;
+	}
+	if( m_noncePrefetchExpiry.TimeRemaining() <= 0 )
+	{
+		// Too old to use, or too late in coming
+		m_noncePrefetchNodeId = 0;
+		return false;
+	}
+	if( !m_noncePrefetchReceived )
+	{
+		return true;
+	}
+
+	// A nonce can only be used once
+	m_currentMsg->setNonce( m_noncePrefetch );
+	m_noncePrefetchNodeId = 0;
+	return false;
+}
+
 
 bool Driver::SendNonceRequest(string logmsg) {
 
@@ -6600,10 +6986,17 @@ bool Driver::SendNonceRequest(string logmsg) {
 	Log::Write(LogLevel_Info, m_currentMsg->GetTargetNodeId(), "Sending (%s) message (Callback ID=0x%.2x, Expected Reply=0x%.2x) - Nonce_Get(%s) - %s:", c_sendQueueNames[m_currentMsgQueueSource], m_expectedCallbackId, m_expectedReply, logmsg.c_str(), PktToString(m_buffer, 10).c_str());
 
 	m_controller->Write(m_buffer, 11);
+	m_nonceWait = true;
+	m_noncePrefetchWait = false;
 
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::initNetworkKeys>
+// Switch to the key schedules for the network key or the inclusion key,
+// deriving them the first time each is used
+//-----------------------------------------------------------------------------
 bool Driver::initNetworkKeys(bool newnode) {
 
 	uint8_t EncryptPassword[16] = {0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA};
@@ -6612,9 +7005,14 @@ bool Driver::initNetworkKeys(bool newnode) {
 	uint8_t SecuritySchemes[1][16] = {
 			{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
 	};
+	int idx = newnode ? 1 : 0;
 	this->m_inclusionkeySet = newnode;
-	this->AuthKey = new aes_encrypt_ctx;
-	this->EncryptKey = new aes_encrypt_ctx;
+	this->AuthKey = &this->m_authKeys[idx];
+	this->EncryptKey = &this->m_encryptKeys[idx];
+	if (m_keysDerived[idx]) {
+		/* the schedules only depend on the key, so reuse them */
+		return true;
+	}
 
 	Log::Write(LogLevel_Info, GetControllerNodeId(), "Setting Up %s Network Key for Secure Communications", newnode == true ? "Inclusion" : "Provided");
 
@@ -6665,6 +7063,7 @@ bool Driver::initNetworkKeys(bool newnode) {
 	}
 	aes_mode_reset(this->EncryptKey);
 	aes_mode_reset(this->AuthKey);
+	m_keysDerived[idx] = true;
 	return true;
 }
 
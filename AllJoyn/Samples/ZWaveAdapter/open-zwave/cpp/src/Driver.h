@@ -634,6 +634,14 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 		//		at regular intervals.  These are of the lowest priority, and are only
 		//		sent when nothing else is going on
 		//
+		// Queues 0 to 4 are strictly prioritised.  Items on the send, query and
+		// poll queues carry a deadline (the "SendDeadline", "QueryDeadline" and
+		// "PollDeadline" options), and of these three queues the one whose oldest
+		// item is due first is served, so a busy send queue cannot starve node
+		// queries and polls forever.  Within each of these queues the nodes take
+		// turns, and a Get that is already waiting on the send or poll queue is
+		// not queued a second time.
+		//
 		enum MsgQueueCmd
 		{
 			MsgQueueCmd_SendMsg = 0,
@@ -649,7 +657,8 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 				m_nodeId(0),
 				m_queryStage(Node::QueryStage_None),
 				m_retry(false),
-				m_cci(NULL)
+				m_cci(NULL),
+				m_deadline(0)
 			{}
 
 			bool operator == ( MsgQueueItem const& _other )const
@@ -673,14 +682,24 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 				return false;
 			}
 
+			uint8 GetNodeId()const;			// The node the item is for
+
 			MsgQueueCmd			m_command;
 			Msg*				m_msg;
 			uint8				m_nodeId;
 			Node::QueryStage		m_queryStage;
 			bool				m_retry;
 			ControllerCommandItem*		m_cci;
+			int32				m_deadline;		// When the item is due, in ms since m_queueEpoch (send, query and poll queues only)
 		};
 
+		int32 GetQueueTime();												// Milliseconds since m_queueEpoch.  Caller must hold m_sendMutex.
+		void PushQueueItem( MsgQueueItem& _item, MsgQueue const _queue );	// Stamps the item's deadline and appends it to the queue.  Caller must hold m_sendMutex.
+		bool CoalesceMsg( Msg* _msg, MsgQueue const _queue );				// Returns true if _msg is a Get already waiting on the send or poll queue.  Caller must hold m_sendMutex.
+		MsgQueue GetScheduledQueue( MsgQueue const _queue );				// The queue to serve when _queue has been signalled.  Caller must hold m_sendMutex.
+		list<MsgQueueItem>::iterator GetScheduledItem( MsgQueue& _queue );		// The next item to take from the queue, which may change to the queue holding it.  Caller must hold m_sendMutex.
+		list<MsgQueueItem>::iterator GetFairItem( MsgQueue const _queue );		// The due or fairest item on a send, query or poll queue.  Caller must hold m_sendMutex.
+
 OPENZWAVE_EXPORT_WARNINGS_OFF
 		list<MsgQueueItem>			m_msgQueue[MsgQueue_Count];
 OPENZWAVE_EXPORT_WARNINGS_ON
@@ -689,6 +708,10 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 		Msg*					m_currentMsg;
 		MsgQueue				m_currentMsgQueueSource;			// identifies which queue held m_currentMsg
 		TimeStamp				m_resendTimeStamp;
+		TimeStamp				m_queueEpoch;						// Origin of the queue item deadlines
+		int32					m_queueDeadline[MsgQueue_Count];	// How long an item may wait on each queue before it is due, in ms
+		uint32					m_sendTurn;							// Counts the items taken from the send, query and poll queues
+		uint32					m_nodeTurn[256];					// The value of m_sendTurn when each node was last served
 
 	//-----------------------------------------------------------------------------
 	// Network functions
@@ -830,12 +853,28 @@ OPENZWAVE_EXPORT_WARNINGS_ON
 		bool SendEncryptedMessage();
 		bool SendNonceRequest(string logmsg);
 		void SendNonceKey(uint8 nodeId, uint8 *nonce);
-		aes_encrypt_ctx *AuthKey;
+		bool HasQueuedEncryptedMsg(uint8 nodeId);		// Whether another encrypted message waits for the node
+		bool UsePrefetchedNonce();						// Give the current message a nonce its node sent ahead of need.  Returns true if one is still on its way.
+		aes_encrypt_ctx *AuthKey;						// The key schedules in use, pointing into m_authKeys and m_encryptKeys
 		aes_encrypt_ctx *EncryptKey;
+		aes_encrypt_ctx m_authKeys[2];					// Key schedules for the provided network key [0] and the inclusion key [1], derived once
+		aes_encrypt_ctx m_encryptKeys[2];
+		bool m_keysDerived[2];
 		uint8 m_nonceReportSent;
 		uint8 m_nonceReportSentAttempt;
 		bool m_inclusionkeySet;
 
+		// While a run of encrypted messages goes to one node, each is sent as a
+		// MessageEncapNonceGet so the node answers with the nonce for the next,
+		// saving the Nonce_Get round trip.
+		bool m_nonceWait;								// The current message waits for a Nonce_Report
+		bool m_noncePrefetchWait;						// ...one that its node was asked for ahead of need
+		uint8 m_noncePrefetchNodeId;					// Node last asked for a nonce ahead of need, or 0
+		bool m_noncePrefetchReceived;					// Whether that nonce has arrived
+		uint8 m_noncePrefetch[8];
+		TimeStamp m_noncePrefetchExpiry;				// When to stop waiting for the nonce, or using it
+		uint32 m_noncePrefetchBatch;					// Encrypted messages sent to the node in a row
+
 	};
 
 } // namespace OpenZWave
@@ -73,6 +73,7 @@ Msg::Msg
 	m_flags( 0 ),
 	m_encrypted ( false ),
 	m_noncerecvd ( false ),
+	m_nonceGet ( false ),
 	m_homeId ( 0 )
 {
 	if( _bReplyRequired )
@@ -313,7 +314,7 @@ uint8* Msg::GetBuffer() {
 	if (m_encrypted == false)
 		return m_buffer;
 	else
-		if (EncyrptBuffer(m_buffer, m_length, GetDriver(), GetDriver()->GetControllerNodeId(), m_targetNodeId, m_nonce, e_buffer)) {
+		if (EncyrptBuffer(m_buffer, m_length, GetDriver(), GetDriver()->GetControllerNodeId(), m_targetNodeId, m_nonce, e_buffer, m_nonceGet)) {
 			return e_buffer;
 		} else {
 			Log::Write(LogLevel_Warning, m_targetNodeId, "Failed to Encyrpt Packet");
@@ -107,7 +107,7 @@ namespace OpenZWave
 		 */
 		string GetLogText()const{ return m_logText; }
 
-		uint32 GetLength()const{ return m_encrypted == true ? m_length + 20 + 6 : m_length; }
+		uint32 GetLength()const{ return m_encrypted == true ? m_length + 20 : m_length; }
 		uint8* GetBuffer();
 		string GetAsString();
 
@@ -163,6 +163,9 @@ namespace OpenZWave
 			memset((m_nonce), '\0', 8);
 			m_noncerecvd = false;
 		}
+		void setNonceGet(bool nonceGet) {	// Send as a MessageEncapNonceGet, asking for the next nonce
+			m_nonceGet = nonceGet;
+		}
 		void SetHomeId(uint32 homeId) { m_homeId = homeId; };
 
 		/** Returns a pointer to the driver (interface with a Z-Wave controller)
@@ -196,6 +199,7 @@ namespace OpenZWave
 		bool			m_encrypted;
 		bool			m_noncerecvd;
 		uint8			m_nonce[8];
+		bool			m_nonceGet;
 		uint32			m_homeId;
 		static uint8		s_nextCallbackId;		// counter to get a unique callback id
 	};
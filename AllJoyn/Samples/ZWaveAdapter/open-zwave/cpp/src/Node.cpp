@@ -3128,6 +3128,13 @@ uint8 *Node::GenerateNonceKey() {
 	for (int i = 0; i < 8; i++) {
 		this->m_nonces[idx][i] = (rand()%0xFF)+1;
 	}
+	/* the first byte identifies the nonce in GetNonceKey, so keep it unique */
+	for (int i = 0; i < 8; i++) {
+		if (i != idx && this->m_nonces[i][0] == this->m_nonces[idx][0]) {
+			this->m_nonces[idx][0] = (rand()%0xFF)+1;
+			i = -1;
+		}
+	}
 	this->m_lastnonce++;
 	if (this->m_lastnonce >= 8)
 		this->m_lastnonce = 0;
@@ -123,6 +123,9 @@ Options* Options::Create
 		s_instance->AddOptionString(	"NetworkKey", 				string(""), 			false);
 		s_instance->AddOptionBool(		"RefreshAllUserCodes",		false ); 					// if true, during startup, we refresh all the UserCodes the device reports it supports. If False, we stop after we get the first "Available" slot (Some devices have 250+ usercode slots! - That makes our Session Stage Very Long )
 		s_instance->AddOptionInt( 		"RetryTimeout", 			RETRY_TIMEOUT);				// How long do we wait to timeout messages sent
+		s_instance->AddOptionInt(		"SendDeadline",				SEND_DEADLINE);				// How long a request may wait on the send queue before it goes ahead of queries and polls
+		s_instance->AddOptionInt(		"QueryDeadline",			QUERY_DEADLINE);			// How long a node query may wait on the query queue before it goes ahead of requests and polls
+		s_instance->AddOptionInt(		"PollDeadline",				POLL_DEADLINE);				// How long a poll may wait on the poll queue before it goes ahead of requests and queries
 		s_instance->AddOptionBool( 		"EnableSIS", 				true);						// Automatically become a SUC if there is no SUC on the network.
 		s_instance->AddOptionBool( 		"AssumeAwake", 				true);						// Assume Devices that Support the Wakeup CC are awake when we first query them....
 		s_instance->AddOptionBool(		"NotifyOnDriverUnload",		false);						// Should we send the Node/Value Notifications on Driver Unloading - Read comments in Driver::~Driver() method about possible race conditions
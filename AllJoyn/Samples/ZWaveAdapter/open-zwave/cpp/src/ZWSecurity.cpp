@@ -74,50 +74,23 @@ namespace OpenZWave {
 		Log::Write(LogLevel_Debug, _receivingNode, "Raw Auth (Minus IV) Size: %d (%d)", bufsize, bufsize+16);
 #endif
 
-		aes_mode_reset(driver->GetAuthKey());
+		/* the MAC is a CBC-MAC, one block at a time, so skip the ECB mode
+		 * wrapper and use the key schedule directly */
+		aes_encrypt_ctx *authKey = driver->GetAuthKey();
 		/* encrypt the IV with ecb */
-		if (aes_ecb_encrypt(iv, tmpauth, 16, driver->GetAuthKey()) == EXIT_FAILURE) {
+		if (aes_encrypt(iv, tmpauth, authKey) == EXIT_FAILURE) {
 			Log::Write(LogLevel_Warning, _receivingNode, "Failed Initial ECB Encrypt of Auth Packet");
 			return false;
 		}
 
-		/* our temporary holding var */
-		uint8 encpck[16];
-
-		int block = 0;
-		/* reset our encpck temp var */
-		memset(encpck, 0, 16);
-		/* now xor the buffer with our encrypted IV */
-		for (int i = 0; i < bufsize; i++) {
-			encpck[block] = buffer[i];
-			block++;
-			/* if we hit a blocksize, then encrypt */
-			if (block == 16) {
-				for (int j = 0; j < 16; j++) {
-					/* here we do our xor */
-					tmpauth[j] = encpck[j] ^ tmpauth[j];
-					/* and reset encpck for good measure */
-					encpck[j] = 0;
-				}
-				/* reset our block counter back to 0 */
-				block = 0;
-				aes_mode_reset(driver->GetAuthKey());
-				if (aes_ecb_encrypt(tmpauth, tmpauth, 16, driver->GetAuthKey()) == EXIT_FAILURE) {
-					Log::Write(LogLevel_Warning, _receivingNode, "Failed Subsequent (%d) ECB Encrypt of Auth Packet", i);
-					return false;
-				}
-			}
-		}
-		/* any left over data that isn't a full block size*/
-		if (block > 0) {
-			for (int i= 0; i < 16; i++) {
-				/* encpck from block to 16 is already gauranteed to be 0
-				 * so its safe to xor it with out tmpmac */
-				tmpauth[i] = encpck[i] ^ tmpauth[i];
+		/* now xor each block of the buffer (already padded with zeros)
+		 * into the running MAC, and encrypt it */
+		for (int i = 0; i < bufsize; i += 16) {
+			for (int j = 0; j < 16; j++) {
+				tmpauth[j] ^= buffer[i+j];
 			}
-			aes_mode_reset(driver->GetAuthKey());
-			if (aes_ecb_encrypt(tmpauth, tmpauth, 16, driver->GetAuthKey()) == EXIT_FAILURE) {
-				Log::Write(LogLevel_Warning, _receivingNode, "Failed Final ECB Encrypt of Auth Packet");
+			if (aes_encrypt(tmpauth, tmpauth, authKey) == EXIT_FAILURE) {
+				Log::Write(LogLevel_Warning, _receivingNode, "Failed Subsequent (%d) ECB Encrypt of Auth Packet", i);
 				return false;
 			}
 		}
@@ -137,7 +110,8 @@ namespace OpenZWave {
 			uint8 const _sendingNode,
 			uint8 const _receivingNode,
 			uint8 const m_nonce[8],
-			uint8* e_buffer
+			uint8* e_buffer,
+			bool const _nonceGet			// Ask the receiver for a nonce for the next message
 	)
 	{
 
@@ -159,7 +133,7 @@ namespace OpenZWave {
 		e_buffer[len++] = _receivingNode;
 		e_buffer[len++] = m_length + 11; 					// Length of the payload
 		e_buffer[len++] = Security::StaticGetCommandClassId();
-		e_buffer[len++] = SecurityCmd_MessageEncap;
+		e_buffer[len++] = _nonceGet ? SecurityCmd_MessageEncapNonceGet : SecurityCmd_MessageEncap;
 
 		/* create our IV */
 		uint8 initializationVector[16];
@@ -189,11 +163,12 @@ namespace OpenZWave {
 
 		/* now encrypt */
 		uint8 encryptedpayload[30];
-		aes_mode_reset(driver->GetEncKey());
+		aes_encrypt_ctx *encKey = driver->GetEncKey();
+		aes_mode_reset(encKey);
 #ifdef DEBUG
 		PrintHex("Plain Text Packet:", plaintextmsg, m_length-5-3);
 #endif
-		if (aes_ofb_encrypt(plaintextmsg, encryptedpayload, m_length-5-3, initializationVector, driver->GetEncKey()) == EXIT_FAILURE) {
+		if (aes_ofb_encrypt(plaintextmsg, encryptedpayload, m_length-5-3, initializationVector, encKey) == EXIT_FAILURE) {
 			Log::Write(LogLevel_Warning, _receivingNode, "Failed to Encrypt Packet");
 			return false;
 		}
@@ -281,7 +256,9 @@ namespace OpenZWave {
 			uint8* m_buffer
 	)
 	{
+#ifdef DEBUG
 		PrintHex("Raw", e_buffer, e_length);
+#endif
 
 		if (e_length < 19) {
 			Log::Write(LogLevel_Warning, _sendingNode, "Recieved a Encrypted Message that is too Short. Dropping it");
@@ -322,7 +299,8 @@ namespace OpenZWave {
 		/* Mac Starts after Encrypted Packet. */
 		PrintHex("Auth", &e_buffer[11+encryptedpacketsize], 8);
 #endif
-		aes_mode_reset(driver->GetEncKey());
+		aes_encrypt_ctx *encKey = driver->GetEncKey();
+		aes_mode_reset(encKey);
 #if 0
 		uint8_t iv[16] = {  0x81, 0x42, 0xd1, 0x51, 0xf1, 0x59, 0x3d, 0x70, 0xd5, 0xe3, 0x6c, 0xcb, 0x02, 0xd0, 0x3f, 0x5c,  /* */  };
 		uint8_t pck[] = {  0x25, 0x68, 0x06, 0xc5, 0xb3, 0xee, 0x2c, 0x17, 0x26, 0x7e, 0xf0, 0x84, 0xd4, 0xc3, 0xba, 0xed, 0xe5, 0xb9, 0x55};
@@ -332,7 +310,7 @@ namespace OpenZWave {
 		}
 		PrintHex("Pck", decryptpacket, 19);
 #else
-		if (aes_ofb_decrypt(encyptedpacket, m_buffer, encryptedpacketsize, iv, driver->GetEncKey()) == EXIT_FAILURE) {
+		if (aes_ofb_decrypt(encyptedpacket, m_buffer, encryptedpacketsize, iv, encKey) == EXIT_FAILURE) {
 			Log::Write(LogLevel_Warning, _sendingNode, "Failed to Decrypt Packet");
 			return false;
 		}
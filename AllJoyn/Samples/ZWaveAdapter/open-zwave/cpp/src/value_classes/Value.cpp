@@ -35,10 +35,16 @@
 #include "platform/Log.h"
 #include "command_classes/CommandClass.h"
 #include <ctime>
+#include <set>
 #include "Options.h"
+#include "Utils.h"
+#include "platform/Mutex.h"
 
 using namespace OpenZWave;
 
+static set<string> s_strings;					// Every label, units and help string in use
+static Mutex* const s_stringsMutex = new Mutex();
+
 static char const* c_genreName[] =
 {
 	"basic",
@@ -87,9 +93,9 @@ Value::Value
 	m_refreshTime(0),
 	m_verifyChanges( false ),
 	m_id( _homeId, _nodeId, _genre, _commandClassId, _instance, _index, _type ),
-	m_label( _label ),
-	m_units( _units ),
-	m_help( "" ),
+	m_label( Intern( _label ) ),
+	m_units( Intern( _units ) ),
+	m_help( Intern( "" ) ),
 	m_readOnly( _readOnly ),
 	m_writeOnly( _writeOnly ),
 	m_isSet( _isSet ),
@@ -112,6 +118,9 @@ Value::Value
 	m_max( 0 ),
 	m_refreshTime(0),
 	m_verifyChanges( false ),
+	m_label( Intern( "" ) ),
+	m_units( Intern( "" ) ),
+	m_help( Intern( "" ) ),
 	m_readOnly( false ),
 	m_writeOnly( false ),
 	m_isSet( false ),
@@ -171,13 +180,13 @@ void Value::ReadXML
 	char const* label = _valueElement->Attribute( "label" );
 	if( label )
 	{
-		m_label = label;
+		m_label = Intern( label );
 	}
 
 	char const* units = _valueElement->Attribute( "units" );
 	if( units )
 	{
-		m_units = units;
+		m_units = Intern( units );
 	}
 
 	char const* readOnly = _valueElement->Attribute( "read_only" );
@@ -267,7 +276,7 @@ void Value::ReadXML
 			str = helpElement->GetText();
 			if( str )
 			{
-				m_help = str;
+				m_help = Intern( str );
 			}
 			break;
 		}
@@ -296,8 +305,8 @@ void Value::WriteXML
 	snprintf( str, sizeof(str), "%d", m_id.GetIndex() );
 	_valueElement->SetAttribute( "index", str );
 
-	_valueElement->SetAttribute( "label", m_label.c_str() );
-	_valueElement->SetAttribute( "units", m_units.c_str() );
+	_valueElement->SetAttribute( "label", m_label->c_str() );
+	_valueElement->SetAttribute( "units", m_units->c_str() );
 	_valueElement->SetAttribute( "read_only", m_readOnly ? "true" : "false" );
 	_valueElement->SetAttribute( "write_only", m_writeOnly ? "true" : "false" );
 	_valueElement->SetAttribute( "verify_changes", m_verifyChanges ? "true" : "false" );
@@ -331,12 +340,12 @@ void Value::WriteXML
 		_valueElement->SetAttribute( "affects", s.c_str() );
 	}
 
-	if( m_help.length() > 0 )
+	if( m_help->length() > 0 )
 	{
 		TiXmlElement* helpElement = new TiXmlElement( "Help" );
 		_valueElement->LinkEndChild( helpElement );
 
-		TiXmlText* textElement = new TiXmlText( m_help.c_str() );
+		TiXmlText* textElement = new TiXmlText( m_help->c_str() );
 		helpElement->LinkEndChild( textElement );
 	}
 }
@@ -474,6 +483,20 @@ void Value::OnValueChanged
 
 }
 
+//-----------------------------------------------------------------------------
+// <Value::Intern>
+// Get the shared copy of a string.  The copies are never freed, as there
+// are only as many as there are distinct labels, units and help texts.
+//-----------------------------------------------------------------------------
+string const* Value::Intern
+(
+	string const& _str
+)
+{
+	LockGuard LG( s_stringsMutex );
+	return &*s_strings.insert( _str ).first;
+}
+
 //-----------------------------------------------------------------------------
 // <Value::GetGenreEnumFromName>
 // Static helper to get a genre enum from a string
@@ -62,14 +62,14 @@ namespace OpenZWave
 		bool IsSet()const{ return m_isSet; }
 		bool IsPolled()const{ return m_pollIntensity != 0; }
 
-		string const& GetLabel()const{ return m_label; }
-		void SetLabel( string const& _label ){ m_label = _label; }
+		string const& GetLabel()const{ return *m_label; }
+		void SetLabel( string const& _label ){ if( *m_label != _label ) m_label = Intern( _label ); }
 
-		string const& GetUnits()const{ return m_units; }
-		void SetUnits( string const& _units ){ m_units = _units; }
+		string const& GetUnits()const{ return *m_units; }
+		void SetUnits( string const& _units ){ if( *m_units != _units ) m_units = Intern( _units ); }
 
-		string const& GetHelp()const{ return m_help; }
-		void SetHelp( string const& _help ){ m_help = _help; }
+		string const& GetHelp()const{ return *m_help; }
+		void SetHelp( string const& _help ){ if( *m_help != _help ) m_help = Intern( _help ); }
 
 		uint8 const& GetPollIntensity()const{ return m_pollIntensity; }
 		void SetPollIntensity( uint8 const& _intensity ){ m_pollIntensity = _intensity; }
@@ -108,10 +108,12 @@ namespace OpenZWave
 		bool		m_verifyChanges;		// if true, apparent changes are verified; otherwise, they're not
 
 	private:
+		static string const* Intern( string const& _str );	// The shared copy of a label, units or help string
+
 		ValueID		m_id;
-		string		m_label;
-		string		m_units;
-		string		m_help;
+		string const*	m_label;			// Interned, as most values share their label, units and help with many others
+		string const*	m_units;
+		string const*	m_help;
 		bool		m_readOnly;
 		bool		m_writeOnly;
 		bool		m_isSet;
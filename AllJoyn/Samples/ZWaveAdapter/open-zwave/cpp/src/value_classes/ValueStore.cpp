@@ -29,25 +29,192 @@
 #include "value_classes/Value.h"
 #include "Manager.h"
 #include "Notification.h"
+#include "Utils.h"
+#include "platform/Mutex.h"
+
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace OpenZWave;
 
+// A reader must see a table entry written before the count or table pointer
+// that covers it.  On x86 only the compiler needs holding back; ARM needs a
+// barrier instruction.  The reader counter operations are full barriers.
+#if defined _MSC_VER
+#if defined _M_ARM
+#define VALUESTORE_BARRIER()	__dmb( _ARM_BARRIER_ISH )
+#elif defined _M_ARM64
+#define VALUESTORE_BARRIER()	__dmb( _ARM64_BARRIER_ISH )
+#else
+#define VALUESTORE_BARRIER()	_ReadWriteBarrier()
+#endif
+#define VALUESTORE_ACQUIRE()	VALUESTORE_BARRIER()
+#define VALUESTORE_RELEASE()	VALUESTORE_BARRIER()
+#define VALUESTORE_ENTER( _c )	_InterlockedIncrement( _c )
+#define VALUESTORE_LEAVE( _c )	_InterlockedDecrement( _c )
+#define VALUESTORE_READERS( _c )	_InterlockedCompareExchange( _c, 0, 0 )
+#else
+#if defined __ATOMIC_ACQUIRE
+#define VALUESTORE_ACQUIRE()	__atomic_thread_fence( __ATOMIC_ACQUIRE )
+#define VALUESTORE_RELEASE()	__atomic_thread_fence( __ATOMIC_RELEASE )
+#else
+#define VALUESTORE_ACQUIRE()	__sync_synchronize()
+#define VALUESTORE_RELEASE()	__sync_synchronize()
+#endif
+#define VALUESTORE_ENTER( _c )	__sync_add_and_fetch( _c, 1 )
+#define VALUESTORE_LEAVE( _c )	__sync_sub_and_fetch( _c, 1 )
+#define VALUESTORE_READERS( _c )	__sync_val_compare_and_swap( _c, 0, 0 )
+#endif
+
+//-----------------------------------------------------------------------------
+// <FindKey>
+// Index of the first entry whose key is not less than the one given
+//-----------------------------------------------------------------------------
+static uint32 FindKey
+(
+	pair<uint32,Value*> const* _entries,
+	uint32 const _count,
+	uint32 const _key
+)
+{
+	uint32 lo = 0;
+	uint32 hi = _count;
+	while( lo < hi )
+	{
+		uint32 mid = ( lo + hi ) >> 1;
+		if( _entries[mid].first < _key )
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
 
 //-----------------------------------------------------------------------------
 // <ValueStore::ValueStore>
+// Constructor
+//-----------------------------------------------------------------------------
+ValueStore::ValueStore
+(
+):
+	m_table( NewTable( 0 ) ),
+	m_readers( 0 ),
+	m_mutex( new Mutex() )
+{
+}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::~ValueStore>
 // Destructor
 //-----------------------------------------------------------------------------
 ValueStore::~ValueStore
 (
 )
 {
-	map<uint32,Value*>::iterator it = m_values.begin();
-	while( !m_values.empty() )
+	Table* table = m_table;
+	for( uint32 i=0; i<table->m_count; ++i )
+	{
+		Value* value = table->m_entries[i].second;
+
+		// Notify the watchers
+		if( Driver* driver = Manager::Get()->GetDriver( value->GetID().GetHomeId() ) )
+		{
+			Notification* notification = new Notification( Notification::Type_ValueRemoved );
+			notification->SetValueId( value->GetID() );
+			driver->QueueNotification( notification );
+		}
+
+		value->Release();
+	}
+	DeleteTable( table );
+
+	// No reader can be left by now
+	Reclaim();
+
+	m_mutex->Release();
+}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::NewTable>
+// Allocate an empty table
+//-----------------------------------------------------------------------------
+ValueStore::Table* ValueStore::NewTable
+(
+	uint32 const _capacity
+)
+{
+	Table* table = new Table();
+	table->m_capacity = _capacity;
+	table->m_count = 0;
+	table->m_entries = _capacity ? new pair<uint32,Value*>[_capacity] : NULL;
+	return table;
+}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::DeleteTable>
+// Free a table that no reader can reach
+//-----------------------------------------------------------------------------
+void ValueStore::DeleteTable
+(
+	Table* _table
+)
+{
+	delete [] _table->m_entries;
+	delete _table;
+}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::Publish>
+// Make a fully built table the one readers see
+//-----------------------------------------------------------------------------
+void ValueStore::Publish
+(
+	Table* _table
+)
+{
+	Table* old = m_table;
+	VALUESTORE_RELEASE();
+	m_table = _table;
+	m_retired.push_back( old );
+}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::Reclaim>
+// Free the tables and values taken out by earlier changes, unless a reader
+// may still be using them
+//-----------------------------------------------------------------------------
+void ValueStore::Reclaim
+(
+)
+{
+	if( m_retired.empty() && m_removed.empty() )
+	{
+		return;
+	}
+
+	// They were unlinked before the counter is read, so a reader
+	// that comes in after this can only find the current table.
+	if( VALUESTORE_READERS( &m_readers ) != 0 )
+	{
+		return;
+	}
+
+	for( vector<Table*>::iterator it = m_retired.begin(); it != m_retired.end(); ++it )
 	{
-		ValueID const& valueId = it->second->GetID();
-		RemoveValue( valueId.GetValueStoreKey() );
-		it = m_values.begin();
+		DeleteTable( *it );
 	}
+	m_retired.clear();
+
+	for( vector<Value*>::iterator it = m_removed.begin(); it != m_removed.end(); ++it )
+	{
+		(*it)->Release();
+	}
+	m_removed.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -65,15 +232,43 @@ bool ValueStore::AddValue
 	}
 
 	uint32 key = _value->GetID().GetValueStoreKey();
-	map<uint32,Value*>::iterator it = m_values.find( key );
-	if( it != m_values.end() )
 	{
-		// There is already a value in the store with this key, so we give up.
-		return false;
-	}
+		LockGuard LG( m_mutex );
+		Reclaim();
+		Table* table = m_table;
+		uint32 count = table->m_count;
+		uint32 pos = FindKey( table->m_entries, count, key );
+		if( pos < count && table->m_entries[pos].first == key )
+		{
+			// There is already a value in the store with this key, so we give up.
+			return false;
+		}
 
-	m_values[key] = _value;
-	_value->AddRef();
+		_value->AddRef();
+		if( pos == count && count < table->m_capacity )
+		{
+			// Values mostly arrive in key order, and a slot past the
+			// count is not looked at by readers until the count moves.
+			table->m_entries[pos] = pair<uint32,Value*>( key, _value );
+			VALUESTORE_RELEASE();
+			table->m_count = count + 1;
+		}
+		else
+		{
+			Table* grown = NewTable( ( count < table->m_capacity ) ? table->m_capacity : ( count ? count * 2 : 8 ) );
+			for( uint32 i=0; i<pos; ++i )
+			{
+				grown->m_entries[i] = table->m_entries[i];
+			}
+			grown->m_entries[pos] = pair<uint32,Value*>( key, _value );
+			for( uint32 i=pos; i<count; ++i )
+			{
+				grown->m_entries[i+1] = table->m_entries[i];
+			}
+			grown->m_count = count + 1;
+			Publish( grown );
+		}
+	}
 
 	// Notify the watchers of the new value
 	if( Driver* driver = Manager::Get()->GetDriver( _value->GetID().GetHomeId() ) )
@@ -95,41 +290,49 @@ bool ValueStore::RemoveValue
 	uint32 const& _key
 )
 {
-	map<uint32,Value*>::iterator it = m_values.find( _key );
-	if( it != m_values.end() )
+	Value* value = NULL;
 	{
-		Value* value = it->second;
-		ValueID const& valueId = value->GetID();
+		LockGuard LG( m_mutex );
+		Reclaim();
+		Table* table = m_table;
+		uint32 count = table->m_count;
+		uint32 pos = FindKey( table->m_entries, count, _key );
+		if( pos == count || table->m_entries[pos].first != _key )
+		{
+			// Value not found in the store
+			return false;
+		}
 
-		// First notify the watchers
-		if( Driver* driver = Manager::Get()->GetDriver( valueId.GetHomeId() ) )
+		value = table->m_entries[pos].second;
+		Table* shrunk = NewTable( table->m_capacity );
+		uint32 j = 0;
+		for( uint32 i=0; i<count; ++i )
 		{
-			Notification* notification = new Notification( Notification::Type_ValueRemoved );
-			notification->SetValueId( valueId );
-			driver->QueueNotification( notification ); 
+			if( i != pos )
+			{
+				shrunk->m_entries[j++] = table->m_entries[i];
+			}
 		}
+		shrunk->m_count = j;
+		Publish( shrunk );
 
-		// Now release and remove the value from the store
-		value->Release();
-		m_values.erase( it );
+		// Keep our reference until no reader can have found the
+		// value, which is for a later change to find out.
+		m_removed.push_back( value );
+	}
 
-		return true;
+	// Notify the watchers
+	ValueID const& valueId = value->GetID();
+	if( Driver* driver = Manager::Get()->GetDriver( valueId.GetHomeId() ) )
+	{
+		Notification* notification = new Notification( Notification::Type_ValueRemoved );
+		notification->SetValueId( valueId );
+		driver->QueueNotification( notification );
 	}
 
-	// Value not found in the store
-	return false;
+	return true;
 }
 
-////-----------------------------------------------------------------------------
-//// <ValueStore::RemoveValue>
-//// Remove a value from the store
-////-----------------------------------------------------------------------------
-//bool ValueStore::RemoveValue
-//(
-//	ValueID const& _id
-//)
-
-
 //-----------------------------------------------------------------------------
 // <ValueStore::RemoveCommandClassValues>
 // Remove all the values associated with a command class from the store
@@ -139,30 +342,47 @@ void ValueStore::RemoveCommandClassValues
 	uint8 const _commandClassId
 )
 {
-	map<uint32,Value*>::iterator it = m_values.begin();
-	while( it != m_values.end() )
+	vector<Value*> removed;
 	{
-		Value* value = it->second;
-		ValueID const& valueId = value->GetID();
-		if( _commandClassId == valueId.GetCommandClassId() )
+		LockGuard LG( m_mutex );
+		Reclaim();
+		Table* table = m_table;
+		Table* kept = NewTable( table->m_capacity );
+		uint32 j = 0;
+		for( uint32 i=0; i<table->m_count; ++i )
 		{
-			// The value belongs to the specified command class
-			
-			// First notify the watchers
-			if( Driver* driver = Manager::Get()->GetDriver( valueId.GetHomeId() ) )
+			Value* value = table->m_entries[i].second;
+			if( _commandClassId == value->GetID().GetCommandClassId() )
 			{
-				Notification* notification = new Notification( Notification::Type_ValueRemoved );
-				notification->SetValueId( valueId );
-				driver->QueueNotification( notification ); 
+				// The value belongs to the specified command class
+				removed.push_back( value );
 			}
+			else
+			{
+				kept->m_entries[j++] = table->m_entries[i];
+			}
+		}
 
-			// Now release and remove the value from the store
-			value->Release();
-			m_values.erase( it++ );
+		if( removed.empty() )
+		{
+			DeleteTable( kept );
+			return;
 		}
-		else
+
+		kept->m_count = j;
+		Publish( kept );
+		m_removed.insert( m_removed.end(), removed.begin(), removed.end() );
+	}
+
+	// Notify the watchers
+	for( vector<Value*>::iterator it = removed.begin(); it != removed.end(); ++it )
+	{
+		ValueID const& valueId = (*it)->GetID();
+		if( Driver* driver = Manager::Get()->GetDriver( valueId.GetHomeId() ) )
 		{
-			++it;
+			Notification* notification = new Notification( Notification::Type_ValueRemoved );
+			notification->SetValueId( valueId );
+			driver->QueueNotification( notification );
 		}
 	}
 }
@@ -178,27 +398,21 @@ Value* ValueStore::GetValue
 {
 	Value* value = NULL;
 
-	map<uint32,Value*>::const_iterator it = m_values.find( _key );
-	if( it != m_values.end() )
+	// Nothing the table or value point to is freed until we leave
+	VALUESTORE_ENTER( &m_readers );
+	Table const* table = m_table;
+	uint32 count = table->m_count;
+	VALUESTORE_ACQUIRE();
+
+	uint32 pos = FindKey( table->m_entries, count, _key );
+	if( pos < count && table->m_entries[pos].first == _key )
 	{
-		value = it->second;
-		if( value )
-		{
-			// Add a reference to the value.  The caller must
-			// call Release on the value when they are done with it.
-			value->AddRef();
-		}
+		// Add a reference to the value.  The caller must
+		// call Release on the value when they are done with it.
+		value = table->m_entries[pos].second;
+		value->AddRef();
 	}
+	VALUESTORE_LEAVE( &m_readers );
 
 	return value;
 }
-
-////-----------------------------------------------------------------------------
-//// <ValueStore::GetValue>
-//// Get a value from the store
-////-----------------------------------------------------------------------------
-//Value* ValueStore::GetValue
-//(
-//	ValueID const& _id
-//)const
-
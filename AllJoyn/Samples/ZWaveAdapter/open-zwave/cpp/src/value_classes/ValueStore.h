@@ -28,7 +28,8 @@
 #ifndef _ValueStore_H
 #define _ValueStore_H
 
-#include <map>
+#include <utility>
+#include <vector>
 #include "Defs.h"
 #include "value_classes/ValueID.h"
 
@@ -37,19 +38,28 @@ class TiXmlElement;
 namespace OpenZWave
 {
 	class Value;
+	class Mutex;
 
 	/** \brief Container that holds all of the values associated with a given node.
+	 *
+	 * The values are kept in one array sorted by their value store key, so a
+	 * lookup is a binary search over contiguous memory.  Lookups take no lock:
+	 * a change is made in place only when it cannot disturb a reader (adding
+	 * at the end of the array), otherwise a new array is built and swapped in.
+	 * Readers announce themselves in a counter, and the arrays and values a
+	 * change takes out are freed by a later change that finds no reader in
+	 * progress.  Changes are serialized by the store's own mutex.  Iterating
+	 * with Begin and End must still not overlap a change.
 	 */
 	class ValueStore
 	{
 	public:
-		
-		typedef map<uint32,Value*>::const_iterator Iterator;
+		typedef pair<uint32,Value*> const* Iterator;
 
-		Iterator Begin(){ return m_values.begin(); }
-		Iterator End(){ return m_values.end(); }
-		
-		ValueStore(){}
+		Iterator Begin(){ return m_table->m_entries; }
+		Iterator End(){ return m_table->m_entries + m_table->m_count; }
+
+		ValueStore();
 		~ValueStore();
 
 		bool AddValue( Value* _value );
@@ -59,7 +69,23 @@ namespace OpenZWave
 		void RemoveCommandClassValues( uint8 const _commandClassId );		// Remove all the values associated with a command class
 
 	private:
-		map<uint32,Value*>	m_values;
+		struct Table
+		{
+			uint32				m_capacity;
+			uint32 volatile		m_count;
+			pair<uint32,Value*>*	m_entries;
+		};
+
+		Table* NewTable( uint32 const _capacity );
+		void DeleteTable( Table* _table );
+		void Publish( Table* _table );					// Swap in a new table, retiring the old one
+		void Reclaim();							// Free what was retired if no reader is in progress
+
+		Table* volatile		m_table;
+		mutable long volatile	m_readers;				// Lookups in progress
+		vector<Table*>		m_retired;				// Tables replaced while a reader may have been using them
+		vector<Value*>		m_removed;				// Values removed while a reader may have been using them
+		Mutex*				m_mutex;				// Serializes changes
 	};
 
 } // namespace OpenZWave